@@ -99,7 +99,8 @@ namespace {
 
     std::map<uint16_t, std::unique_ptr<Handler>> prepare_handlers(
             std::function<void()> close,
-            ConfigStreamContext &context
+            ConfigStreamContext &context,
+            std::iostream &stream
     ) {
         std::map<uint16_t, std::unique_ptr<Handler>> handlers{};
 
@@ -111,7 +112,7 @@ namespace {
         handlers[FILENAME] = std::make_unique<ConfigReferenceHandler>(config_callback, context.paths);
         handlers[CONFIG]   = std::make_unique<ConfigStringHandler>(config_callback);
         handlers[HEADER]   = std::make_unique<ErrorProducingHandler>("Received ISMRMRD header before config file.");
-        handlers[QUERY]    = std::make_unique<QueryHandler>();
+        handlers[QUERY]    = std::make_unique<QueryHandler>(stream);
         handlers[CLOSE]    = std::make_unique<CloseHandler>(close);
 
         return handlers;
@@ -140,7 +141,7 @@ namespace Gadgetron::Server::Connection::ConfigConnection {
         std::thread input_thread = start_input_thread(
                 stream,
                 std::move(channel.output),
-                [&](auto close) { return prepare_handlers(close, context); },
+                [&](auto close) { return prepare_handlers(close, context, stream); },
                 error_handler
         );
 
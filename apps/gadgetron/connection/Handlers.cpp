@@ -5,6 +5,7 @@
 #include "system_info.h"
 
 #include "io/primitives.h"
+#include "io/ismrmrd_meta.h"
 #include "Response.h"
 
 namespace {
@@ -66,6 +67,13 @@ namespace Gadgetron::Server::Connection::Handlers {
         initialize_with_default_queries(answers);
     }
 
+    QueryHandler::QueryHandler(std::iostream &stream) : QueryHandler() {
+        answers["gadgetron::meta::binary"] = [&stream]() {
+            set_meta_encoding(stream, MetaEncoding::binary);
+            return std::string("1");
+        };
+    }
+
     void QueryHandler::handle(std::istream &stream, Gadgetron::Core::OutputChannel& channel) {
 
         auto reserved = read<uint64_t>(stream);
@@ -20,6 +20,10 @@ namespace Gadgetron::Server::Connection::Handlers {
     public:
         QueryHandler();
 
+        // Also answers the queries negotiating the encoding of the stream, see MetaEncoding. Only used before the
+        // stream starts, so the encoding is settled before messages are read and written on separate threads.
+        explicit QueryHandler(std::iostream &stream);
+
         void handle(std::istream &stream, Gadgetron::Core::OutputChannel &channel) override;
 
         std::map<std::string, std::function<std::string()>> answers;
@@ -52,7 +52,8 @@ namespace {
 
     std::map<uint16_t, std::unique_ptr<Handler>> prepare_handlers(
             std::function<void()> close,
-            HeaderContext &context
+            HeaderContext &context,
+            std::iostream &stream
     ) {
         std::map<uint16_t, std::unique_ptr<Handler>> handlers{};
 
@@ -64,7 +65,7 @@ namespace {
         handlers[FILENAME] = std::make_unique<ErrorProducingHandler>(CONFIG_ERROR);
         handlers[CONFIG]   = std::make_unique<ErrorProducingHandler>(CONFIG_ERROR);
         handlers[HEADER]   = std::make_unique<HeaderHandler>(header_callback);
-        handlers[QUERY]    = std::make_unique<QueryHandler>();
+        handlers[QUERY]    = std::make_unique<QueryHandler>(stream);
         handlers[CLOSE]    = std::make_unique<CloseHandler>(close);
 
         return handlers;
@@ -93,7 +94,7 @@ namespace Gadgetron::Server::Connection::HeaderConnection {
         std::thread input_thread = start_input_thread(
                 stream,
                 std::move(channel.output),
-                [&](auto close) { return prepare_handlers(close, context); },
+                [&](auto close) { return prepare_handlers(close, context, stream); },
                 error_handler
         );
 
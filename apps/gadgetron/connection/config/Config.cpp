@@ -170,6 +170,8 @@ namespace {
         static pugi::xml_node add_node(const Config::ParallelProcess& parallelProcess, pugi::xml_node & node){
             auto parallel_node = node.append_child("parallelprocess");
             parallel_node.append_attribute("workers").set_value((long long unsigned int)parallelProcess.workers);
+            parallel_node.append_attribute("window").set_value((long long unsigned int)parallelProcess.window);
+            parallel_node.append_attribute("ordered").set_value(parallelProcess.ordered);
             add_node(parallelProcess.stream, parallel_node);
             return parallel_node;
         }
@@ -536,7 +538,9 @@ namespace {
         Config::ParallelProcess parse_parallelprocess(const pugi::xml_node& parallelprocess_node)
         {
             size_t workers = std::stoul(parallelprocess_node.attribute("workers").value());
-            return Config::ParallelProcess{workers,parse_purestream(parallelprocess_node.child("purestream"))};
+            size_t window = parallelprocess_node.attribute("window").as_ullong(0);
+            bool ordered = parallelprocess_node.attribute("ordered").as_bool(true);
+            return Config::ParallelProcess{workers,parse_purestream(parallelprocess_node.child("purestream")),window,ordered};
         }
 
         Config::PureDistributed parse_puredistributed(const pugi::xml_node& puredistributedprocess_node){
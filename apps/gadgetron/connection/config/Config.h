@@ -90,6 +90,8 @@ namespace Gadgetron::Server::Connection {
         struct ParallelProcess {
             size_t workers = 0;
             PureStream stream;
+            size_t window = 0;
+            bool ordered = true;
         };
 
         struct Distributor : Gadget { using Gadget::Gadget;};
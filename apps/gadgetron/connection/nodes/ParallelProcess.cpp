@@ -1,44 +1,126 @@
 #include "ParallelProcess.h"
 
+#include "common/AdaptiveLimit.h"
+
 #include "ThreadPool.h"
 
 using namespace Gadgetron::Core;
 
+namespace {
+
+    size_t pool_size() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Shared by all ParallelProcess nodes of all connections, so several of them do not oversubscribe the CPU.
+    // Never joined or destroyed, as nodes may still be running during static destruction.
+    ThreadPool &shared_pool() {
+        static auto *pool = new ThreadPool(pool_size());
+        return *pool;
+    }
+}
+
 namespace Gadgetron::Server::Connection::Nodes {
 
-    void ParallelProcess::process_input(GenericInputChannel input, Queue &queue) {
+    /// Counts the messages between the input and the output, blocking the input while there are too many
+    class ParallelProcess::Window {
+    public:
+        explicit Window(size_t size) : size(size) {}
 
-        ThreadPool pool(workers ? workers : std::thread::hardware_concurrency());
+        void acquire() {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return in_flight < size || closed; });
+            if (closed) throw ChannelClosed();
+            in_flight++;
+        }
+
+        void release() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                in_flight--;
+            }
+            cv.notify_one();
+        }
 
-        for (auto message : input) {
-            queue.push(
-                pool.async(
-                        [&](auto message) { return pureStream.process_function(std::move(message)); },
+        void close() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                closed = true;
+            }
+            cv.notify_all();
+        }
+
+    private:
+        const size_t size;
+        size_t in_flight = 0;
+        bool closed = false;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    void ParallelProcess::process_input(GenericInputChannel input, Queue &queue, Window &window, AdaptiveLimit &running) {
+
+        auto finish = [&]() { running.wait_idle(); queue.close(); };
+
+        try {
+            for (auto message : input) {
+                window.acquire();
+                running.acquire();
+
+                auto promise = std::make_shared<std::promise<Message>>();
+                if (ordered) queue.push(promise->get_future());
+
+                shared_pool().async(
+                        [&, promise](auto message) {
+                            auto start = std::chrono::steady_clock::now();
+                            try {
+                                promise->set_value(pureStream.process_function(std::move(message)));
+                            } catch (...) {
+                                promise->set_exception(std::current_exception());
+                            }
+                            if (!ordered) queue.push(promise->get_future());
+                            running.release(std::chrono::steady_clock::now() - start);
+                        },
                         std::move(message)
-                )
-            );
+                );
+            }
+        } catch (...) {
+            finish();
+            throw;
         }
 
-        pool.join(); queue.close();
+        finish();
     }
 
-    void ParallelProcess::process_output(OutputChannel output, Queue &queue) {
-        while(true) output.push_message(queue.pop().get());
+    void ParallelProcess::process_output(OutputChannel output, Queue &queue, Window &window) {
+        try {
+            while (true) {
+                output.push_message(queue.pop().get());
+                window.release();
+            }
+        } catch (...) {
+            window.close();
+            throw;
+        }
     }
 
     void ParallelProcess::process(GenericInputChannel input,
             OutputChannel output,
             ErrorHandler& error_handler
     ) {
+        auto max_workers = workers ? workers : pool_size();
+
         Queue queue;
+        Window in_flight(window ? window : 2 * max_workers);
+        AdaptiveLimit running(max_workers, workers == 0);
 
         auto input_thread = error_handler.run(
-                [&](auto input) { this->process_input(std::move(input), queue); },
+                [&](auto input) { this->process_input(std::move(input), queue, in_flight, running); },
                 std::move(input)
         );
 
         auto output_thread = error_handler.run(
-                [&](auto output) { this->process_output(std::move(output), queue); },
+                [&](auto output) { this->process_output(std::move(output), queue, in_flight); },
                 std::move(output)
         );
 
@@ -49,12 +131,15 @@ namespace Gadgetron::Server::Connection::Nodes {
             const Config::ParallelProcess& conf,
             const Context& context,
             Loader& loader
-    ) : pureStream{ conf.stream, context, loader }, workers{ conf.workers } {}
+    ) : workers{ conf.workers }, window{ conf.window }, ordered{ conf.ordered }, pureStream{ conf.stream, context, loader } {}
+
+    ParallelProcess::ParallelProcess(
+            const Config::ParallelProcess& conf,
+            std::vector<std::unique_ptr<GenericPureGadget>> pure_gadgets
+    ) : workers{ conf.workers }, window{ conf.window }, ordered{ conf.ordered }, pureStream{ std::move(pure_gadgets) } {}
 
     const std::string& ParallelProcess::name() {
         const static std::string n = "ParallelProcess";
         return n;
     }
 }
-
-
@@ -6,20 +6,36 @@
 #include <future>
 
 namespace Gadgetron::Server::Connection::Nodes {
+
+    class AdaptiveLimit;
+
+    /**
+     * Runs a PureStream on the messages in parallel, on a thread pool shared by all ParallelProcess nodes.
+     *
+     * At most 'window' messages are in flight between the input and the output; the input waits while the window is
+     * full. With a number of workers, as many messages run at a time; with none, the number adapts to the latency of
+     * the messages and to the other ParallelProcess nodes running. Messages leave in the order they came in, unless
+     * 'ordered' is false, in which case they leave as they are done.
+     */
     class ParallelProcess : public Processable {
 
     public:
         ParallelProcess(const Config::ParallelProcess& conf, const Core::Context& context, Loader& loader);
+        /// Runs the given pure gadgets rather than loading the stream of conf
+        ParallelProcess(const Config::ParallelProcess& conf, std::vector<std::unique_ptr<Core::GenericPureGadget>> pure_gadgets);
         void process(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler& error_handler) override;
         const std::string& name() override;
     private:
 
         using Queue = Core::MPMCChannel<std::future<Core::Message>>;
+        class Window;
 
-        void process_input(Core::GenericInputChannel input, Queue &queue);
-        void process_output(Core::OutputChannel output, Queue &queue);
+        void process_input(Core::GenericInputChannel input, Queue &queue, Window &window, AdaptiveLimit &running);
+        void process_output(Core::OutputChannel output, Queue &queue, Window &window);
 
         const size_t workers;
+        const size_t window;
+        const bool ordered;
         const PureStream pureStream;
     };
 }
@@ -36,6 +36,10 @@ Gadgetron::Server::Connection::Nodes::PureStream::PureStream(
     Loader& loader
 ) : pure_gadgets{ load_pure_gadgets(conf.gadgets, context, loader) } {}
 
+Gadgetron::Server::Connection::Nodes::PureStream::PureStream(
+    std::vector<std::unique_ptr<Gadgetron::Core::GenericPureGadget>> pure_gadgets
+) : pure_gadgets{ std::move(pure_gadgets) } {}
+
 Gadgetron::Core::Message Gadgetron::Server::Connection::Nodes::PureStream::process_function(
     Gadgetron::Core::Message message
 ) const {
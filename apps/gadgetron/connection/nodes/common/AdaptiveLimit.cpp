@@ -0,0 +1,90 @@
+#include "AdaptiveLimit.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+    // The adaptive limits alive in the process, which share the pool between them
+    std::atomic<size_t> adaptive_limits{0};
+
+    // The limit is reconsidered after this many items, or twice the limit if that is more
+    constexpr size_t minimum_samples = 8;
+
+    // Changes of capacity within this fraction, or within half of what one step makes, are taken as no change
+    constexpr double tolerance = 0.05;
+}
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    AdaptiveLimit::AdaptiveLimit(size_t maximum, bool adaptive) : maximum(std::max<size_t>(maximum, 1)), adaptive(adaptive) {
+        if (adaptive) adaptive_limits++;
+        current = adaptive ? fair_share() : this->maximum;
+    }
+
+    AdaptiveLimit::~AdaptiveLimit() {
+        if (adaptive) adaptive_limits--;
+    }
+
+    void AdaptiveLimit::acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return running < current; });
+        running++;
+    }
+
+    void AdaptiveLimit::release(std::chrono::steady_clock::duration latency) {
+        // Notifies under the lock, as the limit may be destroyed as soon as wait_idle returns
+        std::lock_guard<std::mutex> guard(mutex);
+        running--;
+        if (adaptive) {
+            samples++;
+            total_latency += latency;
+            adapt();
+        }
+        cv.notify_all();
+    }
+
+    void AdaptiveLimit::wait_idle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return running == 0; });
+    }
+
+    size_t AdaptiveLimit::limit() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return current;
+    }
+
+    size_t AdaptiveLimit::fair_share() const {
+        return std::max<size_t>(1, maximum / std::max<size_t>(1, adaptive_limits.load()));
+    }
+
+    void AdaptiveLimit::adapt() {
+        auto share = fair_share();
+        if (samples < std::max(minimum_samples, 2 * current)) {
+            current = std::min(current, share);
+            return;
+        }
+
+        auto mean_latency = std::max(total_latency.count() / samples, 1e-9);
+        auto capacity = current / mean_latency;
+
+        // If the items scale, one step changes the capacity by about 1 / current
+        auto unchanged = std::min(tolerance, 0.5 / current);
+
+        if (capacity < last_capacity * (1 - unchanged)) {
+            // After a step down, the limit above is known to be better
+            confirmed = step < 0;
+            step = -step;
+        } else if (capacity < last_capacity * (1 + unchanged)) {
+            // Held at the fair share, which was found better than the limit below, as long as the capacity holds
+            if (!(confirmed && step > 0 && current >= share)) {
+                step = -1;
+                confirmed = false;
+            }
+        }
+
+        last_capacity = capacity;
+        current = size_t(std::clamp<long long>((long long)current + step, 1, (long long)share));
+        samples = 0;
+        total_latency = std::chrono::duration<double>(0);
+    }
+}
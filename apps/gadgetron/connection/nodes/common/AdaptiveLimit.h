@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    /**
+     * Limits how many items of one node run at a time on a thread pool shared by all nodes and connections.
+     *
+     * A fixed limit stays as given. An adaptive limit starts at the fair share of the pool, which is the pool size
+     * divided by the number of adaptive limits alive in the process, and then follows the measured latency of the
+     * items: it keeps moving in a direction while the items per second it can sustain (limit / mean latency) improve,
+     * turns back when they get worse, and steps down when they stay the same. It never exceeds the fair share, so it
+     * shrinks as more connections run ParallelProcess nodes. Once the step below the fair share has been found worse,
+     * the limit stays at the share until the capacity falls.
+     */
+    class AdaptiveLimit {
+    public:
+        AdaptiveLimit(size_t maximum, bool adaptive);
+        ~AdaptiveLimit();
+
+        AdaptiveLimit(const AdaptiveLimit&) = delete;
+        AdaptiveLimit& operator=(const AdaptiveLimit&) = delete;
+
+        /// Blocks until fewer than limit() items are running, and counts one more
+        void acquire();
+
+        /// Counts one item less, which ran for latency
+        void release(std::chrono::steady_clock::duration latency);
+
+        /// Blocks until no items are running
+        void wait_idle();
+
+        size_t limit() const;
+
+    private:
+        void adapt();
+        size_t fair_share() const;
+
+        const size_t maximum;
+        const bool adaptive;
+
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        size_t running = 0;
+        size_t current;
+
+        size_t samples = 0;
+        std::chrono::duration<double> total_latency{0};
+        double last_capacity = 0;
+        int step = 1;
+        bool confirmed = false;
+    };
+}
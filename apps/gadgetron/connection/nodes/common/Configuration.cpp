@@ -4,6 +4,7 @@
 #include <ismrmrd/ismrmrd.h>
 
 #include "io/primitives.h"
+#include "io/ismrmrd_meta.h"
 #include "MessageID.h"
 
 using namespace Gadgetron::Core;
@@ -30,7 +31,25 @@ namespace Gadgetron::Server::Connection::Nodes {
         );
     }
 
+    // Gadgetron peers that answer the query take binary meta attributes; others answer "Unknown query".
+    static void negotiate_meta_encoding(std::iostream &stream) {
+        IO::write(stream, QUERY);
+        IO::write(stream, uint64_t(0)); // Reserved
+        IO::write(stream, uint64_t(0)); // Correlation id
+        IO::write_string_to_stream<uint64_t>(stream, "gadgetron::meta::binary");
+        stream.flush();
+
+        auto id = IO::read<uint16_t>(stream);
+        if (id != RESPONSE) throw std::runtime_error("Unexpected message id in response to query: " + std::to_string(id));
+
+        IO::read<uint64_t>(stream);
+        if (IO::read_string_from_stream<uint64_t>(stream) == "1") {
+            IO::set_meta_encoding(stream, IO::MetaEncoding::binary);
+        }
+    }
+
     void Configuration::send(std::iostream &stream) const {
+        if (Core::holds_alternative<Config>(config)) negotiate_meta_encoding(stream);
         send_config(stream, config);
         send_header(stream, context.header);
     }
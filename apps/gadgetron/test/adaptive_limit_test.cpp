@@ -0,0 +1,77 @@
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../connection/nodes/common/AdaptiveLimit.h"
+
+using namespace Gadgetron::Server::Connection::Nodes;
+using namespace std::chrono_literals;
+
+namespace {
+
+    // Runs batches of as many items as the limit allows, each taking latency(limit). Returns the final limit.
+    template<class LATENCY>
+    size_t run_batches(AdaptiveLimit& limit, size_t batches, LATENCY latency) {
+        for (size_t batch = 0; batch < batches; batch++) {
+            auto count = limit.limit();
+            for (size_t i = 0; i < count; i++) limit.acquire();
+            for (size_t i = 0; i < count; i++) limit.release(latency(count));
+        }
+        return limit.limit();
+    }
+}
+
+TEST(AdaptiveLimitTest, fixed_limit_blocks_when_full) {
+    AdaptiveLimit limit(2, false);
+    limit.acquire();
+    limit.acquire();
+
+    auto third = std::async(std::launch::async, [&]() { limit.acquire(); });
+    EXPECT_EQ(third.wait_for(50ms), std::future_status::timeout);
+
+    limit.release(1ms);
+    EXPECT_EQ(third.wait_for(5s), std::future_status::ready);
+
+    limit.release(1ms);
+    limit.release(1ms);
+    limit.wait_idle();
+    EXPECT_EQ(limit.limit(), 2);
+}
+
+TEST(AdaptiveLimitTest, backs_off_when_latency_grows_with_the_limit) {
+    AdaptiveLimit limit(16, true);
+    EXPECT_EQ(limit.limit(), 16);
+
+    // Saturated: twice the items take twice as long, so more running gains nothing
+    auto saturated = run_batches(limit, 200, [](size_t count) { return count * 1ms; });
+    EXPECT_LE(saturated, 4);
+}
+
+TEST(AdaptiveLimitTest, stays_at_the_share_when_items_scale) {
+    AdaptiveLimit limit(16, true);
+
+    // Not saturated: the latency does not depend on how many items run. After one step down to find that out,
+    // the limit stays at the share instead of going back and forth.
+    auto scaling = [](size_t) { return 1ms; };
+    EXPECT_EQ(run_batches(limit, 20, scaling), 16);
+    for (size_t batch = 0; batch < 200; batch++) {
+        ASSERT_EQ(run_batches(limit, 1, scaling), 16) << batch;
+    }
+
+    // When the items saturate later on, the limit comes down from the share
+    auto saturated = run_batches(limit, 200, [](size_t count) { return count * 1ms; });
+    EXPECT_LE(saturated, 4);
+}
+
+TEST(AdaptiveLimitTest, shares_the_pool_between_limits) {
+    AdaptiveLimit first(16, true);
+    {
+        AdaptiveLimit second(16, true);
+        EXPECT_EQ(second.limit(), 8);
+
+        run_batches(first, 10, [](size_t) { return 1ms; });
+        EXPECT_LE(first.limit(), 8);
+    }
+}
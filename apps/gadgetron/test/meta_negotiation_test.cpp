@@ -0,0 +1,160 @@
+#include <future>
+
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+
+#include "../connection/Handlers.h"
+#include "../connection/SocketStreamBuf.h"
+#include "../connection/Writers.h"
+#include "../connection/nodes/common/ExternalChannel.h"
+
+#include "MessageID.h"
+#include "io/ismrmrd_meta.h"
+#include "readers/ImageReader.h"
+#include "writers/ImageWriter.h"
+
+namespace ba = boost::asio;
+using tcp    = boost::asio::ip::tcp;
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection;
+using namespace Gadgetron::Server::Connection::Nodes;
+
+namespace {
+
+    // The part of a Gadgetron server a distributed node talks to: queries are answered and the config and header
+    // are taken as in the config phase, after which every image is sent back until the node closes the connection.
+    // A peer that does not negotiate answers the meta encoding query as servers without it do.
+    void serve(std::iostream& stream, bool negotiates) {
+        auto queries = negotiates ? Handlers::QueryHandler(stream) : Handlers::QueryHandler();
+        auto responses = make_channel<MessageChannel>();
+        Server::Connection::Writers::ResponseWriter response_writer;
+
+        auto reader = Core::Readers::ImageReader();
+        auto writer = Core::Writers::ImageWriter();
+
+        while (true) {
+            auto id = IO::read<uint16_t>(stream);
+            switch (id) {
+            case QUERY:
+                queries.handle(stream, responses.output);
+                response_writer.write(stream, responses.input.pop());
+                stream.flush();
+                break;
+            case CONFIG:
+                IO::read_string_from_stream<uint32_t>(stream);
+                break;
+            case HEADER:
+                IO::read_string_from_stream<uint32_t>(stream);
+                break;
+            case GADGET_MESSAGE_ISMRMRD_IMAGE:
+                writer.write(stream, reader.read(stream));
+                stream.flush();
+                break;
+            case CLOSE:
+                IO::write(stream, CLOSE);
+                stream.flush();
+                return;
+            default:
+                throw std::runtime_error("Unexpected message id: " + std::to_string(id));
+            }
+        }
+    }
+
+    std::shared_ptr<Serialization> image_serialization() {
+        Serialization::Readers readers;
+        readers[GADGET_MESSAGE_ISMRMRD_IMAGE] = std::make_unique<Core::Readers::ImageReader>();
+        Serialization::Writers writers;
+        writers.push_back(std::make_unique<Core::Writers::ImageWriter>());
+        return std::make_shared<Serialization>(std::move(readers), std::move(writers));
+    }
+
+    std::shared_ptr<Configuration> distributed_configuration() {
+        auto context = StreamContext(ISMRMRD::IsmrmrdHeader{}, {}, {}, {}, {});
+        return std::make_shared<Configuration>(context, Config{});
+    }
+
+    ISMRMRD::MetaContainer generate_meta(long number) {
+        auto meta = ISMRMRD::MetaContainer();
+        meta.set("GADGETRON_DataRole", "Image");
+        meta.append("GADGETRON_ImageComment", "GT");
+        meta.append("GADGETRON_ImageComment", "PHS");
+        meta.set("GADGETRON_ImageNumber", number);
+        meta.set("GADGETRON_WindowCenter", 1.25);
+        meta.set("GADGETRON_SeriesDescription", "");
+        return meta;
+    }
+
+    void expect_equal_meta(const ISMRMRD::MetaContainer& expected, const ISMRMRD::MetaContainer& meta) {
+        for (const auto& [name, values] : expected) {
+            ASSERT_EQ(meta.length(name.c_str()), values.size()) << name;
+            for (size_t i = 0; i < values.size(); i++) {
+                EXPECT_STREQ(meta.as_str(name.c_str(), i), values[i].as_str()) << name;
+            }
+        }
+    }
+}
+
+class MetaNegotiationTest : public ::testing::TestWithParam<bool> {
+public:
+    MetaNegotiationTest() {
+        auto endpoint = tcp::endpoint(tcp::v6(), 0);
+        acceptor = std::make_unique<tcp::acceptor>(ios, endpoint);
+    }
+
+    // Sends three images with meta attributes through a distributed node's channel to a peer and back
+    void round_trip(bool negotiates) {
+        auto port = acceptor->local_endpoint().port();
+        auto peer = std::async(std::launch::async, [&]() {
+            auto socket = std::make_unique<tcp::socket>(ios);
+            acceptor->accept(*socket);
+            auto stream = Gadgetron::Connection::stream_from_socket(std::move(socket));
+            serve(*stream, negotiates);
+            return IO::meta_encoding(*stream);
+        });
+
+        auto channel = ExternalChannel(
+                Gadgetron::Connection::remote_stream("localhost", std::to_string(port)),
+                image_serialization(),
+                distributed_configuration()
+        );
+
+        auto header = ISMRMRD::ImageHeader{};
+        header.matrix_size[0] = 8;
+        header.matrix_size[1] = 8;
+        header.matrix_size[2] = 1;
+        header.channels       = 1;
+        auto data = hoNDArray<float>(8, 8, 1, 1);
+        std::fill(data.begin(), data.end(), 42.0f);
+
+        for (long n = 0; n < 3; n++) channel.push_message(Message(header, data, generate_meta(n)));
+        channel.close();
+
+        for (long n = 0; n < 3; n++) {
+            auto image = unpack<Image<float>>(channel.pop());
+            ASSERT_TRUE(bool(image));
+            auto& [read_header, read_data, read_meta] = *image;
+            EXPECT_EQ(read_data, data);
+            ASSERT_TRUE(bool(read_meta));
+            expect_equal_meta(generate_meta(n), *read_meta);
+        }
+        EXPECT_THROW(channel.pop(), ChannelClosed);
+
+        ASSERT_EQ(peer.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+        encoding = peer.get();
+    }
+
+    ba::io_service ios{};
+    std::unique_ptr<tcp::acceptor> acceptor;
+    IO::MetaEncoding encoding = IO::MetaEncoding::xml;
+};
+
+TEST_P(MetaNegotiationTest, images_round_trip) {
+    bool negotiates = GetParam();
+    round_trip(negotiates);
+
+    // Peers answering the query take binary meta attributes, older peers keep XML
+    EXPECT_EQ(encoding, negotiates ? IO::MetaEncoding::binary : IO::MetaEncoding::xml);
+}
+
+INSTANTIATE_TEST_SUITE_P(Peers, MetaNegotiationTest, ::testing::Values(true, false));
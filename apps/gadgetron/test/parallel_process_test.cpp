@@ -0,0 +1,194 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../connection/nodes/ParallelProcess.h"
+#include "PureGadget.h"
+
+using namespace Gadgetron;
+using namespace Gadgetron::Server::Connection;
+using namespace Gadgetron::Server::Connection::Nodes;
+using namespace std::chrono_literals;
+
+namespace {
+
+    // Shared between the test and the copies of the gadget: how many items started and run, and a gate they wait at
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool open = true;
+        size_t started = 0;
+
+        void set(bool is_open) {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                open = is_open;
+            }
+            cv.notify_all();
+        }
+
+        size_t started_items() {
+            std::lock_guard<std::mutex> guard(mutex);
+            return started;
+        }
+    };
+
+    // Waits at the gate, then sleeps for as many milliseconds as the message says
+    class Sleeper : public Core::PureGadget<int, int> {
+    public:
+        explicit Sleeper(std::shared_ptr<Gate> gate) : Core::PureGadget<int, int>(Core::Context{}, {}), gate(std::move(gate)) {}
+
+        int process_function(int milliseconds) const override {
+            {
+                std::unique_lock<std::mutex> lock(gate->mutex);
+                gate->started++;
+                gate->cv.wait(lock, [&]() { return gate->open; });
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+            return milliseconds;
+        }
+
+    private:
+        std::shared_ptr<Gate> gate;
+    };
+
+    class RecordingReporter : public ErrorReporter {
+    public:
+        void operator()(const std::string& location, const std::string& message) override {
+            std::lock_guard<std::mutex> guard(mutex);
+            errors.push_back(location + ": " + message);
+        }
+
+        std::mutex mutex;
+        std::vector<std::string> errors;
+    };
+
+    struct Harness {
+        Harness(size_t workers, size_t window, bool ordered, std::shared_ptr<Gate> gate)
+            : node(config(workers, window, ordered), gadgets(std::move(gate))) {}
+
+        // Starts the node on the messages; the input is closed after the last one
+        std::future<void> start(const std::vector<int>& messages) {
+            auto input = Core::make_channel();
+            for (auto message : messages) input.output.push(message);
+            { auto closer = std::move(input.output); }
+
+            auto output = Core::make_channel();
+            results = std::make_unique<Core::GenericInputChannel>(std::move(output.input));
+
+            return std::async(std::launch::async, [this](auto input, auto output) {
+                node.process(std::move(input), std::move(output), handler);
+            }, std::move(input.input), std::move(output.output));
+        }
+
+        std::vector<int> collect() {
+            std::vector<int> values;
+            try {
+                while (true) values.push_back(Core::force_unpack<int>(results->pop()));
+            } catch (const Core::ChannelClosed&) {}
+            return values;
+        }
+
+        static Config::ParallelProcess config(size_t workers, size_t window, bool ordered) {
+            Config::ParallelProcess conf;
+            conf.workers = workers;
+            conf.window = window;
+            conf.ordered = ordered;
+            return conf;
+        }
+
+        static std::vector<std::unique_ptr<Core::GenericPureGadget>> gadgets(std::shared_ptr<Gate> gate) {
+            std::vector<std::unique_ptr<Core::GenericPureGadget>> result;
+            result.push_back(std::make_unique<Sleeper>(std::move(gate)));
+            return result;
+        }
+
+        RecordingReporter reporter;
+        ErrorHandler handler{ reporter, "ParallelProcessTest" };
+        ParallelProcess node;
+        std::unique_ptr<Core::GenericInputChannel> results;
+    };
+
+    // The tests run two items at a time on the shared pool
+    bool pool_too_small() {
+        return std::thread::hardware_concurrency() < 2;
+    }
+
+    bool wait_for(std::function<bool()> condition) {
+        auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(1ms);
+        }
+        return true;
+    }
+}
+
+TEST(ParallelProcessTest, window_blocks_the_input) {
+    if (pool_too_small()) GTEST_SKIP();
+
+    auto gate = std::make_shared<Gate>();
+    gate->set(false);
+
+    // Four workers, but only two messages may be in flight
+    Harness node(4, 2, true, gate);
+    auto done = node.start({ 1, 2, 3, 4, 5, 6 });
+
+    // The gate is opened before checking, so a failure does not leave the node hanging
+    EXPECT_TRUE(wait_for([&]() { return gate->started_items() == 2; }));
+    std::this_thread::sleep_for(100ms);
+    auto started = gate->started_items();
+    gate->set(true);
+    EXPECT_EQ(started, 2);
+
+    EXPECT_EQ(node.collect(), std::vector<int>({ 1, 2, 3, 4, 5, 6 }));
+    ASSERT_EQ(done.wait_for(5s), std::future_status::ready);
+    EXPECT_EQ(gate->started_items(), 6);
+    EXPECT_TRUE(node.reporter.errors.empty());
+}
+
+TEST(ParallelProcessTest, ordered_keeps_the_input_order) {
+    if (pool_too_small()) GTEST_SKIP();
+
+    Harness node(2, 4, true, std::make_shared<Gate>());
+    auto done = node.start({ 300, 0 });
+
+    EXPECT_EQ(node.collect(), std::vector<int>({ 300, 0 }));
+    ASSERT_EQ(done.wait_for(5s), std::future_status::ready);
+}
+
+TEST(ParallelProcessTest, unordered_releases_messages_as_they_complete) {
+    if (pool_too_small()) GTEST_SKIP();
+
+    Harness node(2, 4, false, std::make_shared<Gate>());
+    auto done = node.start({ 300, 0 });
+
+    EXPECT_EQ(node.collect(), std::vector<int>({ 0, 300 }));
+    ASSERT_EQ(done.wait_for(5s), std::future_status::ready);
+}
+
+TEST(ParallelProcessTest, output_failure_does_not_deadlock) {
+    if (pool_too_small()) GTEST_SKIP();
+
+    for (bool ordered : { true, false }) {
+        auto gate = std::make_shared<Gate>();
+        gate->set(false);
+
+        Harness node(2, 2, ordered, gate);
+        auto done = node.start(std::vector<int>(20, 5));
+
+        // The window is full and the items wait at the gate when the output goes away
+        EXPECT_TRUE(wait_for([&]() { return gate->started_items() == 2; })) << ordered;
+        node.results.reset();
+        gate->set(true);
+
+        ASSERT_EQ(done.wait_for(5s), std::future_status::ready) << ordered;
+        EXPECT_LE(gate->started_items(), 4) << ordered;
+    }
+}
@@ -28,6 +28,14 @@ namespace Gadgetron::Core {
        channel.close();
     }
 
+    bool MessageChannel::drained() {
+        return channel.drained();
+    }
+
+    void MessageChannel::listen(std::shared_ptr<ChannelSignal> signal, size_t index) {
+        channel.listen(std::move(signal), index);
+    }
+
     Message GenericInputChannel::pop() {
         return channel->pop();
     }
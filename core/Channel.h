@@ -13,6 +13,7 @@
 
 namespace Gadgetron { namespace Core {
     class GenericInputChannel;
+    class ChannelSelector;
 
     class OutputChannel;
     struct ChannelPair;
@@ -23,6 +24,7 @@ namespace Gadgetron { namespace Core {
 
         friend GenericInputChannel;
         friend OutputChannel;
+        friend ChannelSelector;
 
     protected:
         virtual Message pop() = 0;
@@ -33,6 +35,10 @@ namespace Gadgetron { namespace Core {
 
         virtual void close() = 0;
 
+        virtual bool drained() = 0;
+
+        virtual void listen(std::shared_ptr<ChannelSignal> signal, size_t index) = 0;
+
         class Closer;
     };
 
@@ -96,6 +102,8 @@ namespace Gadgetron { namespace Core {
 
         friend GenericInputChannel split(const GenericInputChannel& channel);
 
+        friend ChannelSelector;
+
         explicit GenericInputChannel(std::shared_ptr<Channel>);
 
         std::shared_ptr<Channel> channel;
@@ -119,6 +127,10 @@ namespace Gadgetron { namespace Core {
 
         void push_message(Message) override;
 
+        bool drained() override;
+
+        void listen(std::shared_ptr<ChannelSignal> signal, size_t index) override;
+
         MPMCChannel<Message> channel;
     };
 
@@ -0,0 +1,54 @@
+#include "ChannelSelector.h"
+
+namespace Gadgetron::Core {
+
+    ChannelSelector::ChannelSelector(std::vector<GenericInputChannel> input)
+        : channels(std::move(input)), opened(channels.size(), true), open_channels(channels.size()),
+          signal(std::make_shared<ChannelSignal>(channels.size())) {
+        for (size_t index = 0; index < channels.size(); index++) channels[index].channel->listen(signal, index);
+    }
+
+    size_t ChannelSelector::size() const {
+        return channels.size();
+    }
+
+    bool ChannelSelector::is_open(size_t index) const {
+        return opened[index];
+    }
+
+    size_t ChannelSelector::open() const {
+        return open_channels;
+    }
+
+    optional<Message> ChannelSelector::try_pop(size_t index) {
+        if (!opened[index] || !signal->take(index)) return none;
+
+        auto message = channels[index].try_pop();
+        if (message) {
+            // There may be more; the channel stays ready until it is found empty
+            signal->mark(index);
+            return message;
+        }
+
+        if (channels[index].channel->drained()) {
+            opened[index] = false;
+            open_channels--;
+        }
+        return none;
+    }
+
+    std::pair<size_t, Message> ChannelSelector::pop(size_t first) {
+        while (open_channels) {
+            for (size_t i = 0; i < channels.size(); i++) {
+                auto index = (first + i) % channels.size();
+                if (auto message = try_pop(index)) return { index, std::move(*message) };
+            }
+            wait();
+        }
+        throw ChannelClosed();
+    }
+
+    void ChannelSelector::wait() {
+        if (open_channels) events = signal->wait(events);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Channel.h"
+
+namespace Gadgetron::Core {
+
+    /**
+     * Reads from several input channels on a single thread. The selector sleeps until one of its channels is pushed to
+     * or closed, and then only looks at the channels which changed, so no thread is needed per channel.
+     */
+    class ChannelSelector {
+    public:
+        explicit ChannelSelector(std::vector<GenericInputChannel> channels);
+
+        size_t size() const;
+
+        /// True until channel index is closed and all its messages have been taken
+        bool is_open(size_t index) const;
+
+        /// The number of open channels
+        size_t open() const;
+
+        /// Takes a message from channel index if one is ready. Does not block.
+        optional<Message> try_pop(size_t index);
+
+        /// Blocks until a channel has a message, looking at the channels in order from first. Returns the index of the
+        /// channel and the message. Throws ChannelClosed once all channels are closed and drained.
+        std::pair<size_t, Message> pop(size_t first = 0);
+
+        /// Blocks until a channel has changed since the last call to wait. Returns immediately if no channel is open.
+        void wait();
+
+    private:
+        std::vector<GenericInputChannel> channels;
+        std::vector<bool> opened;
+        size_t open_channels;
+        std::shared_ptr<ChannelSignal> signal;
+        size_t events = 0;
+    };
+}
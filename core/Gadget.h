@@ -105,7 +105,7 @@ namespace Gadgetron {
 
     private:
         static Core::Message to_message(GadgetContainerMessageBase *message) {
-            std::vector<std::unique_ptr<Core::MessageChunk>> messages;
+            Core::MessageChunks messages;
             auto *current_message = message;
             while (current_message) {
                 messages.emplace_back(current_message->take_message());
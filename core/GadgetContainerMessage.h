@@ -13,6 +13,9 @@ namespace Gadgetron {
     public:
         virtual std::unique_ptr<Core::MessageChunk> take_message() = 0;
         virtual ~GadgetContainerMessageBase() = default;
+
+        static void* operator new(size_t size) { return Core::MessagePool::allocate(size); }
+        static void operator delete(void* ptr, size_t size) noexcept { Core::MessagePool::deallocate(ptr, size); }
     };
 
 
@@ -28,6 +31,11 @@ namespace Gadgetron {
             data = &message->data;
         }
 
+        /// Takes over the chunk of a Core::Message, without copying or moving the data
+        explicit GadgetContainerMessage(std::unique_ptr<Core::TypedMessageChunk<T>> chunk) : message(std::move(chunk)) {
+            data = &message->data;
+        }
+
          ~GadgetContainerMessage() override = default;
 
         std::unique_ptr<Core::MessageChunk> take_message() override {
@@ -1,12 +1,44 @@
 #pragma once
 
 #include "Types.h"
+#include <atomic>
 #include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace Gadgetron::Core {
 
+    /**
+     * Lets a single thread wait on several channels at once, like epoll on a set of sockets. Each channel listening to
+     * the signal marks itself ready when it is pushed to or closed; the waiter takes the ready marks and sleeps only
+     * when there are none. Producers take the lock of the signal only while the waiter sleeps.
+     */
+    class ChannelSignal {
+    public:
+        explicit ChannelSignal(size_t channels) : ready(channels) {}
+
+        /// Marks channel index ready and wakes the waiter
+        void notify(size_t index);
+
+        /// Clears the ready mark of channel index, returning whether it was set
+        bool take(size_t index) { return ready[index].exchange(false); }
+
+        /// Sets the ready mark of channel index, without waking the waiter
+        void mark(size_t index) { ready[index].store(true); }
+
+        /// Blocks until a channel has been notified since the waiter last saw the event count seen. Returns the new count.
+        size_t wait(size_t seen);
+
+    private:
+        std::vector<std::atomic<bool>> ready;
+        std::atomic<size_t> events{0};
+        std::atomic<bool> waiting{false};
+        std::mutex m;
+        std::condition_variable cv;
+    };
+
     template <class T> class MPMCChannel {
     public:
         MPMCChannel() = default;
@@ -20,12 +52,22 @@ namespace Gadgetron::Core {
 
         void close();
 
+        /// True once the channel is closed and empty. A drained channel stays drained.
+        bool drained();
+
+        /// Notifies signal, as channel index, whenever a message is pushed or the channel is closed
+        void listen(std::shared_ptr<ChannelSignal> signal, size_t index);
+
     private:
         T pop_impl(std::unique_lock<std::mutex> lock);
         std::list<T> queue;
         bool is_closed = false;
         std::mutex m;
         std::condition_variable cv;
+        std::shared_ptr<ChannelSignal> signal;
+        size_t signal_index = 0;
+
+        void notify_signal(ChannelSignal* listener) const;
     };
 
     class ChannelClosed : public std::runtime_error {
@@ -35,6 +77,28 @@ namespace Gadgetron::Core {
 
     /** Implementation **/
 
+    inline void ChannelSignal::notify(size_t index) {
+        ready[index].store(true);
+        events.fetch_add(1);
+        // Pairs with the store to waiting in wait; either the waiter sees the new count, or we see it waiting
+        if (waiting.load()) {
+            std::lock_guard<std::mutex> guard(m);
+            cv.notify_one();
+        }
+    }
+
+    inline size_t ChannelSignal::wait(size_t seen) {
+        std::unique_lock<std::mutex> lock(m);
+        waiting.store(true);
+        cv.wait(lock, [&]() { return events.load() != seen; });
+        waiting.store(false);
+        return events.load();
+    }
+
+    template <class T> void MPMCChannel<T>::notify_signal(ChannelSignal* listener) const {
+        if (listener) listener->notify(signal_index);
+    }
+
     template <class T> T MPMCChannel<T>::pop_impl(std::unique_lock<std::mutex> lock) {
         cv.wait(lock, [this]() { return !this->queue.empty() || is_closed; });
         if (queue.empty()) {
@@ -59,29 +123,53 @@ namespace Gadgetron::Core {
     }
 
     template <class T> void MPMCChannel<T>::push(T message) {
+        ChannelSignal* listener;
         {
             std::lock_guard<std::mutex> lock(m);
             if (is_closed)
                 throw ChannelClosed();
             queue.emplace_back(std::move(message));
+            listener = signal.get();
         }
         cv.notify_one();
+        notify_signal(listener);
     }
 
     template <class T> void MPMCChannel<T>::close() {
+        ChannelSignal* listener;
         {
             std::lock_guard<std::mutex> lock(m);
             is_closed = true;
+            listener = signal.get();
         }
         cv.notify_all();
+        notify_signal(listener);
+    }
+
+    template <class T> bool MPMCChannel<T>::drained() {
+        std::lock_guard<std::mutex> lock(m);
+        return is_closed && queue.empty();
+    }
+
+    template <class T> void MPMCChannel<T>::listen(std::shared_ptr<ChannelSignal> listener, size_t index) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            signal = std::move(listener);
+            signal_index = index;
+        }
+        // Whatever arrived before is picked up by the first look at the channel
+        notify_signal(signal.get());
     }
 
     template <class T> template <class... ARGS> void MPMCChannel<T>::emplace(ARGS&&... args) {
+        ChannelSignal* listener;
         {
             std::lock_guard<std::mutex> guard(m);
             queue.emplace_back(std::forward<ARGS>(args)...);
+            listener = signal.get();
         }
         cv.notify_one();
+        notify_signal(listener);
     }
     template <class T> MPMCChannel<T>::MPMCChannel(MPMCChannel&& other) noexcept {
         std::lock_guard<std::mutex> guard(other.m);
@@ -1,38 +1,155 @@
 #include "Message.h"
 #include "GadgetContainerMessage.h"
 
+#include <mutex>
+
+namespace {
+    namespace MessagePoolDetail {
+
+        // blocks are handed out in multiples of the granularity, larger requests go to operator new
+        constexpr size_t granularity = 64;
+        constexpr size_t size_classes = 16;
+        constexpr size_t max_size = granularity * size_classes;
+
+        // blocks move between the thread caches and the depot in batches
+        constexpr size_t batch = 32;
+        constexpr size_t thread_capacity = 2 * batch;
+        constexpr size_t depot_capacity = 64 * 1024;
+
+        size_t size_class(size_t size) {
+            return (size + granularity - 1) / granularity - 1;
+        }
+
+        struct Depot {
+            std::mutex mutex;
+            std::vector<void*> blocks[size_classes];
+        };
+
+        // never destroyed, as chunks may be freed during static destruction
+        Depot& depot() {
+            static Depot* depot = new Depot;
+            return *depot;
+        }
+
+        void return_to_depot(void** blocks, size_t count, size_t cls) {
+            auto& d = depot();
+            std::lock_guard<std::mutex> guard(d.mutex);
+            auto& list = d.blocks[cls];
+            for (size_t i = 0; i < count; i++) {
+                if (list.size() < depot_capacity)
+                    list.push_back(blocks[i]);
+                else
+                    ::operator delete(blocks[i]);
+            }
+        }
+
+        size_t take_from_depot(void** blocks, size_t count, size_t cls) {
+            auto& d = depot();
+            std::lock_guard<std::mutex> guard(d.mutex);
+            auto& list = d.blocks[cls];
+            size_t taken = std::min(count, list.size());
+            std::copy(list.end() - taken, list.end(), blocks);
+            list.resize(list.size() - taken);
+            return taken;
+        }
+
+        struct ThreadCache {
+            void* blocks[size_classes][thread_capacity];
+            size_t count[size_classes] = {};
+
+            ~ThreadCache();
+        };
+
+        // the cache of the thread, which is null before it is made and after it is destroyed
+        thread_local ThreadCache* cache = nullptr;
+        thread_local bool cache_destroyed = false;
+
+        ThreadCache::~ThreadCache() {
+            for (size_t cls = 0; cls < size_classes; cls++) return_to_depot(blocks[cls], count[cls], cls);
+            cache = nullptr;
+            cache_destroyed = true;
+        }
+
+        ThreadCache* thread_cache() {
+            if (!cache && !cache_destroyed) {
+                static thread_local ThreadCache owner;
+                cache = &owner;
+            }
+            return cache;
+        }
+    }
+}
+
+void* Gadgetron::Core::MessagePool::allocate(size_t size) {
+    using namespace MessagePoolDetail;
+    if (size > max_size) return ::operator new(size);
+
+    size_t cls = size_class(size);
+    if (auto* c = thread_cache()) {
+        if (c->count[cls] == 0) c->count[cls] = take_from_depot(c->blocks[cls], batch, cls);
+        if (c->count[cls] > 0) return c->blocks[cls][--c->count[cls]];
+    }
+    return ::operator new((cls + 1) * granularity);
+}
+
+void Gadgetron::Core::MessagePool::deallocate(void* ptr, size_t size) noexcept {
+    using namespace MessagePoolDetail;
+    if (!ptr) return;
+    if (size > max_size) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    size_t cls = size_class(size);
+    auto* c = thread_cache();
+    if (!c) {
+        return_to_depot(&ptr, 1, cls);
+        return;
+    }
+
+    if (c->count[cls] == thread_capacity) {
+        c->count[cls] -= batch;
+        return_to_depot(c->blocks[cls] + c->count[cls], batch, cls);
+    }
+    c->blocks[cls][c->count[cls]++] = ptr;
+}
+
 Gadgetron::GadgetContainerMessageBase* Gadgetron::Core::Message::to_container_message() {
 
-    auto result = std::accumulate(messages_.rbegin(), messages_.rend(), static_cast<GadgetContainerMessageBase*>(nullptr),
-                                  [](auto container_message, auto &old_message) {
-                                      auto container_message2 = old_message->to_container_message();
-                                      container_message2->cont(container_message);
-                                      return container_message2;
-                                  });
+    GadgetContainerMessageBase* result = nullptr;
+    for (auto it = messages_.rbegin(); it != messages_.rend(); ++it) {
+        auto* chunk = it->get();
+        auto* container_message = chunk->to_container_message(std::move(*it));
+        container_message->cont(result);
+        result = container_message;
+    }
 
     messages_.clear();
     return result;
 }
 
+Gadgetron::Core::Message::Message(MessageChunks message_vector)
+        : messages_(std::move(message_vector)) {
 
+}
 
 Gadgetron::Core::Message::Message(std::vector<std::unique_ptr<Gadgetron::Core::MessageChunk>> message_vector)
-        : messages_(std::move(message_vector)) {
+        : messages_(std::make_move_iterator(message_vector.begin()), std::make_move_iterator(message_vector.end())) {
 
 }
 
-const std::vector<std::unique_ptr<Gadgetron::Core::MessageChunk>> &Gadgetron::Core::Message::messages() const {
+const Gadgetron::Core::MessageChunks &Gadgetron::Core::Message::messages() const {
     return messages_;
 }
 
-std::vector<std::unique_ptr<Gadgetron::Core::MessageChunk>> Gadgetron::Core::Message::take_messages() {
+Gadgetron::Core::MessageChunks Gadgetron::Core::Message::take_messages() {
     return std::move(messages_);
 }
 
 Gadgetron::Core::Message Gadgetron::Core::Message::clone(){
-    std::vector<std::unique_ptr<MessageChunk>> cloned_messages;
+    MessageChunks cloned_messages;
     for (const auto& chunk : messages_)
         cloned_messages.emplace_back(chunk->clone());
 
     return Message(std::move(cloned_messages));
-}
\ No newline at end of file
+}
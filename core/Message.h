@@ -3,7 +3,9 @@
 #include <memory>
 #include <vector>
 #include <typeindex>
+#include <typeinfo>
 #include <numeric>
+#include <boost/container/small_vector.hpp>
 #include "Types.h"
 
 namespace Gadgetron {
@@ -18,22 +20,49 @@ namespace Gadgetron {
     namespace Core {
         class Message;
 
+        /**
+         * Recycles the memory of message chunks and legacy container messages, which are allocated and freed at the
+         * rate of the acquisitions, often on different threads. Freed blocks are cached per thread and handed between
+         * threads in batches through a shared depot.
+         */
+        namespace MessagePool {
+            void* allocate(size_t size);
+            void deallocate(void* ptr, size_t size) noexcept;
+        }
+
         class MessageChunk {
         public:
+            explicit MessageChunk(const std::type_info& type) : type(&type) {}
             virtual ~MessageChunk() = default;
             virtual std::unique_ptr<MessageChunk> clone() const = 0;
+
+            /// True if this is a TypedMessageChunk<T>. Compares the type recorded at construction, without a virtual call.
+            template<class T>
+            bool holds() const { return type == &typeid(T) || *type == typeid(T); }
+
+            static void* operator new(size_t size) { return MessagePool::allocate(size); }
+            static void operator delete(void* ptr, size_t size) noexcept { MessagePool::deallocate(ptr, size); }
+
         protected:
-            virtual GadgetContainerMessageBase *to_container_message() = 0;
+            /// Hands the chunk, which is self, over to a new container message
+            virtual GadgetContainerMessageBase *to_container_message(std::unique_ptr<MessageChunk> self) = 0;
 
             friend Message;
+
+        private:
+            const std::type_info* type;
         };
 
+        /// The chunks of a message. Messages rarely have more than four, which are then stored inline.
+        using MessageChunks = boost::container::small_vector<std::unique_ptr<MessageChunk>, 4>;
 
         class Message {
         public:
             template<class ...ARGS>
             explicit Message(ARGS &&...  args);
 
+            explicit Message(MessageChunks message_vector);
+
             explicit Message(std::vector<std::unique_ptr<MessageChunk>> message_vector);
 
             Message(const Message&) = delete;
@@ -41,16 +70,16 @@ namespace Gadgetron {
 
             Message& operator=(Message&&) = default;
 
-            const std::vector<std::unique_ptr<MessageChunk>> &messages() const;
+            const MessageChunks &messages() const;
 
-            std::vector<std::unique_ptr<MessageChunk>> take_messages();
+            MessageChunks take_messages();
 
             GadgetContainerMessageBase *to_container_message();
 
             Message clone();
 
         private:
-            std::vector<std::unique_ptr<MessageChunk>> messages_;
+            MessageChunks messages_;
         };
 
         template<class... ARGS>
@@ -78,7 +107,7 @@ namespace Gadgetron {
         public:
 
             template<class... ARGS>
-            explicit TypedMessageChunk(ARGS &&... xs) : data(std::forward<ARGS>(xs)...) {}
+            explicit TypedMessageChunk(ARGS &&... xs) : MessageChunk(typeid(T)), data(std::forward<ARGS>(xs)...) {}
 
             TypedMessageChunk(TypedMessageChunk &&other) = default;
 
@@ -88,7 +117,7 @@ namespace Gadgetron {
 
             TypedMessageChunk &operator=(TypedMessageChunk &&other) = default;
 
-            GadgetContainerMessageBase *to_container_message() override;
+            GadgetContainerMessageBase *to_container_message(std::unique_ptr<MessageChunk> self) override;
 
             std::unique_ptr<MessageChunk> clone() const override;
 
@@ -12,8 +12,8 @@ namespace Gadgetron::Core {
 
 
     template<class T>
-    GadgetContainerMessageBase* TypedMessageChunk<T>::to_container_message() {
-        return new GadgetContainerMessage<T>(std::move(data));
+    GadgetContainerMessageBase* TypedMessageChunk<T>::to_container_message(std::unique_ptr<MessageChunk> self) {
+        return new GadgetContainerMessage<T>(std::unique_ptr<TypedMessageChunk<T>>(static_cast<TypedMessageChunk<T>*>(self.release())));
     }
 
 
@@ -27,50 +27,53 @@ namespace Gadgetron::Core {
 
             template<class T>
             std::unique_ptr<MessageChunk> make_message(T &&input) {
-                return std::make_unique<TypedMessageChunk<std::remove_reference_t<T>>>(std::forward<T>(input));
+                return std::make_unique<TypedMessageChunk<std::decay_t<T>>>(std::forward<T>(input));
             }
 
             struct MessageMaker {
+                // the variants, tuples and optionals are taken by value and their elements moved into the chunks
                 template<class... VARGS, class ...REST>
                 static void
-                add_messages(std::vector<std::unique_ptr<MessageChunk>> &messages, variant<VARGS...> var,
+                add_messages(MessageChunks &messages, variant<VARGS...> var,
                             REST &&... args) {
-                    Core::visit([&](auto val) { add_messages(messages, val, std::forward<REST>(args)...); },
-                                         var);
+                    Core::visit([&](auto &&val) {
+                                    add_messages(messages, std::forward<decltype(val)>(val), std::forward<REST>(args)...);
+                                },
+                                std::move(var));
                 }
 
                 template<class... TARGS, class ...REST>
                 static void
-                add_messages(std::vector<std::unique_ptr<MessageChunk>> &messages, tuple<TARGS...> opt,
+                add_messages(MessageChunks &messages, tuple<TARGS...> opt,
                              REST &&... args) {
-                    Core::apply([&](auto... targs) {
-                                    add_messages(messages, std::move(targs)..., std::forward<REST...>(args)...);
+                    Core::apply([&](auto &&... targs) {
+                                    add_messages(messages, std::forward<decltype(targs)>(targs)..., std::forward<REST>(args)...);
                                 },
-                                opt);
+                                std::move(opt));
                 }
 
                 template<class T, class ...REST>
                 static void
-                add_messages(std::vector<std::unique_ptr<MessageChunk>> &messages, optional <T> opt, REST &&... args) {
-                    if (opt) messages.emplace_back(make_message(*opt));
+                add_messages(MessageChunks &messages, optional <T> opt, REST &&... args) {
+                    if (opt) messages.emplace_back(make_message(std::move(*opt)));
                     add_messages(messages, std::forward<REST>(args)...);
                 }
 
                 template<class T, class ...REST>
                 static void
-                add_messages(std::vector<std::unique_ptr<MessageChunk>> &messages, T &&arg, REST &&... args) {
+                add_messages(MessageChunks &messages, T &&arg, REST &&... args) {
                     messages.emplace_back(make_message(std::forward<T>(arg)));
                     add_messages(messages, std::forward<REST>(args)...);
                 }
 
-                static void add_messages(std::vector<std::unique_ptr<MessageChunk>> &messages) {
+                static void add_messages(MessageChunks &messages) {
                 }
 
             };
 
             template<class... ARGS>
-            std::vector<std::unique_ptr<MessageChunk>> make_messages(ARGS... args) {
-                std::vector<std::unique_ptr<MessageChunk>> messages;
+            MessageChunks make_messages(ARGS&&... args) {
+                MessageChunks messages;
                 MessageMaker::add_messages(messages, std::forward<ARGS>(args)...);
                 return messages;
             }
@@ -95,7 +98,7 @@ namespace Gadgetron::Core {
                 static bool convertible(Iterator it, const Iterator &it_end, const hana::basic_type<T> &,
                                         const hana::basic_type<TYPES> &... xs) {
                     if (it == it_end) return false;
-                    if (typeid(TypedMessageChunk<T>) == typeid(**it)) {
+                    if ((*it)->template holds<T>()) {
                         return convertible(++it, it_end, xs...);
                     }
                     return false;
@@ -109,7 +112,7 @@ namespace Gadgetron::Core {
 
                 template<class T, class... SARGS>
                 static hana::tuple<T, SARGS...> combine(T &&val1, hana::tuple<SARGS...> &&val2) {
-                    return hana::prepend(val2, std::forward<T>(val1));
+                    return hana::prepend(std::move(val2), std::forward<T>(val1));
                 }
 
 
@@ -153,7 +156,7 @@ namespace Gadgetron::Core {
                 static optional <T> convert(Iterator &it, const Iterator &it_end, const hana::basic_type<optional < T>>
 
                 ) {
-                    if (convertible(it, it_end, hana::type_c<T>)) return reinterpret_message<T>(**it).data;
+                    if (convertible(it, it_end, hana::type_c<T>)) return std::move(reinterpret_message<T>(**it).data);
                     return optional<T>();
                 }
 
@@ -280,7 +283,7 @@ optional <T> unpack(Message &&message) {
 
 template<class... ARGS>
 Gadgetron::Core::Message::Message(ARGS &&... args) : messages_(
-        gadgetron_message_detail::make_messages<ARGS...>(std::forward<ARGS>(args)...)) {
+        gadgetron_message_detail::make_messages(std::forward<ARGS>(args)...)) {
 
 
 }
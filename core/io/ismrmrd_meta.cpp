@@ -0,0 +1,200 @@
+#include "ismrmrd_meta.h"
+
+#include <array>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include <ismrmrd/xml.h>
+
+namespace {
+    using namespace Gadgetron::Core::IO;
+
+    // XML starts with '<' or whitespace, so a leading zero byte marks the binary encoding
+    constexpr char binary_magic[4] = { '\0', 'G', 'M', '1' };
+
+    // Key references: the number of a key sent earlier, or one of the markers below followed by the key itself
+    constexpr uint32_t new_key = 0xFFFFFFFE;
+    constexpr uint32_t inline_key = 0xFFFFFFFF;
+
+    // Keys beyond this are sent in full every time, so streams with generated keys do not grow without bound
+    constexpr size_t max_interned_keys = 4096;
+
+    struct MetaKeys {
+        std::unordered_map<std::string, uint32_t> written;
+        std::vector<std::string> read;
+    };
+
+    int encoding_index() {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    int keys_index() {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    void keys_callback(std::ios_base::event event, std::ios_base& stream, int index) {
+        switch (event) {
+        case std::ios_base::erase_event:
+            delete static_cast<MetaKeys*>(stream.pword(index));
+            stream.pword(index) = nullptr;
+            break;
+        case std::ios_base::copyfmt_event:
+            // The keys belong to the stream they were sent on; a copy of the format starts over with XML.
+            stream.pword(index) = nullptr;
+            stream.iword(encoding_index()) = static_cast<long>(MetaEncoding::xml);
+            break;
+        default:
+            break;
+        }
+    }
+
+    MetaKeys& keys(std::ios_base& stream) {
+        auto keys = static_cast<MetaKeys*>(stream.pword(keys_index()));
+        if (!keys) throw std::runtime_error("Binary meta attributes on a stream where they were not negotiated");
+        return *keys;
+    }
+
+    template<class T>
+    void append(std::string& buffer, T value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void append(std::string& buffer, const char* str, size_t length) {
+        append(buffer, static_cast<uint32_t>(length));
+        buffer.append(str, length);
+    }
+
+    class Cursor {
+    public:
+        explicit Cursor(const std::string& buffer) : position(buffer.data()), end(buffer.data() + buffer.size()) {}
+
+        template<class T>
+        T read() {
+            T value;
+            std::memcpy(&value, take(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        std::string read_string() {
+            auto length = read<uint32_t>();
+            return std::string(take(length), length);
+        }
+
+        const char* read_string(std::string& str) {
+            str = read_string();
+            return str.c_str();
+        }
+
+    private:
+        const char* take(size_t bytes) {
+            if (size_t(end - position) < bytes) throw std::runtime_error("Truncated binary meta attributes");
+            auto data = position;
+            position += bytes;
+            return data;
+        }
+
+        const char* position;
+        const char* const end;
+    };
+
+    std::string serialize_xml(const ISMRMRD::MetaContainer& meta) {
+        std::stringstream stream;
+        ISMRMRD::serialize(meta, stream);
+        return stream.str();
+    }
+
+    std::string serialize_binary(MetaKeys& keys, const ISMRMRD::MetaContainer& meta) {
+
+        std::string buffer(binary_magic, sizeof(binary_magic));
+        append(buffer, uint32_t(0));
+
+        uint32_t entries = 0;
+        for (const auto& [name, values] : meta) {
+            if (values.empty()) continue;
+
+            auto key = keys.written.find(name);
+            if (key != keys.written.end()) {
+                append(buffer, key->second);
+            } else if (keys.written.size() < max_interned_keys) {
+                keys.written.emplace(name, uint32_t(keys.written.size()));
+                append(buffer, new_key);
+                append(buffer, name.data(), name.size());
+            } else {
+                append(buffer, inline_key);
+                append(buffer, name.data(), name.size());
+            }
+
+            append(buffer, uint32_t(values.size()));
+            for (const auto& value : values) {
+                auto str = value.as_str();
+                append(buffer, str, std::strlen(str));
+            }
+            entries++;
+        }
+
+        std::memcpy(&buffer[sizeof(binary_magic)], &entries, sizeof(entries));
+        return buffer;
+    }
+
+    void deserialize_binary(MetaKeys& keys, const std::string& serialized, ISMRMRD::MetaContainer& meta) {
+
+        Cursor cursor(serialized);
+        cursor.read<std::array<char, sizeof(binary_magic)>>();
+
+        std::string inline_name, value;
+        auto entries = cursor.read<uint32_t>();
+        for (uint32_t entry = 0; entry < entries; entry++) {
+
+            const std::string* name;
+            auto key = cursor.read<uint32_t>();
+            if (key == new_key) {
+                keys.read.push_back(cursor.read_string());
+                name = &keys.read.back();
+            } else if (key == inline_key) {
+                inline_name = cursor.read_string();
+                name = &inline_name;
+            } else {
+                if (key >= keys.read.size()) throw std::runtime_error("Unknown key in binary meta attributes");
+                name = &keys.read[key];
+            }
+
+            // Values are appended from their string form, exactly as the XML deserialization does
+            auto count = cursor.read<uint32_t>();
+            for (uint32_t i = 0; i < count; i++) meta.append(name->c_str(), cursor.read_string(value));
+        }
+    }
+
+    bool is_binary(const std::string& serialized) {
+        return serialized.size() >= sizeof(binary_magic) &&
+               std::memcmp(serialized.data(), binary_magic, sizeof(binary_magic)) == 0;
+    }
+}
+
+namespace Gadgetron::Core::IO {
+
+    void set_meta_encoding(std::ios_base& stream, MetaEncoding encoding) {
+        if (encoding == MetaEncoding::binary && !stream.pword(keys_index())) {
+            stream.pword(keys_index()) = new MetaKeys();
+            stream.register_callback(keys_callback, keys_index());
+        }
+        stream.iword(encoding_index()) = static_cast<long>(encoding);
+    }
+
+    MetaEncoding meta_encoding(std::ios_base& stream) {
+        return static_cast<MetaEncoding>(stream.iword(encoding_index()));
+    }
+
+    std::string serialize_meta(std::ostream& stream, const ISMRMRD::MetaContainer& meta) {
+        if (meta_encoding(stream) == MetaEncoding::binary) return serialize_binary(keys(stream), meta);
+        return serialize_xml(meta);
+    }
+
+    void deserialize_meta(std::istream& stream, const std::string& serialized, ISMRMRD::MetaContainer& meta) {
+        if (is_binary(serialized)) return deserialize_binary(keys(stream), serialized, meta);
+        ISMRMRD::deserialize(serialized.c_str(), meta);
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <ismrmrd/meta.h>
+
+namespace Gadgetron::Core::IO {
+
+    /**
+     * Encoding of ISMRMRD::MetaContainer attributes on a stream.
+     *
+     * xml is the ISMRMRD XML serialization and the default on every stream. binary is a compact encoding of the
+     * same attributes: length prefixed keys and values, where each key is sent in full once per stream and as a
+     * number afterwards. The binary encoding is only used on links where both peers have agreed to it (see the
+     * "gadgetron::meta::binary" query), as it depends on the keys sent earlier on the same stream.
+     *
+     * Decoding tells the two encodings apart by their first byte, so readers accept both.
+     */
+    enum class MetaEncoding { xml, binary };
+
+    /**
+     * Sets the encoding of meta attributes written to and read from the stream.
+     * Must be called before the stream is shared between a reading and a writing thread.
+     */
+    void set_meta_encoding(std::ios_base& stream, MetaEncoding encoding);
+
+    MetaEncoding meta_encoding(std::ios_base& stream);
+
+    std::string serialize_meta(std::ostream& stream, const ISMRMRD::MetaContainer& meta);
+
+    void deserialize_meta(std::istream& stream, const std::string& serialized, ISMRMRD::MetaContainer& meta);
+}
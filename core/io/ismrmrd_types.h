@@ -10,6 +10,7 @@
 #include <ismrmrd/ismrmrd.h>
 #include "complext.h"
 #include "Types.h"
+#include "ismrmrd_meta.h"
 namespace Gadgetron::Core::IO {
 
     template<class T> inline constexpr uint16_t ismrmrd_data_type(){ return T::this_function_is_not_defined; }
@@ -63,9 +64,7 @@ void Gadgetron::Core::IO::write(std::ostream& stream, const Image<T>& img) {
     uint64_t meta_size = 0;
 
     if (meta) {
-        std::stringstream meta_stream;
-        ISMRMRD::serialize(*meta, meta_stream);
-        serialized_meta = meta_stream.str();
+        serialized_meta = serialize_meta(stream, *meta);
         meta_size = serialized_meta.size() + 1;
     }
 
@@ -87,13 +86,11 @@ void Gadgetron::Core::IO::write(std::ostream& stream, const Image<T>& img) {
 
 }
 void Gadgetron::Core::IO::write(std::ostream& stream, const ISMRMRD::MetaContainer& meta) {
-    std::stringstream meta_stream;
-    ISMRMRD::serialize(meta, meta_stream);
-    write_string_to_stream(stream, meta_stream.str());
+    write_string_to_stream(stream, serialize_meta(stream, meta));
 }
 void Gadgetron::Core::IO::read(std::istream& stream, ISMRMRD::MetaContainer& meta) {
     auto meta_string = read_string_from_stream(stream);
-    ISMRMRD::deserialize(meta_string.c_str(), meta);
+    deserialize_meta(stream, meta_string, meta);
 }
 void Gadgetron::Core::IO::write(std::ostream& stream, const ISMRMRD::Waveform& wave) {
         IO::write(stream,wave.head);
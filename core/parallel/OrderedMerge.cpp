@@ -0,0 +1,115 @@
+#include "OrderedMerge.h"
+
+#include "ChannelSelector.h"
+
+#include <boost/algorithm/string.hpp>
+
+namespace {
+    using namespace Gadgetron::Core;
+    using Order = Gadgetron::Core::Parallel::OrderedMerge::Order;
+
+    template<class HEADER>
+    const HEADER &header(const MessageChunk &chunk) {
+        return static_cast<const TypedMessageChunk<HEADER> &>(chunk).data;
+    }
+
+    optional<uint64_t> sorting_key(const Message &message, Order order) {
+        if (message.messages().empty()) return none;
+        auto &chunk = *message.messages().front();
+
+        if (chunk.holds<ISMRMRD::AcquisitionHeader>()) {
+            auto &h = header<ISMRMRD::AcquisitionHeader>(chunk);
+            return order == Order::timestamp ? h.acquisition_time_stamp : h.scan_counter;
+        }
+        if (chunk.holds<ISMRMRD::ImageHeader>()) {
+            auto &h = header<ISMRMRD::ImageHeader>(chunk);
+            return order == Order::timestamp ? h.acquisition_time_stamp : h.image_index;
+        }
+        if (chunk.holds<ISMRMRD::WaveformHeader>() && order == Order::timestamp) {
+            return header<ISMRMRD::WaveformHeader>(chunk).time_stamp;
+        }
+        return none;
+    }
+
+    void merge_round_robin(ChannelSelector &selector, OutputChannel &output) {
+        size_t turn = 0;
+        while (selector.open()) {
+            if (auto message = selector.try_pop(turn)) {
+                output.push_message(std::move(*message));
+            } else if (selector.is_open(turn)) {
+                selector.wait();
+                continue;
+            }
+            turn = (turn + 1) % selector.size();
+        }
+    }
+
+    struct Head {
+        Message message;
+        uint64_t key;
+    };
+
+    void merge_sorted(ChannelSelector &selector, OutputChannel &output, Order order) {
+        std::vector<optional<Head>> heads(selector.size());
+
+        while (true) {
+            bool complete = true;
+            for (size_t index = 0; index < heads.size(); index++) {
+                while (!heads[index]) {
+                    auto message = selector.try_pop(index);
+                    if (!message) break;
+
+                    if (auto key = sorting_key(*message, order)) {
+                        heads[index] = Head{ std::move(*message), *key };
+                    } else {
+                        output.push_message(std::move(*message));
+                    }
+                }
+                complete = complete && (heads[index] || !selector.is_open(index));
+            }
+
+            if (!complete) {
+                selector.wait();
+                continue;
+            }
+
+            optional<size_t> first;
+            for (size_t index = 0; index < heads.size(); index++) {
+                if (heads[index] && (!first || heads[index]->key < heads[*first]->key)) first = index;
+            }
+            if (!first) return;
+
+            output.push_message(std::move(heads[*first]->message));
+            heads[*first] = none;
+        }
+    }
+}
+
+namespace Gadgetron::Core::Parallel {
+
+    OrderedMerge::OrderedMerge(const Context &, const GadgetProperties &props) : Merge(props) {}
+
+    void OrderedMerge::process(std::map<std::string, GenericInputChannel> input, OutputChannel output) {
+
+        std::vector<GenericInputChannel> channels;
+        for (auto &pair : input) channels.emplace_back(std::move(pair.second));
+
+        ChannelSelector selector(std::move(channels));
+
+        if (order == Order::round_robin) {
+            merge_round_robin(selector, output);
+        } else {
+            merge_sorted(selector, output, order);
+        }
+    }
+
+    void from_string(const std::string &str, OrderedMerge::Order &order) {
+        auto lower = boost::to_lower_copy(str);
+        if (lower == "round_robin") order = OrderedMerge::Order::round_robin;
+        else if (lower == "timestamp") order = OrderedMerge::Order::timestamp;
+        else if (lower == "acquisition_index") order = OrderedMerge::Order::acquisition_index;
+        else throw std::runtime_error("Unknown merge order: " + str);
+    }
+
+    GADGETRON_MERGE_EXPORT(OrderedMerge)
+}
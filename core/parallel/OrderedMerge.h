@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Context.h>
+#include <PropertyMixin.h>
+#include <Channel.h>
+
+#include "Merge.h"
+
+namespace Gadgetron::Core::Parallel {
+
+    /**
+     * Merges the branches on a single thread, in an order given by the 'order' property:
+     *
+     * round_robin: one message from each open branch in turn, waiting for the branch whose turn it is.
+     * timestamp: by the acquisition time stamp of acquisitions and images and the time stamp of waveforms.
+     * acquisition_index: by the scan counter of acquisitions and the image index of images.
+     *
+     * The sorted orders assume each branch produces its messages in order, and hold a message back until every open
+     * branch has one to compare with. Messages without a time stamp or index are passed on as they arrive.
+     */
+    class OrderedMerge : public Merge {
+    public:
+        enum class Order {
+            round_robin,
+            timestamp,
+            acquisition_index
+        };
+
+        OrderedMerge(const Context &context, const GadgetProperties &props);
+        void process(std::map<std::string, GenericInputChannel>, OutputChannel) override;
+
+        NODE_PROPERTY(order, Order, "Order of the merged messages: round_robin, timestamp or acquisition_index", Order::round_robin);
+    };
+
+    void from_string(const std::string &str, OrderedMerge::Order &order);
+}
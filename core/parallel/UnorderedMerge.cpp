@@ -1,20 +1,6 @@
 #include "UnorderedMerge.h"
 
-#include <thread>
-
-namespace {
-
-    using namespace Gadgetron::Core;
-
-    void move_input_to_output(GenericInputChannel input, OutputChannel output) {
-        std::transform(
-                std::begin(input),
-                std::end(input),
-                std::begin(output),
-                [](auto message) { return message; }
-        );
-    }
-}
+#include "ChannelSelector.h"
 
 namespace Gadgetron::Core::Parallel {
 
@@ -22,21 +8,28 @@ namespace Gadgetron::Core::Parallel {
 
     void UnorderedMerge::process(std::map<std::string, GenericInputChannel> input, OutputChannel output) {
 
-        std::vector<std::thread> threads;
-
-        for (auto &pair : input) {
-            threads.emplace_back(
-                    std::thread(
-                            move_input_to_output,
-                            split(pair.second),
-                            split(output)
-                    )
-            );
+        std::vector<GenericInputChannel> channels;
+        for (auto &pair : input) channels.emplace_back(std::move(pair.second));
+
+        ChannelSelector selector(std::move(channels));
+
+        // The merge ends when all inputs are closed; a ChannelClosed from the output is passed on to the caller
+        auto pop = [&](size_t first) -> optional<std::pair<size_t, Message>> {
+            try {
+                return selector.pop(first);
+            } catch (const ChannelClosed &) {
+                return none;
+            }
+        };
+
+        // Messages are taken as they arrive; the search starts after the last branch served, so no branch is starved
+        size_t next = 0;
+        while (auto popped = pop(next)) {
+            auto &[index, message] = *popped;
+            next = (index + 1) % selector.size();
+            output.push_message(std::move(message));
         }
-
-        for (auto &thread : threads) thread.join();
     }
 
     GADGETRON_MERGE_EXPORT(UnorderedMerge)
 }
-
@@ -3,6 +3,7 @@
 #include "MessageID.h"
 
 #include "io/primitives.h"
+#include "io/ismrmrd_meta.h"
 
 namespace {
     using namespace Gadgetron;
@@ -25,12 +26,12 @@ namespace {
         return Core::Message(header,std::move(image_data),std::move(meta));
     }
 
-    Core::optional<ISMRMRD::MetaContainer> parse_meta(const std::string &serialized_meta) {
+    Core::optional<ISMRMRD::MetaContainer> parse_meta(std::istream& stream, const std::string &serialized_meta) {
 
         if (serialized_meta.empty()) return Core::none;
 
         ISMRMRD::MetaContainer meta;
-        ISMRMRD::deserialize(serialized_meta.c_str(), meta);
+        Core::IO::deserialize_meta(stream, serialized_meta, meta);
 
         return meta;
     }
@@ -41,7 +42,7 @@ Gadgetron::Core::Message Gadgetron::Core::Readers::ImageReader::read(std::istrea
     auto header = IO::read<ISMRMRD::ImageHeader>(stream);
     auto serialized_meta = IO::read_string_from_stream<uint64_t>(stream);
 
-    auto meta = parse_meta(serialized_meta);
+    auto meta = parse_meta(stream, serialized_meta);
 
     auto datatype = ismrmrd_to_variant.at(header.data_type);
     return Core::visit([&](auto tag){return read_image_message(stream,header,std::move(meta),tag);}, datatype);
@@ -29,6 +29,7 @@ class T1MocoGadget : public Core::ChannelGadget<IsmrmrdImageArray> {
     NODE_PROPERTY(step_size, float, "Maximum step size for demons registration (between 0.1 and 2.0)", 2.0f);
     NODE_PROPERTY(iterations, unsigned int, "Number of iterations of demons registration and T1 fit", 5);
     NODE_PROPERTY(scales, unsigned int, "Number of image scales to use", 1);
+    NODE_PROPERTY(batch_fitting, bool, "Fit the T1 map in batches of pixels with the batched Levenberg-Marquardt solver", false);
 
   private:
     void process(Core::InputChannel<IsmrmrdImageArray>& input, Core::OutputChannel& out) final override {
@@ -48,7 +49,7 @@ class T1MocoGadget : public Core::ChannelGadget<IsmrmrdImageArray> {
 
             auto phase_corrected = T1::phase_correct(moco_images, TI_values);
 
-            const auto [A, B, T1star] = T1::fit_T1_3param(phase_corrected, TI_values);
+            const auto [A, B, T1star] = T1::fit_T1_3param(phase_corrected, TI_values, batch_fitting);
 
             auto T1 = t1_from_t1star(A, B, T1star);
             clean_image(T1);
@@ -56,6 +56,11 @@ namespace Gadgetron {
         GADGET_PROPERTY(std_thres_masking, double, "Number of noise std for masking", 3.0);
         GADGET_PROPERTY(mapping_with_masking, bool, "Whether to compute and apply a mask for mapping", true);
 
+        GADGET_PROPERTY(batch_fitting, bool, "Whether to fit pixels in batches; if false, every pixel is fitted with the simplex solver", false);
+        GADGET_PROPERTY(dictionary_matching, bool, "Whether to match pixels against a precomputed dictionary of the signal model", false);
+        GADGET_PROPERTY(refine_dictionary_match, bool, "Whether to refine the dictionary match with the batched fitting", false);
+        GADGET_PROPERTY(dictionary_size, int, "Number of entries in the dictionary", 500);
+
         // ------------------------------------------------------------------------------------
 
     protected:
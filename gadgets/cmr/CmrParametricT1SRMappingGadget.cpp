@@ -114,6 +114,10 @@ namespace Gadgetron {
 
             t1_sr.max_iter_ = max_iter.value();
             t1_sr.thres_fun_ = thres_func.value();
+            t1_sr.use_batch_fitting_ = batch_fitting.value();
+            t1_sr.use_dictionary_matching_ = dictionary_matching.value();
+            t1_sr.refine_dictionary_match_ = refine_dictionary_match.value();
+            t1_sr.dictionary_size_ = dictionary_size.value();
             t1_sr.max_map_value_ = max_T1.value();
 
             t1_sr.verbose_ = verbose.value();
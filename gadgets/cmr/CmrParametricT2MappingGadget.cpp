@@ -125,6 +125,10 @@ namespace Gadgetron {
 
             t2_mapper.max_iter_ = max_iter.value();
             t2_mapper.thres_fun_ = thres_func.value();
+            t2_mapper.use_batch_fitting_ = batch_fitting.value();
+            t2_mapper.use_dictionary_matching_ = dictionary_matching.value();
+            t2_mapper.refine_dictionary_match_ = refine_dictionary_match.value();
+            t2_mapper.dictionary_size_ = dictionary_size.value();
             t2_mapper.max_map_value_ = max_T2.value();
 
             t2_mapper.verbose_ = verbose.value();
@@ -0,0 +1,203 @@
+#include "EPIReadoutGadget.h"
+#include "EPIReadoutBatch.h"
+#include "hoNDFFT.h"
+#include "ismrmrd/xml.h"
+
+#include <deque>
+
+namespace Gadgetron {
+
+    EPIReadoutGadget::EPIReadoutGadget(const Core::Context& context, const Core::GadgetProperties& props)
+        : Core::ChannelGadget<Core::Acquisition>(context, props) {
+        auto& h = context.header;
+
+        if (h.encoding.size() == 0) {
+            GADGET_THROW("This Gadget needs an encoding description");
+        }
+
+        // Get the encoding space and trajectory description
+        ISMRMRD::EncodingSpace e_space = h.encoding[0].encodedSpace;
+        ISMRMRD::EncodingSpace r_space = h.encoding[0].reconSpace;
+        ISMRMRD::EncodingLimits e_limits = h.encoding[0].encodingLimits;
+
+        if (!h.encoding[0].trajectoryDescription) {
+            GADGET_THROW("Trajectory description missing");
+        }
+        ISMRMRD::TrajectoryDescription traj_desc = *h.encoding[0].trajectoryDescription;
+
+        if (traj_desc.identifier != "ConventionalEPI") {
+            GADGET_THROW("Expected trajectory description identifier 'ConventionalEPI', not found.");
+        }
+
+        // Primary encoding space is for EPI
+        reconx.encodeNx_ = e_space.matrixSize.x;
+        reconx.encodeFOV_ = e_space.fieldOfView_mm.x;
+        reconx.reconNx_ = r_space.matrixSize.x;
+        reconx.reconFOV_ = r_space.fieldOfView_mm.x;
+
+        for (auto& parameter : traj_desc.userParameterLong) {
+            if (parameter.name == "rampUpTime") {
+                reconx.rampUpTime_ = parameter.value;
+            } else if (parameter.name == "rampDownTime") {
+                reconx.rampDownTime_ = parameter.value;
+            } else if (parameter.name == "flatTopTime") {
+                reconx.flatTopTime_ = parameter.value;
+            } else if (parameter.name == "acqDelayTime") {
+                reconx.acqDelayTime_ = parameter.value;
+            } else if (parameter.name == "numSamples") {
+                reconx.numSamples_ = parameter.value;
+            } else if (parameter.name == "numberOfNavigators") {
+                corr_.numNavigators_ = parameter.value;
+            } else if (parameter.name == "etl") {
+                corr_.etl_ = parameter.value;
+            }
+        }
+
+        for (auto& parameter : traj_desc.userParameterDouble) {
+            if (parameter.name == "dwellTime") {
+                reconx.dwellTime_ = parameter.value;
+            }
+        }
+
+        // If the flat top time is not set in the header, then we assume that rampSampling is off
+        // and we set the flat top time from the number of samples and the dwell time.
+        if (reconx.flatTopTime_ == 0) {
+            reconx.flatTopTime_ = reconx.dwellTime_ * reconx.numSamples_;
+        }
+
+        reconx.computeTrajectory();
+
+        // Second encoding space is an even readout for PAT REF e.g. FLASH
+        if (h.encoding.size() > 1) {
+            ISMRMRD::EncodingSpace e_space2 = h.encoding[1].encodedSpace;
+            ISMRMRD::EncodingSpace r_space2 = h.encoding[1].reconSpace;
+            reconx_other.encodeNx_ = r_space2.matrixSize.x;
+            reconx_other.encodeFOV_ = r_space2.fieldOfView_mm.x;
+            reconx_other.reconNx_ = r_space2.matrixSize.x;
+            reconx_other.reconFOV_ = r_space2.fieldOfView_mm.x;
+            reconx_other.numSamples_ = e_space2.matrixSize.x;
+            oversamplng_ratio2_ = (float)e_space2.matrixSize.x / r_space2.matrixSize.x;
+            reconx_other.dwellTime_ = 1.0;
+            reconx_other.computeTrajectory();
+        }
+
+        corr_.referenceNavigatorNumber_ = referenceNavigatorNumber;
+        corr_.B0CorrectionMode_ = B0CorrectionMode;
+        corr_.OEPhaseCorrectionMode_ = OEPhaseCorrectionMode;
+        corr_.navigatorParameterFilterLength_ = navigatorParameterFilterLength;
+        corr_.navigatorParameterFilterExcludeVols_ = navigatorParameterFilterExcludeVols;
+
+        // Make sure the reference navigator is properly set:
+        if (referenceNavigatorNumber > (corr_.numNavigators_ - 1)) {
+            GADGET_THROW("Reference navigator number is larger than number of navigators acquired.");
+        }
+
+        if (navigatorParameterFilterLength > 1) {
+            corr_.init_arrays_for_nav_parameter_filtering(e_limits);
+        }
+
+        cutNx_ = cut_x ? e_space.matrixSize.x : 0;
+    }
+
+    Core::Acquisition EPIReadoutGadget::reconstruct_other(Core::Acquisition acquisition) {
+        auto& [hdr, data, traj] = acquisition;
+
+        if (reconx_other.encodeNx_ > data.get_size(0) / oversamplng_ratio2_) {
+            reconx_other.encodeNx_ = (int)(data.get_size(0) / oversamplng_ratio2_);
+            reconx_other.computeTrajectory();
+        }
+
+        if (reconx_other.reconNx_ > data.get_size(0) / oversamplng_ratio2_) {
+            reconx_other.reconNx_ = (int)(data.get_size(0) / oversamplng_ratio2_);
+        }
+
+        if (reconx_other.numSamples_ > data.get_size(0)) {
+            reconx_other.numSamples_ = data.get_size(0);
+            reconx_other.computeTrajectory();
+        }
+
+        ISMRMRD::AcquisitionHeader hdr_out;
+        hoNDArray<std::complex<float>> data_out(reconx.reconNx_, data.get_size(1));
+        reconx_other.apply(hdr, data, hdr_out, data_out);
+
+        // FFT in x back to k
+        hoNDFFT<float>::instance()->fft1c(data_out, fft_res_, fft_buf_);
+
+        size_t RO = hdr_out.number_of_samples;
+        size_t stride = fft_res_.get_size(0);
+        size_t CHA = fft_res_.get_size(1);
+        size_t startX = 0;
+        if (cutNx_ > 0 && RO > cutNx_) {
+            // cut the central part from the kspace line
+            startX = (uint16_t)(hdr_out.center_sample - cutNx_ / 2);
+            float ratio = RO / (float)cutNx_;
+            hdr_out.number_of_samples = cutNx_;
+            hdr_out.center_sample = (uint16_t)(hdr_out.center_sample / ratio);
+        }
+
+        size_t nx = hdr_out.number_of_samples;
+        data.create(nx, CHA);
+        for (size_t cha = 0; cha < CHA; cha++) {
+            std::copy(fft_res_.begin() + cha * stride + startX, fft_res_.begin() + cha * stride + startX + nx, data.begin() + cha * nx);
+        }
+
+        hdr = hdr_out;
+        return acquisition;
+    }
+
+    void EPIReadoutGadget::process(Core::InputChannel<Core::Acquisition>& in, Core::OutputChannel& out) {
+
+        EPI::EPIReadoutBatch<std::complex<float>> batch(reconx, corr_, batch_lines);
+        std::deque<Core::optional<hoNDArray<float>>> trajectories;
+        uint16_t slice = 0;
+
+        auto flush = [&]() {
+            batch.process(cutNx_, [&](ISMRMRD::AcquisitionHeader& hdr, hoNDArray<std::complex<float>>&& data) {
+                out.push(Core::Acquisition{ hdr, std::move(data), std::move(trajectories.front()) });
+                trajectories.pop_front();
+            });
+        };
+
+        for (auto acquisition : in) {
+            auto& [hdr, data, traj] = acquisition;
+
+            // Pass on the non-EPI data (e.g. FLASH Calibration), after the EPI lines that came before it.
+            // Lines still waiting for their navigators are held back, as EPICorrGadget does.
+            if (hdr.encoding_space_ref > 0) {
+                if (corr_.corrComputed()) flush();
+                out.push(reconstruct_other(std::move(acquisition)));
+                continue;
+            }
+
+            if (hdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA)) {
+                // The lines before the navigator belong to the shot of the current correction
+                if (corr_.corrComputed()) flush();
+
+                ISMRMRD::AcquisitionHeader hdr_out;
+                hoNDArray<std::complex<float>> regridded(reconx.reconNx_, data.get_size(1));
+                reconx.apply(hdr, data, hdr_out, regridded);
+
+                arma::cx_fmat adata = as_arma_matrix(regridded);
+                corr_.process_phase_correction_data(hdr_out, adata);
+                continue;
+            }
+
+            // The lines of a batch are of one slice. Until the navigators of the first shot are processed, all lines are kept.
+            if (!batch.empty() && corr_.corrComputed() && (hdr.idx.slice != slice || !batch.compatible(data))) flush();
+
+            slice = hdr.idx.slice;
+            batch.add(hdr, data);
+            trajectories.push_back(std::move(traj));
+
+            if (batch.full() && corr_.corrComputed()) flush();
+        }
+
+        if (corr_.corrComputed()) {
+            flush();
+        } else if (!batch.empty()) {
+            GWARN_STREAM("EPIReadoutGadget: " << batch.size() << " lines without navigators are dropped");
+        }
+    }
+
+    GADGETRON_GADGET_EXPORT(EPIReadoutGadget)
+}
@@ -0,0 +1,60 @@
+/**
+    \brief  EPI readout processing in one stage: ramp sampling regridding, navigator based B0 and odd-even phase
+            correction, FFT in x back to k-space and optionally the cut to the encoded matrix size.
+
+            The output is that of EPIReconXGadget, EPICorrGadget, FFTXGadget (and CutXGadget), but the lines of a
+            slice are processed in batches, see EPIReadoutBatch.h.
+*/
+
+#pragma once
+
+#include "Node.h"
+#include "Types.h"
+#include "hoNDArray.h"
+#include "gadgetron_epi_export.h"
+
+#include "EPIReconXObjectFlat.h"
+#include "EPIReconXObjectTrapezoid.h"
+#include "EPICorrectionObject.h"
+
+#include <ismrmrd/ismrmrd.h>
+#include <complex>
+
+namespace Gadgetron {
+
+    class EXPORTGADGETS_EPI EPIReadoutGadget : public Core::ChannelGadget<Core::Acquisition> {
+    public:
+        EPIReadoutGadget(const Core::Context& context, const Core::GadgetProperties& props);
+
+        void process(Core::InputChannel<Core::Acquisition>& input, Core::OutputChannel& output) override;
+
+    protected:
+        NODE_PROPERTY(referenceNavigatorNumber, size_t,
+                      "Navigator number to be used as reference, both for phase correction and weights for filtering (default=1 -- second navigator)",
+                      1);
+        NODE_PROPERTY(B0CorrectionMode, std::string, "B0 correction mode: none, mean or linear", "mean");
+        NODE_PROPERTY(OEPhaseCorrectionMode, std::string, "Odd-Even phase-correction mode: none, mean, linear or polynomial", "polynomial");
+        NODE_PROPERTY(navigatorParameterFilterLength, int,
+                      "Number of repetitions to use to filter the navigator parameters (set to 0 or negative for no filtering)",
+                      0);
+        NODE_PROPERTY(navigatorParameterFilterExcludeVols, size_t,
+                      "Number of volumes/repetitions to exclude from the beginning of the run when filtering the navigator parameters",
+                      0);
+        NODE_PROPERTY(batch_lines, size_t, "Number of EPI lines of a slice regridded and transformed together", 64);
+        NODE_PROPERTY(cut_x, bool, "Cut the lines to the encoded matrix size, like CutXGadget", false);
+
+        // the reconstruction of the EPI lines and of the lines of the second encoding space, e.g. FLASH calibration
+        EPI::EPIReconXObjectTrapezoid<std::complex<float>> reconx;
+        EPI::EPIReconXObjectFlat<std::complex<float>> reconx_other;
+        float oversamplng_ratio2_;
+
+        EPI::EPICorrectionObject<std::complex<float>> corr_;
+
+        size_t cutNx_;
+
+        hoNDArray<std::complex<float>> fft_res_;
+        hoNDArray<std::complex<float>> fft_buf_;
+
+        Core::Acquisition reconstruct_other(Core::Acquisition acquisition);
+    };
+}
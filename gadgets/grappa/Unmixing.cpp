@@ -75,7 +75,8 @@ namespace Gadgetron::Grappa {
             auto current_weights = weights_provider[image.meta.slice];
             output.push(
                     create_image_header(image, current_weights),
-                    unmix(image, current_weights)
+                    unmix(image, current_weights),
+                    create_image_meta(image, current_weights)
             );
         }
     }
@@ -128,6 +129,17 @@ namespace Gadgetron::Grappa {
         return header;
     }
 
+    ISMRMRD::MetaContainer Unmixing::create_image_meta(const Image &image, const Weights &weights) {
+
+        ISMRMRD::MetaContainer meta;
+
+        // The age is in acquisition time stamp ticks; weights calculated from data newer than the image have a negative age.
+        meta.set("grappa_weights_version", long(weights.meta.version));
+        meta.set("grappa_weights_age", long(int32_t(image.meta.time_stamp - weights.meta.time_stamp)));
+
+        return meta;
+    }
+
     std::vector<size_t> Unmixing::create_output_image_dimensions(const Core::Context &context) {
         auto r_space  = context.header.encoding[0].reconSpace;
         return {
@@ -24,6 +24,9 @@ namespace Gadgetron::Grappa {
     public:
         struct {
             uint16_t slice, n_combined_channels, n_uncombined_channels;
+            // Counts the weights calculated for the slice; time_stamp is that of the latest acquisition they are based on.
+            uint64_t version;
+            uint32_t time_stamp;
         } meta;
 
         hoNDArray<std::complex<float>> data;
@@ -49,6 +52,7 @@ namespace Gadgetron::Grappa {
         static std::vector<size_t> create_output_image_dimensions(const Core::Context &context);
         static std::vector<float> create_output_image_fov(const Core::Context &context);
         ISMRMRD::ImageHeader create_image_header(const Image &image, const Weights &weights);
+        ISMRMRD::MetaContainer create_image_meta(const Image &image, const Weights &weights);
 
         const Core::Context context;
         const std::vector<size_t> image_dimensions;
@@ -1,8 +1,13 @@
 #include "WeightsCalculator.h"
 
-#include <set>
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <map>
+#include <thread>
 
 #include "common/AcquisitionBuffer.h"
+#include "common/WeightsQueue.h"
 #include "common/grappa_common.h"
 
 #ifdef USE_CUDA
@@ -15,6 +20,7 @@
 #include "Unmixing.h"
 
 #include "Gadget.h"
+#include "ThreadPool.h"
 
 namespace {
     using namespace Gadgetron;
@@ -71,6 +77,10 @@ namespace {
             return acceleration[slice].value();
         }
 
+        optional<size_t> current_acceleration_factor(size_t slice) const {
+            return acceleration[slice];
+        }
+
         void clear(size_t slice) {
             previous_line[slice] = acceleration[slice] = none;
         }
@@ -82,8 +92,12 @@ namespace {
 
     class DirectionMonitor {
     public:
-        explicit DirectionMonitor(Grappa::AcquisitionBuffer &buffer,  AccelerationMonitor &acceleration, size_t max_slices)
-        : buffer(buffer),  acceleration(acceleration), orientations(max_slices) {
+        explicit DirectionMonitor(
+                Grappa::AcquisitionBuffer &buffer,
+                AccelerationMonitor &acceleration,
+                size_t max_slices,
+                std::function<void(size_t)> on_clear
+        ) : buffer(buffer), acceleration(acceleration), orientations(max_slices), on_clear(std::move(on_clear)) {
 
         }
 
@@ -111,6 +125,7 @@ namespace {
         void clear(size_t slice) {
             buffer.clear(slice);
             acceleration.clear(slice);
+            on_clear(slice);
         }
 
 
@@ -125,36 +140,89 @@ namespace {
         };
 
         std::vector<SliceOrientation> orientations;
+        std::function<void(size_t)> on_clear;
     };
 }
 
 namespace Gadgetron::Grappa {
 
+    // Everything a worker needs to calculate the weights of a slice, taken while the buffer is not changing. The
+    // calibration is taken with the data, so version and time stamp describe what the weights are calculated from.
     template<class WeightsCore>
-    Grappa::Weights create_weights(
+    struct WeightsRequest {
+        uint64_t version;
+        uint32_t time_stamp;
+        hoNDArray<std::complex<float>> data;
+        typename WeightsCore::Snapshot calibration;
+        std::array<uint16_t, 4> region_of_support;
+        uint16_t acceleration_factor, n_combined_channels, n_uncombined_channels;
+    };
+
+    template<class WeightsCore>
+    WeightsRequest<WeightsCore> create_request(
             uint16_t index,
+            uint64_t version,
+            uint32_t time_stamp,
             const AcquisitionBuffer &buffer,
+            WeightsCore &core,
             uint16_t n_combined_channels,
             uint16_t n_uncombined_channels,
-            const AccelerationMonitor &acceleration_monitor,
+            const AccelerationMonitor &acceleration_monitor
+    ) {
+        return WeightsRequest<WeightsCore>{
+                version,
+                time_stamp,
+                hoNDArray<std::complex<float>>(buffer.view(index)),
+                core.snapshot(index),
+                buffer.region_of_support(index),
+                uint16_t(acceleration_monitor.acceleration_factor(index)),
+                n_combined_channels,
+                n_uncombined_channels
+        };
+    }
+
+    template<class WeightsCore>
+    Grappa::Weights create_weights(
+            uint16_t index,
+            WeightsRequest<WeightsCore> &&request,
             WeightsCore &core
     ) {
         return Grappa::Weights{
                 {
                         index,
-                        n_combined_channels,
-                        n_uncombined_channels
+                        request.n_combined_channels,
+                        request.n_uncombined_channels,
+                        request.version,
+                        request.time_stamp
                 },
                 core.calculate_weights(
-                        buffer.view(index),
-                        buffer.region_of_support(index),
-                        acceleration_monitor.acceleration_factor(index),
-                        n_combined_channels,
-                        n_uncombined_channels
+                        index,
+                        std::move(request.calibration),
+                        request.data,
+                        request.region_of_support,
+                        request.acceleration_factor,
+                        request.n_combined_channels,
+                        request.n_uncombined_channels
                 )
         };
     }
 
+    template<class WeightsCore>
+    void calculate_weights(WeightsQueue<WeightsRequest<WeightsCore>> &queue, WeightsCore &core, OutputChannel &out) {
+        try {
+            while (true) {
+                auto [index, request] = queue.pop();
+                out.push(create_weights(index, std::move(request), core));
+                queue.done(index);
+            }
+        }
+        catch (const ChannelClosed &) {}
+        catch (...) {
+            queue.fail(std::current_exception());
+            throw;
+        }
+    }
+
     template<class WeightsCore>
     WeightsCalculator<WeightsCore>::WeightsCalculator(
             const Context &context,
@@ -164,7 +232,9 @@ namespace Gadgetron::Grappa {
     template<class WeightsCore>
     void WeightsCalculator<WeightsCore>::process(InputChannel<Grappa::Slice> &in, OutputChannel &out) {
 
-        std::set<uint16_t> updated_slices{};
+        std::map<uint16_t, std::vector<size_t>> updated_lines{};
+        std::map<uint16_t, uint32_t> time_stamps{};
+        std::map<uint16_t, uint64_t> versions{};
         uint16_t n_combined_channels = 0, n_uncombined_channels = 0;
 
         const auto slice_limits = context.header.encoding[0].encodingLimits.slice;
@@ -173,37 +243,79 @@ namespace Gadgetron::Grappa {
         AcquisitionBuffer buffer{context};
         AccelerationMonitor acceleration_monitor{max_slices};
 
-        buffer.add_pre_update_callback(DirectionMonitor{buffer, acceleration_monitor,max_slices});
-        buffer.add_post_update_callback([&](auto &acq) { updated_slices.insert(slice_of(acq)); });
+        WeightsCore core{
+                {coil_map_estimation_ks, coil_map_estimation_power, coil_map_estimation_downsampling},
+                {block_size_samples, block_size_lines, convolution_kernel_threshold}
+        };
+
+        // Weights are calculated by the workers, while this thread keeps taking in acquisitions. A slice updated
+        // again before a worker got to it is only calculated once, from the latest data.
+        WeightsQueue<WeightsRequest<WeightsCore>> queue;
+
+        // A request still waiting for a cleared slice is for the old geometry, and is dropped with its calibration.
+        buffer.add_pre_update_callback(DirectionMonitor{buffer, acceleration_monitor, max_slices, [&](size_t slice) {
+            core.clear(slice);
+            queue.drop(slice);
+            updated_lines.erase(slice);
+        }});
+        buffer.add_post_update_callback([&](auto &acq) { updated_lines[slice_of(acq)].push_back(buffer.line_index(acq)); });
+        buffer.add_post_update_callback([&](auto &acq) {
+            time_stamps[slice_of(acq)] = std::get<ISMRMRD::AcquisitionHeader>(acq).acquisition_time_stamp;
+        });
         buffer.add_post_update_callback([&](auto &acq) { acceleration_monitor(acq); });
         buffer.add_post_update_callback([&](auto &acq) {
             n_combined_channels = combined_channels(acq);
             n_uncombined_channels = uncombined_channels(acq);
         });
 
-        WeightsCore core{
-                {coil_map_estimation_ks, coil_map_estimation_power},
-                {block_size_samples, block_size_lines, convolution_kernel_threshold}
-        };
-
-        while (true) {
-            auto slices = take_available_slices(in);
-            buffer.add(slices);
+        // hardware_concurrency() is 0 when the number of cores cannot be determined
+        const unsigned int n_workers = weights_workers ? weights_workers : std::max(1u, std::thread::hardware_concurrency());
+        ThreadPool pool(n_workers);
 
-            for (auto index : updated_slices) {
+        std::vector<std::future<void>> workers;
+        for (unsigned int i = 0; i < n_workers; i++) {
+            workers.push_back(pool.async([&]() { calculate_weights(queue, core, out); }));
+        }
 
-                if (!buffer.is_sufficiently_sampled(index)) continue;
-                out.push(create_weights(
-                        index,
-                        buffer,
-                        n_combined_channels,
-                        n_uncombined_channels,
-                        acceleration_monitor,
-                        core
-                ));
+        std::exception_ptr error;
+        try {
+            while (true) {
+                auto slices = take_available_slices(in);
+                buffer.add(slices);
+
+                for (const auto &[index, lines] : updated_lines) {
+
+                    // The calibration takes in the new lines now, so calculating the weights only has to solve for the kernel.
+                    core.update(index, buffer.view(index), lines, acceleration_monitor.current_acceleration_factor(index));
+
+                    if (!buffer.is_sufficiently_sampled(index)) continue;
+                    bool superseded = queue.push(index, create_request(
+                            index,
+                            ++versions[index],
+                            time_stamps[index],
+                            buffer,
+                            core,
+                            n_combined_channels,
+                            n_uncombined_channels,
+                            acceleration_monitor
+                    ));
+
+                    if (superseded) GDEBUG_STREAM("Weights for slice " << index << " superseded before they were calculated.");
+                }
+                updated_lines.clear();
             }
-            updated_slices.clear();
         }
+        catch (const ChannelClosed &) {
+            queue.close();
+        }
+        catch (...) {
+            error = std::current_exception();
+            queue.fail(error);
+        }
+
+        pool.join();
+        for (auto &worker : workers) worker.get();
+        if (error) std::rethrow_exception(error);
     }
 
     using cpuWeightsCalculator = WeightsCalculator<CPU::WeightsCore>;
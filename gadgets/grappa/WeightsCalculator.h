@@ -16,11 +16,14 @@ namespace Gadgetron::Grappa {
         // TODO: Descriptive descriptions.
         NODE_PROPERTY(coil_map_estimation_ks, uint16_t, "", 5);
         NODE_PROPERTY(coil_map_estimation_power, uint16_t, "", 3);
+        NODE_PROPERTY(coil_map_estimation_downsampling, uint16_t, "Coil maps are estimated at every n-th pixel and interpolated in between.", 1);
 
         NODE_PROPERTY(block_size_lines, uint16_t, "Block size used to estimate missing samples; number of lines.", 4);
         NODE_PROPERTY(block_size_samples, uint16_t, "Block size used to estimate missing samples; number of samples.", 5);
         NODE_PROPERTY(convolution_kernel_threshold, float, "Grappa convolution kernel calibration Tikhonov threshold.", 5e-4);
 
+        NODE_PROPERTY(weights_workers, uint16_t, "Number of threads calculating weights; 0 uses one per core.", 2);
+
         void process(Core::InputChannel<Slice> &in, Core::OutputChannel &out) override;
 
     private:
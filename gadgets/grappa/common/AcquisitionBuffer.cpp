@@ -72,7 +72,7 @@ namespace Gadgetron::Grappa {
         }
 
         auto current_slice = header.idx.slice;
-        auto current_line = header.idx.kspace_encode_step_1 + internals.line_offset;
+        auto current_line = line_index(acquisition);
 
         if (!buffers.count(current_slice)) {
             buffers[current_slice] = create_buffer({
@@ -138,6 +138,10 @@ namespace Gadgetron::Grappa {
         return std::array<uint16_t, 4>{0, uint16_t(buffers.at(index).data.get_size(0)), uint16_t(lower+internals.line_offset), uint16_t(upper+internals.line_offset)};
     }
 
+    size_t AcquisitionBuffer::line_index(const AnnotatedAcquisition &acquisition) const {
+        return std::get<ISMRMRD::AcquisitionHeader>(acquisition).idx.kspace_encode_step_1 + internals.line_offset;
+    }
+
     AcquisitionBuffer::buffer AcquisitionBuffer::create_buffer(const std::vector<size_t> &dimensions) {
 
         buffer buffer {
@@ -40,6 +40,9 @@ namespace Gadgetron::Grappa {
 
         std::array<uint16_t,4> region_of_support(size_t index) const;
 
+        // Line of the buffer the acquisition is stored in.
+        size_t line_index(const AnnotatedAcquisition &acquisition) const;
+
         void add_pre_update_callback(std::function<void(const AnnotatedAcquisition &)> fn);
         void add_post_update_callback(std::function<void(const AnnotatedAcquisition &)> fn);
 
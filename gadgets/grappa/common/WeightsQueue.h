@@ -0,0 +1,119 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include "MPMCChannel.h"
+
+namespace Gadgetron::Grappa {
+
+    // Pending weights calculations, at most one per slice; a newer request replaces the one still waiting.
+    // Slices that have never had weights are handed out first, the others in the order they were first requested.
+    // A slice is handed out to one worker at a time, so the weights of a slice are delivered in order.
+    template<class Request>
+    class WeightsQueue {
+    public:
+        // Returns true if the request replaced one that was still waiting.
+        bool push(uint16_t slice, Request request) {
+            bool superseded;
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (error) std::rethrow_exception(error);
+                if (closed) throw Core::ChannelClosed();
+
+                // A replaced request keeps its place, so a slice updated faster than the workers keep up is not starved.
+                auto it = pending.find(slice);
+                superseded = it != pending.end();
+                if (superseded) it->second.request = std::move(request);
+                else pending.emplace(slice, Pending{std::move(request), order++});
+            }
+            cv.notify_all();
+            return superseded;
+        }
+
+        // Drops the request of the slice still waiting, if any; a request already handed out is not affected.
+        void drop(uint16_t slice) {
+            std::lock_guard<std::mutex> guard(mutex);
+            pending.erase(slice);
+        }
+
+        // Blocks until a request can be handed out; throws ChannelClosed once the queue is closed and drained, or has failed.
+        std::pair<uint16_t, Request> pop() {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            auto next = pending.end();
+            cv.wait(lock, [&]() {
+                next = select();
+                return next != pending.end() || error || (closed && pending.empty());
+            });
+
+            if (error || next == pending.end()) throw Core::ChannelClosed();
+
+            std::pair<uint16_t, Request> request{next->first, std::move(next->second.request)};
+            busy.insert(next->first);
+            pending.erase(next);
+            return request;
+        }
+
+        // The worker is done with the slice handed out by pop.
+        void done(uint16_t slice) {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                busy.erase(slice);
+                calculated.insert(slice);
+            }
+            cv.notify_all();
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                closed = true;
+            }
+            cv.notify_all();
+        }
+
+        // Stops the workers; the error is thrown to the next push.
+        void fail(std::exception_ptr e) {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (!error) error = e;
+            }
+            cv.notify_all();
+        }
+
+    private:
+        struct Pending {
+            Request request;
+            uint64_t order;
+        };
+
+        typename std::map<uint16_t, Pending>::iterator select() {
+            auto next = pending.end();
+            for (auto it = pending.begin(); it != pending.end(); ++it) {
+                if (busy.count(it->first)) continue;
+                if (next == pending.end() || precedes(*it, *next)) next = it;
+            }
+            return next;
+        }
+
+        bool precedes(const std::pair<const uint16_t, Pending> &a, const std::pair<const uint16_t, Pending> &b) const {
+            bool a_first = !calculated.count(a.first), b_first = !calculated.count(b.first);
+            if (a_first != b_first) return a_first;
+            return a.second.order < b.second.order;
+        }
+
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        std::map<uint16_t, Pending> pending;
+        std::set<uint16_t> busy, calculated;
+        uint64_t order = 0;
+
+        bool closed = false;
+        std::exception_ptr error;
+    };
+}
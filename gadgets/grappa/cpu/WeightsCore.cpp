@@ -1,18 +1,80 @@
 #include "WeightsCore.h"
 
+namespace {
+    using namespace Gadgetron;
+
+    void kernel_pattern(std::vector<int> &kE1, std::vector<int> &oE1, size_t acceleration_factor, size_t width, size_t height) {
+        size_t convKRO, convKE1;
+        Gadgetron::grappa2d_kerPattern(kE1, oE1, convKRO, convKE1, acceleration_factor, width, height, false);
+    }
+}
+
 namespace Gadgetron::Grappa::CPU {
 
-    const hoNDArray<std::complex<float>> &WeightsCore::estimate_coil_map(const hoNDArray<std::complex<float>> &data) {
+    void WeightsCore::update(
+            uint16_t index,
+            const hoNDArray<std::complex<float>> &data,
+            const std::vector<size_t> &lines,
+            Core::optional<uint16_t> acceleration_factor
+    ) {
+        Calibration *calibration;
+        {
+            std::lock_guard<std::mutex> guard(calibrations_mutex);
+            auto &slot = calibrations[index];
+            if (!slot) {
+                slot = std::make_unique<Calibration>();
+                slot->generation = ++generations;
+                slot->equations.initialize(data.get_size(0), data.get_size(1), data.get_size(2), data.get_size(2), 0, data.get_size(0) - 1);
+            }
+            calibration = slot.get();
+        }
+
+        // Without a kernel pattern the lines are only stored; the equations are built once the acceleration is known.
+        if (acceleration_factor) {
+            std::vector<int> kE1, oE1;
+            kernel_pattern(kE1, oE1, *acceleration_factor, kernel_params.width, kernel_params.height);
+            calibration->equations.set_kernel_pattern(kernel_params.width, kE1, oE1);
+        }
+
+        calibration->equations.update(data, data, lines);
+    }
+
+    void WeightsCore::clear(uint16_t index) {
+        std::lock_guard<std::mutex> guard(calibrations_mutex);
+        calibrations.erase(index);
+    }
+
+    WeightsCore::Snapshot WeightsCore::snapshot(uint16_t index) {
+        std::lock_guard<std::mutex> guard(calibrations_mutex);
+        auto it = calibrations.find(index);
+        if (it == calibrations.end()) return {};
+
+        Snapshot snapshot{it->second->generation, grappa2d_calib_equations<std::complex<float>>{}};
+        it->second->equations.snapshot(*snapshot.equations);
+        return snapshot;
+    }
+
+    bool WeightsCore::is_current(uint16_t index, const Snapshot &snapshot) {
+        std::lock_guard<std::mutex> guard(calibrations_mutex);
+        auto it = calibrations.find(index);
+        return it != calibrations.end() && it->second->generation == snapshot.generation;
+    }
+
+    const hoNDArray<std::complex<float>> &WeightsCore::estimate_coil_map(
+            const hoNDArray<std::complex<float>> &data,
+            Buffers &buffers
+    ) {
 
         hoNDFFT<float>::instance()->ifft2c(data, buffers.image);
-        Gadgetron::coil_map_2d_Inati(buffers.image, buffers.coil_map, coil_map_params.ks, coil_map_params.power);
+        Gadgetron::coil_map_2d_Inati(buffers.image, buffers.coil_map, coil_map_params.ks, coil_map_params.power, coil_map_params.downsampling);
 
         return buffers.coil_map;
     }
 
     hoNDArray<std::complex<float>> WeightsCore::fill_in_uncombined_weights(
             hoNDArray<std::complex<float>> &unmixing_coefficients,
-            size_t n_combined_channels
+            size_t n_combined_channels,
+            Buffers &buffers
     ) {
         std::vector<hoNDArray<std::complex<float>>> weights = { unmixing_coefficients };
 
@@ -27,6 +89,8 @@ namespace Gadgetron::Grappa::CPU {
     }
 
     hoNDArray<std::complex<float>> WeightsCore::calculate_weights(
+            uint16_t index,
+            Snapshot snapshot,
             const hoNDArray<std::complex<float>> &data,
             std::array<uint16_t, 4> region_of_support,
             uint16_t acceleration_factor,
@@ -42,22 +106,44 @@ namespace Gadgetron::Grappa::CPU {
 
 
 
-        auto coil_map = estimate_coil_map(data);
-
-
-        Gadgetron::grappa2d_calib_convolution_kernel(
-                data,
-                data,
-                acceleration_factor,
-                kernel_params.threshold,
-                kernel_params.width,
-                kernel_params.height,
-                region_of_support[0],
-                region_of_support[1],
-                region_of_support[2],
-                region_of_support[3],
-                buffers.convolution_kernel
-        );
+        Buffers buffers;
+        auto coil_map = estimate_coil_map(data, buffers);
+
+
+        // The equations of the lines in the buffer were accumulated by update, and taken with the data when the weights
+        // were requested; the region of support is not needed. If the slice was cleared since, or the equations were
+        // built for another acceleration, the slice is calibrated from the data instead.
+        std::vector<int> kE1, oE1;
+        kernel_pattern(kE1, oE1, acceleration_factor, kernel_params.width, kernel_params.height);
+
+        auto &equations = snapshot.equations;
+        if (equations && equations->rows > 0 && equations->kE1 == kE1 && equations->oE1 == oE1 && is_current(index, snapshot)) {
+            hoNDArray<std::complex<float>> kernel;
+            equations->solve(kernel_params.threshold, kernel);
+
+            Gadgetron::grappa2d_convert_to_convolution_kernel(
+                    kernel,
+                    kernel_params.width,
+                    kE1,
+                    oE1,
+                    buffers.convolution_kernel
+            );
+        }
+        else {
+            Gadgetron::grappa2d_calib_convolution_kernel(
+                    data,
+                    data,
+                    acceleration_factor,
+                    kernel_params.threshold,
+                    kernel_params.width,
+                    kernel_params.height,
+                    region_of_support[0],
+                    region_of_support[1],
+                    region_of_support[2],
+                    region_of_support[3],
+                    buffers.convolution_kernel
+            );
+        }
 
         Gadgetron::grappa2d_image_domain_kernel(
                 buffers.convolution_kernel,
@@ -78,7 +164,8 @@ namespace Gadgetron::Grappa::CPU {
 
         return fill_in_uncombined_weights(
                 unmixing_coefficients,
-                n_combined_channels
+                n_combined_channels,
+                buffers
         );
     }
 }
\ No newline at end of file
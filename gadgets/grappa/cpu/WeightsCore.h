@@ -7,11 +7,40 @@
 #include "mri_core_grappa.h"
 #include "mri_core_coil_map_estimation.h"
 
+#include "Types.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
 namespace Gadgetron::Grappa::CPU {
 
     class WeightsCore {
     public:
+        // The equations of a slice as they were when its weights were requested. Each calibration of a slice has its own
+        // generation; the equations are only used if the slice has not been cleared since.
+        struct Snapshot {
+            uint64_t generation = 0;
+            Core::optional<grappa2d_calib_equations<std::complex<float>>> equations;
+        };
+
+        // Adds the lines to the calibration of the slice as they arrive, so calculating weights only solves for the kernel.
+        // Update, clear and snapshot are called from one thread.
+        void update(
+                uint16_t index,
+                const hoNDArray<std::complex<float>> &data,
+                const std::vector<size_t> &lines,
+                Core::optional<uint16_t> acceleration_factor
+        );
+
+        void clear(uint16_t index);
+
+        Snapshot snapshot(uint16_t index);
+
+        // May be called from several threads, and concurrently with update and clear.
         hoNDArray<std::complex<float>> calculate_weights(
+                uint16_t index,
+                Snapshot snapshot,
                 const hoNDArray<std::complex<float>> &data,
                 std::array<uint16_t, 4> region_of_support,
                 uint16_t acceleration_factor,
@@ -19,19 +48,26 @@ namespace Gadgetron::Grappa::CPU {
                 uint16_t n_uncombined_channels
         );
 
+        struct Buffers {
+            hoNDArray<std::complex<float>> image, coil_map, convolution_kernel, image_domain_kernel;
+            hoNDArray<float> g_factor;
+        };
+
         const hoNDArray<std::complex<float>> &
         estimate_coil_map(
-                const hoNDArray<std::complex<float>> &data
+                const hoNDArray<std::complex<float>> &data,
+                Buffers &buffers
         );
 
         hoNDArray<std::complex<float>>
         fill_in_uncombined_weights(
                 hoNDArray<std::complex<float>> &unmixing_coefficients,
-                size_t n_combined_channels
+                size_t n_combined_channels,
+                Buffers &buffers
         );
 
         struct {
-            uint16_t ks, power;
+            uint16_t ks, power, downsampling;
         } coil_map_params;
 
         struct {
@@ -39,10 +75,17 @@ namespace Gadgetron::Grappa::CPU {
             float threshold;
         } kernel_params;
 
-        struct {
-            // We maintain a few buffers to avoid reallocating them repeatedly.
-            hoNDArray<std::complex<float>> image, coil_map, convolution_kernel, image_domain_kernel;
-            hoNDArray<float> g_factor;
-        } buffers;
+        struct Calibration {
+            uint64_t generation;
+            grappa2d_calib_accumulator<std::complex<float>> equations;
+        };
+
+        // Whether the snapshot was taken from the current calibration of the slice.
+        bool is_current(uint16_t index, const Snapshot &snapshot);
+
+        // The mutex guards the map; the calibrations are only used by the thread calling update.
+        std::mutex calibrations_mutex;
+        std::map<uint16_t, std::unique_ptr<Calibration>> calibrations;
+        uint64_t generations = 0;
     };
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 namespace Gadgetron::Grappa::GPU {
 
     hoNDArray<std::complex<float>> WeightsCore::calculate_weights(
+            uint16_t index,
+            Snapshot snapshot,
             const hoNDArray<std::complex<float>> &data,
             std::array<uint16_t, 4> region_of_support,
             uint16_t acceleration_factor,
@@ -19,6 +21,8 @@ namespace Gadgetron::Grappa::GPU {
             throw std::runtime_error("GPU RT Grappa does not currently support uncombined channels.");
         }
 
+        std::lock_guard<std::mutex> guard(mutex);
+
         // First line is a crime. Look at this. Look at it! Enjoy the crime! TODO: Fight crime!
         cuNDArray<complext<float>> k_space_data(reinterpret_cast<const hoNDArray<complext<float>> &>(data));
         cuNDArray<complext<float>> coil_map = estimate_coil_map(k_space_data);
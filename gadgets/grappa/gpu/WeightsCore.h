@@ -4,11 +4,31 @@
 #include "cuNDArray.h"
 #include "cuFFTCachedPlan.h"
 
+#include "Types.h"
+
+#include <mutex>
+
 namespace Gadgetron::Grappa::GPU {
 
     class WeightsCore {
     public:
+        // The GPU calibration works on the whole buffer; lines are not accumulated as they arrive.
+        struct Snapshot {};
+
+        void update(
+                uint16_t index,
+                const hoNDArray<std::complex<float>> &data,
+                const std::vector<size_t> &lines,
+                Core::optional<uint16_t> acceleration_factor
+        ) {}
+
+        void clear(uint16_t index) {}
+
+        Snapshot snapshot(uint16_t index) { return {}; }
+
         hoNDArray<std::complex<float>> calculate_weights(
+                uint16_t index,
+                Snapshot snapshot,
                 const hoNDArray<std::complex<float>> &data,
                 std::array<uint16_t, 4> region_of_support,
                 uint16_t acceleration_factor,
@@ -19,7 +39,7 @@ namespace Gadgetron::Grappa::GPU {
         cuNDArray<complext<float>> estimate_coil_map(const cuNDArray<complext<float>> &);
 
         struct {
-            uint16_t ks, power;
+            uint16_t ks, power, downsampling;
         } coil_map_params;
 
         struct {
@@ -28,6 +48,8 @@ namespace Gadgetron::Grappa::GPU {
         } kernel_params;
 
 
+        // Weights are calculated one at a time; the calculations share the plan and the device.
+        std::mutex mutex;
         cuFFTCachedPlan<complext<float>> fft_plan;
     };
 }
\ No newline at end of file
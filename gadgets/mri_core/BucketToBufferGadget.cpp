@@ -1,8 +1,10 @@
 #include "BucketToBufferGadget.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_reductions.h"
+#include "hoNDArray_mapped.h"
 #include "mri_core_data.h"
 #include <boost/algorithm/string.hpp>
+#include <numeric>
 
 
 using BufferKey =  Gadgetron::BucketToBufferGadget::BufferKey;
@@ -47,6 +49,7 @@ namespace Gadgetron {
 
         for (auto acq_bucket : input) {
             std::map<BufferKey, IsmrmrdReconData> recon_data_buffers;
+            size_t buffered_bytes = 0;
             GDEBUG_STREAM("BUCKET_SIZE " << acq_bucket.data_.size() << " ESPACE " << acq_bucket.refstats_.size());
             // Iterate over the reference data of the bucket
             for (auto& acq : acq_bucket.ref_) {
@@ -57,7 +60,7 @@ namespace Gadgetron {
                 uint16_t espace       = acqhdr.encoding_space_ref;
                 IsmrmrdReconBit& rbit = getRBit(recon_data_buffers, key, espace);
                 if (!rbit.ref_) {
-                    rbit.ref_ = makeDataBuffer(acqhdr, header.encoding[espace], acq_bucket.refstats_[espace], true);
+                    rbit.ref_ = makeDataBuffer(acqhdr, header.encoding[espace], acq_bucket.refstats_[espace], true, buffered_bytes);
                     rbit.ref_->sampling_ = createSamplingDescription(
                         header.encoding[espace], acq_bucket.refstats_[espace], acqhdr, true);
                 }
@@ -76,7 +79,7 @@ namespace Gadgetron {
                 uint16_t espace       = acqhdr.encoding_space_ref;
                 IsmrmrdReconBit& rbit = getRBit(recon_data_buffers, key, espace);
                 if (rbit.data_.data_.empty()) {
-                    rbit.data_ = makeDataBuffer(acqhdr, header.encoding[espace], acq_bucket.datastats_[espace], false);
+                    rbit.data_ = makeDataBuffer(acqhdr, header.encoding[espace], acq_bucket.datastats_[espace], false, buffered_bytes);
                     rbit.data_.sampling_ = createSamplingDescription(
                         header.encoding[espace], acq_bucket.datastats_[espace], acqhdr, false);
                 }
@@ -89,11 +92,17 @@ namespace Gadgetron {
             // Send all the ReconData messages
             GDEBUG("End of bucket reached, sending out %d ReconData buffers\n", recon_data_buffers.size());
 
+            // The buffers are moved on, as copies of mapped buffers would be held in RAM
             for (auto& recon_data_buffer : recon_data_buffers) {
+                for (auto& rbit : recon_data_buffer.second.rbit_) {
+                    advise_sequential(rbit.data_.data_);
+                    if (rbit.ref_) advise_sequential(rbit.ref_->data_);
+                }
+
                 if (acq_bucket.waveform_.empty())
-                    out.push(recon_data_buffer.second);
+                    out.push(std::move(recon_data_buffer.second));
                 else
-                    out.push(recon_data_buffer.second, acq_bucket.waveform_);
+                    out.push(std::move(recon_data_buffer.second), acq_bucket.waveform_);
             }
         }
     }
@@ -160,7 +169,7 @@ namespace Gadgetron {
     }
 
     IsmrmrdDataBuffered BucketToBufferGadget::makeDataBuffer(const ISMRMRD::AcquisitionHeader& acqhdr,
-        ISMRMRD::Encoding encoding, const AcquisitionBucketStats& stats, bool forref) const {
+        ISMRMRD::Encoding encoding, const AcquisitionBucketStats& stats, bool forref, size_t& buffered_bytes) const {
         IsmrmrdDataBuffered buffer;
 
         // Allocate the reference data array
@@ -185,9 +194,18 @@ namespace Gadgetron {
                                              << NE0 << " " << NE1 << " " << NE2 << " " << NCHA << " " << NN << " " << NS
                                              << " " << NLOC << "]");
 
-        // Allocate the array for the data
-        buffer.data_ = hoNDArray<std::complex<float>>(NE0, NE1, NE2, NCHA, NN, NS, NLOC);
-        clear(&buffer.data_);
+        // Allocate the array for the data; a mapped array starts out zero, so it is not cleared
+        std::vector<size_t> dimensions = { NE0, NE1, NE2, NCHA, NN, NS, NLOC };
+        size_t bytes = std::accumulate(dimensions.begin(), dimensions.end(), sizeof(std::complex<float>), std::multiplies<size_t>());
+        buffered_bytes += bytes;
+
+        if (memory_budget_mb && buffered_bytes > memory_budget_mb * 1024 * 1024) {
+            GDEBUG_STREAM("Buffers of the bucket exceed the memory budget; mapping " << bytes << " bytes in " << mapped_buffer_folder);
+            buffer.data_ = create_mapped_array<std::complex<float>>(dimensions, mapped_buffer_folder);
+        } else {
+            buffer.data_ = hoNDArray<std::complex<float>>(dimensions);
+            clear(&buffer.data_);
+        }
 
         // Allocate the array for the headers
         buffer.headers_ = hoNDArray<ISMRMRD::AcquisitionHeader>(NE1, NE2, NN, NS, NLOC);
@@ -546,7 +564,10 @@ namespace Gadgetron {
         }
     }
     BucketToBufferGadget::BucketToBufferGadget(const Core::Context& context, const Core::GadgetProperties& props)
-        : ChannelGadget(context, props), header{ context.header } {}
+        : ChannelGadget(context, props), header{ context.header } {
+        if (memory_budget_mb && mapped_buffer_folder.empty())
+            GADGET_THROW("BucketToBufferGadget: memory_budget_mb requires mapped_buffer_folder, a folder on disk");
+    }
 
     namespace {
         using Dimension = BucketToBufferGadget::Dimension;
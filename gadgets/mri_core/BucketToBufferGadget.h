@@ -42,6 +42,12 @@ namespace Gadgetron {
         NODE_PROPERTY(ignore_segment, bool, "Ignore segment", false);
         NODE_PROPERTY(verbose, bool, "Whether to print more information", false);
 
+        // Buffers of long 3D, 4D flow or free breathing scans may not fit in RAM; beyond the budget they are kept in
+        // memory mapped temporary files, which downstream gadgets use like any other buffer. There is no default folder,
+        // as /tmp is often a tmpfs, which keeps the files in RAM after all
+        NODE_PROPERTY(memory_budget_mb, size_t, "Buffers of a bucket beyond this size, in MB, are memory mapped; 0 keeps all buffers in RAM", 0);
+        NODE_PROPERTY(mapped_buffer_folder, std::string, "Folder on disk for the temporary files of memory mapped buffers; required with a memory budget", "");
+
         ISMRMRD::IsmrmrdHeader header;
 
         void process(Core::InputChannel<AcquisitionBucket>& in, Core::OutputChannel& out) override;
@@ -49,7 +55,7 @@ namespace Gadgetron {
 
 
         IsmrmrdDataBuffered makeDataBuffer(const ISMRMRD::AcquisitionHeader& acqhdr, ISMRMRD::Encoding encoding,
-            const AcquisitionBucketStats& stats, bool forref) const;
+            const AcquisitionBucketStats& stats, bool forref, size_t& buffered_bytes) const;
         SamplingDescription createSamplingDescription(const ISMRMRD::Encoding& encoding,
             const AcquisitionBucketStats& stats, const ISMRMRD::AcquisitionHeader& acqhdr, bool forref) const ;
         void add_acquisition(IsmrmrdDataBuffered& dataBuffer, const Core::Acquisition& acq, ISMRMRD::Encoding encoding,
@@ -1,11 +1,131 @@
 #include "IsmrmrdDumpGadget.h"
 #include <iomanip>
+#include <fstream>
+#include <list>
 #include <boost/filesystem.hpp>
 #include "network_utils.h"
+#include "io/primitives.h"
 #include <thread>
 
 namespace bf = boost::filesystem;
 
+namespace {
+    using namespace Gadgetron;
+
+    using DumpItem = Core::variant<Core::Acquisition, Core::Waveform>;
+
+    size_t size_in_bytes(const Core::Acquisition& acq) {
+        const auto& [head, data, traj] = acq;
+        return sizeof(head) + data.get_number_of_bytes() + (traj ? traj->get_number_of_bytes() : 0);
+    }
+
+    size_t size_in_bytes(const Core::Waveform& wav) {
+        const auto& [head, data] = wav;
+        return sizeof(head) + data.get_number_of_bytes();
+    }
+
+    // Items waiting for the dump file writer, bounded by the memory they hold
+    class DumpQueue {
+    public:
+        explicit DumpQueue(size_t max_bytes) : max_bytes(max_bytes) {}
+
+        // Leaves the item with the caller if the queue is full; an empty queue takes any item
+        bool try_push(DumpItem& item) {
+            auto bytes = Core::visit([](const auto& i) { return size_in_bytes(i); }, item);
+            {
+                std::lock_guard<std::mutex> guard(m);
+                if (!has_room(bytes)) return false;
+                add(std::move(item), bytes);
+            }
+            cv.notify_all();
+            return true;
+        }
+
+        void push(DumpItem item) {
+            auto bytes = Core::visit([](const auto& i) { return size_in_bytes(i); }, item);
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&]() { return has_room(bytes) || closed; });
+                add(std::move(item), bytes);
+            }
+            cv.notify_all();
+        }
+
+        DumpItem pop() {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this]() { return !queue.empty() || closed; });
+            if (queue.empty()) throw Core::ChannelClosed();
+
+            auto [item, bytes] = std::move(queue.front());
+            queue.pop_front();
+            used_bytes -= bytes;
+
+            lock.unlock();
+            cv.notify_all();
+            return std::move(item);
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> guard(m);
+                closed = true;
+            }
+            cv.notify_all();
+        }
+
+    private:
+        bool has_room(size_t bytes) const {
+            return queue.empty() || used_bytes + bytes <= max_bytes;
+        }
+
+        void add(DumpItem item, size_t bytes) {
+            if (closed) throw Core::ChannelClosed();
+            queue.emplace_back(std::move(item), bytes);
+            used_bytes += bytes;
+        }
+
+        std::mutex m;
+        std::condition_variable cv;
+        std::list<std::pair<DumpItem, size_t>> queue;
+        size_t used_bytes = 0;
+        const size_t max_bytes;
+        bool closed = false;
+    };
+
+    // The spill log is a plain sequence of items, each its variant index followed by the item as Gadgetron writes it
+    void write_to_log(std::ostream& log, const DumpItem& item) {
+        Core::IO::write(log, uint16_t(item.index()));
+        Core::visit([&log](const auto& i) { Core::IO::write(log, i); }, item);
+    }
+
+    DumpItem read_from_log(std::istream& log) {
+        auto index = Core::IO::read<uint16_t>(log);
+        if (index == 0) return Core::IO::read<Core::Acquisition>(log);
+        return Core::IO::read<Core::Waveform>(log);
+    }
+
+    // Completes the spill log, closes the queue and joins the writer, also when process leaves by an exception
+    class WriterGuard {
+    public:
+        WriterGuard(DumpQueue& queue, std::ofstream& log, std::thread& writer) : queue(queue), log(log), writer(writer) {}
+
+        ~WriterGuard() {
+            stop();
+        }
+
+        void stop() {
+            if (log.is_open()) log.close();
+            queue.close();
+            if (writer.joinable()) writer.join();
+        }
+
+    private:
+        DumpQueue& queue;
+        std::ofstream& log;
+        std::thread& writer;
+    };
+}
+
 
 namespace Gadgetron
 {
@@ -87,7 +207,7 @@ namespace Gadgetron
         }
     }
 
-    ISMRMRD::Dataset IsmrmrdDumpGadget::create_ismrmrd_dataset() const 
+    std::string IsmrmrdDumpGadget::create_dump_filename() const
     {
             std::string measurement_id = "";
             std::string ismrmrd_filename = "";
@@ -181,7 +301,7 @@ namespace Gadgetron
             ismrmrd_filename = filepath.string();
             GDEBUG_STREAM("KSpace dump file name : " << ismrmrd_filename);
 
-            return ISMRMRD::Dataset(ismrmrd_filename.c_str(), "dataset", true);
+            return ismrmrd_filename;
         }
 
     static void append_to_dataset(const Core::Acquisition& acq, ISMRMRD::Dataset& dataset){
@@ -222,42 +342,95 @@ namespace Gadgetron
 
 
 
-        Core::MPMCChannel<Core::variant<Core::Acquisition,Core::Waveform>> data_buffer;
+        auto ismrmrd_filename = create_dump_filename();
+        auto spill_filename = ismrmrd_filename + ".spill";
 
-        auto save_thread = std::thread([&data_buffer,this](){
-            auto dataset = create_ismrmrd_dataset();
+        DumpQueue data_buffer(writer_queue_mb * 1024 * 1024);
+        bool spilled = false;
 
-            {
-                auto stream = std::stringstream();
-                ISMRMRD::serialize(header,stream);
-                dataset.writeHeader(stream.str());
-                GDEBUG_STREAM("IsmrmrdDumpGadget, save ismrmrd xml header ... ");
-            }
+        // Once spilling, everything goes to the log, so the dump file keeps the order of the stream
+        std::vector<char> log_buffer;
+        std::ofstream log;
 
+        // Closing the queue on a failure releases a process blocked on a full queue; the error is rethrown after the join
+        std::exception_ptr save_error;
 
+        auto save_thread = std::thread([&data_buffer,&spilled,&save_error,&ismrmrd_filename,&spill_filename,this](){
             try {
-                for (;;) {
-                    Core::visit([&dataset](const auto& item) { append_to_dataset(item, dataset); }, data_buffer.pop());
+                auto dataset = ISMRMRD::Dataset(ismrmrd_filename.c_str(), "dataset", true);
+
+                {
+                    auto stream = std::stringstream();
+                    ISMRMRD::serialize(header,stream);
+                    dataset.writeHeader(stream.str());
+                    GDEBUG_STREAM("IsmrmrdDumpGadget, save ismrmrd xml header ... ");
+                }
+
+                auto append = [&dataset](const auto& item) { append_to_dataset(item, dataset); };
+
+                try {
+                    for (;;) {
+                        Core::visit(append, data_buffer.pop());
+                    }
+                } catch (const Core::ChannelClosed& closed) {
                 }
-            } catch (const Core::ChannelClosed& closed) {              
+
+                // The queue is closed after the last item is spilled, so the log is complete here
+                if (spilled) {
+                    GDEBUG_STREAM("IsmrmrdDumpGadget, converting spill log " << spill_filename);
+                    std::ifstream log(spill_filename, std::ios::binary);
+                    while (log.peek() != std::ifstream::traits_type::eof()) {
+                        Core::visit(append, read_from_log(log));
+                    }
+                    log.close();
+                    bf::remove(spill_filename);
+                }
+            } catch (...) {
+                save_error = std::current_exception();
+                data_buffer.close();
             }
         });
 
+        WriterGuard writer(data_buffer, log, save_thread);
+
         if (save_xml_header_only){
             GDEBUG_STREAM("Only saving header");
             data_buffer.close();
             move_if(input,output, is_valid_type);
-            save_thread.join();
+            writer.stop();
+            if (save_error) std::rethrow_exception(save_error);
             return;
         }
-        
-        for (auto item : input){
-            data_buffer.push(item);
-            if (is_valid_type(item))
-                output.push(std::move(item));
+
+        try {
+            for (auto item : input){
+                auto dumped = item;
+
+                if (!spilled && !data_buffer.try_push(dumped)) {
+                    if (spill_to_log) {
+                        GWARN_STREAM("IsmrmrdDumpGadget, writer is falling behind; spilling to " << spill_filename);
+                        log_buffer.resize(size_t(16) * 1024 * 1024);
+                        log.rdbuf()->pubsetbuf(log_buffer.data(), log_buffer.size());
+                        log.open(spill_filename, std::ios::binary | std::ios::trunc);
+                        if (!log) GADGET_THROW("Failed to open spill log " + spill_filename);
+                        spilled = true;
+                    } else {
+                        data_buffer.push(std::move(dumped));
+                    }
+                }
+                if (spilled) write_to_log(log, dumped);
+
+                if (is_valid_type(item))
+                    output.push(std::move(item));
+            }
+        } catch (const Core::ChannelClosed&) {
+            // The writer closes the queue when it fails; its error is the one to report
+            writer.stop();
+            if (!save_error) throw;
         }
-        data_buffer.close();
-        save_thread.join();
+
+        writer.stop();
+        if (save_error) std::rethrow_exception(save_error);
     }
     GADGETRON_GADGET_EXPORT(IsmrmrdDumpGadget);
 
@@ -42,6 +42,10 @@ namespace Gadgetron {
         // TODO: remove this option
         NODE_PROPERTY(pass_waveform_downstream, bool, "If true, waveform data is passed downstream", false);
 
+        // The dump file is written by its own thread, so the stream does not wait for HDF5
+        NODE_PROPERTY(writer_queue_mb, size_t, "Data held in memory for the dump file writer, in MB", 256);
+        NODE_PROPERTY(spill_to_log, bool, "If true, data the dump file writer cannot keep up with is appended to a log and converted after the scan; otherwise the stream waits for the writer", true);
+
 
         void process(Core::InputChannel<Core::variant<Core::Acquisition,Core::Waveform>>& input, Core::OutputChannel& output) override;
 
@@ -50,7 +54,7 @@ namespace Gadgetron {
 
         const bool save_ismrmrd_data_;
 
-        ISMRMRD::Dataset create_ismrmrd_dataset() const;
+        std::string create_dump_filename() const;
         bool  is_ip_on_blacklist() const ; 
     };
 
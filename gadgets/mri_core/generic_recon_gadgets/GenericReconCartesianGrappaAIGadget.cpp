@@ -505,7 +505,9 @@ namespace Gadgetron {
         }
         else
         {
-            PythonFunction< hoNDArray<T> > apply_grappa_ai("grappa_ai", "apply_grappa_ai_model");
+            // dataA is handed to python as a view of its memory and the recon returned by python is adopted,
+            // neither is copied; python must not keep dataA, which is refilled for the next ii
+            PythonFunction< std::shared_ptr< hoNDArray<T> > > apply_grappa_ai("grappa_ai", "apply_grappa_ai_model");
 
             size_t kRO = grappa_kSize_RO.value();
             size_t kNE1 = grappa_kSize_E1.value();
@@ -522,9 +524,9 @@ namespace Gadgetron {
 
 //#pragma omp parallel default(none) private(ii) shared(num, N, S, kRO, kE1, oE1, RO, E1, E2, srcCHA, convkRO, convkE1, convkE2, ref_N, ref_S, recon_obj, dstCHA, unmixingCoeff_CHA, e, recon_bit, periodic_boundary_condition, apply_grappa_ai) if(num>1)
             {
-                hoNDArray<T> dataA;
+                std::shared_ptr< hoNDArray<T> > dataA = std::make_shared< hoNDArray<T> >();
                 hoNDArray<unsigned short> dataAInd;
-                hoNDArray<T> recon;
+                std::shared_ptr< hoNDArray<T> > recon;
                 hoNDArray<T> res_grappa, im_grappa, im_combined_grappa;
                 hoNDArray<T> res_ai, im_ai, im_combined_ai;
 
@@ -548,13 +550,13 @@ namespace Gadgetron {
 
                     size_t ref_ii = usedN + usedS * ref_N + slc * ref_N*ref_S;
 
-                    Gadgetron::grappa2d_prepare_recon(data, kRO, kE1, oE1, periodic_boundary_condition, dataA, dataAInd);
+                    Gadgetron::grappa2d_prepare_recon(data, kRO, kE1, oE1, periodic_boundary_condition, *dataA, dataAInd);
 
                     hoNDArray<T> coilMap(RO, E1, dstCHA, &(recon_obj.coil_map_(0, 0, 0, 0, usedN, usedS, slc)));
 
                     // grappa recon
                     res_grappa = data;
-                    Gadgetron::grappa2d_perform_recon(dataA, kernels_[e][ref_ii], dataAInd, oE1, RO, E1, res_grappa);
+                    Gadgetron::grappa2d_perform_recon(*dataA, kernels_[e][ref_ii], dataAInd, oE1, RO, E1, res_grappa);
 
                     Gadgetron::hoNDFFT<float>::instance()->ifft2c(res_grappa, im_grappa);
                     Gadgetron::coil_combine(im_grappa, coilMap, 2, im_combined_grappa);
@@ -565,7 +567,7 @@ namespace Gadgetron {
                     im_ai = im_grappa;
                     recon = apply_grappa_ai(dataA, models_[e][ref_ii]);
                     res_ai = data;
-                    Gadgetron::grappa2d_fill_reconed_kspace(dataAInd, recon, oE1, RO, E1, res_ai);
+                    Gadgetron::grappa2d_fill_reconed_kspace(dataAInd, *recon, oE1, RO, E1, res_ai);
                     Gadgetron::hoNDFFT<float>::instance()->ifft2c(res_ai, im_ai);
                     Gadgetron::coil_combine(im_ai, coilMap, 2, im_combined_ai);
 
@@ -77,6 +77,8 @@ namespace Gadgetron {
         GADGET_PROPERTY(grappa_kSize_E2, int, "Grappa kernel size E2", 4);
         GADGET_PROPERTY(grappa_reg_lamda, double, "Grappa regularization threshold", 0.0005);
         GADGET_PROPERTY(grappa_calib_over_determine_ratio, double, "Grappa calibration overdermination ratio", 45);
+        GADGET_PROPERTY(use_fused_unwrapping, bool, "Whether to inverse fft, unmix and scale each image in one pass when unwrapping", false);
+        GADGET_PROPERTY(unwrapping_channel_tile, size_t, "Number of channels inverse fft-ed together when unwrapping an image, 0 for all", 4);
 
         /// ------------------------------------------------------------------------------------
         /// down stream coil compression
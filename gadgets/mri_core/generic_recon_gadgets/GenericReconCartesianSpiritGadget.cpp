@@ -4,6 +4,8 @@
 #include "hoNDArray_reductions.h"
 #include "hoSPIRIT2DOperator.h"
 #include "hoLsqrSolver.h"
+#include "hoSPIRIT2DTOperator.h"
+#include "hoLsqrBatchSolver.h"
 #include "mri_core_grappa.h"
 
 namespace Gadgetron {
@@ -673,104 +675,193 @@ namespace Gadgetron {
             kspace_Shifted = kspace;
             Gadgetron::hoNDFFT<float>::instance()->ifftshift2D(kspace, kspace_Shifted);
 
+            if (this->spirit_batch_solve.value())
+            {
+                this->perform_spirit_unwrapping_batch(kspace_Shifted, ker_Shifted, res);
+            }
+            else
+            {
+#ifdef USE_OMP
+                int numThreads = (int)num;
+                if (numThreads > omp_get_num_procs()) numThreads = omp_get_num_procs();
+                GDEBUG_CONDITION_STREAM(this->verbose.value(), "numThreads : " << numThreads);
+#endif // USE_OMP
+
+                std::vector<size_t> dim(3, 1);
+                dim[0] = RO;
+                dim[1] = E1;
+                dim[2] = CHA;
+
+#pragma omp parallel default(none) private(ii) shared(num, N, S, RO, E1, CHA, dim, ref_N, ref_S, kspace, res, kspace_Shifted, ker_Shifted, iter_max, iter_thres, print_iter) num_threads(numThreads) if(num>1) 
+                {
+                    boost::shared_ptr< hoSPIRIT2DOperator< std::complex<float> > > oper(new hoSPIRIT2DOperator< std::complex<float> >(&dim));
+                    hoSPIRIT2DOperator< std::complex<float> >& spirit = *oper;
+                    spirit.use_non_centered_fft_ = true;
+                    spirit.no_null_space_ = false;
+
+                    if (ref_N == 1 && ref_S == 1)
+                    {
+                        boost::shared_ptr<hoNDArray< std::complex<float> > > ker(new hoNDArray< std::complex<float> >(RO, E1, CHA, CHA, ker_Shifted.begin()));
+                        spirit.set_forward_kernel(*ker, false);
+                    }
+
+                    hoLsqrSolver< std::complex<float> > cgSolver;
+                    cgSolver.set_tc_tolerance((float)iter_thres);
+                    cgSolver.set_max_iterations(iter_max);
+                    cgSolver.set_output_mode(print_iter ? hoLsqrSolver< std::complex<float> >::OUTPUT_VERBOSE : hoLsqrSolver< std::complex<float> >::OUTPUT_SILENT);
+                    cgSolver.set_encoding_operator(oper);
+
+                    hoNDArray< std::complex<float> > b(RO, E1, CHA);
+                    hoNDArray< std::complex<float> > unwarppedKSpace(RO, E1, CHA);
+
+#pragma omp for 
+                    for (ii = 0; ii < num; ii++)
+                    {
+                        size_t slc = ii / (N*S);
+                        size_t s = (ii - slc*N*S) / N;
+                        size_t n = ii - slc*N*S - s*N;
+
+                        // check whether the kspace is undersampled
+                        bool undersampled = false;
+                        for (size_t e1 = 0; e1 < E1; e1++)
+                        {
+                            if ((std::abs(kspace(RO / 2, e1, 0, CHA - 1, n, s, slc)) == 0)
+                                && (std::abs(kspace(RO / 2, e1, 0, 0, n, s, slc)) == 0))
+                            {
+                                undersampled = true;
+                                break;
+                            }
+                        }
+
+                        std::complex<float>* pKpaceShifted = &(kspace_Shifted(0, 0, 0, 0, n, s, slc));
+                        std::complex<float>* pRes = &(res(0, 0, 0, 0, n, s, slc));
+
+                        if (!undersampled)
+                        {
+                            memcpy(pRes, pKpaceShifted, sizeof(std::complex<float>)*RO*E1*CHA);
+                            continue;
+                        }
+
+                        long long kernelN = n;
+                        if (kernelN >= (long long)ref_N) kernelN = (long long)ref_N - 1;
+
+                        long long kernelS = s;
+                        if (kernelS >= (long long)ref_S) kernelS = (long long)ref_S - 1;
+
+                        boost::shared_ptr< hoNDArray< std::complex<float> > > acq(new hoNDArray< std::complex<float> >(RO, E1, CHA, pKpaceShifted));
+                        spirit.set_acquired_points(*acq);
+                        cgSolver.set_x0(acq);
+
+                        if (ref_N == 1 && ref_S == 1)
+                        {
+                            spirit.compute_righ_hand_side(*acq, b);
+                            cgSolver.solve(&unwarppedKSpace, &b);
+                        }
+                        else
+                        {
+                            std::complex<float>* pKer = &(ker_Shifted(0, 0, 0, 0, kernelN, kernelS, slc));
+                            boost::shared_ptr<hoNDArray< std::complex<float> > > ker(new hoNDArray< std::complex<float> >(RO, E1, CHA, CHA, pKer));
+                            spirit.set_forward_kernel(*ker, false);
+
+                            spirit.compute_righ_hand_side(*acq, b);
+                            cgSolver.solve(&unwarppedKSpace, &b);
+                        }
+
+                        // restore the acquired points
+                        spirit.restore_acquired_kspace(*acq, unwarppedKSpace);
+                        memcpy(pRes, unwarppedKSpace.begin(), unwarppedKSpace.get_number_of_bytes());
+                    }
+                }
+            }
+
+            Gadgetron::hoNDFFT<float>::instance()->fftshift2D(res, kspace_Shifted);
+            res = kspace_Shifted;
+        }
+        catch (...)
+        {
+            GADGET_THROW("Errors happened in GenericReconCartesianSpiritGadget::perform_spirit_unwrapping(...) ... ");
+        }
+    }
+
+    void GenericReconCartesianSpiritGadget::perform_spirit_unwrapping_batch(hoNDArray< std::complex<float> >& kspace_Shifted, hoNDArray< std::complex<float> >& ker_Shifted, hoNDArray< std::complex<float> >& res)
+    {
+        try
+        {
+            size_t iter_max = this->spirit_iter_max.value();
+            double iter_thres = this->spirit_iter_thres.value();
+            bool print_iter = this->spirit_print_iter.value();
+
+            size_t RO = kspace_Shifted.get_size(0);
+            size_t E1 = kspace_Shifted.get_size(1);
+            size_t CHA = kspace_Shifted.get_size(3);
+            size_t N = kspace_Shifted.get_size(4);
+            size_t S = kspace_Shifted.get_size(5);
+            size_t SLC = kspace_Shifted.get_size(6);
+
+            size_t ref_N = ker_Shifted.get_size(4);
+            size_t ref_S = ker_Shifted.get_size(5);
+
+            // every S and SLC is one batch of N systems; fully sampled N are frozen by the solver after the first step
+            long long num = S*SLC;
+            long long ii;
+
 #ifdef USE_OMP
             int numThreads = (int)num;
             if (numThreads > omp_get_num_procs()) numThreads = omp_get_num_procs();
             GDEBUG_CONDITION_STREAM(this->verbose.value(), "numThreads : " << numThreads);
 #endif // USE_OMP
 
-            std::vector<size_t> dim(3, 1);
+            std::vector<size_t> dim(4, 1);
             dim[0] = RO;
             dim[1] = E1;
             dim[2] = CHA;
+            dim[3] = N;
 
-#pragma omp parallel default(none) private(ii) shared(num, N, S, RO, E1, CHA, dim, ref_N, ref_S, kspace, res, kspace_Shifted, ker_Shifted, iter_max, iter_thres, print_iter) num_threads(numThreads) if(num>1) 
+#pragma omp parallel default(none) private(ii) shared(num, S, RO, E1, CHA, N, dim, ref_N, ref_S, res, kspace_Shifted, ker_Shifted, iter_max, iter_thres, print_iter) num_threads(numThreads) if(num>1) 
             {
-                boost::shared_ptr< hoSPIRIT2DOperator< std::complex<float> > > oper(new hoSPIRIT2DOperator< std::complex<float> >(&dim));
-                hoSPIRIT2DOperator< std::complex<float> >& spirit = *oper;
+                boost::shared_ptr< hoSPIRIT2DTOperator< std::complex<float> > > oper(new hoSPIRIT2DTOperator< std::complex<float> >(&dim));
+                hoSPIRIT2DTOperator< std::complex<float> >& spirit = *oper;
                 spirit.use_non_centered_fft_ = true;
                 spirit.no_null_space_ = false;
 
-                if (ref_N == 1 && ref_S == 1)
-                {
-                    boost::shared_ptr<hoNDArray< std::complex<float> > > ker(new hoNDArray< std::complex<float> >(RO, E1, CHA, CHA, ker_Shifted.begin()));
-                    spirit.set_forward_kernel(*ker, false);
-                }
-
-                hoLsqrSolver< std::complex<float> > cgSolver;
-                cgSolver.set_tc_tolerance((float)iter_thres);
-                cgSolver.set_max_iterations(iter_max);
-                cgSolver.set_output_mode(print_iter ? hoLsqrSolver< std::complex<float> >::OUTPUT_VERBOSE : hoLsqrSolver< std::complex<float> >::OUTPUT_SILENT);
-                cgSolver.set_encoding_operator(oper);
+                hoLsqrBatchSolver< std::complex<float> > solver;
+                solver.set_tc_tolerance((float)iter_thres);
+                solver.set_max_iterations(iter_max);
+                solver.set_output_mode(print_iter ? hoLsqrBatchSolver< std::complex<float> >::OUTPUT_VERBOSE : hoLsqrBatchSolver< std::complex<float> >::OUTPUT_SILENT);
+                solver.set_encoding_operator(oper);
 
-                hoNDArray< std::complex<float> > b(RO, E1, CHA);
-                hoNDArray< std::complex<float> > unwarppedKSpace(RO, E1, CHA);
+                hoNDArray< std::complex<float> > b(RO, E1, CHA, N);
+                hoNDArray< std::complex<float> > unwarppedKSpace(RO, E1, CHA, N);
 
 #pragma omp for 
                 for (ii = 0; ii < num; ii++)
                 {
-                    size_t slc = ii / (N*S);
-                    size_t s = (ii - slc*N*S) / N;
-                    size_t n = ii - slc*N*S - s*N;
-
-                    // check whether the kspace is undersampled
-                    bool undersampled = false;
-                    for (size_t e1 = 0; e1 < E1; e1++)
-                    {
-                        if ((std::abs(kspace(RO / 2, e1, 0, CHA - 1, n, s, slc)) == 0)
-                            && (std::abs(kspace(RO / 2, e1, 0, 0, n, s, slc)) == 0))
-                        {
-                            undersampled = true;
-                            break;
-                        }
-                    }
-
-                    std::complex<float>* pKpaceShifted = &(kspace_Shifted(0, 0, 0, 0, n, s, slc));
-                    std::complex<float>* pRes = &(res(0, 0, 0, 0, n, s, slc));
-
-                    if (!undersampled)
-                    {
-                        memcpy(pRes, pKpaceShifted, sizeof(std::complex<float>)*RO*E1*CHA);
-                        continue;
-                    }
-
-                    long long kernelN = n;
-                    if (kernelN >= (long long)ref_N) kernelN = (long long)ref_N - 1;
+                    size_t slc = ii / S;
+                    size_t s = ii - slc*S;
 
                     long long kernelS = s;
                     if (kernelS >= (long long)ref_S) kernelS = (long long)ref_S - 1;
 
-                    boost::shared_ptr< hoNDArray< std::complex<float> > > acq(new hoNDArray< std::complex<float> >(RO, E1, CHA, pKpaceShifted));
-                    spirit.set_acquired_points(*acq);
-                    cgSolver.set_x0(acq);
+                    // the 2D+T operator uses kernel min(n, ref_N-1) for the n-th system
+                    hoNDArray< std::complex<float> > ker(RO, E1, CHA, CHA, ref_N, &(ker_Shifted(0, 0, 0, 0, 0, kernelS, slc)));
+                    spirit.set_forward_kernel(ker, false);
 
-                    if (ref_N == 1 && ref_S == 1)
-                    {
-                        spirit.compute_righ_hand_side(*acq, b);
-                        cgSolver.solve(&unwarppedKSpace, &b);
-                    }
-                    else
-                    {
-                        std::complex<float>* pKer = &(ker_Shifted(0, 0, 0, 0, kernelN, kernelS, slc));
-                        boost::shared_ptr<hoNDArray< std::complex<float> > > ker(new hoNDArray< std::complex<float> >(RO, E1, CHA, CHA, pKer));
-                        spirit.set_forward_kernel(*ker, false);
+                    boost::shared_ptr< hoNDArray< std::complex<float> > > acq(new hoNDArray< std::complex<float> >(RO, E1, CHA, N, &(kspace_Shifted(0, 0, 0, 0, 0, s, slc))));
+                    spirit.set_acquired_points(*acq);
+                    solver.set_x0(acq);
 
-                        spirit.compute_righ_hand_side(*acq, b);
-                        cgSolver.solve(&unwarppedKSpace, &b);
-                    }
+                    spirit.compute_righ_hand_side(*acq, b);
+                    solver.solve(&unwarppedKSpace, &b);
 
                     // restore the acquired points
                     spirit.restore_acquired_kspace(*acq, unwarppedKSpace);
-                    memcpy(pRes, unwarppedKSpace.begin(), unwarppedKSpace.get_number_of_bytes());
+                    memcpy(&(res(0, 0, 0, 0, 0, s, slc)), unwarppedKSpace.begin(), unwarppedKSpace.get_number_of_bytes());
                 }
             }
-
-            Gadgetron::hoNDFFT<float>::instance()->fftshift2D(res, kspace_Shifted);
-            res = kspace_Shifted;
         }
         catch (...)
         {
-            GADGET_THROW("Errors happened in GenericReconCartesianSpiritGadget::perform_spirit_unwrapping(...) ... ");
+            GADGET_THROW("Errors happened in GenericReconCartesianSpiritGadget::perform_spirit_unwrapping_batch(...) ... ");
         }
     }
 
@@ -80,6 +80,7 @@ namespace Gadgetron {
         GADGET_PROPERTY(spirit_iter_max, int, "Spirit maximal number of iterations", 0);
         GADGET_PROPERTY(spirit_iter_thres, double, "Spirit threshold to stop iteration", 0);
         GADGET_PROPERTY(spirit_print_iter, bool, "Spirit print out iterations", false);
+        GADGET_PROPERTY(spirit_batch_solve, bool, "Spirit solves all N of a S/SLC together with a batched 2D+T operator; off keeps the per-frame solve", false);
 
     protected:
 
@@ -110,6 +111,10 @@ namespace Gadgetron {
         // kspace, kerIm, full_kspace: [RO E1 CHA N S SLC]
         void perform_spirit_unwrapping(hoNDArray< std::complex<float> >& kspace, hoNDArray< std::complex<float> >& kerIm, hoNDArray< std::complex<float> >& full_kspace);
 
+        // perform spirit unwrapping for all N of every S and SLC in lockstep
+        // kspace_Shifted, ker_Shifted, res: ifftshifted [RO E1 E2 CHA N S SLC]
+        void perform_spirit_unwrapping_batch(hoNDArray< std::complex<float> >& kspace_Shifted, hoNDArray< std::complex<float> >& ker_Shifted, hoNDArray< std::complex<float> >& res);
+
         // perform coil combination
         void perform_spirit_coil_combine(ReconObjType& recon_obj);
     };
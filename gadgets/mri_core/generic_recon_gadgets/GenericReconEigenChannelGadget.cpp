@@ -167,13 +167,15 @@ namespace Gadgetron {
                 {
                     // use ref to compute coefficients
                     Gadgetron::compute_eigen_channel_coefficients(rbit.ref_->data_, average_N, average_S,
-                        (calib_mode_[e] == Gadgetron::ISMRMRD_interleaved), N, S, upstream_coil_compression_thres.value(), upstream_coil_compression_num_modesKept.value(), KLT_[e]);
+                        (calib_mode_[e] == Gadgetron::ISMRMRD_interleaved), N, S, upstream_coil_compression_thres.value(), upstream_coil_compression_num_modesKept.value(), KLT_[e],
+                        upstream_coil_compression_energy_thres.value(), eigen_channel_stable_tolerance.value());
                 }
                 else
                 {
                     // use data to compute coefficients
                     Gadgetron::compute_eigen_channel_coefficients(rbit.data_.data_, average_N, average_S,
-                        (calib_mode_[e] == Gadgetron::ISMRMRD_interleaved), N, S, upstream_coil_compression_thres.value(), upstream_coil_compression_num_modesKept.value(), KLT_[e]);
+                        (calib_mode_[e] == Gadgetron::ISMRMRD_interleaved), N, S, upstream_coil_compression_thres.value(), upstream_coil_compression_num_modesKept.value(), KLT_[e],
+                        upstream_coil_compression_energy_thres.value(), eigen_channel_stable_tolerance.value());
                 }
 
                 if (verbose.value())
@@ -50,6 +50,13 @@ namespace Gadgetron {
         /// the first N and first S will be used to compute number of channels to keep
         GADGET_PROPERTY(upstream_coil_compression_thres, double, "Threadhold for upstream coil compression", -1);
         GADGET_PROPERTY(upstream_coil_compression_num_modesKept, int, "Number of modes to keep for upstream coil compression", 0);
+        /// if upstream_coil_compression_num_modesKept<=0 and upstream_coil_compression_energy_thres>0, the modes holding this fraction of the energy are kept,
+        /// computed with a randomized decomposition from a subset of the samples (see hoNDKLT::prepare_randomized)
+        GADGET_PROPERTY(upstream_coil_compression_energy_thres, double, "Fraction of the energy kept for upstream coil compression, with a randomized decomposition", -1);
+
+        /// if eigen_channel_stable_tolerance>0, KLT coefficients are reused for N, S or incoming IsmrmrdReconData they still describe within this tolerance
+        /// the tolerance is the summed difference of the relative energy along every kept mode, see hoNDKLT::is_stable
+        GADGET_PROPERTY(eigen_channel_stable_tolerance, double, "Tolerance to reuse KLT coefficients for stable data", 0);
 
     protected:
 
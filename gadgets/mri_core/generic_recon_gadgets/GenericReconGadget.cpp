@@ -437,8 +437,9 @@ namespace Gadgetron {
                 size_t ks    = this->coil_map_kernel_size_readout.value();
                 size_t kz    = this->coil_map_kernel_size_phase.value();
                 size_t power = 3;
+                size_t downsampling = this->coil_map_downsampling.value();
 
-                Gadgetron::coil_map_Inati(complex_im_recon_buf_, coil_map, ks, kz, power);
+                Gadgetron::coil_map_Inati(complex_im_recon_buf_, coil_map, ks, kz, power, downsampling);
             } else {
                 size_t ks      = this->coil_map_kernel_size_readout.value();
                 size_t kz      = this->coil_map_kernel_size_phase.value();
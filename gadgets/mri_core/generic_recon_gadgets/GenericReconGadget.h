@@ -41,6 +41,7 @@ namespace Gadgetron {
         GADGET_PROPERTY(coil_map_kernel_size_phase, size_t, "Coil map estimation, kernel size along phase/slice encoding", 5);
         GADGET_PROPERTY(coil_map_num_iter, size_t, "Coil map estimation, number of iterations", 10);
         GADGET_PROPERTY(coil_map_thres_iter, double, "Coil map estimation, threshold to stop iteration", 1e-4);
+        GADGET_PROPERTY(coil_map_downsampling, size_t, "Coil map estimation, Inati coil maps are estimated at every n-th pixel and interpolated in between", 1);
 
     protected:
 
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "Channel.h"
+#include "ChannelSelector.h"
+#include "Context.h"
+#include "parallel/OrderedMerge.h"
+#include "parallel/UnorderedMerge.h"
+
+#include <thread>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Core::Parallel;
+
+namespace {
+
+    Acquisition acquisition(uint32_t time_stamp, uint32_t scan_counter) {
+        ISMRMRD::AcquisitionHeader header{};
+        header.acquisition_time_stamp = time_stamp;
+        header.scan_counter = scan_counter;
+        return Acquisition(header, hoNDArray<std::complex<float>>(4), none);
+    }
+
+    // Runs a merge over branches holding the given acquisitions, returning the time stamps in the order of the output
+    template<class MERGE>
+    std::vector<uint32_t> merge(const std::vector<std::vector<Acquisition>> &branches, GadgetProperties properties) {
+        std::map<std::string, GenericInputChannel> inputs;
+        for (size_t index = 0; index < branches.size(); index++) {
+            auto channel = make_channel<MessageChannel>();
+            for (auto &acq : branches[index]) channel.output.push(acq);
+            inputs.emplace("branch" + std::to_string(index), std::move(channel.input));
+        }
+
+        auto output = make_channel<MessageChannel>();
+        {
+            MERGE merge(Context{}, properties);
+            merge.process(std::move(inputs), std::move(output.output));
+        }
+
+        std::vector<uint32_t> time_stamps;
+        try {
+            while (true) {
+                auto acq = force_unpack<Acquisition>(output.input.pop());
+                time_stamps.push_back(std::get<ISMRMRD::AcquisitionHeader>(acq).acquisition_time_stamp);
+            }
+        } catch (const ChannelClosed &) {}
+        return time_stamps;
+    }
+}
+
+TEST(ChannelSelectorTest, pops_from_all_channels_in_order) {
+    constexpr size_t branches = 16;
+    constexpr int messages = 500;
+
+    std::vector<GenericInputChannel> inputs;
+    std::vector<std::thread> producers;
+    for (size_t index = 0; index < branches; index++) {
+        auto channel = make_channel<MessageChannel>();
+        inputs.emplace_back(std::move(channel.input));
+        producers.emplace_back([](OutputChannel output) {
+            for (int i = 0; i < messages; i++) output.push(i);
+        }, std::move(channel.output));
+    }
+
+    ChannelSelector selector(std::move(inputs));
+    std::vector<int> next(branches, 0);
+    try {
+        while (true) {
+            auto [index, message] = selector.pop();
+            EXPECT_EQ(force_unpack<int>(std::move(message)), next[index]++);
+        }
+    } catch (const ChannelClosed &) {}
+
+    for (auto &producer : producers) producer.join();
+    for (auto count : next) EXPECT_EQ(count, messages);
+    EXPECT_EQ(selector.open(), 0);
+}
+
+TEST(ChannelSelectorTest, unordered_merge_passes_everything) {
+    std::vector<std::vector<Acquisition>> branches(8);
+    for (uint32_t i = 0; i < 800; i++) branches[i % 8].push_back(acquisition(i, i));
+
+    auto time_stamps = merge<UnorderedMerge>(branches, {});
+    std::sort(time_stamps.begin(), time_stamps.end());
+
+    ASSERT_EQ(time_stamps.size(), 800);
+    for (uint32_t i = 0; i < 800; i++) EXPECT_EQ(time_stamps[i], i);
+}
+
+TEST(ChannelSelectorTest, unordered_merge_reports_a_closed_output) {
+    std::map<std::string, GenericInputChannel> inputs;
+    auto channel = make_channel<MessageChannel>();
+    channel.output.push(acquisition(1, 1));
+    inputs.emplace("branch0", std::move(channel.input));
+
+    // Dropping the input end closes the output channel
+    auto output = make_channel<MessageChannel>();
+    { auto closed = std::move(output.input); }
+
+    UnorderedMerge merge(Context{}, {});
+    EXPECT_THROW(merge.process(std::move(inputs), std::move(output.output)), ChannelClosed);
+}
+
+TEST(ChannelSelectorTest, ordered_merge_sorts_by_time_stamp) {
+    std::vector<std::vector<Acquisition>> branches = {
+            { acquisition(1, 9), acquisition(4, 8), acquisition(5, 7) },
+            { acquisition(2, 6), acquisition(7, 5) },
+            { acquisition(3, 4), acquisition(6, 3), acquisition(8, 2), acquisition(9, 1) }
+    };
+
+    EXPECT_EQ(merge<OrderedMerge>(branches, { { "order", "timestamp" } }),
+              std::vector<uint32_t>({ 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+}
+
+TEST(ChannelSelectorTest, ordered_merge_sorts_by_acquisition_index) {
+    std::vector<std::vector<Acquisition>> branches = {
+            { acquisition(1, 1), acquisition(2, 4) },
+            { acquisition(3, 2), acquisition(4, 3) }
+    };
+
+    EXPECT_EQ(merge<OrderedMerge>(branches, { { "order", "acquisition_index" } }),
+              std::vector<uint32_t>({ 1, 3, 4, 2 }));
+}
+
+TEST(ChannelSelectorTest, ordered_merge_takes_turns) {
+    std::vector<std::vector<Acquisition>> branches = {
+            { acquisition(1, 0), acquisition(4, 0), acquisition(6, 0) },
+            { acquisition(2, 0) },
+            { acquisition(3, 0), acquisition(5, 0) }
+    };
+
+    EXPECT_EQ(merge<OrderedMerge>(branches, {}), std::vector<uint32_t>({ 1, 2, 3, 4, 5, 6 }));
+}
@@ -0,0 +1,144 @@
+#include "GridGraphCut.h"
+#include "ImageGraph.h"
+
+#include <boost/graph/boykov_kolmogorov_max_flow.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    // integer valued capacities, so the flow is exact and the minimal cut unique
+    struct GridCapacities {
+        std::vector<size_t> dims;
+        std::vector<float> edge;        // [num_nodes * D], to the successor along every dimension
+        std::vector<float> reverse_edge;
+        std::vector<float> source;
+        std::vector<float> sink;
+
+        size_t num_nodes() const { return source.size(); }
+
+        bool has_successor(size_t idx, size_t d) const {
+            size_t stride = 1;
+            for (size_t k = 0; k < d; k++) stride *= dims[k];
+            return (idx / stride) % dims[d] + 1 < dims[d];
+        }
+
+        size_t successor(size_t idx, size_t d) const {
+            size_t stride = 1;
+            for (size_t k = 0; k < d; k++) stride *= dims[k];
+            return idx + stride;
+        }
+    };
+
+    GridCapacities random_capacities(const std::vector<size_t>& dims, std::mt19937& gen) {
+        std::uniform_int_distribution<int> edge_dist(0, 10);
+        std::uniform_int_distribution<int> terminal_dist(-20, 20);
+
+        GridCapacities caps;
+        caps.dims = dims;
+        size_t n = 1;
+        for (auto d : dims) n *= d;
+
+        caps.edge.resize(n * dims.size());
+        caps.reverse_edge.resize(n * dims.size());
+        for (size_t i = 0; i < caps.edge.size(); i++) {
+            caps.edge[i] = edge_dist(gen);
+            caps.reverse_edge[i] = (i % 3 == 0) ? edge_dist(gen) : 0;
+        }
+
+        caps.source.resize(n);
+        caps.sink.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            int t = terminal_dist(gen);
+            caps.source[i] = std::max(t, 0);
+            caps.sink[i] = std::max(-t, 0) + (i % 5 == 0 ? 3 : 0);
+        }
+        return caps;
+    }
+
+    void set_capacities(GridGraphCut& graph, const GridCapacities& caps) {
+        const size_t D = caps.dims.size();
+        for (size_t i = 0; i < caps.num_nodes(); i++) {
+            for (size_t d = 0; d < D; d++)
+                if (caps.has_successor(i, d)) graph.set_edge_capacity(i, d, caps.edge[i * D + d], caps.reverse_edge[i * D + d]);
+            graph.set_terminal_capacity(i, caps.source[i], caps.sink[i]);
+        }
+    }
+
+    // reference solution with the boost Boykov-Kolmogorov solver on the implicit image graph
+    template <unsigned int D> std::vector<bool> boost_source_side(const GridCapacities& caps, float& flow) {
+        vector_td<int, D> dims;
+        for (unsigned int d = 0; d < D; d++) dims[d] = caps.dims[d];
+
+        ImageGraph<D> graph(dims);
+        auto& capacity_map = graph.edge_capacity_map;
+
+        for (size_t i = 0; i < caps.num_nodes(); i++) {
+            for (unsigned int d = 0; d < D; d++) {
+                if (!caps.has_successor(i, d)) continue;
+                size_t j = caps.successor(i, d);
+                capacity_map[graph.edge(i, j).first] += caps.edge[i * D + d];
+                capacity_map[graph.edge(j, i).first] += caps.reverse_edge[i * D + d];
+            }
+            capacity_map[graph.edge_from_source(i)] += caps.source[i];
+            capacity_map[graph.edge_to_sink(i)] += caps.sink[i];
+        }
+
+        flow = boost::boykov_kolmogorov_max_flow(graph, graph.source_vertex, graph.sink_vertex);
+
+        std::vector<bool> result(caps.num_nodes());
+        for (size_t i = 0; i < caps.num_nodes(); i++)
+            result[i] = graph.color_map[i] == boost::default_color_type::black_color;
+        return result;
+    }
+
+    template <unsigned int D> void compare_with_boost(const std::vector<size_t>& dims, unsigned int seed) {
+        std::mt19937 gen(seed);
+        auto caps = random_capacities(dims, gen);
+
+        float expected_flow;
+        auto expected = boost_source_side<D>(caps, expected_flow);
+
+        GridGraphCut graph(dims);
+        set_capacities(graph, caps);
+        float flow = graph.maxflow();
+
+        EXPECT_EQ(flow, expected_flow);
+        for (size_t i = 0; i < caps.num_nodes(); i++)
+            ASSERT_EQ(graph.is_source_side(i), expected[i]) << "node " << i;
+    }
+}
+
+TEST(GridGraphCut, same_cut_as_boost_2D) {
+    compare_with_boost<2>({ 37, 29 }, 1);
+    compare_with_boost<2>({ 64, 3 }, 2);
+}
+
+TEST(GridGraphCut, same_cut_as_boost_3D) {
+    compare_with_boost<3>({ 13, 11, 7 }, 3);
+}
+
+// changing all capacities and continuing from the previous flow gives the cut of a fresh solve
+TEST(GridGraphCut, reuse_trees) {
+    std::vector<size_t> dims{ 31, 23, 4 };
+    std::mt19937 gen(4);
+
+    GridGraphCut reused(dims);
+
+    for (int it = 0; it < 6; it++) {
+        auto caps = random_capacities(dims, gen);
+
+        set_capacities(reused, caps);
+        float flow = reused.maxflow(true);
+
+        GridGraphCut fresh(dims);
+        set_capacities(fresh, caps);
+        float expected_flow = fresh.maxflow();
+
+        EXPECT_EQ(flow, expected_flow);
+        for (size_t i = 0; i < fresh.num_nodes(); i++)
+            ASSERT_EQ(reused.is_source_side(i), fresh.is_source_side(i)) << "iteration " << it << ", node " << i;
+    }
+}
@@ -0,0 +1,170 @@
+#include "mri_core_coil_map_estimation.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    typedef std::complex<double> T;
+
+    // direct evaluation of the Souheil method: windowed covariance, power iterations and object phase for every pixel
+    hoNDArray<T> reference_coil_map(const hoNDArray<T>& data, size_t RO, size_t E1, size_t E2, size_t CHA, int ks, int kz, size_t power) {
+        auto wrap = [](long long i, long long n) { return (size_t)(((i % n) + n) % n); };
+
+        hoNDArray<T> coil_map(data.dimensions());
+        std::vector<T> R(CHA * CHA), S(CHA), v(CHA), w(CHA);
+
+        for (size_t e2 = 0; e2 < E2; e2++) {
+            for (size_t e1 = 0; e1 < E1; e1++) {
+                for (size_t ro = 0; ro < RO; ro++) {
+                    std::fill(R.begin(), R.end(), T(0));
+                    std::fill(S.begin(), S.end(), T(0));
+
+                    for (int kz2 = -kz / 2; kz2 <= kz / 2; kz2++)
+                        for (int ke1 = -ks / 2; ke1 <= ks / 2; ke1++)
+                            for (int kro = -ks / 2; kro <= ks / 2; kro++) {
+                                size_t offset = wrap(e2 + kz2, E2) * RO * E1 + wrap(e1 + ke1, E1) * RO + wrap(ro + kro, RO);
+                                for (size_t i = 0; i < CHA; i++) {
+                                    T xi = data[offset + i * RO * E1 * E2];
+                                    S[i] += xi;
+                                    for (size_t j = 0; j < CHA; j++)
+                                        R[i + j * CHA] += std::conj(xi) * data[offset + j * RO * E1 * E2];
+                                }
+                            }
+
+                    auto normalize = [&](std::vector<T>& x) {
+                        double n = 0;
+                        for (auto& c : x) n += std::norm(c);
+                        for (auto& c : x) c /= std::sqrt(n);
+                    };
+
+                    v = S;
+                    normalize(v);
+                    for (size_t p = 0; p < power; p++) {
+                        for (size_t i = 0; i < CHA; i++) {
+                            w[i] = 0;
+                            for (size_t j = 0; j < CHA; j++) w[i] += R[i + j * CHA] * v[j];
+                        }
+                        v = w;
+                        normalize(v);
+                    }
+
+                    T phase = 0;
+                    for (size_t c = 0; c < CHA; c++) phase += S[c] * v[c];
+                    phase /= std::abs(phase);
+
+                    for (size_t c = 0; c < CHA; c++)
+                        coil_map[e2 * RO * E1 + e1 * RO + ro + c * RO * E1 * E2] = std::conj(v[c]) * phase;
+                }
+            }
+        }
+
+        return coil_map;
+    }
+
+    // smooth coil sensitivities on a smooth object, plus noise
+    hoNDArray<T> coil_images(size_t RO, size_t E1, size_t E2, size_t CHA, double noise, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::normal_distribution<double> dist(0, noise);
+
+        hoNDArray<T> data(RO, E1, E2, CHA);
+        for (size_t c = 0; c < CHA; c++)
+            for (size_t e2 = 0; e2 < E2; e2++)
+                for (size_t e1 = 0; e1 < E1; e1++)
+                    for (size_t ro = 0; ro < RO; ro++) {
+                        double x = (double)ro / RO, y = (double)e1 / E1, z = (double)e2 / E2;
+                        T object = std::polar(1.0 + std::sin(3 * x) * std::cos(2 * y), 0.5 * x + z);
+                        T sensitivity = std::polar(1.0 / (1.0 + 4 * std::pow(x - 0.2 * c, 2) + 3 * std::pow(y - 0.15 * c, 2)), 0.7 * c + y);
+                        data(ro, e1, e2, c) = object * sensitivity + T(dist(gen), dist(gen));
+                    }
+        return data;
+    }
+
+    // a bright disc on a dark background, unit noise everywhere
+    hoNDArray<std::complex<float>> high_dynamic_range_images(size_t RO, size_t E1, size_t CHA, double object, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::normal_distribution<double> dist(0, 1);
+
+        hoNDArray<std::complex<float>> data(RO, E1, CHA);
+        for (size_t c = 0; c < CHA; c++)
+            for (size_t e1 = 0; e1 < E1; e1++)
+                for (size_t ro = 0; ro < RO; ro++) {
+                    double x = (double)ro / RO, y = (double)e1 / E1;
+                    double inside = std::pow(x - 0.5, 2) + std::pow(y - 0.5, 2) < 0.09 ? object : 0;
+                    T sensitivity = std::polar(1.0 / (1.0 + 4 * std::pow(x - 0.06 * c, 2) + 3 * std::pow(y - 0.05 * c, 2)), 0.4 * c + y);
+                    T value = inside * sensitivity + T(dist(gen), dist(gen));
+                    data(ro, e1, c) = std::complex<float>(value);
+                }
+        return data;
+    }
+}
+
+TEST(coil_map_estimation, Inati_2D) {
+    size_t RO = 37, E1 = 29, CHA = 6;
+    auto data = coil_images(RO, E1, 1, CHA, 0.05, 1);
+
+    for (size_t ks : { 3, 7 }) {
+        hoNDArray<T> im(RO, E1, CHA, data.get_data_ptr());
+        hoNDArray<T> coil_map;
+        coil_map_2d_Inati(im, coil_map, ks, 3);
+
+        auto expected = reference_coil_map(data, RO, E1, 1, CHA, ks, 1, 3);
+        for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+            ASSERT_NEAR(std::abs(coil_map[i] - expected[i]), 0.0, 1e-8) << "ks " << ks << ", " << i;
+    }
+}
+
+TEST(coil_map_estimation, Inati_3D) {
+    size_t RO = 19, E1 = 17, E2 = 8, CHA = 4;
+    auto data = coil_images(RO, E1, E2, CHA, 0.05, 2);
+
+    hoNDArray<T> coil_map;
+    coil_map_3d_Inati(data, coil_map, 5, 3, 3);
+
+    auto expected = reference_coil_map(data, RO, E1, E2, CHA, 5, 3, 3);
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+        ASSERT_NEAR(std::abs(coil_map[i] - expected[i]), 0.0, 1e-8) << i;
+}
+
+// the running sums of float data must not lose the dark background to cancellation against the bright object
+TEST(coil_map_estimation, Inati_2D_float_high_dynamic_range) {
+    size_t RO = 96, E1 = 80, CHA = 16;
+    auto im = high_dynamic_range_images(RO, E1, CHA, 1000, 4);
+
+    hoNDArray<std::complex<float>> coil_map;
+    coil_map_2d_Inati(im, coil_map, 7, 3);
+
+    hoNDArray<T> data(RO, E1, 1, CHA);
+    for (size_t i = 0; i < data.get_number_of_elements(); i++) data[i] = T(im[i]);
+    auto expected = reference_coil_map(data, RO, E1, 1, CHA, 7, 1, 3);
+
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+        ASSERT_NEAR(std::abs(T(coil_map[i]) - expected[i]), 0.0, 1e-4) << i;
+}
+
+TEST(coil_map_estimation, Inati_downsampled) {
+    size_t RO = 64, E1 = 48, CHA = 8;
+    auto data = coil_images(RO, E1, 1, CHA, 0.01, 3);
+    hoNDArray<T> im(RO, E1, CHA, data.get_data_ptr());
+
+    hoNDArray<T> full, downsampled;
+    coil_map_2d_Inati(im, full, 7, 3);
+    coil_map_2d_Inati(im, downsampled, 7, 3, 2);
+
+    // the estimated pixels are the same, the interpolated ones close
+    double diff = 0, norm = 0;
+    for (size_t c = 0; c < CHA; c++) {
+        for (size_t e1 = 0; e1 < E1; e1++) {
+            for (size_t ro = 0; ro < RO; ro++) {
+                T a = full(ro, e1, c), b = downsampled(ro, e1, c);
+                if (e1 % 2 == 0 && ro % 2 == 0) ASSERT_NEAR(std::abs(a - b), 0.0, 1e-10);
+                diff += std::norm(a - b);
+                norm += std::norm(a);
+            }
+        }
+    }
+    EXPECT_LT(std::sqrt(diff / norm), 0.05);
+}
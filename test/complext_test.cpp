@@ -0,0 +1,49 @@
+#include "complext.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+
+using namespace Gadgetron;
+using testing::Types;
+
+// The operators mixing a real scalar and a complext give the std::complex results
+template <typename T> class complext_Test : public ::testing::Test {
+public:
+    typedef std::complex<T> C;
+
+    static void expect_equal(const complext<T>& result, const C& expected) {
+        EXPECT_NEAR(result._real, expected.real(), 1e-5 * std::abs(expected));
+        EXPECT_NEAR(result._imag, expected.imag(), 1e-5 * std::abs(expected));
+    }
+
+    const T s = T(1.5);
+    const complext<T> c{ T(0.75), T(-2.25) };
+    const C c_std{ T(0.75), T(-2.25) };
+};
+
+typedef Types<float, double> realImplementations;
+TYPED_TEST_SUITE(complext_Test, realImplementations);
+
+TYPED_TEST(complext_Test, scalar_minus_complext) {
+    this->expect_equal(this->s - this->c, this->s - this->c_std);
+    this->expect_equal(TypeParam(0) - this->c, -this->c_std);
+}
+
+TYPED_TEST(complext_Test, complext_minus_scalar) {
+    this->expect_equal(this->c - this->s, this->c_std - this->s);
+}
+
+TYPED_TEST(complext_Test, scalar_plus_complext) {
+    this->expect_equal(this->s + this->c, this->s + this->c_std);
+    this->expect_equal(this->c + this->s, this->c_std + this->s);
+}
+
+TYPED_TEST(complext_Test, scalar_times_complext) {
+    this->expect_equal(this->s * this->c, this->s * this->c_std);
+    this->expect_equal(this->c * this->s, this->c_std * this->s);
+}
+
+TYPED_TEST(complext_Test, scalar_over_complext) {
+    this->expect_equal(this->s / this->c, this->s / this->c_std);
+    this->expect_equal(this->c / this->s, this->c_std / this->s);
+}
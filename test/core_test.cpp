@@ -3,6 +3,7 @@
 #include "Message.h"
 #include "Channel.h"
 #include "Types.h"
+#include "GadgetContainerMessage.h"
 
 TEST(TypeTests, multitype) {
     using namespace Gadgetron::Core;
@@ -227,3 +228,46 @@ TEST(TypeTests, tupletype3) {
 }
 
 
+
+TEST(TypeTests, lvaluetype) {
+    using namespace Gadgetron::Core;
+    auto channel = make_channel<MessageChannel>();
+    GenericInputChannel inputChannel = std::move(channel.input);
+    OutputChannel outputChannel = std::move(channel.output);
+
+    const std::string text("hello");
+    std::vector<float> values{ 1.0f, 2.0f, 3.0f };
+    outputChannel.push(text, values);
+
+    EXPECT_EQ(values.size(), 3);
+
+    auto message = inputChannel.pop();
+
+    EXPECT_TRUE(convertible_to<std::string>(message));
+    EXPECT_FALSE((convertible_to<std::string, std::vector<double>>(message)));
+
+    auto converted = force_unpack<std::string, std::vector<float>>(std::move(message));
+
+    EXPECT_EQ(std::get<0>(converted), text);
+    EXPECT_EQ(std::get<1>(converted), values);
+}
+
+TEST(TypeTests, containermessage) {
+    using namespace Gadgetron::Core;
+
+    Message message(std::string("hello"), int(42));
+    auto* container = message.to_container_message();
+
+    MessageChunks chunks;
+    for (auto* current = container; current; current = dynamic_cast<Gadgetron::GadgetContainerMessageBase*>(current->cont()))
+        chunks.emplace_back(current->take_message());
+    container->release();
+
+    Message restored(std::move(chunks));
+
+    ASSERT_TRUE((convertible_to<std::string, int>(restored)));
+    auto converted = force_unpack<std::string, int>(std::move(restored));
+
+    EXPECT_EQ(std::get<0>(converted), "hello");
+    EXPECT_EQ(std::get<1>(converted), 42);
+}
@@ -14,6 +14,7 @@
 #include "twoParaExpRecoveryOperator.h"
 #include "curveFittingCostFunction.h"
 #include "cmr_t1_mapping.h"
+#include "cmr_t2_mapping.h"
 #include <gtest/gtest.h>
 #include <boost/random.hpp>
 
@@ -233,3 +234,365 @@ TYPED_TEST(curveFitting_test, T1SRMapping)
     // test hole filling
     EXPECT_NEAR(t1_sr.map_(12, 23, 0, 0), 1122.36963, 1.0);
 }
+
+TYPED_TEST(curveFitting_test, T1SRBatch)
+{
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+
+    t1_sr.ti_.resize(11, 545);
+    t1_sr.ti_[10] = 10000;
+    t1_sr.max_iter_ = 150;
+    t1_sr.thres_fun_ = 1e-6;
+    t1_sr.max_map_value_ = 4000;
+
+    std::vector<float> y = { 178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471 };
+
+    const size_t B = Gadgetron::CmrT1SRMapping<float>::batch_size;
+    const size_t NUM = t1_sr.get_num_of_paras();
+    const size_t num = B - 3;
+
+    // the first pixel is the reference curve, the others are noisy copies of it
+    boost::mt19937 rng(42);
+    boost::normal_distribution<float> noise(0, 3);
+
+    std::vector<float> yi(y.size()*B, 0), guess(NUM*B, 0), bi(NUM*B, 0), map_v(B, 0);
+    std::vector<float> yp(y.size()), guess_p, bi_p;
+
+    size_t p, n;
+    for (p = 0; p < num; p++)
+    {
+        for (n = 0; n < y.size(); n++)
+        {
+            yp[n] = y[n] + ((p > 0) ? noise(rng) : 0);
+            yi[n*B + p] = yp[n];
+        }
+
+        t1_sr.get_initial_guess(t1_sr.ti_, yp, guess_p);
+        for (n = 0; n < NUM; n++) guess[n*B + p] = guess_p[n];
+    }
+
+    t1_sr.compute_map_batch(t1_sr.ti_, &yi[0], &guess[0], num, &bi[0], &map_v[0]);
+
+    // least square solution of the reference curve
+    EXPECT_NEAR(bi[0], 471.0636, 0.01);
+    EXPECT_NEAR(bi[B], 1122.3631, 0.05);
+    EXPECT_NEAR(map_v[0], 1122.3631, 0.05);
+
+    // every pixel of the batch agrees with the simplex fit of that pixel alone
+    for (p = 0; p < num; p++)
+    {
+        for (n = 0; n < y.size(); n++) yp[n] = yi[n*B + p];
+
+        float map_p(0);
+        t1_sr.get_initial_guess(t1_sr.ti_, yp, guess_p);
+        t1_sr.compute_map(t1_sr.ti_, yp, guess_p, bi_p, map_p);
+
+        EXPECT_NEAR(bi[p], bi_p[0], 0.05);
+        EXPECT_NEAR(bi[B + p], bi_p[1], 0.5);
+        EXPECT_NEAR(map_v[p], map_p, 0.5);
+    }
+}
+
+TYPED_TEST(curveFitting_test, T1SRMappingBatch)
+{
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+
+    t1_sr.fill_holes_in_maps_ = true;
+    t1_sr.max_size_of_holes_ = 20;
+    t1_sr.hole_marking_value_ = 0;
+    t1_sr.compute_SD_maps_ = true;
+    t1_sr.use_batch_fitting_ = true;
+
+    t1_sr.ti_.resize(11, 545);
+    t1_sr.ti_[10] = 10000;
+
+    t1_sr.max_iter_ = 150;
+    t1_sr.max_map_value_ = 4000;
+
+    // the row length is not a multiple of the batch size
+    size_t RO = 75;
+    size_t E1 = 44;
+    size_t N = t1_sr.ti_.size();
+
+    std::vector<float> y = { 178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471 };
+
+    t1_sr.data_.create(RO, E1, N, 1, 1);
+
+    size_t n;
+    for (n = 0; n < N; n++)
+    {
+        Gadgetron::hoNDArray<float> data2D;
+        data2D.create(RO, E1, &(t1_sr.data_(0, 0, n, 0, 0)));
+        Gadgetron::fill(data2D, y[n]);
+    }
+
+    t1_sr.mask_for_mapping_.create(RO, E1, 1);
+    Gadgetron::fill(t1_sr.mask_for_mapping_, (float)1);
+
+    t1_sr.mask_for_mapping_(12, 23, 0) = 0;
+    t1_sr.mask_for_mapping_(12, 24, 0) = 0;
+    t1_sr.mask_for_mapping_(13, 23, 0) = 0;
+
+    t1_sr.perform_parametric_mapping();
+
+    EXPECT_NEAR(t1_sr.para_(0, 0, 0, 0, 0), 471.0636, 0.01);
+    EXPECT_NEAR(t1_sr.para_(RO - 1, E1 / 2, 0, 0, 0), 471.0636, 0.01);
+
+    EXPECT_NEAR(t1_sr.map_(0, 0, 0, 0), 1122.3631, 0.05);
+    EXPECT_NEAR(t1_sr.map_(RO / 2, E1 / 2, 0, 0), 1122.3631, 0.05);
+    EXPECT_NEAR(t1_sr.map_(RO - 1, E1 - 1, 0, 0), 1122.3631, 0.05);
+    EXPECT_NEAR(t1_sr.map_(37, 16, 0, 0), 1122.3631, 0.05);
+
+    // masked pixels are filled from their neighbours
+    EXPECT_NEAR(t1_sr.map_(12, 23, 0, 0), 1122.3631, 1.0);
+}
+
+TYPED_TEST(curveFitting_test, T1SRMappingDictionary)
+{
+    std::vector<float> ti = { 100, 200, 350, 500, 700, 1000, 1500, 2200, 3000, 5000 };
+
+    size_t RO = 64;
+    size_t E1 = 40;
+    size_t N = ti.size();
+
+    // T1 varies along RO and A along E1
+    Gadgetron::hoNDArray<float> data(RO, E1, N, 1, 1);
+
+    size_t ro, e1, n;
+    for (e1 = 0; e1 < E1; e1++)
+    {
+        for (ro = 0; ro < RO; ro++)
+        {
+            float A = 100 + 10 * e1;
+            float T1 = 300 + 25 * ro;
+            for (n = 0; n < N; n++)
+            {
+                data(ro, e1, n, 0, 0) = A * (1 - std::exp(-ti[n] / T1));
+            }
+        }
+    }
+
+    auto set_up = [&](Gadgetron::CmrT1SRMapping<float>& t1_sr)
+    {
+        t1_sr.fill_holes_in_maps_ = false;
+        t1_sr.compute_SD_maps_ = false;
+        t1_sr.ti_ = ti;
+        t1_sr.data_ = data;
+        t1_sr.max_iter_ = 150;
+        t1_sr.max_map_value_ = 4000;
+    };
+
+    Gadgetron::CmrT1SRMapping<float> fit, matched, refined;
+
+    set_up(fit);
+    fit.use_batch_fitting_ = true;
+    fit.perform_parametric_mapping();
+
+    set_up(matched);
+    matched.use_dictionary_matching_ = true;
+    matched.refine_dictionary_match_ = false;
+    matched.perform_parametric_mapping();
+
+    set_up(refined);
+    refined.use_dictionary_matching_ = true;
+    refined.refine_dictionary_match_ = true;
+    refined.perform_parametric_mapping();
+
+    // the dictionary is computed once for these ti
+    std::shared_ptr<const Gadgetron::CmrT1SRMapping<float>::Dictionary> dict1, dict2;
+    ASSERT_TRUE(matched.get_dictionary(ti, dict1));
+    ASSERT_TRUE(refined.get_dictionary(ti, dict2));
+    EXPECT_EQ(dict1.get(), dict2.get());
+
+    // 500 log-spaced entries are 1.7% apart, the interpolated match is much closer
+    for (e1 = 0; e1 < E1; e1++)
+    {
+        for (ro = 0; ro < RO; ro++)
+        {
+            float T1 = fit.map_(ro, e1, 0, 0);
+            EXPECT_NEAR(T1, 300 + 25 * ro, 0.01);
+
+            EXPECT_NEAR(matched.map_(ro, e1, 0, 0), T1, 0.002*T1);
+            EXPECT_NEAR(matched.para_(ro, e1, 0, 0, 0), fit.para_(ro, e1, 0, 0, 0), 0.002*fit.para_(ro, e1, 0, 0, 0));
+
+            EXPECT_NEAR(refined.map_(ro, e1, 0, 0), T1, 0.01);
+            EXPECT_NEAR(refined.para_(ro, e1, 0, 0, 0), fit.para_(ro, e1, 0, 0, 0), 0.01);
+        }
+    }
+}
+
+TYPED_TEST(curveFitting_test, T1SRMappingDictionaryAccuracy)
+{
+    std::vector<float> ti = { 100, 200, 350, 500, 700, 1000, 1500, 2200, 3000, 5000 };
+
+    size_t RO = 48;
+    size_t E1 = 32;
+    size_t N = ti.size();
+
+    // noisy recovery curves, T1 varies along RO
+    Gadgetron::hoNDArray<float> data(RO, E1, N, 1, 1);
+
+    boost::mt19937 rng(7);
+    boost::normal_distribution<float> noise(0, 2);
+
+    size_t ro, e1, n;
+    for (e1 = 0; e1 < E1; e1++)
+    {
+        for (ro = 0; ro < RO; ro++)
+        {
+            float T1 = 400 + 40 * ro;
+            for (n = 0; n < N; n++)
+            {
+                data(ro, e1, n, 0, 0) = 200 * (1 - std::exp(-ti[n] / T1)) + noise(rng);
+            }
+        }
+    }
+
+    auto set_up = [&](Gadgetron::CmrT1SRMapping<float>& t1_sr)
+    {
+        t1_sr.fill_holes_in_maps_ = false;
+        t1_sr.compute_SD_maps_ = false;
+        t1_sr.ti_ = ti;
+        t1_sr.data_ = data;
+        t1_sr.max_iter_ = 150;
+        t1_sr.max_map_value_ = 4000;
+    };
+
+    // the iterative fit is the default simplex solver
+    Gadgetron::CmrT1SRMapping<float> fit, matched;
+
+    set_up(fit);
+    fit.perform_parametric_mapping();
+
+    set_up(matched);
+    matched.use_dictionary_matching_ = true;
+    matched.refine_dictionary_match_ = false;
+    matched.perform_parametric_mapping();
+
+    double err_fit = 0, err_matched = 0;
+    for (e1 = 0; e1 < E1; e1++)
+    {
+        for (ro = 0; ro < RO; ro++)
+        {
+            double T1 = 400 + 40 * ro;
+            err_fit += (fit.map_(ro, e1, 0, 0) - T1) * (fit.map_(ro, e1, 0, 0) - T1) / (T1 * T1);
+            err_matched += (matched.map_(ro, e1, 0, 0) - T1) * (matched.map_(ro, e1, 0, 0) - T1) / (T1 * T1);
+        }
+    }
+
+    err_fit = std::sqrt(err_fit / (RO*E1));
+    err_matched = std::sqrt(err_matched / (RO*E1));
+
+    GDEBUG_STREAM("relative rms T1 error, simplex fit : " << err_fit << ", dictionary match : " << err_matched);
+
+    // matching against the dictionary is as accurate as fitting, noise dominates the error
+    EXPECT_LT(err_fit, 0.05);
+    EXPECT_LT(err_matched, 1.05*err_fit + 0.002);
+}
+
+TYPED_TEST(curveFitting_test, T1SRDictionaryCache)
+{
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+    t1_sr.max_map_value_ = 4000;
+
+    auto get = [&](size_t i)
+    {
+        std::vector<float> ti = { 100, 200, 350, 500, 700, 1000, 1500, 2200, 3000, 5000 };
+        for (auto& v : ti) v += i;
+
+        std::shared_ptr<const Gadgetron::CmrT1SRMapping<float>::Dictionary> dict;
+        EXPECT_TRUE(t1_sr.get_dictionary(ti, dict));
+        return dict;
+    };
+
+    auto first = get(0);
+    auto second = get(1);
+
+    // the first ti set stays in use while many others are added, the second one is dropped
+    for (size_t i = 2; i < 100; i++)
+    {
+        get(i);
+        EXPECT_EQ(get(0).get(), first.get());
+    }
+
+    EXPECT_NE(get(1).get(), second.get());
+}
+
+TYPED_TEST(curveFitting_test, T2MappingDictionary)
+{
+    std::vector<float> te = { 0, 10, 20, 30, 45, 60, 80, 100 };
+
+    size_t RO = 64;
+    size_t E1 = 40;
+    size_t N = te.size();
+
+    // T2 varies along RO and A along E1
+    Gadgetron::hoNDArray<float> data(RO, E1, N, 1, 1);
+
+    size_t ro, e1, n;
+    for (e1 = 0; e1 < E1; e1++)
+    {
+        for (ro = 0; ro < RO; ro++)
+        {
+            float A = 100 + 10 * e1;
+            float T2 = 30 + 2 * ro;
+            for (n = 0; n < N; n++)
+            {
+                data(ro, e1, n, 0, 0) = A * std::exp(-te[n] / T2);
+            }
+        }
+    }
+
+    auto set_up = [&](Gadgetron::CmrT2Mapping<float>& t2)
+    {
+        t2.fill_holes_in_maps_ = false;
+        t2.compute_SD_maps_ = false;
+        t2.ti_ = te;
+        t2.data_ = data;
+        t2.max_iter_ = 150;
+        t2.max_map_value_ = 250;
+    };
+
+    Gadgetron::CmrT2Mapping<float> fit, matched, refined;
+
+    set_up(fit);
+    fit.use_batch_fitting_ = true;
+    fit.perform_parametric_mapping();
+
+    set_up(matched);
+    matched.use_dictionary_matching_ = true;
+    matched.refine_dictionary_match_ = false;
+    matched.perform_parametric_mapping();
+
+    set_up(refined);
+    refined.use_dictionary_matching_ = true;
+    refined.refine_dictionary_match_ = true;
+    refined.perform_parametric_mapping();
+
+    // the dictionary is computed once for these te, and is not shared with a T1 model of the same grid
+    std::shared_ptr<const Gadgetron::CmrT2Mapping<float>::Dictionary> dict1, dict2, dict_t1;
+    ASSERT_TRUE(matched.get_dictionary(te, dict1));
+    ASSERT_TRUE(refined.get_dictionary(te, dict2));
+    EXPECT_EQ(dict1.get(), dict2.get());
+
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+    t1_sr.max_map_value_ = 250;
+    ASSERT_TRUE(t1_sr.get_dictionary(te, dict_t1));
+    EXPECT_NE(dict1.get(), dict_t1.get());
+
+    // 500 log-spaced entries are 1.1% apart, the interpolated match is much closer
+    for (e1 = 0; e1 < E1; e1++)
+    {
+        for (ro = 0; ro < RO; ro++)
+        {
+            float T2 = fit.map_(ro, e1, 0, 0);
+            EXPECT_NEAR(T2, 30 + 2 * ro, 0.01);
+
+            EXPECT_NEAR(matched.map_(ro, e1, 0, 0), T2, 0.002*T2);
+            EXPECT_NEAR(matched.para_(ro, e1, 0, 0, 0), fit.para_(ro, e1, 0, 0, 0), 0.002*fit.para_(ro, e1, 0, 0, 0));
+
+            EXPECT_NEAR(refined.map_(ro, e1, 0, 0), T2, 0.01);
+            EXPECT_NEAR(refined.para_(ro, e1, 0, 0, 0), fit.para_(ro, e1, 0, 0, 0), 0.01);
+        }
+    }
+}
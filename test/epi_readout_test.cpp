@@ -0,0 +1,202 @@
+#include "EPIReadoutBatch.h"
+#include "epi_correction_reference.h"
+#include "hoNDFFT.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using namespace Gadgetron::EPI;
+using Gadgetron::Test::BaselineEPICorrection;
+
+namespace {
+
+    typedef std::complex<float> T;
+
+    struct Modes {
+        std::string B0;
+        std::string OEPhase;
+        int filterLength;
+    };
+
+    const Modes default_modes = { "mean", "polynomial", 0 };
+
+    ISMRMRD::EncodingLimits encoding_limits() {
+        ISMRMRD::EncodingLimits limits;
+        limits.repetition = ISMRMRD::Limit(0, 3, 0);
+        return limits;
+    }
+
+    // A ramp sampled trapezoid of 64 encoded samples with 128 acquired samples
+    void setup(EPIReconXObjectTrapezoid<T>& reconx) {
+        reconx.encodeNx_ = 64;
+        reconx.encodeFOV_ = 250;
+        reconx.reconNx_ = 64;
+        reconx.reconFOV_ = 250;
+        reconx.rampUpTime_ = 100;
+        reconx.rampDownTime_ = 100;
+        reconx.flatTopTime_ = 300;
+        reconx.numSamples_ = 128;
+        reconx.dwellTime_ = 3.5;
+        reconx.computeTrajectory();
+    }
+
+    void setup(EPICorrectionObject<T>& corr, const Modes& modes) {
+        corr.numNavigators_ = 3;
+        corr.referenceNavigatorNumber_ = 1;
+        corr.B0CorrectionMode_ = modes.B0;
+        corr.OEPhaseCorrectionMode_ = modes.OEPhase;
+        corr.navigatorParameterFilterLength_ = modes.filterLength;
+        if (modes.filterLength > 1) corr.init_arrays_for_nav_parameter_filtering(encoding_limits());
+    }
+
+    void setup(BaselineEPICorrection& corr, const Modes& modes) {
+        corr.numNavigators_ = 3;
+        corr.referenceNavigatorNumber = 1;
+        corr.B0CorrectionMode = modes.B0;
+        corr.OEPhaseCorrectionMode = modes.OEPhase;
+        corr.navigatorParameterFilterLength = modes.filterLength;
+        if (modes.filterLength > 1) corr.init_arrays_for_nav_parameter_filtering(encoding_limits());
+    }
+
+    struct Line {
+        ISMRMRD::AcquisitionHeader hdr;
+        hoNDArray<T> data;
+    };
+
+    // Shots of 3 navigators and 40 lines of alternating polarity, one shot per repetition
+    std::vector<Line> make_lines(size_t channels, size_t shots = 2) {
+        std::mt19937 gen(7);
+        std::normal_distribution<float> dist;
+
+        std::vector<Line> lines;
+        for (size_t shot = 0; shot < shots; shot++) {
+            for (size_t n = 0; n < 43; n++) {
+                Line line;
+                line.hdr.read_dir[0] = 1;
+                line.hdr.position[0] = 12.5f;
+                line.hdr.active_channels = channels;
+                line.hdr.idx.repetition = shot;
+                if (n < 3) line.hdr.setFlag(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA);
+                if (n % 2) line.hdr.setFlag(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE);
+
+                line.data.create(128, channels);
+                for (auto& v : line.data) v = T(dist(gen), dist(gen));
+                lines.push_back(std::move(line));
+            }
+        }
+        return lines;
+    }
+
+    // EPIReconXGadget, EPICorrGadget and FFTXGadget line by line, with the correction as EPICorrGadget had it
+    // before it moved to EPICorrectionObject
+    std::vector<Line> reference(std::vector<Line> lines, const Modes& modes = default_modes) {
+        EPIReconXObjectTrapezoid<T> reconx;
+        BaselineEPICorrection corr;
+        setup(reconx);
+        setup(corr, modes);
+
+        std::vector<Line> result;
+        for (auto& line : lines) {
+            ISMRMRD::AcquisitionHeader hdr_out;
+            hoNDArray<T> data_out(reconx.reconNx_, line.data.get_size(1));
+            reconx.apply(line.hdr, line.data, hdr_out, data_out);
+
+            arma::cx_fmat adata = as_arma_matrix(data_out);
+            if (hdr_out.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA)) {
+                corr.process_phase_correction_data(hdr_out, adata);
+                continue;
+            }
+            corr.apply_epi_correction(hdr_out, adata);
+
+            hoNDArray<T> r, buf;
+            hoNDFFT<float>::instance()->fft1c(data_out, r, buf);
+            result.push_back(Line{ hdr_out, r });
+        }
+        return result;
+    }
+
+    std::vector<Line> batched(std::vector<Line> lines, size_t batch_lines, size_t cutNx = 0, const Modes& modes = default_modes) {
+        EPIReconXObjectTrapezoid<T> reconx;
+        EPICorrectionObject<T> corr;
+        setup(reconx);
+        setup(corr, modes);
+
+        EPIReadoutBatch<T> batch(reconx, corr, batch_lines);
+        std::vector<Line> result;
+        auto emit = [&](ISMRMRD::AcquisitionHeader& hdr, hoNDArray<T>&& data) { result.push_back(Line{ hdr, std::move(data) }); };
+
+        for (auto& line : lines) {
+            if (line.hdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA)) {
+                if (corr.corrComputed()) batch.process(cutNx, emit);
+
+                ISMRMRD::AcquisitionHeader hdr_out;
+                hoNDArray<T> data_out(reconx.reconNx_, line.data.get_size(1));
+                reconx.apply(line.hdr, line.data, hdr_out, data_out);
+                arma::cx_fmat adata = as_arma_matrix(data_out);
+                corr.process_phase_correction_data(hdr_out, adata);
+                continue;
+            }
+
+            batch.add(line.hdr, line.data);
+            if (batch.full() && corr.corrComputed()) batch.process(cutNx, emit);
+        }
+        batch.process(cutNx, emit);
+        return result;
+    }
+}
+
+namespace {
+
+    void expect_equal(const std::vector<Line>& result, const std::vector<Line>& expected, const std::string& what) {
+        ASSERT_EQ(result.size(), expected.size()) << what;
+
+        for (size_t l = 0; l < result.size(); l++) {
+            EXPECT_EQ(result[l].hdr.number_of_samples, expected[l].hdr.number_of_samples);
+            EXPECT_EQ(result[l].hdr.center_sample, expected[l].hdr.center_sample);
+            EXPECT_EQ(result[l].hdr.flags, expected[l].hdr.flags);
+            ASSERT_EQ(result[l].data.dimensions(), expected[l].data.dimensions());
+
+            for (size_t i = 0; i < result[l].data.size(); i++)
+                ASSERT_LT(std::abs(result[l].data[i] - expected[l].data[i]), 1e-4f * (1 + std::abs(expected[l].data[i])))
+                    << what << ", " << l << ", " << i;
+        }
+    }
+}
+
+TEST(EPIReadoutBatch, matches_line_by_line) {
+    auto lines = make_lines(4);
+    auto expected = reference(lines);
+    ASSERT_EQ(expected.size(), 80);
+
+    for (size_t batch_lines : { 1, 7, 64 })
+        expect_equal(batched(lines, batch_lines), expected, "batch_lines " + std::to_string(batch_lines));
+}
+
+TEST(EPIReadoutBatch, matches_line_by_line_for_all_correction_modes) {
+    auto lines = make_lines(3, 4);
+
+    for (auto modes : { Modes{ "none", "none", 0 }, Modes{ "mean", "mean", 0 }, Modes{ "linear", "linear", 0 },
+                        Modes{ "linear", "polynomial", 0 }, Modes{ "linear", "polynomial", 3 } }) {
+        auto what = modes.B0 + "/" + modes.OEPhase + "/" + std::to_string(modes.filterLength);
+        auto expected = reference(lines, modes);
+        ASSERT_EQ(expected.size(), 160) << what;
+        expect_equal(batched(lines, 16, 0, modes), expected, what);
+    }
+}
+
+TEST(EPIReadoutBatch, cut) {
+    auto lines = make_lines(2);
+    auto expected = reference(lines);
+    auto result = batched(lines, 16, 32);
+    ASSERT_EQ(result.size(), expected.size());
+
+    for (size_t l = 0; l < result.size(); l++) {
+        EXPECT_EQ(result[l].hdr.number_of_samples, 32);
+        EXPECT_EQ(result[l].hdr.center_sample, 16);
+        for (size_t cha = 0; cha < 2; cha++)
+            for (size_t x = 0; x < 32; x++)
+                ASSERT_LT(std::abs(result[l].data(x, cha) - expected[l].data(x + 16, cha)), 1e-4f * (1 + std::abs(expected[l].data(x + 16, cha))));
+    }
+}
@@ -0,0 +1,15 @@
+#include "../../gadgets/mri_core/BucketToBufferGadget.h"
+#include "setup_gadget.h"
+#include <gtest/gtest.h>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+using namespace std::string_literals;
+
+TEST(BucketToBufferGadgetTest, memory_budget_requires_mapped_buffer_folder) {
+    auto context = generate_context();
+
+    EXPECT_ANY_THROW(BucketToBufferGadget(context, { { "memory_budget_mb"s, "64"s } }));
+    EXPECT_NO_THROW(BucketToBufferGadget(context, { { "memory_budget_mb"s, "64"s }, { "mapped_buffer_folder"s, "/var/tmp"s } }));
+    EXPECT_NO_THROW(BucketToBufferGadget(context, {}));
+}
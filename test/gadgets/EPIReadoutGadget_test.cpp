@@ -0,0 +1,153 @@
+#include "../../gadgets/epi/EPIReadoutGadget.h"
+#include "../epi_correction_reference.h"
+#include "setup_gadget.h"
+#include "hoNDFFT.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+using namespace std::string_literals;
+
+namespace {
+
+    typedef std::complex<float> T;
+
+    // A ramp sampled trapezoid of 64 encoded samples with 128 acquired samples, and a FLASH reference space
+    Core::Context epi_context() {
+        auto context = generate_context();
+        auto& encoding = context.header.encoding[0];
+        encoding.encodedSpace = generate_encodingspace({ 64, 40, 1 }, { 250, 250, 5 });
+        encoding.reconSpace = generate_encodingspace({ 64, 40, 1 }, { 250, 250, 5 });
+
+        ISMRMRD::TrajectoryDescription traj;
+        traj.identifier = "ConventionalEPI";
+        traj.userParameterLong = { { "rampUpTime", 100 }, { "rampDownTime", 100 }, { "flatTopTime", 300 },
+                                   { "acqDelayTime", 0 }, { "numSamples", 128 }, { "numberOfNavigators", 3 },
+                                   { "etl", 40 } };
+        traj.userParameterDouble = { { "dwellTime", 3.5 } };
+        encoding.trajectoryDescription = traj;
+
+        auto flash = generate_encoding();
+        flash.encodedSpace = generate_encodingspace({ 128, 40, 1 }, { 500, 250, 5 });
+        flash.reconSpace = generate_encodingspace({ 64, 40, 1 }, { 250, 250, 5 });
+        context.header.encoding.push_back(flash);
+        return context;
+    }
+
+    Core::Acquisition make_line(std::mt19937& gen, size_t channels, bool navigator, bool reverse, bool reference) {
+        std::normal_distribution<float> dist;
+        auto acq = generate_acquisition(128, channels);
+        auto& hdr = std::get<ISMRMRD::AcquisitionHeader>(acq);
+        hdr.read_dir[0] = 1;
+        hdr.position[0] = 12.5f;
+        if (navigator) hdr.setFlag(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA);
+        if (reverse) hdr.setFlag(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE);
+        if (reference) hdr.encoding_space_ref = 1;
+        for (auto& v : std::get<hoNDArray<T>>(acq)) v = T(dist(gen), dist(gen));
+        return acq;
+    }
+
+    // Two shots of 3 navigators and 40 lines, with FLASH reference lines before the first shot and in the middle
+    // of the second one
+    std::vector<Core::Acquisition> make_stream(size_t channels) {
+        std::mt19937 gen(11);
+        std::vector<Core::Acquisition> stream;
+        stream.push_back(make_line(gen, channels, false, false, true));
+        for (size_t shot = 0; shot < 2; shot++) {
+            for (size_t n = 0; n < 43; n++) {
+                if (shot == 1 && n == 13) stream.push_back(make_line(gen, channels, false, false, true));
+                stream.push_back(make_line(gen, channels, n < 3, n % 2, false));
+            }
+        }
+        return stream;
+    }
+
+    // EPIReconXGadget, EPICorrGadget and FFTXGadget for the EPI lines, with the correction as EPICorrGadget had it
+    // before it moved to EPICorrectionObject. Reference lines are passed on in stream order.
+    std::vector<Core::Acquisition> unfused_chain(std::vector<Core::Acquisition> stream) {
+        EPI::EPIReconXObjectTrapezoid<T> reconx;
+        reconx.encodeNx_ = 64;
+        reconx.encodeFOV_ = 250;
+        reconx.reconNx_ = 64;
+        reconx.reconFOV_ = 250;
+        reconx.rampUpTime_ = 100;
+        reconx.rampDownTime_ = 100;
+        reconx.flatTopTime_ = 300;
+        reconx.acqDelayTime_ = 0;
+        reconx.numSamples_ = 128;
+        reconx.dwellTime_ = 3.5;
+        reconx.computeTrajectory();
+
+        BaselineEPICorrection corr;
+        corr.numNavigators_ = 3;
+        corr.etl_ = 40;
+
+        std::vector<Core::Acquisition> result;
+        for (auto& acq : stream) {
+            auto& [hdr, data, traj] = acq;
+            if (hdr.encoding_space_ref > 0) {
+                result.push_back(acq);
+                continue;
+            }
+
+            ISMRMRD::AcquisitionHeader hdr_out;
+            hoNDArray<T> data_out(reconx.reconNx_, data.get_size(1));
+            reconx.apply(hdr, data, hdr_out, data_out);
+
+            arma::cx_fmat adata = as_arma_matrix(data_out);
+            if (hdr_out.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA)) {
+                corr.process_phase_correction_data(hdr_out, adata);
+                continue;
+            }
+            corr.apply_epi_correction(hdr_out, adata);
+
+            hoNDArray<T> r, buf;
+            hoNDFFT<float>::instance()->fft1c(data_out, r, buf);
+            result.push_back(Core::Acquisition{ hdr_out, r, Core::none });
+        }
+        return result;
+    }
+
+    std::vector<Core::Acquisition> fused(const std::vector<Core::Acquisition>& stream, size_t batch_lines) {
+        auto channels = setup_gadget<EPIReadoutGadget>({ { "batch_lines"s, std::to_string(batch_lines) } }, epi_context());
+        {
+            auto input = std::move(channels.input);
+            for (auto& acq : stream) input.push(acq);
+        }
+
+        std::vector<Core::Acquisition> result;
+        try {
+            while (true) result.push_back(Core::force_unpack<Core::Acquisition>(channels.output.pop()));
+        } catch (const Core::ChannelClosed&) {}
+        return result;
+    }
+}
+
+TEST(EPIReadoutGadgetTest, matches_unfused_chain_in_stream_order) {
+    auto stream = make_stream(4);
+    auto expected = unfused_chain(stream);
+    ASSERT_EQ(expected.size(), 82);
+
+    for (size_t batch_lines : { 1, 16, 64 }) {
+        auto result = fused(stream, batch_lines);
+        ASSERT_EQ(result.size(), expected.size()) << batch_lines;
+
+        for (size_t l = 0; l < result.size(); l++) {
+            auto& [hdr, data, traj] = result[l];
+            auto& [expected_hdr, expected_data, expected_traj] = expected[l];
+
+            ASSERT_EQ(hdr.encoding_space_ref, expected_hdr.encoding_space_ref) << batch_lines << ", " << l;
+            if (hdr.encoding_space_ref > 0) continue;
+
+            EXPECT_EQ(hdr.number_of_samples, expected_hdr.number_of_samples);
+            EXPECT_EQ(hdr.center_sample, expected_hdr.center_sample);
+            EXPECT_EQ(hdr.flags, expected_hdr.flags);
+            ASSERT_EQ(data.dimensions(), expected_data.dimensions());
+
+            for (size_t i = 0; i < data.size(); i++)
+                ASSERT_LT(std::abs(data[i] - expected_data[i]), 1e-4f * (1 + std::abs(expected_data[i])))
+                    << batch_lines << ", " << l << ", " << i;
+        }
+    }
+}
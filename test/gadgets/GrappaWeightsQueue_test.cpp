@@ -0,0 +1,88 @@
+#include "../../gadgets/grappa/common/WeightsQueue.h"
+
+#include <future>
+#include <gtest/gtest.h>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Grappa;
+using namespace std::chrono_literals;
+
+TEST(GrappaWeightsQueue, superseded_requests_are_coalesced) {
+
+    WeightsQueue<int> queue;
+
+    EXPECT_FALSE(queue.push(0, 1));
+    EXPECT_FALSE(queue.push(1, 10));
+    EXPECT_TRUE(queue.push(0, 2));
+    EXPECT_TRUE(queue.push(0, 3));
+    queue.close();
+
+    auto [slice, request] = queue.pop();
+    EXPECT_EQ(slice, 0);
+    EXPECT_EQ(request, 3);
+    queue.done(slice);
+
+    std::tie(slice, request) = queue.pop();
+    EXPECT_EQ(slice, 1);
+    EXPECT_EQ(request, 10);
+    queue.done(slice);
+
+    EXPECT_THROW(queue.pop(), Core::ChannelClosed);
+}
+
+TEST(GrappaWeightsQueue, slices_without_weights_go_first) {
+
+    WeightsQueue<int> queue;
+
+    queue.push(0, 0);
+    queue.done(queue.pop().first);
+
+    queue.push(0, 1);
+    queue.push(1, 1);
+    queue.push(2, 1);
+    queue.push(0, 2);
+
+    EXPECT_EQ(queue.pop().first, 1);
+    EXPECT_EQ(queue.pop().first, 2);
+    EXPECT_EQ(queue.pop().second, 2);
+}
+
+TEST(GrappaWeightsQueue, one_worker_per_slice) {
+
+    WeightsQueue<int> queue;
+
+    queue.push(0, 1);
+    auto first = queue.pop();
+    queue.push(0, 2);
+
+    auto second = std::async(std::launch::async, [&]() { return queue.pop(); });
+    EXPECT_EQ(second.wait_for(50ms), std::future_status::timeout);
+
+    queue.done(first.first);
+    EXPECT_EQ(second.get().second, 2);
+}
+
+TEST(GrappaWeightsQueue, worker_errors_reach_the_producer) {
+
+    WeightsQueue<int> queue;
+
+    queue.push(0, 1);
+    queue.fail(std::make_exception_ptr(std::runtime_error("calculation failed")));
+
+    EXPECT_THROW(queue.pop(), Core::ChannelClosed);
+    EXPECT_THROW(queue.push(1, 1), std::runtime_error);
+}
+
+TEST(GrappaWeightsQueue, dropped_requests_are_not_handed_out) {
+
+    WeightsQueue<int> queue;
+
+    queue.push(0, 1);
+    queue.push(1, 1);
+    queue.drop(0);
+    queue.drop(2);
+    queue.close();
+
+    EXPECT_EQ(queue.pop().first, 1);
+    EXPECT_THROW(queue.pop(), Core::ChannelClosed);
+}
@@ -0,0 +1,83 @@
+#include "../../gadgets/mri_core/IsmrmrdDumpGadget.h"
+#include "setup_gadget.h"
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+using namespace std::string_literals;
+namespace bf = boost::filesystem;
+
+TEST(IsmrmrdDumpGadgetTest, spilled_acquisitions_are_dumped_in_order) {
+
+    auto folder = bf::temp_directory_path() / bf::unique_path();
+    bf::create_directory(folder);
+
+    {
+        // Without room for the writer, all but the first few acquisitions go through the spill log
+        auto channels = setup_gadget<IsmrmrdDumpGadget>({ { "folder"s, folder.string() },
+                                                          { "writer_queue_mb"s, "0"s },
+                                                          { "ip_no_data_saving"s, ""s } });
+
+        {
+            auto input = std::move(channels.input);
+            for (uint32_t i = 0; i < 200; i++) {
+                auto acq = generate_acquisition(192, 16);
+                std::get<ISMRMRD::AcquisitionHeader>(acq).scan_counter = i;
+                input.push(std::move(acq));
+            }
+        }
+
+        size_t passed = 0;
+        try {
+            while (true) {
+                channels.output.pop();
+                passed++;
+            }
+        } catch (const Core::ChannelClosed&) {}
+        ASSERT_EQ(passed, 200);
+    }
+
+    std::vector<bf::path> files(bf::directory_iterator(folder), bf::directory_iterator{});
+    ASSERT_EQ(files.size(), 1);
+    ASSERT_EQ(files[0].extension(), ".h5");
+
+    {
+        ISMRMRD::Dataset dataset(files[0].string().c_str(), "dataset", false);
+        ASSERT_EQ(dataset.getNumberOfAcquisitions(), 200);
+
+        ISMRMRD::Acquisition acq;
+        for (uint32_t i = 0; i < 200; i++) {
+            dataset.readAcquisition(i, acq);
+            EXPECT_EQ(acq.scan_counter(), i);
+        }
+    }
+
+    bf::remove_all(folder);
+}
+
+TEST(IsmrmrdDumpGadgetTest, writer_failure_is_reported) {
+
+    for (auto spill_to_log : { "true"s, "false"s }) {
+        auto folder = bf::temp_directory_path() / bf::unique_path();
+        bf::create_directory(folder);
+
+        IsmrmrdDumpGadget gadget(generate_context(), { { "folder"s, folder.string() },
+                                                       { "writer_queue_mb"s, "0"s },
+                                                       { "spill_to_log"s, spill_to_log },
+                                                       { "ip_no_data_saving"s, ""s } });
+
+        // The folder is gone by the time the writer creates the dump file
+        bf::remove_all(folder);
+
+        auto input = Core::make_channel();
+        for (uint32_t i = 0; i < 20; i++) input.output.push(generate_acquisition(192, 16));
+        { auto closer = std::move(input.output); }
+
+        auto output = Core::make_channel();
+        Core::Node& node = gadget;
+
+        // Either the writer's error or the failure to open the spill log, after the writer has been joined
+        EXPECT_ANY_THROW(node.process(input.input, output.output)) << spill_to_log;
+    }
+}
@@ -0,0 +1,140 @@
+#include "hoCgBatchSolver.h"
+#include "hoCgSolver.h"
+#include "hoLsqrBatchSolver.h"
+#include "hoLsqrSolver.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_math.h"
+#include "linearOperator.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+
+    // Block diagonal operator over the last dimension; every block is (d + 2) on the diagonal and -1 on the first off-diagonals
+    template <class T> class hoTestBatchOperator : public linearOperator<hoNDArray<T>> {
+    public:
+        hoTestBatchOperator(std::vector<size_t> dims, hoNDArray<T> d) : linearOperator<hoNDArray<T>>(&dims), d_(d) {}
+
+        virtual void mult_M(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+            size_t M = in->get_size(0);
+            size_t B = in->get_number_of_elements() / M;
+            for (size_t b = 0; b < B; b++) {
+                const T* x = in->begin() + b * M;
+                T* y       = out->begin() + b * M;
+                const T* d = d_.begin() + b * M;
+                for (size_t n = 0; n < M; n++) {
+                    T v = (d[n] + T(2)) * x[n];
+                    if (n > 0)
+                        v -= x[n - 1];
+                    if (n + 1 < M)
+                        v -= x[n + 1];
+                    y[n] = accumulate ? y[n] + v : v;
+                }
+            }
+        }
+
+        virtual void mult_MH(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+            mult_M(in, out, accumulate);
+        }
+
+        virtual void mult_MH_M(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+            hoNDArray<T> tmp(in->dimensions());
+            mult_M(in, &tmp);
+            mult_M(&tmp, out, accumulate);
+        }
+
+    protected:
+        hoNDArray<T> d_;
+    };
+}
+
+template <typename T> class hoBatchSolver_Test : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        M = 97;
+        B = 7;
+        dims = std::vector<size_t>{ M, B };
+        d.create(dims);
+        rhs.create(dims);
+
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<float> dist(0.1f, 1.0f);
+        for (size_t n = 0; n < d.get_number_of_elements(); n++) {
+            // systems of different conditioning, so they converge after different numbers of iterations
+            d[n]   = T(dist(gen) * float(1 + n / M));
+            rhs[n] = T(dist(gen));
+        }
+    }
+
+    boost::shared_ptr<hoTestBatchOperator<T>> make_operator(size_t b, size_t nb) {
+        std::vector<size_t> sdims{ M, nb };
+        hoNDArray<T> sd(sdims, d.begin() + b * M);
+        return boost::make_shared<hoTestBatchOperator<T>>(sdims, hoNDArray<T>(sd));
+    }
+
+    size_t M, B;
+    std::vector<size_t> dims;
+    hoNDArray<T> d, rhs;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> batchImplementations;
+
+TYPED_TEST_SUITE(hoBatchSolver_Test, batchImplementations);
+
+TYPED_TEST(hoBatchSolver_Test, cgMatchesSingleSystems) {
+    hoCgBatchSolver<TypeParam> batch;
+    batch.set_encoding_operator(this->make_operator(0, this->B));
+    batch.set_max_iterations(100);
+    batch.set_tc_tolerance(1e-6);
+    auto x = batch.solve_from_rhs(&this->rhs);
+
+    for (size_t b = 0; b < this->B; b++) {
+        hoCgSolver<TypeParam> single;
+        single.set_encoding_operator(this->make_operator(b, 1));
+        single.set_max_iterations(100);
+        single.set_tc_tolerance(1e-6);
+
+        hoNDArray<TypeParam> rhs_b(this->M, 1, this->rhs.begin() + b * this->M);
+        auto x_b = single.solve_from_rhs(&rhs_b);
+
+        hoNDArray<TypeParam> diff(this->M, 1, x->begin() + b * this->M);
+        diff -= *x_b;
+        EXPECT_LT(nrm2(&diff) / nrm2(x_b.get()), 1e-3);
+        EXPECT_EQ(batch.get_iterations()[b], single.get_iteration_times().size());
+    }
+}
+
+TYPED_TEST(hoBatchSolver_Test, lsqrMatchesSingleSystems) {
+    hoLsqrBatchSolver<TypeParam> batch;
+    batch.set_encoding_operator(this->make_operator(0, this->B));
+    batch.set_max_iterations(100);
+    batch.set_tc_tolerance(1e-5);
+
+    hoNDArray<TypeParam> x;
+    batch.solve(&x, &this->rhs);
+
+    bool different_iterations = false;
+    for (size_t b = 0; b < this->B; b++) {
+        hoLsqrSolver<TypeParam> single;
+        single.set_encoding_operator(this->make_operator(b, 1));
+        single.set_max_iterations(100);
+        single.set_tc_tolerance(1e-5);
+
+        hoNDArray<TypeParam> rhs_b(this->M, 1, this->rhs.begin() + b * this->M);
+        hoNDArray<TypeParam> x_b;
+        single.solve(&x_b, &rhs_b);
+
+        hoNDArray<TypeParam> diff(this->M, 1, x.begin() + b * this->M);
+        diff -= x_b;
+        EXPECT_LT(nrm2(&diff) / nrm2(&x_b), 1e-3);
+
+        if (batch.get_iterations()[b] != batch.get_iterations()[0])
+            different_iterations = true;
+    }
+
+    EXPECT_TRUE(different_iterations);
+}
@@ -0,0 +1,143 @@
+#include "hoCgSolver.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_math.h"
+#include "linearOperator.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+
+    // Symmetric positive definite operator: (d + 2) on the diagonal, -1 on the first off-diagonals
+    template <class T> class hoTestSPDOperator : public linearOperator<hoNDArray<T>> {
+    public:
+        hoTestSPDOperator(std::vector<size_t> dims, hoNDArray<T> d) : linearOperator<hoNDArray<T>>(&dims), d_(d) {}
+
+        virtual void mult_M(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+            size_t N = in->get_number_of_elements();
+            for (size_t n = 0; n < N; n++) {
+                T v = (d_[n] + T(2)) * (*in)[n];
+                if (n > 0)
+                    v -= (*in)[n - 1];
+                if (n + 1 < N)
+                    v -= (*in)[n + 1];
+                (*out)[n] = accumulate ? (*out)[n] + v : v;
+            }
+        }
+
+        virtual void mult_MH(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+            mult_M(in, out, accumulate);
+        }
+
+        virtual void mult_MH_M(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+            mult_M(in, out, accumulate);
+        }
+
+    protected:
+        hoNDArray<T> d_;
+    };
+}
+
+template <typename T> class hoCgSolver_Test : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        dims = std::vector<size_t>{ 37, 49 };
+        hoNDArray<T> d(dims);
+        rhs.create(dims);
+
+        std::mt19937 gen(4321);
+        std::uniform_real_distribution<float> dist(0.1f, 1.0f);
+        for (size_t n = 0; n < d.get_number_of_elements(); n++) {
+            d[n] = T(dist(gen));
+            rhs[n] = T(dist(gen));
+        }
+
+        op = boost::make_shared<hoTestSPDOperator<T>>(dims, d);
+    }
+
+    void setup_solver(cgSolver<hoNDArray<T>>& solver) {
+        solver.set_encoding_operator(op);
+        solver.set_max_iterations(40);
+        solver.set_tc_tolerance(typename realType<T>::Type(1e-12));
+    }
+
+    std::vector<size_t> dims;
+    hoNDArray<T> rhs;
+    boost::shared_ptr<hoTestSPDOperator<T>> op;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> cgImplementations;
+
+TYPED_TEST_SUITE(hoCgSolver_Test, cgImplementations);
+
+TYPED_TEST(hoCgSolver_Test, matchesGenericSolver) {
+    cgSolver<hoNDArray<TypeParam>> reference;
+    this->setup_solver(reference);
+    auto x_ref = reference.solve_from_rhs(&this->rhs);
+
+    hoCgSolver<TypeParam> solver;
+    this->setup_solver(solver);
+    auto x = solver.solve_from_rhs(&this->rhs);
+
+    hoNDArray<TypeParam> diff(*x);
+    diff -= *x_ref;
+    EXPECT_LT(nrm2(&diff) / nrm2(x_ref.get()), 1e-4);
+    EXPECT_FALSE(solver.get_iteration_times().empty());
+    EXPECT_LE(solver.get_iteration_times().size(), 40);
+}
+
+TYPED_TEST(hoCgSolver_Test, pipelinedMatchesGenericSolver) {
+    cgSolver<hoNDArray<TypeParam>> reference;
+    this->setup_solver(reference);
+    auto x_ref = reference.solve_from_rhs(&this->rhs);
+
+    hoCgSolver<TypeParam> solver;
+    this->setup_solver(solver);
+    solver.set_pipelined(true);
+    auto x = solver.solve_from_rhs(&this->rhs);
+
+    hoNDArray<TypeParam> diff(*x);
+    diff -= *x_ref;
+    EXPECT_LT(nrm2(&diff) / nrm2(x_ref.get()), 1e-3);
+}
+
+TYPED_TEST(hoCgSolver_Test, reusesWorkspace) {
+    hoCgSolver<TypeParam> solver;
+    this->setup_solver(solver);
+
+    auto x1 = solver.solve_from_rhs(&this->rhs);
+    EXPECT_GT(solver.get_allocations_last_solve(), 1);
+
+    // only the returned solution is allocated once the workspace exists
+    auto x2 = solver.solve_from_rhs(&this->rhs);
+    EXPECT_EQ(solver.get_allocations_last_solve(), 1);
+
+    hoNDArray<TypeParam> diff(*x2);
+    diff -= *x1;
+    EXPECT_EQ(nrm2(&diff), 0);
+}
+
+TYPED_TEST(hoCgSolver_Test, pipelinedIgnoresStaleWorkspace) {
+    hoCgSolver<TypeParam> solver;
+    this->setup_solver(solver);
+    solver.set_pipelined(true);
+
+    // leaves NaN in the workspace
+    hoNDArray<TypeParam> poisoned(this->dims);
+    poisoned.fill(TypeParam(std::numeric_limits<typename realType<TypeParam>::Type>::quiet_NaN()));
+    solver.solve_from_rhs(&poisoned);
+
+    auto x = solver.solve_from_rhs(&this->rhs);
+
+    hoCgSolver<TypeParam> fresh;
+    this->setup_solver(fresh);
+    fresh.set_pipelined(true);
+    auto x_ref = fresh.solve_from_rhs(&this->rhs);
+
+    hoNDArray<TypeParam> diff(*x);
+    diff -= *x_ref;
+    EXPECT_LT(nrm2(&diff) / nrm2(x_ref.get()), 1e-5);
+}
@@ -0,0 +1,158 @@
+#include "hoComplexKernels.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace Gadgetron;
+using testing::Types;
+
+// Compares the kernels of every supported instruction set with the std::complex results
+template <typename T> class hoComplexKernels_Test : public ::testing::Test {
+public:
+    typedef std::complex<T> C;
+
+    static std::vector<C> random_vector(size_t N, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::normal_distribution<T> dist;
+        std::vector<C> x(N);
+        for (auto& v : x) v = C(dist(gen), dist(gen));
+        return x;
+    }
+
+    static std::vector<hoComplexKernels::InstructionSet> supported_instruction_sets() {
+        std::vector<hoComplexKernels::InstructionSet> sets;
+        for (auto isa : { hoComplexKernels::InstructionSet::Scalar, hoComplexKernels::InstructionSet::Avx2, hoComplexKernels::InstructionSet::Avx512 })
+            if (hoComplexKernels::is_supported(isa)) sets.push_back(isa);
+        return sets;
+    }
+
+protected:
+    virtual void SetUp() {
+        default_isa = hoComplexKernels::get_instruction_set();
+        tolerance = std::is_same<T, float>::value ? 1e-5 : 1e-13;
+        lengths = { 0, 1, 3, 7, 8, 17, 1021 }; // covers the remainders of the vector loops
+    }
+
+    virtual void TearDown() {
+        hoComplexKernels::set_instruction_set(default_isa);
+    }
+
+    hoComplexKernels::InstructionSet default_isa;
+    double tolerance;
+    std::vector<size_t> lengths;
+};
+
+typedef Types<float, double> KernelTypes;
+TYPED_TEST_SUITE(hoComplexKernels_Test, KernelTypes);
+
+TYPED_TEST(hoComplexKernels_Test, set_instruction_set) {
+    EXPECT_TRUE(hoComplexKernels::is_supported(hoComplexKernels::InstructionSet::Scalar));
+    for (auto isa : this->supported_instruction_sets())
+        EXPECT_EQ(hoComplexKernels::set_instruction_set(isa), isa);
+    EXPECT_EQ(hoComplexKernels::set_instruction_set(hoComplexKernels::InstructionSet::Scalar), hoComplexKernels::InstructionSet::Scalar);
+}
+
+TYPED_TEST(hoComplexKernels_Test, multiply_divide) {
+    typedef typename TestFixture::C C;
+    for (auto isa : this->supported_instruction_sets()) {
+        hoComplexKernels::set_instruction_set(isa);
+        for (size_t N : this->lengths) {
+            auto x = this->random_vector(N, 1);
+            auto y = this->random_vector(N, 2);
+            std::vector<C> r(N), rc(N), rd(N);
+
+            hoComplexKernels::multiply(N, x.data(), y.data(), r.data());
+            hoComplexKernels::multiply_conj(N, x.data(), y.data(), rc.data());
+            hoComplexKernels::divide(N, x.data(), y.data(), rd.data());
+
+            for (size_t n = 0; n < N; n++) {
+                ASSERT_LT(std::abs(r[n] - x[n] * y[n]), this->tolerance * std::abs(x[n] * y[n])) << int(isa) << ", " << N << ", " << n;
+                ASSERT_LT(std::abs(rc[n] - x[n] * std::conj(y[n])), this->tolerance * std::abs(x[n] * y[n])) << int(isa) << ", " << N << ", " << n;
+                ASSERT_LT(std::abs(rd[n] - x[n] / y[n]), this->tolerance * std::abs(x[n] / y[n])) << int(isa) << ", " << N << ", " << n;
+            }
+        }
+    }
+}
+
+TYPED_TEST(hoComplexKernels_Test, in_place) {
+    typedef typename TestFixture::C C;
+    for (auto isa : this->supported_instruction_sets()) {
+        hoComplexKernels::set_instruction_set(isa);
+        auto x = this->random_vector(37, 3);
+        auto y = this->random_vector(37, 4);
+        auto r = x;
+        hoComplexKernels::multiply(r.size(), r.data(), y.data(), r.data());
+        for (size_t n = 0; n < r.size(); n++)
+            ASSERT_LT(std::abs(r[n] - x[n] * y[n]), this->tolerance * std::abs(x[n] * y[n])) << int(isa) << ", " << n;
+    }
+}
+
+TYPED_TEST(hoComplexKernels_Test, abs_argument) {
+    typedef TypeParam T;
+    typedef typename TestFixture::C C;
+    for (auto isa : this->supported_instruction_sets()) {
+        hoComplexKernels::set_instruction_set(isa);
+        for (size_t N : this->lengths) {
+            auto x = this->random_vector(N, 5);
+            std::vector<T> a(N), p(N);
+
+            hoComplexKernels::abs(N, x.data(), a.data());
+            hoComplexKernels::argument(N, x.data(), p.data());
+
+            for (size_t n = 0; n < N; n++) {
+                ASSERT_NEAR(a[n], std::abs(x[n]), this->tolerance * std::abs(x[n])) << int(isa) << ", " << N << ", " << n;
+                ASSERT_NEAR(p[n], std::arg(x[n]), 4 * std::numeric_limits<T>::epsilon() * M_PI) << int(isa) << ", " << N << ", " << n;
+            }
+        }
+    }
+}
+
+TYPED_TEST(hoComplexKernels_Test, argument_special_values) {
+    typedef TypeParam T;
+    typedef typename TestFixture::C C;
+
+    // every combination of signed zeros, the axes, the diagonals and the octant boundaries
+    const T values[] = { T(0), -T(0), T(1), T(-1), T(0.5), T(-2), T(1e-3), T(-7) };
+    std::vector<C> x;
+    for (T re : values)
+        for (T im : values) x.push_back(C(re, im));
+
+    for (auto isa : this->supported_instruction_sets()) {
+        hoComplexKernels::set_instruction_set(isa);
+        std::vector<T> p(x.size());
+        hoComplexKernels::argument(x.size(), x.data(), p.data());
+        for (size_t n = 0; n < x.size(); n++) {
+            ASSERT_NEAR(p[n], std::arg(x[n]), 4 * std::numeric_limits<T>::epsilon() * M_PI) << int(isa) << ", " << x[n];
+            ASSERT_EQ(std::signbit(p[n]), std::signbit(std::arg(x[n]))) << int(isa) << ", " << x[n];
+        }
+    }
+}
+
+TYPED_TEST(hoComplexKernels_Test, axpy_dotc) {
+    typedef typename TestFixture::C C;
+    const C a(0.75, -1.25);
+    for (auto isa : this->supported_instruction_sets()) {
+        hoComplexKernels::set_instruction_set(isa);
+        for (size_t N : this->lengths) {
+            auto x = this->random_vector(N, 6);
+            auto y = this->random_vector(N, 7);
+
+            auto r = y;
+            hoComplexKernels::axpy(N, a, x.data(), r.data());
+            for (size_t n = 0; n < N; n++)
+                ASSERT_LT(std::abs(r[n] - (a * x[n] + y[n])), this->tolerance * (std::abs(a * x[n]) + std::abs(y[n]))) << int(isa) << ", " << N << ", " << n;
+
+            std::complex<double> expected = 0;
+            double scale = 0;
+            for (size_t n = 0; n < N; n++) {
+                expected += std::conj(std::complex<double>(x[n])) * std::complex<double>(y[n]);
+                scale += std::abs(x[n]) * std::abs(y[n]);
+            }
+            C d = hoComplexKernels::dotc(N, x.data(), y.data());
+            ASSERT_LE(std::abs(std::complex<double>(d) - expected), 10 * this->tolerance * scale) << int(isa) << ", " << N;
+        }
+    }
+}
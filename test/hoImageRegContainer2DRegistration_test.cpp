@@ -0,0 +1,118 @@
+#include "hoImageRegContainer2DRegistration.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace Gadgetron;
+
+namespace {
+
+    typedef hoNDImage<float, 2> ImageType;
+    typedef hoImageRegContainer2DRegistration<ImageType, ImageType, double> RegContainerType;
+
+    // a blob moving over the frames, on a smooth background
+    void make_frames(hoNDImageContainer2D<ImageType>& container, size_t RO, size_t E1, size_t N) {
+        std::vector<size_t> cols(1, N);
+        std::vector<size_t> dim{ RO, E1 };
+        container.create(cols, dim);
+
+        for (size_t n = 0; n < N; n++) {
+            ImageType& im = container(0, n);
+            float cx = RO / 2.0f + 3.0f * std::sin(2 * M_PI * n / N);
+            float cy = E1 / 2.0f + 2.0f * std::cos(2 * M_PI * n / N);
+            for (size_t y = 0; y < E1; y++)
+                for (size_t x = 0; x < RO; x++) {
+                    float r2 = ((x - cx) * (x - cx) + (y - cy) * (y - cy)) / (0.04f * RO * E1);
+                    im(x, y) = 100.0f * std::exp(-r2) + 10.0f + 0.05f * x;
+                }
+        }
+    }
+
+    void set_parameters(RegContainerType& reg) {
+        reg.setDefaultParameters(3, false);
+        reg.container_reg_mode_ = GT_IMAGE_REG_CONTAINER_FIXED_REFERENCE;
+        reg.container_reg_transformation_ = GT_IMAGE_REG_TRANSFORMATION_DEFORMATION_FIELD_BIDIRECTIONAL;
+        reg.max_iter_num_pyramid_level_ = std::vector<unsigned int>{ 8, 16, 16 };
+        reg.dissimilarity_type_ = GT_IMAGE_DISSIMILARITY_LocalCCR;
+    }
+
+    // gives the tests the register the container keeps per thread
+    class ReusedRegContainer : public RegContainerType {
+    public:
+        using RegContainerType::DeformationFieldBidirectionalRegisterType;
+        using RegContainerType::createDeformationFieldBidirectionalRegister;
+        using RegContainerType::registerTwoImagesDeformationFieldBidirectional;
+    };
+}
+
+// the container registration reuses one register per thread, it must give the same result as one register per frame
+TEST(hoImageRegContainer2DRegistration, fixed_reference_matches_pair_registration) {
+    hoNDImageContainer2D<ImageType> frames;
+    make_frames(frames, 64, 48, 9);
+
+    std::vector<unsigned int> ref(1, 4);
+
+    RegContainerType reg;
+    set_parameters(reg);
+    ASSERT_TRUE(reg.registerOverContainer2DFixedReference(frames, ref, true, false));
+
+    RegContainerType pair;
+    set_parameters(pair);
+
+    for (size_t n = 0; n < frames.cols()[0]; n++) {
+        if (n == ref[0]) continue;
+
+        ImageType warped;
+        hoNDImage<double, 2> dx, dy, dxInv, dyInv;
+        hoNDImage<double, 2>* deform[2] = { &dx, &dy };
+        hoNDImage<double, 2>* deformInv[2] = { &dxInv, &dyInv };
+
+        ASSERT_TRUE(pair.registerTwoImagesDeformationFieldBidirectional(frames(0, ref[0]), frames(0, n), false, &warped, deform, deformInv));
+
+        for (size_t i = 0; i < dx.get_number_of_elements(); i++) {
+            ASSERT_EQ(dx(i), reg.deformation_field_[0](0, n)(i));
+            ASSERT_EQ(dy(i), reg.deformation_field_[1](0, n)(i));
+            ASSERT_EQ(dxInv(i), reg.deformation_field_inverse_[0](0, n)(i));
+        }
+
+        for (size_t i = 0; i < warped.get_number_of_elements(); i++)
+            ASSERT_EQ(warped(i), reg.warped_container_(0, n)(i));
+    }
+}
+
+// a register reused for images of another size gives the same result as a new register
+TEST(hoImageRegContainer2DRegistration, reused_register_follows_image_size) {
+    hoNDImageContainer2D<ImageType> large, small;
+    make_frames(large, 64, 48, 3);
+    make_frames(small, 40, 56, 3);
+
+    ReusedRegContainer container;
+    set_parameters(container);
+    std::unique_ptr<ReusedRegContainer::DeformationFieldBidirectionalRegisterType> reused(container.createDeformationFieldBidirectionalRegister());
+    std::unique_ptr<ReusedRegContainer::DeformationFieldBidirectionalRegisterType> fresh(container.createDeformationFieldBidirectionalRegister());
+
+    ImageType warped, warpedFresh;
+    hoNDImage<double, 2> dx, dy, dxInv, dyInv, dxFresh, dyFresh, dxInvFresh, dyInvFresh;
+    hoNDImage<double, 2>* deform[2] = { &dx, &dy };
+    hoNDImage<double, 2>* deformInv[2] = { &dxInv, &dyInv };
+    hoNDImage<double, 2>* deformFresh[2] = { &dxFresh, &dyFresh };
+    hoNDImage<double, 2>* deformInvFresh[2] = { &dxInvFresh, &dyInvFresh };
+
+    ASSERT_TRUE(container.registerTwoImagesDeformationFieldBidirectional(*reused, large(0, 1), large(0, 0), false, &warped, deform, deformInv));
+    ASSERT_TRUE(container.registerTwoImagesDeformationFieldBidirectional(*reused, small(0, 1), small(0, 0), false, &warped, deform, deformInv));
+    ASSERT_TRUE(container.registerTwoImagesDeformationFieldBidirectional(*fresh, small(0, 1), small(0, 0), false, &warpedFresh, deformFresh, deformInvFresh));
+
+    ASSERT_EQ(dx.get_size(0), 40);
+    ASSERT_EQ(dx.get_size(1), 56);
+    ASSERT_EQ(dxInv.get_number_of_elements(), dxInvFresh.get_number_of_elements());
+
+    for (size_t i = 0; i < dxFresh.get_number_of_elements(); i++) {
+        ASSERT_EQ(dx(i), dxFresh(i));
+        ASSERT_EQ(dy(i), dyFresh(i));
+        ASSERT_EQ(dxInv(i), dxInvFresh(i));
+        ASSERT_EQ(dyInv(i), dyInvFresh(i));
+    }
+
+    for (size_t i = 0; i < warpedFresh.get_number_of_elements(); i++)
+        ASSERT_EQ(warped(i), warpedFresh(i));
+}
@@ -0,0 +1,123 @@
+#include "hoImageRegWarper.h"
+#include "hoImageRegRigid2DTransformation.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    template <typename ImageType> void fill_image(ImageType& im, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        for (size_t n = 0; n < im.get_number_of_elements(); n++)
+            im(n) = dist(gen);
+    }
+
+    // deformation of up to +-3 pixels, large enough to move pixels across the image border
+    template <unsigned int D> void fill_deformation(hoImageRegDeformationField<double, D>& deform, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<double> dist(-3.0, 3.0);
+        for (unsigned int d = 0; d < D; d++) {
+            hoNDImage<double, D>& field = deform.getDeformationField(d);
+            for (size_t n = 0; n < field.get_number_of_elements(); n++)
+                field(n) = dist(gen);
+        }
+    }
+
+    template <typename ImageType> double max_difference(const ImageType& a, const ImageType& b) {
+        double r = 0;
+        for (size_t n = 0; n < a.get_number_of_elements(); n++)
+            r = std::max(r, (double)std::abs(a(n) - b(n)));
+        return r;
+    }
+
+    template <unsigned int D>
+    void compare_engine_with_generic_path(const std::vector<size_t>& dims, GT_IMAGE_INTERPOLATOR interp_type,
+        GT_BOUNDARY_CONDITION bh_type, bool useWorldCoordinate, double tolerance) {
+        typedef hoNDImage<float, D> ImageType;
+
+        ImageType target(dims), source(dims);
+        fill_image(target, 11);
+        fill_image(source, 12);
+
+        // a part of the target is background and must not be warped
+        for (size_t n = 0; n < target.get_number_of_elements(); n += 7)
+            target(n) = 0;
+
+        hoImageRegDeformationField<double, D> deform(dims);
+        fill_deformation(deform, 13);
+
+        std::unique_ptr<hoNDBoundaryHandler<ImageType>> bh(createBoundaryHandler<ImageType>(bh_type));
+        bh->setArray(source);
+        std::unique_ptr<hoNDInterpolator<ImageType>> interp(createInterpolator<ImageType, D>(interp_type));
+        interp->setArray(source);
+        interp->setBoundaryHandler(*bh);
+
+        hoImageRegWarper<ImageType, ImageType, double> warper;
+        warper.setTransformation(deform);
+        warper.setInterpolator(*interp);
+
+        ImageType warped_generic, warped_engine;
+
+        warper.useWarpEngine_ = false;
+        ASSERT_TRUE(warper.warp(target, source, useWorldCoordinate, warped_generic));
+
+        warper.useWarpEngine_ = true;
+        ASSERT_TRUE(warper.warp(target, source, useWorldCoordinate, warped_engine));
+
+        EXPECT_LE(max_difference(warped_generic, warped_engine), tolerance);
+
+        for (size_t n = 0; n < target.get_number_of_elements(); n += 7)
+            EXPECT_EQ(warped_engine(n), 0);
+    }
+}
+
+TEST(hoImageRegWarper, linear2D) {
+    std::vector<size_t> dims{ 131, 97 };
+    for (auto bh : { GT_BOUNDARY_CONDITION_FIXEDVALUE, GT_BOUNDARY_CONDITION_BORDERVALUE, GT_BOUNDARY_CONDITION_PERIODIC, GT_BOUNDARY_CONDITION_MIRROR }) {
+        compare_engine_with_generic_path<2>(dims, GT_IMAGE_INTERPOLATOR_LINEAR, bh, false, 1e-6);
+        compare_engine_with_generic_path<2>(dims, GT_IMAGE_INTERPOLATOR_LINEAR, bh, true, 1e-6);
+    }
+}
+
+TEST(hoImageRegWarper, linear3D) {
+    std::vector<size_t> dims{ 67, 45, 23 };
+    compare_engine_with_generic_path<3>(dims, GT_IMAGE_INTERPOLATOR_LINEAR, GT_BOUNDARY_CONDITION_BORDERVALUE, false, 1e-6);
+    compare_engine_with_generic_path<3>(dims, GT_IMAGE_INTERPOLATOR_LINEAR, GT_BOUNDARY_CONDITION_FIXEDVALUE, true, 1e-6);
+}
+
+TEST(hoImageRegWarper, bspline2D) {
+    std::vector<size_t> dims{ 64, 48 };
+    compare_engine_with_generic_path<2>(dims, GT_IMAGE_INTERPOLATOR_BSPLINE, GT_BOUNDARY_CONDITION_BORDERVALUE, false, 1e-6);
+}
+
+TEST(hoImageRegWarper, rigid2D) {
+    typedef hoNDImage<float, 2> ImageType;
+
+    std::vector<size_t> dims{ 256, 192 };
+    ImageType target(dims), source(dims);
+    fill_image(target, 21);
+    fill_image(source, 22);
+
+    hoImageRegRigid2DTransformation<double> rigid;
+    rigid.set_tx_ty_rz(2.5, -1.25, 5.0);
+
+    hoNDBoundaryHandlerBorderValue<ImageType> bh(source);
+    hoNDInterpolatorLinear<ImageType> interp(source, bh);
+
+    hoImageRegWarper<ImageType, ImageType, double> warper;
+    warper.setTransformation(rigid);
+    warper.setInterpolator(interp);
+
+    ImageType warped_generic, warped_engine;
+
+    warper.useWarpEngine_ = false;
+    ASSERT_TRUE(warper.warp(target, source, false, warped_generic));
+
+    warper.useWarpEngine_ = true;
+    ASSERT_TRUE(warper.warp(target, source, false, warped_engine));
+
+    EXPECT_LE(max_difference(warped_generic, warped_engine), 1e-6);
+}
@@ -0,0 +1,140 @@
+#include "hoNDArray_expressions.h"
+#include "complext.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template <typename T> class hoNDArray_expressions_Test : public ::testing::Test {
+public:
+    typedef typename realType<T>::Type REAL;
+
+    static hoNDArray<T> random_array(const std::vector<size_t>& dims, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<REAL> dist(0.5, 1.5);
+        hoNDArray<T> x(dims);
+        for (size_t i = 0; i < x.get_number_of_elements(); i++) {
+            if constexpr (is_complex_type_v<T>)
+                x[i] = T(dist(gen), dist(gen));
+            else
+                x[i] = dist(gen);
+        }
+        return x;
+    }
+
+    static REAL distance(T a, T b) {
+        using std::abs;
+        return abs(a - b);
+    }
+
+protected:
+    virtual void SetUp() {
+        dims = { 37, 49, 23, 3 }; // more than NumElementsUseThreading, so the parallel loops are covered too
+        A = random_array(dims, 1);
+        B = random_array(dims, 2);
+        C = random_array(dims, 3);
+    }
+
+    std::vector<size_t> dims;
+    hoNDArray<T> A, B, C;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>, float_complext> ExpressionTypes;
+TYPED_TEST_SUITE(hoNDArray_expressions_Test, ExpressionTypes);
+
+TYPED_TEST(hoNDArray_expressions_Test, arithmetic) {
+    typedef typename TestFixture::REAL REAL;
+
+    hoNDArray<TypeParam> r;
+    assign(r, lazy(this->A) * lazy(this->B) - lazy(this->C) / lazy(this->B) + REAL(2));
+    ASSERT_EQ(r.dimensions(), this->dims);
+    for (size_t i = 0; i < r.get_number_of_elements(); i++)
+        ASSERT_LT(this->distance(r[i], this->A[i] * this->B[i] - this->C[i] / this->B[i] + REAL(2)), 1e-5) << i;
+
+    auto negated = eval(REAL(1) - lazy(this->A) * 0.5);
+    for (size_t i = 0; i < negated.get_number_of_elements(); i++)
+        ASSERT_LT(this->distance(negated[i], REAL(1) - this->A[i] * REAL(0.5)), 1e-6) << i;
+
+    assign(r, -lazy(this->C));
+    for (size_t i = 0; i < r.get_number_of_elements(); i++)
+        ASSERT_EQ(this->distance(r[i], TypeParam(0) - this->C[i]), 0) << i;
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, in_place) {
+    hoNDArray<TypeParam> x = this->A;
+    assign(x, lazy(x) * lazy(this->B) + lazy(this->C));
+    for (size_t i = 0; i < x.get_number_of_elements(); i++)
+        ASSERT_LT(this->distance(x[i], this->A[i] * this->B[i] + this->C[i]), 1e-5) << i;
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, broadcast) {
+    hoNDArray<TypeParam> plane(this->dims[0], this->dims[1], this->A.get_data_ptr());
+    size_t plane_size = plane.get_number_of_elements();
+
+    hoNDArray<TypeParam> r;
+    assign(r, lazy(plane) * lazy(this->B) + lazy(this->C));
+    ASSERT_EQ(r.dimensions(), this->dims);
+    for (size_t i = 0; i < r.get_number_of_elements(); i++)
+        ASSERT_LT(this->distance(r[i], plane[i % plane_size] * this->B[i] + this->C[i]), 1e-5) << i;
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, along) {
+    for (size_t dim = 0; dim < this->dims.size(); dim++) {
+        auto f = this->random_array({ this->dims[dim] }, 4 + dim);
+
+        // along the first dimension f is broadcast
+        hoNDArray<TypeParam> r;
+        if (dim == 0)
+            assign(r, lazy(this->A) * lazy(f));
+        else
+            assign(r, lazy(this->A) * along(f, dim, this->dims));
+
+        size_t stride = 1;
+        for (size_t d = 0; d < dim; d++) stride *= this->dims[d];
+        for (size_t i = 0; i < r.get_number_of_elements(); i++)
+            ASSERT_LT(this->distance(r[i], this->A[i] * f[(i / stride) % this->dims[dim]]), 1e-5) << dim << ", " << i;
+    }
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, reductions) {
+    typedef typename TestFixture::REAL REAL;
+    size_t N = this->A.get_number_of_elements();
+    double tolerance = std::is_same<REAL, float>::value ? 1e-4 : 1e-10;
+
+    std::complex<double> expected_sum = 0, expected_dot = 0;
+    double expected_nrm2 = 0;
+    for (size_t i = 0; i < N; i++) {
+        std::complex<double> a(real(this->A[i]), imag(this->A[i])), b(real(this->B[i]), imag(this->B[i]));
+        expected_sum += a + b;
+        expected_dot += std::conj(a) * b;
+        expected_nrm2 += std::norm(a - b);
+    }
+    expected_nrm2 = std::sqrt(expected_nrm2);
+
+    auto s = sum(lazy(this->A) + lazy(this->B));
+    EXPECT_LT(std::abs(std::complex<double>(std::real(s), std::imag(s)) - expected_sum) / std::abs(expected_sum), tolerance);
+
+    auto d = dot(lazy(this->A), lazy(this->B));
+    EXPECT_LT(std::abs(std::complex<double>(std::real(d), std::imag(d)) - expected_dot) / std::abs(expected_dot), tolerance);
+
+    REAL n = nrm2(lazy(this->A) - lazy(this->B));
+    EXPECT_NEAR(n / expected_nrm2, 1.0, tolerance);
+}
+
+TEST(hoNDArray_expressions, complex_functions) {
+    typedef std::complex<float> T;
+    auto x = hoNDArray_expressions_Test<T>::random_array({ 61, 17 }, 5);
+
+    hoNDArray<float> r;
+    assign(r, abs(lazy(x)) + norm(lazy(x)) * real(lazy(x)) - imag(conj(lazy(x))));
+    for (size_t i = 0; i < x.get_number_of_elements(); i++)
+        ASSERT_NEAR(r[i], std::abs(x[i]) + std::norm(x[i]) * x[i].real() + x[i].imag(), 1e-5) << i;
+}
+
+TEST(hoNDArray_expressions, incompatible_dimensions) {
+    hoNDArray<float> a(16, 8), b(8, 16), r;
+    EXPECT_THROW(assign(r, lazy(a) + lazy(b)), std::runtime_error);
+}
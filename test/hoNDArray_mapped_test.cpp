@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include "hoNDArray_mapped.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <complex>
+#include <numeric>
+
+using namespace Gadgetron;
+
+TEST(hoNDArray_mapped, starts_out_zero) {
+    auto x = create_mapped_array<std::complex<float>>({ 64, 32, 8 }, boost::filesystem::temp_directory_path().string());
+
+    ASSERT_TRUE(is_mapped(x));
+    EXPECT_EQ(x.get_number_of_elements(), 64 * 32 * 8);
+    EXPECT_TRUE(std::all_of(x.begin(), x.end(), [](auto v) { return v == std::complex<float>(0); }));
+}
+
+TEST(hoNDArray_mapped, moves_and_copies) {
+    auto before = mapped_memory_in_use();
+    {
+        auto x = create_mapped_array<float>({ 1000, 100 }, boost::filesystem::temp_directory_path().string());
+        std::iota(x.begin(), x.end(), 0.0f);
+        EXPECT_EQ(mapped_memory_in_use(), before + x.get_number_of_bytes());
+
+        // A copy is an ordinary array; a move keeps the mapping
+        hoNDArray<float> copy(x);
+        EXPECT_FALSE(is_mapped(copy));
+        EXPECT_EQ(copy, x);
+
+        auto data = x.get_data_ptr();
+        hoNDArray<float> moved(std::move(x));
+        EXPECT_EQ(moved.get_data_ptr(), data);
+        EXPECT_TRUE(is_mapped(moved));
+
+        hoNDArray<float> assigned;
+        assigned = std::move(moved);
+        EXPECT_TRUE(is_mapped(assigned));
+        EXPECT_EQ(assigned, copy);
+
+        prefetch(assigned, 100 * 1000 / 2, 1000);
+        advise_sequential(assigned);
+    }
+    EXPECT_EQ(mapped_memory_in_use(), before);
+}
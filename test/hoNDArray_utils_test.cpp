@@ -5,6 +5,7 @@
 #include "GadgetronTimer.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <complex>
 #include <vector>
 #include <range/v3/view.hpp>
@@ -12,6 +13,21 @@
 using namespace Gadgetron;
 using testing::Types;
 
+// element by element permutation, to compare permute with
+template <typename T> static hoNDArray<T> reference_permute(const hoNDArray<T>& in, const std::vector<size_t>& order) {
+  std::vector<size_t> dims;
+  for (auto d : order) dims.push_back(in.get_size(d));
+  hoNDArray<T> out(dims);
+
+  std::vector<size_t> index(order.size()), in_index(order.size());
+  for (size_t i = 0; i < out.get_number_of_elements(); i++) {
+    out.calculate_index(i, index);
+    for (size_t d = 0; d < order.size(); d++) in_index[order[d]] = index[d];
+    out[i] = in[in.calculate_offset(in_index)];
+  }
+  return out;
+}
+
 template <typename T> class hoNDArray_utils_TestReal : public ::testing::Test {
 protected:
   virtual void SetUp() {
@@ -108,6 +124,53 @@ TYPED_TEST(hoNDArray_utils_TestReal,permuteTest){
   EXPECT_FLOAT_EQ(2, permute(this->Array,order)[851]);
 }
 
+TYPED_TEST(hoNDArray_utils_TestReal,permuteAllOrdersTest){
+  // larger than the tiles and above the threading threshold
+  hoNDArray<TypeParam> x(71, 37, 5, 9);
+  for (size_t i = 0; i < x.get_number_of_elements(); i++) x[i] = TypeParam(i);
+
+  std::vector<size_t> order = {0, 1, 2, 3};
+  do {
+    auto expected = reference_permute(x, order);
+    auto result = permute(x, order);
+    ASSERT_EQ(expected.dimensions(), result.dimensions());
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+      ASSERT_EQ(expected[i], result[i]) << order[0] << order[1] << order[2] << order[3] << ", " << i;
+  } while (std::next_permutation(order.begin(), order.end()));
+}
+
+TYPED_TEST(hoNDArray_utils_TestReal,permuteSingletonTest){
+  // the dimensions of size one are dropped, and CHA moves from after RO to the end
+  hoNDArray<TypeParam> x(64, 1, 8, 1, 33);
+  for (size_t i = 0; i < x.get_number_of_elements(); i++) x[i] = TypeParam(i);
+
+  for (auto order : std::vector<std::vector<size_t>>{ {0, 1, 3, 4, 2}, {2, 0, 1, 3, 4}, {4, 3, 2, 1, 0}, {1, 3, 0, 2, 4} }) {
+    auto expected = reference_permute(x, order);
+    auto result = permute(x, order);
+    ASSERT_EQ(expected.dimensions(), result.dimensions());
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+      ASSERT_EQ(expected[i], result[i]) << i;
+  }
+}
+
+TYPED_TEST(hoNDArray_utils_TestReal,permuteInplaceTest){
+  // square transposes, which are done in place, a copy, and orders which go through a temporary array
+  std::vector<std::pair<std::vector<size_t>, std::vector<size_t>>> cases = {
+    { {67, 67, 3}, {1, 0, 2} }, { {128, 128}, {1, 0} }, { {67, 67, 3}, {0, 1, 2} },
+    { {67, 67, 3}, {2, 0, 1} }, { {37, 49, 23}, {1, 0, 2} } };
+
+  for (auto& c : cases) {
+    hoNDArray<TypeParam> x(c.first);
+    for (size_t i = 0; i < x.get_number_of_elements(); i++) x[i] = TypeParam(i);
+
+    auto expected = reference_permute(x, c.second);
+    permute_inplace(x, c.second);
+    ASSERT_EQ(expected.dimensions(), x.dimensions());
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+      ASSERT_EQ(expected[i], x[i]) << i;
+  }
+}
+
 TYPED_TEST(hoNDArray_utils_TestReal,shiftDimTest){
 
   fill(&this->Array,TypeParam(1));
@@ -184,6 +247,27 @@ TYPED_TEST(hoNDArray_utils_TestCplx,permuteTest){
   EXPECT_FLOAT_EQ(3, imag(permute(this->Array, order)[37*23*19]));
 }
 
+TYPED_TEST(hoNDArray_utils_TestCplx,permuteAllOrdersTest){
+  hoNDArray<TypeParam> x(71, 37, 5, 9);
+  for (size_t i = 0; i < x.get_number_of_elements(); i++) x[i] = TypeParam(i, -float(i));
+
+  std::vector<size_t> order = {0, 1, 2, 3};
+  do {
+    auto expected = reference_permute(x, order);
+    auto result = permute(x, order);
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++) {
+      ASSERT_EQ(real(expected[i]), real(result[i])) << i;
+      ASSERT_EQ(imag(expected[i]), imag(result[i])) << i;
+    }
+
+    auto y = x;
+    permute_inplace(y, order);
+    ASSERT_EQ(expected.dimensions(), y.dimensions());
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+      ASSERT_EQ(real(expected[i]), real(y[i])) << i;
+  } while (std::next_permutation(order.begin(), order.end()));
+}
+
 TYPED_TEST(hoNDArray_utils_TestCplx,shiftDimTest){
 
   fill(&this->Array,TypeParam(1,1));
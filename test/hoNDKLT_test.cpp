@@ -0,0 +1,256 @@
+#include "hoNDKLT.h"
+#include "hoArmadillo.h"
+#include "hoNDArray_elemwise.h"
+#include "mri_core_utility.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    typedef std::complex<float> T;
+
+    // sources of decaying strength, every one ratio times the one before, mixed into CHA channels, plus white noise of noise_sigma
+    hoNDArray<T> mixed_sources(const std::vector<size_t>& dims, size_t sources, float ratio, float noise_sigma, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::normal_distribution<float> dist;
+
+        size_t CHA = dims[3];
+        hoNDArray<T> mix(sources, CHA);
+        for (auto& v : mix) v = T(dist(gen), dist(gen));
+
+        hoNDArray<T> data(dims);
+        Gadgetron::clear(data);
+
+        size_t num = dims[0] * dims[1] * dims[2];
+        size_t images = data.get_number_of_elements() / (num * CHA);
+        for (size_t i = 0; i < images; i++) {
+            T* pData = data.begin() + i * num * CHA;
+            for (size_t k = 0; k < sources; k++) {
+                float strength = 10.0f * std::pow(ratio, (float)k);
+                for (size_t m = 0; m < num; m++) {
+                    T s = strength * T(dist(gen), dist(gen));
+                    for (size_t cha = 0; cha < CHA; cha++) pData[m + cha * num] += s * mix(k, cha);
+                }
+            }
+        }
+
+        for (auto& v : data) v += noise_sigma * T(dist(gen), dist(gen));
+        return data;
+    }
+
+    // the KLT as computed before the blocked covariance: the singular value decomposition of the mean free [M CHA] data matrix
+    void svd_baseline(const hoNDArray<T>& data, hoNDArray<T>& V, hoNDArray<float>& E) {
+        size_t CHA = data.get_size(3);
+        size_t M = data.get_number_of_elements() / CHA;
+
+        hoNDArray<T> data2D(M, CHA);
+        for (size_t cha = 0; cha < CHA; cha++) {
+            T mean = 0;
+            for (size_t m = 0; m < M; m++) mean += data[m + cha * M];
+            mean /= (float)M;
+            for (size_t m = 0; m < M; m++) data2D(m, cha) = data[m + cha * M] - mean;
+        }
+
+        arma::Mat<T> Am = as_arma_matrix(data2D);
+        arma::Mat<T> Um, Vm;
+        arma::Col<float> Sv;
+        arma::svd_econ(Um, Sv, Vm, Am, 'r');
+
+        V.create(CHA, CHA);
+        memcpy(V.begin(), Vm.memptr(), sizeof(T) * CHA * CHA);
+
+        E.create(CHA);
+        for (size_t n = 0; n < CHA; n++) E[n] = Sv(n) * Sv(n);
+    }
+
+    // distance between the subspaces spanned by the first L columns of V1 and V2, |V1*V1' - V2*V2'|
+    float subspace_distance(const hoNDArray<T>& V1, const hoNDArray<T>& V2, size_t L) {
+        size_t N = V1.get_size(0);
+        float diff = 0;
+        for (size_t c = 0; c < N; c++) {
+            for (size_t r = 0; r < N; r++) {
+                T p1 = 0, p2 = 0;
+                for (size_t l = 0; l < L; l++) {
+                    p1 += V1(r, l) * std::conj(V1(c, l));
+                    p2 += V2(r, l) * std::conj(V2(c, l));
+                }
+                diff += std::norm(p1 - p2);
+            }
+        }
+        return std::sqrt(diff);
+    }
+
+    hoNDArray<T> rotate_channels(const hoNDArray<T>& data) {
+        size_t CHA = data.get_size(3);
+        size_t M = data.get_number_of_elements() / CHA;
+
+        hoNDArray<T> rotated(data.dimensions());
+        for (size_t cha = 0; cha < CHA; cha++)
+            memcpy(rotated.begin() + ((cha + 1) % CHA) * M, data.begin() + cha * M, sizeof(T) * M);
+        return rotated;
+    }
+}
+
+TEST(hoNDKLT, prepare_matches_svd) {
+    auto data = mixed_sources({ 48, 40, 3, 8 }, 5, 0.5f, 0.1f, 1);
+
+    hoNDArray<T> V_svd;
+    hoNDArray<float> E_svd;
+    svd_baseline(data, V_svd, E_svd);
+
+    hoNDKLT<T> klt;
+    klt.prepare(data, 3, (size_t)0);
+    EXPECT_EQ(klt.output_length(), 8);
+
+    hoNDArray<T> V, E;
+    klt.eigen_vector(V);
+    klt.eigen_value(E);
+
+    for (size_t n = 0; n < 8; n++) EXPECT_NEAR(std::real(E[n]), E_svd[n], 1e-3f * E_svd[0]) << n;
+
+    // the modes of the sources are well separated from each other and from the noise
+    for (size_t L = 1; L <= 5; L++) EXPECT_LT(subspace_distance(V, V_svd, L), 5e-3f) << L;
+}
+
+TEST(hoNDKLT, prepare_matches_svd_along_inner_dimension) {
+    // the channels are not the last dimension, so the data are permuted before the covariance is accumulated
+    auto data = mixed_sources({ 32, 32, 2, 6 }, 4, 0.5f, 0.1f, 2);
+    hoNDArray<T> data5D(32, 32, 2, 6, 1);
+    memcpy(data5D.begin(), data.begin(), sizeof(T) * data.get_number_of_elements());
+    hoNDArray<T> extended(32, 32, 2, 6, 2);
+    memcpy(extended.begin(), data.begin(), sizeof(T) * data.get_number_of_elements());
+    memcpy(extended.begin() + data.get_number_of_elements(), data.begin(), sizeof(T) * data.get_number_of_elements());
+
+    hoNDKLT<T> klt, klt_extended;
+    klt.prepare(data5D, 3, (size_t)0);
+    klt_extended.prepare(extended, 3, (size_t)0);
+
+    hoNDArray<T> V, V_extended, E, E_extended;
+    klt.eigen_vector(V);
+    klt.eigen_value(E);
+    klt_extended.eigen_vector(V_extended);
+    klt_extended.eigen_value(E_extended);
+
+    // twice the same samples: twice the energy, the same modes
+    for (size_t n = 0; n < 6; n++) EXPECT_NEAR(std::real(E_extended[n]), 2 * std::real(E[n]), 1e-3f * std::real(E[0])) << n;
+    for (size_t L = 1; L <= 4; L++) EXPECT_LT(subspace_distance(V, V_extended, L), 1e-3f) << L;
+}
+
+TEST(hoNDKLT, prepare_randomized_energy_threshold) {
+    // 8 channels, 256 samples per channel are drawn from 9600 samples; every source has 1/16 of the energy of the one before
+    auto data = mixed_sources({ 48, 40, 5, 8 }, 5, 0.25f, 0.01f, 3);
+
+    hoNDArray<T> V_svd;
+    hoNDArray<float> E_svd;
+    svd_baseline(data, V_svd, E_svd);
+
+    float total = 0;
+    for (size_t n = 0; n < 8; n++) total += E_svd[n];
+
+    for (float thres : { 0.9f, 0.99f }) {
+        // smallest number of modes holding thres of the energy
+        size_t expected = 0;
+        float kept = 0;
+        while (kept < thres * total) kept += E_svd[expected++];
+
+        hoNDKLT<T> klt;
+        klt.prepare_randomized(data, 3, thres);
+
+        // the thresholds are away from the energy held by 1 and 2 modes, so the estimate does not cross a neighbouring mode
+        EXPECT_EQ(klt.output_length(), expected) << thres;
+
+        hoNDArray<T> V;
+        klt.eigen_vector(V);
+        EXPECT_LT(subspace_distance(V, V_svd, klt.output_length()), 0.1f) << thres;
+    }
+
+    // max_modes caps the number of modes, with energy_thres <= 0 exactly max_modes are kept
+    hoNDKLT<T> klt;
+    klt.prepare_randomized(data, 3, 0.999f, 2);
+    EXPECT_EQ(klt.output_length(), 2);
+    klt.prepare_randomized(data, 3, 0.0f, 3);
+    EXPECT_EQ(klt.output_length(), 3);
+}
+
+TEST(hoNDKLT, is_stable) {
+    auto data = mixed_sources({ 48, 40, 4, 8 }, 4, 0.5f, 0.1f, 4);
+
+    hoNDKLT<T> klt;
+    klt.prepare(data, 3, (size_t)4);
+
+    // the relative energies are estimated from every third sample, within a few percent
+    EXPECT_TRUE(klt.is_stable(data, 3, 0.05f));
+
+    // a little more noise does not change the modes
+    hoNDArray<T> noisy(data);
+    std::mt19937 gen(5);
+    std::normal_distribution<float> dist;
+    for (auto& v : noisy) v += 0.1f * T(dist(gen), dist(gen));
+    EXPECT_TRUE(klt.is_stable(noisy, 3, 0.05f));
+
+    // the channels rotated are not described by the modes any more
+    EXPECT_FALSE(klt.is_stable(rotate_channels(data), 3, 0.05f));
+
+    // other sources, mixed differently
+    EXPECT_FALSE(klt.is_stable(mixed_sources({ 48, 40, 4, 8 }, 4, 0.5f, 0.1f, 6), 3, 0.05f));
+}
+
+TEST(hoNDKLT, compute_eigen_channel_coefficients_reuses_stable_coefficients) {
+    // 3 N of the same sources with different noise
+    auto base = mixed_sources({ 24, 24, 2, 6 }, 3, 0.5f, 0.1f, 7);
+    hoNDArray<T> data(24, 24, 2, 6, 3, 1, 1);
+    std::mt19937 gen(8);
+    std::normal_distribution<float> dist;
+    size_t imSize = base.get_number_of_elements();
+    for (size_t n = 0; n < 3; n++)
+        for (size_t i = 0; i < imSize; i++) data[i + n * imSize] = base[i] + 0.1f * T(dist(gen), dist(gen));
+
+    auto eigen_value = [](const hoNDKLT<T>& klt) {
+        hoNDArray<T> E;
+        klt.eigen_value(E);
+        return E;
+    };
+
+    auto expect_same = [](const hoNDArray<T>& a, const hoNDArray<T>& b) {
+        ASSERT_EQ(a.get_number_of_elements(), b.get_number_of_elements());
+        for (size_t i = 0; i < a.get_number_of_elements(); i++) EXPECT_EQ(a[i], b[i]) << i;
+    };
+
+    std::vector<std::vector<std::vector<hoNDKLT<T>>>> KLT, KLT_fresh;
+
+    // without a tolerance, every N gets its own transform
+    Gadgetron::compute_eigen_channel_coefficients(data, false, false, false, 3, 1, 0.001, 0, KLT_fresh);
+    EXPECT_NE(std::real(eigen_value(KLT_fresh[0][0][1])[0]), std::real(eigen_value(KLT_fresh[0][0][0])[0]));
+
+    // with a tolerance, N=1 and N=2 take the transform of N=0
+    Gadgetron::compute_eigen_channel_coefficients(data, false, false, false, 3, 1, 0.001, 0, KLT, -1, 0.05);
+    ASSERT_EQ(KLT[0][0].size(), 3);
+    expect_same(eigen_value(KLT[0][0][0]), eigen_value(KLT_fresh[0][0][0]));
+    expect_same(eigen_value(KLT[0][0][1]), eigen_value(KLT[0][0][0]));
+    expect_same(eigen_value(KLT[0][0][2]), eigen_value(KLT[0][0][0]));
+    EXPECT_EQ(KLT[0][0][2].output_length(), KLT[0][0][0].output_length());
+
+    // the transforms of the previous call are kept for data they still describe
+    hoNDArray<T> next(data);
+    for (auto& v : next) v += 0.05f * T(dist(gen), dist(gen));
+    auto previous = eigen_value(KLT[0][0][0]);
+    Gadgetron::compute_eigen_channel_coefficients(next, false, false, false, 3, 1, 0.001, 0, KLT, -1, 0.05);
+    expect_same(eigen_value(KLT[0][0][0]), previous);
+
+    // and computed again for data they do not describe
+    auto rotated = rotate_channels(data);
+    Gadgetron::compute_eigen_channel_coefficients(rotated, false, false, false, 3, 1, 0.001, 0, KLT, -1, 0.05);
+
+    hoNDArray<T> first(24, 24, 2, 6, const_cast<T*>(rotated.begin()));
+    hoNDKLT<T> expected;
+    expected.prepare(first, 3, (float)0.001);
+
+    hoNDArray<T> V, V_expected;
+    KLT[0][0][0].eigen_vector(V);
+    expected.eigen_vector(V_expected);
+    EXPECT_LT(subspace_distance(V, V_expected, expected.output_length()), 1e-4f);
+}
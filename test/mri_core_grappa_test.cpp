@@ -0,0 +1,218 @@
+#include "mri_core_grappa.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+#include "hoNDFFT.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <complex>
+#include <numeric>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    typedef std::complex<float> T;
+
+    hoNDArray<T> random_array(const std::vector<size_t>& dims, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::normal_distribution<float> dist;
+
+        hoNDArray<T> a(dims);
+        for (auto& v : a) v = T(dist(gen), dist(gen));
+        return a;
+    }
+
+    // The unwrapping of GenericReconCartesianGrappaGadget before the fused pass: the aliased images of all
+    // channels, the scaling, then the unmixing of every image
+    hoNDArray<T> reference(const hoNDArray<T>& kspace, const hoNDArray<T>& unmixCoeff, float scaleFactor) {
+        size_t RO = kspace.get_size(0), E1 = kspace.get_size(1), E2 = kspace.get_size(2);
+        size_t N = kspace.get_size(4), S = kspace.get_size(5), SLC = kspace.get_size(6);
+        size_t uCHA = unmixCoeff.get_size(3), uN = unmixCoeff.get_size(4), uS = unmixCoeff.get_size(5);
+
+        hoNDArray<T> aliased, buf;
+        if (E2 > 1)
+            hoNDFFT<float>::instance()->ifft3c(kspace, aliased, buf);
+        else
+            hoNDFFT<float>::instance()->ifft2c(kspace, aliased, buf);
+        Gadgetron::scal(scaleFactor, aliased);
+
+        hoNDArray<T> result(RO, E1, E2, 1, N, S, SLC);
+        for (size_t slc = 0; slc < SLC; slc++) {
+            for (size_t s = 0; s < S; s++) {
+                for (size_t n = 0; n < N; n++) {
+                    hoNDArray<T> im(RO, E1, E2, uCHA, 1, &aliased(0, 0, 0, 0, n, s, slc));
+                    hoNDArray<T> unmix(RO, E1, E2, uCHA, const_cast<T*>(&unmixCoeff(0, 0, 0, 0, std::min(n, uN - 1), std::min(s, uS - 1), slc)));
+                    hoNDArray<T> res(RO, E1, E2, 1, &result(0, 0, 0, 0, n, s, slc));
+                    Gadgetron::apply_unmix_coeff_aliased_image_3D(im, unmix, res);
+                }
+            }
+        }
+        return result;
+    }
+
+    void expect_near(const hoNDArray<T>& expected, const hoNDArray<T>& result) {
+        ASSERT_EQ(expected.get_number_of_elements(), result.get_number_of_elements());
+        float scale = Gadgetron::nrm2(expected) / std::sqrt((float)expected.get_number_of_elements());
+        for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+            ASSERT_LT(std::abs(expected[i] - result[i]), 1e-4f * scale) << i;
+    }
+}
+
+TEST(GrappaUnwrap, fused_2D) {
+    // 10 channels, of which 8 are unmixed; the coefficients of N=1 and S=0 are used for N=2, S=1
+    auto kspace = random_array({ 32, 24, 1, 10, 3, 2, 2 }, 1);
+    auto unmixCoeff = random_array({ 32, 24, 1, 8, 2, 1, 2 }, 2);
+
+    auto expected = reference(kspace, unmixCoeff, 0.25f);
+
+    for (size_t tileCHA : { 1, 3, 8, 0 }) {
+        hoNDArray<T> result;
+        Gadgetron::apply_unmix_coeff_kspace_fused(kspace, unmixCoeff, 0.25f, result, tileCHA);
+
+        EXPECT_EQ(result.get_size(3), 1);
+        EXPECT_EQ(result.get_size(4), 3);
+        EXPECT_EQ(result.get_size(6), 2);
+        expect_near(expected, result);
+    }
+}
+
+TEST(GrappaUnwrap, fused_3D) {
+    auto kspace = random_array({ 16, 12, 8, 4, 2, 1, 1 }, 3);
+    auto unmixCoeff = random_array({ 16, 12, 8, 4, 1, 1, 1 }, 4);
+
+    auto expected = reference(kspace, unmixCoeff, 1.0f);
+
+    hoNDArray<T> result;
+    Gadgetron::apply_unmix_coeff_kspace_fused(kspace, unmixCoeff, 1.0f, result, 3);
+    expect_near(expected, result);
+}
+
+TEST(GrappaUnwrap, fused_single_image) {
+    // one 2D image, large enough for the accumulation to be shared out over the pixels
+    auto kspace = random_array({ 288, 256, 1, 6, 1, 1, 1 }, 5);
+    auto unmixCoeff = random_array({ 288, 256, 1, 5, 1, 1, 1 }, 6);
+
+    auto expected = reference(kspace, unmixCoeff, 0.5f);
+
+    hoNDArray<T> result;
+    Gadgetron::apply_unmix_coeff_kspace_fused(kspace, unmixCoeff, 0.5f, result, 2);
+    expect_near(expected, result);
+}
+
+namespace {
+
+    // The kernel of the batch calibration, grappa2d_prepare_calib and grappa2d_perform_calib, on the lines [startE1 endE1]
+    hoNDArray<T> batch_kernel(const hoNDArray<T>& acs, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startE1, size_t endE1) {
+        hoNDArray<T> ker;
+        Gadgetron::grappa2d_calib(acs, acs, 5e-4, 5, kE1, oE1, 0, acs.get_size(0) - 1, startE1, endE1, ker);
+        return ker;
+    }
+
+    void copy_lines(const hoNDArray<T>& from, hoNDArray<T>& to, const std::vector<size_t>& lines) {
+        for (auto line : lines)
+            for (size_t cha = 0; cha < from.get_size(2); cha++)
+                for (size_t ro = 0; ro < from.get_size(0); ro++) to(ro, line, cha) = from(ro, line, cha);
+    }
+}
+
+TEST(GrappaCalibAccumulator, lines_in_any_order) {
+    std::vector<int> kE1, oE1;
+    size_t convKRO, convKE1;
+    Gadgetron::grappa2d_kerPattern(kE1, oE1, convKRO, convKE1, 2, 5, 4, false);
+
+    auto acs = random_array({ 24, 32, 4 }, 5);
+
+    grappa2d_calib_accumulator<T> accumulator;
+    accumulator.initialize(24, 32, 4, 4, 0, 23);
+    accumulator.set_kernel_pattern(5, kE1, oE1);
+
+    std::vector<size_t> lines(32);
+    std::iota(lines.begin(), lines.end(), 0);
+    std::shuffle(lines.begin(), lines.end(), std::mt19937(6));
+    for (size_t l = 0; l < lines.size(); l += 3)
+        accumulator.update(acs, acs, std::vector<size_t>(lines.begin() + l, lines.begin() + std::min(l + 3, lines.size())));
+
+    hoNDArray<T> A, B;
+    Gadgetron::grappa2d_prepare_calib(acs, acs, 5, kE1, oE1, 0, 23, 0, 31, A, B);
+    EXPECT_EQ(accumulator.number_of_equations(), A.get_size(0));
+
+    hoNDArray<T> ker;
+    accumulator.solve(5e-4, ker);
+    expect_near(batch_kernel(acs, kE1, oE1, 0, 31), ker);
+}
+
+TEST(GrappaCalibAccumulator, replaced_lines) {
+    std::vector<int> kE1, oE1;
+    size_t convKRO, convKE1;
+    Gadgetron::grappa2d_kerPattern(kE1, oE1, convKRO, convKE1, 2, 5, 4, false);
+
+    // Only the lines [8 23] are sampled
+    auto acs = random_array({ 24, 32, 4 }, 7);
+    std::vector<size_t> lines(16);
+    std::iota(lines.begin(), lines.end(), 8);
+
+    grappa2d_calib_accumulator<T> accumulator;
+    accumulator.initialize(24, 32, 4, 4, 0, 23);
+    accumulator.update(acs, acs, lines);
+    accumulator.set_kernel_pattern(5, kE1, oE1);
+
+    hoNDArray<T> ker;
+    accumulator.solve(5e-4, ker);
+    expect_near(batch_kernel(acs, kE1, oE1, 8, 23), ker);
+
+    // A single line replaces a few row blocks, a time interleaved frame replaces all of them
+    for (unsigned int frame = 0; frame < 4; frame++) {
+        auto update = random_array({ 24, 32, 4 }, 8 + frame);
+
+        std::vector<size_t> replaced = { 12 + frame };
+        if (frame % 2) {
+            replaced.clear();
+            for (size_t line = 8 + frame / 2; line < 24; line += 2) replaced.push_back(line);
+        }
+
+        copy_lines(update, acs, replaced);
+        accumulator.update(acs, acs, replaced);
+
+        accumulator.solve(5e-4, ker);
+        expect_near(batch_kernel(acs, kE1, oE1, 8, 23), ker);
+    }
+
+    // A new pattern is calibrated from the stored lines
+    Gadgetron::grappa2d_kerPattern(kE1, oE1, convKRO, convKE1, 3, 5, 4, false);
+    accumulator.set_kernel_pattern(5, kE1, oE1);
+    accumulator.solve(5e-4, ker);
+    expect_near(batch_kernel(acs, kE1, oE1, 8, 23), ker);
+}
+
+TEST(GrappaCalibAccumulator, snapshot_keeps_the_equations_it_was_taken_with) {
+    std::vector<int> kE1, oE1;
+    size_t convKRO, convKE1;
+    Gadgetron::grappa2d_kerPattern(kE1, oE1, convKRO, convKE1, 2, 5, 4, false);
+
+    auto acs = random_array({ 24, 32, 4 }, 9);
+    std::vector<size_t> lines(16);
+    std::iota(lines.begin(), lines.end(), 8);
+
+    grappa2d_calib_accumulator<T> accumulator;
+    accumulator.initialize(24, 32, 4, 4, 0, 23);
+    accumulator.set_kernel_pattern(5, kE1, oE1);
+    accumulator.update(acs, acs, lines);
+
+    grappa2d_calib_equations<T> equations;
+    accumulator.snapshot(equations);
+    auto expected = batch_kernel(acs, kE1, oE1, 8, 23);
+
+    // Lines added after the snapshot do not change it
+    auto update = random_array({ 24, 32, 4 }, 10);
+    std::vector<size_t> more = { 4, 5, 6, 7, 12 };
+    copy_lines(update, acs, more);
+    accumulator.update(acs, acs, more);
+
+    hoNDArray<T> ker;
+    equations.solve(5e-4, ker);
+    expect_near(expected, ker);
+    EXPECT_EQ(equations.kE1, kE1);
+    EXPECT_EQ(equations.oE1, oE1);
+}
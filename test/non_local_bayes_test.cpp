@@ -0,0 +1,157 @@
+#include "non_local_bayes.h"
+#include "hoArmadillo.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <complex>
+#include <numeric>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    // the non-local Bayes filter as implemented before the patch search read the distances from a padded image:
+    // every patch of the search window is extracted, and the patches are sorted by their distance to the reference
+    template <class T> struct Patch {
+        arma::Col<T> patch;
+        int x, y;
+    };
+
+    template <class T> arma::Col<T> reference_patch(const hoNDArray<T>& image, int x, int y, int patch_size) {
+        const int nx = image.get_size(0);
+        const int ny = image.get_size(1);
+
+        arma::Col<T> window(patch_size * patch_size);
+        for (int ky = 0; ky < patch_size; ky++)
+            for (int kx = 0; kx < patch_size; kx++)
+                window[kx + ky * patch_size] = image((kx - patch_size / 2 + x + nx) % nx, (ky - patch_size / 2 + y + ny) % ny);
+        return window;
+    }
+
+    template <class T> void reference_denoise(std::vector<Patch<T>>& patches, float noise_std) {
+        arma::Col<T> mean_patch(patches.front().patch.size(), arma::fill::zeros);
+        for (auto& patch : patches) mean_patch += patch.patch;
+        mean_patch /= patches.size();
+
+        float std2 = 0;
+        for (auto& patch : patches) {
+            float std = arma::stddev(patch.patch);
+            std2 += std * std;
+        }
+        std2 *= patches.size() / float(patches.size() - 1);
+
+        if (std2 < noise_std * noise_std * 1.1) {
+            auto mean_value = arma::mean(mean_patch);
+            for (auto& patch : patches) patch.patch.fill(mean_value);
+            return;
+        }
+
+        arma::Mat<T> covariance(mean_patch.size(), mean_patch.size(), arma::fill::zeros);
+        for (auto& patch : patches) covariance += (patch.patch - mean_patch) * (patch.patch - mean_patch).t();
+        covariance /= patches.size() - 1;
+
+        arma::Mat<T> noise_covariance = covariance + noise_std * noise_std * arma::eye<arma::Mat<T>>(arma::size(covariance));
+        arma::Mat<T> inv_cov(arma::size(covariance));
+        if (arma::inv(inv_cov, noise_covariance))
+            for (auto& patch : patches) patch.patch = mean_patch + inv_cov * covariance * (patch.patch - mean_patch);
+    }
+
+    template <class T> hoNDArray<T> reference_non_local_bayes(const hoNDArray<T>& image, float noise_std, int search_window) {
+        const int patch_size = 5;
+        const int n_patches  = 50;
+        const int nx         = image.get_size(0);
+        const int ny         = image.get_size(1);
+
+        hoNDArray<T> result(image.dimensions());
+        result.fill(0);
+        hoNDArray<int> count(image.dimensions());
+        count.fill(0);
+        hoNDArray<bool> mask(image.dimensions());
+        mask.fill(true);
+
+        for (int ky = 0; ky < ny; ky++) {
+            for (int kx = 0; kx < nx; kx++) {
+                if (!mask(kx, ky)) continue;
+
+                auto reference = reference_patch(image, kx, ky, patch_size);
+
+                std::vector<Patch<T>> patches;
+                std::vector<float> distances;
+                for (int dy = std::max(ky - search_window / 2, 0); dy < std::min(search_window / 2 + ky, ny); dy++) {
+                    for (int dx = std::max(kx - search_window / 2, 0); dx < std::min(search_window / 2 + kx, nx); dx++) {
+                        patches.push_back(Patch<T>{ reference_patch(image, dx, dy, patch_size), dx, dy });
+
+                        float distance = 0;
+                        for (int i = 0; i < patch_size * patch_size; i++) distance += std::norm(reference[i] - patches.back().patch[i]);
+                        distances.push_back(distance);
+                    }
+                }
+
+                // equal distances keep the order of the search window
+                std::vector<size_t> order(patches.size());
+                std::iota(order.begin(), order.end(), 0);
+                std::stable_sort(order.begin(), order.end(), [&](auto i, auto j) { return distances[i] < distances[j]; });
+
+                std::vector<Patch<T>> best;
+                for (size_t i = 0; i < std::min<size_t>(patches.size(), n_patches); i++) best.push_back(patches[order[i]]);
+
+                reference_denoise(best, noise_std);
+
+                for (auto& patch : best) {
+                    for (int py = 0; py < patch_size; py++) {
+                        int y = (patch.y + py - patch_size / 2 + ny) % ny;
+                        for (int px = 0; px < patch_size; px++) {
+                            int x = (patch.x + px - patch_size / 2 + nx) % nx;
+                            result(x, y) += patch.patch[px + py * patch_size];
+                            count(x, y)++;
+                        }
+                    }
+                    mask(patch.x, patch.y) = false;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < result.get_number_of_elements(); i++) result[i] /= count[i];
+        return result;
+    }
+
+    // a smooth image with an edge, plus noise
+    float phantom(int x, int y, std::mt19937& gen) {
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        return 10.0f * std::sin(0.2f * x) + (y > 12 ? 20.0f : 0.0f) + noise(gen);
+    }
+}
+
+TEST(non_local_bayes, real_matches_previous_implementation) {
+    std::mt19937 gen(1);
+    hoNDArray<float> image(29, 24, 2);
+    for (size_t n = 0; n < 2; n++)
+        for (int y = 0; y < 24; y++)
+            for (int x = 0; x < 29; x++)
+                image(x, y, n) = phantom(x + 5 * n, y, gen);
+
+    auto result = Denoise::non_local_bayes(image, 1.0f, 12);
+    ASSERT_EQ(result.dimensions(), image.dimensions());
+
+    for (size_t n = 0; n < 2; n++) {
+        hoNDArray<float> slice(29, 24, image.get_data_ptr() + n * 29 * 24);
+        auto expected = reference_non_local_bayes(slice, 1.0f, 12);
+        for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+            ASSERT_NEAR(result[i + n * 29 * 24], expected[i], 1e-4f * (1.0f + std::abs(expected[i]))) << n << " " << i;
+    }
+}
+
+TEST(non_local_bayes, complex_matches_previous_implementation) {
+    std::mt19937 gen(2);
+    hoNDArray<std::complex<float>> image(26, 21);
+    for (int y = 0; y < 21; y++)
+        for (int x = 0; x < 26; x++)
+            image(x, y) = std::complex<float>(phantom(x, y, gen), phantom(y, x, gen));
+
+    auto result   = Denoise::non_local_bayes(image, 2.0f, 10);
+    auto expected = reference_non_local_bayes(image, 2.0f, 10);
+
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+        ASSERT_NEAR(std::abs(result[i] - expected[i]), 0.0f, 1e-4f * (1.0f + std::abs(expected[i]))) << i;
+}
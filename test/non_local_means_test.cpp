@@ -0,0 +1,80 @@
+#include "non_local_means.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    // direct evaluation of every patch distance, with periodic boundaries
+    template <class T> hoNDArray<T> reference_non_local_means(const hoNDArray<T>& image, float noise_std, int search_radius) {
+        const int D = 5;
+        const int nx = image.get_size(0);
+        const int ny = image.get_size(1);
+        auto wrap = [](int i, int n) { return ((i % n) + n) % n; };
+
+        hoNDArray<T> result(image.dimensions());
+        for (int y = 0; y < ny; y++) {
+            for (int x = 0; x < nx; x++) {
+                float sum_weight = 0;
+                T sum_value      = 0;
+                for (int dy = -search_radius; dy < search_radius; dy++) {
+                    for (int dx = -search_radius; dx < search_radius; dx++) {
+                        float dist = 0;
+                        for (int ky = -D / 2; ky <= D / 2; ky++)
+                            for (int kx = -D / 2; kx <= D / 2; kx++)
+                                dist += std::norm(image(wrap(x + kx, nx), wrap(y + ky, ny))
+                                                  - image(wrap(x + dx + kx, nx), wrap(y + dy + ky, ny)));
+
+                        float weight = std::exp(-dist / (noise_std * noise_std * D * D));
+                        sum_weight += weight;
+                        sum_value += weight * image(wrap(x + dx, nx), wrap(y + dy, ny));
+                    }
+                }
+                result(x, y) = sum_value / sum_weight;
+            }
+        }
+        return result;
+    }
+
+    // a smooth image with an edge, plus noise
+    float phantom(int x, int y, std::mt19937& gen) {
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        return 10.0f * std::sin(0.1f * x) + (y > 20 ? 20.0f : 0.0f) + noise(gen);
+    }
+}
+
+TEST(non_local_means, real) {
+    std::mt19937 gen(1);
+    hoNDArray<float> image(45, 38, 2);
+    for (size_t n = 0; n < 2; n++)
+        for (int y = 0; y < 38; y++)
+            for (int x = 0; x < 45; x++)
+                image(x, y, n) = phantom(x + 7 * n, y, gen);
+
+    auto result = Denoise::non_local_means(image, 1.0f, 5);
+    ASSERT_EQ(result.dimensions(), image.dimensions());
+
+    for (size_t n = 0; n < 2; n++) {
+        hoNDArray<float> slice(45, 38, image.get_data_ptr() + n * 45 * 38);
+        auto expected = reference_non_local_means(slice, 1.0f, 5);
+        for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+            ASSERT_NEAR(result[i + n * 45 * 38], expected[i], 1e-3f * (1.0f + std::abs(expected[i])));
+    }
+}
+
+TEST(non_local_means, complex) {
+    std::mt19937 gen(2);
+    hoNDArray<std::complex<float>> image(40, 33);
+    for (int y = 0; y < 33; y++)
+        for (int x = 0; x < 40; x++)
+            image(x, y) = std::complex<float>(phantom(x, y, gen), phantom(y, x, gen));
+
+    auto result   = Denoise::non_local_means(image, 2.0f, 4);
+    auto expected = reference_non_local_means(image, 2.0f, 4);
+
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+        ASSERT_NEAR(std::abs(result[i] - expected[i]), 0.0f, 1e-3f * (1.0f + std::abs(expected[i])));
+}
@@ -185,3 +185,102 @@ TYPED_TEST(pattern_recognition_test, kmeans_test)
 
     EXPECT_LE( std::sqrt(sumD) / N, 2.0);
 }
+
+// K blobs in P dimensions, the blobs partly overlap
+template <typename T> static void make_blobs(hoNDArray<T>& X, size_t P, size_t N, size_t K, unsigned int seed)
+{
+    std::mt19937 gen(seed);
+    std::normal_distribution<T> distribution(0, 1);
+
+    X.create(P, N);
+    for (size_t n = 0; n < N; n++)
+    {
+        size_t k = n % K;
+        for (size_t p = 0; p < P; p++) X(p, n) = distribution(gen) + (T)(3 * ((k + p) % K));
+    }
+}
+
+TYPED_TEST(pattern_recognition_test, kmeans_triangle_inequality)
+{
+    size_t P = 3, N = 6000, K = 7;
+
+    hoNDArray<float> X;
+    make_blobs(X, P, N, K, 1);
+
+    Gadgetron::kmeans<float> km;
+    km.seed_ = 2;
+    km.replicates_ = 1;
+    km.perform_online_update_ = false;
+
+    hoNDArray<float> C_for_initial;
+    km.get_initial_guess_sample(X, K, C_for_initial);
+
+    std::vector<size_t> IDX_full, IDX_bounds;
+    hoNDArray<float> C_full, C_bounds;
+    float sumD_full, sumD_bounds;
+
+    km.use_triangle_inequality_ = false;
+    km.run(X, K, C_for_initial, IDX_full, C_full, sumD_full);
+
+    km.use_triangle_inequality_ = true;
+    km.run(X, K, C_for_initial, IDX_bounds, C_bounds, sumD_bounds);
+
+    EXPECT_EQ(IDX_full, IDX_bounds);
+    EXPECT_NEAR(sumD_full, sumD_bounds, 1e-4*sumD_full);
+}
+
+TYPED_TEST(pattern_recognition_test, kmeans_fixed_seed)
+{
+    size_t P = 4, N = 5000, K = 5;
+
+    hoNDArray<float> X;
+    make_blobs(X, P, N, K, 3);
+
+    std::vector<size_t> IDX[2];
+    hoNDArray<float> C[2];
+    float sumD[2];
+
+    for (size_t r = 0; r < 2; r++)
+    {
+        Gadgetron::kmeans<float> km;
+        km.seed_ = 7;
+        km.replicates_ = 3;
+
+        hoNDArray<float> C_for_initial;
+        km.get_initial_guess_kmeansplusplus(X, K, C_for_initial);
+
+        std::vector<float> sumD_rep;
+        km.run_replicates(X, K, C_for_initial, IDX[r], C[r], sumD_rep, sumD[r]);
+    }
+
+    EXPECT_EQ(IDX[0], IDX[1]);
+    EXPECT_EQ(sumD[0], sumD[1]);
+    for (size_t i = 0; i < C[0].get_number_of_elements(); i++) EXPECT_EQ(C[0][i], C[1][i]);
+}
+
+TYPED_TEST(pattern_recognition_test, kmeans_mini_batch)
+{
+    size_t P = 2, N = 40000, K = 4;
+
+    hoNDArray<float> X;
+    make_blobs(X, P, N, K, 4);
+
+    Gadgetron::kmeans<float> km;
+    km.seed_ = 5;
+    km.replicates_ = 1;
+    km.perform_online_update_ = false;
+
+    hoNDArray<float> C_for_initial;
+    km.get_initial_guess_kmeansplusplus(X, K, C_for_initial);
+
+    std::vector<size_t> IDX;
+    hoNDArray<float> C;
+    float sumD_full, sumD_batch;
+    km.run(X, K, C_for_initial, IDX, C, sumD_full);
+
+    km.mini_batch_size_ = 1000;
+    km.run(X, K, C_for_initial, IDX, C, sumD_batch);
+
+    ASSERT_EQ(IDX.size(), N);
+    EXPECT_LE(sumD_batch, 1.05f*sumD_full);
+}
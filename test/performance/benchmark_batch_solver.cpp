@@ -0,0 +1,164 @@
+//
+// Compares per-frame and batched lockstep LSQR solves of a 2D+T SPIRIT unwrapping
+//
+#include "hoLsqrBatchSolver.h"
+#include "hoLsqrSolver.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_math.h"
+#include "hoNDFFT.h"
+#include "hoSPIRIT2DOperator.h"
+#include "hoSPIRIT2DTOperator.h"
+#include "log.h"
+#include "mri_core_spirit.h"
+
+#include <chrono>
+#include <cmath>
+
+#define RO 192
+#define E1 144
+#define CHA 8
+#define N 24
+#define ACCEL 4
+#define ITERATIONS 70
+
+using namespace Gadgetron;
+
+typedef std::complex<float> T;
+
+// smooth object seen by CHA gaussian coils, one slightly moving object per frame, undersampled with a shifted pattern
+static void make_data(hoNDArray<T>& full, hoNDArray<T>& kspace)
+{
+    full.create(RO, E1, CHA, N);
+    for (size_t n = 0; n < N; n++)
+    {
+        float cx = RO / 2 + 8.0f*std::sin(2 * M_PI*n / N);
+        for (size_t cha = 0; cha < CHA; cha++)
+        {
+            float px = RO / 2 + 0.4f*RO*std::cos(2 * M_PI*cha / CHA);
+            float py = E1 / 2 + 0.4f*E1*std::sin(2 * M_PI*cha / CHA);
+            for (size_t e1 = 0; e1 < E1; e1++)
+            {
+                for (size_t ro = 0; ro < RO; ro++)
+                {
+                    float ox = (ro - cx) / (0.35f*RO), oy = (e1 - E1 / 2.0f) / (0.4f*E1);
+                    float obj = (ox*ox + oy*oy < 1) ? 1.0f + 0.3f*std::cos(0.1f*ro) : 0.0f;
+                    float sen = std::exp(-((ro - px)*(ro - px) + (e1 - py)*(e1 - py)) / (0.5f*RO*E1));
+                    full(ro, e1, cha, n) = std::polar(obj*sen, float(0.3f*cha + 0.01f*ro));
+                }
+            }
+        }
+    }
+    hoNDFFT<float>::instance()->fft2c(full);
+
+    kspace = full;
+    for (size_t n = 0; n < N; n++)
+        for (size_t e1 = 0; e1 < E1; e1++)
+            if ((e1 + n) % ACCEL != 0)
+                for (size_t cha = 0; cha < CHA; cha++)
+                    for (size_t ro = 0; ro < RO; ro++)
+                        kspace(ro, e1, cha, n) = T(0);
+}
+
+int main()
+{
+    hoNDArray<T> full, kspace;
+    make_data(full, kspace);
+
+    // calibrate on the central lines of the first frame
+    size_t acsE1 = 32;
+    hoNDArray<T> acs(RO, acsE1, CHA);
+    for (size_t cha = 0; cha < CHA; cha++)
+        for (size_t e1 = 0; e1 < acsE1; e1++)
+            for (size_t ro = 0; ro < RO; ro++)
+                acs(ro, e1, cha) = full(ro, e1 + (E1 - acsE1) / 2, cha, 0);
+
+    size_t kRO = 5, kE1 = 5;
+    hoNDArray<T> convKer(2 * kRO - 1, 2 * kE1 - 1, CHA, CHA);
+    spirit2d_calib_convolution_kernel(acs, acs, 0.005, kRO, kE1, 1, 1, convKer, true);
+
+    hoNDArray<T> kIm(RO, E1, CHA, CHA), ker(RO, E1, CHA, CHA);
+    spirit2d_image_domain_kernel(convKer, RO, E1, kIm);
+    hoNDFFT<float>::instance()->ifftshift2D(kIm, ker);
+
+    hoNDArray<T> kspace_shifted(kspace);
+    hoNDFFT<float>::instance()->ifftshift2D(kspace, kspace_shifted);
+
+    // ------------------------------------------------
+    // one solve per frame, in parallel over frames
+    // ------------------------------------------------
+    hoNDArray<T> res_frame(RO, E1, CHA, N);
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        std::vector<size_t> dim{ RO, E1, CHA };
+        long long n;
+
+#pragma omp parallel private(n) shared(dim, ker, kspace_shifted, res_frame)
+        {
+            boost::shared_ptr< hoSPIRIT2DOperator<T> > oper(new hoSPIRIT2DOperator<T>(&dim));
+            oper->use_non_centered_fft_ = true;
+            oper->no_null_space_ = false;
+            oper->set_forward_kernel(ker, false);
+
+            hoLsqrSolver<T> solver;
+            solver.set_tc_tolerance(1e-4f);
+            solver.set_max_iterations(ITERATIONS);
+            solver.set_encoding_operator(oper);
+
+            hoNDArray<T> b(RO, E1, CHA), x(RO, E1, CHA);
+
+#pragma omp for
+            for (n = 0; n < (long long)N; n++)
+            {
+                boost::shared_ptr< hoNDArray<T> > acq(new hoNDArray<T>(RO, E1, CHA, &kspace_shifted(0, 0, 0, n)));
+                oper->set_acquired_points(*acq);
+                solver.set_x0(acq);
+                oper->compute_righ_hand_side(*acq, b);
+                solver.solve(&x, &b);
+                oper->restore_acquired_kspace(*acq, x);
+                memcpy(&res_frame(0, 0, 0, n), x.begin(), x.get_number_of_bytes());
+            }
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    GINFO_STREAM("Per frame solves took " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl);
+
+    // ------------------------------------------------
+    // all frames in lockstep
+    // ------------------------------------------------
+    hoNDArray<T> res_batch(RO, E1, CHA, N);
+    start = std::chrono::high_resolution_clock::now();
+    {
+        std::vector<size_t> dim{ RO, E1, CHA, N };
+        boost::shared_ptr< hoSPIRIT2DTOperator<T> > oper(new hoSPIRIT2DTOperator<T>(&dim));
+        oper->use_non_centered_fft_ = true;
+        oper->no_null_space_ = false;
+
+        hoNDArray<T> ker2DT(RO, E1, CHA, CHA, 1, ker.begin());
+        oper->set_forward_kernel(ker2DT, false);
+
+        hoLsqrBatchSolver<T> solver;
+        solver.set_tc_tolerance(1e-4f);
+        solver.set_max_iterations(ITERATIONS);
+        solver.set_encoding_operator(oper);
+
+        boost::shared_ptr< hoNDArray<T> > acq(new hoNDArray<T>(kspace_shifted));
+        oper->set_acquired_points(*acq);
+        solver.set_x0(acq);
+
+        hoNDArray<T> b(RO, E1, CHA, N);
+        oper->compute_righ_hand_side(*acq, b);
+        solver.solve(&res_batch, &b);
+        oper->restore_acquired_kspace(*acq, res_batch);
+
+        const std::vector<unsigned int>& iters = solver.get_iterations();
+        GINFO_STREAM("Batched iterations, min " << *std::min_element(iters.begin(), iters.end()) << ", max " << *std::max_element(iters.begin(), iters.end()) << std::endl);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    GINFO_STREAM("Batched solve took " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl);
+
+    hoNDArray<T> diff(res_batch);
+    diff -= res_frame;
+    GINFO_STREAM("Relative difference " << nrm2(&diff) / nrm2(&res_frame) << std::endl);
+
+    return 0;
+}
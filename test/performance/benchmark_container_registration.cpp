@@ -0,0 +1,91 @@
+//
+// Thread scaling of hoImageRegContainer2DRegistration over the frames of a series
+//
+#include "hoImageRegContainer2DRegistration.h"
+#include "log.h"
+
+#include <chrono>
+#include <cmath>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif // USE_OMP
+
+using namespace Gadgetron;
+
+typedef hoNDImage<float, 2> ImageType;
+typedef hoImageRegContainer2DRegistration<ImageType, ImageType, double> RegContainerType;
+
+// a blob moving over the frames, as in a free breathing series
+void make_frames(hoNDImageContainer2D<ImageType>& container, size_t RO, size_t E1, size_t N)
+{
+    std::vector<size_t> cols(1, N);
+    std::vector<size_t> dim{ RO, E1 };
+    container.create(cols, dim);
+
+    for (size_t n = 0; n < N; n++)
+    {
+        ImageType& im = container(0, n);
+        float cx = RO / 2.0f + 6.0f * std::sin(2 * M_PI * n / N);
+        float cy = E1 / 2.0f + 4.0f * std::cos(2 * M_PI * n / N);
+        for (size_t y = 0; y < E1; y++)
+            for (size_t x = 0; x < RO; x++)
+            {
+                float r2 = ((x - cx) * (x - cx) + (y - cy) * (y - cy)) / (0.04f * RO * E1);
+                im(x, y) = 100.0f * std::exp(-r2) + 10.0f + 0.05f * x;
+            }
+    }
+}
+
+double time_registration(hoNDImageContainer2D<ImageType>& frames, GT_IMAGE_REG_CONTAINER_MODE mode)
+{
+    RegContainerType reg;
+    reg.setDefaultParameters(3, false);
+    reg.container_reg_mode_ = mode;
+    reg.container_reg_transformation_ = GT_IMAGE_REG_TRANSFORMATION_DEFORMATION_FIELD_BIDIRECTIONAL;
+    reg.max_iter_num_pyramid_level_ = std::vector<unsigned int>{ 32, 64, 100 };
+    reg.dissimilarity_type_ = GT_IMAGE_DISSIMILARITY_LocalCCR;
+
+    std::vector<unsigned int> ref(1, (unsigned int)(frames.cols()[0] / 2));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (mode == GT_IMAGE_REG_CONTAINER_FIXED_REFERENCE)
+        reg.registerOverContainer2DFixedReference(frames, ref, true, false);
+    else
+        reg.registerOverContainer2DProgressive(frames, ref);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+int main()
+{
+    hoNDImageContainer2D<ImageType> frames;
+    make_frames(frames, 192, 144, 32);
+
+    int max_threads = 1;
+#ifdef USE_OMP
+    max_threads = omp_get_num_procs();
+#endif // USE_OMP
+
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    for (auto mode : { GT_IMAGE_REG_CONTAINER_FIXED_REFERENCE, GT_IMAGE_REG_CONTAINER_PROGRESSIVE })
+    {
+        double serial = 0;
+        for (int threads : thread_counts)
+        {
+#ifdef USE_OMP
+            omp_set_num_threads(threads);
+#endif // USE_OMP
+            double ms = time_registration(frames, mode);
+            if (threads == 1) serial = ms;
+
+            GINFO_STREAM(getImageRegContainerModeName(mode) << " " << threads << " threads : " << ms << " ms, speedup " << serial / ms << std::endl);
+        }
+    }
+
+    return 0;
+}
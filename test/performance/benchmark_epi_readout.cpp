@@ -0,0 +1,132 @@
+//
+// Times the EPI readout processing at the line rate of a multiband acquisition: the line by line chain of
+// EPIReconXGadget, EPICorrGadget and FFTXGadget against EPIReadoutBatch, on the toolbox objects the gadgets use
+//
+#include "EPIReadoutBatch.h"
+#include "hoNDFFT.h"
+#include "log.h"
+
+#include <chrono>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using namespace Gadgetron::EPI;
+
+typedef std::complex<float> T;
+
+struct Line {
+    ISMRMRD::AcquisitionHeader hdr;
+    hoNDArray<T> data;
+};
+
+static void setup(EPIReconXObjectTrapezoid<T>& reconx, EPICorrectionObject<T>& corr)
+{
+    reconx.encodeNx_ = 96;
+    reconx.encodeFOV_ = 220;
+    reconx.reconNx_ = 96;
+    reconx.reconFOV_ = 220;
+    reconx.rampUpTime_ = 120;
+    reconx.rampDownTime_ = 120;
+    reconx.flatTopTime_ = 400;
+    reconx.numSamples_ = 192;
+    reconx.dwellTime_ = 3.2;
+    reconx.computeTrajectory();
+
+    corr.numNavigators_ = 3;
+    corr.referenceNavigatorNumber_ = 1;
+}
+
+static double lines_per_s(size_t lines, std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return lines / std::chrono::duration<double>(end - start).count();
+}
+
+int main()
+{
+    // 64 channels (e.g. 32 coils of a multiband 2 slice group), 3 navigators and 72 lines per shot
+    const size_t channels = 64, shots = 40, lines_per_shot = 72;
+
+    std::mt19937 gen(3);
+    std::normal_distribution<float> dist;
+
+    std::vector<Line> lines;
+    for (size_t shot = 0; shot < shots; shot++) {
+        for (size_t n = 0; n < 3 + lines_per_shot; n++) {
+            Line line;
+            line.hdr.read_dir[0] = 1;
+            line.hdr.active_channels = channels;
+            if (n < 3) line.hdr.setFlag(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA);
+            if (n % 2) line.hdr.setFlag(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE);
+            line.data.create(192, channels);
+            for (auto& v : line.data) v = T(dist(gen), dist(gen));
+            lines.push_back(std::move(line));
+        }
+    }
+    size_t imaging_lines = shots * lines_per_shot;
+
+    std::vector<hoNDArray<T>> expected;
+    {
+        EPIReconXObjectTrapezoid<T> reconx;
+        EPICorrectionObject<T> corr;
+        setup(reconx, corr);
+        hoNDArray<T> r, buf;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto& line : lines) {
+            ISMRMRD::AcquisitionHeader hdr_out;
+            hoNDArray<T> data_out(reconx.reconNx_, channels);
+            reconx.apply(line.hdr, line.data, hdr_out, data_out);
+
+            arma::cx_fmat adata = as_arma_matrix(data_out);
+            if (hdr_out.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA)) {
+                corr.process_phase_correction_data(hdr_out, adata);
+                continue;
+            }
+            corr.apply_epi_correction(hdr_out, adata);
+
+            hoNDFFT<float>::instance()->fft1c(data_out, r, buf);
+            memcpy(data_out.begin(), r.begin(), r.get_number_of_bytes());
+            expected.push_back(std::move(data_out));
+        }
+        GINFO_STREAM("line by line : " << lines_per_s(imaging_lines, start) << " lines/s" << std::endl);
+    }
+
+    for (size_t batch_lines : { 8, 32, 128 }) {
+        EPIReconXObjectTrapezoid<T> reconx;
+        EPICorrectionObject<T> corr;
+        setup(reconx, corr);
+        EPIReadoutBatch<T> batch(reconx, corr, batch_lines);
+
+        std::vector<hoNDArray<T>> result;
+        auto emit = [&](ISMRMRD::AcquisitionHeader&, hoNDArray<T>&& data) { result.push_back(std::move(data)); };
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto& line : lines) {
+            if (line.hdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA)) {
+                if (corr.corrComputed()) batch.process(0, emit);
+
+                ISMRMRD::AcquisitionHeader hdr_out;
+                hoNDArray<T> data_out(reconx.reconNx_, channels);
+                reconx.apply(line.hdr, line.data, hdr_out, data_out);
+                arma::cx_fmat adata = as_arma_matrix(data_out);
+                corr.process_phase_correction_data(hdr_out, adata);
+                continue;
+            }
+            batch.add(line.hdr, line.data);
+            if (batch.full() && corr.corrComputed()) batch.process(0, emit);
+        }
+        batch.process(0, emit);
+        double rate = lines_per_s(imaging_lines, start);
+
+        float max_difference = 0;
+        for (size_t l = 0; l < result.size(); l++)
+            for (size_t i = 0; i < result[l].size(); i++)
+                max_difference = std::max(max_difference, std::abs(result[l][i] - expected[l][i]));
+
+        GINFO_STREAM("batches of " << batch_lines << " lines : " << rate << " lines/s, max difference " << max_difference << std::endl);
+    }
+
+    return 0;
+}
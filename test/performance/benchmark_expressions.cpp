@@ -0,0 +1,94 @@
+//
+// Compares the elementwise operators, which evaluate every operation into its own array, with the fused expressions
+// of hoNDArray_expressions.h: a chain of products, the norm of a difference and a separable kspace filter
+//
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+#include "hoNDArray_expressions.h"
+#include "mri_core_kspace_filter.h"
+#include "log.h"
+
+#include <chrono>
+#include <random>
+
+#define RO 256
+#define E1 256
+#define E2 32
+#define CHA 8
+
+using namespace Gadgetron;
+
+typedef std::complex<float> T;
+
+static hoNDArray<T> random_array(const std::vector<size_t>& dims, unsigned int seed)
+{
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> dist;
+    hoNDArray<T> x(dims);
+    for (size_t i = 0; i < x.get_number_of_elements(); i++) x[i] = T(dist(gen), dist(gen));
+    return x;
+}
+
+static float max_difference(const hoNDArray<T>& x, const hoNDArray<T>& y)
+{
+    float diff = 0;
+    for (size_t i = 0; i < x.get_number_of_elements(); i++) diff = std::max(diff, std::abs(x[i] - y[i]));
+    return diff;
+}
+
+template <typename F> static long long time_ms(F f, int repetitions = 10)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++) f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() / repetitions;
+}
+
+int main()
+{
+    std::vector<size_t> dims{ RO, E1, E2, CHA };
+    auto b = random_array(dims, 1);
+    auto c = random_array(dims, 2);
+    auto d = random_array(dims, 3);
+    auto e = random_array(dims, 4);
+
+    // a = b*c + d*conj(e)
+    hoNDArray<T> a_elemwise(dims), a_fused(dims), tmp(dims);
+    auto elemwise_ms = time_ms([&]()
+    {
+        Gadgetron::multiply(b, c, a_elemwise);
+        Gadgetron::multiplyConj(d, e, tmp);
+        a_elemwise += tmp;
+    });
+    auto fused_ms = time_ms([&]() { assign(a_fused, lazy(b) * lazy(c) + lazy(d) * conj(lazy(e))); });
+    GINFO_STREAM("b*c + d*conj(e) : elementwise operators " << elemwise_ms << " ms, fused " << fused_ms << " ms, max difference " << max_difference(a_elemwise, a_fused) << std::endl);
+
+    // nrm2(b - c)
+    float n_elemwise = 0, n_fused = 0;
+    elemwise_ms = time_ms([&]()
+    {
+        tmp = b;
+        tmp -= c;
+        n_elemwise = Gadgetron::nrm2(&tmp);
+    });
+    fused_ms = time_ms([&]() { n_fused = nrm2(lazy(b) - lazy(c)); });
+    GINFO_STREAM("nrm2(b - c) : elementwise operators " << elemwise_ms << " ms, fused " << fused_ms << " ms, " << n_elemwise << " vs " << n_fused << std::endl);
+
+    // separable filter along RO, E1 and E2, applied to every channel
+    hoNDArray<T> fRO, fE1, fE2;
+    generate_symmetric_filter(RO, fRO, ISMRMRD_FILTER_GAUSSIAN, 1.5);
+    generate_symmetric_filter(E1, fE1, ISMRMRD_FILTER_HANNING);
+    generate_symmetric_filter(E2, fE2, ISMRMRD_FILTER_TAPERED_HANNING, 1.5, 4);
+
+    hoNDArray<T> filtered_elemwise, filtered_fused;
+    elemwise_ms = time_ms([&]()
+    {
+        hoNDArray<T> fxyz;
+        compute_3d_filter(fRO, fE1, fE2, fxyz);
+        Gadgetron::multiply(b, fxyz, filtered_elemwise);
+    });
+    fused_ms = time_ms([&]() { apply_kspace_filter_ROE1E2(b, fRO, fE1, fE2, filtered_fused); });
+    GINFO_STREAM("kspace filter : full filter array " << elemwise_ms << " ms, fused " << fused_ms << " ms, max difference " << max_difference(filtered_elemwise, filtered_fused) << std::endl);
+
+    return 0;
+}
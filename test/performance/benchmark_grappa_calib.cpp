@@ -0,0 +1,67 @@
+//
+// Times the GRAPPA calibration latency of real-time data: the calibration lines of a slice arrive one at a time and a
+// kernel is needed as soon as the last one is in. The batch calibration builds and solves the whole system then; the
+// accumulated calibration has added the rows of every line on arrival and only solves.
+//
+#include "mri_core_grappa.h"
+#include "log.h"
+
+#include <chrono>
+#include <random>
+
+#define RO 128
+#define E1 48
+#define CHA 16
+#define R 2
+
+using namespace Gadgetron;
+
+typedef std::complex<float> T;
+
+template <typename F> static double time_ms(F f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main()
+{
+    std::mt19937 gen(9);
+    std::normal_distribution<float> dist;
+
+    hoNDArray<T> acs(RO, E1, CHA);
+    for (auto& v : acs) v = T(dist(gen), dist(gen));
+
+    std::vector<int> kE1, oE1;
+    size_t convKRO, convKE1;
+    Gadgetron::grappa2d_kerPattern(kE1, oE1, convKRO, convKE1, R, 5, 4, false);
+
+    hoNDArray<T> expected;
+    double batch = time_ms([&]() { Gadgetron::grappa2d_calib(acs, acs, 5e-4, 5, kE1, oE1, 0, RO - 1, 0, E1 - 1, expected); });
+    GINFO_STREAM("batch calibration after the last line : " << batch << " ms" << std::endl);
+
+    grappa2d_calib_accumulator<T> accumulator;
+    accumulator.initialize(RO, E1, CHA, CHA, 0, RO - 1);
+    accumulator.set_kernel_pattern(5, kE1, oE1);
+
+    double per_line = 0;
+    for (size_t e1 = 0; e1 < E1; e1++) per_line += time_ms([&]() { accumulator.update(acs, acs, { e1 }); });
+
+    hoNDArray<T> ker;
+    double solve = time_ms([&]() { accumulator.solve(5e-4, ker); });
+
+    float max_difference = 0;
+    for (size_t i = 0; i < ker.get_number_of_elements(); i++) max_difference = std::max(max_difference, std::abs(ker[i] - expected[i]));
+
+    GINFO_STREAM("accumulated calibration : " << per_line / E1 << " ms per line on arrival, " << solve << " ms after the last line, max difference " << max_difference << std::endl);
+
+    // A time interleaved frame replaces every R-th line
+    std::vector<size_t> frame;
+    for (size_t e1 = 0; e1 < E1; e1 += R) frame.push_back(e1);
+    double replace = time_ms([&]() { accumulator.update(acs, acs, frame); });
+    GINFO_STREAM("accumulated calibration : " << replace << " ms to replace a frame of " << frame.size() << " lines" << std::endl);
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+//
+// Times the GRAPPA unwrapping of a multi-slice, multi-phase buffer: the aliased images of all channels followed by the
+// unmixing of every image, as GenericReconCartesianGrappaGadget did, against the fused pass per image
+//
+#include "mri_core_grappa.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDFFT.h"
+#include "log.h"
+
+#include <chrono>
+#include <random>
+
+#define RO 192
+#define E1 144
+#define CHA 24
+#define N 8
+#define SLC 4
+
+using namespace Gadgetron;
+
+typedef std::complex<float> T;
+
+template <typename F> static long long time_ms(F f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+int main()
+{
+    std::mt19937 gen(5);
+    std::normal_distribution<float> dist;
+
+    hoNDArray<T> kspace(RO, E1, 1, CHA, N, 1, SLC);
+    for (auto& v : kspace) v = T(dist(gen), dist(gen));
+
+    hoNDArray<T> unmixCoeff(RO, E1, 1, CHA, 1, 1, SLC);
+    for (auto& v : unmixCoeff) v = T(dist(gen), dist(gen));
+
+    float scaleFactor = 0.5f;
+
+    hoNDArray<T> expected(RO, E1, 1, 1, N, 1, SLC);
+    long long two_pass = time_ms([&]() {
+        hoNDArray<T> aliased, buf;
+        hoNDFFT<float>::instance()->ifft2c(kspace, aliased, buf);
+        Gadgetron::scal(scaleFactor, aliased);
+
+        long long num = N*SLC;
+        long long ii;
+#pragma omp parallel for default(none) private(ii) shared(num, aliased, unmixCoeff, expected)
+        for (ii = 0; ii < num; ii++)
+        {
+            size_t slc = ii / N;
+            size_t n = ii - slc*N;
+            hoNDArray<T> im(RO, E1, 1, CHA, 1, &aliased(0, 0, 0, 0, n, 0, slc));
+            hoNDArray<T> unmix(RO, E1, 1, CHA, &unmixCoeff(0, 0, 0, 0, 0, 0, slc));
+            hoNDArray<T> res(RO, E1, 1, 1, &expected(0, 0, 0, 0, n, 0, slc));
+            Gadgetron::apply_unmix_coeff_aliased_image_3D(im, unmix, res);
+        }
+    });
+    GINFO_STREAM("aliased images, then unmixing : " << two_pass << " ms" << std::endl);
+
+    for (size_t tileCHA : { 1, 4, 8, 0 })
+    {
+        hoNDArray<T> result;
+        long long fused = time_ms([&]() { Gadgetron::apply_unmix_coeff_kspace_fused(kspace, unmixCoeff, scaleFactor, result, tileCHA); });
+
+        float max_difference = 0;
+        for (size_t i = 0; i < result.get_number_of_elements(); i++) max_difference = std::max(max_difference, std::abs(result[i] - expected[i]));
+
+        GINFO_STREAM("fused, " << tileCHA << " channels per tile : " << fused << " ms, max difference " << max_difference << std::endl);
+    }
+
+    return 0;
+}
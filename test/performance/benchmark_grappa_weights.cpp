@@ -0,0 +1,186 @@
+//
+// Times the GRAPPA weights of real-time data: every slice is updated by each frame of an interleaved acquisition, and
+// the weights are calculated either in line with the acquisitions, as WeightsCalculator used to, or by workers taking
+// the latest request of each slice from a WeightsQueue. Reports the latency from the arrival of a frame to the weights
+// based on it, the number of weights calculated, and the CPU time used.
+//
+#include "../../gadgets/grappa/common/WeightsQueue.h"
+#include "../../gadgets/grappa/cpu/WeightsCore.h"
+#include "ThreadPool.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <random>
+#include <thread>
+
+#define RO 128
+#define E1 96
+#define CHA 16
+#define R 2
+
+using namespace Gadgetron;
+using namespace Gadgetron::Grappa;
+
+typedef std::complex<float> T;
+typedef std::chrono::steady_clock Clock;
+
+struct Request {
+    Clock::time_point arrival;
+    hoNDArray<T> data;
+};
+
+class Frames {
+public:
+    Frames(size_t slices, size_t frames, std::chrono::milliseconds interval) : slices(slices), frames(frames), interval(interval) {
+        std::mt19937 gen(5);
+        std::normal_distribution<float> dist;
+
+        kspace.create(RO, E1, CHA, slices);
+        for (size_t s = 0; s < slices; s++) {
+            for (size_t c = 0; c < CHA; c++) {
+                T coil(dist(gen), dist(gen));
+                for (size_t e1 = 0; e1 < E1; e1++)
+                    for (size_t ro = 0; ro < RO; ro++)
+                        kspace(ro, e1, c, s) = coil * T(dist(gen), dist(gen)) / float(1 + std::abs(int(e1) - E1 / 2));
+            }
+        }
+    }
+
+    // Copies the lines of the frame into the buffer of the slice and returns their indices
+    std::vector<size_t> acquire(size_t frame, size_t slice, hoNDArray<T>& buffer) const {
+        std::vector<size_t> lines;
+        for (size_t e1 = frame % R; e1 < E1; e1 += R) {
+            for (size_t c = 0; c < CHA; c++)
+                std::copy_n(&kspace(0, e1, c, slice), RO, &buffer(0, e1, c));
+            lines.push_back(e1);
+        }
+        return lines;
+    }
+
+    const size_t slices, frames;
+    const std::chrono::milliseconds interval;
+
+private:
+    hoNDArray<T> kspace;
+};
+
+struct Result {
+    std::vector<double> latency_ms;
+    size_t requests = 0;
+    double cpu_s = 0, wall_s = 0;
+
+    void report(const std::string& name) {
+        std::sort(latency_ms.begin(), latency_ms.end());
+        auto percentile = [&](double p) { return latency_ms[size_t(p * (latency_ms.size() - 1))]; };
+        GINFO_STREAM(name << " : " << latency_ms.size() << " of " << requests << " weights calculated, latency median "
+                          << percentile(0.5) << " ms, 95% " << percentile(0.95) << " ms, max " << latency_ms.back()
+                          << " ms, CPU " << cpu_s << " s in " << wall_s << " s" << std::endl);
+    }
+};
+
+static CPU::WeightsCore create_core()
+{
+    return CPU::WeightsCore{ { 5, 3, 1 }, { 5, 4, 5e-4f } };
+}
+
+static double ms_since(Clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+static const std::array<uint16_t, 4> region_of_support = { 0, RO, 0, E1 };
+
+static Result in_line(const Frames& frames)
+{
+    auto core = create_core();
+    std::vector<hoNDArray<T>> buffers(frames.slices, hoNDArray<T>(RO, E1, CHA));
+    Result result;
+
+    auto cpu = std::clock();
+    auto start = Clock::now();
+    for (size_t frame = 0; frame < frames.frames; frame++) {
+        auto arrival = start + frame * frames.interval;
+        std::this_thread::sleep_until(arrival);
+
+        for (size_t s = 0; s < frames.slices; s++) {
+            auto lines = frames.acquire(frame, s, buffers[s]);
+            core.update(s, buffers[s], lines, uint16_t(R));
+            if (frame == 0) continue;
+
+            result.requests++;
+            core.calculate_weights(s, buffers[s], region_of_support, R, CHA, 0);
+            result.latency_ms.push_back(ms_since(arrival));
+        }
+    }
+    result.wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+    result.cpu_s = double(std::clock() - cpu) / CLOCKS_PER_SEC;
+    return result;
+}
+
+static Result queued(const Frames& frames, unsigned int workers)
+{
+    auto core = create_core();
+    std::vector<hoNDArray<T>> buffers(frames.slices, hoNDArray<T>(RO, E1, CHA));
+    Result result;
+    std::mutex result_mutex;
+
+    WeightsQueue<Request> queue;
+    Core::ThreadPool pool(workers);
+    std::vector<std::future<void>> futures;
+    for (unsigned int i = 0; i < workers; i++) {
+        futures.push_back(pool.async([&]() {
+            try {
+                while (true) {
+                    auto [slice, request] = queue.pop();
+                    core.calculate_weights(slice, request.data, region_of_support, R, CHA, 0);
+                    {
+                        std::lock_guard<std::mutex> guard(result_mutex);
+                        result.latency_ms.push_back(ms_since(request.arrival));
+                    }
+                    queue.done(slice);
+                }
+            } catch (const Core::ChannelClosed&) {
+            }
+        }));
+    }
+
+    auto cpu = std::clock();
+    auto start = Clock::now();
+    for (size_t frame = 0; frame < frames.frames; frame++) {
+        auto arrival = start + frame * frames.interval;
+        std::this_thread::sleep_until(arrival);
+
+        for (size_t s = 0; s < frames.slices; s++) {
+            auto lines = frames.acquire(frame, s, buffers[s]);
+            core.update(s, buffers[s], lines, uint16_t(R));
+            if (frame == 0) continue;
+
+            result.requests++;
+            queue.push(s, Request{ arrival, buffers[s] });
+        }
+    }
+    queue.close();
+    pool.join();
+    for (auto& future : futures) future.get();
+
+    result.wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+    result.cpu_s = double(std::clock() - cpu) / CLOCKS_PER_SEC;
+    return result;
+}
+
+int main()
+{
+    // An interleaved acquisition with R 2: two frames make up the calibration region of a slice.
+    for (size_t slices : { 1, 4, 8 }) {
+        Frames frames(slices, 40, std::chrono::milliseconds(50));
+        GINFO_STREAM(slices << " slice(s), a frame every " << frames.interval.count() << " ms" << std::endl);
+
+        in_line(frames).report("in line");
+        for (unsigned int workers : { 1, 2, 4 })
+            queued(frames, workers).report("queued, " + std::to_string(workers) + " worker(s)");
+    }
+
+    return 0;
+}
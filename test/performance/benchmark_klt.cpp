@@ -0,0 +1,143 @@
+//
+// Compares the eigen channel (KLT) computation on 64 channel data: the singular value decomposition of the whole
+// data matrix, the blocked covariance accumulation and the randomized truncated decomposition
+//
+#include "hoArmadillo.h"
+#include "hoNDKLT.h"
+#include "hoNDArray_elemwise.h"
+#include "log.h"
+
+#include <chrono>
+#include <random>
+
+#define RO 256
+#define E1 256
+#define E2 16
+#define CHA 64
+#define SOURCES 12
+
+using namespace Gadgetron;
+
+typedef std::complex<float> T;
+
+// SOURCES smooth sources with decaying strength, mixed into CHA channels, plus white noise
+static void make_data(hoNDArray<T>& data)
+{
+    std::mt19937 gen(1);
+    std::normal_distribution<float> dist;
+
+    hoNDArray<T> mix(SOURCES, CHA);
+    for (size_t i = 0; i < mix.get_number_of_elements(); i++) mix[i] = T(dist(gen), dist(gen));
+
+    data.create(RO, E1, E2, CHA);
+    Gadgetron::clear(data);
+    size_t num = RO*E1*E2;
+    for (size_t k = 0; k < SOURCES; k++)
+    {
+        float strength = 10.0f * std::exp(-0.3f*k);
+        for (size_t m = 0; m < num; m++)
+        {
+            T s = std::polar(strength*std::sin(0.001f*(k + 1)*m), 0.0003f*m*k);
+            for (size_t cha = 0; cha < CHA; cha++) data[m + cha*num] += s*mix(k, cha);
+        }
+    }
+
+    for (size_t i = 0; i < data.get_number_of_elements(); i++) data[i] += T(dist(gen), dist(gen));
+}
+
+// distance between the subspaces spanned by the first L columns of V1 and V2, |V1*V1' - V2*V2'|
+static float subspace_distance(const hoNDArray<T>& V1, const hoNDArray<T>& V2, size_t L)
+{
+    size_t N = V1.get_size(0);
+    float diff = 0;
+    for (size_t c = 0; c < N; c++)
+    {
+        for (size_t r = 0; r < N; r++)
+        {
+            T p1 = 0, p2 = 0;
+            for (size_t l = 0; l < L; l++)
+            {
+                p1 += V1(r, l)*std::conj(V1(c, l));
+                p2 += V2(r, l)*std::conj(V2(c, l));
+            }
+            diff += std::norm(p1 - p2);
+        }
+    }
+    return std::sqrt(diff);
+}
+
+template <typename F> static long long time_ms(F f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+int main()
+{
+    hoNDArray<T> data;
+    make_data(data);
+
+    size_t M = RO*E1*E2;
+
+    // singular value decomposition of the mean free data matrix
+    hoNDArray<T> V_svd(CHA, CHA);
+    auto svd_ms = time_ms([&]()
+    {
+        hoNDArray<T> data2D(M, CHA);
+        for (size_t cha = 0; cha < CHA; cha++)
+        {
+            T mean = 0;
+            for (size_t m = 0; m < M; m++) mean += data[m + cha*M];
+            mean /= (float)M;
+            for (size_t m = 0; m < M; m++) data2D(m, cha) = data[m + cha*M] - mean;
+        }
+
+        arma::Mat<T> Am = as_arma_matrix(data2D);
+        arma::Mat<T> Um, Vm;
+        arma::Col<float> Sv;
+        arma::svd_econ(Um, Sv, Vm, Am, 'r');
+        memcpy(V_svd.begin(), Vm.memptr(), sizeof(T)*CHA*CHA);
+    });
+    GINFO_STREAM("SVD of the data matrix took " << svd_ms << " ms" << std::endl);
+
+    hoNDKLT<T> klt;
+    auto cov_ms = time_ms([&]() { klt.prepare(data, 3, (float)0.001); });
+    GINFO_STREAM("Blocked covariance and eigen decomposition took " << cov_ms << " ms, " << klt.output_length() << " modes kept" << std::endl);
+
+    hoNDArray<T> V, E;
+    klt.eigen_vector(V);
+    klt.eigen_value(E);
+
+    float total = 0, kept = 0;
+    size_t L = 0;
+    for (size_t n = 0; n < CHA; n++) total += std::real(E(n));
+    while (kept < 0.99f*total) kept += std::real(E(L++));
+    GINFO_STREAM("Subspace distance to the SVD for " << L << " modes : " << subspace_distance(V, V_svd, L) << std::endl);
+
+    hoNDKLT<T> randomized;
+    auto rand_ms = time_ms([&]() { randomized.prepare_randomized(data, 3, (float)0.99); });
+    GINFO_STREAM("Randomized decomposition took " << rand_ms << " ms, " << randomized.output_length() << " modes kept" << std::endl);
+
+    hoNDArray<T> V_rand;
+    randomized.eigen_vector(V_rand);
+    GINFO_STREAM("Subspace distance to the SVD for " << randomized.output_length() << " modes : " << subspace_distance(V_rand, V_svd, randomized.output_length()) << std::endl);
+
+    // the next N of stable data only needs a check whether the kept modes still hold
+    hoNDArray<T> next(data);
+    std::mt19937 gen(2);
+    std::normal_distribution<float> dist;
+    for (size_t i = 0; i < next.get_number_of_elements(); i++) next[i] += 0.1f*T(dist(gen), dist(gen));
+
+    bool stable = false;
+    auto stable_ms = time_ms([&]() { stable = randomized.is_stable(next, 3, 0.01f); });
+    GINFO_STREAM("Stability check took " << stable_ms << " ms, stable : " << stable << std::endl);
+
+    // the same data with the channels rotated is not described by the modes any more
+    hoNDArray<T> rotated(data.dimensions());
+    for (size_t cha = 0; cha < CHA; cha++) memcpy(rotated.begin() + ((cha + 1) % CHA)*M, data.begin() + cha*M, sizeof(T)*M);
+    GINFO_STREAM("Channels rotated, stable : " << randomized.is_stable(rotated, 3, 0.01f) << std::endl);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+//
+// Compares the kmeans variants on a large data set: the full distance computation of every iteration, the
+// iterations with triangle inequality bounds and the mini-batch mode, all from the same kmeans++ initialization
+//
+#include "pr_kmeans.h"
+#include "log.h"
+
+#include <chrono>
+#include <random>
+
+#define P 8
+#define N 400000
+#define K 24
+
+using namespace Gadgetron;
+
+typedef float T;
+
+// K gaussian blobs of different widths at random centres
+static void make_data(hoNDArray<T>& X)
+{
+    std::mt19937 gen(1);
+    std::normal_distribution<T> dist;
+    std::uniform_real_distribution<T> centre(-20, 20);
+
+    hoNDArray<T> centres(P, K);
+    for (size_t i = 0; i < centres.get_number_of_elements(); i++) centres[i] = centre(gen);
+
+    X.create(P, N);
+    for (size_t n = 0; n < N; n++)
+    {
+        size_t k = n % K;
+        T width = (T)1 + (T)(k % 4);
+        for (size_t p = 0; p < P; p++) X(p, n) = centres(p, k) + width*dist(gen);
+    }
+}
+
+template <typename F> static long long time_ms(F f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+int main()
+{
+    hoNDArray<T> X;
+    make_data(X);
+
+    kmeans<T> km;
+    km.seed_ = 1;
+    km.replicates_ = 1;
+    km.max_iter_ = 100;
+    km.perform_online_update_ = false;
+
+    hoNDArray<T> C_for_initial;
+    auto init_ms = time_ms([&]() { km.get_initial_guess_kmeansplusplus(X, K, C_for_initial); });
+    GINFO_STREAM("kmeans++ initialization took " << init_ms << " ms" << std::endl);
+
+    std::vector<size_t> IDX_full, IDX_bounds, IDX_batch;
+    hoNDArray<T> C;
+    T sumD_full, sumD_bounds, sumD_batch;
+
+    km.use_triangle_inequality_ = false;
+    auto full_ms = time_ms([&]() { km.run(X, K, C_for_initial, IDX_full, C, sumD_full); });
+    GINFO_STREAM("Full distance computation took " << full_ms << " ms, sumD : " << sumD_full << std::endl);
+
+    km.use_triangle_inequality_ = true;
+    auto bounds_ms = time_ms([&]() { km.run(X, K, C_for_initial, IDX_bounds, C, sumD_bounds); });
+
+    size_t num_different = 0;
+    for (size_t n = 0; n < N; n++) num_different += (IDX_full[n] != IDX_bounds[n]);
+    GINFO_STREAM("Triangle inequality bounds took " << bounds_ms << " ms, sumD : " << sumD_bounds << ", " << num_different << " points clustered differently" << std::endl);
+
+    km.mini_batch_size_ = 4096;
+    auto batch_ms = time_ms([&]() { km.run(X, K, C_for_initial, IDX_batch, C, sumD_batch); });
+    GINFO_STREAM("Mini-batch of " << km.mini_batch_size_ << " took " << batch_ms << " ms, sumD : " << sumD_batch << std::endl);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+//
+// Times merging 8 to 32 branches into one channel, as at the end of a Parallel node. Each branch is fed by its own
+// producer. The merge either runs a thread per branch, all pushing to the output, as UnorderedMerge used to, or waits
+// on all branches from a single thread through a ChannelSelector, as UnorderedMerge and OrderedMerge do now.
+// Reports the time per message, from the first push to the last message read from the output, and the CPU time used.
+//
+#include "Channel.h"
+#include "Context.h"
+#include "Types.h"
+#include "log.h"
+#include "parallel/OrderedMerge.h"
+#include "parallel/UnorderedMerge.h"
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Core::Parallel;
+
+constexpr size_t messages_per_branch = 20000;
+
+static void thread_per_branch(std::map<std::string, GenericInputChannel> input, OutputChannel output)
+{
+    std::vector<std::thread> threads;
+    for (auto& pair : input) {
+        threads.emplace_back([](GenericInputChannel input, OutputChannel output) {
+            try {
+                while (true) output.push_message(input.pop());
+            } catch (const ChannelClosed&) {}
+        }, std::move(pair.second), split(output));
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+template<class MERGE>
+static void run(const std::string& name, size_t branches, MERGE merge)
+{
+    std::map<std::string, GenericInputChannel> inputs;
+    std::vector<OutputChannel> outputs;
+    for (size_t index = 0; index < branches; index++) {
+        auto channel = make_channel<MessageChannel>();
+        inputs.emplace(std::to_string(index), std::move(channel.input));
+        outputs.emplace_back(std::move(channel.output));
+    }
+    auto merged = make_channel<MessageChannel>();
+
+    auto wall = std::chrono::steady_clock::now();
+    auto cpu = std::clock();
+
+    std::thread merger(merge, std::move(inputs), std::move(merged.output));
+
+    std::vector<std::thread> producers;
+    for (auto& output : outputs) {
+        producers.emplace_back([](OutputChannel output) {
+            ISMRMRD::AcquisitionHeader header{};
+            for (uint32_t n = 0; n < messages_per_branch; n++) {
+                header.acquisition_time_stamp = n;
+                output.push(header);
+            }
+        }, std::move(output));
+    }
+
+    size_t count = 0;
+    try {
+        while (true) {
+            merged.input.pop();
+            count++;
+        }
+    } catch (const ChannelClosed&) {}
+
+    for (auto& producer : producers) producer.join();
+    merger.join();
+
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - wall).count();
+    auto cpu_time = double(std::clock() - cpu) / CLOCKS_PER_SEC;
+
+    GINFO_STREAM(name << ", " << branches << " branches: " << elapsed / count << " ns per message, "
+        << cpu_time << " s CPU for " << count << " messages" << std::endl);
+}
+
+int main()
+{
+    for (size_t branches : { 8, 16, 32 }) {
+        run("thread per branch", branches, thread_per_branch);
+
+        run("UnorderedMerge", branches, [](auto input, auto output) {
+            UnorderedMerge(Context{}, {}).process(std::move(input), std::move(output));
+        });
+
+        run("OrderedMerge, timestamp", branches, [](auto input, auto output) {
+            OrderedMerge(Context{}, { { "order", "timestamp" } }).process(std::move(input), std::move(output));
+        });
+    }
+
+    return 0;
+}
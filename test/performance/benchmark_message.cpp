@@ -0,0 +1,100 @@
+//
+// Counts the heap allocations and times the message traffic of one acquisition: pushing it through a channel,
+// matching and unpacking it as in InputChannel<Acquisition>, and the round trip through the GadgetContainerMessage
+// chain of the legacy gadgets. The data arrays are made up front, so only the message overhead is counted.
+//
+#include "Channel.h"
+#include "GadgetContainerMessage.h"
+#include "Message.h"
+#include "Types.h"
+#include "log.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> allocations{ 0 };
+
+void* operator new(size_t size)
+{
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+
+static std::vector<Acquisition> make_acquisitions(size_t count)
+{
+    std::vector<Acquisition> acquisitions;
+    for (size_t n = 0; n < count; n++) {
+        ISMRMRD::AcquisitionHeader header{};
+        header.scan_counter = uint32_t(n);
+        acquisitions.emplace_back(header, hoNDArray<std::complex<float>>(256, 16), none);
+    }
+    return acquisitions;
+}
+
+static double ns_per(std::chrono::high_resolution_clock::duration elapsed, size_t count)
+{
+    return std::chrono::duration<double, std::nano>(elapsed).count() / count;
+}
+
+static Message legacy_round_trip(Message message)
+{
+    auto* container = message.to_container_message();
+
+    MessageChunks chunks;
+    for (auto* current = container; current; current = dynamic_cast<GadgetContainerMessageBase*>(current->cont()))
+        chunks.emplace_back(current->take_message());
+    container->release();
+    return Message(std::move(chunks));
+}
+
+int main()
+{
+    constexpr size_t count = 100000;
+
+    auto channel = make_channel<MessageChannel>();
+    auto bypass = make_channel<MessageChannel>();
+    InputChannel<Acquisition> input(channel.input, bypass.output);
+
+    // warm up, so pools and the channel have reached their steady state
+    for (auto& acquisition : make_acquisitions(1000)) {
+        channel.output.push(std::move(acquisition));
+        input.pop();
+    }
+
+    {
+        auto acquisitions = make_acquisitions(count);
+        size_t before = allocations;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto& acquisition : acquisitions) {
+            channel.output.push(std::move(acquisition));
+            auto unpacked = input.pop();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        GINFO_STREAM("push, match and unpack : " << double(allocations - before) / count << " allocations and "
+            << ns_per(end - start, count) << " ns per acquisition" << std::endl);
+    }
+
+    {
+        auto acquisitions = make_acquisitions(count);
+        size_t before = allocations;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto& acquisition : acquisitions) {
+            auto message = legacy_round_trip(Message(std::move(acquisition)));
+            auto unpacked = force_unpack<Acquisition>(std::move(message));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        GINFO_STREAM("legacy container round trip : " << double(allocations - before) / count << " allocations and "
+            << ns_per(end - start, count) << " ns per acquisition" << std::endl);
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+//
+// Times permute on the permutations of the recon buffers [RO E1 E2 CHA N S SLC], against copying the array, and
+// against the element by element permutation with ArrayIterator
+//
+#include "hoNDArray_utils.h"
+#include "log.h"
+
+#include <chrono>
+#include <complex>
+
+using namespace Gadgetron;
+
+typedef std::complex<float> T;
+
+template <typename F> static double time_ms(F f, int repetitions = 5)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++) f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+static void elementwise_permute(const hoNDArray<T>& in, hoNDArray<T>& out, std::vector<size_t> order)
+{
+    ArrayIterator it(in.get_dimensions().get(), &order);
+    for (size_t i = 0; i < in.get_number_of_elements(); i++) {
+        out[i] = in[it.get_current_idx()];
+        it.advance();
+    }
+}
+
+int main()
+{
+    // RO E1 E2 CHA N S SLC
+    std::vector<size_t> dims{ 256, 192, 1, 32, 8, 1, 4 };
+    hoNDArray<T> x(dims);
+    for (size_t i = 0; i < x.get_number_of_elements(); i++) x[i] = T(float(i), -float(i));
+
+    struct Case { const char* name; std::vector<size_t> order; };
+    std::vector<Case> cases = {
+        { "CHA to the end", { 0, 1, 2, 4, 5, 6, 3 } },
+        { "CHA to the front", { 3, 0, 1, 2, 4, 5, 6 } },
+        { "RO <-> E1", { 1, 0, 2, 3, 4, 5, 6 } },
+        { "N S SLC first", { 4, 5, 6, 0, 1, 2, 3 } },
+        { "reverse", { 6, 5, 4, 3, 2, 1, 0 } },
+    };
+
+    hoNDArray<T> copy(dims);
+    GINFO_STREAM("copy : " << time_ms([&]() { std::copy_n(x.begin(), x.get_number_of_elements(), copy.begin()); }) << " ms" << std::endl);
+
+    for (auto& c : cases) {
+        auto reference = permute(x, c.order);
+        hoNDArray<T> result(reference.dimensions()), elementwise(reference.dimensions());
+
+        double permute_ms = time_ms([&]() { permute(x, result, c.order); });
+        double elementwise_ms = time_ms([&]() { elementwise_permute(x, elementwise, c.order); }, 1);
+
+        bool equal = std::equal(result.begin(), result.end(), elementwise.begin());
+        GINFO_STREAM(c.name << " : permute " << permute_ms << " ms, element by element " << elementwise_ms << " ms" << (equal ? "" : ", RESULTS DIFFER") << std::endl);
+    }
+
+    // square images, in place
+    hoNDArray<T> images(256, 256, 32, 8);
+    double inplace_ms = time_ms([&]() { permute_inplace(images, { 1, 0, 2, 3 }); });
+    GINFO_STREAM("256x256 transpose in place : " << inplace_ms << " ms" << std::endl);
+
+    return 0;
+}
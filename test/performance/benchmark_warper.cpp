@@ -0,0 +1,79 @@
+//
+// Compares hoImageRegWarpEngine with the generic per pixel warping path of hoImageRegWarper
+//
+#include "hoImageRegWarper.h"
+#include "log.h"
+
+#include <chrono>
+#include <random>
+
+#define ITERATIONS 20
+
+using namespace Gadgetron;
+
+template <unsigned int D>
+void time_warp(const std::vector<size_t>& dims, GT_IMAGE_INTERPOLATOR interp_type, GT_BOUNDARY_CONDITION bh_type)
+{
+    typedef hoNDImage<float, D> ImageType;
+
+    ImageType target(dims), source(dims);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(0.1f, 1.0f);
+    for (size_t n = 0; n < target.get_number_of_elements(); n++)
+    {
+        target(n) = dist(gen);
+        source(n) = dist(gen);
+    }
+
+    // smooth deformation of a few pixels, as produced by the moco
+    hoImageRegDeformationField<double, D> deform(dims);
+    for (unsigned int d = 0; d < D; d++)
+    {
+        hoNDImage<double, D>& field = deform.getDeformationField(d);
+        for (size_t n = 0; n < field.get_number_of_elements(); n++)
+            field(n) = 2.5*std::sin(0.01*n + d);
+    }
+
+    std::unique_ptr< hoNDBoundaryHandler<ImageType> > bh(createBoundaryHandler<ImageType>(bh_type));
+    bh->setArray(source);
+    std::unique_ptr< hoNDInterpolator<ImageType> > interp(createInterpolator<ImageType, D>(interp_type));
+    interp->setArray(source);
+    interp->setBoundaryHandler(*bh);
+
+    hoImageRegWarper<ImageType, ImageType, double> warper;
+    warper.setTransformation(deform);
+    warper.setInterpolator(*interp);
+
+    ImageType warped_generic, warped_engine;
+
+    for (int engine = 0; engine < 2; engine++)
+    {
+        warper.useWarpEngine_ = (engine == 1);
+        ImageType& warped = (engine == 1) ? warped_engine : warped_generic;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int it = 0; it < ITERATIONS; it++)
+            warper.warp(target, source, false, warped);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        GINFO_STREAM(D << "D " << getInterpolatorName(interp_type) << " " << getBoundaryHandlerName(bh_type)
+            << (engine ? " engine  : " : " generic : ")
+            << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / ITERATIONS << " us per warp" << std::endl);
+    }
+
+    double max_diff = 0;
+    for (size_t n = 0; n < warped_engine.get_number_of_elements(); n++)
+        max_diff = std::max(max_diff, (double)std::abs(warped_engine(n) - warped_generic(n)));
+    GINFO_STREAM("max difference " << max_diff << std::endl);
+}
+
+int main()
+{
+    time_warp<2>({ 256, 256 }, GT_IMAGE_INTERPOLATOR_LINEAR, GT_BOUNDARY_CONDITION_BORDERVALUE);
+    time_warp<2>({ 512, 512 }, GT_IMAGE_INTERPOLATOR_LINEAR, GT_BOUNDARY_CONDITION_FIXEDVALUE);
+    time_warp<2>({ 256, 256 }, GT_IMAGE_INTERPOLATOR_BSPLINE, GT_BOUNDARY_CONDITION_BORDERVALUE);
+    time_warp<3>({ 192, 192, 64 }, GT_IMAGE_INTERPOLATOR_LINEAR, GT_BOUNDARY_CONDITION_BORDERVALUE);
+
+    return 0;
+}
@@ -166,6 +166,97 @@ TEST_F(python_converter_test, numpy_hoNDArray_three_outputs)
     EXPECT_FLOAT_EQ(c[20], 255);
 }
 
+TEST_F(python_converter_test, numpy_shared_hoNDArray)
+{
+    GDEBUG_STREAM(" --------------------------------------------------------------------------------------------------");
+    GDEBUG_STREAM("Test shared hoNDArray passed to and from numpy");
+    {
+        GILLock gl;     // this is needed
+        boost::python::object main(boost::python::import("__main__"));
+        boost::python::object global(main.attr("__dict__"));
+        boost::python::exec("import numpy as np\n"
+            "def scale_in_place(a): \n"
+            "   assert a.flags.f_contiguous and a.flags.writeable and not a.flags.owndata\n"
+            "   a[1, 2] = -1\n"
+            "   a *= 2\n"
+            "   return a\n"
+            "def identity(a): \n"
+            "   return a\n"
+            "def keep(a): \n"
+            "   global kept\n"
+            "   kept = a\n"
+            "def kept_sum(): \n"
+            "   return float(kept.sum())\n"
+            "def release_kept(): \n"
+            "   global kept\n"
+            "   del kept\n"
+            "def make_fortran(): \n"
+            "   return np.asfortranarray(np.arange(12, dtype=np.float32).reshape(3, 4))\n"
+            "def make_c(): \n"
+            "   return np.arange(12, dtype=np.float32).reshape(3, 4)\n"
+            "def make_double(): \n"
+            "   return np.asfortranarray(np.zeros((3, 4)))\n",
+            global, global);
+    }
+
+    auto a = std::make_shared< hoNDArray<float> >(3, 4);
+    Gadgetron::fill(*a, float(45));
+
+    // numpy writes through a view of the memory of a, and the view comes back without copying
+    PythonFunction< std::shared_ptr< hoNDArray<float> > > scale_in_place("__main__", "scale_in_place");
+    std::shared_ptr< hoNDArray<float> > b = scale_in_place(a);
+
+    EXPECT_EQ(b->get_data_ptr(), a->get_data_ptr());
+    EXPECT_FLOAT_EQ((*a)(0, 0), 90);
+    EXPECT_FLOAT_EQ((*a)(1, 2), -2);
+    EXPECT_FLOAT_EQ((*a)(2, 3), 90);
+
+    // the view keeps the array alive after C++ let go of it
+    PythonFunction<> keep("__main__", "keep");
+    PythonFunction<float> kept_sum("__main__", "kept_sum");
+    PythonFunction<> release_kept("__main__", "release_kept");
+    std::weak_ptr< hoNDArray<float> > weak = a;
+    keep(a);
+    a.reset();
+    b.reset();
+    EXPECT_FALSE(weak.expired());
+    EXPECT_FLOAT_EQ(kept_sum(), 11 * 90 - 2);
+    release_kept();
+    EXPECT_TRUE(weak.expired());
+
+    // an array adopted from numpy goes back as the numpy array it wraps
+    PythonFunction< std::shared_ptr< hoNDArray<float> > > identity("__main__", "identity");
+    std::shared_ptr< hoNDArray<float> > e = identity(std::make_shared< hoNDArray<float> >(3, 4));
+    std::shared_ptr< hoNDArray<float> > d = identity(e);
+    EXPECT_EQ(d->get_data_ptr(), e->get_data_ptr());
+
+    // the fortran array is adopted, the C array is copied once into fortran order
+    PythonFunction< std::shared_ptr< hoNDArray<float> > > make_fortran("__main__", "make_fortran");
+    PythonFunction< std::shared_ptr< hoNDArray<float> > > make_c("__main__", "make_c");
+    std::shared_ptr< hoNDArray<float> > f = make_fortran();
+    std::shared_ptr< hoNDArray<float> > c = make_c();
+
+    ASSERT_EQ(f->get_size(0), 3);
+    ASSERT_EQ(f->get_size(1), 4);
+    ASSERT_EQ(c->get_size(0), 3);
+    ASSERT_EQ(c->get_size(1), 4);
+    for (size_t j = 0; j < 4; j++)
+        for (size_t i = 0; i < 3; i++) {
+            EXPECT_FLOAT_EQ((*f)(i, j), i * 4 + j);
+            EXPECT_FLOAT_EQ((*c)(i, j), i * 4 + j);
+        }
+
+    // float64 memory is not read as float32
+    PythonFunction< std::shared_ptr< hoNDArray<float> > > make_double("__main__", "make_double");
+    EXPECT_THROW(make_double(), std::runtime_error);
+
+    // release the numpy arrays without holding the GIL
+    d.reset();
+    e.reset();
+    f.reset();
+    c.reset();
+}
+
 TEST_F(python_converter_test, ismrmrd_acquisitionheader)
 {
     {
@@ -3,6 +3,8 @@
 #include "Message.h"
 #include "MessageID.h"
 #include "hoNDArray_elemwise.h"
+#include "io/ismrmrd_meta.h"
+#include "io/ismrmrd_types.h"
 #include "mri_core_data.h"
 #include "readers/BufferReader.h"
 #include "readers/GadgetIsmrmrdReader.h"
@@ -38,6 +40,36 @@ namespace {
 
         return { acquisition_header, data, Core::none };
     }
+
+    ISMRMRD::MetaContainer generate_meta() {
+        auto meta = ISMRMRD::MetaContainer();
+        meta.set("GADGETRON_DataRole", "Image");
+        meta.append("GADGETRON_ImageComment", "GT");
+        meta.append("GADGETRON_ImageComment", "PHS");
+        meta.set("GADGETRON_ImageNumber", long(12));
+        meta.set("GADGETRON_WindowCenter", 1.25);
+        meta.set("GADGETRON_SeriesDescription", "");
+        return meta;
+    }
+
+    void expect_equal_meta(const ISMRMRD::MetaContainer& expected, const ISMRMRD::MetaContainer& meta) {
+        for (const auto& [name, values] : expected) {
+            ASSERT_EQ(meta.length(name.c_str()), values.size()) << name;
+            for (size_t i = 0; i < values.size(); i++) {
+                EXPECT_STREQ(meta.as_str(name.c_str(), i), values[i].as_str()) << name;
+                EXPECT_EQ(meta.as_long(name.c_str(), i), values[i].as_long()) << name;
+                EXPECT_EQ(meta.as_double(name.c_str(), i), values[i].as_double()) << name;
+            }
+        }
+    }
+
+    ISMRMRD::MetaContainer xml_round_trip(const ISMRMRD::MetaContainer& meta) {
+        std::stringstream stream;
+        Gadgetron::Core::IO::write(stream, meta);
+        ISMRMRD::MetaContainer result;
+        Gadgetron::Core::IO::read(stream, result);
+        return result;
+    }
 }
 
 TEST(ReadWriteTest, AcquisitionTest) {
@@ -161,6 +193,78 @@ TEST(ReadWriteTest, ImageTest) {
     ASSERT_EQ(data, std::get<hoNDArray<int>>(value));
 }
 
+TEST(ReadWriteTest, BinaryMetaImageTest) {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    auto header           = ISMRMRD::ImageHeader{};
+    header.matrix_size[0] = 16;
+    header.matrix_size[1] = 16;
+    header.matrix_size[2] = 1;
+    header.channels       = 1;
+
+    auto data = hoNDArray<float>(16, 16, 1, 1);
+    std::fill(data.begin(), data.end(), 42.0f);
+    auto meta = generate_meta();
+
+    auto stream = std::stringstream();
+    IO::set_meta_encoding(stream, IO::MetaEncoding::binary);
+
+    auto reader = Core::Readers::ImageReader();
+    auto writer = Core::Writers::ImageWriter();
+
+    std::vector<std::streamoff> sizes;
+    for (int i = 0; i < 2; i++) {
+        auto start = stream.tellp();
+        writer.write(stream, Core::Message(header, data, meta));
+        sizes.push_back(stream.tellp() - start);
+    }
+
+    // The keys are only sent with the first image
+    EXPECT_LT(sizes[1], sizes[0]);
+
+    auto expected = xml_round_trip(meta);
+    for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(Core::IO::read<uint16_t>(stream), GADGET_MESSAGE_ISMRMRD_IMAGE);
+        auto unpacked = Core::unpack<Image<float>>(reader.read(stream));
+        ASSERT_TRUE(bool(unpacked));
+
+        auto& [read_header, read_data, read_meta] = *unpacked;
+        ASSERT_EQ(data, read_data);
+        ASSERT_TRUE(bool(read_meta));
+        expect_equal_meta(expected, *read_meta);
+    }
+}
+
+TEST(ReadWriteTest, BinaryMetaStreamTest) {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    auto meta = generate_meta();
+
+    auto stream = std::stringstream();
+    IO::write(stream, meta);
+    IO::set_meta_encoding(stream, IO::MetaEncoding::binary);
+    IO::write(stream, meta);
+    IO::write(stream, meta);
+
+    // XML written before the negotiation is still read on the binary stream
+    auto expected = xml_round_trip(meta);
+    for (int i = 0; i < 3; i++) {
+        ISMRMRD::MetaContainer result;
+        IO::read(stream, result);
+        expect_equal_meta(expected, result);
+    }
+
+    auto other = std::stringstream();
+    IO::set_meta_encoding(other, IO::MetaEncoding::binary);
+    IO::write(other, meta);
+
+    ISMRMRD::MetaContainer result;
+    auto unnegotiated = std::stringstream(other.str());
+    EXPECT_THROW(IO::read(unnegotiated, result), std::runtime_error);
+}
+
 TEST(ReadWriteTest, BucketTest) {
     using namespace Gadgetron;
     using namespace Gadgetron::Core;
@@ -0,0 +1,95 @@
+#include "t1fit.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    // Inversion times of a MOLLI 5(3)3 scheme, as sorted by T1MocoGadget
+    const std::vector<float> molli_TI = { 100, 180, 260, 1100, 1180, 2100, 2180, 3100 };
+
+    // Synthetic MOLLI signal A - B exp(-TI/T1star) with T1star from 300 to 1500 ms along x
+    struct MolliData {
+        hoNDArray<float> data;
+        hoNDArray<float> A;
+        hoNDArray<float> B;
+        hoNDArray<float> T1star;
+    };
+
+    MolliData make_molli(size_t X, size_t Y, float noise_sigma) {
+        std::mt19937 gen(42);
+        std::normal_distribution<float> noise(0, noise_sigma);
+
+        MolliData result{ hoNDArray<float>(X, Y, molli_TI.size()), hoNDArray<float>(X, Y), hoNDArray<float>(X, Y),
+                          hoNDArray<float>(X, Y) };
+        for (size_t y = 0; y < Y; y++) {
+            for (size_t x = 0; x < X; x++) {
+                float A = 400 + 20 * y;
+                float B = 1.9f * A;
+                float T1star = 300 + 1200 * x / float(X - 1);
+                result.A(x, y) = A;
+                result.B(x, y) = B;
+                result.T1star(x, y) = T1star;
+                for (size_t t = 0; t < molli_TI.size(); t++)
+                    result.data(x, y, t) = A - B * std::exp(-molli_TI[t] / T1star) + noise(gen);
+            }
+        }
+        return result;
+    }
+}
+
+TEST(t1fit, fit_T1_3param_batched_matches_default_on_molli) {
+    auto molli = make_molli(37, 5, 2.0f);
+
+    auto fitted = T1::fit_T1_3param(molli.data, molli_TI);
+    auto batched = T1::fit_T1_3param(molli.data, molli_TI, true);
+
+    for (size_t i = 0; i < molli.T1star.size(); i++) {
+        EXPECT_NEAR(fitted.T1star[i], molli.T1star[i], 0.03f * molli.T1star[i]) << i;
+        EXPECT_NEAR(batched.T1star[i], molli.T1star[i], 0.03f * molli.T1star[i]) << i;
+
+        EXPECT_NEAR(batched.T1star[i], fitted.T1star[i], 0.005f * fitted.T1star[i]) << i;
+        EXPECT_NEAR(batched.A[i], fitted.A[i], 0.005f * fitted.A[i]) << i;
+        EXPECT_NEAR(batched.B[i], fitted.B[i], 0.005f * fitted.B[i]) << i;
+    }
+}
+
+TEST(t1fit, fit_T1_3param_complex_batched_matches_default_on_molli) {
+    auto molli = make_molli(21, 3, 2.0f);
+
+    // magnitude data with a coil phase; the sign is recovered by trying every inversion point
+    hoNDArray<std::complex<float>> data(molli.data.dimensions());
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = std::polar(std::abs(molli.data[i]), 0.3f);
+
+    auto fitted = T1::fit_T1_3param(data, molli_TI);
+    auto batched = T1::fit_T1_3param(data, molli_TI, true);
+
+    for (size_t i = 0; i < molli.T1star.size(); i++) {
+        EXPECT_NEAR(batched.T1star[i], fitted.T1star[i], 0.005f * fitted.T1star[i]) << i;
+    }
+}
+
+TEST(t1fit, fit_T1_2param_batched_matches_default) {
+    const size_t X = 29, Y = 4;
+    hoNDArray<float> data(X, Y, molli_TI.size());
+    hoNDArray<float> T1_true(X, Y);
+    for (size_t y = 0; y < Y; y++) {
+        for (size_t x = 0; x < X; x++) {
+            float A = 500 + 50 * y;
+            T1_true(x, y) = 400 + 1400 * x / float(X - 1);
+            for (size_t t = 0; t < molli_TI.size(); t++)
+                data(x, y, t) = A * (1 - 2 * std::exp(-molli_TI[t] / T1_true(x, y)));
+        }
+    }
+
+    auto fitted = T1::fit_T1_2param(data, molli_TI);
+    auto batched = T1::fit_T1_2param(data, molli_TI, true);
+
+    for (size_t i = 0; i < T1_true.size(); i++) {
+        EXPECT_NEAR(fitted.T1[i], T1_true[i], 0.01f * T1_true[i]) << i;
+        EXPECT_NEAR(batched.T1[i], fitted.T1[i], 0.005f * fitted.T1[i]) << i;
+        EXPECT_NEAR(batched.A[i], fitted.A[i], 0.005f * fitted.A[i]) << i;
+    }
+}
@@ -1,5 +1,6 @@
 #include "t1fit.h"
 #include "HybridLM.h"
+#include "hoBatchLMSolver.h"
 #include "hoArmadillo.h"
 #include "hoNDArray_math.h"
 #include <vector>
@@ -72,11 +73,72 @@ template <class T> struct T1Residual_3param {
     }
 };
 
+// Models for the batched fits, y = A * (1 - 2 exp(-TI/T1)) with p = {T1, A}
+template <class T> struct T1Curve_2param {
+    static constexpr int num_params = 2;
+
+    T operator()(T TI, const T* p, T* grad) const {
+        T coeff = std::exp(-TI / p[0]);
+        grad[0] = -T(2) * p[1] * TI * coeff / (p[0] * p[0]);
+        grad[1] = T(1) - T(2) * coeff;
+        return p[1] * (T(1) - T(2) * coeff);
+    }
+};
+
+// y = A - B * exp(-TI/T1star) with p = {T1star, A, B}
+template <class T> struct T1starCurve_3param {
+    static constexpr int num_params = 3;
+
+    T operator()(T TI, const T* p, T* grad) const {
+        T coeff = std::exp(-TI / p[0]);
+        grad[0] = -p[2] * TI * coeff / (p[0] * p[0]);
+        grad[1] = T(1);
+        grad[2] = -coeff;
+        return p[1] - p[2] * coeff;
+    }
+};
+
+constexpr int fit_batch_size = 16;
+
+template <class Model> using BatchSolver = hoBatchLMSolver<float, Model, fit_batch_size>;
+
+/**
+ * Fits a batch of pixels stored pixel fastest; data is (TI, fit_batch_size), params (num_params, fit_batch_size)
+ * and holds the initial guess on input. As for a single pixel fit, pixels where the solver fails are set to NaN and
+ * pixels which did not converge are set to 0.
+ */
+template <class Model>
+void fit_T1_batch(BatchSolver<Model>& solver, const std::vector<float>& TI, const float* data, float* params, int num) {
+    hoBatchLMStatus status[fit_batch_size];
+    solver.solve(TI, data, params, status, num);
+
+    for (int l = 0; l < num; l++) {
+        for (int i = 0; i < Model::num_params; i++) {
+            switch (status[l]) {
+            case hoBatchLMStatus::LINEAR_SOLVER_FAILED:
+                params[i * fit_batch_size + l] = std::numeric_limits<float>::quiet_NaN();
+                break;
+            case hoBatchLMStatus::MAX_ITERATIONS_REACHED:
+                params[i * fit_batch_size + l] = 0;
+                break;
+            case hoBatchLMStatus::SUCCESS:
+                break;
+            }
+        }
+    }
+}
+
 struct T1_2param_value {
     float T1;
     float A;
 };
 
+struct T1_3param_value {
+    float T1;
+    float A;
+    float B;
+};
+
 template <class T> T1_2param_value fit_T1_2param_single(const std::vector<T>& TI, const std::vector<T>& data) {
 
     T A = *std::max_element(data.begin(), data.end()) - *std::min_element(data.begin(), data.end());
@@ -99,12 +161,6 @@ template <class T> T1_2param_value fit_T1_2param_single(const std::vector<T>& TI
     return {params[0], params[1]};
 }
 
-struct T1_3param_value {
-    float T1;
-    float A;
-    float B;
-};
-
 template <class T> T1_3param_value fit_T1_3param_single(const std::vector<T>& TI, const std::vector<T>& data) {
 
     T A = *std::max_element(data.begin(), data.end());
@@ -229,63 +285,294 @@ hoNDArray<float> Gadgetron::T1::predict_signal(const T1_3param& params, const st
     return result;
 }
 
-T1_2param Gadgetron::T1::fit_T1_2param(const hoNDArray<float>& data, const std::vector<float>& TI) {
+namespace {
 
-    if (data.get_size(2) != TI.size()) {
-        throw std::runtime_error("Data and TI do not match");
+void initial_guess_2param(const float* data, int num, size_t nTI, float* params) {
+    for (int l = 0; l < num; l++) {
+        float max_v = data[l], min_v = data[l];
+        for (size_t t = 1; t < nTI; t++) {
+            max_v = std::max(max_v, data[t * fit_batch_size + l]);
+            min_v = std::min(min_v, data[t * fit_batch_size + l]);
+        }
+        params[l] = 800;
+        params[fit_batch_size + l] = max_v - min_v;
+    }
+}
+
+void initial_guess_3param(const float* data, int num, size_t nTI, float* params) {
+    for (int l = 0; l < num; l++) {
+        float max_v = data[l], min_v = data[l];
+        for (size_t t = 1; t < nTI; t++) {
+            max_v = std::max(max_v, data[t * fit_batch_size + l]);
+            min_v = std::min(min_v, data[t * fit_batch_size + l]);
+        }
+        params[l] = 800;
+        params[fit_batch_size + l] = max_v;
+        params[2 * fit_batch_size + l] = max_v - min_v;
+    }
+}
+
+float calculate_residual(const T1_2param_value vals, const std::vector<float>& TI, const std::vector<float>& data) {
+    float result = 0;
+    for (int i = 0; i < (int)TI.size(); i++) {
+        auto diff = data[i] - vals.A * (1 - 2 * std::exp(-TI[i] / vals.T1));
+        result += diff * diff;
+    }
+    return std::sqrt(result);
+}
+
+float calculate_residual(const T1_3param_value vals, const std::vector<float>& TI, const std::vector<float>& data) {
+    float result = 0;
+    for (int i = 0; i < (int)TI.size(); i++) {
+        auto diff = data[i] - (vals.A - vals.B * std::exp(-TI[i] / vals.T1));
+        result += diff * diff;
     }
+    return std::sqrt(result);
+}
+
+// The fits of fit_T1_2param and fit_T1_3param with batch_fitting, solving fit_batch_size pixels of a row together
+T1_2param fit_T1_2param_batched(const hoNDArray<float>& data, const std::vector<float>& TI) {
 
     auto A = hoNDArray<float>({data.get_size(0), data.get_size(1)});
     auto T1 = A;
 
 #pragma omp parallel
     {
+        BatchSolver<T1Curve_2param<float>> solver;
+        std::vector<float> data_batch(TI.size() * fit_batch_size);
+        std::vector<float> params(2 * fit_batch_size);
+
+#pragma omp for
+        for (int y = 0; y < (int)data.get_size(1); y++) {
+            for (int x0 = 0; x0 < (int)data.get_size(0); x0 += fit_batch_size) {
+                int num = std::min(fit_batch_size, (int)data.get_size(0) - x0);
+
+                for (int t = 0; t < (int)TI.size(); t++) {
+                    for (int l = 0; l < num; l++) {
+                        data_batch[t * fit_batch_size + l] = data(x0 + l, y, t);
+                    }
+                }
+
+                initial_guess_2param(data_batch.data(), num, TI.size(), params.data());
+                fit_T1_batch(solver, TI, data_batch.data(), params.data(), num);
+
+                for (int l = 0; l < num; l++) {
+                    T1(x0 + l, y) = params[l];
+                    A(x0 + l, y) = params[fit_batch_size + l];
+                }
+            }
+        }
+    }
+    return {A, T1};
+}
+
+T1_2param fit_T1_2param_batched(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI) {
+
+    auto A = hoNDArray<float>(data.get_size(0), data.get_size(1));
+    auto T1 = A;
+
+#pragma omp parallel
+    {
+        BatchSolver<T1Curve_2param<float>> solver;
+        std::vector<float> data_batch(TI.size() * fit_batch_size);
+        std::vector<float> params(2 * fit_batch_size);
+
         std::vector<float> data_view(TI.size());
+        std::vector<float> residual(TI.size() * fit_batch_size);
+        std::vector<float> A_values(TI.size() * fit_batch_size);
+        std::vector<float> T1_values(TI.size() * fit_batch_size);
+
 #pragma omp for
         for (int y = 0; y < (int)data.get_size(1); y++) {
-            for (int x = 0; x < (int)data.get_size(0); x++) {
+            for (int x0 = 0; x0 < (int)data.get_size(0); x0 += fit_batch_size) {
+                int num = std::min(fit_batch_size, (int)data.get_size(0) - x0);
+
                 for (int t = 0; t < (int)TI.size(); t++) {
-                    data_view[t] = data(x, y, t);
+                    for (int l = 0; l < num; l++) {
+                        data_batch[t * fit_batch_size + l] = std::abs(data(x0 + l, y, t));
+                    }
                 }
 
-                auto result = fit_T1_2param_single<float>(TI, data_view);
+                // try every inversion point; the points before it get a negative sign
+                for (int t = 0; t < (int)TI.size(); t++) {
+                    for (int k = 0; k < t; k++) {
+                        for (int l = 0; l < num; l++) {
+                            data_batch[k * fit_batch_size + l] = -std::abs(data_batch[k * fit_batch_size + l]);
+                        }
+                    }
 
-                A(x, y) = result.A;
-                T1(x, y) = result.T1;
+                    initial_guess_2param(data_batch.data(), num, TI.size(), params.data());
+                    fit_T1_batch(solver, TI, data_batch.data(), params.data(), num);
+
+                    for (int l = 0; l < num; l++) {
+                        for (int k = 0; k < (int)TI.size(); k++) {
+                            data_view[k] = data_batch[k * fit_batch_size + l];
+                        }
+
+                        T1_2param_value result{params[l], params[fit_batch_size + l]};
+                        T1_values[l * TI.size() + t] = result.T1;
+                        A_values[l * TI.size() + t] = result.A;
+                        residual[l * TI.size() + t] = calculate_residual(result, TI, data_view);
+                    }
+                }
+
+                for (int l = 0; l < num; l++) {
+                    auto residual_l = residual.begin() + l * TI.size();
+                    auto smallest_residual_index =
+                        l * TI.size() + (std::min_element(residual_l, residual_l + TI.size()) - residual_l);
+                    A(x0 + l, y) = A_values[smallest_residual_index];
+                    T1(x0 + l, y) = T1_values[smallest_residual_index];
+                }
             }
         }
     }
     return {A, T1};
 }
 
-namespace {
+T1_3param fit_T1_3param_batched(const hoNDArray<float>& data, const std::vector<float>& TI) {
 
-float calculate_residual(const T1_2param_value vals, const std::vector<float>& TI, const std::vector<float>& data) {
-    float result = 0;
-    for (int i = 0; i < (int)TI.size(); i++) {
-        auto diff = data[i] - vals.A * (1 - 2 * std::exp(-TI[i] / vals.T1));
-        result += diff * diff;
+    auto A = hoNDArray<float>({data.get_size(0), data.get_size(1)});
+    auto B = hoNDArray<float>({data.get_size(0), data.get_size(1)});
+    auto T1 = hoNDArray<float>({data.get_size(0), data.get_size(1)});
+
+#pragma omp parallel
+    {
+        BatchSolver<T1starCurve_3param<float>> solver;
+        std::vector<float> data_batch(TI.size() * fit_batch_size);
+        std::vector<float> params(3 * fit_batch_size);
+
+#pragma omp for
+        for (int y = 0; y < (int)data.get_size(1); y++) {
+            for (int x0 = 0; x0 < (int)data.get_size(0); x0 += fit_batch_size) {
+                int num = std::min(fit_batch_size, (int)data.get_size(0) - x0);
+
+                for (int t = 0; t < (int)TI.size(); t++) {
+                    for (int l = 0; l < num; l++) {
+                        data_batch[t * fit_batch_size + l] = data(x0 + l, y, t);
+                    }
+                }
+
+                initial_guess_3param(data_batch.data(), num, TI.size(), params.data());
+                fit_T1_batch(solver, TI, data_batch.data(), params.data(), num);
+
+                for (int l = 0; l < num; l++) {
+                    T1(x0 + l, y) = params[l];
+                    A(x0 + l, y) = params[fit_batch_size + l];
+                    B(x0 + l, y) = params[2 * fit_batch_size + l];
+                }
+            }
+        }
     }
-    return std::sqrt(result);
+    return {A, B, T1};
 }
+T1_3param fit_T1_3param_batched(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI) {
 
-float calculate_residual(const T1_3param_value vals, const std::vector<float>& TI, const std::vector<float>& data) {
-    float result = 0;
-    for (int i = 0; i < (int)TI.size(); i++) {
-        auto diff = data[i] - (vals.A - vals.B * std::exp(-TI[i] / vals.T1));
-        result += diff * diff;
+    auto A = hoNDArray<float>(data.get_size(0), data.get_size(1));
+    auto B = A;
+    auto T1 = A;
+
+#pragma omp parallel
+    {
+        BatchSolver<T1starCurve_3param<float>> solver;
+        std::vector<float> data_batch(TI.size() * fit_batch_size);
+        std::vector<float> params(3 * fit_batch_size);
+
+        std::vector<float> data_view(TI.size());
+        std::vector<float> residual(TI.size() * fit_batch_size);
+        std::vector<float> A_values(TI.size() * fit_batch_size);
+        std::vector<float> B_values(TI.size() * fit_batch_size);
+        std::vector<float> T1_values(TI.size() * fit_batch_size);
+
+#pragma omp for
+        for (int y = 0; y < (int)data.get_size(1); y++) {
+            for (int x0 = 0; x0 < (int)data.get_size(0); x0 += fit_batch_size) {
+                int num = std::min(fit_batch_size, (int)data.get_size(0) - x0);
+
+                for (int t = 0; t < (int)TI.size(); t++) {
+                    for (int l = 0; l < num; l++) {
+                        data_batch[t * fit_batch_size + l] = std::abs(data(x0 + l, y, t));
+                    }
+                }
+
+                // try every inversion point; the points before it get a negative sign
+                for (int t = 0; t < (int)TI.size(); t++) {
+                    for (int k = 0; k < t; k++) {
+                        for (int l = 0; l < num; l++) {
+                            data_batch[k * fit_batch_size + l] = -std::abs(data_batch[k * fit_batch_size + l]);
+                        }
+                    }
+
+                    initial_guess_3param(data_batch.data(), num, TI.size(), params.data());
+                    fit_T1_batch(solver, TI, data_batch.data(), params.data(), num);
+
+                    for (int l = 0; l < num; l++) {
+                        for (int k = 0; k < (int)TI.size(); k++) {
+                            data_view[k] = data_batch[k * fit_batch_size + l];
+                        }
+
+                        T1_3param_value result{params[l], params[fit_batch_size + l], params[2 * fit_batch_size + l]};
+                        T1_values[l * TI.size() + t] = result.T1;
+                        A_values[l * TI.size() + t] = result.A;
+                        B_values[l * TI.size() + t] = result.B;
+                        residual[l * TI.size() + t] = calculate_residual(result, TI, data_view);
+                    }
+                }
+
+                for (int l = 0; l < num; l++) {
+                    auto residual_l = residual.begin() + l * TI.size();
+                    auto smallest_residual_index =
+                        l * TI.size() + (std::min_element(residual_l, residual_l + TI.size()) - residual_l);
+                    A(x0 + l, y) = A_values[smallest_residual_index];
+                    B(x0 + l, y) = B_values[smallest_residual_index];
+                    T1(x0 + l, y) = T1_values[smallest_residual_index];
+                }
+            }
+        }
     }
-    return std::sqrt(result);
+    return {A, B, T1};
 }
 
 } // namespace
 
-T1_2param Gadgetron::T1::fit_T1_2param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI) {
+T1_2param Gadgetron::T1::fit_T1_2param(const hoNDArray<float>& data, const std::vector<float>& TI, bool batch_fitting) {
 
     if (data.get_size(2) != TI.size()) {
         throw std::runtime_error("Data and TI do not match");
     }
 
+    if (batch_fitting) return fit_T1_2param_batched(data, TI);
+
+    auto A = hoNDArray<float>({data.get_size(0), data.get_size(1)});
+    auto T1 = A;
+
+#pragma omp parallel
+    {
+        std::vector<float> data_view(TI.size());
+#pragma omp for
+        for (int y = 0; y < (int)data.get_size(1); y++) {
+            for (int x = 0; x < (int)data.get_size(0); x++) {
+                for (int t = 0; t < (int)TI.size(); t++) {
+                    data_view[t] = data(x, y, t);
+                }
+
+                auto result = fit_T1_2param_single<float>(TI, data_view);
+
+                A(x, y) = result.A;
+                T1(x, y) = result.T1;
+            }
+        }
+    }
+    return {A, T1};
+}
+
+T1_2param Gadgetron::T1::fit_T1_2param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI, bool batch_fitting) {
+
+    if (data.get_size(2) != TI.size()) {
+        throw std::runtime_error("Data and TI do not match");
+    }
+
+    if (batch_fitting) return fit_T1_2param_batched(data, TI);
+
     auto A = hoNDArray<float>(data.get_size(0), data.get_size(1));
     auto T1 = A;
 
@@ -322,12 +609,14 @@ T1_2param Gadgetron::T1::fit_T1_2param(const hoNDArray<std::complex<float>>& dat
     return {A, T1};
 }
 
-T1_3param Gadgetron::T1::fit_T1_3param(const hoNDArray<float>& data, const std::vector<float>& TI) {
+T1_3param Gadgetron::T1::fit_T1_3param(const hoNDArray<float>& data, const std::vector<float>& TI, bool batch_fitting) {
 
     if (data.get_size(2) != TI.size()) {
         throw std::runtime_error("Data and TI do not match");
     }
 
+    if (batch_fitting) return fit_T1_3param_batched(data, TI);
+
     auto A = hoNDArray<float>({data.get_size(0), data.get_size(1)});
     auto B = hoNDArray<float>({data.get_size(0), data.get_size(1)});
     auto T1 = hoNDArray<float>({data.get_size(0), data.get_size(1)});
@@ -352,12 +641,15 @@ T1_3param Gadgetron::T1::fit_T1_3param(const hoNDArray<float>& data, const std::
     }
     return {A, B, T1};
 }
-T1_3param Gadgetron::T1::fit_T1_3param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI) {
+
+T1_3param Gadgetron::T1::fit_T1_3param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI, bool batch_fitting) {
 
     if (data.get_size(2) != TI.size()) {
         throw std::runtime_error("Data and TI do not match");
     }
 
+    if (batch_fitting) return fit_T1_3param_batched(data, TI);
+
     auto A = hoNDArray<float>(data.get_size(0), data.get_size(1));
     auto B = A;
     auto T1 = A;
@@ -397,6 +689,7 @@ T1_3param Gadgetron::T1::fit_T1_3param(const hoNDArray<std::complex<float>>& dat
     }
     return {A, B, T1};
 }
+
 hoNDArray<float> Gadgetron::T1::phase_correct(const hoNDArray<std::complex<float>>& data,
                                               const std::vector<float>& TI) {
 
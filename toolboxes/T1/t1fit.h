@@ -22,26 +22,30 @@ struct T1_3param {
  * Fits a T1 map using the 2 parameter model
  * @param data Data of shape (X,Y,TI)
  * @param TI Inversion times
+ * @param batch_fitting Fit the pixels in batches with the batched Levenberg-Marquardt solver, instead of one by one
+ * with the hybrid Levenberg-Marquardt solver. Its stopping criteria differ, so the maps are close but not identical.
  * @return Magnitude (A) and T1 mapping
  */
-T1_2param fit_T1_2param(const hoNDArray<float>& data, const std::vector<float>& TI);
+T1_2param fit_T1_2param(const hoNDArray<float>& data, const std::vector<float>& TI, bool batch_fitting = false);
 
 /**
  * Fits a T1 map using the 2 parameter model, and calculates the sign by trying all combinations
  * @param data Data of shape (X,Y,TI)
  * @param TI Inversion times
+ * @param batch_fitting Fit the pixels in batches, see above
  * @return Magnitude (A) and T1 mapping
  */
-T1_2param fit_T1_2param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI);
+T1_2param fit_T1_2param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI, bool batch_fitting = false);
 
 /**
  * Fits a T1 map using the 2 parameter model
  * @param data Data of shape (X,Y,TI)
  * @param TI Inversion times
+ * @param batch_fitting Fit the pixels in batches, see above
  * @return Magnitude (A), inverse magnitude (B) and T1 mapping
  */
-T1_3param fit_T1_3param(const hoNDArray<float>& data, const std::vector<float>& TI);
-T1_3param fit_T1_3param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI);
+T1_3param fit_T1_3param(const hoNDArray<float>& data, const std::vector<float>& TI, bool batch_fitting = false);
+T1_3param fit_T1_3param(const hoNDArray<std::complex<float>>& data, const std::vector<float>& TI, bool batch_fitting = false);
 
 
 hoNDArray<float> calculate_error_map(const T1_3param& params, const hoNDArray<float>& data, const std::vector<float>& TI);
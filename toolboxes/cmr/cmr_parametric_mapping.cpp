@@ -17,9 +17,16 @@
 #include "hoNDBSpline.h"
 
 #include "hoNDArray_linalg.h"
+#include "OmpExceptions.h"
 
 #include <boost/math/special_functions/sign.hpp>
 
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <typeinfo>
+
 namespace Gadgetron { 
 
 template <typename T>
@@ -192,6 +199,13 @@ CmrParametricMapping<T>::CmrParametricMapping()
     max_map_value_ = -1;
     min_map_value_ = 0;
 
+    use_batch_fitting_ = false;
+
+    use_dictionary_matching_ = false;
+    refine_dictionary_match_ = false;
+    dictionary_size_ = 500;
+    dictionary_min_map_value_ = 1;
+
     verbose_ = false;
     perform_timing_ = false;
 
@@ -260,6 +274,20 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
             if (!debug_folder_.empty()) gt_exporter_.export_array(this->mask_for_mapping_, debug_folder_ + "CmrParametricMapping_mask_for_mapping");
         }
 
+        std::shared_ptr<const Dictionary> dict;
+        bool use_dictionary = false;
+        if (this->use_dictionary_matching_)
+        {
+            if (this->perform_timing_) { gt_timer_.start("get dictionary for mapping ... "); }
+            use_dictionary = this->get_dictionary(ti_, dict);
+            if (this->perform_timing_) { gt_timer_.stop(); }
+
+            if (!use_dictionary)
+            {
+                GWARN_STREAM("Dictionary matching is not supported for this mapping, pixels are fitted instead ... ");
+            }
+        }
+
         if (this->perform_timing_) { gt_timer_.start("perform pixel-wise mapping ... "); }
 
         long long ro, e1;
@@ -287,72 +315,206 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
                     pMaskCurr = pMask + s*RO*E1 + slc*S*RO*E1;
                 }
 
-#pragma omp parallel private(e1, ro, n) shared(RO, E1, pMask, pMaskCurr, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM)
+                // the matched parameters are kept in pPara and serve as the initial guess of the fitting
+                if (use_dictionary)
                 {
-                    std::vector<T> yi(num_ti, 0);
-                    std::vector<T> guess(NUM + 1, 0);
-                    std::vector<T> bi(NUM + 1, 0);
-                    std::vector<T> sd(NUM + 1, 0);
+                    this->match_dictionary(ti_, *dict, pData, pMaskCurr, RO*E1, pPara);
+                }
 
-                    T map_v(0), map_sd(0);
+                if (this->use_batch_fitting_ || use_dictionary)
+                {
+                    OmpExceptions errors;
 
-#pragma omp for 
-                    for (e1 = 0; e1 < E1; e1++)
+#pragma omp parallel private(e1, ro, n) shared(RO, E1, pMask, pMaskCurr, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM, use_dictionary, errors)
                     {
-                        for (ro = 0; ro < RO; ro++)
-                        {
-                            long long offset = ro + e1*RO;
+                        const size_t B = batch_size;
+
+                        std::vector<T> yi(num_ti, 0);
+                        std::vector<T> guess(NUM, 0);
+                        std::vector<T> bi(NUM, 0);
+                        std::vector<T> sd(NUM, 0);
 
-                            if (pMask != NULL)
+                        // a batch of pixels, pixels fastest
+                        std::vector<T> yi_batch(num_ti*B, 0);
+                        std::vector<T> guess_batch(NUM*B, 0);
+                        std::vector<T> bi_batch(NUM*B, 0);
+                        std::vector<T> map_batch(B, 0);
+                        std::vector<long long> offset_batch(B, 0);
+                        size_t num_batch = 0;
+
+                        T map_sd(0);
+
+                        auto fit_batch = [&]()
+                        {
+                            if (use_dictionary && !this->refine_dictionary_match_)
                             {
-                                if (pMaskCurr[offset] <= 0)
-                                    continue;
+                                this->compute_map_from_dictionary_match(&guess_batch[0], num_batch, &bi_batch[0], &map_batch[0]);
                             }
-
-                            // get data vector
-                            for (n = 0; n < num_ti; n++)
+                            else
                             {
-                                yi[n] = pData[offset + n*RO*E1];
+                                this->compute_map_batch(ti_, &yi_batch[0], &guess_batch[0], num_batch, &bi_batch[0], &map_batch[0]);
                             }
 
-                            // estimate initial para
-                            this->get_initial_guess(ti_, yi, guess);
+                            for (size_t b = 0; b < num_batch; b++)
+                            {
+                                long long offset = offset_batch[b];
 
-                            // perform mapping
-                            this->compute_map(ti_, yi, guess, bi, map_v);
+                                pMap[offset] = map_batch[b];
+                                for (size_t p = 0; p < NUM; p++)
+                                {
+                                    bi[p] = bi_batch[p*B + b];
+                                    pPara[offset + p*RO*E1] = bi[p];
+                                }
 
-                            pMap[offset] = map_v;
-                            for (n = 0; n < NUM; n++)
-                            {
-                                pPara[offset + n*RO*E1] = bi[n];
+                                // compute SD if needed
+                                if (this->compute_SD_maps_)
+                                {
+                                    for (size_t t = 0; t < num_ti; t++)
+                                    {
+                                        yi[t] = yi_batch[t*B + b];
+                                    }
+
+                                    try
+                                    {
+                                        this->compute_sd(ti_, yi, bi, sd, map_sd);
+                                    }
+                                    catch (...)
+                                    {
+                                        std::fill(sd.begin(), sd.end(), T(0));
+                                        map_sd = 0;
+                                    }
+
+                                    pMapSD[offset] = map_sd;
+                                    for (size_t p = 0; p < NUM; p++)
+                                    {
+                                        pParaSD[offset + p*RO*E1] = sd[p];
+                                    }
+                                }
                             }
 
-                            // compute SD if needed
-                            if (this->compute_SD_maps_)
+                            num_batch = 0;
+                        };
+
+#pragma omp for 
+                        for (e1 = 0; e1 < E1; e1++)
+                        {
+                            errors.run([&]()
                             {
-                                try
-                                {
-                                    this->compute_sd(ti_, yi, bi, sd, map_sd);
-                                }
-                                catch(...)
+                                for (ro = 0; ro < RO; ro++)
                                 {
-                                    for (n = 0; n < NUM; n++)
+                                    long long offset = ro + e1*RO;
+
+                                    if (pMask != NULL)
+                                    {
+                                        if (pMaskCurr[offset] <= 0)
+                                            continue;
+                                    }
+
+                                    // get data vector and initial guess
+                                    for (n = 0; n < num_ti; n++)
+                                    {
+                                        yi[n] = pData[offset + n*RO*E1];
+                                        yi_batch[n*B + num_batch] = yi[n];
+                                    }
+
+                                    if (use_dictionary)
                                     {
-                                        sd[n] = 0;
+                                        for (n = 0; n < NUM; n++)
+                                        {
+                                            guess_batch[n*B + num_batch] = pPara[offset + n*RO*E1];
+                                        }
+                                    }
+                                    else
+                                    {
+                                        this->get_initial_guess(ti_, yi, guess);
+                                        for (n = 0; n < NUM; n++)
+                                        {
+                                            guess_batch[n*B + num_batch] = guess[n];
+                                        }
                                     }
 
-                                    map_sd = 0;
+                                    offset_batch[num_batch++] = offset;
+
+                                    if (num_batch == B) fit_batch();
                                 }
+                            });
+                        }
 
-                                pMapSD[offset] = map_sd;
+                        // pixels left over by this thread
+                        if (num_batch > 0) errors.run(fit_batch);
+                    } // openmp
+
+                    errors.rethrow();
+                }
+                else
+                {
+#pragma omp parallel private(e1, ro, n) shared(RO, E1, pMask, pMaskCurr, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM)
+                    {
+                        std::vector<T> yi(num_ti, 0);
+                        std::vector<T> guess(NUM + 1, 0);
+                        std::vector<T> bi(NUM + 1, 0);
+                        std::vector<T> sd(NUM + 1, 0);
+
+                        T map_v(0), map_sd(0);
+
+#pragma omp for 
+                        for (e1 = 0; e1 < E1; e1++)
+                        {
+                            for (ro = 0; ro < RO; ro++)
+                            {
+                                long long offset = ro + e1*RO;
+
+                                if (pMask != NULL)
+                                {
+                                    if (pMaskCurr[offset] <= 0)
+                                        continue;
+                                }
+
+                                // get data vector
+                                for (n = 0; n < num_ti; n++)
+                                {
+                                    yi[n] = pData[offset + n*RO*E1];
+                                }
+
+                                // estimate initial para
+                                this->get_initial_guess(ti_, yi, guess);
+
+                                // perform mapping
+                                this->compute_map(ti_, yi, guess, bi, map_v);
+
+                                pMap[offset] = map_v;
                                 for (n = 0; n < NUM; n++)
                                 {
-                                    pParaSD[offset + n*RO*E1] = sd[n];
+                                    pPara[offset + n*RO*E1] = bi[n];
+                                }
+
+                                // compute SD if needed
+                                if (this->compute_SD_maps_)
+                                {
+                                    try
+                                    {
+                                        this->compute_sd(ti_, yi, bi, sd, map_sd);
+                                    }
+                                    catch(...)
+                                    {
+                                        for (n = 0; n < NUM; n++)
+                                        {
+                                            sd[n] = 0;
+                                        }
+
+                                        map_sd = 0;
+                                    }
+
+                                    pMapSD[offset] = map_sd;
+                                    for (n = 0; n < NUM; n++)
+                                    {
+                                        pParaSD[offset + n*RO*E1] = sd[n];
+                                    }
                                 }
                             }
                         }
-                    }
-                } // openmp
+                    } // openmp
+                }
             }
         }
 
@@ -437,6 +599,243 @@ void CmrParametricMapping<T>::compute_map(const std::vector<T>& ti, const std::v
     map_v = 0;
 }
 
+template <typename T>
+void CmrParametricMapping<T>::compute_map_batch(const VectorType& ti, const T* yi, const T* guess, size_t num, T* bi, T* map_v)
+{
+    const size_t B = batch_size;
+    size_t num_ti = ti.size();
+    size_t NUM = this->get_num_of_paras();
+
+    VectorType y(num_ti), g(NUM), b(NUM);
+
+    size_t p, n;
+    for (p = 0; p < num; p++)
+    {
+        for (n = 0; n < num_ti; n++) y[n] = yi[n*B + p];
+        for (n = 0; n < NUM; n++) g[n] = guess[n*B + p];
+
+        this->compute_map(ti, y, g, b, map_v[p]);
+
+        for (n = 0; n < NUM; n++) bi[n*B + p] = b[n];
+    }
+}
+
+template <typename T>
+bool CmrParametricMapping<T>::get_dictionary_signal(const VectorType& ti, T map_v, VectorType& s) const
+{
+    return false;
+}
+
+template <typename T>
+bool CmrParametricMapping<T>::get_dictionary(const VectorType& ti, std::shared_ptr<const Dictionary>& dict)
+{
+    try
+    {
+        size_t K = this->dictionary_size_;
+        T min_v = this->dictionary_min_map_value_;
+        T max_v = this->max_map_value_;
+
+        VectorType s;
+        if (this->get_num_of_paras() != 2 || ti.empty() || K < 2 || min_v <= 0 || max_v <= min_v) return false;
+        if (!this->get_dictionary_signal(ti, max_v, s)) return false;
+
+        // dictionaries are shared by all mapping objects, as the same ti are used for every series of a protocol
+        // the least recently used one is dropped when the cache is full
+        typedef std::tuple<std::string, VectorType, size_t, T, T> KeyType;
+        typedef std::list<KeyType> UsageList;
+        static UsageList usage;
+        static std::map< KeyType, std::pair< std::shared_ptr<const Dictionary>, typename UsageList::iterator > > cache;
+        static std::mutex cache_mutex;
+        const size_t max_cache_size = 32;
+
+        KeyType key(typeid(*this).name(), ti, K, min_v, max_v);
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+
+        auto iter = cache.find(key);
+        if (iter != cache.end())
+        {
+            usage.splice(usage.begin(), usage, iter->second.second);
+            dict = iter->second.first;
+            return true;
+        }
+
+        size_t num_ti = ti.size();
+
+        std::shared_ptr<Dictionary> d(new Dictionary());
+        d->atoms.create(num_ti, K);
+        d->map_values.resize(K);
+        d->norms.resize(K);
+
+        T r = std::log(max_v / min_v) / (T)(K - 1);
+
+        size_t k, n;
+        for (k = 0; k < K; k++)
+        {
+            T map_v = (k == K - 1) ? max_v : min_v * std::exp(r*k);
+            this->get_dictionary_signal(ti, map_v, s);
+
+            T v(0);
+            for (n = 0; n < num_ti; n++) v += s[n] * s[n];
+            v = std::sqrt(v);
+
+            T* pAtom = d->atoms.begin() + k*num_ti;
+            for (n = 0; n < num_ti; n++) pAtom[n] = (v > 0) ? s[n] / v : 0;
+
+            d->map_values[k] = map_v;
+            d->norms[k] = v;
+        }
+
+        if (cache.size() >= max_cache_size)
+        {
+            cache.erase(usage.back());
+            usage.pop_back();
+        }
+
+        usage.push_front(key);
+        cache[key] = std::make_pair(std::shared_ptr<const Dictionary>(d), usage.begin());
+
+        dict = d;
+        return true;
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in CmrParametricMapping<T>::get_dictionary(...) ... ");
+    }
+}
+
+template <typename T>
+void CmrParametricMapping<T>::match_dictionary(const VectorType& ti, const Dictionary& dict, const T* data, const T* mask, size_t num, T* guess)
+{
+    try
+    {
+        size_t num_ti = dict.atoms.get_size(0);
+        size_t K = dict.atoms.get_size(1);
+
+        GADGET_CHECK_THROW(num_ti == ti.size());
+
+        std::vector<size_t> ind;
+        ind.reserve(num);
+
+        size_t p;
+        for (p = 0; p < num; p++)
+        {
+            if (mask == NULL || mask[p] > 0) ind.push_back(p);
+        }
+
+        const size_t L = dictionary_block_size;
+
+        hoNDArray<T> y_buf(num_ti*std::min(L, ind.size())), c_buf(K*std::min(L, ind.size()));
+
+        long long i;
+
+        OmpExceptions errors;
+
+        size_t start;
+        for (start = 0; start < ind.size(); start += L)
+        {
+            size_t nb = std::min(L, ind.size() - start);
+
+            // [num_ti nb] pixels and [K nb] inner products with every atom
+            hoNDArray<T> Y(num_ti, nb, y_buf.begin(), false);
+            hoNDArray<T> C(K, nb, c_buf.begin(), false);
+
+            size_t j, n, k;
+            for (j = 0; j < nb; j++)
+            {
+                for (n = 0; n < num_ti; n++)
+                {
+                    Y(n, j) = data[ind[start + j] + n*num];
+                }
+            }
+
+            // the gemm is called outside the parallel region, so the BLAS is free to use its own threads
+            Gadgetron::gemm(C, dict.atoms, true, Y, false);
+
+#pragma omp parallel private(i, n, k) shared(num_ti, K, ind, start, nb, num, guess, Y, C, errors)
+            {
+                VectorType yi(num_ti), g(2);
+
+#pragma omp for 
+                for (i = 0; i < (long long)nb; i++)
+                {
+                    errors.run([&]()
+                    {
+                        const T* pC = C.begin() + i*K;
+
+                        size_t best = 0;
+                        for (k = 1; k < K; k++)
+                        {
+                            if (pC[k] > pC[best]) best = k;
+                        }
+
+                        size_t offset = ind[start + i];
+
+                        if (pC[best] > 0 && dict.norms[best] > 0)
+                        {
+                            T c = pC[best];
+                            T norm = dict.norms[best];
+                            T map_v = dict.map_values[best];
+
+                            // parabolic interpolation of the peak over the log-spaced map values
+                            if (best > 0 && best < K - 1)
+                            {
+                                T cm = pC[best - 1];
+                                T cp = pC[best + 1];
+                                T d = cm - 2 * c + cp;
+                                if (d < 0)
+                                {
+                                    T delta = (cm - cp) / (2 * d);
+                                    c -= (cm - cp) * delta / 4;
+                                    norm += delta * (dict.norms[best + 1] - dict.norms[best - 1]) / 2;
+                                    map_v *= std::exp(delta * std::log(dict.map_values[best + 1] / dict.map_values[best - 1]) / 2);
+                                }
+                            }
+
+                            guess[offset] = c / norm;
+                            guess[offset + num] = map_v;
+                        }
+                        else
+                        {
+                            for (n = 0; n < num_ti; n++) yi[n] = Y(n, i);
+                            this->get_initial_guess(ti, yi, g);
+                            guess[offset] = g[0];
+                            guess[offset + num] = g[1];
+                        }
+                    });
+                }
+            }
+
+            errors.rethrow();
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in CmrParametricMapping<T>::match_dictionary(...) ... ");
+    }
+}
+
+template <typename T>
+void CmrParametricMapping<T>::compute_map_from_dictionary_match(const T* guess, size_t num, T* bi, T* map_v)
+{
+    const size_t B = batch_size;
+
+    memcpy(bi, guess, sizeof(T) * 2 * B);
+
+    size_t p;
+    for (p = 0; p < num; p++)
+    {
+        map_v[p] = 0;
+
+        if (bi[p] > 0 && bi[B + p] > 0)
+        {
+            map_v[p] = bi[B + p];
+            if (map_v[p] >= max_map_value_) map_v[p] = hole_marking_value_;
+            if (map_v[p] <= min_map_value_) map_v[p] = hole_marking_value_;
+        }
+    }
+}
+
 template <typename T>
 void CmrParametricMapping<T>::compute_sd(const std::vector<T>& ti, const std::vector<T>& yi, const std::vector<T>& bi, std::vector<T>& sd, T& map_sd)
 {
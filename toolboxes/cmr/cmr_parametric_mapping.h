@@ -18,6 +18,8 @@
 #include "hoNDImageContainer2D.h"
 #include "hoMRImage.h"
 
+#include <memory>
+
 namespace Gadgetron { 
 
     /// map: the 2D map for hole filling; holes is marked by value 'hole'
@@ -106,6 +108,39 @@ namespace Gadgetron {
         T max_map_value_;
         T min_map_value_;
 
+        /// whether to fit the pixels in batches with compute_map_batch(...)
+        /// if false, every pixel is fitted on its own with compute_map(...)
+        bool use_batch_fitting_;
+
+        /// number of pixels fitted together by compute_map_batch(...)
+        static constexpr size_t batch_size = 16;
+
+        /// whether to match every pixel against a precomputed dictionary of the signal model
+        /// only models y = A * s(ti; map) with the parameters {A, map} support it, see get_dictionary_signal(...)
+        /// the dictionary is computed once per set of ti and kept for later calls
+        bool use_dictionary_matching_;
+        /// whether to refine the matched parameters with compute_map_batch(...)
+        /// if false, the matched parameters, interpolated between the neighbouring entries, are the result
+        bool refine_dictionary_match_;
+        /// number of dictionary entries, log-spaced between dictionary_min_map_value_ and max_map_value_
+        size_t dictionary_size_;
+        /// smallest map value in the dictionary
+        T dictionary_min_map_value_;
+
+        /// number of pixels matched together in one gemm, the gemm of a block is multi-threaded by the BLAS
+        static constexpr size_t dictionary_block_size = 4096;
+
+        /// signals of unit amplitude for every map value of the dictionary
+        struct Dictionary
+        {
+            /// [ti.size() K], normalised signals
+            hoNDArray<T> atoms;
+            /// [K], map value of every atom
+            VectorType map_values;
+            /// [K], norm of every signal before normalisation
+            VectorType norms;
+        };
+
         // ======================================================================================
         /// parameter for debugging
         // ======================================================================================
@@ -134,6 +169,27 @@ namespace Gadgetron {
         /// compute map values for every parameters in bi
         virtual void compute_map(const VectorType& ti, const VectorType& yi, const VectorType& guess, VectorType& bi, T& map_v);
 
+        /// compute map values for a batch of num <= batch_size pixels
+        /// yi: [ti.size() batch_size], guess and bi: [NUM batch_size], map_v: [batch_size], pixels fastest
+        /// the default implementation calls compute_map(...) for every pixel
+        virtual void compute_map_batch(const VectorType& ti, const T* yi, const T* guess, size_t num, T* bi, T* map_v);
+
+        /// signal of unit amplitude at ti for the map value map_v, s(ti; map_v)
+        /// return false if the model does not support dictionary matching; the default implementation returns false
+        virtual bool get_dictionary_signal(const VectorType& ti, T map_v, VectorType& s) const;
+
+        /// get the dictionary for ti; it is computed on the first call and shared afterwards
+        /// return false if the model does not support dictionary matching
+        virtual bool get_dictionary(const VectorType& ti, std::shared_ptr<const Dictionary>& dict);
+
+        /// match num pixels of data [num ti.size()] against the dictionary, pixels with mask <= 0 are skipped
+        /// the matched {A, map} is stored in guess [num 2]; pixels matching no entry get the initial guess
+        virtual void match_dictionary(const VectorType& ti, const Dictionary& dict, const T* data, const T* mask, size_t num, T* guess);
+
+        /// compute map values for a batch of matched parameters, without refinement
+        /// same layout as compute_map_batch(...)
+        virtual void compute_map_from_dictionary_match(const T* guess, size_t num, T* bi, T* map_v);
+
         /// compute SD values for every parameters in bi
         virtual void compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd);
 
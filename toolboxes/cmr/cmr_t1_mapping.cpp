@@ -11,6 +11,7 @@
 #include "hoNDArray_math.h"
 
 #include "simplexLagariaSolver.h"
+#include "hoBatchLMSolver.h"
 #include "twoParaExpRecoveryOperator.h"
 #include "curveFittingCostFunction.h"
 
@@ -18,6 +19,21 @@
 
 namespace Gadgetron { 
 
+// y = A * ( 1-exp(-ti/T1) ), p = {A, T1}
+template <typename T>
+struct T1SRCurveModel
+{
+    static constexpr int num_params = 2;
+
+    T operator()(T x, const T* p, T* grad) const
+    {
+        T e = std::exp(-x / p[1]);
+        grad[0] = 1 - e;
+        grad[1] = -p[0] * e * x / (p[1] * p[1]);
+        return p[0] * (1 - e);
+    }
+};
+
 template <typename T> 
 CmrT1SRMapping<T>::CmrT1SRMapping() : BaseClass()
 {
@@ -97,6 +113,53 @@ void CmrT1SRMapping<T>::compute_map(const VectorType& ti, const VectorType& yi,
     }
 }
 
+template <typename T>
+void CmrT1SRMapping<T>::compute_map_batch(const VectorType& ti, const T* yi, const T* guess, size_t num, T* bi, T* map_v)
+{
+    try
+    {
+        const size_t B = BaseClass::batch_size;
+        size_t NUM = this->get_num_of_paras();
+
+        Gadgetron::hoBatchLMSolver< T, T1SRCurveModel<T>, (int)BaseClass::batch_size > solver;
+        solver.max_iter_ = max_iter_;
+
+        memcpy(bi, guess, sizeof(T)*NUM*B);
+        solver.solve(ti, yi, bi, NULL, (int)num);
+
+        size_t p;
+        for (p = 0; p < num; p++)
+        {
+            map_v[p] = 0;
+
+            if (bi[p] > 0 && bi[B + p] > 0)
+            {
+                map_v[p] = bi[B + p];
+                if (map_v[p] >= max_map_value_) map_v[p] = hole_marking_value_;
+                if (map_v[p] <= min_map_value_) map_v[p] = hole_marking_value_;
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in CmrT1SRMapping<T>::compute_map_batch(...) ... ");
+    }
+}
+
+template <typename T>
+bool CmrT1SRMapping<T>::get_dictionary_signal(const VectorType& ti, T map_v, VectorType& s) const
+{
+    s.resize(ti.size());
+
+    size_t n;
+    for (n = 0; n < ti.size(); n++)
+    {
+        s[n] = 1 - std::exp(-ti[n] / map_v);
+    }
+
+    return true;
+}
+
 template <typename T>
 void CmrT1SRMapping<T>::compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd)
 {
@@ -12,6 +12,7 @@
 #include "hoNDArray_linalg.h"
 
 #include "simplexLagariaSolver.h"
+#include "hoBatchLMSolver.h"
 #include "twoParaExpDecayOperator.h"
 #include "curveFittingCostFunction.h"
 
@@ -19,6 +20,21 @@
 
 namespace Gadgetron { 
 
+// y = A * exp(-ti/T2), p = {A, T2}
+template <typename T>
+struct T2CurveModel
+{
+    static constexpr int num_params = 2;
+
+    T operator()(T x, const T* p, T* grad) const
+    {
+        T e = std::exp(-x / p[1]);
+        grad[0] = e;
+        grad[1] = p[0] * e * x / (p[1] * p[1]);
+        return p[0] * e;
+    }
+};
+
 template <typename T> 
 CmrT2Mapping<T>::CmrT2Mapping() : BaseClass()
 {
@@ -134,6 +150,53 @@ void CmrT2Mapping<T>::compute_map(const VectorType& ti, const VectorType& yi, co
     }
 }
 
+template <typename T>
+void CmrT2Mapping<T>::compute_map_batch(const VectorType& ti, const T* yi, const T* guess, size_t num, T* bi, T* map_v)
+{
+    try
+    {
+        const size_t B = BaseClass::batch_size;
+        size_t NUM = this->get_num_of_paras();
+
+        Gadgetron::hoBatchLMSolver< T, T2CurveModel<T>, (int)BaseClass::batch_size > solver;
+        solver.max_iter_ = max_iter_;
+
+        memcpy(bi, guess, sizeof(T)*NUM*B);
+        solver.solve(ti, yi, bi, NULL, (int)num);
+
+        size_t p;
+        for (p = 0; p < num; p++)
+        {
+            map_v[p] = 0;
+
+            if (bi[p] > 0 && bi[B + p] > 0)
+            {
+                map_v[p] = bi[B + p];
+                if (map_v[p] >= max_map_value_) map_v[p] = hole_marking_value_;
+                if (map_v[p] <= min_map_value_) map_v[p] = hole_marking_value_;
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in CmrT2Mapping<T>::compute_map_batch(...) ... ");
+    }
+}
+
+template <typename T>
+bool CmrT2Mapping<T>::get_dictionary_signal(const VectorType& ti, T map_v, VectorType& s) const
+{
+    s.resize(ti.size());
+
+    size_t n;
+    for (n = 0; n < ti.size(); n++)
+    {
+        s[n] = std::exp(-ti[n] / map_v);
+    }
+
+    return true;
+}
+
 template <typename T>
 void CmrT2Mapping<T>::compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd)
 {
@@ -46,6 +46,12 @@ public:
     /// compute map values for every parameters in bi
     virtual void compute_map(const VectorType& ti, const VectorType& yi, const VectorType& guess, VectorType& bi, T& map_v);
 
+    /// compute map values for a batch of pixels, fitted together with the Levenberg-Marquardt solver
+    virtual void compute_map_batch(const VectorType& ti, const T* yi, const T* guess, size_t num, T* bi, T* map_v);
+
+    /// s = exp(-ti/T2), for dictionary matching
+    virtual bool get_dictionary_signal(const VectorType& ti, T map_v, VectorType& s) const;
+
     /// compute SD values for every parameters in bi
     virtual void compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd);
 
@@ -72,6 +78,11 @@ public:
     using BaseClass::thres_fun_;
     using BaseClass::max_map_value_;
     using BaseClass::min_map_value_;
+    using BaseClass::use_batch_fitting_;
+    using BaseClass::use_dictionary_matching_;
+    using BaseClass::refine_dictionary_match_;
+    using BaseClass::dictionary_size_;
+    using BaseClass::dictionary_min_map_value_;
 
     using BaseClass::verbose_;
     using BaseClass::debug_folder_;
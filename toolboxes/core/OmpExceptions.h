@@ -0,0 +1,43 @@
+/** \file OmpExceptions.h
+    \brief Carries exceptions out of OpenMP parallel regions.
+
+    An exception must not leave an OpenMP parallel region; if it does, std::terminate is called. The work inside the
+    region is run through OmpExceptions::run, which keeps the first exception thrown, and rethrow() is called after the
+    region to throw it on the calling thread.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+namespace Gadgetron {
+
+    class OmpExceptions {
+    public:
+        /// Runs f, keeping the exception if it throws. Once an exception is kept, further work is skipped.
+        template <class F> void run(F&& f) {
+            if (failed()) return;
+            try {
+                f();
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (!error) error = std::current_exception();
+                failed_.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        bool failed() const { return failed_.load(std::memory_order_relaxed); }
+
+        /// Throws the kept exception, if any. Call after the parallel region.
+        void rethrow() {
+            if (error) std::rethrow_exception(error);
+        }
+
+    private:
+        std::mutex mutex;
+        std::exception_ptr error;
+        std::atomic<bool> failed_{ false };
+    };
+}
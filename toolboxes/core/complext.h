@@ -369,7 +369,7 @@ namespace Gadgetron {
     template<class T, class S>
     __inline__ __host__ __device__ auto operator-(const T& c1, const complext<S>& c2) -> complext<decltype(c1-c2._real)>{
         auto real = c1-c2._real;
-        return complext<decltype(real)>(real,c2._imag);
+        return complext<decltype(real)>(real,-c2._imag);
     };
 
     template<class T, class S>
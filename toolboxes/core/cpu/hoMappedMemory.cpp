@@ -0,0 +1,140 @@
+#include "hoMappedMemory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Gadgetron {
+
+    namespace {
+
+        // Mapped regions by start address. The count lets the release of ordinary memory skip the lock.
+        std::mutex regions_mutex;
+        std::map<const char*, size_t> regions;
+        std::atomic<size_t> region_count{0};
+        std::atomic<size_t> bytes_in_use{0};
+
+        // The region containing data, or a size of zero if data is not in mapped memory
+        std::pair<const char*, size_t> region_of(const void* data) {
+            if (!data || region_count.load(std::memory_order_relaxed) == 0) return {nullptr, 0};
+
+            std::lock_guard<std::mutex> guard(regions_mutex);
+            auto region = regions.upper_bound(static_cast<const char*>(data));
+            if (region == regions.begin()) return {nullptr, 0};
+            --region;
+            if (static_cast<const char*>(data) >= region->first + region->second) return {nullptr, 0};
+            return *region;
+        }
+
+#ifndef _WIN32
+        int advice(MappedMemoryAccess access) {
+            switch (access) {
+                case MappedMemoryAccess::sequential: return MADV_SEQUENTIAL;
+                case MappedMemoryAccess::random: return MADV_RANDOM;
+                case MappedMemoryAccess::will_need: return MADV_WILLNEED;
+                case MappedMemoryAccess::dont_need: return MADV_DONTNEED;
+                default: return MADV_NORMAL;
+            }
+        }
+
+        std::runtime_error mapping_error(const std::string& what, const std::string& folder) {
+            return std::runtime_error("Mapped memory: " + what + " in " + folder + " failed: " + std::strerror(errno));
+        }
+#endif
+    }
+
+    void* allocate_mapped_memory(size_t bytes, const std::string& folder) {
+#ifdef _WIN32
+        throw std::runtime_error("Mapped memory is not supported on Windows");
+#else
+        if (bytes == 0) bytes = 1;
+
+        std::string name = folder + "/gadgetron_mapped_XXXXXX";
+        std::vector<char> path(name.begin(), name.end());
+        path.push_back('\0');
+
+        int fd = mkstemp(path.data());
+        if (fd < 0) throw mapping_error("creating a temporary file", folder);
+        unlink(path.data());
+
+        if (ftruncate(fd, off_t(bytes)) != 0) {
+            auto error = mapping_error("sizing a temporary file", folder);
+            close(fd);
+            throw error;
+        }
+
+        void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            auto error = mapping_error("mapping a temporary file", folder);
+            close(fd);
+            throw error;
+        }
+        close(fd);
+
+        {
+            std::lock_guard<std::mutex> guard(regions_mutex);
+            regions.emplace(static_cast<const char*>(data), bytes);
+            region_count++;
+        }
+        bytes_in_use += bytes;
+
+        return data;
+#endif
+    }
+
+    bool release_mapped_memory(void* data) {
+        if (!data || region_count.load(std::memory_order_relaxed) == 0) return false;
+
+#ifdef _WIN32
+        return false;
+#else
+        size_t bytes;
+        {
+            std::lock_guard<std::mutex> guard(regions_mutex);
+            auto region = regions.find(static_cast<const char*>(data));
+            if (region == regions.end()) return false;
+            bytes = region->second;
+            regions.erase(region);
+            region_count--;
+        }
+        bytes_in_use -= bytes;
+
+        munmap(data, bytes);
+        return true;
+#endif
+    }
+
+    bool is_mapped_memory(const void* data) {
+        return region_of(data).second != 0;
+    }
+
+    void advise_mapped_memory(const void* data, size_t bytes, MappedMemoryAccess access) {
+#ifndef _WIN32
+        auto [start, size] = region_of(data);
+        if (size == 0 || bytes == 0) return;
+
+        // madvise takes page aligned ranges; the range is widened to the pages it touches, within the region
+        const uintptr_t page = uintptr_t(sysconf(_SC_PAGESIZE));
+        auto begin = reinterpret_cast<uintptr_t>(data) / page * page;
+        auto end = std::min(reinterpret_cast<uintptr_t>(data) + bytes, reinterpret_cast<uintptr_t>(start) + size);
+
+        madvise(reinterpret_cast<void*>(begin), end - begin, advice(access));
+#endif
+    }
+
+    size_t mapped_memory_in_use() {
+        return bytes_in_use;
+    }
+}
@@ -0,0 +1,42 @@
+/** \file hoMappedMemory.h
+    \brief Array storage in a memory mapped temporary file, for arrays which may not fit in RAM.
+
+    The file is created in the given folder and unlinked straight away, so it is removed when the memory is released,
+    also if the process dies. Its pages are read on access and written back under memory pressure, so a mapped array
+    costs page cache rather than resident memory. The file is sparse; fresh memory reads as zero without being written.
+
+    hoNDArray releases mapped memory handed to it with delete_data_on_destruct set (see create_mapped_array in
+    hoNDArray_mapped.h), so mapped arrays move, copy and destruct like any other array.
+*/
+
+#pragma once
+
+#include "cpucore_export.h"
+
+#include <cstddef>
+#include <string>
+
+namespace Gadgetron {
+
+    enum class MappedMemoryAccess {
+        normal,     ///< default read ahead
+        sequential, ///< aggressive read ahead; pages behind the reader may be dropped early
+        random,     ///< no read ahead
+        will_need,  ///< start reading the pages in now
+        dont_need   ///< the pages may be dropped now; they are read back from the file on the next access
+    };
+
+    /// Maps a temporary file of the given size in folder. Throws std::runtime_error if the file cannot be created.
+    EXPORTCPUCORE void* allocate_mapped_memory(size_t bytes, const std::string& folder);
+
+    /// Unmaps memory from allocate_mapped_memory and returns true; returns false for any other pointer.
+    EXPORTCPUCORE bool release_mapped_memory(void* data);
+
+    EXPORTCPUCORE bool is_mapped_memory(const void* data);
+
+    /// Hints how a range of mapped memory will be accessed. Ranges outside mapped memory are ignored.
+    EXPORTCPUCORE void advise_mapped_memory(const void* data, size_t bytes, MappedMemoryAccess access);
+
+    /// The size of all mapped memory currently allocated.
+    EXPORTCPUCORE size_t mapped_memory_in_use();
+}
@@ -11,6 +11,7 @@
 #include <boost/shared_ptr.hpp>
 #include <stdexcept>
 #include "TypeTraits.h"
+#include "hoMappedMemory.h"
 
 namespace Gadgetron{
 
@@ -320,7 +321,8 @@ namespace Gadgetron{
 
     template<class X> void _deallocate_memory( X* data )
     {
-      delete [] data;
+      // Memory from allocate_mapped_memory is unmapped instead
+      if (!release_mapped_memory(data)) delete [] data;
     }
 
 
@@ -252,9 +252,11 @@ namespace Gadgetron {
     template<typename T>
     hoNDArray<T>::hoNDArray(hoNDArray<T> &&a) noexcept : Gadgetron::NDArray<T>::NDArray() {
         data_ = a.data_;
-        this->dimensions_ = a.dimensions_;
+        this->dimensions_ = std::move(a.dimensions_);
         this->elements_ = a.elements_;
         a.data_ = nullptr;
+        a.dimensions_.clear();
+        a.elements_ = 0;
         this->offsetFactors_ = a.offsetFactors_;
         this->delete_data_on_destruct_ = a.delete_data_on_destruct_;
     }
@@ -295,11 +297,13 @@ namespace Gadgetron {
             return *this;
         }
         this->clear();
-        this->dimensions_ = rhs.dimensions_;
+        this->dimensions_ = std::move(rhs.dimensions_);
         this->offsetFactors_ = rhs.offsetFactors_;
         this->elements_ = rhs.elements_;
         data_ = rhs.data_;
         rhs.data_ = nullptr;
+        rhs.dimensions_.clear();
+        rhs.elements_ = 0;
         this->delete_data_on_destruct_ = rhs.delete_data_on_destruct_;
         return *this;
     }
@@ -0,0 +1,50 @@
+/** \file hoNDArray_mapped.h
+    \brief hoNDArrays stored in a memory mapped temporary file (see hoMappedMemory.h).
+
+    A mapped array is an ordinary hoNDArray whose data lives in the page cache of an unlinked temporary file, so it
+    can be larger than the memory the process may keep resident. Moving the array keeps the mapping; copying it makes
+    an ordinary array. The data of a new mapped array is zero.
+*/
+
+#pragma once
+
+#include "hoNDArray.h"
+#include "hoMappedMemory.h"
+
+namespace Gadgetron {
+
+    template<class T>
+    hoNDArray<T> create_mapped_array(const std::vector<size_t>& dimensions, const std::string& folder) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be mapped");
+
+        size_t elements = 1;
+        for (auto d : dimensions) elements *= d;
+
+        auto data = static_cast<T*>(allocate_mapped_memory(elements * sizeof(T), folder));
+        return hoNDArray<T>(dimensions, data, true);
+    }
+
+    template<class T>
+    bool is_mapped(const hoNDArray<T>& array) {
+        return is_mapped_memory(array.get_data_ptr());
+    }
+
+    /**
+    * @brief Hints that the elements [first, first + count) of a mapped array will be read next, e.g. the next
+    * [RO E1 E2] block of a recon pass over CHA, N and S. The pages are read in the background. Does nothing for an
+    * ordinary array.
+    */
+    template<class T>
+    void prefetch(const hoNDArray<T>& array, size_t first, size_t count) {
+        advise_mapped_memory(array.get_data_ptr() + first, count * sizeof(T), MappedMemoryAccess::will_need);
+    }
+
+    /**
+    * @brief Hints that a mapped array will be read front to back, with more read ahead and the pages behind the
+    * reader dropped first. Does nothing for an ordinary array.
+    */
+    template<class T>
+    void advise_sequential(const hoNDArray<T>& array) {
+        advise_mapped_memory(array.get_data_ptr(), array.get_number_of_bytes(), MappedMemoryAccess::sequential);
+    }
+}
@@ -0,0 +1,347 @@
+/** \file hoNDArray_permute.h
+    \brief Permutation of the dimensions of arrays, used by permute in hoNDArray_utils.h.
+
+    A permutation is first reduced: dimensions of size one are dropped, and neighbouring output dimensions which are
+    also neighbours in the input are merged. What remains is one of
+      - a copy, if the order is the identity,
+      - a copy of rows, if the first output dimension is contiguous in the input, e.g. when CHA is moved to the end,
+      - a transpose of the first output dimension and the one which is contiguous in the input, repeated over the
+        remaining dimensions, e.g. when RO and E1 are swapped or CHA is moved to the front.
+    The transpose goes through tiles which fit in the L1 cache, with in-register transposes of 2x2 blocks for 8 byte
+    types such as complex<float> and 4x4 blocks for 4 byte types. Both kernels are parallelised over rows or tiles of
+    all the outer dimensions.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GADGETRON_PERMUTE_SSE2
+#endif
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+namespace Gadgetron {
+namespace Permutation {
+
+    /// the number of elements above which the kernels are parallelised
+    constexpr size_t elements_use_threading = 64 * 1024;
+
+    /**
+    * @brief A reduced permutation: the output is packed, with the given sizes, and output dimension d is read with
+    * input stride in_strides[d]
+    */
+    struct Plan {
+        std::vector<size_t> sizes;
+        std::vector<size_t> in_strides;
+        size_t elements = 0;
+
+        /// the order is the identity and the permutation is a copy
+        bool is_copy() const { return sizes.size() == 1 && in_strides[0] == 1; }
+
+        /// the first output dimension is contiguous in the input
+        bool is_row_copy() const { return in_strides[0] == 1; }
+
+        /// the output dimension which is contiguous in the input
+        size_t contiguous_dimension() const {
+            return std::find(in_strides.begin(), in_strides.end(), size_t(1)) - in_strides.begin();
+        }
+    };
+
+    /**
+    * @brief Reduces the permutation of an array with the given dimensions. The order must contain every dimension once.
+    */
+    inline Plan make_plan(const std::vector<size_t>& dims, const std::vector<size_t>& order) {
+        std::vector<size_t> strides(dims.size(), 1);
+        for (size_t d = 1; d < dims.size(); d++) strides[d] = strides[d - 1] * dims[d - 1];
+
+        Plan plan;
+        plan.elements = 1;
+        for (auto d : order) {
+            plan.elements *= dims[d];
+            if (dims[d] == 1) continue;
+
+            if (!plan.sizes.empty() && strides[d] == plan.in_strides.back() * plan.sizes.back()) {
+                plan.sizes.back() *= dims[d];
+            } else {
+                plan.sizes.push_back(dims[d]);
+                plan.in_strides.push_back(strides[d]);
+            }
+        }
+
+        if (plan.sizes.empty()) {
+            plan.sizes.push_back(1);
+            plan.in_strides.push_back(1);
+        }
+        return plan;
+    }
+
+    namespace detail {
+
+        // Walks over the given dimensions of the plan in output order, keeping track of the input and output offsets
+        class Odometer {
+        public:
+            Odometer(const Plan& plan, std::vector<size_t> dimensions, size_t start) : plan_(plan), dims_(std::move(dimensions)) {
+                out_strides_.resize(plan.sizes.size(), 1);
+                for (size_t d = 1; d < plan.sizes.size(); d++) out_strides_[d] = out_strides_[d - 1] * plan.sizes[d - 1];
+
+                index_.resize(dims_.size());
+                for (size_t k = 0; k < dims_.size(); k++) {
+                    index_[k] = start % plan.sizes[dims_[k]];
+                    start /= plan.sizes[dims_[k]];
+                    in_ += index_[k] * plan.in_strides[dims_[k]];
+                    out_ += index_[k] * out_strides_[dims_[k]];
+                }
+            }
+
+            size_t in() const { return in_; }
+            size_t out() const { return out_; }
+            size_t out_stride(size_t d) const { return out_strides_[d]; }
+
+            void advance() {
+                for (size_t k = 0; k < dims_.size(); k++) {
+                    size_t d = dims_[k];
+                    in_ += plan_.in_strides[d];
+                    out_ += out_strides_[d];
+                    if (++index_[k] < plan_.sizes[d]) return;
+
+                    in_ -= plan_.sizes[d] * plan_.in_strides[d];
+                    out_ -= plan_.sizes[d] * out_strides_[d];
+                    index_[k] = 0;
+                }
+            }
+
+        private:
+            const Plan& plan_;
+            std::vector<size_t> dims_;
+            std::vector<size_t> out_strides_;
+            std::vector<size_t> index_;
+            size_t in_ = 0;
+            size_t out_ = 0;
+        };
+
+        // side of the square tiles of the transpose, so that a tile of the input and one of the output fit in L1
+        template <class T> constexpr size_t tile_size() {
+            return sizeof(T) <= 4 ? 64 : sizeof(T) <= 8 ? 32 : 16;
+        }
+
+        // out[j*ldo + i] = in[i][j] for i < rows and j < cols
+        template <class T>
+        inline void transpose_tile(const T* const* in, T* out, size_t ldo, size_t rows, size_t cols) {
+            size_t i = 0, j = 0;
+#ifdef GADGETRON_PERMUTE_SSE2
+            if constexpr (std::is_trivially_copyable<T>::value && sizeof(T) == 8) {
+                for (i = 0; i + 2 <= rows; i += 2) {
+                    for (j = 0; j + 2 <= cols; j += 2) {
+                        __m128d r0 = _mm_loadu_pd(reinterpret_cast<const double*>(in[i] + j));
+                        __m128d r1 = _mm_loadu_pd(reinterpret_cast<const double*>(in[i + 1] + j));
+                        _mm_storeu_pd(reinterpret_cast<double*>(out + j * ldo + i), _mm_unpacklo_pd(r0, r1));
+                        _mm_storeu_pd(reinterpret_cast<double*>(out + (j + 1) * ldo + i), _mm_unpackhi_pd(r0, r1));
+                    }
+                }
+            } else if constexpr (std::is_trivially_copyable<T>::value && sizeof(T) == 4) {
+                for (i = 0; i + 4 <= rows; i += 4) {
+                    for (j = 0; j + 4 <= cols; j += 4) {
+                        __m128 r0 = _mm_loadu_ps(reinterpret_cast<const float*>(in[i] + j));
+                        __m128 r1 = _mm_loadu_ps(reinterpret_cast<const float*>(in[i + 1] + j));
+                        __m128 r2 = _mm_loadu_ps(reinterpret_cast<const float*>(in[i + 2] + j));
+                        __m128 r3 = _mm_loadu_ps(reinterpret_cast<const float*>(in[i + 3] + j));
+                        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                        _mm_storeu_ps(reinterpret_cast<float*>(out + j * ldo + i), r0);
+                        _mm_storeu_ps(reinterpret_cast<float*>(out + (j + 1) * ldo + i), r1);
+                        _mm_storeu_ps(reinterpret_cast<float*>(out + (j + 2) * ldo + i), r2);
+                        _mm_storeu_ps(reinterpret_cast<float*>(out + (j + 3) * ldo + i), r3);
+                    }
+                }
+            }
+#endif
+            // the columns right of the blocks, then the rows below them
+            size_t block_rows = i, block_cols = j;
+            if (block_rows == 0) block_cols = 0;
+            for (size_t jj = block_cols; jj < cols; jj++)
+                for (size_t ii = 0; ii < block_rows; ii++) out[jj * ldo + ii] = in[ii][jj];
+            for (size_t jj = 0; jj < cols; jj++)
+                for (size_t ii = block_rows; ii < rows; ii++) out[jj * ldo + ii] = in[ii][jj];
+        }
+
+        // out[j*ldo + i] = in[i*ldi + j] for i < rows and j < cols
+        template <class T>
+        inline void transpose_tile(const T* in, size_t ldi, T* out, size_t ldo, size_t rows, size_t cols) {
+            constexpr size_t B = tile_size<T>();
+            const T* row[B];
+            for (size_t i = 0; i < rows; i++) row[i] = in + i * ldi;
+            transpose_tile(row, out, ldo, rows, cols);
+        }
+
+        template <class T> void copy_rows(const T* in, T* out, const Plan& plan) {
+            const size_t length = plan.sizes[0];
+            const long long rows = plan.elements / length;
+            std::vector<size_t> outer;
+            for (size_t d = 1; d < plan.sizes.size(); d++) outer.push_back(d);
+
+#ifdef USE_OMP
+#pragma omp parallel if (plan.elements > elements_use_threading)
+#endif
+            {
+#ifdef USE_OMP
+                const long long threads = omp_get_num_threads(), thread = omp_get_thread_num();
+#else
+                const long long threads = 1, thread = 0;
+#endif
+                const long long first = rows * thread / threads, last = rows * (thread + 1) / threads;
+                Odometer position(plan, outer, first);
+                for (long long r = first; r < last; r++) {
+                    std::copy_n(in + position.in(), length, out + position.out());
+                    position.advance();
+                }
+            }
+        }
+
+        // The rows of the transpose are the first output dimensions, as many as needed for a full tile, and the
+        // columns are the output dimension p which is contiguous in the input. The input offsets of the rows are
+        // tabulated, since the dimensions have unrelated input strides when e.g. the order is reversed.
+        template <class T> void transpose(const T* in, T* out, const Plan& plan) {
+            constexpr size_t B = tile_size<T>();
+            const size_t p = plan.contiguous_dimension();
+
+            size_t q = 1, rows = plan.sizes[0];
+            while (q < p && rows < B) rows *= plan.sizes[q++];
+            const size_t cols = plan.sizes[p];
+
+            std::vector<size_t> row_offsets(rows);
+            {
+                std::vector<size_t> row_dims(q);
+                for (size_t d = 0; d < q; d++) row_dims[d] = d;
+                Odometer row(plan, row_dims, 0);
+                for (size_t i = 0; i < rows; i++, row.advance()) row_offsets[i] = row.in();
+            }
+
+            std::vector<size_t> outer;
+            for (size_t d = q; d < plan.sizes.size(); d++)
+                if (d != p) outer.push_back(d);
+
+            const size_t row_tiles = (rows + B - 1) / B, col_tiles = (cols + B - 1) / B;
+            const size_t tiles = row_tiles * col_tiles;
+            const long long work = (plan.elements / (rows * cols)) * tiles;
+
+#ifdef USE_OMP
+#pragma omp parallel if (plan.elements > elements_use_threading)
+#endif
+            {
+#ifdef USE_OMP
+                const long long threads = omp_get_num_threads(), thread = omp_get_thread_num();
+#else
+                const long long threads = 1, thread = 0;
+#endif
+                const long long first = work * thread / threads, last = work * (thread + 1) / threads;
+                if (first < last) {
+                    Odometer position(plan, outer, first / tiles);
+                    const size_t ldo = position.out_stride(p);
+                    const T* row[B];
+
+                    size_t tile = first % tiles;
+                    for (long long w = first; w < last; w++) {
+                        const size_t i0 = (tile / col_tiles) * B, j0 = (tile % col_tiles) * B;
+                        const size_t tile_rows = std::min(B, rows - i0);
+                        for (size_t i = 0; i < tile_rows; i++) row[i] = in + position.in() + row_offsets[i0 + i] + j0;
+                        transpose_tile(row, out + position.out() + j0 * ldo + i0, ldo, tile_rows, std::min(B, cols - j0));
+
+                        if (++tile == tiles) {
+                            tile = 0;
+                            position.advance();
+                        }
+                    }
+                }
+            }
+        }
+
+        // swaps the tiles (i0, j0) and (j0, i0) of the square matrix x, transposing both
+        template <class T> void swap_tiles(T* x, size_t n, size_t i0, size_t j0, size_t rows, size_t cols, T* buffer) {
+            constexpr size_t B = tile_size<T>();
+            if (i0 == j0) {
+                transpose_tile(x + i0 * n + j0, n, buffer, B, rows, cols);
+                for (size_t i = 0; i < rows; i++) std::copy_n(buffer + i * B, cols, x + (i0 + i) * n + j0);
+            } else {
+                transpose_tile(x + i0 * n + j0, n, buffer, B, rows, cols);
+                transpose_tile(x + j0 * n + i0, n, x + i0 * n + j0, n, cols, rows);
+                for (size_t i = 0; i < cols; i++) std::copy_n(buffer + i * B, rows, x + (j0 + i) * n + i0);
+            }
+        }
+
+        // the plan transposes the first two dimensions of equal size and keeps the others in place
+        inline bool is_square_transpose(const Plan& plan) {
+            if (plan.sizes.size() < 2 || plan.sizes[0] != plan.sizes[1]) return false;
+            const size_t n = plan.sizes[0];
+            if (plan.in_strides[0] != n || plan.in_strides[1] != 1) return false;
+
+            size_t stride = n * n;
+            for (size_t d = 2; d < plan.sizes.size(); d++) {
+                if (plan.in_strides[d] != stride) return false;
+                stride *= plan.sizes[d];
+            }
+            return true;
+        }
+
+        template <class T> void transpose_square_inplace(T* x, const Plan& plan) {
+            constexpr size_t B = tile_size<T>();
+            const size_t n = plan.sizes[0];
+            const size_t tiles_1d = (n + B - 1) / B;
+
+            // the tiles on and above the diagonal
+            std::vector<std::pair<size_t, size_t>> tiles;
+            for (size_t ti = 0; ti < tiles_1d; ti++)
+                for (size_t tj = ti; tj < tiles_1d; tj++) tiles.emplace_back(ti * B, tj * B);
+
+            const long long matrices = plan.elements / (n * n);
+            const long long work = matrices * tiles.size();
+
+#ifdef USE_OMP
+#pragma omp parallel if (plan.elements > elements_use_threading)
+#endif
+            {
+                std::vector<T> buffer(B * B);
+#ifdef USE_OMP
+#pragma omp for
+#endif
+                for (long long w = 0; w < work; w++) {
+                    T* matrix = x + (w / tiles.size()) * n * n;
+                    const auto& tile = tiles[w % tiles.size()];
+                    swap_tiles(matrix, n, tile.first, tile.second, std::min(B, n - tile.first), std::min(B, n - tile.second), buffer.data());
+                }
+            }
+        }
+    }
+
+    /**
+    * @brief Permutes the array in into out according to the plan. The arrays must not overlap.
+    */
+    template <class T> void permute(const T* in, T* out, const Plan& plan) {
+        if (plan.elements == 0) return;
+
+        if (plan.is_row_copy())
+            detail::copy_rows(in, out, plan);
+        else
+            detail::transpose(in, out, plan);
+    }
+
+    /**
+    * @brief Permutes the array x in place according to the plan. Returns false if this is not supported for the plan,
+    * which leaves x unchanged. Supported are copies, and transposes of two dimensions of equal size.
+    */
+    template <class T> bool permute_inplace(T* x, const Plan& plan) {
+        if (plan.elements == 0 || plan.is_copy()) return true;
+
+        if (detail::is_square_transpose(plan)) {
+            detail::transpose_square_inplace(x, plan);
+            return true;
+        }
+        return false;
+    }
+}
+}
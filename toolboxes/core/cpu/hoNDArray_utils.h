@@ -5,6 +5,7 @@
 #include <numeric>
 #include "hoNDArray.h"
 #include "hoNDArray_iterators.h"
+#include "hoNDArray_permute.h"
 #include "vector_td_utilities.h"
 
 #include <boost/version.hpp>
@@ -86,6 +87,44 @@ namespace Gadgetron {
     size_t current_idx_;
   };
 
+  namespace detail {
+      // checks the dimension order of permute and pads it with the dimensions it does not mention
+      inline std::vector<size_t> full_permute_order(size_t number_of_dimensions, const std::vector<size_t>& dim_order)
+      {
+        // Check ordering array
+        if (dim_order.size() > number_of_dimensions) {
+          throw std::runtime_error("hoNDArray::permute - Invalid length of dimension ordering array");;
+        }
+
+        std::vector<size_t> dim_count(number_of_dimensions,0);
+        for (size_t i = 0; i < dim_order.size(); i++) {
+          if (dim_order[i] >= number_of_dimensions) {
+            throw std::runtime_error("hoNDArray::permute - Invalid dimension order array");;
+          }
+          dim_count[dim_order[i]]++;
+        }
+
+        // Create an internal array to store the dimensions
+        std::vector<size_t> dim_order_int;
+
+        // Check that there are no duplicate dimensions
+        for (size_t i = 0; i < dim_order.size(); i++) {
+          if (dim_count[dim_order[i]] != 1) {
+            throw std::runtime_error("hoNDArray::permute - Invalid dimension order array (duplicates)");;
+          }
+          dim_order_int.push_back(dim_order[i]);
+        }
+
+        // Pad dimension order array with dimension not mentioned in order array
+        for (size_t i = 0; i < dim_count.size(); i++) {
+          if (dim_count[i] == 0) {
+            dim_order_int.push_back(i);
+          }
+        }
+        return dim_order_int;
+      }
+  }
+
   template<class T> hoNDArray<T> shift_dim( const hoNDArray<T>& in, int shift )
   {
     std::vector<size_t> order;
@@ -109,8 +148,8 @@ namespace Gadgetron {
   {
 
     std::vector<size_t> dims;
-    for (size_t i = 0; i < dim_order.size(); i++)
-      dims.push_back(in.get_dimensions()->at(dim_order[i]));
+    for (auto d : detail::full_permute_order(in.get_number_of_dimensions(), dim_order))
+      dims.push_back(in.get_size(d));
     hoNDArray<T> out(dims);
     permute( in, out, dim_order);
     return out;
@@ -119,109 +158,40 @@ namespace Gadgetron {
   template<class T> void
   permute(const  hoNDArray<T>& in, hoNDArray<T>& out, const std::vector<size_t>& dim_order)
   {
+    auto dim_order_int = detail::full_permute_order(in.get_number_of_dimensions(), dim_order);
 
-    // Check ordering array
-    if (dim_order.size() > in.get_number_of_dimensions()) {
-      throw std::runtime_error("hoNDArray::permute - Invalid length of dimension ordering array");;
-    }
-
-    std::vector<size_t> dim_count(in.get_number_of_dimensions(),0);
     for (size_t i = 0; i < dim_order.size(); i++) {
-      if (dim_order[i] >= in.get_number_of_dimensions()) {
-        throw std::runtime_error("hoNDArray::permute - Invalid dimension order array");;
-      }
-      dim_count[dim_order[i]]++;
-    }
-
-    // Create an internal array to store the dimensions
-    std::vector<size_t> dim_order_int;
-
-    // Check that there are no duplicate dimensions
-    for (size_t i = 0; i < dim_order.size(); i++) {
-      if (dim_count[dim_order[i]] != 1) {
-        throw std::runtime_error("hoNDArray::permute - Invalid dimension order array (duplicates)");;
-
-      }
-      dim_order_int.push_back(dim_order[i]);
-    }
-
-    for (size_t i = 0; i < dim_order_int.size(); i++) {
       if ((*in.get_dimensions())[dim_order_int[i]] != out.get_size(i)) {
         throw std::runtime_error("permute(): dimensions of output array do not match the input array");;
       }
     }
 
-    // Pad dimension order array with dimension not mentioned in order array
-    if (dim_order_int.size() < in.get_number_of_dimensions()) {
-      for (size_t i = 0; i < dim_count.size(); i++) {
-        if (dim_count[i] == 0) {
-          dim_order_int.push_back(i);
-        }
-      }
-    }
-
-    T* o = out.get_data_ptr();
-
-    // if memcpy can be used during permute
-    size_t stride = 1;
-    size_t num_dim_memcpy = 0;
-    for (size_t i = 0; i < dim_order_int.size(); i++) {
-        if (dim_order_int[i]==i){
-            stride *= in.get_size(i);
-            num_dim_memcpy = i;
-        }
-        else{
-            break;
-        }
+    if (out.get_number_of_elements() != in.get_number_of_elements()) {
+      throw std::runtime_error("permute(): number of elements of output array do not match the input array");;
     }
 
-    if (stride == 1) {
-        // point by point assignment is needed
-        ArrayIterator it(in.get_dimensions().get(), &dim_order_int);
-        for (size_t i = 0; i < in.get_number_of_elements(); i++) {
-            o[i] = in.get_data_ptr()[it.get_current_idx()];
-            it.advance();
-        }
-    }
-    else {
-        // memcpy can be used
-
-        size_t nDim = in.get_number_of_dimensions();
-        size_t num_memcpy = in.get_number_of_elements() / stride;
-
-        if (num_dim_memcpy == nDim - 1){
-            memcpy(out.begin(), in.begin(), in.get_number_of_bytes());
-            return;
-        }
-
-        // for the array index calculation
-        std::vector<size_t> dim_permute(nDim-num_dim_memcpy-1);
-        for (size_t i = num_dim_memcpy+1; i < dim_order_int.size(); i++) {
-            dim_permute[i - num_dim_memcpy - 1] = in.get_size(i);
-        }
-
-        size_t n;
-
-        const hoNDArray<T> permuteArray(dim_permute, const_cast<T*>(in.get_data_ptr()), false);
-
-        // starting index for in and out array for every permute memcpy operation
-        std::vector<size_t> ind_permute_in(dim_permute.size(), 0), ind_in(nDim, 0), ind_out(nDim, 0);
-
-        for (n = 0; n < num_memcpy; n++) {
-            permuteArray.calculate_index(n, ind_permute_in);
-            memcpy(&ind_in[0] + num_dim_memcpy + 1, &ind_permute_in[0], sizeof(size_t)*ind_permute_in.size());
+    Permutation::permute(in.get_data_ptr(), out.get_data_ptr(), Permutation::make_plan(in.dimensions(), dim_order_int));
+  }
 
-            // permute the indexes
-            for (size_t i = 0; i < nDim; i++) {
-                ind_out[i] = ind_in[dim_order_int[i]];
-            }
+  /**
+  * @brief Permutes the dimensions of x in place. Copies and transposes of two dimensions of equal size, e.g. of
+  * square images, are done without a temporary array; other orders permute into one and copy it back into x.
+  */
+  template<class T> void
+  permute_inplace(hoNDArray<T>& x, const std::vector<size_t>& dim_order)
+  {
+    auto dim_order_int = detail::full_permute_order(x.get_number_of_dimensions(), dim_order);
 
-            size_t offset_in = in.calculate_offset(ind_in);
-            size_t offset_out = out.calculate_offset(ind_out);
+    std::vector<size_t> dims;
+    for (auto d : dim_order_int) dims.push_back(x.get_size(d));
 
-            memcpy(o + offset_out, in.begin() + offset_in, sizeof(T)*stride);
-        }
+    auto plan = Permutation::make_plan(x.dimensions(), dim_order_int);
+    if (!Permutation::permute_inplace(x.get_data_ptr(), plan)) {
+      hoNDArray<T> tmp(dims);
+      Permutation::permute(x.get_data_ptr(), tmp.get_data_ptr(), plan);
+      std::copy_n(tmp.get_data_ptr(), tmp.get_number_of_elements(), x.get_data_ptr());
     }
+    x.reshape(dims);
   }
 
   // Expand array to new dimension
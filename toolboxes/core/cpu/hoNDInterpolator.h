@@ -111,6 +111,7 @@ namespace Gadgetron
         }
 
         virtual void setBoundaryHandler(BoundHanlderType& bh) { bh_ = &bh; if ( array_!=NULL ) bh_->setArray(*array_); }
+        BoundHanlderType* getBoundaryHandler() const { return bh_; }
 
         /// access the pixel value
         virtual T operator()( const coord_type* pos ) = 0;
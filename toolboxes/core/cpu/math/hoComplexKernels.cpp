@@ -0,0 +1,231 @@
+#include "hoComplexKernels.h"
+#include "hoComplexKernels.hpp"
+#include "cpuisa.h"
+
+#include <cmath>
+
+namespace Gadgetron{
+namespace hoComplexKernels{
+
+namespace detail{
+namespace scalar{
+
+    template <class T> void multiply(size_t N, const T* x, const T* y, T* r)
+    {
+        for (size_t n = 0; n < 2 * N; n += 2)
+        {
+            T re = x[n] * y[n] - x[n + 1] * y[n + 1];
+            T im = x[n + 1] * y[n] + x[n] * y[n + 1];
+            r[n] = re;
+            r[n + 1] = im;
+        }
+    }
+
+    template <class T> void multiply_conj(size_t N, const T* x, const T* y, T* r)
+    {
+        for (size_t n = 0; n < 2 * N; n += 2)
+        {
+            T re = x[n] * y[n] + x[n + 1] * y[n + 1];
+            T im = x[n + 1] * y[n] - x[n] * y[n + 1];
+            r[n] = re;
+            r[n + 1] = im;
+        }
+    }
+
+    template <class T> void divide(size_t N, const T* x, const T* y, T* r)
+    {
+        for (size_t n = 0; n < 2 * N; n += 2)
+        {
+            T d = y[n] * y[n] + y[n + 1] * y[n + 1];
+            T re = (x[n] * y[n] + x[n + 1] * y[n + 1]) / d;
+            T im = (x[n + 1] * y[n] - x[n] * y[n + 1]) / d;
+            r[n] = re;
+            r[n + 1] = im;
+        }
+    }
+
+    template <class T> void abs(size_t N, const T* x, T* r)
+    {
+        for (size_t n = 0; n < N; n++) r[n] = std::hypot(x[2 * n], x[2 * n + 1]);
+    }
+
+    template <class T> void argument(size_t N, const T* x, T* r)
+    {
+        for (size_t n = 0; n < N; n++) r[n] = std::atan2(x[2 * n + 1], x[2 * n]);
+    }
+
+    template <class T> void axpy(size_t N, T a_re, T a_im, const T* x, T* y)
+    {
+        for (size_t n = 0; n < 2 * N; n += 2)
+        {
+            y[n] += a_re * x[n] - a_im * x[n + 1];
+            y[n + 1] += a_re * x[n + 1] + a_im * x[n];
+        }
+    }
+
+    template <class T> void dotc(size_t N, const T* x, const T* y, T* re, T* im)
+    {
+        T sr = 0, si = 0;
+        for (size_t n = 0; n < 2 * N; n += 2)
+        {
+            sr += x[n] * y[n] + x[n + 1] * y[n + 1];
+            si += x[n] * y[n + 1] - x[n + 1] * y[n];
+        }
+        *re = sr;
+        *im = si;
+    }
+
+    template void multiply(size_t, const float*, const float*, float*);
+    template void multiply(size_t, const double*, const double*, double*);
+    template void multiply_conj(size_t, const float*, const float*, float*);
+    template void multiply_conj(size_t, const double*, const double*, double*);
+    template void divide(size_t, const float*, const float*, float*);
+    template void divide(size_t, const double*, const double*, double*);
+    template void abs(size_t, const float*, float*);
+    template void abs(size_t, const double*, double*);
+    template void argument(size_t, const float*, float*);
+    template void argument(size_t, const double*, double*);
+    template void axpy(size_t, float, float, const float*, float*);
+    template void axpy(size_t, double, double, const double*, double*);
+    template void dotc(size_t, const float*, const float*, float*, float*);
+    template void dotc(size_t, const double*, const double*, double*, double*);
+}
+
+    template <class T> KernelTable<T> scalar_kernels()
+    {
+        KernelTable<T> table;
+        table.multiply = &scalar::multiply<T>;
+        table.multiply_conj = &scalar::multiply_conj<T>;
+        table.divide = &scalar::divide<T>;
+        table.abs = &scalar::abs<T>;
+        table.argument = &scalar::argument<T>;
+        table.axpy = &scalar::axpy<T>;
+        table.dotc = &scalar::dotc<T>;
+        return table;
+    }
+
+    template KernelTable<float> scalar_kernels<float>();
+    template KernelTable<double> scalar_kernels<double>();
+}
+
+namespace{
+
+    InstructionSet best_supported()
+    {
+        if (CPU_supports_AVX512F()) return InstructionSet::Avx512;
+        if (CPU_supports_AVX2() && CPU_supports_FMA()) return InstructionSet::Avx2;
+        return InstructionSet::Scalar;
+    }
+
+    struct Dispatch
+    {
+        InstructionSet isa;
+        detail::KernelTable<float> float_kernels;
+        detail::KernelTable<double> double_kernels;
+
+        void select(InstructionSet requested)
+        {
+            while (!is_supported(requested)) requested = InstructionSet(int(requested) - 1);
+
+            isa = requested;
+            switch (isa)
+            {
+            case InstructionSet::Avx512:
+                float_kernels = detail::avx512_kernels<float>();
+                double_kernels = detail::avx512_kernels<double>();
+                break;
+            case InstructionSet::Avx2:
+                float_kernels = detail::avx2_kernels<float>();
+                double_kernels = detail::avx2_kernels<double>();
+                break;
+            default:
+                float_kernels = detail::scalar_kernels<float>();
+                double_kernels = detail::scalar_kernels<double>();
+            }
+        }
+    };
+
+    Dispatch& dispatch()
+    {
+        static Dispatch d = []() { Dispatch d; d.select(best_supported()); return d; }();
+        return d;
+    }
+
+    template <class T> const detail::KernelTable<T>& kernels();
+    template <> const detail::KernelTable<float>& kernels<float>() { return dispatch().float_kernels; }
+    template <> const detail::KernelTable<double>& kernels<double>() { return dispatch().double_kernels; }
+
+    template <class T> const T* as_real(const std::complex<T>* x) { return reinterpret_cast<const T*>(x); }
+    template <class T> T* as_real(std::complex<T>* x) { return reinterpret_cast<T*>(x); }
+}
+
+    bool is_supported(InstructionSet isa)
+    {
+        static const InstructionSet best = best_supported();
+        return int(isa) <= int(best);
+    }
+
+    InstructionSet get_instruction_set()
+    {
+        return dispatch().isa;
+    }
+
+    InstructionSet set_instruction_set(InstructionSet isa)
+    {
+        dispatch().select(isa);
+        return dispatch().isa;
+    }
+
+    template <class T> void multiply(size_t N, const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r)
+    {
+        kernels<T>().multiply(N, as_real(x), as_real(y), as_real(r));
+    }
+
+    template <class T> void multiply_conj(size_t N, const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r)
+    {
+        kernels<T>().multiply_conj(N, as_real(x), as_real(y), as_real(r));
+    }
+
+    template <class T> void divide(size_t N, const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r)
+    {
+        kernels<T>().divide(N, as_real(x), as_real(y), as_real(r));
+    }
+
+    template <class T> void abs(size_t N, const std::complex<T>* x, T* r)
+    {
+        kernels<T>().abs(N, as_real(x), r);
+    }
+
+    template <class T> void argument(size_t N, const std::complex<T>* x, T* r)
+    {
+        kernels<T>().argument(N, as_real(x), r);
+    }
+
+    template <class T> void axpy(size_t N, std::complex<T> a, const std::complex<T>* x, std::complex<T>* y)
+    {
+        kernels<T>().axpy(N, a.real(), a.imag(), as_real(x), as_real(y));
+    }
+
+    template <class T> std::complex<T> dotc(size_t N, const std::complex<T>* x, const std::complex<T>* y)
+    {
+        T re, im;
+        kernels<T>().dotc(N, as_real(x), as_real(y), &re, &im);
+        return std::complex<T>(re, im);
+    }
+
+    template void multiply(size_t, const std::complex<float>*, const std::complex<float>*, std::complex<float>*);
+    template void multiply(size_t, const std::complex<double>*, const std::complex<double>*, std::complex<double>*);
+    template void multiply_conj(size_t, const std::complex<float>*, const std::complex<float>*, std::complex<float>*);
+    template void multiply_conj(size_t, const std::complex<double>*, const std::complex<double>*, std::complex<double>*);
+    template void divide(size_t, const std::complex<float>*, const std::complex<float>*, std::complex<float>*);
+    template void divide(size_t, const std::complex<double>*, const std::complex<double>*, std::complex<double>*);
+    template void abs(size_t, const std::complex<float>*, float*);
+    template void abs(size_t, const std::complex<double>*, double*);
+    template void argument(size_t, const std::complex<float>*, float*);
+    template void argument(size_t, const std::complex<double>*, double*);
+    template void axpy(size_t, std::complex<float>, const std::complex<float>*, std::complex<float>*);
+    template void axpy(size_t, std::complex<double>, const std::complex<double>*, std::complex<double>*);
+    template std::complex<float> dotc(size_t, const std::complex<float>*, const std::complex<float>*);
+    template std::complex<double> dotc(size_t, const std::complex<double>*, const std::complex<double>*);
+}
+}
@@ -0,0 +1,75 @@
+/** \file hoComplexKernels.h
+    \brief Explicitly vectorised kernels on complex float and double arrays.
+
+    The complex loops of hoNDArray_elemwise rarely auto-vectorise: the interleaved layout needs shuffles the
+    compiler does not generate, and std::abs and std::arg are library calls. These kernels are written with AVX2
+    and AVX-512 intrinsics instead. The instruction set is selected at runtime from what the cpu supports
+    (see cpuisa.h), with a scalar fallback, so the library is still built for the baseline architecture.
+
+    The vectorised kernels use the plain formulas of complext: x*y and x/y without the NaN and infinity recovery of
+    std::complex, |x| as sqrt(re*re + im*im) without the overflow protection of hypot and a polynomial arctangent
+    accurate to a few ulp. The scalar fallback uses std::abs and std::arg.
+*/
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+namespace Gadgetron{
+namespace hoComplexKernels{
+
+    enum class InstructionSet { Scalar, Avx2, Avx512 };
+
+    /**
+    * @brief Whether the cpu supports the kernels of the given instruction set
+    */
+    bool is_supported(InstructionSet isa);
+
+    /**
+    * @brief The instruction set of the kernels in use. This is the best supported one unless set_instruction_set was called.
+    */
+    InstructionSet get_instruction_set();
+
+    /**
+    * @brief Uses the kernels of the given instruction set, or the best supported one below it, e.g. to compare them.
+    * Returns the instruction set in use.
+    */
+    InstructionSet set_instruction_set(InstructionSet isa);
+
+    /**
+    * @brief r = x*y
+    */
+    template <class T> void multiply(size_t N, const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r);
+
+    /**
+    * @brief r = x*conj(y)
+    */
+    template <class T> void multiply_conj(size_t N, const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r);
+
+    /**
+    * @brief r = x/y
+    */
+    template <class T> void divide(size_t N, const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r);
+
+    /**
+    * @brief r = |x|
+    */
+    template <class T> void abs(size_t N, const std::complex<T>* x, T* r);
+
+    /**
+    * @brief r = arg(x)
+    */
+    template <class T> void argument(size_t N, const std::complex<T>* x, T* r);
+
+    /**
+    * @brief y = a*x + y
+    */
+    template <class T> void axpy(size_t N, std::complex<T> a, const std::complex<T>* x, std::complex<T>* y);
+
+    /**
+    * @brief Returns sum(conj(x)*y)
+    */
+    template <class T> std::complex<T> dotc(size_t N, const std::complex<T>* x, const std::complex<T>* y);
+}
+}
@@ -0,0 +1,239 @@
+/** \file hoComplexKernels.hpp
+    \brief Internal part of hoComplexKernels: the kernel tables of the instruction sets and the vectorised algorithms.
+
+    The algorithms are written once against a vector traits class, which hoComplexKernelsAvx2.cpp and
+    hoComplexKernelsAvx512.cpp implement with their intrinsics. Those files are compiled with the instruction set
+    enabled, so they must not instantiate any inline function that other files instantiate too: the linker keeps one
+    copy, which could then be the AVX-512 one. The algorithms are therefore in an anonymous namespace, and the
+    remainders of the vector loops are handed to the scalar kernels of hoComplexKernels.cpp.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace Gadgetron{
+namespace hoComplexKernels{
+namespace detail{
+
+    // kernels on interleaved arrays of N complex values
+    template <class T> struct KernelTable
+    {
+        void (*multiply)(size_t N, const T* x, const T* y, T* r);
+        void (*multiply_conj)(size_t N, const T* x, const T* y, T* r);
+        void (*divide)(size_t N, const T* x, const T* y, T* r);
+        void (*abs)(size_t N, const T* x, T* r);
+        void (*argument)(size_t N, const T* x, T* r);
+        void (*axpy)(size_t N, T a_re, T a_im, const T* x, T* y);
+        void (*dotc)(size_t N, const T* x, const T* y, T* re, T* im);
+    };
+
+    template <class T> KernelTable<T> scalar_kernels();
+    template <class T> KernelTable<T> avx2_kernels();
+    template <class T> KernelTable<T> avx512_kernels();
+
+    // the scalar kernels, defined in hoComplexKernels.cpp
+    namespace scalar{
+        template <class T> void multiply(size_t N, const T* x, const T* y, T* r);
+        template <class T> void multiply_conj(size_t N, const T* x, const T* y, T* r);
+        template <class T> void divide(size_t N, const T* x, const T* y, T* r);
+        template <class T> void abs(size_t N, const T* x, T* r);
+        template <class T> void argument(size_t N, const T* x, T* r);
+        template <class T> void axpy(size_t N, T a_re, T a_im, const T* x, T* y);
+        template <class T> void dotc(size_t N, const T* x, const T* y, T* re, T* im);
+    }
+
+namespace{
+
+    // ----------------------------------------------------------------------------------------
+    // The traits V provide
+    //   value_type, vec, mask, width          the element type, the vector and mask types, the elements per vector
+    //   load, store, set1, zero               unaligned memory access and constants
+    //   add, sub, mul, div, sqrt, min, max    elementwise arithmetic
+    //   fmadd(a, b, c)                        a*b + c
+    //   fmaddsub(a, b, c), fmsubadd(a, b, c)  a*b -/+ c in the even elements and a*b +/- c in the odd ones
+    //   dup_re, dup_im, swap                  (re, re), (im, im) and (im, re) of every complex value
+    //   deinterleave(v0, v1, re, im)          the real and imaginary parts of the complex values of v0 and v1
+    //   abs, copysign, hsum                   |a|, |a| with the sign of b, and the sum of all elements
+    //   gt, eq, is_negative, select           comparisons and select(m, a, b) = m ? a : b
+    // ----------------------------------------------------------------------------------------
+
+    template <class V> void multiply(size_t N, const typename V::value_type* x, const typename V::value_type* y, typename V::value_type* r)
+    {
+        size_t n = 0;
+        for (; n + V::width <= 2 * N; n += V::width)
+        {
+            auto a = V::load(x + n);
+            auto b = V::load(y + n);
+            V::store(r + n, V::fmaddsub(a, V::dup_re(b), V::mul(V::swap(a), V::dup_im(b))));
+        }
+        scalar::multiply(N - n / 2, x + n, y + n, r + n);
+    }
+
+    template <class V> void multiply_conj(size_t N, const typename V::value_type* x, const typename V::value_type* y, typename V::value_type* r)
+    {
+        size_t n = 0;
+        for (; n + V::width <= 2 * N; n += V::width)
+        {
+            auto a = V::load(x + n);
+            auto b = V::load(y + n);
+            V::store(r + n, V::fmsubadd(a, V::dup_re(b), V::mul(V::swap(a), V::dup_im(b))));
+        }
+        scalar::multiply_conj(N - n / 2, x + n, y + n, r + n);
+    }
+
+    // x/y = x*conj(y)/|y|^2, like complext
+    template <class V> void divide(size_t N, const typename V::value_type* x, const typename V::value_type* y, typename V::value_type* r)
+    {
+        size_t n = 0;
+        for (; n + V::width <= 2 * N; n += V::width)
+        {
+            auto a = V::load(x + n);
+            auto b = V::load(y + n);
+            auto b2 = V::mul(b, b);
+            auto num = V::fmsubadd(a, V::dup_re(b), V::mul(V::swap(a), V::dup_im(b)));
+            V::store(r + n, V::div(num, V::add(b2, V::swap(b2))));
+        }
+        scalar::divide(N - n / 2, x + n, y + n, r + n);
+    }
+
+    template <class V> void abs(size_t N, const typename V::value_type* x, typename V::value_type* r)
+    {
+        size_t n = 0;
+        for (; n + V::width <= N; n += V::width)
+        {
+            typename V::vec re, im;
+            V::deinterleave(V::load(x + 2 * n), V::load(x + 2 * n + V::width), re, im);
+            V::store(r + n, V::sqrt(V::fmadd(re, re, V::mul(im, im))));
+        }
+        scalar::abs(N - n, x + 2 * n, r + n);
+    }
+
+    // atan2(y, x) from a polynomial arctangent on [0, 1], after the cephes atanf and atan
+    template <class V> typename V::vec atan2(typename V::vec y, typename V::vec x)
+    {
+        typedef typename V::value_type T;
+        typedef typename V::vec vec;
+
+        const vec pi = V::set1(T(3.14159265358979323846));
+        const vec pi_2 = V::set1(T(1.57079632679489661923));
+        const vec pi_4 = V::set1(T(0.78539816339744830962));
+        const vec one = V::set1(T(1));
+
+        vec ax = V::abs(x);
+        vec ay = V::abs(y);
+        vec mx = V::max(ax, ay);
+        vec mn = V::min(ax, ay);
+
+        // a in [0, 1], and 0 for x = y = 0
+        vec a = V::select(V::eq(mx, V::zero()), V::zero(), V::div(mn, mx));
+
+        vec r;
+        if constexpr (std::is_same<T, float>::value)
+        {
+            auto big = V::gt(a, V::set1(T(0.4142135623730950)));
+            vec t = V::select(big, V::div(V::sub(a, one), V::add(a, one)), a);
+            vec z = V::mul(t, t);
+            vec p = V::fmadd(V::set1(T(8.05374449538e-2)), z, V::set1(T(-1.38776856032e-1)));
+            p = V::fmadd(p, z, V::set1(T(1.99777106478e-1)));
+            p = V::fmadd(p, z, V::set1(T(-3.33329491539e-1)));
+            r = V::fmadd(V::mul(p, z), t, t);
+            r = V::add(r, V::select(big, pi_4, V::zero()));
+        }
+        else
+        {
+            auto big = V::gt(a, V::set1(T(0.66)));
+            vec t = V::select(big, V::div(V::sub(a, one), V::add(a, one)), a);
+            vec z = V::mul(t, t);
+
+            vec p = V::fmadd(V::set1(T(-8.750608600031904122785e-1)), z, V::set1(T(-1.615753718733365076637e1)));
+            p = V::fmadd(p, z, V::set1(T(-7.500855792314704667340e1)));
+            p = V::fmadd(p, z, V::set1(T(-1.228866684490136173410e2)));
+            p = V::fmadd(p, z, V::set1(T(-6.485021904942025371773e1)));
+
+            vec q = V::add(z, V::set1(T(2.485846490142306297962e1)));
+            q = V::fmadd(q, z, V::set1(T(1.650270098316988542046e2)));
+            q = V::fmadd(q, z, V::set1(T(4.328810604912902668951e2)));
+            q = V::fmadd(q, z, V::set1(T(4.853903996359136964868e2)));
+            q = V::fmadd(q, z, V::set1(T(1.945506571482613964425e2)));
+
+            r = V::fmadd(V::div(V::mul(z, p), q), t, t);
+            r = V::add(r, V::select(big, V::set1(T(0.78539816339744830962 + 0.5 * 6.123233995736765886130e-17)), V::zero()));
+        }
+
+        r = V::select(V::gt(ay, ax), V::sub(pi_2, r), r);
+        r = V::select(V::is_negative(x), V::sub(pi, r), r);
+        return V::copysign(r, y);
+    }
+
+    template <class V> void argument(size_t N, const typename V::value_type* x, typename V::value_type* r)
+    {
+        size_t n = 0;
+        for (; n + V::width <= N; n += V::width)
+        {
+            typename V::vec re, im;
+            V::deinterleave(V::load(x + 2 * n), V::load(x + 2 * n + V::width), re, im);
+            V::store(r + n, atan2<V>(im, re));
+        }
+        scalar::argument(N - n, x + 2 * n, r + n);
+    }
+
+    template <class V> void axpy(size_t N, typename V::value_type a_re, typename V::value_type a_im, const typename V::value_type* x, typename V::value_type* y)
+    {
+        auto are = V::set1(a_re);
+        auto aim = V::set1(a_im);
+
+        size_t n = 0;
+        for (; n + V::width <= 2 * N; n += V::width)
+        {
+            auto b = V::load(x + n);
+            V::store(y + n, V::add(V::load(y + n), V::fmaddsub(b, are, V::mul(V::swap(b), aim))));
+        }
+        scalar::axpy(N - n / 2, a_re, a_im, x + n, y + n);
+    }
+
+    // conj(x)*y = (xr*yr + xi*yi) + i(xr*yi - xi*yr): the real part is the sum of x*y, the imaginary one the
+    // alternating sum of x*swap(y). Two accumulators each hide the latency of the fma.
+    template <class V> void dotc(size_t N, const typename V::value_type* x, const typename V::value_type* y, typename V::value_type* re, typename V::value_type* im)
+    {
+        typedef typename V::value_type T;
+
+        auto re0 = V::zero(), re1 = V::zero(), im0 = V::zero(), im1 = V::zero();
+
+        size_t n = 0;
+        for (; n + 2 * V::width <= 2 * N; n += 2 * V::width)
+        {
+            auto a0 = V::load(x + n), a1 = V::load(x + n + V::width);
+            auto b0 = V::load(y + n), b1 = V::load(y + n + V::width);
+            re0 = V::fmadd(a0, b0, re0);
+            re1 = V::fmadd(a1, b1, re1);
+            im0 = V::fmadd(a0, V::swap(b0), im0);
+            im1 = V::fmadd(a1, V::swap(b1), im1);
+        }
+
+        // the alternating signs of the imaginary part
+        auto alternate = V::fmsubadd(V::zero(), V::zero(), V::set1(T(1)));
+
+        T tail_re, tail_im;
+        scalar::dotc(N - n / 2, x + n, y + n, &tail_re, &tail_im);
+        *re = V::hsum(V::add(re0, re1)) + tail_re;
+        *im = V::hsum(V::mul(V::add(im0, im1), alternate)) + tail_im;
+    }
+
+    template <class V> KernelTable<typename V::value_type> make_kernels()
+    {
+        KernelTable<typename V::value_type> table;
+        table.multiply = &multiply<V>;
+        table.multiply_conj = &multiply_conj<V>;
+        table.divide = &divide<V>;
+        table.abs = &abs<V>;
+        table.argument = &argument<V>;
+        table.axpy = &axpy<V>;
+        table.dotc = &dotc<V>;
+        return table;
+    }
+}
+}
+}
+}
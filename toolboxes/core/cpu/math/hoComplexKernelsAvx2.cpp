@@ -0,0 +1,124 @@
+// Complex kernels with AVX2 and FMA, compiled with -mavx2 -mfma. See hoComplexKernels.hpp for what may be used here.
+
+#include "hoComplexKernels.hpp"
+
+#include <immintrin.h>
+
+namespace Gadgetron{
+namespace hoComplexKernels{
+namespace detail{
+
+namespace{
+
+    struct Avx2Float
+    {
+        typedef float value_type;
+        typedef __m256 vec;
+        typedef __m256 mask; // the sign bits select, like in blendv
+        static constexpr size_t width = 8;
+
+        static vec load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, vec v) { _mm256_storeu_ps(p, v); }
+        static vec set1(float v) { return _mm256_set1_ps(v); }
+        static vec zero() { return _mm256_setzero_ps(); }
+
+        static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+        static vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+        static vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+        static vec div(vec a, vec b) { return _mm256_div_ps(a, b); }
+        static vec sqrt(vec a) { return _mm256_sqrt_ps(a); }
+        static vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+        static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+        static vec fmadd(vec a, vec b, vec c) { return _mm256_fmadd_ps(a, b, c); }
+        static vec fmaddsub(vec a, vec b, vec c) { return _mm256_fmaddsub_ps(a, b, c); }
+        static vec fmsubadd(vec a, vec b, vec c) { return _mm256_fmsubadd_ps(a, b, c); }
+
+        static vec dup_re(vec a) { return _mm256_moveldup_ps(a); }
+        static vec dup_im(vec a) { return _mm256_movehdup_ps(a); }
+        static vec swap(vec a) { return _mm256_permute_ps(a, 0xB1); }
+
+        static void deinterleave(vec v0, vec v1, vec& re, vec& im)
+        {
+            // the shuffles work within the 128 bit lanes, the permutes put the pairs in order
+            re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0))), 0xD8));
+            im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1))), 0xD8));
+        }
+
+        static vec abs(vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static vec copysign(vec a, vec b)
+        {
+            const vec sign = _mm256_set1_ps(-0.0f);
+            return _mm256_or_ps(_mm256_andnot_ps(sign, a), _mm256_and_ps(sign, b));
+        }
+        static float hsum(vec a)
+        {
+            __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+            s = _mm_hadd_ps(s, s);
+            s = _mm_hadd_ps(s, s);
+            return _mm_cvtss_f32(s);
+        }
+
+        static mask gt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static mask eq(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+        static mask is_negative(vec a) { return a; }
+        static vec select(mask m, vec a, vec b) { return _mm256_blendv_ps(b, a, m); }
+    };
+
+    struct Avx2Double
+    {
+        typedef double value_type;
+        typedef __m256d vec;
+        typedef __m256d mask;
+        static constexpr size_t width = 4;
+
+        static vec load(const double* p) { return _mm256_loadu_pd(p); }
+        static void store(double* p, vec v) { _mm256_storeu_pd(p, v); }
+        static vec set1(double v) { return _mm256_set1_pd(v); }
+        static vec zero() { return _mm256_setzero_pd(); }
+
+        static vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+        static vec sub(vec a, vec b) { return _mm256_sub_pd(a, b); }
+        static vec mul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+        static vec div(vec a, vec b) { return _mm256_div_pd(a, b); }
+        static vec sqrt(vec a) { return _mm256_sqrt_pd(a); }
+        static vec min(vec a, vec b) { return _mm256_min_pd(a, b); }
+        static vec max(vec a, vec b) { return _mm256_max_pd(a, b); }
+        static vec fmadd(vec a, vec b, vec c) { return _mm256_fmadd_pd(a, b, c); }
+        static vec fmaddsub(vec a, vec b, vec c) { return _mm256_fmaddsub_pd(a, b, c); }
+        static vec fmsubadd(vec a, vec b, vec c) { return _mm256_fmsubadd_pd(a, b, c); }
+
+        static vec dup_re(vec a) { return _mm256_movedup_pd(a); }
+        static vec dup_im(vec a) { return _mm256_permute_pd(a, 0xF); }
+        static vec swap(vec a) { return _mm256_permute_pd(a, 0x5); }
+
+        static void deinterleave(vec v0, vec v1, vec& re, vec& im)
+        {
+            re = _mm256_permute4x64_pd(_mm256_unpacklo_pd(v0, v1), 0xD8);
+            im = _mm256_permute4x64_pd(_mm256_unpackhi_pd(v0, v1), 0xD8);
+        }
+
+        static vec abs(vec a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+        static vec copysign(vec a, vec b)
+        {
+            const vec sign = _mm256_set1_pd(-0.0);
+            return _mm256_or_pd(_mm256_andnot_pd(sign, a), _mm256_and_pd(sign, b));
+        }
+        static double hsum(vec a)
+        {
+            __m128d s = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+            s = _mm_hadd_pd(s, s);
+            return _mm_cvtsd_f64(s);
+        }
+
+        static mask gt(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+        static mask eq(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+        static mask is_negative(vec a) { return a; }
+        static vec select(mask m, vec a, vec b) { return _mm256_blendv_pd(b, a, m); }
+    };
+}
+
+    template <> KernelTable<float> avx2_kernels<float>() { return make_kernels<Avx2Float>(); }
+    template <> KernelTable<double> avx2_kernels<double>() { return make_kernels<Avx2Double>(); }
+}
+}
+}
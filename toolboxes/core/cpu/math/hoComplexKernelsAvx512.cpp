@@ -0,0 +1,117 @@
+// Complex kernels with AVX-512F, compiled with -mavx512f. See hoComplexKernels.hpp for what may be used here.
+
+#include "hoComplexKernels.hpp"
+
+#include <immintrin.h>
+
+namespace Gadgetron{
+namespace hoComplexKernels{
+namespace detail{
+
+namespace{
+
+    // the bitwise operations on floating point vectors are AVX-512DQ, so they go through the integer ones
+    struct Avx512Float
+    {
+        typedef float value_type;
+        typedef __m512 vec;
+        typedef __mmask16 mask;
+        static constexpr size_t width = 16;
+
+        static vec load(const float* p) { return _mm512_loadu_ps(p); }
+        static void store(float* p, vec v) { _mm512_storeu_ps(p, v); }
+        static vec set1(float v) { return _mm512_set1_ps(v); }
+        static vec zero() { return _mm512_setzero_ps(); }
+
+        static vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+        static vec sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+        static vec mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+        static vec div(vec a, vec b) { return _mm512_div_ps(a, b); }
+        static vec sqrt(vec a) { return _mm512_sqrt_ps(a); }
+        static vec min(vec a, vec b) { return _mm512_min_ps(a, b); }
+        static vec max(vec a, vec b) { return _mm512_max_ps(a, b); }
+        static vec fmadd(vec a, vec b, vec c) { return _mm512_fmadd_ps(a, b, c); }
+        static vec fmaddsub(vec a, vec b, vec c) { return _mm512_fmaddsub_ps(a, b, c); }
+        static vec fmsubadd(vec a, vec b, vec c) { return _mm512_fmsubadd_ps(a, b, c); }
+
+        static vec dup_re(vec a) { return _mm512_moveldup_ps(a); }
+        static vec dup_im(vec a) { return _mm512_movehdup_ps(a); }
+        static vec swap(vec a) { return _mm512_permute_ps(a, 0xB1); }
+
+        static void deinterleave(vec v0, vec v1, vec& re, vec& im)
+        {
+            const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+            const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+            re = _mm512_permutex2var_ps(v0, even, v1);
+            im = _mm512_permutex2var_ps(v0, odd, v1);
+        }
+
+        static vec abs(vec a) { return _mm512_abs_ps(a); }
+        static vec copysign(vec a, vec b)
+        {
+            const __m512i sign = _mm512_set1_epi32(0x80000000);
+            return _mm512_castsi512_ps(_mm512_or_si512(_mm512_andnot_si512(sign, _mm512_castps_si512(a)), _mm512_and_si512(sign, _mm512_castps_si512(b))));
+        }
+        static float hsum(vec a) { return _mm512_reduce_add_ps(a); }
+
+        static mask gt(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+        static mask eq(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+        static mask is_negative(vec a) { return _mm512_test_epi32_mask(_mm512_castps_si512(a), _mm512_set1_epi32(0x80000000)); }
+        static vec select(mask m, vec a, vec b) { return _mm512_mask_blend_ps(m, b, a); }
+    };
+
+    struct Avx512Double
+    {
+        typedef double value_type;
+        typedef __m512d vec;
+        typedef __mmask8 mask;
+        static constexpr size_t width = 8;
+
+        static vec load(const double* p) { return _mm512_loadu_pd(p); }
+        static void store(double* p, vec v) { _mm512_storeu_pd(p, v); }
+        static vec set1(double v) { return _mm512_set1_pd(v); }
+        static vec zero() { return _mm512_setzero_pd(); }
+
+        static vec add(vec a, vec b) { return _mm512_add_pd(a, b); }
+        static vec sub(vec a, vec b) { return _mm512_sub_pd(a, b); }
+        static vec mul(vec a, vec b) { return _mm512_mul_pd(a, b); }
+        static vec div(vec a, vec b) { return _mm512_div_pd(a, b); }
+        static vec sqrt(vec a) { return _mm512_sqrt_pd(a); }
+        static vec min(vec a, vec b) { return _mm512_min_pd(a, b); }
+        static vec max(vec a, vec b) { return _mm512_max_pd(a, b); }
+        static vec fmadd(vec a, vec b, vec c) { return _mm512_fmadd_pd(a, b, c); }
+        static vec fmaddsub(vec a, vec b, vec c) { return _mm512_fmaddsub_pd(a, b, c); }
+        static vec fmsubadd(vec a, vec b, vec c) { return _mm512_fmsubadd_pd(a, b, c); }
+
+        static vec dup_re(vec a) { return _mm512_movedup_pd(a); }
+        static vec dup_im(vec a) { return _mm512_permute_pd(a, 0xFF); }
+        static vec swap(vec a) { return _mm512_permute_pd(a, 0x55); }
+
+        static void deinterleave(vec v0, vec v1, vec& re, vec& im)
+        {
+            const __m512i even = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+            const __m512i odd = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+            re = _mm512_permutex2var_pd(v0, even, v1);
+            im = _mm512_permutex2var_pd(v0, odd, v1);
+        }
+
+        static vec abs(vec a) { return _mm512_abs_pd(a); }
+        static vec copysign(vec a, vec b)
+        {
+            const __m512i sign = _mm512_set1_epi64(0x8000000000000000LL);
+            return _mm512_castsi512_pd(_mm512_or_si512(_mm512_andnot_si512(sign, _mm512_castpd_si512(a)), _mm512_and_si512(sign, _mm512_castpd_si512(b))));
+        }
+        static double hsum(vec a) { return _mm512_reduce_add_pd(a); }
+
+        static mask gt(vec a, vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+        static mask eq(vec a, vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+        static mask is_negative(vec a) { return _mm512_test_epi64_mask(_mm512_castpd_si512(a), _mm512_set1_epi64(0x8000000000000000LL)); }
+        static vec select(mask m, vec a, vec b) { return _mm512_mask_blend_pd(m, b, a); }
+    };
+}
+
+    template <> KernelTable<float> avx512_kernels<float>() { return make_kernels<Avx512Float>(); }
+    template <> KernelTable<double> avx512_kernels<double>() { return make_kernels<Avx512Double>(); }
+}
+}
+}
@@ -23,7 +23,16 @@
 #define NumElementsUseThreading 64 * 1024
 
 namespace {
-
+    // the complex types with a vectorised abs and argument in hoComplexKernels
+    template <class T, class R> constexpr bool use_complex_kernel = false;
+    template <> constexpr bool use_complex_kernel<std::complex<float>, float> = true;
+    template <> constexpr bool use_complex_kernel<std::complex<double>, double> = true;
+    template <> constexpr bool use_complex_kernel<Gadgetron::complext<float>, float> = true;
+    template <> constexpr bool use_complex_kernel<Gadgetron::complext<double>, double> = true;
+
+    template <class T, class R> const std::complex<R>* as_std_complex(const T* x) {
+        return reinterpret_cast<const std::complex<R>*>(x);
+    }
 }
 
 namespace Gadgetron {
@@ -65,16 +74,16 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
-        using std::arg;
-        transform(x,r,[](auto val){return arg(val);});
+        hoComplexKernels::argument(x.size(), x.data(), r.data());
     }
 
     template  void argument(const hoNDArray<std::complex<float>>& x, hoNDArray<float>& r);
     template  void argument(const hoNDArray<std::complex<double>>& x, hoNDArray<double>& r);
 
     template <class T> hoNDArray<realType_t<T>> argument(const hoNDArray<T>& x) {
-        using std::arg;
-        return Gadgetron::transform(x,[](const auto& v){return arg(v);});
+        hoNDArray<realType_t<T>> r(x.dimensions());
+        hoComplexKernels::argument(x.size(), x.data(), r.data());
+        return r;
     }
 
     template  hoNDArray<float> argument(const hoNDArray<std::complex<float>>& x);
@@ -102,7 +111,11 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
-        transform(x,r,[](auto val){return abs(val);});
+        if constexpr (use_complex_kernel<T, R>) {
+            hoComplexKernels::abs(x.size(), as_std_complex<T, R>(x.data()), r.data());
+        } else {
+            transform(x,r,[](auto val){return abs(val);});
+        }
     }
 
     template  void abs(const hoNDArray<float>& x, hoNDArray<float>& r);
@@ -117,8 +130,14 @@ namespace Gadgetron {
     template  void abs(const hoNDArray<complext<double>>& x, hoNDArray<complext<double>>& r);
 
     template <class T> hoNDArray<realType_t<T>> abs(const hoNDArray<T>& x) {
-        using std::abs;
-        return transform(x,[](auto val){return abs(val);}) ;
+        if constexpr (use_complex_kernel<T, realType_t<T>>) {
+            hoNDArray<realType_t<T>> r(x.dimensions());
+            hoComplexKernels::abs(x.size(), as_std_complex<T, realType_t<T>>(x.data()), r.data());
+            return r;
+        } else {
+            using std::abs;
+            return transform(x,[](auto val){return abs(val);}) ;
+        }
     }
 
     template  hoNDArray<float> abs(const hoNDArray<float>& x);
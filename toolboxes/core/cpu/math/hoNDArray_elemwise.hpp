@@ -53,18 +53,52 @@ namespace {
             }
         }
 
-        template <class T, class S, class BinaryFunction>
-        void transform_arrays_inplace(hoNDArray<T>& x, const hoNDArray<S>& y, BinaryFunction&& op) {
+        // --------------------------------------------------------------------------------
+
+        // the complex types with a vectorised kernel in hoComplexKernels, and their real type
+        template <class T> struct complexKernelType { typedef void type; };
+        template <> struct complexKernelType<std::complex<float>> { typedef float type; };
+        template <> struct complexKernelType<std::complex<double>> { typedef double type; };
+        template <> struct complexKernelType<Gadgetron::complext<float>> { typedef float type; };
+        template <> struct complexKernelType<Gadgetron::complext<double>> { typedef double type; };
+
+        // used when an operation has no kernel
+        struct NoKernel {};
+
+        // as transform_impl, with a kernel of hoComplexKernels when x, y and r are complex float or double arrays
+        template<class T, class S, class BinaryOperator, class Kernel>
+        inline void transform_impl(size_t sizeX, size_t sizeY, const T *x, const S *y,
+                                   typename mathReturnType<T, S>::type *r, BinaryOperator op, Kernel kernel) {
+            if constexpr (!std::is_same<Kernel, NoKernel>::value && std::is_same<T, S>::value
+                          && !std::is_void<typename complexKernelType<T>::type>::value) {
+                if (sizeY > 0 && sizeX % sizeY == 0) {
+                    typedef std::complex<typename complexKernelType<T>::type> C;
+                    const C *a = reinterpret_cast<const C *>(x);
+                    const C *b = reinterpret_cast<const C *>(y);
+                    C *c = reinterpret_cast<C *>(r);
+
+                    // y is broadcast over blocks of x
+                    for (size_t offset = 0; offset < sizeX; offset += sizeY) {
+                        kernel(sizeY, a + offset, b, c + offset);
+                    }
+                    return;
+                }
+            }
+            transform_impl(sizeX, sizeY, x, y, r, op);
+        }
+
+        template <class T, class S, class BinaryFunction, class Kernel = NoKernel>
+        void transform_arrays_inplace(hoNDArray<T>& x, const hoNDArray<S>& y, BinaryFunction&& op, Kernel kernel = Kernel()) {
             if (!compatible_dimensions<T, S>(x, y)) {
                 throw std::runtime_error("add: x and y have incompatible dimensions.");
             }
             transform_impl(x.get_number_of_elements(), y.get_number_of_elements(), x.data(), y.data(), x.data(),
-                std::forward<BinaryFunction>(op));
+                std::forward<BinaryFunction>(op), kernel);
         }
 
-        template <class T, class S, class BinaryFunction>
+        template <class T, class S, class BinaryFunction, class Kernel = NoKernel>
         void transform_arrays(const hoNDArray<T>& x, const hoNDArray<S>& y,
-            hoNDArray<typename mathReturnType<T, S>::type>& r, BinaryFunction&& op) {
+            hoNDArray<typename mathReturnType<T, S>::type>& r, BinaryFunction&& op, Kernel kernel = Kernel()) {
             // Check the dimensions os x and y for broadcasting.
             if (!compatible_dimensions<T, S>(x, y)) {
                 throw std::runtime_error("add: x and y have incompatible dimensions.");
@@ -87,8 +121,12 @@ namespace {
             }
 
             transform_impl(x.get_number_of_elements(), y.get_number_of_elements(), x.begin(), y.begin(), r.begin(),
-                std::forward<BinaryFunction>(op));
+                std::forward<BinaryFunction>(op), kernel);
         }
+
+        const auto multiply_kernel = [](size_t N, const auto *x, const auto *y, auto *r) { hoComplexKernels::multiply(N, x, y, r); };
+        const auto multiply_conj_kernel = [](size_t N, const auto *x, const auto *y, auto *r) { hoComplexKernels::multiply_conj(N, x, y, r); };
+        const auto divide_kernel = [](size_t N, const auto *x, const auto *y, auto *r) { hoComplexKernels::divide(N, x, y, r); };
     }
 }
 
@@ -106,18 +144,18 @@ void Gadgetron::subtract(
 template <class T, class S>
 void Gadgetron::multiply(
     const hoNDArray<T>& x, const hoNDArray<S>& y, hoNDArray<typename mathReturnType<T, S>::type>& r) {
-    ::gadgetron_detail::transform_arrays(x, y, r, std::multiplies<>());
+    ::gadgetron_detail::transform_arrays(x, y, r, std::multiplies<>(), ::gadgetron_detail::multiply_kernel);
 }
 
 template <class T, class S>
 void Gadgetron::divide(
     const hoNDArray<T>& x, const hoNDArray<S>& y, hoNDArray<typename mathReturnType<T, S>::type>& r) {
-    ::gadgetron_detail::transform_arrays(x, y, r, std::divides<>());
+    ::gadgetron_detail::transform_arrays(x, y, r, std::divides<>(), ::gadgetron_detail::divide_kernel);
 }
 template <class T, class S>
 void Gadgetron::multiplyConj(
     const hoNDArray<T>& x, const hoNDArray<S>& y, hoNDArray<typename mathReturnType<T, S>::type>& r) {
-    ::gadgetron_detail::transform_arrays(x, y, r, [](auto& a, auto& b) { return a * conj(b); });
+    ::gadgetron_detail::transform_arrays(x, y, r, [](auto& a, auto& b) { return a * conj(b); }, ::gadgetron_detail::multiply_conj_kernel);
 }
 
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator+=(hoNDArray<T>& x, const hoNDArray<S>& y) {
@@ -129,11 +167,11 @@ template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator-=(hoNDA
     return x;
 }
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator*=(hoNDArray<T>& x, const hoNDArray<S>& y) {
-    ::gadgetron_detail::transform_arrays_inplace(x, y, std::multiplies<>());
+    ::gadgetron_detail::transform_arrays_inplace(x, y, std::multiplies<>(), ::gadgetron_detail::multiply_kernel);
     return x;
 }
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator/=(hoNDArray<T>& x, const hoNDArray<S>& y) {
-    ::gadgetron_detail::transform_arrays_inplace(x, y, std::divides<>());
+    ::gadgetron_detail::transform_arrays_inplace(x, y, std::divides<>(), ::gadgetron_detail::divide_kernel);
     return x;
 }
 
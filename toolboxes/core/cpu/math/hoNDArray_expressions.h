@@ -0,0 +1,439 @@
+/** \file hoNDArray_expressions.h
+    \brief Lazy elementwise expressions on hoNDArrays.
+
+    The operators of hoNDArray_elemwise.h evaluate every operation into its own array, so a chain like
+    a*b + c*d makes four passes over memory and allocates three temporaries. The expressions in this header
+    record the chain instead and evaluate it in a single pass when it is assigned or reduced:
+
+        assign(r, lazy(a)*lazy(b) + lazy(c)*lazy(d));
+        auto n = nrm2(lazy(u) - lazy(u_prev));
+
+    The API is opt-in; nothing in hoNDArray_math.h returns an expression.
+
+    Arrays are broadcast like in hoNDArray_elemwise.h: an operand whose dimensions are the leading dimensions of
+    the result is repeated over the remaining ones. A one dimensional array can also be repeated along any other
+    dimension of the result with along(f, dim, dims), which applies separable filters without building the full
+    filter array.
+
+    Expressions hold pointers to their arrays and have to be evaluated while the arrays are alive, i.e. in the
+    statement that builds them. The result of assign can be one of the operands of full size, but not one that is
+    broadcast. Scalars are real or std::complex; the unconstrained operators of complext would capture a complext
+    scalar. Complex values are evaluated as complext so that the loops vectorise, and the loops are OpenMP parallel
+    for arrays above NumElementsUseThreading.
+*/
+
+#pragma once
+
+#include "complext.h"
+#include "hoNDArray.h"
+
+#include <cmath>
+#include <complex>
+#include <type_traits>
+
+#ifndef NumElementsUseThreading
+#define NumElementsUseThreading 64 * 1024
+#endif // NumElementsUseThreading
+
+namespace Gadgetron{
+namespace Expressions{
+
+    namespace detail{
+
+        // std::complex is evaluated as complext, which has inlined arithmetic
+        template <class T> struct internal_type { typedef T type; };
+        template <class T> struct internal_type<std::complex<T>> { typedef complext<T> type; };
+        template <class T> using internal_t = typename internal_type<T>::type;
+
+        // and reduced values are returned as std::complex again
+        template <class T> struct external_type { typedef T type; };
+        template <class T> struct external_type<complext<T>> { typedef std::complex<T> type; };
+        template <class T> using external_t = typename external_type<T>::type;
+
+        // a line is a run of the first dimension; long lines are split into blocks for the threads
+        constexpr size_t block_length = 4096;
+    }
+
+    /**
+    * @brief Base of all expressions. Every expression E provides
+    *   value_type                       the (internal) type of its elements
+    *   line(l)                          a cursor on the line l; cursor[i] is the element of the linear index l*L + i.
+    *                                    Everything that is constant along a line is resolved here, so the loop
+    *                                    over a line only loads and computes.
+    *   size(), line_length()            the number of elements and the first dimension of the largest array
+    *   dimensions()                     the dimensions of the largest array, or nullptr if it has none
+    *   compatible(N, L)                 whether it can be evaluated for N elements in lines of L
+    */
+    template <class E> struct Expression
+    {
+        const E& self() const { return static_cast<const E&>(*this); }
+    };
+
+    /**
+    * @brief An array, broadcast over the trailing dimensions of the result
+    */
+    template <class T> class ArrayTerminal : public Expression<ArrayTerminal<T>>
+    {
+    public:
+        typedef detail::internal_t<T> value_type;
+
+        explicit ArrayTerminal(const hoNDArray<T>& x)
+            : data_(reinterpret_cast<const value_type*>(x.get_data_ptr())), dims_(&x.dimensions())
+            , N_(x.get_number_of_elements()), L_(x.get_number_of_dimensions() ? x.get_size(0) : 0)
+            , lines_(L_ ? N_ / L_ : 0)
+        {
+        }
+
+        struct Cursor
+        {
+            const value_type* p;
+            value_type operator[](size_t i) const { return p[i]; }
+        };
+
+        Cursor line(size_t l) const { return Cursor{ data_ + (l % lines_) * L_ }; }
+
+        size_t size() const { return N_; }
+        size_t line_length() const { return L_; }
+        const std::vector<size_t>* dimensions() const { return dims_; }
+        bool compatible(size_t N, size_t L) const { return L_ == L && N_ > 0 && N % N_ == 0; }
+
+    private:
+        const value_type* data_;
+        const std::vector<size_t>* dims_;
+        size_t N_, L_, lines_;
+    };
+
+    /**
+    * @brief A one dimensional array repeated along all dimensions of the result but one, which is not the first.
+    * Along the first dimension an array is broadcast by lazy(f) already.
+    */
+    template <class T> class AxisTerminal : public Expression<AxisTerminal<T>>
+    {
+    public:
+        typedef detail::internal_t<T> value_type;
+
+        AxisTerminal(const hoNDArray<T>& f, size_t dim, const std::vector<size_t>& dims)
+            : data_(reinterpret_cast<const value_type*>(f.get_data_ptr())), len_(f.get_number_of_elements())
+            , stride_(1), N_(1), L_(dims.empty() ? 0 : dims[0])
+        {
+            GADGET_CHECK_THROW(dim > 0 && dim < dims.size() && dims[dim] == len_);
+            for (size_t d = 1; d < dim; d++) stride_ *= dims[d];
+            for (auto d : dims) N_ *= d;
+        }
+
+        struct Cursor
+        {
+            value_type v;
+            value_type operator[](size_t) const { return v; }
+        };
+
+        Cursor line(size_t l) const { return Cursor{ data_[(l / stride_) % len_] }; }
+
+        size_t size() const { return N_; }
+        size_t line_length() const { return L_; }
+        const std::vector<size_t>* dimensions() const { return nullptr; }
+        bool compatible(size_t N, size_t L) const { return N == N_ && L == L_; }
+
+    private:
+        const value_type* data_;
+        size_t len_, stride_, N_, L_;
+    };
+
+    /**
+    * @brief A scalar, repeated for every element
+    */
+    template <class T> class ScalarTerminal : public Expression<ScalarTerminal<T>>
+    {
+    public:
+        typedef detail::internal_t<T> value_type;
+
+        explicit ScalarTerminal(T v) : v_(*reinterpret_cast<const value_type*>(&v)) {}
+
+        struct Cursor
+        {
+            value_type v;
+            value_type operator[](size_t) const { return v; }
+        };
+
+        Cursor line(size_t) const { return Cursor{ v_ }; }
+
+        size_t size() const { return 0; }
+        size_t line_length() const { return 0; }
+        const std::vector<size_t>* dimensions() const { return nullptr; }
+        bool compatible(size_t, size_t) const { return true; }
+
+    private:
+        value_type v_;
+    };
+
+    template <class Op, class A> class UnaryExpression : public Expression<UnaryExpression<Op, A>>
+    {
+    public:
+        typedef decltype(Op()(std::declval<typename A::value_type>())) value_type;
+
+        explicit UnaryExpression(const A& a) : a_(a) {}
+
+        struct Cursor
+        {
+            typename A::Cursor a;
+            value_type operator[](size_t i) const { return Op()(a[i]); }
+        };
+
+        Cursor line(size_t l) const { return Cursor{ a_.line(l) }; }
+
+        size_t size() const { return a_.size(); }
+        size_t line_length() const { return a_.line_length(); }
+        const std::vector<size_t>* dimensions() const { return a_.dimensions(); }
+        bool compatible(size_t N, size_t L) const { return a_.compatible(N, L); }
+
+    private:
+        A a_;
+    };
+
+    template <class Op, class A, class B> class BinaryExpression : public Expression<BinaryExpression<Op, A, B>>
+    {
+    public:
+        typedef decltype(Op()(std::declval<typename A::value_type>(), std::declval<typename B::value_type>())) value_type;
+
+        BinaryExpression(const A& a, const B& b) : a_(a), b_(b) {}
+
+        struct Cursor
+        {
+            typename A::Cursor a;
+            typename B::Cursor b;
+            value_type operator[](size_t i) const { return Op()(a[i], b[i]); }
+        };
+
+        Cursor line(size_t l) const { return Cursor{ a_.line(l), b_.line(l) }; }
+
+        // the largest operand sets the shape of the result
+        size_t size() const { return a_.size() >= b_.size() ? a_.size() : b_.size(); }
+        size_t line_length() const { return a_.size() >= b_.size() ? a_.line_length() : b_.line_length(); }
+        const std::vector<size_t>* dimensions() const
+        {
+            if (a_.dimensions() && b_.dimensions()) return a_.size() >= b_.size() ? a_.dimensions() : b_.dimensions();
+            return a_.dimensions() ? a_.dimensions() : b_.dimensions();
+        }
+        bool compatible(size_t N, size_t L) const { return a_.compatible(N, L) && b_.compatible(N, L); }
+
+    private:
+        A a_;
+        B b_;
+    };
+
+    namespace ops{
+        struct plus { template <class A, class B> auto operator()(const A& a, const B& b) const { return a + b; } };
+        struct minus { template <class A, class B> auto operator()(const A& a, const B& b) const { return a - b; } };
+        struct multiplies { template <class A, class B> auto operator()(const A& a, const B& b) const { return a * b; } };
+        struct divides { template <class A, class B> auto operator()(const A& a, const B& b) const { return a / b; } };
+        struct negate { template <class A> A operator()(const A& a) const { A t(a); return -t; } };
+        struct conj_op { template <class A> A operator()(const A& a) const { return Gadgetron::conj(a); } };
+        struct abs_op { template <class A> auto operator()(const A& a) const { using std::abs; return abs(a); } };
+        struct norm_op { template <class A> auto operator()(const A& a) const { return Gadgetron::norm(a); } };
+        struct real_op { template <class A> auto operator()(const A& a) const { return Gadgetron::real(a); } };
+        struct imag_op { template <class A> auto operator()(const A& a) const { return Gadgetron::imag(a); } };
+    }
+
+    // ----------------------------------------------------------------------------------------
+    // building expressions
+    // ----------------------------------------------------------------------------------------
+
+    /**
+    * @brief Starts an expression from an array
+    */
+    template <class T> ArrayTerminal<T> lazy(const hoNDArray<T>& x) { return ArrayTerminal<T>(x); }
+
+    /**
+    * @brief Repeats the one dimensional array f along the dimension dim > 0 of an array of dimensions dims
+    */
+    template <class T> AxisTerminal<T> along(const hoNDArray<T>& f, size_t dim, const std::vector<size_t>& dims)
+    {
+        return AxisTerminal<T>(f, dim, dims);
+    }
+
+    namespace detail{
+        template <class T> struct is_scalar : std::is_arithmetic<T> {};
+        template <class T> struct is_scalar<std::complex<T>> : std::true_type {};
+
+        // real scalars take the precision of the expression, so float arrays are not promoted by double literals
+        template <class S, class V> using scalar_t = std::conditional_t<std::is_arithmetic<S>::value, typename realType<V>::Type, S>;
+    }
+
+#define GADGETRON_EXPRESSION_BINARY_OPERATOR(OP, FUNCTOR)                                                                  \
+    template <class A, class B> BinaryExpression<ops::FUNCTOR, A, B> operator OP(const Expression<A>& a, const Expression<B>& b) \
+    {                                                                                                                      \
+        return BinaryExpression<ops::FUNCTOR, A, B>(a.self(), b.self());                                                  \
+    }                                                                                                                      \
+    template <class A, class S, class = std::enable_if_t<detail::is_scalar<S>::value>>                                     \
+    auto operator OP(const Expression<A>& a, S s)                                                                          \
+    {                                                                                                                      \
+        typedef detail::scalar_t<S, typename A::value_type> V;                                                             \
+        return BinaryExpression<ops::FUNCTOR, A, ScalarTerminal<V>>(a.self(), ScalarTerminal<V>(V(s)));                    \
+    }                                                                                                                      \
+    template <class S, class B, class = std::enable_if_t<detail::is_scalar<S>::value>>                                     \
+    auto operator OP(S s, const Expression<B>& b)                                                                          \
+    {                                                                                                                      \
+        typedef detail::scalar_t<S, typename B::value_type> V;                                                             \
+        return BinaryExpression<ops::FUNCTOR, ScalarTerminal<V>, B>(ScalarTerminal<V>(V(s)), b.self());                    \
+    }
+
+    GADGETRON_EXPRESSION_BINARY_OPERATOR(+, plus)
+    GADGETRON_EXPRESSION_BINARY_OPERATOR(-, minus)
+    GADGETRON_EXPRESSION_BINARY_OPERATOR(*, multiplies)
+    GADGETRON_EXPRESSION_BINARY_OPERATOR(/, divides)
+
+#undef GADGETRON_EXPRESSION_BINARY_OPERATOR
+
+    template <class A> UnaryExpression<ops::negate, A> operator-(const Expression<A>& a) { return UnaryExpression<ops::negate, A>(a.self()); }
+    template <class A> UnaryExpression<ops::conj_op, A> conj(const Expression<A>& a) { return UnaryExpression<ops::conj_op, A>(a.self()); }
+    template <class A> UnaryExpression<ops::abs_op, A> abs(const Expression<A>& a) { return UnaryExpression<ops::abs_op, A>(a.self()); }
+    template <class A> UnaryExpression<ops::norm_op, A> norm(const Expression<A>& a) { return UnaryExpression<ops::norm_op, A>(a.self()); }
+    template <class A> UnaryExpression<ops::real_op, A> real(const Expression<A>& a) { return UnaryExpression<ops::real_op, A>(a.self()); }
+    template <class A> UnaryExpression<ops::imag_op, A> imag(const Expression<A>& a) { return UnaryExpression<ops::imag_op, A>(a.self()); }
+
+    // ----------------------------------------------------------------------------------------
+    // evaluation
+    // ----------------------------------------------------------------------------------------
+
+    namespace detail{
+
+        // calls f(line, begin, end) for every block of every line, in parallel for large arrays
+        template <class F> void for_each_block(size_t N, size_t L, F f)
+        {
+            size_t num_lines = N / L;
+            size_t blocks_per_line = (L + block_length - 1) / block_length;
+            long long num_tasks = (long long)(num_lines * blocks_per_line);
+
+            long long t;
+#pragma omp parallel for if(N > NumElementsUseThreading)
+            for (t = 0; t < num_tasks; t++)
+            {
+                size_t line = t / blocks_per_line;
+                size_t begin = (t % blocks_per_line) * block_length;
+                size_t end = begin + block_length < L ? begin + block_length : L;
+                f(line, begin, end);
+            }
+        }
+
+        template <class E> void check_shape(const E& e, size_t N, size_t L)
+        {
+            GADGET_CHECK_THROW(N > 0 && L > 0 && N % L == 0);
+            GADGET_CHECK_THROW(e.compatible(N, L));
+        }
+    }
+
+    /**
+    * @brief r = e, evaluated in a single pass. r is created with the dimensions of the largest array of e if its
+    * number of elements does not match.
+    */
+    template <class T, class E> void assign(hoNDArray<T>& r, const Expression<E>& expr)
+    {
+        const E& e = expr.self();
+        if (r.get_number_of_elements() != e.size())
+        {
+            GADGET_CHECK_THROW(e.dimensions() != nullptr);
+            r.create(*e.dimensions());
+        }
+
+        size_t N = r.get_number_of_elements();
+        size_t L = e.line_length();
+        detail::check_shape(e, N, L);
+
+        typedef detail::internal_t<T> value_type;
+        value_type* pr = reinterpret_cast<value_type*>(r.get_data_ptr());
+
+        detail::for_each_block(N, L, [&](size_t line, size_t begin, size_t end)
+        {
+            value_type* po = pr + line * L;
+            auto c = e.line(line);
+#pragma omp simd
+            for (size_t i = begin; i < end; i++)
+                po[i] = value_type(c[i]);
+        });
+    }
+
+    /**
+    * @brief Returns a new array holding e
+    */
+    template <class E> auto eval(const Expression<E>& expr)
+    {
+        hoNDArray<detail::external_t<typename E::value_type>> r;
+        assign(r, expr);
+        return r;
+    }
+
+    /**
+    * @brief Returns the sum of all elements of e
+    */
+    template <class E> auto sum(const Expression<E>& expr)
+    {
+        typedef typename E::value_type value_type;
+        typedef typename realType<value_type>::Type REAL;
+
+        const E& e = expr.self();
+        size_t N = e.size();
+        size_t L = e.line_length();
+        detail::check_shape(e, N, L);
+
+        size_t num_lines = N / L;
+        size_t blocks_per_line = (L + detail::block_length - 1) / detail::block_length;
+        long long num_tasks = (long long)(num_lines * blocks_per_line);
+
+        REAL re(0), im(0);
+        long long t;
+#pragma omp parallel for reduction(+:re,im) if(N > NumElementsUseThreading)
+        for (t = 0; t < num_tasks; t++)
+        {
+            size_t line = t / blocks_per_line;
+            size_t begin = (t % blocks_per_line) * detail::block_length;
+            size_t end = begin + detail::block_length < L ? begin + detail::block_length : L;
+
+            REAL block_re(0), block_im(0);
+            auto c = e.line(line);
+            if constexpr (is_complex_type_v<value_type>)
+            {
+#pragma omp simd reduction(+:block_re,block_im)
+                for (size_t i = begin; i < end; i++)
+                {
+                    value_type v = c[i];
+                    block_re += v.real();
+                    block_im += v.imag();
+                }
+            }
+            else
+            {
+#pragma omp simd reduction(+:block_re)
+                for (size_t i = begin; i < end; i++)
+                    block_re += c[i];
+            }
+            re += block_re;
+            im += block_im;
+        }
+
+        if constexpr (is_complex_type_v<value_type>)
+            return detail::external_t<value_type>(re, im);
+        else
+            return re;
+    }
+
+    /**
+    * @brief Returns sum(conj(a)*b), like Gadgetron::dot
+    */
+    template <class A, class B> auto dot(const Expression<A>& a, const Expression<B>& b)
+    {
+        return sum(conj(a) * b);
+    }
+
+    /**
+    * @brief Returns the l2 norm of e
+    */
+    template <class E> auto nrm2(const Expression<E>& e)
+    {
+        using std::sqrt;
+        return sqrt(sum(norm(e)));
+    }
+}
+
+    using Expressions::lazy;
+    using Expressions::along;
+}
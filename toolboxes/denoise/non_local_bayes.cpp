@@ -4,24 +4,37 @@
 #include <GadgetronTimer.h>
 #include "hoArmadillo.h"
 #include <numeric>
+#include <algorithm>
 
 namespace Gadgetron {
     namespace Denoise {
 
         namespace {
 
+            // periodic extension of the image by pad pixels on every side, so the patch of pixel (x, y) starts at (x, y)
             template<class T>
-            arma::Col<T> get_patch(const hoNDArray<T> &image, int x, int y, int patch_size,
-                                   const vector_td<int, 2> &image_dims) {
+            hoNDArray<T> pad_periodic(const hoNDArray<T> &image, int pad, const vector_td<int, 2> &image_dims) {
 
-                const int N = patch_size * patch_size;
-                arma::Col<T> window = arma::Col<T>(N);
+                hoNDArray<T> padded(image_dims[0] + 2 * pad, image_dims[1] + 2 * pad);
+                for (int y = 0; y < image_dims[1] + 2 * pad; y++) {
+                    for (int x = 0; x < image_dims[0] + 2 * pad; x++) {
+                        padded(x, y) = image((x - pad + image_dims[0]) % image_dims[0],
+                                             (y - pad + image_dims[1]) % image_dims[1]);
+                    }
+                }
+                return padded;
+            };
+
+            template<class T>
+            arma::Col<T> get_patch(const hoNDArray<T> &padded, int x, int y, int patch_size) {
+
+                const int stride = padded.get_size(0);
+                const T *data = padded.get_data_ptr() + y * stride + x;
+
+                arma::Col<T> window = arma::Col<T>(patch_size * patch_size);
                 for (int ky = 0; ky < patch_size; ky++) {
                     for (int kx = 0; kx < patch_size; kx++) {
-                        window[kx + ky * patch_size] = image(
-                                ((kx - patch_size / 2) + x + image_dims[0]) % image_dims[0],
-                                ((ky - patch_size / 2) + y + image_dims[1]) % image_dims[1]);
-
+                        window[kx + ky * patch_size] = data[kx + ky * stride];
                     }
                 }
                 return window;
@@ -36,25 +49,59 @@ namespace Gadgetron {
             };
 
 
+            /**
+             * Finds the max_n_patches patches in the search window closest to the patch at (kx, ky).
+             * Distances are computed straight from the padded image and only the selected patches are extracted.
+             */
             template<class T>
             std::vector<ImagePatch<T>>
-            create_patches(const hoNDArray<T> &image, int kx, int ky, int patch_size, int search_window,
-                           const vector_td<int, 2> &image_dims) {
+            find_similar_patches(const hoNDArray<T> &padded, int kx, int ky, int patch_size, int search_window,
+                                 int max_n_patches, const vector_td<int, 2> &image_dims) {
 
-                std::vector<ImagePatch<T>> result;
-                result.reserve(search_window);
+                struct Candidate {
+                    float distance;
+                    int index, x, y;
+                };
+
+                const int stride = padded.get_size(0);
+                const T *reference = padded.get_data_ptr() + ky * stride + kx;
+
+                std::vector<Candidate> candidates;
+                candidates.reserve(search_window * search_window);
 
                 for (int dy = std::max(ky - search_window / 2, 0);
                      dy < std::min(search_window / 2 + ky, image_dims[1]); dy++) {
                     for (int dx = std::max(kx - search_window / 2, 0);
                          dx < std::min(search_window / 2 + kx, image_dims[0]); dx++) {
 
-                        result.push_back(ImagePatch<T>{get_patch(image, dx, dy, patch_size, image_dims), dx, dy});
+                        const T *candidate = padded.get_data_ptr() + dy * stride + dx;
+
+                        float distance = 0;
+                        for (int py = 0; py < patch_size; py++) {
+                            for (int px = 0; px < patch_size; px++) {
+                                distance += std::norm(reference[px + py * stride] - candidate[px + py * stride]);
+                            }
+                        }
+
+                        candidates.push_back(Candidate{distance, int(candidates.size()), dx, dy});
                     }
                 }
 
-                return result;
+                int n_patches = std::min<int>(candidates.size(), max_n_patches);
+                std::partial_sort(candidates.begin(), candidates.begin() + n_patches, candidates.end(),
+                                  [](const Candidate &c1, const Candidate &c2) {
+                                      return c1.distance < c2.distance ||
+                                             (c1.distance == c2.distance && c1.index < c2.index);
+                                  });
+
+                std::vector<ImagePatch<T>> result;
+                result.reserve(n_patches);
+                for (int i = 0; i < n_patches; i++) {
+                    result.push_back(ImagePatch<T>{get_patch(padded, candidates[i].x, candidates[i].y, patch_size),
+                                                   candidates[i].x, candidates[i].y});
+                }
 
+                return result;
             };
 
 
@@ -75,17 +122,6 @@ namespace Gadgetron {
             };
 
 
-            template<class T>
-            float distance(const arma::Col<T> &patch1, const arma::Col<T> &patch2) {
-                arma::Col<T> diff = patch1 - patch2;
-
-                float result = 0;
-                for (auto d : diff) result += std::norm(d);
-
-                result /= patch1.size() * patch1.size();
-                return result;
-            };
-
             template<class T>
             arma::Col<T> get_mean_patch(const std::vector<ImagePatch<T>> &patches) {
 
@@ -115,30 +151,6 @@ namespace Gadgetron {
             }
 
 
-            template<class T>
-            void
-            filter_patches(std::vector<ImagePatch<T>> &patches, int max_n_patches, const arma::Col<T> &reference_patch) {
-
-                auto distances = std::vector<float>(patches.size());
-                transform(patches.begin(), patches.end(), distances.begin(),
-                          [&](auto patch) { return distance(patch.patch, reference_patch); });
-
-                std::vector<size_t> patch_indices(patches.size());
-                std::iota(patch_indices.begin(), patch_indices.end(), 0);
-
-                sort(patch_indices.begin(), patch_indices.end(),
-                     [&](auto v1, auto v2) { return distances[v1] < distances[v2]; });
-
-                int n_patches = std::min<int>(patches.size(),max_n_patches);
-                std::vector<ImagePatch<T>> best_patches(n_patches);
-
-                for (int i = 0; i < n_patches; i++) {
-                    best_patches[i] = std::move(patches[patch_indices[i]]);
-                }
-
-                patches = std::move(best_patches);
-            }
-
             template<class T>
             bool is_homogenous_area(std::vector<ImagePatch<T>> &patches, float noise_std) {
 
@@ -198,19 +210,19 @@ namespace Gadgetron {
                         from_std_vector<size_t, 2>(image.dimensions())
                 );
 
-#pragma omp parallel for num_threads(4)
+                const auto padded = pad_periodic(image, patch_size / 2, image_dims);
+
+                // every reference pixel takes the pixels of its patches out of the mask, so the next reference depends on
+                // all patches before it; the pixels are visited in order, and images are filtered in parallel instead
                 for (int ky = 0; ky < image.get_size(1); ky++) {
                     for (int kx = 0; kx < image.get_size(0); kx++) {
 
                         if (mask(kx, ky)) {
-                            auto reference_patch = get_patch(image, kx, ky, patch_size, image_dims);
-                            auto patches = create_patches(image, kx, ky, patch_size, search_window, image_dims);
-
-                            filter_patches(patches, n_patches, reference_patch);
+                            auto patches = find_similar_patches(padded, kx, ky, patch_size, search_window, n_patches,
+                                                                image_dims);
                             denoise_patches(patches, noise_std);
 
                             for (auto &patch : patches) {
-                                #pragma omp critical
                                 add_patch(patch, result, count, patch_size, image_dims);
                                 mask(patch.center_x, patch.center_y) = false;
                             }
@@ -237,13 +249,11 @@ namespace Gadgetron {
 
                 auto result = hoNDArray<T>(image.dimensions());
 
-                hoNDArray<T> result_view;
-                result_view.create(image_dims);
                 #pragma omp parallel for
                 for (int i = 0; i < n_images; i++) {
 
                     auto image_view = hoNDArray<T>(image_dims, const_cast<T*>(image.get_data_ptr() + i * image_elements));
-                    result_view = non_local_bayes_single_image(image_view, noise_std, search_window);
+                    auto result_view = non_local_bayes_single_image(image_view, noise_std, search_window);
 
                     memcpy(result.begin() + i * image_elements, result_view.begin(), result_view.get_number_of_bytes());
                 }
@@ -12,57 +12,133 @@ namespace Gadgetron {
 
         namespace {
 
+            constexpr int patch_size = 5;
 
-            template<class T, int D>
-            vector_td<T, D * D> get_patch(const hoNDArray<T> &image, int x, int y,
-                                          const vector_td<int, 2> &image_dims) {
+            // number of image rows processed together, so the patch sums and accumulators of a tile stay in cache
+            constexpr int tile_rows = 32;
 
-                constexpr int N = D * D;
-                vector_td<T, N> window;
-                for (int ky = 0; ky < D; ky++) {
-                    for (int kx = 0; kx < D; kx++) {
-                        window[kx + ky * D] = image(((kx - D / 2) + x + image_dims[0]) % image_dims[0],
-                                                    ((ky - D / 2) + y + image_dims[1]) % image_dims[1]);
+            inline int wrap(int i, int n) {
+                i %= n;
+                return i < 0 ? i + n : i;
+            }
+
+            // periodic extension of the image by pad pixels on every side, so shifted patches are contiguous rows
+            template<class T>
+            hoNDArray<T> pad_periodic(const hoNDArray<T> &image, int pad) {
+
+                const int nx = image.get_size(0);
+                const int ny = image.get_size(1);
 
+                hoNDArray<T> padded(nx + 2 * pad, ny + 2 * pad);
+                for (int y = 0; y < ny + 2 * pad; y++) {
+                    const T *src = image.get_data_ptr() + wrap(y - pad, ny) * nx;
+                    T *dst = padded.get_data_ptr() + y * (nx + 2 * pad);
+                    for (int x = 0; x < nx + 2 * pad; x++) {
+                        dst[x] = src[wrap(x - pad, nx)];
                     }
                 }
-                return window;
-            };
-
+                return padded;
+            }
 
+            /**
+             * The patch distance of every pixel to the patch shifted by (dx, dy) is a box filter of the squared
+             * difference between the image and its shifted copy. For every offset it is computed for all pixels of a
+             * tile at once: a patch_size tap sum along x, followed by a running (summed-area) sum along y.
+             */
             template<class T>
-            hoNDArray<T> non_local_means_single_image(const hoNDArray<T> &image, float noise_std, int search_radius) {
-
-                constexpr int D = 5;
-
-                hoNDArray<T> result(image.dimensions());
-                const float noise_std2 = noise_std * noise_std;
-                const vector_td<int, 2> image_dims = vector_td<int, 2>(
-                        from_std_vector<size_t, 2>(image.dimensions()));
+            void non_local_means_tile(const hoNDArray<T> &padded, int pad, int nx, int y0, int rows,
+                                      float noise_std, int search_radius, T *result) {
+
+                constexpr int D = patch_size;
+                constexpr int H = D / 2;
+
+                const int stride = padded.get_size(0);
+                const float scale = 1.0f / (noise_std * noise_std * D * D);
+                const T *data = padded.get_data_ptr();
+
+                std::vector<float> diff(nx + D - 1);
+                std::vector<float> box_rows((rows + D - 1) * nx);
+                std::vector<float> patch_distance(nx);
+                std::vector<float> sum_weight(rows * nx, 0.0f);
+                std::vector<T> sum_value(rows * nx, T(0));
+
+                for (int dy = -search_radius; dy < search_radius; dy++) {
+                    for (int dx = -search_radius; dx < search_radius; dx++) {
+
+                        // patch sums along x for the rows of the tile and the patch halo above and below
+                        for (int r = 0; r < rows + D - 1; r++) {
+                            const T *p = data + (y0 + r - H + pad) * stride + pad - H;
+                            const T *q = data + (y0 + r - H + dy + pad) * stride + pad - H + dx;
+
+                            float *d = diff.data();
+#pragma omp simd
+                            for (int i = 0; i < nx + D - 1; i++) {
+                                d[i] = std::norm(p[i] - q[i]);
+                            }
 
-#pragma omp parallel for
-                for (int ky = 0; ky < image.get_size(1); ky++) {
-                    for (int kx = 0; kx < image.get_size(0); kx++) {
-                        float sum_weight = 0;
-                        T sum_value = 0;
-                        auto window = get_patch<T, D>(image, kx, ky, image_dims);
+                            float *box = box_rows.data() + r * nx;
+#pragma omp simd
+                            for (int x = 0; x < nx; x++) {
+                                float s = 0;
+                                for (int k = 0; k < D; k++) s += d[x + k];
+                                box[x] = s;
+                            }
+                        }
 
-                        for (int dy = -int(search_radius); dy < search_radius; dy++) {
-                            for (int dx = -int(search_radius); dx < search_radius; dx++) {
+                        // running sum along y gives the full patch distance of every row
+                        float *dist = patch_distance.data();
+                        std::fill(patch_distance.begin(), patch_distance.end(), 0.0f);
+                        for (int r = 0; r < D; r++) {
+                            const float *box = box_rows.data() + r * nx;
+#pragma omp simd
+                            for (int x = 0; x < nx; x++) dist[x] += box[x];
+                        }
 
-                                auto window2 = get_patch<T, D>(image, kx + dx, ky + dy, image_dims);
-                                auto diff = window - window2;
-                                auto weight = std::exp(-norm_squared(diff) / (noise_std2 * D * D));
+                        for (int j = 0; j < rows; j++) {
+                            const T *centre = data + (y0 + j + dy + pad) * stride + pad + dx;
+                            float *w_sum = sum_weight.data() + j * nx;
+                            T *v_sum = sum_value.data() + j * nx;
 
-                                sum_weight += weight;
-                                sum_value += weight * window2[D / 2 + D * (D / 2)];
+#pragma omp simd
+                            for (int x = 0; x < nx; x++) {
+                                float weight = std::exp(-dist[x] * scale);
+                                w_sum[x] += weight;
+                                v_sum[x] += weight * centre[x];
+                            }
 
+                            if (j + 1 < rows) {
+                                const float *box_in = box_rows.data() + (j + D) * nx;
+                                const float *box_out = box_rows.data() + j * nx;
+#pragma omp simd
+                                for (int x = 0; x < nx; x++) dist[x] += box_in[x] - box_out[x];
                             }
                         }
+                    }
+                }
+
+                for (int i = 0; i < rows * nx; i++) {
+                    result[y0 * nx + i] = sum_value[i] / sum_weight[i];
+                }
+            }
 
-                        result(kx, ky) = sum_value / sum_weight;
 
-                    }
+            template<class T>
+            hoNDArray<T> non_local_means_single_image(const hoNDArray<T> &image, float noise_std, int search_radius) {
+
+                const int nx = image.get_size(0);
+                const int ny = image.get_size(1);
+                const int pad = search_radius + patch_size / 2;
+
+                hoNDArray<T> result(image.dimensions());
+                auto padded = pad_periodic(image, pad);
+
+                const int n_tiles = (ny + tile_rows - 1) / tile_rows;
+
+#pragma omp parallel for
+                for (int tile = 0; tile < n_tiles; tile++) {
+                    int y0 = tile * tile_rows;
+                    int rows = std::min(tile_rows, ny - y0);
+                    non_local_means_tile(padded, pad, nx, y0, rows, noise_std, search_radius, result.get_data_ptr());
                 }
 
                 return result;
@@ -88,7 +164,6 @@ namespace Gadgetron {
                     auto result_view = non_local_means_single_image(image_view, noise_std,search_radius) ;
 
                     memcpy(result.begin() + i * image_elements, result_view.begin(), result_view.get_number_of_bytes());
-                    GDEBUG_STREAM("I finished one");
                 }
                 return result;
 
@@ -0,0 +1,367 @@
+//
+// Boykov-Kolmogorov max-flow with reuse of the search trees (Kohli and Torr), implemented from the papers cited in
+// GridGraphCut.h.
+//
+
+#include "GridGraphCut.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Gadgetron {
+
+    GridGraphCut::GridGraphCut(const std::vector<size_t>& dims) : dims_(dims), stage_(0), has_trees_(false) {
+
+        if (dims_.empty() || dims_.size() > 3)
+            throw std::invalid_argument("GridGraphCut: only 1 to 3 dimensional grids are supported");
+
+        size_t num_nodes = 1;
+        for (auto d : dims_) num_nodes *= d;
+
+        const size_t D = dims_.size();
+        std::vector<size_t> strides(D, 1);
+        for (size_t d = 1; d < D; d++) strides[d] = strides[d - 1] * dims_[d - 1];
+
+        auto has_successor = [&](size_t node, size_t d) { return (node / strides[d]) % dims_[d] + 1 < dims_[d]; };
+        auto has_predecessor = [&](size_t node, size_t d) { return (node / strides[d]) % dims_[d] > 0; };
+
+        first_arc_ = std::vector<int>(num_nodes + 1, 0);
+        for (size_t i = 0; i < num_nodes; i++) {
+            int degree = 0;
+            for (size_t d = 0; d < D; d++) degree += has_successor(i, d) + has_predecessor(i, d);
+            first_arc_[i + 1] = first_arc_[i] + degree;
+        }
+
+        const size_t num_arcs = first_arc_[num_nodes];
+        arc_head_ = std::vector<int>(num_arcs);
+        arc_sister_ = std::vector<int>(num_arcs);
+        arc_cap_ = std::vector<float>(num_arcs, 0);
+        arc_rcap_ = std::vector<float>(num_arcs, 0);
+        successor_arc_ = std::vector<int>(num_nodes * D, -1);
+
+        std::vector<int> cursor(first_arc_.begin(), first_arc_.end() - 1);
+        for (size_t i = 0; i < num_nodes; i++) {
+            for (size_t d = 0; d < D; d++) {
+                if (!has_successor(i, d)) continue;
+                size_t j = i + strides[d];
+                int a = cursor[i]++;
+                int s = cursor[j]++;
+                arc_head_[a] = j;
+                arc_head_[s] = i;
+                arc_sister_[a] = s;
+                arc_sister_[s] = a;
+                successor_arc_[i * D + d] = a;
+            }
+        }
+
+        source_cap_ = std::vector<float>(num_nodes, 0);
+        sink_cap_ = std::vector<float>(num_nodes, 0);
+        tr_cap_ = std::vector<float>(num_nodes, 0);
+
+        tree_ = std::vector<Tree>(num_nodes, FREE);
+        parent_arc_ = std::vector<int>(num_nodes, ROOT);
+        is_orphan_ = std::vector<char>(num_nodes, 0);
+        is_active_ = std::vector<char>(num_nodes, 0);
+        checked_stage_ = std::vector<unsigned int>(num_nodes, 0);
+        is_marked_ = std::vector<char>(num_nodes, 0);
+    }
+
+    void GridGraphCut::set_edge_capacity(size_t node, size_t dim, float capacity, float reverse_capacity) {
+
+        int a = successor_arc_[node * dims_.size() + dim];
+        if (a < 0) throw std::invalid_argument("GridGraphCut: node has no successor along this dimension");
+
+        int s = arc_sister_[a];
+        int j = arc_head_[a];
+
+        // keep the current flow on the edge, as far as the new capacities allow
+        float flow = arc_cap_[a] - arc_rcap_[a];
+        arc_cap_[a] = capacity;
+        arc_cap_[s] = reverse_capacity;
+        arc_rcap_[a] = capacity - flow;
+        arc_rcap_[s] = reverse_capacity + flow;
+
+        // flow above the new capacity is removed, and the nodes are balanced through their terminal edges
+        if (arc_rcap_[a] < 0) {
+            float excess = -arc_rcap_[a];
+            arc_rcap_[a] = 0;
+            arc_rcap_[s] -= excess;
+            tr_cap_[node] += excess;
+            tr_cap_[j] -= excess;
+        } else if (arc_rcap_[s] < 0) {
+            float excess = -arc_rcap_[s];
+            arc_rcap_[s] = 0;
+            arc_rcap_[a] -= excess;
+            tr_cap_[j] += excess;
+            tr_cap_[node] -= excess;
+        }
+
+        mark_node(node);
+        mark_node(j);
+    }
+
+    void GridGraphCut::set_terminal_capacity(size_t node, float source_capacity, float sink_capacity) {
+
+        tr_cap_[node] += (source_capacity - source_cap_[node]) - (sink_capacity - sink_cap_[node]);
+        source_cap_[node] = source_capacity;
+        sink_cap_[node] = sink_capacity;
+
+        mark_node(node);
+    }
+
+    void GridGraphCut::mark_node(int i) {
+        if (has_trees_ && !is_marked_[i]) {
+            is_marked_[i] = 1;
+            marked_nodes_.push_back(i);
+        }
+    }
+
+    void GridGraphCut::activate(int i) {
+        if (!is_active_[i]) {
+            is_active_[i] = 1;
+            active_.push_back(i);
+        }
+    }
+
+    void GridGraphCut::make_orphan(int i) {
+        if (!is_orphan_[i]) {
+            is_orphan_[i] = 1;
+            orphans_.push_back(i);
+        }
+    }
+
+    void GridGraphCut::make_root(int i, Tree t) {
+        tree_[i] = t;
+        parent_arc_[i] = ROOT;
+        is_orphan_[i] = 0;
+    }
+
+    void GridGraphCut::build_trees() {
+
+        active_.clear();
+        orphans_.clear();
+        std::fill(is_active_.begin(), is_active_.end(), 0);
+        std::fill(is_orphan_.begin(), is_orphan_.end(), 0);
+
+        for (int i : marked_nodes_) is_marked_[i] = 0;
+        marked_nodes_.clear();
+
+        // every node with terminal residual is the root of a tree of its own
+        for (size_t i = 0; i < num_nodes(); i++) {
+            if (tr_cap_[i] != 0) {
+                make_root(i, tr_cap_[i] > 0 ? SOURCE_TREE : SINK_TREE);
+                activate(i);
+            } else {
+                tree_[i] = FREE;
+            }
+        }
+    }
+
+    void GridGraphCut::repair_trees() {
+
+        // a changed node with terminal residual becomes a root of the tree it now belongs to; a root that lost its
+        // terminal residual loses its parent
+        for (int i : marked_nodes_) {
+            is_marked_[i] = 0;
+
+            if (tr_cap_[i] > 0) make_root(i, SOURCE_TREE);
+            else if (tr_cap_[i] < 0) make_root(i, SINK_TREE);
+            else if (tree_[i] != FREE && parent_arc_[i] == ROOT) make_orphan(i);
+        }
+
+        // every tree edge at a changed node must still carry residual capacity and join nodes of the same tree;
+        // the nodes around a change may have new paths to the other tree, so they grow again
+        auto check = [&](int j) {
+            if (tree_[j] == FREE) return;
+
+            if (!is_orphan_[j] && parent_arc_[j] != ROOT
+                && (arc_rcap_[parent_arc_[j]] <= 0 || tree_[parent_of(j)] != tree_[j]))
+                make_orphan(j);
+
+            activate(j);
+        };
+
+        for (int i : marked_nodes_) {
+            check(i);
+            for (int a = first_arc_[i]; a < first_arc_[i + 1]; a++) check(arc_head_[a]);
+        }
+
+        marked_nodes_.clear();
+
+        adopt_orphans();
+    }
+
+    int GridGraphCut::grow(int i) {
+
+        const Tree t = tree_[i];
+
+        for (int a = first_arc_[i]; a < first_arc_[i + 1]; a++) {
+            int out = arc_out_of(a, t);
+            if (arc_rcap_[out] <= 0) continue;
+
+            int j = arc_head_[a];
+            if (tree_[j] == FREE) {
+                tree_[j] = t;
+                parent_arc_[j] = out;
+                activate(j);
+            } else if (tree_[j] != t) {
+                // out runs from the source tree to the sink tree, whichever tree i is in
+                return out;
+            }
+        }
+
+        return -1;
+    }
+
+    void GridGraphCut::augment(int bridge) {
+
+        // the path runs from the source root down the source tree to the tail of bridge, and from its head
+        // up the sink tree to the sink root
+        float flow = arc_rcap_[bridge];
+
+        int i = tail(bridge);
+        for (; parent_arc_[i] != ROOT; i = tail(parent_arc_[i])) flow = std::min(flow, arc_rcap_[parent_arc_[i]]);
+        flow = std::min(flow, tr_cap_[i]);
+
+        i = arc_head_[bridge];
+        for (; parent_arc_[i] != ROOT; i = arc_head_[parent_arc_[i]]) flow = std::min(flow, arc_rcap_[parent_arc_[i]]);
+        flow = std::min(flow, -tr_cap_[i]);
+
+        auto push = [&](int a) {
+            arc_rcap_[a] -= flow;
+            arc_rcap_[arc_sister_[a]] += flow;
+        };
+
+        push(bridge);
+
+        // a node whose tree edge or terminal edge is saturated loses its parent
+        i = tail(bridge);
+        while (parent_arc_[i] != ROOT) {
+            int a = parent_arc_[i];
+            push(a);
+            if (arc_rcap_[a] <= 0) make_orphan(i);
+            i = tail(a);
+        }
+        tr_cap_[i] -= flow;
+        if (tr_cap_[i] <= 0) make_orphan(i);
+
+        i = arc_head_[bridge];
+        while (parent_arc_[i] != ROOT) {
+            int a = parent_arc_[i];
+            push(a);
+            if (arc_rcap_[a] <= 0) make_orphan(i);
+            i = arc_head_[a];
+        }
+        tr_cap_[i] += flow;
+        if (tr_cap_[i] >= 0) make_orphan(i);
+    }
+
+    void GridGraphCut::adopt_orphans() {
+
+        if (++stage_ == 0) {
+            std::fill(checked_stage_.begin(), checked_stage_.end(), 0);
+            stage_ = 1;
+        }
+
+        while (!orphans_.empty()) {
+            int i = orphans_.front();
+            orphans_.pop_front();
+            if (is_orphan_[i]) adopt(i);
+        }
+    }
+
+    bool GridGraphCut::reaches_terminal(int i) {
+
+        // a path found valid stays valid for the rest of the stage: a node only becomes an orphan during the
+        // stage when its parent finds no new parent, and then its path already ran through an orphan
+        path_.clear();
+        bool valid = false;
+        for (int k = i;; k = parent_of(k)) {
+            if (checked_stage_[k] == stage_) {
+                valid = true;
+                break;
+            }
+            if (is_orphan_[k]) break;
+
+            path_.push_back(k);
+            if (parent_arc_[k] == ROOT) {
+                valid = true;
+                break;
+            }
+        }
+
+        if (valid)
+            for (int k : path_) checked_stage_[k] = stage_;
+        return valid;
+    }
+
+    void GridGraphCut::adopt(int i) {
+
+        const Tree t = tree_[i];
+
+        // the first neighbour in the same tree with residual capacity towards i and a path to the terminal
+        for (int a = first_arc_[i]; a < first_arc_[i + 1]; a++) {
+            int j = arc_head_[a];
+            int in = arc_into(a, t);
+            if (tree_[j] != t || arc_rcap_[in] <= 0 || !reaches_terminal(j)) continue;
+
+            parent_arc_[i] = in;
+            is_orphan_[i] = 0;
+            checked_stage_[i] = stage_;
+            return;
+        }
+
+        // none found: i becomes free, its children orphans, and the neighbours that can reach it grow again
+        for (int a = first_arc_[i]; a < first_arc_[i + 1]; a++) {
+            int j = arc_head_[a];
+            if (tree_[j] != t) continue;
+
+            if (arc_rcap_[arc_into(a, t)] > 0) activate(j);
+            if (!is_orphan_[j] && parent_arc_[j] != ROOT && parent_of(j) == i) make_orphan(j);
+        }
+
+        tree_[i] = FREE;
+        is_orphan_[i] = 0;
+    }
+
+    float GridGraphCut::maxflow(bool reuse_trees) {
+
+        if (reuse_trees && has_trees_) repair_trees();
+        else build_trees();
+
+        has_trees_ = true;
+
+        // an active node stays at the front of the queue as long as it finds paths to the other tree
+        while (!active_.empty()) {
+            int i = active_.front();
+
+            int bridge = (tree_[i] == FREE) ? -1 : grow(i);
+            if (bridge < 0) {
+                active_.pop_front();
+                is_active_[i] = 0;
+                continue;
+            }
+
+            augment(bridge);
+            adopt_orphans();
+        }
+
+        return cut_value();
+    }
+
+    float GridGraphCut::cut_value() const {
+
+        double value = 0;
+        for (size_t i = 0; i < num_nodes(); i++) {
+            if (is_source_side(i)) {
+                value += sink_cap_[i];
+                for (int a = first_arc_[i]; a < first_arc_[i + 1]; a++) {
+                    if (!is_source_side(arc_head_[a])) value += arc_cap_[a];
+                }
+            } else {
+                value += source_cap_[i];
+            }
+        }
+        return float(value);
+    }
+}
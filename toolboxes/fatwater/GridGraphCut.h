@@ -0,0 +1,120 @@
+#pragma once
+
+#include "fatwater_export.h"
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace Gadgetron {
+
+    /**
+     * Max-flow / min-cut on a 4 or 6 connected image grid, with the augmenting path algorithm of Boykov and Kolmogorov
+     * (An experimental comparison of min-cut/max-flow algorithms for energy minimization in vision, PAMI 2004).
+     *
+     * The graph is stored flat in compressed sparse row form: the arcs of node i are first_arc_[i] to
+     * first_arc_[i+1]-1, and every arc stores its head and its reverse (sister) arc. The two terminal edges
+     * of a node are merged into one residual capacity, positive towards the source and negative towards the sink.
+     * Every tree node stores the arc that carries flow between it and its parent, from the parent to the node in the
+     * source tree and from the node to the parent in the sink tree, so a tree edge is valid while that arc has
+     * residual capacity.
+     *
+     * The flow and the search trees are kept after maxflow(). When capacities are changed afterwards,
+     * maxflow(true) continues from the previous flow and only repairs the trees around the changed nodes
+     * (dynamic graph cuts, Kohli and Torr, ICCV 2005), instead of starting again from zero flow.
+     *
+     * This is an implementation from the descriptions in these two papers, written for this grid layout; it does not
+     * derive from the maxflow library of the authors.
+     */
+    class EXPORTFATWATER GridGraphCut {
+    public:
+
+        /// grid of up to 3 dimensions, first dimension fastest
+        explicit GridGraphCut(const std::vector<size_t>& dims);
+
+        size_t num_nodes() const { return tr_cap_.size(); }
+
+        /// capacity of the edge from node to its successor along dimension dim, and of the reverse edge
+        void set_edge_capacity(size_t node, size_t dim, float capacity, float reverse_capacity);
+
+        /// capacity of the edges from the source to node and from node to the sink
+        void set_terminal_capacity(size_t node, float source_capacity, float sink_capacity);
+
+        /// compute the maximal flow and return its value
+        /// with reuse_trees, the flow and search trees of the previous call are the starting point
+        float maxflow(bool reuse_trees = false);
+
+        /// whether node is reachable from the source in the residual graph, i.e. on the source side of the minimal cut
+        bool is_source_side(size_t node) const { return tree_[node] == SOURCE_TREE; }
+
+    private:
+
+        enum Tree : char { FREE = 0, SOURCE_TREE = 1, SINK_TREE = 2 };
+
+        /// parent_arc_ of a node attached directly to its terminal
+        static constexpr int ROOT = -1;
+
+        int tail(int a) const { return arc_head_[arc_sister_[a]]; }
+
+        /// arc along which flow enters the subtree of i through its neighbour across a, in tree t
+        int arc_into(int a, Tree t) const { return t == SOURCE_TREE ? arc_sister_[a] : a; }
+
+        /// arc along which flow leaves i towards a child across a, in tree t
+        int arc_out_of(int a, Tree t) const { return t == SOURCE_TREE ? a : arc_sister_[a]; }
+
+        int parent_of(int i) const { return tree_[i] == SOURCE_TREE ? tail(parent_arc_[i]) : arc_head_[parent_arc_[i]]; }
+
+        void mark_node(int i);
+        void activate(int i);
+        void make_orphan(int i);
+        void make_root(int i, Tree t);
+
+        void build_trees();
+        void repair_trees();
+
+        /// scans the neighbours of the active node i, returns the arc from the source tree to the sink tree if one is met
+        int grow(int i);
+        void augment(int bridge);
+        void adopt_orphans();
+        bool reaches_terminal(int i);
+        void adopt(int i);
+
+        float cut_value() const;
+
+        std::vector<size_t> dims_;
+
+        // compressed sparse row graph
+        std::vector<int> first_arc_;
+        std::vector<int> arc_head_;
+        std::vector<int> arc_sister_;
+        std::vector<float> arc_cap_;
+        std::vector<float> arc_rcap_;
+
+        // arc from every node to its successor along every dimension, -1 at the border
+        std::vector<int> successor_arc_;
+
+        // terminal capacities and merged terminal residual
+        std::vector<float> source_cap_;
+        std::vector<float> sink_cap_;
+        std::vector<float> tr_cap_;
+
+        // search trees
+        std::vector<Tree> tree_;
+        std::vector<int> parent_arc_;
+        std::vector<char> is_orphan_;
+        std::vector<char> is_active_;
+        std::deque<int> active_;
+        std::deque<int> orphans_;
+
+        // during an adoption stage, nodes whose path to the terminal is known to hold no orphan carry its number
+        std::vector<unsigned int> checked_stage_;
+        unsigned int stage_;
+        std::vector<int> path_;
+
+        // nodes whose capacities changed since the last maxflow()
+        std::vector<char> is_marked_;
+        std::vector<int> marked_nodes_;
+
+        bool has_trees_;
+    };
+}
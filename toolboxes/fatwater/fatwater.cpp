@@ -9,8 +9,6 @@
 
 #include <boost/config.hpp>
 
-#include <boost/graph/graph_utility.hpp>
-#include <boost/graph/boykov_kolmogorov_max_flow.hpp>
 
 #include <boost/timer/timer.hpp>
 #include <boost/iterator/function_input_iterator.hpp>
@@ -210,6 +208,7 @@ namespace Gadgetron {
             fmIndex.fill(field_map_strengths.size() / 2);
 
             hoNDArray<uint16_t> fmIndex_update;
+            GridGraphCut graph(field_map_graph_dimensions(fmIndex));
             for (int i = 0; i < config.number_of_iterations; i++) {
                 if (coinflip(rng_state) == 0 || i < 15) {
                     if (!(i % 2)) {
@@ -224,7 +223,7 @@ namespace Gadgetron {
                                                                         field_map_strengths.size() - 1);
                 }
 
-                fmIndex = update_field_map(fmIndex, fmIndex_update, residual, second_deriv);
+                fmIndex = update_field_map(fmIndex, fmIndex_update, residual, second_deriv, graph);
             }
 
             return fmIndex;
@@ -3,8 +3,9 @@
 //
 
 #include <random>
-#include "ImageGraph.h"
-#include <boost/graph/boykov_kolmogorov_max_flow.hpp>
+#include <cassert>
+#include <stdexcept>
+#include "GridGraphCut.h"
 #include "graph_cut.h"
 
 
@@ -13,8 +14,8 @@ namespace {
     static std::mt19937 rng_state(4242);
 
 
-    template<unsigned int D>
-    void update_regularization_edge(ImageGraph<D> &graph, const hoNDArray<uint16_t> &field_map,
+    void update_regularization_edge(std::vector<float> &edge_capacity, std::vector<float> &source_capacity,
+                                    std::vector<float> &sink_capacity, const hoNDArray<uint16_t> &field_map,
                                     const hoNDArray<uint16_t> &proposed_field_map,
                                     const hoNDArray<float> &second_deriv, const size_t idx, const size_t idx2,
                                     const size_t edge_idx, float scaling) {
@@ -36,45 +37,43 @@ namespace {
 
         assert(lambda >= 0);
 
-        auto &capacity_map = graph.edge_capacity_map;
-
-        capacity_map[edge_idx] += weight;
+        edge_capacity[edge_idx] += weight;
         {
             float aq = lambda * (c - a);
 
             if (aq > 0) {
-                capacity_map[graph.edge_from_source(idx)] += aq;
+                source_capacity[idx] += aq;
 
             } else {
-                capacity_map[graph.edge_to_sink(idx)] -= aq;
+                sink_capacity[idx] -= aq;
             }
         }
 
         {
             float aj = lambda * (d - c);
             if (aj > 0) {
-                capacity_map[graph.edge_from_source(idx2)] += aj;
+                source_capacity[idx2] += aj;
 
             } else {
-                capacity_map[graph.edge_to_sink(idx2)] -= aj;
+                sink_capacity[idx2] -= aj;
             }
         }
 
 
     }
 
-    template<unsigned int D>
-    ImageGraph<D> make_graph(const hoNDArray<uint16_t> &field_map, const hoNDArray<uint16_t> &proposed_field_map,
-                             const hoNDArray<float> &residual_diff_map, const hoNDArray<float> &second_deriv) {
-
-        const auto dims = vector_td<int,3>(field_map.get_size(0),field_map.get_size(1),field_map.get_size(2));
+    void set_capacities(GridGraphCut &graph, const hoNDArray<uint16_t> &field_map,
+                        const hoNDArray<uint16_t> &proposed_field_map,
+                        const hoNDArray<float> &residual_diff_map, const hoNDArray<float> &second_deriv) {
 
-        vector_td<int,D> graph_dims;
-        for (int i = 0; i < D; i++) graph_dims[i] = dims[i];
+        const size_t dims[3] = {field_map.get_size(0), field_map.get_size(1), field_map.get_size(2)};
+        const size_t num_nodes = field_map.get_number_of_elements();
 
-        ImageGraph<D> graph = ImageGraph<D>(graph_dims);
+        // edges to the successor along x, y and z of every voxel
+        std::vector<float> edge_capacity(3 * num_nodes, 0);
+        std::vector<float> source_capacity(num_nodes, 0);
+        std::vector<float> sink_capacity(num_nodes, 0);
 
-        auto &capacity_map = graph.edge_capacity_map;
         //Add regularization edges
 
         for (size_t kz = 0; kz < dims[2]; kz++) {
@@ -86,66 +85,80 @@ namespace {
                     if (kx < (dims[0] - 1)) {
                         size_t idx2 = idx + 1;
 
-                        update_regularization_edge(graph, field_map, proposed_field_map, second_deriv, idx, idx2,
-                                                   graph.edge(idx, idx2).first, 1);
+                        update_regularization_edge(edge_capacity, source_capacity, sink_capacity, field_map,
+                                                   proposed_field_map, second_deriv, idx, idx2, 3 * idx, 1);
                     }
 
 
                     if (ky < (dims[1] - 1)) {
                         size_t idx2 = idx + dims[0];
-                        update_regularization_edge(graph, field_map, proposed_field_map, second_deriv, idx, idx2,
-                                                   graph.edge(idx, idx2).first, 1);
+                        update_regularization_edge(edge_capacity, source_capacity, sink_capacity, field_map,
+                                                   proposed_field_map, second_deriv, idx, idx2, 3 * idx + 1, 1);
                     }
 
                     if (kz < (dims[2] - 1)) {
                         size_t idx2 = idx + dims[0]*dims[1];
-                        update_regularization_edge(graph, field_map, proposed_field_map, second_deriv, idx, idx2,
-                                                   graph.edge(idx, idx2).first, 1);
+                        update_regularization_edge(edge_capacity, source_capacity, sink_capacity, field_map,
+                                                   proposed_field_map, second_deriv, idx, idx2, 3 * idx + 2, 1);
                     }
 
                     float residual_diff = residual_diff_map[idx];
 
                     if (residual_diff > 0) {
-                        capacity_map[graph.edge_to_sink(idx)] += int(residual_diff);
+                        sink_capacity[idx] += int(residual_diff);
 
                     } else {
-                        capacity_map[graph.edge_from_source(idx)] -= int(residual_diff);
+                        source_capacity[idx] -= int(residual_diff);
                     }
 
                 }
             }
         }
 
-        return graph;
-    }
-
-    template<unsigned int DIMS>
-    std::vector<boost::default_color_type>
-    graph_cut(const hoNDArray<uint16_t> &field_map_index, const hoNDArray<uint16_t> &proposed_field_map_index,
-              const hoNDArray<float> &lambda_map, const hoNDArray<float> &residual_diff_map) {
-
-        ImageGraph<DIMS> graph = make_graph<DIMS>(field_map_index, proposed_field_map_index, residual_diff_map,
-                                                  lambda_map);
+        for (size_t kz = 0; kz < dims[2]; kz++) {
+            for (size_t ky = 0; ky < dims[1]; ky++) {
+                for (size_t kx = 0; kx < dims[0]; kx++) {
+                    size_t idx = kz*dims[1]*dims[0]+ky * dims[0] + kx;
 
-        float flow = boost::boykov_kolmogorov_max_flow(graph, graph.source_vertex, graph.sink_vertex);
+                    if (kx < (dims[0] - 1)) graph.set_edge_capacity(idx, 0, edge_capacity[3 * idx], 0);
+                    if (ky < (dims[1] - 1)) graph.set_edge_capacity(idx, 1, edge_capacity[3 * idx + 1], 0);
+                    if (kz < (dims[2] - 1)) graph.set_edge_capacity(idx, 2, edge_capacity[3 * idx + 2], 0);
 
-        return std::move(graph.color_map);
+                    graph.set_terminal_capacity(idx, source_capacity[idx], sink_capacity[idx]);
+                }
+            }
+        }
     }
 
 }
 namespace Gadgetron {
 
 
+    std::vector<size_t> field_map_graph_dimensions(const hoNDArray<uint16_t> &field_map_index) {
+        return {field_map_index.get_size(0), field_map_index.get_size(1), field_map_index.get_size(2)};
+    }
+
     hoNDArray<uint16_t>
     update_field_map(const hoNDArray<uint16_t> &field_map_index, const hoNDArray<uint16_t> &proposed_field_map_index,
                      const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map) {
 
+        GridGraphCut graph(field_map_graph_dimensions(field_map_index));
+        return update_field_map(field_map_index, proposed_field_map_index, residuals_map, lambda_map, graph);
+    }
+
+    hoNDArray<uint16_t>
+    update_field_map(const hoNDArray<uint16_t> &field_map_index, const hoNDArray<uint16_t> &proposed_field_map_index,
+                     const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map, GridGraphCut &graph) {
+
 
         hoNDArray<float> residual_diff_map(field_map_index.dimensions());
         const auto X = field_map_index.get_size(0);
         const auto Y = field_map_index.get_size(1);
         const auto Z = field_map_index.get_size(2);
 
+        if (graph.num_nodes() != field_map_index.get_number_of_elements())
+            throw std::invalid_argument("update_field_map: graph does not match the field map");
+
         for (size_t kz = 0; kz < Z; kz++) {
             for (size_t ky = 0; ky < Y; ky++) {
                 for (size_t kx = 0; kx < X; kx++) {
@@ -158,20 +171,15 @@ namespace Gadgetron {
         }
 
 
-        std::vector<boost::default_color_type> color_map;
-        if (Z == 1) {
-            color_map = graph_cut<2>(field_map_index, proposed_field_map_index, lambda_map,
-                                     residual_diff_map);
-        } else {
-            color_map = graph_cut<3>(field_map_index, proposed_field_map_index, lambda_map, residual_diff_map);
-        }
-
+        // the flow of the previous update is kept and repaired for the new capacities
+        set_capacities(graph, field_map_index, proposed_field_map_index, residual_diff_map, lambda_map);
+        graph.maxflow(true);
 
 
         auto result = field_map_index;
         size_t updated_voxels = 0;
         for (size_t i = 0; i < field_map_index.get_number_of_elements(); i++) {
-            if (color_map[i] != boost::default_color_type::black_color) {
+            if (!graph.is_source_side(i)) {
                 updated_voxels++;
                 result[i] = proposed_field_map_index[i];
             }
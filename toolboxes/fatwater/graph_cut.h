@@ -3,6 +3,7 @@
 
 
 #include "hoNDArray.h"
+#include "GridGraphCut.h"
 namespace  Gadgetron {
 
 
@@ -10,4 +11,12 @@ namespace  Gadgetron {
     update_field_map(const hoNDArray <uint16_t> &field_map_index, const hoNDArray <uint16_t> &proposed_field_map_index,
                      const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map);
 
+    /// graph with the dimensions of the field map, for update_field_map
+    std::vector<size_t> field_map_graph_dimensions(const hoNDArray <uint16_t> &field_map_index);
+
+    /// update the field map with the graph of the previous update, whose flow is reused
+    hoNDArray <uint16_t>
+    update_field_map(const hoNDArray <uint16_t> &field_map_index, const hoNDArray <uint16_t> &proposed_field_map_index,
+                     const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map, GridGraphCut &graph);
+
 }
\ No newline at end of file
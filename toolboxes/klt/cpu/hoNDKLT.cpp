@@ -4,12 +4,80 @@
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_linalg.h"
 #include "hoNDArray_utils.h"
-#include "hoArmadillo.h"
+#include "cpp_blas.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
 
 namespace Gadgetron{
 
+namespace
+{
+    // number of samples per BLAS call; the mean free copy of a block of a 128 channel array is 8MB for complex float
+    constexpr size_t sample_block_size = 8192;
+
+    // C += A'*A for the rows x n matrix A, only the lower triangle of C is updated
+    void rank_k_update(size_t n, size_t rows, const float* a, size_t lda, float* c)
+    {
+        BLAS::syrk(false, true, n, rows, 1.0f, a, lda, 1.0f, c, n);
+    }
+
+    void rank_k_update(size_t n, size_t rows, const double* a, size_t lda, double* c)
+    {
+        BLAS::syrk(false, true, n, rows, 1.0, a, lda, 1.0, c, n);
+    }
+
+    void rank_k_update(size_t n, size_t rows, const std::complex<float>* a, size_t lda, std::complex<float>* c)
+    {
+        BLAS::herk(false, true, n, rows, 1.0f, a, lda, 1.0f, c, n);
+    }
+
+    void rank_k_update(size_t n, size_t rows, const std::complex<double>* a, size_t lda, std::complex<double>* c)
+    {
+        BLAS::herk(false, true, n, rows, 1.0, a, lda, 1.0, c, n);
+    }
+
+    // calls f(block, ld, rows, res) for consecutive blocks of samples of the [M N] matrix data2D, with the mean subtracted if mean is not empty
+    // f is called outside of any parallel region, so the BLAS library can use its own threads; only the mean free copy is shared out
+    template <typename T, typename F>
+    void accumulate_over_sample_blocks(const hoNDArray<T>& data2D, const hoNDArray<T>& mean, hoNDArray<T>& res, F f)
+    {
+        const size_t M = data2D.get_size(0);
+        const size_t N = data2D.get_size(1);
+        const bool remove_mean = (mean.get_number_of_elements() > 0);
+
+        Gadgetron::clear(res);
+
+        if (!remove_mean)
+        {
+            f(data2D.begin(), M, M, res);
+            return;
+        }
+
+        hoNDArray<T> block(std::min(sample_block_size, M), N);
+        const size_t ld = block.get_size(0);
+
+        for (size_t m0 = 0; m0 < M; m0 += sample_block_size)
+        {
+            size_t rows = std::min(sample_block_size, M - m0);
+
+            long long n;
+#pragma omp parallel for private(n) if(N>1)
+            for (n = 0; n < (long long)N; n++)
+            {
+                const T* pData = data2D.begin() + n*M + m0;
+                T* pBlock = block.begin() + n*ld;
+                for (size_t m = 0; m < rows; m++) pBlock[m] = pData[m] - mean[n];
+            }
+
+            f(block.begin(), ld, rows, res);
+        }
+    }
+}
+
 template<typename T> 
-hoNDKLT<T>::hoNDKLT()
+hoNDKLT<T>::hoNDKLT() : output_length_(0), total_energy_(0), remove_mean_(true)
 {
 }
 
@@ -44,6 +112,8 @@ hoNDKLT<T>& hoNDKLT<T>::operator=(const Self& v)
     this->V_ = v.V_;
     this->E_ = v.E_;
     this->output_length_ = v.output_length_;
+    this->total_energy_ = v.total_energy_;
+    this->remove_mean_ = v.remove_mean_;
 
     size_t N = this->V_.get_size(0);
     this->M_.create(N, this->output_length_, V_.begin());
@@ -52,68 +122,100 @@ hoNDKLT<T>& hoNDKLT<T>::operator=(const Self& v)
 }
 
 template<typename T>
-void hoNDKLT<T>::compute_eigen_vector(const hoNDArray<T>& data, bool remove_mean)
+void hoNDKLT<T>::get_2D_data(const hoNDArray<T>& data, size_t dim, hoNDArray<T>& buffer, hoNDArray<T>& data2D) const
 {
-
     size_t NDim = data.get_number_of_dimensions();
-    size_t N = data.get_size(NDim-1);
-
-    size_t M = data.get_number_of_elements() / N;
+    GADGET_CHECK_THROW(dim<NDim);
 
-    hoNDArray<T> data2D;
-    data2D.create(M, N, const_cast<T*>(data.begin()));
+    size_t N = data.get_size(dim);
+    size_t num = data.get_number_of_elements() / N;
 
-    V_.create(N, N);
-    E_.create(N, 1);
-    Gadgetron::clear(V_);
-    Gadgetron::clear(E_);
+    std::vector<size_t> dimD;
+    data.get_dimensions(dimD);
 
-        size_t m, n;
+    size_t K = 1;
+    for (size_t n = dim + 1; n < NDim; n++) K *= dimD[n];
 
-        // compute and subtract mean from data
-        hoNDArray<T> data2DNoMean;
+    if (dim == NDim - 1 || K == 1)
+    {
+        data2D.create(num, N, const_cast<T*>(data.begin()));
+    }
+    else
+    {
+        std::vector<size_t> dimOrder(NDim), dimPermuted(dimD);
 
-        arma::Mat<T> Am;
-        if (remove_mean)
+        size_t l;
+        for (l = 0; l<NDim; l++)
         {
-            hoNDArray<T> dataMean(1, N);
-            Gadgetron::sum_over_dimension(data2D, dataMean, 0);
+            dimOrder[l] = l;
+            dimPermuted[l] = dimD[l];
+        }
 
-            Gadgetron::scal((T)(1.0 / M), dataMean);
+        dimOrder[dim] = NDim - 1;
+        dimOrder[NDim - 1] = dim;
 
-            data2DNoMean.create(M, N);
+        dimPermuted[dim] = dimD[NDim - 1];
+        dimPermuted[NDim - 1] = dimD[dim];
 
-            for (n = 0; n < N; n++)
-            {
-                for (m = 0; m < M; m++)
-                {
-                    data2DNoMean(m, n) = data2D(m, n) - dataMean(0, n);
-                }
-            }
+        buffer.create(dimPermuted);
+        Gadgetron::permute(data, buffer, dimOrder);
 
-            Am = as_arma_matrix(data2DNoMean);
-        }
-        else
-        {
-            Am = as_arma_matrix(data2D);
-        }
+        data2D.create(num, N, buffer.begin());
+    }
+}
 
-        // call svd
-        arma::Mat<T> Vm = as_arma_matrix(V_);
-        arma::Mat<T> Um;
-        arma::Col<value_type> Sv;
+template<typename T>
+void hoNDKLT<T>::compute_mean(const hoNDArray<T>& data2D, hoNDArray<T>& mean) const
+{
+    size_t M = data2D.get_size(0);
+    size_t N = data2D.get_size(1);
 
-		
+    mean.create(1, N);
+    Gadgetron::sum_over_dimension(data2D, mean, 0);
+    Gadgetron::scal((T)(1.0 / M), mean);
+}
 
-        arma::svd_econ(Um, Sv, Vm, Am, 'r');
-		
+template<typename T>
+void hoNDKLT<T>::compute_eigen_vector(const hoNDArray<T>& data, bool remove_mean)
+{
+    size_t NDim = data.get_number_of_dimensions();
+    size_t N = data.get_size(NDim-1);
 
-        for (n = 0; n < N; n++)
-        {
-            value_type v = Sv(n);
-            E_(n) = v * v; // the E is eigen value, the square of singular value
-        }
+    size_t M = data.get_number_of_elements() / N;
+
+    hoNDArray<T> data2D;
+    data2D.create(M, N, const_cast<T*>(data.begin()));
+
+    hoNDArray<T> dataMean;
+    if (remove_mean) this->compute_mean(data2D, dataMean);
+
+    // the covariance matrix is accumulated with rank-k updates over blocks of samples,
+    // instead of a singular value decomposition of the whole [M N] data matrix
+    hoNDArray<T> C(N, N);
+    accumulate_over_sample_blocks(data2D, dataMean, C, [N](const T* a, size_t lda, size_t rows, hoNDArray<T>& res)
+    {
+        rank_k_update(N, rows, a, lda, res.begin());
+    });
+
+    hoNDArray<value_type> E;
+    Gadgetron::heev(C, E);
+
+    // heev gives ascending eigen values; the eigen values of the covariance matrix are the squared singular values of the data
+    V_.create(N, N);
+    E_.create(N, 1);
+
+    total_energy_ = 0;
+    for (size_t n = 0; n < N; n++)
+    {
+        value_type v = E(N - 1 - n);
+        if (v < 0) v = 0;
+
+        E_(n) = v;
+        total_energy_ += v;
+        memcpy(V_.begin() + n*N, C.begin() + (N - 1 - n)*N, sizeof(T)*N);
+    }
 
+    remove_mean_ = remove_mean;
 }
 
 template<typename T>
@@ -134,56 +236,194 @@ void hoNDKLT<T>::prepare(const hoNDArray<T>& data, size_t dim, size_t output_len
         output_length_ = N;
     }
 
-    std::vector<size_t> dimD;
-    data.get_dimensions(dimD);
+    hoNDArray<T> dataP, data2D;
+    this->get_2D_data(data, dim, dataP, data2D);
 
-    size_t K = 1;
-    for (size_t n = dim + 1; n < NDim; n++) K *= dimD[n];
+    this->compute_eigen_vector(data2D, remove_mean);
 
-    if (dim == NDim - 1)
-    {
-        this->compute_eigen_vector(data, remove_mean);
-    }
-    else if (K == 1)
+    GADGET_CHECK_THROW(V_.get_size(0)==N);
+    GADGET_CHECK_THROW(V_.get_size(1) == N);
+    GADGET_CHECK_THROW(E_.get_size(0) == N);
+
+    M_.create(N, output_length_, V_.begin());
+ 
+}
+
+template<typename T>
+void hoNDKLT<T>::prepare_randomized(const hoNDArray<T>& data, size_t dim, value_type energy_thres, size_t max_modes, size_t num_samples, bool remove_mean)
+{
+    try
     {
-        std::vector<size_t> dimShrinked(dim + 1);
-        memcpy(&dimShrinked[0], &dimD[0], sizeof(size_t)*(dim + 1));
+        size_t NDim = data.get_number_of_dimensions();
+        GADGET_CHECK_THROW(dim<NDim);
+
+        size_t N = data.get_size(dim);
+        if (max_modes == 0 || max_modes > N) max_modes = N;
+        if (num_samples == 0) num_samples = randomized_samples_per_channel*N;
+
+        hoNDArray<T> dataP, data2D;
+        this->get_2D_data(data, dim, dataP, data2D);
 
-        hoNDArray<T> dataS;
-        dataS.create(dimShrinked, const_cast<T*>(data.begin()));
+        size_t M = data2D.get_size(0);
 
-        this->compute_eigen_vector(dataS, remove_mean);
+        if (M <= num_samples)
+        {
+            this->compute_eigen_vector(data2D, remove_mean);
+        }
+        else
+        {
+            hoNDArray<T> dataMean;
+            if (remove_mean) this->compute_mean(data2D, dataMean);
+
+            // squared norm of every sample, accumulated one channel at a time
+            std::vector<value_type> norms(M, 0);
+            for (size_t n = 0; n < N; n++)
+            {
+                const T* pData = data2D.begin() + n*M;
+                T mean = remove_mean ? dataMean[n] : T(0);
+
+#pragma omp parallel for
+                for (long long m = 0; m < (long long)M; m++) norms[m] += std::norm(pData[m] - mean);
+            }
+
+            std::vector<value_type> cumulative(M);
+            std::partial_sum(norms.begin(), norms.end(), cumulative.begin());
+            value_type total = cumulative[M - 1];
+
+            if (total <= 0)
+            {
+                this->compute_eigen_vector(data2D, remove_mean);
+            }
+            else
+            {
+                // length-squared sampling: sample m is drawn with probability p = |a_m|^2/|A|^2 and scaled by 1/sqrt(num_samples*p),
+                // so the covariance of the sampled rows is an unbiased estimate of the full covariance matrix
+                std::mt19937 gen(4537);
+                std::uniform_real_distribution<value_type> dist(0, total);
+
+                std::vector<value_type> draws(num_samples);
+                for (size_t j = 0; j < num_samples; j++) draws[j] = dist(gen);
+                std::sort(draws.begin(), draws.end());
+
+                std::vector<size_t> ind(num_samples);
+                std::vector<value_type> scale(num_samples);
+                size_t m = 0;
+                for (size_t j = 0; j < num_samples; j++)
+                {
+                    while (m < M - 1 && cumulative[m] < draws[j]) m++;
+                    ind[j] = m;
+                    scale[j] = std::sqrt(total / (num_samples*norms[m]));
+                }
+
+                hoNDArray<T> sampled(num_samples, N);
+                for (size_t n = 0; n < N; n++)
+                {
+                    const T* pData = data2D.begin() + n*M;
+                    T mean = remove_mean ? dataMean[n] : T(0);
+                    for (size_t j = 0; j < num_samples; j++) sampled(j, n) = (pData[ind[j]] - mean) * scale[j];
+                }
+
+                this->compute_eigen_vector(sampled, false);
+                remove_mean_ = remove_mean;
+            }
+        }
+
+        // smallest number of modes holding energy_thres of the total energy
+        size_t n = max_modes;
+        if (energy_thres > 0)
+        {
+            value_type kept_energy = 0;
+            for (n = 0; n < max_modes; )
+            {
+                kept_energy += std::real(E_(n++));
+                if (kept_energy >= energy_thres*total_energy_) break;
+            }
+        }
+
+        output_length_ = n;
+        M_.create(N, output_length_, V_.begin());
+
+        GDEBUG("NUMBER OF MODES KEPT %d \n", output_length_);
     }
-    else
+    catch (...)
     {
-        std::vector<size_t> dimOrder(NDim), dimPermuted(dimD);
+        GADGET_THROW("Errors in hoNDKLT<T>::prepare_randomized(...) ... ");
+    }
+}
 
-        size_t l;
-        for (l = 0; l<NDim; l++)
+template<typename T>
+bool hoNDKLT<T>::is_stable(const hoNDArray<T>& data, size_t dim, value_type tolerance) const
+{
+    try
+    {
+        GADGET_CHECK_THROW(data.get_size(dim) == M_.get_size(0));
+
+        if (total_energy_ <= 0) return false;
+
+        size_t N = M_.get_size(0);
+        size_t L = output_length_;
+
+        hoNDArray<T> dataP, data2D;
+        this->get_2D_data(data, dim, dataP, data2D);
+
+        // the relative energies are estimated from every stride-th sample, about as many as prepare_randomized draws
+        size_t num = data2D.get_size(0);
+        size_t stride = std::max((size_t)1, num / (randomized_samples_per_channel*N));
+        size_t num_used = (num + stride - 1) / stride;
+
+        hoNDArray<T> dataUsed;
+        if (stride == 1)
         {
-            dimOrder[l] = l;
-            dimPermuted[l] = dimD[l];
+            dataUsed.create(num, N, data2D.begin());
+        }
+        else
+        {
+            dataUsed.create(num_used, N);
+            for (size_t n = 0; n < N; n++)
+            {
+                for (size_t m = 0; m < num_used; m++) dataUsed(m, n) = data2D(m*stride, n);
+            }
         }
 
-        dimOrder[dim] = NDim - 1;
-        dimOrder[NDim - 1] = dim;
+        hoNDArray<T> dataMean;
+        if (remove_mean_) this->compute_mean(dataUsed, dataMean);
 
-        dimPermuted[dim] = dimD[NDim - 1];
-        dimPermuted[NDim - 1] = dimD[dim];
+        // energy along every kept mode, followed by the total energy
+        hoNDArray<T> energy(L + 1);
+        const hoNDArray<T>& M = M_;
+        accumulate_over_sample_blocks(dataUsed, dataMean, energy, [N, L, &M](const T* a, size_t lda, size_t rows, hoNDArray<T>& res)
+        {
+            std::vector<T> AM(rows*L);
+            BLAS::gemm(false, false, rows, L, N, T(1), a, lda, M.begin(), N, T(0), AM.data(), rows);
 
-        hoNDArray<T> dataP;
-        dataP.create(dimPermuted);
-        Gadgetron::permute( data, dataP, dimOrder);
+            for (size_t l = 0; l < L; l++)
+            {
+                value_type e = 0;
+                for (size_t m = 0; m < rows; m++) e += std::norm(AM[l*rows + m]);
+                res[l] += e;
+            }
 
-        this->compute_eigen_vector(dataP, remove_mean);
-    }
+            value_type e = 0;
+            for (size_t n = 0; n < N; n++)
+                for (size_t m = 0; m < rows; m++) e += std::norm(a[n*lda + m]);
+            res[L] += e;
+        });
 
-    GADGET_CHECK_THROW(V_.get_size(0)==N);
-    GADGET_CHECK_THROW(V_.get_size(1) == N);
-    GADGET_CHECK_THROW(E_.get_size(0) == N);
+        value_type total_energy = std::real(energy[L]);
+        if (total_energy <= 0) return false;
 
-    M_.create(N, output_length_, V_.begin());
- 
+        value_type diff = 0;
+        for (size_t l = 0; l < L; l++)
+        {
+            diff += std::abs(std::real(energy[l]) / total_energy - std::real(E_(l)) / total_energy_);
+        }
+
+        return (diff <= tolerance);
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDKLT<T>::is_stable(...) ... ");
+    }
 }
 
 template<typename T>
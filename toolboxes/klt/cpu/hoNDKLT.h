@@ -53,6 +53,19 @@ namespace Gadgetron{
         void prepare(const hoNDArray<T>& data, size_t dim, std::vector<size_t>& untransformed, size_t output_length = 0, bool remove_mean = true);
         void prepare(const hoNDArray<T>& data, size_t dim, std::vector<size_t>& untransformed, value_type thres = (value_type)0.001, bool remove_mean = true);
 
+        /// randomized decomposition for data with many more samples than channels
+        /// the covariance matrix is estimated from num_samples samples, drawn with probability proportional to their squared norm
+        /// (length-squared sampling, Frieze, Kannan and Vempala, J ACM 2004); num_samples == 0 means 256 samples per channel
+        /// the output length is the smallest number of modes whose eigen values sum to at least energy_thres of the total energy, at most max_modes (0 means no limit)
+        /// if energy_thres <= 0, max_modes modes are kept
+        void prepare_randomized(const hoNDArray<T>& data, size_t dim, value_type energy_thres = (value_type)0.99, size_t max_modes = 0, size_t num_samples = 0, bool remove_mean = true);
+
+        /// whether the kept modes still describe data along dim
+        /// the energy of data along every kept eigen vector and the eigen values, both relative to the total energy, are compared
+        /// returns true if the summed absolute difference is at most tolerance
+        /// the energies are estimated from a regular subset of the samples, so this is much cheaper than computing the transform again
+        bool is_stable(const hoNDArray<T>& data, size_t dim, value_type tolerance) const;
+
         /// apply the transform
         /// The input array size must meet in.get_size(dim) == M.get_size(0)
         /// out array will have out.get_size(dim)==out_length
@@ -87,10 +100,23 @@ namespace Gadgetron{
         hoNDArray<T> E_;
         /// length of output dimension
         size_t output_length_;
+        /// sum of all eigen values
+        value_type total_energy_;
+        /// whether the mean was removed before computing the eigen vectors
+        bool remove_mean_;
+
+        /// default number of samples per channel drawn by prepare_randomized
+        static constexpr size_t randomized_samples_per_channel = 256;
 
-        /// compute eigen vector and values
+        /// get the data as a [num N] matrix with N = data.get_size(dim); data2D points to data or, if it had to be permuted, to buffer
+        void get_2D_data(const hoNDArray<T>& data, size_t dim, hoNDArray<T>& buffer, hoNDArray<T>& data2D) const;
+
+        /// compute eigen vector and values from the covariance matrix, accumulated over blocks of samples
         void compute_eigen_vector(const hoNDArray<T>& data, bool remove_mean);
 
+        /// compute the mean of every column of data2D
+        void compute_mean(const hoNDArray<T>& data2D, hoNDArray<T>& mean) const;
+
         /// exclude untransformed data
         void exclude_untransformed(const hoNDArray<T>& data, size_t dim, std::vector<size_t>& untransformed, hoNDArray<T>& dataCropped);
 
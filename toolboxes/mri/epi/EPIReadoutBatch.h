@@ -0,0 +1,176 @@
+/** \file   EPIReadoutBatch.h
+    \brief  Batched readout processing of EPI lines: ramp sampling regridding, navigator correction and readout FFT.
+
+    The lines of encoding space 0 are collected per readout polarity, so the regridding with the operator of
+    EPIReconXObjectTrapezoid is one matrix product per polarity instead of one per line. The correction of the
+    shot and the FFT to k-space are then applied to the regridded lines while they are still in cache. The result
+    is that of EPIReconXGadget, EPICorrGadget, FFTXGadget and, optionally, CutXGadget applied line by line.
+*/
+
+#pragma once
+
+#include "EPIExport.h"
+#include "EPIReconXObjectTrapezoid.h"
+#include "EPICorrectionObject.h"
+#include "hoNDArray_linalg.h"
+#include "hoNDFFT.h"
+
+#include <complex>
+#include <vector>
+
+namespace Gadgetron { namespace EPI {
+
+template <typename T> class EPIReadoutBatch
+{
+ public:
+  typedef typename realType<T>::Type REAL;
+
+  EPIReadoutBatch(EPIReconXObjectTrapezoid<T>& reconx, EPICorrectionObject<T>& corr, size_t batchLines);
+
+  size_t size() const { return lines_.size(); }
+  bool empty() const { return lines_.empty(); }
+
+  // Whether the batch holds the number of lines it was made for. Lines can be added beyond it, e.g. while
+  // the correction of the shot is not computed yet.
+  bool full() const { return lines_.size() >= batchLines_; }
+
+  // Whether a line with this data can join the batch: all lines of a batch have the same samples and channels
+  bool compatible(const hoNDArray<T>& data) const;
+
+  // Adds a line of encoding space 0 which is not a navigator
+  void add(ISMRMRD::AcquisitionHeader& hdr, const hoNDArray<T>& data);
+
+  // Regrids, corrects and transforms the lines, and hands them to emit(hdr, data) in the order they were
+  // added. Lines with more than cutNx samples are cut to the central cutNx, like CutXGadget; 0 keeps all.
+  // The correction of the shot must be computed. The batch is empty afterwards.
+  template <class EMIT> void process(size_t cutNx, EMIT&& emit);
+
+ protected:
+
+  struct Line
+  {
+    ISMRMRD::AcquisitionHeader hdr;
+    size_t polarity;  // 0 for forward, 1 for reverse readouts
+    size_t column;    // first column of the line in the buffers of its polarity
+  };
+
+  EPIReconXObjectTrapezoid<T>& reconx_;
+  EPICorrectionObject<T>& corr_;
+  size_t batchLines_;
+
+  std::vector<Line> lines_;
+  size_t samples_;
+  size_t channels_;
+
+  // the lines of each polarity side by side: samples_ x columns_ before and reconNx_ x columns_ after regridding
+  std::vector<T> acquired_[2];
+  std::vector<T> regridded_[2];
+  size_t columns_[2];
+  const hoNDArray<T>* operator_[2];
+
+  hoNDArray<T> transformed_[2];
+  hoNDArray<T> fftBuf_;
+};
+
+template <typename T> EPIReadoutBatch<T>::EPIReadoutBatch(EPIReconXObjectTrapezoid<T>& reconx, EPICorrectionObject<T>& corr, size_t batchLines)
+  : reconx_(reconx), corr_(corr), batchLines_(batchLines), samples_(0), channels_(0)
+{
+  columns_[0] = columns_[1] = 0;
+  operator_[0] = operator_[1] = nullptr;
+}
+
+template <typename T> bool EPIReadoutBatch<T>::compatible(const hoNDArray<T>& data) const
+{
+  if (lines_.empty()) return true;
+  return (data.get_size(0) == samples_) && (data.get_number_of_elements() == samples_ * channels_);
+}
+
+template <typename T> void EPIReadoutBatch<T>::add(ISMRMRD::AcquisitionHeader& hdr, const hoNDArray<T>& data)
+{
+  GADGET_CHECK_THROW(compatible(data));
+
+  if (lines_.empty()) {
+    samples_ = data.get_size(0);
+    channels_ = data.get_number_of_elements() / samples_;
+  }
+
+  // The operator is computed with the header of the first line it is asked for, as in apply
+  size_t polarity = hdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE) ? 1 : 0;
+  operator_[polarity] = &reconx_.getOperator(hdr);
+
+  auto& acquired = acquired_[polarity];
+  size_t column = columns_[polarity];
+  acquired.resize((column + channels_) * samples_);
+  std::copy(data.begin(), data.end(), acquired.begin() + column * samples_);
+
+  lines_.push_back(Line{ hdr, polarity, column });
+  columns_[polarity] += channels_;
+}
+
+template <typename T> template <class EMIT> void EPIReadoutBatch<T>::process(size_t cutNx, EMIT&& emit)
+{
+  if (lines_.empty()) return;
+  GADGET_CHECK_THROW(corr_.corrComputed());
+
+  size_t reconNx = reconx_.reconNx_;
+
+  // Regrid all lines of a polarity at once
+  hoNDArray<T> regridded[2];
+  for (size_t polarity = 0; polarity < 2; polarity++) {
+    size_t columns = columns_[polarity];
+    if (columns == 0) continue;
+
+    regridded_[polarity].resize(reconNx * columns);
+    hoNDArray<T> in(samples_, columns, acquired_[polarity].data());
+    regridded[polarity].create(reconNx, columns, regridded_[polarity].data());
+    Gadgetron::gemm(regridded[polarity], *operator_[polarity], in);
+  }
+
+  // The correction of every echo, in the order of the lines
+  arma::Col<T> corr;
+  for (auto& line : lines_) {
+    corr_.next_echo_correction(line.hdr, corr);
+    GADGET_CHECK_THROW(corr.n_elem == reconNx);
+
+    T* pLine = regridded[line.polarity].begin() + line.column * reconNx;
+    for (size_t cha = 0; cha < channels_; cha++) {
+      T* pCha = pLine + cha * reconNx;
+      for (size_t n = 0; n < reconNx; n++) pCha[n] *= corr[n];
+    }
+  }
+
+  // FFT in x back to k, out of place like FFTXGadget
+  for (size_t polarity = 0; polarity < 2; polarity++) {
+    if (columns_[polarity] > 0) hoNDFFT<REAL>::instance()->fft1c(regridded[polarity], transformed_[polarity], fftBuf_);
+  }
+
+  for (auto& line : lines_) {
+    ISMRMRD::AcquisitionHeader& hdr = line.hdr;
+    hdr.number_of_samples = reconNx;
+    hdr.center_sample = reconNx / 2;
+
+    size_t RO = reconNx;
+    size_t startX = 0;
+    if ((cutNx > 0) && (RO > cutNx)) {
+      // cut the central part from the kspace line
+      startX = (uint16_t)(hdr.center_sample - cutNx / 2);
+      float ratio = RO / (float)cutNx;
+      hdr.number_of_samples = cutNx;
+      hdr.center_sample = (uint16_t)(hdr.center_sample / ratio);
+    }
+
+    size_t nx = hdr.number_of_samples;
+    hoNDArray<T> data(nx, channels_);
+    const T* pLine = transformed_[line.polarity].begin() + line.column * reconNx;
+    for (size_t cha = 0; cha < channels_; cha++) {
+      std::copy(pLine + cha * RO + startX, pLine + cha * RO + startX + nx, data.begin() + cha * nx);
+    }
+
+    emit(hdr, std::move(data));
+  }
+
+  lines_.clear();
+  columns_[0] = columns_[1] = 0;
+}
+
+}}
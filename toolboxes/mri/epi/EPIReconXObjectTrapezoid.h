@@ -26,6 +26,10 @@ template <typename T> class EPIReconXObjectTrapezoid : public EPIReconXObject<T>
   virtual int apply(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in, 
 		    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out);
 
+  // The reconNx x numSamples regridding operator for the readout polarity of hdr_in. It is computed
+  // on the first call, with the off-center distance of that header.
+  const hoNDArray<T>& getOperator(ISMRMRD::AcquisitionHeader &hdr_in);
+
   using EPIReconXObject<T>::filterPos_;
   using EPIReconXObject<T>::filterNeg_;
   using EPIReconXObject<T>::slicePosition;
@@ -153,8 +157,7 @@ template <typename T> int EPIReconXObjectTrapezoid<T>::computeTrajectory()
 }
 
 
-template <typename T> int EPIReconXObjectTrapezoid<T>::apply(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in, 
-		    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out)
+template <typename T> const hoNDArray<T>& EPIReconXObjectTrapezoid<T>::getOperator(ISMRMRD::AcquisitionHeader &hdr_in)
 {
   if (!operatorComputed_) {
     // Compute the reconstruction operator
@@ -252,20 +255,16 @@ template <typename T> int EPIReconXObjectTrapezoid<T>::apply(ISMRMRD::Acquisitio
     operatorComputed_ = true;
   }
 
-  // convert to armadillo representation of matrices and vectors
-  //arma::Mat<typename stdType<T>::Type> adata_in = as_arma_matrix(&data_in);
-  //arma::Mat<typename stdType<T>::Type> adata_out = as_arma_matrix(&data_out);
+  // Negative or forward readout
+  return hdr_in.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE) ? Mneg_ : Mpos_;
+}
 
+template <typename T> int EPIReconXObjectTrapezoid<T>::apply(ISMRMRD::AcquisitionHeader &hdr_in, hoNDArray <T> &data_in, 
+		    ISMRMRD::AcquisitionHeader &hdr_out, hoNDArray <T> &data_out)
+{
   // Apply it
-  if (hdr_in.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_REVERSE)) {
-    // Negative readout
-    // adata_out = as_arma_matrix(&Mneg_) * adata_in;
-      Gadgetron::gemm(data_out, Mneg_, data_in);
-  } else {
-    // Forward readout
-    // adata_out = as_arma_matrix(&Mpos_) * adata_in;
-      Gadgetron::gemm(data_out, Mpos_, data_in);
-  }
+  // adata_out = as_arma_matrix(&Mpos_ or &Mneg_) * adata_in;
+  Gadgetron::gemm(data_out, getOperator(hdr_in), data_in);
 
   // Copy the input header to the output header and set the size and the center sample
   hdr_out = hdr_in;
@@ -11,6 +11,10 @@
 #include "hoNDArray_reductions.h"
 #include "complext.h"
 #include "GadgetronTimer.h"
+
+#include <algorithm>
+#include <vector>
+
 #ifdef USE_OMP
     #include <omp.h>
 #endif // USE_OMP
@@ -18,202 +22,472 @@
 namespace Gadgetron
 {
 
-template<typename T> 
-void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power)
+namespace
 {
-    try
+    // Windowed covariance of the coil images for the Souheil method, computed with running sums.
+    // For every pixel, the CHAxCHA matrix R(i, j) = sum_window conj(x_i)*x_j is stored packed (i<=j, index j*(j+1)/2+i),
+    // followed by the windowed sums S(c) = sum_window x_c. All entries are stored planar, [entry][RO] real and imaginary
+    // parts, so the updates and the eigen solves run over a whole line of pixels at once.
+    // The sums are kept in double: a window is moved by adding one row and subtracting another, and in float the
+    // cancellation between the two leaves errors of the order of the object signal in the background.
+    template<typename value_type>
+    class InatiLineCovariance
     {
-        typedef typename realType<T>::Type value_type;
-        using std::abs;
+    public:
 
-        long long RO = data.get_size(0);
-        long long E1 = data.get_size(1);
-        long long CHA = data.get_size(2);
+        InatiLineCovariance(const value_type* data, size_t RO, size_t E1, size_t E2, size_t CHA, size_t ks, size_t kz)
+            : data_(data), RO_(RO), E1_(E1), E2_(E2), CHA_(CHA), halfKs_((long long)ks / 2), halfKz_((long long)kz / 2)
+        {
+            num_pairs_ = CHA*(CHA + 1) / 2;
+            num_entries_ = num_pairs_ + CHA;
+
+            acc_re_.resize(num_entries_*RO);
+            acc_im_.resize(num_entries_*RO);
+            x_re_.resize(CHA*RO);
+            x_im_.resize(CHA*RO);
+            y_re_.resize(CHA*RO);
+            y_im_.resize(CHA*RO);
+            line_re_.resize(RO + 2 * halfKs_ + 1);
+            line_im_.resize(RO + 2 * halfKs_ + 1);
+        }
 
-        long long N = data.get_number_of_elements() / (RO*E1*CHA);
-        GADGET_CHECK_THROW(N == 1);
+        size_t num_pairs() const { return num_pairs_; }
+        size_t num_entries() const { return num_entries_; }
 
-        const T* pData = data.begin();
+        const double* real(size_t entry) const { return &acc_re_[entry*RO_]; }
+        const double* imag(size_t entry) const { return &acc_im_[entry*RO_]; }
 
-        if (!data.dimensions_equal(&coilMap))
+        // window sums for the output line (e1, e2)
+        void initialize(long long e1, long long e2)
         {
-            coilMap = data;
+            std::fill(acc_re_.begin(), acc_re_.end(), 0.0);
+            std::fill(acc_im_.begin(), acc_im_.end(), 0.0);
+
+            for (long long ke2 = -halfKz_; ke2 <= halfKz_; ke2++)
+                for (long long ke1 = -halfKs_; ke1 <= halfKs_; ke1++)
+                    this->add_rows(e1 + ke1, 0, e2 + ke2, false);
         }
-        T* pSen = coilMap.begin();
 
-        if (ks % 2 != 1)
+        // move the window from line (e1-1, e2) to line (e1, e2)
+        void advance(long long e1, long long e2)
         {
-            ks++;
+            for (long long ke2 = -halfKz_; ke2 <= halfKz_; ke2++)
+            {
+                this->add_rows(e1 + halfKs_, e1 - halfKs_ - 1, e2 + ke2, true);
+            }
+        }
+
+    private:
+
+        static size_t wrap(long long i, size_t n)
+        {
+            long long r = i % (long long)n;
+            return (size_t)(r < 0 ? r + (long long)n : r);
+        }
+
+        // copy one input row, periodic boundary, into planar [CHA RO] buffers
+        void load_row(long long e1, long long e2, value_type* pRe, value_type* pIm)
+        {
+            size_t RO = RO_;
+            size_t row = wrap(e2, E2_)*RO*E1_ + wrap(e1, E1_)*RO;
+
+            for (size_t c = 0; c < CHA_; c++)
+            {
+                const value_type* pRow = data_ + 2 * (c*RO*E1_*E2_ + row);
+                for (size_t ro = 0; ro < RO; ro++)
+                {
+                    pRe[c*RO + ro] = pRow[2 * ro];
+                    pIm[c*RO + ro] = pRow[2 * ro + 1];
+                }
+            }
         }
 
-        size_t kss = ks*ks;
-        long long halfKs = (long long)ks / 2;
+        // add the readout window sums of row e1 to the accumulators and, if remove is set, subtract those of row e1_removed
+        void add_rows(long long e1, long long e1_removed, long long e2, bool remove)
+        {
+            size_t RO = RO_;
+
+            this->load_row(e1, e2, &x_re_[0], &x_im_[0]);
+            if (remove)
+                this->load_row(e1_removed, e2, &y_re_[0], &y_im_[0]);
+            else
+            {
+                std::fill(y_re_.begin(), y_re_.end(), (value_type)0);
+                std::fill(y_im_.begin(), y_im_.end(), (value_type)0);
+            }
+
+            double* pLineRe = &line_re_[halfKs_];
+            double* pLineIm = &line_im_[halfKs_];
+
+            size_t i, j, c, ro;
+            size_t entry = 0;
+            for (j = 0; j < CHA_; j++)
+            {
+                const value_type* xReJ = &x_re_[j*RO];
+                const value_type* xImJ = &x_im_[j*RO];
+                const value_type* yReJ = &y_re_[j*RO];
+                const value_type* yImJ = &y_im_[j*RO];
+
+                for (i = 0; i <= j; i++)
+                {
+                    const value_type* xReI = &x_re_[i*RO];
+                    const value_type* xImI = &x_im_[i*RO];
+                    const value_type* yReI = &y_re_[i*RO];
+                    const value_type* yImI = &y_im_[i*RO];
+
+#pragma omp simd
+                    for (ro = 0; ro < RO; ro++)
+                    {
+                        double xRe = xReI[ro], xIm = xImI[ro], yRe = yReI[ro], yIm = yImI[ro];
+                        pLineRe[ro] = (xRe * xReJ[ro] + xIm * xImJ[ro]) - (yRe * yReJ[ro] + yIm * yImJ[ro]);
+                        pLineIm[ro] = (xRe * xImJ[ro] - xIm * xReJ[ro]) - (yRe * yImJ[ro] - yIm * yReJ[ro]);
+                    }
 
-        long long e1;
+                    this->add_box_sum(entry++);
+                }
+            }
+
+            for (c = 0; c < CHA_; c++)
+            {
+#pragma omp simd
+                for (ro = 0; ro < RO; ro++)
+                {
+                    pLineRe[ro] = (double)x_re_[c*RO + ro] - y_re_[c*RO + ro];
+                    pLineIm[ro] = (double)x_im_[c*RO + ro] - y_im_[c*RO + ro];
+                }
+                this->add_box_sum(entry++);
+            }
+        }
 
-        #pragma omp parallel private(e1) shared(ks, RO, E1, CHA, pSen, pData, halfKs, power, kss)
+        // running sum of the line over the readout window, added to the accumulator of entry
+        // the line is stored from index halfKs_, the borders are filled periodically first
+        void add_box_sum(size_t entry)
         {
-            hoNDArray<T> D(ks*ks, CHA);
-            T* pD = D.begin();
+            size_t RO = RO_;
+            size_t ks = 2 * halfKs_ + 1;
+            double* pLineRe = &line_re_[0];
+            double* pLineIm = &line_im_[0];
+
+            for (long long k = 0; k < halfKs_; k++)
+            {
+                pLineRe[k] = pLineRe[halfKs_ + wrap(k - halfKs_, RO)];
+                pLineIm[k] = pLineIm[halfKs_ + wrap(k - halfKs_, RO)];
+                pLineRe[halfKs_ + RO + k] = pLineRe[halfKs_ + wrap(k + RO, RO)];
+                pLineIm[halfKs_ + RO + k] = pLineIm[halfKs_ + wrap(k + RO, RO)];
+            }
 
-            hoNDArray<T> DC(ks*ks, CHA);
-            T* pDC = DC.begin();
+            double* pAccRe = &acc_re_[entry*RO];
+            double* pAccIm = &acc_im_[entry*RO];
 
-            hoNDArray<T> DH_D(CHA, CHA);
-            Gadgetron::clear(DH_D);
+            double re = 0, im = 0;
+            for (size_t k = 0; k < ks; k++)
+            {
+                re += pLineRe[k];
+                im += pLineIm[k];
+            }
+
+            for (size_t ro = 0; ro < RO; ro++)
+            {
+                pAccRe[ro] += re;
+                pAccIm[ro] += im;
+
+                re += pLineRe[ro + ks] - pLineRe[ro];
+                im += pLineIm[ro + ks] - pLineIm[ro];
+            }
+        }
 
-            hoNDArray<T> U1(ks*ks, 1);
-            T* pU1 = U1.begin();
+        const value_type* data_;
+        size_t RO_, E1_, E2_, CHA_;
+        long long halfKs_, halfKz_;
+        size_t num_pairs_, num_entries_;
 
-            hoNDArray<T> V1(CHA, 1);
-            T* pV1 = V1.begin();
+        std::vector<double> acc_re_, acc_im_;
+        std::vector<value_type> x_re_, x_im_, y_re_, y_im_;
+        std::vector<double> line_re_, line_im_;
+    };
 
-            hoNDArray<T> V(CHA, 1);
+    // power iterations for the dominant eigen vector of the windowed covariance, for L pixels at once
+    // R: [num_entries L] planar covariance and window sums, as in InatiLineCovariance
+    // work: at least (4*CHA+3)*L values
+    // out: [CHA L] planar coil map, the conjugated eigen vector with the phase of the windowed object sum
+    template<typename value_type>
+    void inati_eigen_vectors(const value_type* R_re, const value_type* R_im, size_t L, size_t CHA, size_t power,
+        value_type* work, value_type* out_re, value_type* out_im)
+    {
+        size_t num_pairs = CHA*(CHA + 1) / 2;
+        const value_type* S_re = R_re + num_pairs*L;
+        const value_type* S_im = R_im + num_pairs*L;
 
-            Gadgetron::clear(D);
-            Gadgetron::clear(DC);
-            Gadgetron::clear(DH_D);
-            Gadgetron::clear(U1);
-            Gadgetron::clear(V1);
-            Gadgetron::clear(V);
+        value_type* v_re = work;
+        value_type* v_im = v_re + CHA*L;
+        value_type* w_re = v_im + CHA*L;
+        value_type* w_im = w_re + CHA*L;
+        value_type* ph_re = w_im + CHA*L;
+        value_type* ph_im = ph_re + L;
+        value_type* scale = ph_im + L;
 
-            T phaseU1;
+        size_t i, j, c, l, po;
 
-            value_type v1Norm(1), u1Norm(1);
+        auto normalize = [&](value_type* re, value_type* im)
+        {
+            size_t c, l;
 
-            long long cha, ro, kro, ke1, de1, dro;
-            size_t po;
+            std::fill(scale, scale + L, (value_type)0);
+            for (c = 0; c < CHA; c++)
+            {
+#pragma omp simd
+                for (l = 0; l < L; l++) scale[l] += re[c*L + l] * re[c*L + l] + im[c*L + l] * im[c*L + l];
+            }
+
+            for (l = 0; l < L; l++) scale[l] = (scale[l] > 0) ? (value_type)1 / std::sqrt(scale[l]) : (value_type)0;
 
-            #pragma omp for
-            for (e1 = 0; e1<(int)E1; e1++)
+            for (c = 0; c < CHA; c++)
             {
-                for (ro = 0; ro<(long long)RO; ro++)
+#pragma omp simd
+                for (l = 0; l < L; l++)
                 {
-                    // fill the data matrix D
-                    if (e1 >= halfKs && e1<E1 - halfKs && ro >= halfKs && ro<RO - halfKs)
-                    {
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                            {
-                                de1 = e1 + ke1;
-                                for (kro = -halfKs; kro <= halfKs; kro++)
-                                {
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + ro + kro];
-                                    ind++;
-                                }
-                            }
-                        }
-                    }
-                    else
-                    {
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                            {
-                                de1 = e1 + ke1;
-                                if (de1 < 0) de1 += E1;
-                                if (de1 >= E1) de1 -= E1;
-
-                                for (kro = -halfKs; kro <= halfKs; kro++)
-                                {
-                                    dro = ro + kro;
-                                    if (dro < 0) dro += RO;
-                                    if (dro >= RO) dro -= RO;
-
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + dro];
-                                    ind++;
-                                }
-                            }
-                        }
-                    }
+                    re[c*L + l] *= scale[l];
+                    im[c*L + l] *= scale[l];
+                }
+            }
+        };
 
-                    T* pTmp;
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        pTmp = pD + cha*kss;
-                        pV1[cha] = pTmp[0];
-                        for (po = 1; po<kss; po++)
-                        {
-                            pV1[cha] += pTmp[po];
-                        }
-                    }
+        memcpy(v_re, S_re, sizeof(value_type)*CHA*L);
+        memcpy(v_im, S_im, sizeof(value_type)*CHA*L);
+        normalize(v_re, v_im);
 
-                    value_type sum(0);
-                    for (cha = 0; cha<CHA; cha++)
+        for (po = 0; po < power; po++)
+        {
+            std::fill(w_re, w_re + 2 * CHA*L, (value_type)0);
+
+            // w = R*v, with R(j, i) = conj(R(i, j))
+            size_t entry = 0;
+            for (j = 0; j < CHA; j++)
+            {
+                for (i = 0; i <= j; i++, entry++)
+                {
+                    const value_type* a = R_re + entry*L;
+                    const value_type* b = R_im + entry*L;
+
+                    value_type* wi_re = w_re + i*L;
+                    value_type* wi_im = w_im + i*L;
+                    const value_type* vj_re = v_re + j*L;
+                    const value_type* vj_im = v_im + j*L;
+
+#pragma omp simd
+                    for (l = 0; l < L; l++)
                     {
-                        const T& c = pV1[cha];
-                        const value_type re = c.real();
-                        const value_type im = c.imag();
-                        sum += ((re*re) + (im * im));
+                        wi_re[l] += a[l] * vj_re[l] - b[l] * vj_im[l];
+                        wi_im[l] += a[l] * vj_im[l] + b[l] * vj_re[l];
                     }
-                    v1Norm = std::sqrt(sum);
 
-                    value_type v1NormInv = (value_type)1.0 / v1Norm;
-                    for (cha = 0; cha<CHA; cha++)
+                    if (i == j) continue;
+
+                    value_type* wj_re = w_re + j*L;
+                    value_type* wj_im = w_im + j*L;
+                    const value_type* vi_re = v_re + i*L;
+                    const value_type* vi_im = v_im + i*L;
+
+#pragma omp simd
+                    for (l = 0; l < L; l++)
                     {
-                        pV1[cha] *= v1NormInv;
+                        wj_re[l] += a[l] * vi_re[l] + b[l] * vi_im[l];
+                        wj_im[l] += a[l] * vi_im[l] - b[l] * vi_re[l];
                     }
+                }
+            }
 
-                    memcpy(pDC, pD, sizeof(T)*ks*ks*CHA);
-                    gemm(DH_D, DC, true, D, false);
+            normalize(w_re, w_im);
+            std::swap(v_re, w_re);
+            std::swap(v_im, w_im);
+        }
 
-                    for (po = 0; po<power; po++)
-                    {
-                        gemm(V, DH_D, false, V1, false);
-                        memcpy(V1.begin(), V.begin(), V.get_number_of_bytes());
+        // phase of the windowed object sum, sum_c S(c)*v(c)
+        std::fill(ph_re, ph_re + 2 * L, (value_type)0);
+        for (c = 0; c < CHA; c++)
+        {
+#pragma omp simd
+            for (l = 0; l < L; l++)
+            {
+                ph_re[l] += S_re[c*L + l] * v_re[c*L + l] - S_im[c*L + l] * v_im[c*L + l];
+                ph_im[l] += S_re[c*L + l] * v_im[c*L + l] + S_im[c*L + l] * v_re[c*L + l];
+            }
+        }
 
-                        sum = 0;
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            const T& c = pV1[cha];
-                            const value_type re = c.real();
-                            const value_type im = c.imag();
-                            sum += ((re*re) + (im * im));
-                        }
-                        v1Norm = std::sqrt(sum);
+        for (l = 0; l < L; l++)
+        {
+            value_type m = std::sqrt(ph_re[l] * ph_re[l] + ph_im[l] * ph_im[l]);
+            scale[l] = (m > 0) ? (value_type)1 / m : (value_type)0;
+        }
+
+        // put the mean object phase to coil map, conj(v)*phase
+        for (c = 0; c < CHA; c++)
+        {
+#pragma omp simd
+            for (l = 0; l < L; l++)
+            {
+                value_type a = v_re[c*L + l], b = v_im[c*L + l];
+                out_re[c*L + l] = (a*ph_re[l] + b*ph_im[l])*scale[l];
+                out_im[c*L + l] = (a*ph_im[l] - b*ph_re[l])*scale[l];
+            }
+        }
+    }
 
-                        value_type v1NormInv = (value_type)1.0 / v1Norm;
-                        for (cha = 0; cha<CHA; cha++)
+    // linear interpolation of a line between the samples at multiples of ds and the last point
+    template<typename T>
+    void interpolate_line(T* p, size_t n, size_t stride, size_t ds)
+    {
+        for (size_t x = 0; x < n; x++)
+        {
+            if (x % ds == 0 || x == n - 1) continue;
+
+            size_t x0 = (x / ds)*ds;
+            size_t x1 = std::min(x0 + ds, n - 1);
+            typename realType<T>::Type w = (typename realType<T>::Type)(x - x0) / (typename realType<T>::Type)(x1 - x0);
+
+            p[x*stride] = p[x0*stride] * ((typename realType<T>::Type)1 - w) + p[x1*stride] * w;
+        }
+    }
+
+    inline bool is_sampled(size_t x, size_t n, size_t ds)
+    {
+        return (x % ds == 0) || (x == n - 1);
+    }
+
+    // Souheil method on [RO E1 E2 CHA], with E2 == 1 and kz == 1 for 2D
+    // the eigen vectors are computed at every ds-th pixel along each dimension and interpolated in between
+    template<typename T>
+    void coil_map_Inati_running_sums(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t RO, size_t E1, size_t E2, size_t CHA, size_t ks, size_t kz, size_t power, size_t ds)
+    {
+        typedef typename realType<T>::Type value_type;
+
+        if (ds < 1) ds = 1;
+
+        const value_type* pData = reinterpret_cast<const value_type*>(data.begin());
+        value_type* pSen = reinterpret_cast<value_type*>(coilMap.begin());
+
+        // sampled readout points
+        std::vector<size_t> ro_samples;
+        for (size_t ro = 0; ro < RO; ro++) if (is_sampled(ro, RO, ds)) ro_samples.push_back(ro);
+        size_t L = ro_samples.size();
+
+        // tasks of consecutive lines along E1, the window slides from one line to the next
+        const size_t lines_per_task = 32;
+        std::vector<std::pair<size_t, size_t> > tasks;
+        for (size_t e2 = 0; e2 < E2; e2++)
+        {
+            if (!is_sampled(e2, E2, ds)) continue;
+            for (size_t e1 = 0; e1 < E1; e1 += lines_per_task) tasks.push_back(std::make_pair(e2, e1));
+        }
+
+        long long t;
+
+#pragma omp parallel
+        {
+            InatiLineCovariance<value_type> cov(pData, RO, E1, E2, CHA, ks, kz);
+            size_t num_entries = cov.num_entries();
+
+            std::vector<value_type> R_re(num_entries*L), R_im(num_entries*L);
+
+            std::vector<value_type> work((4 * CHA + 3)*L), out_re(CHA*L), out_im(CHA*L);
+
+#pragma omp for schedule(dynamic)
+            for (t = 0; t < (long long)tasks.size(); t++)
+            {
+                size_t e2 = tasks[t].first;
+                size_t e1_start = tasks[t].second;
+                size_t e1_end = std::min(e1_start + lines_per_task, E1);
+
+                for (size_t e1 = e1_start; e1 < e1_end; e1++)
+                {
+                    if (e1 == e1_start)
+                        cov.initialize(e1, e2);
+                    else
+                        cov.advance(e1, e2);
+
+                    if (!is_sampled(e1, E1, ds)) continue;
+
+                    for (size_t n = 0; n < num_entries; n++)
+                    {
+                        for (size_t l = 0; l < L; l++)
                         {
-                            pV1[cha] *= v1NormInv;
+                            R_re[n*L + l] = (value_type)cov.real(n)[ro_samples[l]];
+                            R_im[n*L + l] = (value_type)cov.imag(n)[ro_samples[l]];
                         }
                     }
 
-                    gemm(U1, D, false, V1, false);
+                    inati_eigen_vectors(&R_re[0], &R_im[0], L, CHA, power, &work[0], &out_re[0], &out_im[0]);
 
-                    phaseU1 = pU1[0];
-                    for (po = 1; po<kss; po++)
+                    for (size_t cha = 0; cha < CHA; cha++)
                     {
-                        phaseU1 += pU1[po];
+                        value_type* pCoil = pSen + 2 * (cha*RO*E1*E2 + e2*RO*E1 + e1*RO);
+                        for (size_t l = 0; l < L; l++)
+                        {
+                            pCoil[2 * ro_samples[l]] = out_re[cha*L + l];
+                            pCoil[2 * ro_samples[l] + 1] = out_im[cha*L + l];
+                        }
                     }
-                    phaseU1 /= abs(phaseU1);
+                }
+            }
+        }
 
-                    const value_type c = phaseU1.real();
-                    const value_type d = phaseU1.imag();
+        if (ds == 1) return;
 
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        const T& v = pV1[cha];
-                        const value_type a = v.real();
-                        const value_type b = v.imag();
+        // fill in between the samples, along RO, then E1, then E2
+        T* pCoilMap = coilMap.begin();
+        long long cha;
 
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[0] = a*c + b*d;
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[1] = a*d - b*c;
-                    }
+#pragma omp parallel for
+        for (cha = 0; cha < (long long)CHA; cha++)
+        {
+            T* pCha = pCoilMap + cha*RO*E1*E2;
+            size_t ro, e1, e2;
 
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        pSen[cha*RO*E1 + e1*RO + ro] = V1(cha, 0);
-                    }
+            for (e2 = 0; e2 < E2; e2++)
+            {
+                if (!is_sampled(e2, E2, ds)) continue;
+
+                for (e1 = 0; e1 < E1; e1++)
+                {
+                    if (is_sampled(e1, E1, ds)) interpolate_line(pCha + e2*RO*E1 + e1*RO, RO, 1, ds);
                 }
+
+                for (ro = 0; ro < RO; ro++) interpolate_line(pCha + e2*RO*E1 + ro, E1, RO, ds);
+            }
+
+            if (E2 > 1)
+            {
+                for (e1 = 0; e1 < E1; e1++)
+                    for (ro = 0; ro < RO; ro++) interpolate_line(pCha + e1*RO + ro, E2, RO*E1, ds);
             }
         }
     }
+}
+
+template<typename T> 
+void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power, size_t downsampling)
+{
+    try
+    {
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t CHA = data.get_size(2);
+
+        size_t N = data.get_number_of_elements() / (RO*E1*CHA);
+        GADGET_CHECK_THROW(N == 1);
+
+        if (!data.dimensions_equal(&coilMap))
+        {
+            coilMap = data;
+        }
+
+        if (ks % 2 != 1)
+        {
+            ks++;
+        }
+
+        coil_map_Inati_running_sums(data, coilMap, RO, E1, 1, CHA, ks, 1, power, downsampling);
+    }
     catch (...)
     {
         GERROR_STREAM("Errors in coil_map_2d_Inati(...) ... ");
@@ -221,36 +495,30 @@ void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
     }
 }
 
-template void coil_map_2d_Inati(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t power);
-template void coil_map_2d_Inati(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t power);
+template void coil_map_2d_Inati(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t power, size_t downsampling);
+template void coil_map_2d_Inati(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t power, size_t downsampling);
 
-template void coil_map_2d_Inati(const hoNDArray< complext<float> >& data, hoNDArray< complext<float> >& coilMap, size_t ks, size_t power);
-template void coil_map_2d_Inati(const hoNDArray< complext<double> >& data, hoNDArray< complext<double> >& coilMap, size_t ks, size_t power);
+template void coil_map_2d_Inati(const hoNDArray< complext<float> >& data, hoNDArray< complext<float> >& coilMap, size_t ks, size_t power, size_t downsampling);
+template void coil_map_2d_Inati(const hoNDArray< complext<double> >& data, hoNDArray< complext<double> >& coilMap, size_t ks, size_t power, size_t downsampling);
 // ------------------------------------------------------------------------
 
 template<typename T> 
-void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t kz, size_t power)
+void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t kz, size_t power, size_t downsampling)
 {
     try
     {
-        typedef typename realType<T>::Type value_type;
-        using std::abs;
-
-        long long RO = data.get_size(0);
-        long long E1 = data.get_size(1);
-        long long E2 = data.get_size(2);
-        long long CHA = data.get_size(3);
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t E2 = data.get_size(2);
+        size_t CHA = data.get_size(3);
 
-        long long N = data.get_number_of_elements() / (RO*E1*E2*CHA);
+        size_t N = data.get_number_of_elements() / (RO*E1*E2*CHA);
         GADGET_CHECK_THROW(N == 1);
 
-        const T* pData = data.begin();
-
         if (!data.dimensions_equal(&coilMap))
         {
             coilMap = data;
         }
-        T* pSen = coilMap.begin();
 
         if (ks % 2 != 1)
         {
@@ -262,134 +530,7 @@ void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
             kz++;
         }
 
-        size_t kss = ks*ks*kz;
-        long long halfKs = (long long)ks / 2;
-        long long halfKz = (long long)kz / 2;
-
-        long long e2;
-
-        #pragma omp parallel default(none) private(e2) shared(ks, kz, RO, E1, E2, CHA, pSen, pData, halfKs, halfKz, power, kss)
-        {
-            hoMatrix<T> D(kss, CHA);
-            hoMatrix<T> DC(kss, CHA);
-            hoMatrix<T> DH_D(CHA, CHA);
-
-            hoMatrix<T> U1(kss, 1);
-            hoMatrix<T> V1(CHA, 1);
-            hoMatrix<T> V(CHA, 1);
-
-            Gadgetron::clear(D);
-            Gadgetron::clear(DC);
-            Gadgetron::clear(DH_D);
-            Gadgetron::clear(U1);
-            Gadgetron::clear(V1);
-            Gadgetron::clear(V);
-
-            T phaseU1;
-
-            value_type v1Norm(1);
-
-            long long cha, ro, e1, kro, dro, ke1, de1, ke2, de2;
-            size_t po;
-
-            #pragma omp for
-            for (e2 = 0; e2<(long long)E2; e2++)
-            {
-                for (e1 = 0; e1<(long long)E1; e1++)
-                {
-                    for (ro = 0; ro<(long long)RO; ro++)
-                    {
-                        // fill the data matrix D
-                        if (e2 >= halfKz && e2<E2 - halfKz && e1 >= halfKs && e1<E1 - halfKs && ro >= halfKs && ro<RO - halfKs)
-                        {
-                            for (cha = 0; cha<CHA; cha++)
-                            {
-                                const T* pDataCurr = pData + cha*RO*E1*E2;
-                                long long ind = 0;
-                                for (ke2 = -halfKz; ke2 <= halfKz; ke2++)
-                                {
-                                    de2 = e2 + ke2;
-                                    for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                                    {
-                                        de1 = e1 + ke1;
-                                        for (kro = -halfKs; kro <= halfKs; kro++)
-                                        {
-                                            D(ind++, cha) = pDataCurr[de2*RO*E1 + de1*RO + ro + kro];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            for (cha = 0; cha<CHA; cha++)
-                            {
-                                const T* pDataCurr = pData + cha*RO*E1*E2;
-                                long long ind = 0;
-                                for (ke2 = -halfKz; ke2 <= halfKz; ke2++)
-                                {
-                                    de2 = e2 + ke2;
-                                    if (de2 < 0) de2 += E2;
-                                    if (de2 >= E2) de2 -= E2;
-
-                                    for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                                    {
-                                        de1 = e1 + ke1;
-                                        if (de1 < 0) de1 += E1;
-                                        if (de1 >= E1) de1 -= E1;
-
-                                        for (kro = -halfKs; kro <= halfKs; kro++)
-                                        {
-                                            dro = ro + kro;
-                                            if (dro < 0) dro += RO;
-                                            if (dro >= RO) dro -= RO;
-
-                                            D(ind++, cha) = pDataCurr[de2*RO*E1 + de1*RO + dro];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        // compute V1
-                        D.sumOverCol(V1);
-                        v1Norm = nrm2(V1);
-                        scal((value_type)1.0 / v1Norm, V1);
-
-                        memcpy(DC.begin(), D.begin(), sizeof(T)*kss*CHA);
-                        gemm(DH_D, DC, true, D, false);
-                        // gemm(DH_D, D, true, D, false);
-
-                        for (po = 0; po<power; po++)
-                        {
-                            gemm(V, DH_D, false, V1, false);
-                            V1 = V;
-                            v1Norm = nrm2(V1);
-                            scal((value_type)1.0 / v1Norm, V1);
-                        }
-
-                        // compute U1
-                        gemm(U1, D, false, V1, false);
-
-                        phaseU1 = U1(0, 0);
-                        for (po = 1; po<kss; po++)
-                        {
-                            phaseU1 += U1(po, 0);
-                        }
-                        phaseU1 /= abs(phaseU1);
-
-                        // put the mean object phase to coil map
-                        conjugate(V1, V1);
-                        scal(phaseU1, V1);
-
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            pSen[cha*RO*E1*E2 + e2*RO*E1 + e1*RO + ro] = V1(cha, 0);
-                        }
-                    }
-                }
-            }
-        }
+        coil_map_Inati_running_sums(data, coilMap, RO, E1, E2, CHA, ks, kz, power, downsampling);
     }
     catch (...)
     {
@@ -398,11 +539,11 @@ void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
     }
 }
 
-template void coil_map_3d_Inati(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t kz, size_t power);
-template void coil_map_3d_Inati(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t kz, size_t power);
+template void coil_map_3d_Inati(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t kz, size_t power, size_t downsampling);
+template void coil_map_3d_Inati(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t kz, size_t power, size_t downsampling);
 
-template void coil_map_3d_Inati(const hoNDArray< complext<float> >& data, hoNDArray< complext<float> >& coilMap, size_t ks, size_t kz, size_t power);
-template void coil_map_3d_Inati(const hoNDArray< complext<double> >& data, hoNDArray< complext<double> >& coilMap, size_t ks, size_t kz, size_t power);
+template void coil_map_3d_Inati(const hoNDArray< complext<float> >& data, hoNDArray< complext<float> >& coilMap, size_t ks, size_t kz, size_t power, size_t downsampling);
+template void coil_map_3d_Inati(const hoNDArray< complext<double> >& data, hoNDArray< complext<double> >& coilMap, size_t ks, size_t kz, size_t power, size_t downsampling);
 // ------------------------------------------------------------------------
 
 template<typename T> 
@@ -618,7 +759,7 @@ template void coil_map_3d_Inati_Iter(const hoNDArray< complext<float> >& data, h
 template void coil_map_3d_Inati_Iter(const hoNDArray< complext<double> >& data, hoNDArray< complext<double> >& coilMap, size_t ks, size_t kz, size_t iterNum, double thres);
 // ------------------------------------------------------------------------
 
-template<typename T> void coil_map_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t kz, size_t power)
+template<typename T> void coil_map_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t kz, size_t power, size_t downsampling)
 {
     try
     {
@@ -650,21 +791,21 @@ template<typename T> void coil_map_Inati(const hoNDArray<T>& data, hoNDArray<T>&
                 hoNDArray<T> im(RO, E1, E2, CHA, const_cast<T*>(data.begin() + n*RO*E1*E2*CHA));
                 hoNDArray<T> cmap(RO, E1, E2, CHA, coilMap.begin() + n*RO*E1*E2*CHA);
 
-                Gadgetron::coil_map_3d_Inati(im, cmap, ks, kz, power);
+                Gadgetron::coil_map_3d_Inati(im, cmap, ks, kz, power, downsampling);
             }
         }
         else
         {
 #ifdef USE_OMP
             int num_procs = omp_get_num_procs();
-#pragma omp parallel for default(none) private(n) shared(num, RO, E1, CHA, data, coilMap, ks, power) if(num>num_procs/2)
+#pragma omp parallel for default(none) private(n) shared(num, RO, E1, CHA, data, coilMap, ks, power, downsampling) if(num>num_procs/2)
 #endif // USE_OMP
             for (n = 0; n < (long long)num; n++)
             {
                 hoNDArray<T> im(RO, E1, CHA, const_cast<T*>(data.begin()) + n*RO*E1*CHA);
                 hoNDArray<T> cmap(RO, E1, CHA, coilMap.begin() + n*RO*E1*CHA);
 
-                Gadgetron::coil_map_2d_Inati(im, cmap, ks, power);
+                Gadgetron::coil_map_2d_Inati(im, cmap, ks, power, downsampling);
             }
         }
     }
@@ -674,16 +815,16 @@ template<typename T> void coil_map_Inati(const hoNDArray<T>& data, hoNDArray<T>&
     }
 }
 
-template void coil_map_Inati(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t kz, size_t power);
-template void coil_map_Inati(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t kz, size_t power);
+template void coil_map_Inati(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t kz, size_t power, size_t downsampling);
+template void coil_map_Inati(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t kz, size_t power, size_t downsampling);
 
-template <typename T> hoNDArray<T> coil_map_Inati(const hoNDArray<T>& data, size_t ks, size_t kz, size_t power) {
+template <typename T> hoNDArray<T> coil_map_Inati(const hoNDArray<T>& data, size_t ks, size_t kz, size_t power, size_t downsampling) {
     auto coilMap = hoNDArray<T>(data.dimensions());
-    coil_map_Inati(data, coilMap, ks, kz, power);
+    coil_map_Inati(data, coilMap, ks, kz, power, downsampling);
     return coilMap;
 }
-template hoNDArray<std::complex<float>> coil_map_Inati(const hoNDArray< std::complex<float> >& data, size_t ks, size_t kz, size_t power);
-template hoNDArray<std::complex<double>> coil_map_Inati(const hoNDArray< std::complex<double> >& data, size_t ks, size_t kz, size_t power);
+template hoNDArray<std::complex<float>> coil_map_Inati(const hoNDArray< std::complex<float> >& data, size_t ks, size_t kz, size_t power, size_t downsampling);
+template hoNDArray<std::complex<double>> coil_map_Inati(const hoNDArray< std::complex<double> >& data, size_t ks, size_t kz, size_t power, size_t downsampling);
 // ------------------------------------------------------------------------
 
 template<typename T> void coil_map_Inati_Iter(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t kz, size_t iterNum, typename realType<T>::Type thres)
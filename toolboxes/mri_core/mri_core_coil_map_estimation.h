@@ -33,14 +33,17 @@ namespace Gadgetron
     // these functions are using 2D data correlation matrix
     // ks: the kernel size for local covariance estimation
     // power: number of iterations to apply power method
-    template<typename T>  void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t power = 3);
+    // downsampling: the coil map is estimated at every downsampling-th pixel and linearly interpolated in between
+    // the local covariances are computed with running sums over the kernel window, stored packed,
+    // and the power iterations run over a line of pixels at once
+    template<typename T>  void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t power = 3, size_t downsampling = 1);
 
     // data: [RO E1 E2 CHA], this functions uses true 3D data correlation matrix
-    template<typename T>  void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t kz = 5, size_t power = 3);
+    template<typename T>  void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t kz = 5, size_t power = 3, size_t downsampling = 1);
 
     // data: [RO E1 E2 CHA N S SLC ...], if E2==1, the 2D coil map estimation is assumed
-    template<typename T>  void coil_map_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t kz = 5, size_t power = 3);
-    template<typename T>  hoNDArray<T> coil_map_Inati(const hoNDArray<T>& data, size_t ks = 7, size_t kz = 5, size_t power = 3);
+    template<typename T>  void coil_map_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t kz = 5, size_t power = 3, size_t downsampling = 1);
+    template<typename T>  hoNDArray<T> coil_map_Inati(const hoNDArray<T>& data, size_t ks = 7, size_t kz = 5, size_t power = 3, size_t downsampling = 1);
 
     // the Souheil iteration method
     // data: [RO E1 CHA], only 3D array
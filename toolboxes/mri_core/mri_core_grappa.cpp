@@ -26,11 +26,15 @@
 #include "mri_core_utility.h"
 #include "hoMatrix.h"
 #include "hoNDArray_linalg.h"
+#include "cpp_blas.h"
 #include "hoNDFFT.h"
 #include "hoNDArray_utils.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_reductions.h"
 #include "ImageIOAnalyze.h"
+#include "OmpExceptions.h"
+
+#include <algorithm>
 
 #ifdef USE_OMP
     #include "omp.h"
@@ -478,6 +482,296 @@ template EXPORTMRICORE void grappa2d_fill_reconed_kspace(const hoNDArray<unsigne
 
 // ------------------------------------------------------------------------
 
+template <typename T>
+grappa2d_calib_accumulator<T>::grappa2d_calib_accumulator() : RO_(0), E1_(0), srcCHA_(0), dstCHA_(0), startRO_(0), endRO_(0), kRO_(0), complete_rows_(0), downdated_rows_(0)
+{
+}
+
+template <typename T>
+void grappa2d_calib_accumulator<T>::initialize(size_t RO, size_t E1, size_t srcCHA, size_t dstCHA, size_t startRO, size_t endRO)
+{
+    GADGET_CHECK_THROW(startRO <= endRO && endRO < RO);
+
+    RO_ = RO;
+    E1_ = E1;
+    srcCHA_ = srcCHA;
+    dstCHA_ = dstCHA;
+    startRO_ = startRO;
+    endRO_ = endRO;
+
+    src_.create(RO, E1, srcCHA);
+    dst_.create(RO, E1, dstCHA);
+
+    this->clear();
+}
+
+template <typename T>
+void grappa2d_calib_accumulator<T>::set_kernel_pattern(size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1)
+{
+    long long kROhalf = kRO / 2;
+    if (2 * kROhalf == kRO)
+    {
+        GWARN_STREAM("grappa2d_calib_accumulator<T>::set_kernel_pattern(...) - 2*kROhalf == kRO " << kRO);
+    }
+    kRO = 2 * kROhalf + 1;
+
+    if (kRO == kRO_ && kE1 == kE1_ && oE1 == oE1_) return;
+
+    GADGET_CHECK_THROW(!kE1.empty());
+    GADGET_CHECK_THROW(endRO_ - startRO_ + 1 > 2 * kROhalf);
+
+    kRO_ = kRO;
+    kE1_ = kE1;
+    oE1_ = oE1;
+
+    this->rebuild();
+}
+
+template <typename T>
+void grappa2d_calib_accumulator<T>::update(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, const std::vector<size_t>& lines)
+{
+    try
+    {
+        GADGET_CHECK_THROW(acsSrc.get_size(0) == RO_ && acsSrc.get_size(1) == E1_ && acsSrc.get_size(2) == srcCHA_);
+        GADGET_CHECK_THROW(acsDst.get_size(0) == RO_ && acsDst.get_size(1) == E1_ && acsDst.get_size(2) == dstCHA_);
+
+        /// the row blocks using the lines, either as source or as target
+        std::vector<size_t> rows;
+        for (auto line : lines)
+        {
+            GADGET_CHECK_THROW(line < E1_);
+            for (auto k : kE1_) if ((long long)line - k >= 0 && (long long)line - k < (long long)E1_) rows.push_back(line - k);
+            for (auto o : oE1_) if ((long long)line - o >= 0 && (long long)line - o < (long long)E1_) rows.push_back(line - o);
+        }
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        std::vector<size_t> removed, added;
+        for (auto e1 : rows) if (this->is_complete((long long)e1)) removed.push_back(e1);
+        for (auto line : lines) sampled_[line] = true;
+        for (auto e1 : rows) if (this->is_complete((long long)e1)) added.push_back(e1);
+
+        complete_rows_ = complete_rows_ + added.size() - removed.size();
+
+        /// replacing row blocks costs twice the work of adding them, so rebuild when that is cheaper;
+        /// also rebuild once as many row blocks were removed as there are, so the rounding errors of the removals do not add up
+        bool incremental = (removed.size() + added.size() <= complete_rows_) && (downdated_rows_ + removed.size() <= complete_rows_);
+
+        /// the removed row blocks are formed from the samples still stored
+        if (incremental && !removed.empty()) this->accumulate(removed, -1);
+
+        for (auto line : lines)
+        {
+            for (size_t cha = 0; cha < srcCHA_; cha++)
+                memcpy(&src_(0, line, cha), &acsSrc(0, line, cha), sizeof(T)*RO_);
+            for (size_t cha = 0; cha < dstCHA_; cha++)
+                memcpy(&dst_(0, line, cha), &acsDst(0, line, cha), sizeof(T)*RO_);
+        }
+
+        if (!incremental)
+        {
+            this->rebuild();
+            return;
+        }
+
+        if (!added.empty()) this->accumulate(added, 1);
+        downdated_rows_ += removed.size();
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in grappa2d_calib_accumulator<T>::update(...) ... ");
+    }
+}
+
+template <typename T>
+void grappa2d_calib_accumulator<T>::clear()
+{
+    sampled_.assign(E1_, false);
+    Gadgetron::clear(src_);
+    Gadgetron::clear(dst_);
+
+    complete_rows_ = 0;
+    downdated_rows_ = 0;
+    Gadgetron::clear(AHA_);
+    Gadgetron::clear(AHB_);
+}
+
+template <typename T>
+size_t grappa2d_calib_accumulator<T>::number_of_equations() const
+{
+    if (kE1_.empty()) return 0;
+    return complete_rows_ * (endRO_ - startRO_ + 2 - kRO_);
+}
+
+template <typename T>
+bool grappa2d_calib_accumulator<T>::is_complete(long long e1) const
+{
+    if (kE1_.empty()) return false;
+
+    for (auto k : kE1_)
+    {
+        if (e1 + k < 0 || e1 + k >= (long long)E1_ || !sampled_[e1 + k]) return false;
+    }
+
+    for (auto o : oE1_)
+    {
+        if (e1 + o < 0 || e1 + o >= (long long)E1_ || !sampled_[e1 + o]) return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+void grappa2d_calib_accumulator<T>::rebuild()
+{
+    size_t colA = kRO_ * kE1_.size() * srcCHA_;
+    size_t colB = dstCHA_ * oE1_.size();
+
+    AHA_.create(colA, colA);
+    AHB_.create(colA, colB);
+    Gadgetron::clear(AHA_);
+    Gadgetron::clear(AHB_);
+
+    std::vector<size_t> rows;
+    for (size_t e1 = 0; e1 < E1_; e1++) if (this->is_complete((long long)e1)) rows.push_back(e1);
+
+    complete_rows_ = rows.size();
+    downdated_rows_ = 0;
+
+    if (!rows.empty()) this->accumulate(rows, 1);
+}
+
+template <typename T>
+void grappa2d_calib_accumulator<T>::accumulate(const std::vector<size_t>& rows, value_type sign)
+{
+    long long kROhalf = kRO_ / 2;
+    size_t kNE1 = kE1_.size();
+    size_t oNE1 = oE1_.size();
+
+    size_t sRO = startRO_ + kROhalf;
+    size_t eRO = endRO_ - kROhalf;
+    size_t lenRO = eRO - sRO + 1;
+
+    size_t rowA = rows.size() * lenRO;
+    size_t colA = kRO_ * kNE1 * srcCHA_;
+    size_t colB = dstCHA_ * oNE1;
+
+    A_.create(rowA, colA);
+    B_.create(rowA, colB);
+    T* pA = A_.begin();
+    T* pB = B_.begin();
+
+    /// same layout as grappa2d_prepare_calib
+    for (size_t r = 0; r < rows.size(); r++)
+    {
+        size_t e1 = rows[r];
+
+        size_t col = 0;
+        for (size_t src = 0; src < srcCHA_; src++)
+        {
+            for (size_t ke1 = 0; ke1 < kNE1; ke1++)
+            {
+                const T* pSrc = &src_(0, e1 + kE1_[ke1], src);
+                for (long long kro = -kROhalf; kro <= kROhalf; kro++)
+                {
+                    T* pCol = pA + r * lenRO + col * rowA;
+                    for (size_t ro = sRO; ro <= eRO; ro++) pCol[ro - sRO] = pSrc[ro + kro];
+                    col++;
+                }
+            }
+        }
+
+        col = 0;
+        for (size_t oe1 = 0; oe1 < oNE1; oe1++)
+        {
+            for (size_t dst = 0; dst < dstCHA_; dst++)
+            {
+                memcpy(pB + r * lenRO + col * rowA, &dst_(sRO, e1 + oE1_[oe1], dst), sizeof(T)*lenRO);
+                col++;
+            }
+        }
+    }
+
+    BLAS::herk(false, true, colA, rowA, sign, A_.begin(), rowA, value_type(1), AHA_.begin(), colA);
+    if (colB > 0) BLAS::gemm(true, false, colA, colB, rowA, T(sign), A_.begin(), rowA, B_.begin(), rowA, T(1), AHB_.begin(), colA);
+}
+
+template <typename T>
+void grappa2d_calib_accumulator<T>::snapshot(grappa2d_calib_equations<T>& equations) const
+{
+    equations.kRO = kRO_;
+    equations.kE1 = kE1_;
+    equations.oE1 = oE1_;
+    equations.srcCHA = srcCHA_;
+    equations.dstCHA = dstCHA_;
+    equations.rows = kE1_.empty() ? 0 : complete_rows_;
+    equations.AHA = AHA_;
+    equations.AHB = AHB_;
+}
+
+template <typename T>
+void grappa2d_calib_accumulator<T>::solve(double thres, hoNDArray<T>& ker) const
+{
+    try
+    {
+        grappa2d_calib_equations<T> equations;
+        this->snapshot(equations);
+        equations.solve(thres, ker);
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in grappa2d_calib_accumulator<T>::solve(...) ... ");
+    }
+}
+
+template <typename T>
+void grappa2d_calib_equations<T>::solve(double thres, hoNDArray<T>& ker)
+{
+    typedef typename realType<T>::Type value_type;
+
+    try
+    {
+        GADGET_CHECK_THROW(!kE1.empty());
+        GADGET_CHECK_THROW(rows > 0);
+
+        size_t K = AHA.get_size(0);
+
+        /// Tikhonov regularization as in SolveLinearSystem_Tikhonov, on the accumulated A'*A
+        double trA = 0;
+        for (size_t c = 0; c < K; c++) trA += std::abs(AHA(c, c));
+
+        double value = trA*thres / K;
+        for (size_t c = 0; c < K; c++)
+        {
+            AHA(c, c) = T((value_type)(std::abs(AHA(c, c)) + value));
+        }
+
+        if (trA / K < 4.0)
+        {
+            value_type scalingFactor = (value_type)(K*4.0 / trA);
+            Gadgetron::scal(scalingFactor, AHA);
+            Gadgetron::scal(scalingFactor, AHB);
+        }
+
+        Gadgetron::posv(AHA, AHB);
+
+        ker.create(kRO, kE1.size(), srcCHA, dstCHA, oE1.size());
+        memcpy(ker.begin(), AHB.begin(), ker.get_number_of_bytes());
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in grappa2d_calib_equations<T>::solve(...) ... ");
+    }
+}
+
+template struct EXPORTMRICORE grappa2d_calib_equations< std::complex<float> >;
+template struct EXPORTMRICORE grappa2d_calib_equations< std::complex<double> >;
+
+template class EXPORTMRICORE grappa2d_calib_accumulator< std::complex<float> >;
+template class EXPORTMRICORE grappa2d_calib_accumulator< std::complex<double> >;
+
+// ------------------------------------------------------------------------
+
 template <typename T> 
 void grappa2d_recon(const hoNDArray<T>& kspace, const hoNDArray<T>& ker, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, bool periodic_boundary_condition, hoNDArray<T>& res)
 {
@@ -1840,4 +2134,175 @@ template EXPORTMRICORE void apply_unmix_coeff_aliased_image_3D(const hoNDArray<
 
 // ------------------------------------------------------------------------
 
+template <typename T> 
+void apply_unmix_coeff_kspace_fused(const hoNDArray<T>& kspace, const hoNDArray<T>& unmixCoeff, typename realType<T>::Type scaleFactor, hoNDArray<T>& complexIm, size_t tileCHA)
+{
+    try
+    {
+        size_t RO = kspace.get_size(0);
+        size_t E1 = kspace.get_size(1);
+        size_t E2 = kspace.get_size(2);
+        size_t CHA = kspace.get_size(3);
+        size_t N = kspace.get_size(4);
+        size_t S = kspace.get_size(5);
+        size_t SLC = kspace.get_size(6);
+
+        size_t uCHA = unmixCoeff.get_size(3);
+        size_t uN = unmixCoeff.get_size(4);
+        size_t uS = unmixCoeff.get_size(5);
+
+        GADGET_CHECK_THROW(unmixCoeff.get_size(0) == RO);
+        GADGET_CHECK_THROW(unmixCoeff.get_size(1) == E1);
+        GADGET_CHECK_THROW(unmixCoeff.get_size(2) == E2);
+        GADGET_CHECK_THROW(uCHA <= CHA);
+        GADGET_CHECK_THROW(unmixCoeff.get_size(6) == SLC);
+
+        if (complexIm.get_size(0) != RO
+            || complexIm.get_size(1) != E1
+            || complexIm.get_size(2) != E2
+            || complexIm.get_number_of_elements() != RO*E1*E2*N*S*SLC)
+        {
+            complexIm.create(RO, E1, E2, 1, N, S, SLC);
+        }
+
+        if (tileCHA == 0 || tileCHA > uCHA) tileCHA = uCHA;
+
+        size_t imSize = RO*E1*E2;
+        long long num = N*S*SLC;
+        long long ii;
+
+#ifdef USE_OMP
+        long long numThreads = omp_get_max_threads();
+#else
+        long long numThreads = 1;
+#endif // USE_OMP
+
+        if (num < numThreads)
+        {
+            // too few images to share out, e.g. a single 2D slice; the images are done one after another,
+            // all channels of an image are fft-ed in one call, which shares the channels over the threads,
+            // and the accumulation is shared out over the pixels
+            hoNDArray<T> aliasedIm(RO, E1, E2, uCHA);
+            hoNDArray<T> buf(RO, E1, E2, uCHA);
+
+            for (ii = 0; ii < num; ii++)
+            {
+                size_t slc = ii / (N*S);
+                size_t s = (ii - slc*N*S) / N;
+                size_t n = ii - slc*N*S - s*N;
+
+                size_t usedN = (n < uN) ? n : uN - 1;
+                size_t usedS = (s < uS) ? s : uS - 1;
+
+                const T* pKspace = &(kspace(0, 0, 0, 0, n, s, slc));
+                const T* pUnmix = &(unmixCoeff(0, 0, 0, 0, usedN, usedS, slc));
+                T* pRes = &(complexIm(0, 0, 0, 0, n, s, slc));
+
+                hoNDArray<T> kspaceIm(RO, E1, E2, uCHA, const_cast<T*>(pKspace));
+                if (E2 > 1)
+                {
+                    Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft3c(kspaceIm, aliasedIm, buf);
+                }
+                else
+                {
+                    Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft2c(kspaceIm, aliasedIm, buf);
+                }
+
+                const T* pIm = aliasedIm.begin();
+                long long p;
+
+#pragma omp parallel for default(none) private(p) shared(pIm, pUnmix, pRes, scaleFactor, uCHA, imSize) if(imSize>64*1024)
+                for (p = 0; p < (long long)imSize; p++)
+                {
+                    T v = pUnmix[p] * pIm[p];
+                    for (size_t c = 1; c < uCHA; c++) v += pUnmix[c*imSize + p] * pIm[c*imSize + p];
+                    pRes[p] = v * scaleFactor;
+                }
+            }
+
+            return;
+        }
+
+        // the buffers are allocated and the images fft-ed in the parallel region, a throw is carried out of it
+        OmpExceptions errors;
+
+#pragma omp parallel default(none) private(ii) shared(kspace, unmixCoeff, scaleFactor, complexIm, tileCHA, RO, E1, E2, N, S, uCHA, uN, uS, imSize, num, errors)
+        {
+            hoNDArray<T> aliasedIm, buf;
+            errors.run([&]()
+            {
+                aliasedIm.create(RO, E1, E2, tileCHA);
+                buf.create(RO, E1, E2, tileCHA);
+            });
+
+#pragma omp for schedule(dynamic)
+            for (ii = 0; ii < num; ii++)
+            {
+                errors.run([&]()
+                {
+                    size_t slc = ii / (N*S);
+                    size_t s = (ii - slc*N*S) / N;
+                    size_t n = ii - slc*N*S - s*N;
+
+                    size_t usedN = (n < uN) ? n : uN - 1;
+                    size_t usedS = (s < uS) ? s : uS - 1;
+
+                    const T* pKspace = &(kspace(0, 0, 0, 0, n, s, slc));
+                    const T* pUnmix = &(unmixCoeff(0, 0, 0, 0, usedN, usedS, slc));
+                    T* pRes = &(complexIm(0, 0, 0, 0, n, s, slc));
+
+                    for (size_t cha = 0; cha < uCHA; cha += tileCHA)
+                    {
+                        size_t numCHA = std::min(tileCHA, uCHA - cha);
+
+                        hoNDArray<T> kspaceTile(RO, E1, E2, numCHA, const_cast<T*>(pKspace + cha*imSize));
+                        hoNDArray<T> aliasedTile(RO, E1, E2, numCHA, aliasedIm.begin());
+                        hoNDArray<T> bufTile(RO, E1, E2, numCHA, buf.begin());
+
+                        if (E2 > 1)
+                        {
+                            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft3c(kspaceTile, aliasedTile, bufTile);
+                        }
+                        else
+                        {
+                            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft2c(kspaceTile, aliasedTile, bufTile);
+                        }
+
+                        for (size_t c = 0; c < numCHA; c++)
+                        {
+                            const T* pIm = aliasedTile.begin() + c*imSize;
+                            const T* pCoeff = pUnmix + (cha + c)*imSize;
+
+                            if (cha + c == 0)
+                            {
+                                for (size_t p = 0; p < imSize; p++) pRes[p] = pCoeff[p] * pIm[p];
+                            }
+                            else
+                            {
+                                for (size_t p = 0; p < imSize; p++) pRes[p] += pCoeff[p] * pIm[p];
+                            }
+                        }
+                    }
+
+                    if (scaleFactor != 1)
+                    {
+                        for (size_t p = 0; p < imSize; p++) pRes[p] *= scaleFactor;
+                    }
+                });
+            }
+        }
+
+        errors.rethrow();
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in apply_unmix_coeff_kspace_fused(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void apply_unmix_coeff_kspace_fused(const hoNDArray< std::complex<float> >& kspace, const hoNDArray< std::complex<float> >& unmixCoeff, float scaleFactor, hoNDArray< std::complex<float> >& complexIm, size_t tileCHA);
+template EXPORTMRICORE void apply_unmix_coeff_kspace_fused(const hoNDArray< std::complex<double> >& kspace, const hoNDArray< std::complex<double> >& unmixCoeff, double scaleFactor, hoNDArray< std::complex<double> >& complexIm, size_t tileCHA);
+
+// ------------------------------------------------------------------------
+
 }
@@ -108,6 +108,89 @@ namespace Gadgetron {
     /// in case the recon=A*ker has already been computed, assign them back to res
     template <typename T> EXPORTMRICORE void grappa2d_fill_reconed_kspace(const hoNDArray<unsigned short>& AInd, const hoNDArray<T>& recon, const std::vector<int>& oE1, size_t RO, size_t E1, hoNDArray<T>& res);
 
+    /// the accumulated normal equations of a grappa2d_calib_accumulator, taken out to be solved elsewhere, e.g. on another thread
+    template <typename T>
+    struct EXPORTMRICORE grappa2d_calib_equations
+    {
+        size_t kRO;
+        std::vector<int> kE1;
+        std::vector<int> oE1;
+        size_t srcCHA;
+        size_t dstCHA;
+
+        /// number of row blocks of A accumulated
+        size_t rows;
+        hoNDArray<T> AHA;
+        hoNDArray<T> AHB;
+
+        /// solve for ker [kRO kE1 srcCHA dstCHA oE1], as grappa2d_perform_calib; AHA and AHB are overwritten
+        void solve(double thres, hoNDArray<T>& ker);
+    };
+
+    /// incremental grappa 2d calibration
+    /// the normal equations A'*A and A'*B of grappa2d_prepare_calib are accumulated as calibration lines arrive, so a calibration
+    /// only needs the regularized Cholesky solve of grappa2d_perform_calib
+    /// every row block of A (all RO positions of one target line e1) is added once all the lines e1+kE1 and e1+oE1 are sampled;
+    /// when a line is replaced, only the row blocks using it are removed with the old samples and added again with the new ones,
+    /// unless that costs more than rebuilding the equations from the stored lines
+    template <typename T>
+    class EXPORTMRICORE grappa2d_calib_accumulator
+    {
+    public:
+
+        typedef typename realType<T>::Type value_type;
+
+        grappa2d_calib_accumulator();
+
+        /// calibration lines are [RO srcCHA] and [RO dstCHA]; the rows use the RO range [startRO endRO]
+        /// drops all lines and equations
+        void initialize(size_t RO, size_t E1, size_t srcCHA, size_t dstCHA, size_t startRO, size_t endRO);
+
+        /// kernel pattern as computed by grappa2d_kerPattern; if it changes, the equations are rebuilt from the stored lines
+        void set_kernel_pattern(size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1);
+
+        /// copy the lines listed in lines from acsSrc [RO E1 srcCHA] and acsDst [RO E1 dstCHA] and update the equations
+        /// a line copied before is replaced
+        void update(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, const std::vector<size_t>& lines);
+
+        /// drop all lines and equations, keeping the sizes and the kernel pattern
+        void clear();
+
+        /// number of rows of A accumulated
+        size_t number_of_equations() const;
+
+        /// copy of the equations as they are now, with the kernel pattern they were accumulated for
+        void snapshot(grappa2d_calib_equations<T>& equations) const;
+
+        /// solve for ker [kRO kE1 srcCHA dstCHA oE1], as grappa2d_perform_calib
+        void solve(double thres, hoNDArray<T>& ker) const;
+
+    protected:
+
+        void rebuild();
+        bool is_complete(long long e1) const;
+        /// add sign * A'*A and sign * A'*B of the row blocks listed in rows to the equations
+        void accumulate(const std::vector<size_t>& rows, value_type sign);
+
+        size_t RO_, E1_, srcCHA_, dstCHA_, startRO_, endRO_;
+
+        size_t kRO_;
+        std::vector<int> kE1_;
+        std::vector<int> oE1_;
+
+        hoNDArray<T> src_;
+        hoNDArray<T> dst_;
+        std::vector<bool> sampled_;
+
+        hoNDArray<T> AHA_;
+        hoNDArray<T> AHB_;
+        size_t complete_rows_;
+        size_t downdated_rows_;
+
+        hoNDArray<T> A_;
+        hoNDArray<T> B_;
+    };
+
     /// ---------------------------------------------------------------------
     /// 3D grappa
     /// ---------------------------------------------------------------------
@@ -183,6 +266,17 @@ namespace Gadgetron {
     /// aliasedIm : [RO E1 E2 srcCHA ...]
     template <typename T> EXPORTMRICORE void apply_unmix_coeff_aliased_image_3D(const hoNDArray<T>& aliasedIm, const hoNDArray<T>& unmixCoeff, hoNDArray<T>& complexIm);
 
+    /// apply unmixing coefficients on undersampled kspace of all slices, N and S in one pass per image
+    /// kspace: [RO E1 E2 CHA N S SLC]
+    /// unmixCoeff : [RO E1 E2 uCHA uN uS SLC], uCHA <= CHA; for n >= uN and s >= uS, the last uN and uS are used
+    /// scaleFactor : applied to the unwrapped images, e.g. the SNR unit scaling
+    /// complexIm : [RO E1 E2 1 N S SLC] unwrapped complex images
+    /// for every image, tileCHA channels at a time are inverse fft-ed to a per thread buffer and accumulated into the unwrapped image,
+    /// so the aliased images of all channels are never stored; the images are shared out over the OpenMP threads
+    /// when there are fewer images than threads, the images are done in turn with all channels fft-ed together and the pixels shared out
+    template <typename T> EXPORTMRICORE void apply_unmix_coeff_kspace_fused(const hoNDArray<T>& kspace, const hoNDArray<T>& unmixCoeff,
+                                                                        typename realType<T>::Type scaleFactor, hoNDArray<T>& complexIm, size_t tileCHA = 4);
+
     /// ------------------------
     /// grappa 3d low level functions
     /// ------------------------
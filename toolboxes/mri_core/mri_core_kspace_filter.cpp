@@ -6,6 +6,7 @@
 
 #include "mri_core_kspace_filter.h"
 #include "hoNDArray_elemwise.h"
+#include "hoNDArray_expressions.h"
 #include <boost/algorithm/string.hpp>
 
 #ifdef M_PI
@@ -763,13 +764,7 @@ void apply_kspace_filter_E1(const hoNDArray<T>& data, const hoNDArray<T>& fE1, h
     {
         GADGET_CHECK_THROW(data.get_size(1) == fE1.get_number_of_elements());
 
-        hoNDArray<T> fRO(data.get_size(0));
-        fRO.fill(T(1.0));
-
-        hoNDArray<T> fxy;
-        compute_2d_filter(fRO, fE1, fxy);
-
-        Gadgetron::multiply(data, fxy, dataFiltered);
+        assign(dataFiltered, lazy(data) * along(fE1, 1, data.dimensions()));
     }
     catch (...)
     {
@@ -815,10 +810,7 @@ void apply_kspace_filter_ROE1(const hoNDArray<T>& data, const hoNDArray<T>& fRO,
         GADGET_CHECK_THROW(data.get_size(0) == fRO.get_size(0));
         GADGET_CHECK_THROW(data.get_size(1) == fE1.get_size(0));
 
-        hoNDArray<T> fROE1;
-        compute_2d_filter(fRO, fE1, fROE1);
-
-        Gadgetron::multiply(data, fROE1, dataFiltered);
+        assign(dataFiltered, lazy(data) * lazy(fRO) * along(fE1, 1, data.dimensions()));
     }
     catch (...)
     {
@@ -840,16 +832,7 @@ void apply_kspace_filter_E2(const hoNDArray<T>& data, const hoNDArray<T>& fE2, h
     {
         GADGET_CHECK_THROW(data.get_size(2) == fE2.get_number_of_elements());
 
-        hoNDArray<T> fRO(data.get_size(0));
-        fRO.fill(T(1.0));
-
-        hoNDArray<T> fE1(data.get_size(1));
-        fE1.fill(T(1.0));
-
-        hoNDArray<T> fxyz;
-        compute_3d_filter(fRO, fE1, fE2, fxyz);
-
-        Gadgetron::multiply(data, fxyz, dataFiltered);
+        assign(dataFiltered, lazy(data) * along(fE2, 2, data.dimensions()));
     }
     catch (...)
     {
@@ -872,13 +855,7 @@ void apply_kspace_filter_ROE2(const hoNDArray<T>& data, const hoNDArray<T>& fRO,
         GADGET_CHECK_THROW(data.get_size(0) == fRO.get_number_of_elements());
         GADGET_CHECK_THROW(data.get_size(2) == fE2.get_number_of_elements());
 
-        hoNDArray<T> fE1(data.get_size(1));
-        fE1.fill(T(1.0));
-
-        hoNDArray<T> fxyz;
-        compute_3d_filter(fRO, fE1, fE2, fxyz);
-
-        Gadgetron::multiply(data, fxyz, dataFiltered);
+        assign(dataFiltered, lazy(data) * lazy(fRO) * along(fE2, 2, data.dimensions()));
     }
     catch (...)
     {
@@ -901,13 +878,7 @@ void apply_kspace_filter_E1E2(const hoNDArray<T>& data, const hoNDArray<T>& fE1,
         GADGET_CHECK_THROW(data.get_size(1) == fE1.get_number_of_elements());
         GADGET_CHECK_THROW(data.get_size(2) == fE2.get_number_of_elements());
 
-        hoNDArray<T> fRO(data.get_size(0));
-        fRO.fill(T(1.0));
-
-        hoNDArray<T> fxyz;
-        compute_3d_filter(fRO, fE1, fE2, fxyz);
-
-        Gadgetron::multiply(data, fxyz, dataFiltered);
+        assign(dataFiltered, lazy(data) * along(fE1, 1, data.dimensions()) * along(fE2, 2, data.dimensions()));
     }
     catch (...)
     {
@@ -955,10 +926,7 @@ void apply_kspace_filter_ROE1E2(const hoNDArray<T>& data, const hoNDArray<T>& fR
         GADGET_CHECK_THROW(data.get_size(1) == fE1.get_number_of_elements());
         GADGET_CHECK_THROW(data.get_size(2) == fE2.get_number_of_elements());
 
-        hoNDArray<T> fxyz;
-        compute_3d_filter(fRO, fE1, fE2, fxyz);
-
-        Gadgetron::multiply(data, fxyz, dataFiltered);
+        assign(dataFiltered, lazy(data) * lazy(fRO) * along(fE1, 1, data.dimensions()) * along(fE2, 2, data.dimensions()));
     }
     catch (...)
     {
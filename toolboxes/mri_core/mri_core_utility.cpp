@@ -456,7 +456,7 @@ namespace Gadgetron
     // ------------------------------------------------------------------------
 
     template <typename T> 
-    void compute_eigen_channel_coefficients(const hoNDArray<T>& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT<T> > > >& KLT)
+    void compute_eigen_channel_coefficients(const hoNDArray<T>& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT<T> > > >& KLT, double coil_compression_energy_thres, double stable_tolerance)
     {
         
         size_t RO = data.get_size(0);
@@ -477,6 +477,8 @@ namespace Gadgetron
         size_t dataAveN = dataAve.get_size(4);
         size_t dataAveS = dataAve.get_size(5);
 
+        bool randomized = (compression_num_modesKept == 0 && coil_compression_energy_thres > 0);
+
         if(KLT.size()!=SLC) KLT.resize(SLC);
         for (slc = 0; slc < SLC; slc++)
         {
@@ -499,15 +501,55 @@ namespace Gadgetron
                     size_t n_used = n;
                     if (n_used >= dataAveN) n_used = dataAveN - 1;
 
+                    if (n_used != n || s_used != s)
+                    {
+                        // same averaged data as an earlier N or S
+                        KLT[slc][s][n] = KLT[slc][s_used][n_used];
+                        continue;
+                    }
+
                     T* pDataAve = &(dataAve(0, 0, 0, 0, n_used, s_used, slc));
                     hoNDArray<T> dataUsed(RO, E1, E2, CHA, pDataAve);
 
-                    if (slc == 0 && n == 0 && s == 0)
+                    bool first = (slc == 0 && n == 0 && s == 0);
+
+                    if (stable_tolerance > 0)
+                    {
+                        // the KLT of the previous call, or of the previous N or S, if it still describes the data
+                        const hoNDKLT<T>* candidate = NULL;
+                        if (KLT[slc][s][n].transform_length() == CHA && (first || KLT[slc][s][n].output_length() == KLT[0][0][0].output_length()))
+                        {
+                            candidate = &KLT[slc][s][n];
+                        }
+
+                        if (candidate == NULL || !candidate->is_stable(dataUsed, 3, (value_type)stable_tolerance))
+                        {
+                            candidate = NULL;
+                            if (n > 0)
+                                candidate = &KLT[slc][s][n - 1];
+                            else if (s > 0)
+                                candidate = &KLT[slc][s - 1][n];
+
+                            if (candidate != NULL && !candidate->is_stable(dataUsed, 3, (value_type)stable_tolerance)) candidate = NULL;
+                        }
+
+                        if (candidate != NULL)
+                        {
+                            if (candidate != &KLT[slc][s][n]) KLT[slc][s][n] = *candidate;
+                            continue;
+                        }
+                    }
+
+                    if (first)
                     {
                         if (compression_num_modesKept > 0)
                         {
                             KLT[slc][s][n].prepare(dataUsed, 3, compression_num_modesKept);
                         }
+                        else if (randomized)
+                        {
+                            KLT[slc][s][n].prepare_randomized(dataUsed, 3, (value_type)(coil_compression_energy_thres));
+                        }
                         else if (coil_compression_thres > 0)
                         {
                             KLT[slc][s][n].prepare(dataUsed, 3, (value_type)(coil_compression_thres));
@@ -517,16 +559,13 @@ namespace Gadgetron
                             KLT[slc][s][n].prepare(dataUsed, 3, (size_t)(0));
                         }
                     }
+                    else if (randomized)
+                    {
+                        KLT[slc][s][n].prepare_randomized(dataUsed, 3, (value_type)0, KLT[0][0][0].output_length());
+                    }
                     else
                     {
-                        if(n>=dataAveN && s>=dataAveS)
-                        {
-                            KLT[slc][s][n] = KLT[slc][dataAveS - 1][dataAveN-1];
-                        }
-                        else
-                        {
-                            KLT[slc][s][n].prepare(dataUsed, 3, KLT[0][0][0].output_length());
-                        }
+                        KLT[slc][s][n].prepare(dataUsed, 3, KLT[0][0][0].output_length());
                     }
                 }
             }
@@ -534,8 +573,8 @@ namespace Gadgetron
         
     }
 
-    template EXPORTMRICORE void compute_eigen_channel_coefficients(const hoNDArray< std::complex<float> >& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT< std::complex<float> > > > >& KLT);
-    template EXPORTMRICORE void compute_eigen_channel_coefficients(const hoNDArray< std::complex<double> >& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT< std::complex<double> > > > >& KLT);
+    template EXPORTMRICORE void compute_eigen_channel_coefficients(const hoNDArray< std::complex<float> >& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT< std::complex<float> > > > >& KLT, double coil_compression_energy_thres, double stable_tolerance);
+    template EXPORTMRICORE void compute_eigen_channel_coefficients(const hoNDArray< std::complex<double> >& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT< std::complex<double> > > > >& KLT, double coil_compression_energy_thres, double stable_tolerance);
 
     // ------------------------------------------------------------------------
 
@@ -46,7 +46,9 @@ namespace Gadgetron
     /// if average_N==true or average_S==true, data will first be averaged along N or S
     /// if coil_compression_thres>0 or compression_num_modesKept>0, the number of kept channels is determine; compression_num_modesKept has the priority if it is set
     /// for all N, S and SLC, the same number of channels is kept. This number is either set by compression_num_modesKept or automatically determined in the first KLT prepare call
-    template <typename T> EXPORTMRICORE void compute_eigen_channel_coefficients(const hoNDArray<T>& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT<T> > > >& KLT);
+    /// if coil_compression_energy_thres>0 and compression_num_modesKept is not set, the modes holding this fraction of the energy are kept, computed with hoNDKLT::prepare_randomized
+    /// if stable_tolerance>0, the KLT of an earlier N or S, or the one already in KLT, is reused for data it still describes within this tolerance (see hoNDKLT::is_stable)
+    template <typename T> EXPORTMRICORE void compute_eigen_channel_coefficients(const hoNDArray<T>& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT<T> > > >& KLT, double coil_compression_energy_thres = -1, double stable_tolerance = 0);
 
     /// apply eigen channel coefficients
     /// apply KLT coefficients to data for every N, S, and SLC
@@ -13,16 +13,63 @@
 
 #include <boost/math/special_functions/sign.hpp>
 
+#include <algorithm>
 #include <random>
 
 namespace Gadgetron { 
 
+namespace
+{
+    // squared distance between two points of P dimensions
+    template <typename T>
+    inline T distance_squared(const T* x, const T* c, size_t P)
+    {
+        T d = 0;
+#pragma omp simd reduction(+:d)
+        for (size_t p = 0; p < P; p++)
+        {
+            T t = x[p] - c[p];
+            d += t*t;
+        }
+        return d;
+    }
+
+    // closest centroid of x, the first one if several are equally close
+    template <typename T>
+    inline size_t closest_centroid(const T* x, const T* pC, size_t P, size_t K, T& d_closest, T& d_second)
+    {
+        size_t closest = 0;
+        d_closest = std::numeric_limits<T>::max();
+        d_second = std::numeric_limits<T>::max();
+
+        for (size_t k = 0; k < K; k++)
+        {
+            T d = distance_squared(x, pC + k*P, P);
+            if (d < d_closest)
+            {
+                d_second = d_closest;
+                d_closest = d;
+                closest = k;
+            }
+            else if (d < d_second)
+            {
+                d_second = d;
+            }
+        }
+
+        return closest;
+    }
+}
+
 template <typename T> 
 kmeans<T>::kmeans()
 {
     max_iter_ = 100;
     replicates_ = 10;
     perform_online_update_ = true;
+    use_triangle_inequality_ = true;
+    mini_batch_size_ = 0;
+    seed_ = 0;
 
     verbose_ = false;
     perform_timing_ = false;
@@ -36,6 +83,15 @@ kmeans<T>::~kmeans()
 {
 }
 
+template <typename T>
+std::mt19937 kmeans<T>::create_random_generator() const
+{
+    if (this->seed_ > 0) return std::mt19937(this->seed_);
+
+    std::random_device rd;
+    return std::mt19937(rd());
+}
+
 template <typename T>
 void kmeans<T>::get_initial_guess_sample(const ArrayType& X, size_t K, ArrayType& C_for_initial)
 {
@@ -48,8 +104,7 @@ void kmeans<T>::get_initial_guess_sample(const ArrayType& X, size_t K, ArrayType
 
         GADGET_CHECK_THROW(N>K);
 
-        std::random_device rd;
-        std::mt19937 gen(rd());
+        std::mt19937 gen = this->create_random_generator();
         std::uniform_real_distribution<> dis(0, 1);
 
         C_for_initial.create(P, K, this->replicates_);
@@ -86,8 +141,7 @@ void kmeans<T>::get_initial_guess_uniform(const ArrayType& X, size_t K, ArrayTyp
 
         GADGET_CHECK_THROW(N>K);
 
-        std::random_device rd;
-        std::mt19937 gen(rd());
+        std::mt19937 gen = this->create_random_generator();
         std::uniform_real_distribution<> dis(0, 1);
 
         C_for_initial.create(P, K, this->replicates_);
@@ -143,8 +197,7 @@ void kmeans<T>::get_initial_guess_cluster(const ArrayType& X, size_t K, ArrayTyp
 
         GADGET_CHECK_THROW(N>K);
 
-        std::random_device rd;
-        std::mt19937 gen(rd());
+        std::mt19937 gen = this->create_random_generator();
         std::uniform_real_distribution<> dis(0, 1);
 
         C_for_initial.create(P, K, this->replicates_);
@@ -212,35 +265,23 @@ void kmeans<T>::get_initial_guess_kmeansplusplus(const ArrayType& X, size_t K, A
 
         GADGET_CHECK_THROW(N>K);
 
-        std::random_device rd;
-        std::mt19937 gen(rd());
+        std::mt19937 gen = this->create_random_generator();
         std::uniform_real_distribution<> dis(0, 1);
 
         C_for_initial.create(P, K, this->replicates_);
         Gadgetron::clear(C_for_initial);
 
-        ClusterType IDX;
-        IDX.resize(N, 0);
-
-        // find the first center
         ArrayType C;
         C.create(P, K);
         Gadgetron::clear(C);
 
-        VectorType norm_C(K, 0);
-
-        ArrayType D;
-        D.create(P, N);
+        // squared distance of every point to its closest chosen centroid, and its cumulative sum
+        VectorType D_min(N);
+        std::vector<double> cumsum_D(N);
 
-        ArrayType D_norm;
-        D_norm.create(N);
-
-        ArrayType cumsum_D_norm;
-        cumsum_D_norm.create(N);
-
-        ArrayType CX;
+        const T* pX = X.begin();
 
-        size_t n, i, t, s;
+        size_t n, i, s;
 
         for (n = 0; n < this->replicates_; n++)
         {
@@ -248,31 +289,32 @@ void kmeans<T>::get_initial_guess_kmeansplusplus(const ArrayType& X, size_t K, A
             if (ind >= N) ind = N - 1;
             memcpy(&C(0, 0), &X(0, ind), sizeof(T)*P);
 
-            ArrayType aC;
-            aC.create(P, C.begin());
-            norm_C[0] = Gadgetron::dot(aC, aC,false);
-
-            for (i = 1; i < K; i++)
+            for (i = 0; i + 1 < K; i++)
             {
-                // compute distance to the nearest centroid for all data points
-                this->compute_dist(X, IDX, C, D);
+                // only the distances to the newest centroid need to be computed
+                const T* pC = &C(0, i);
 
-                // compute norm of distance vector
-                this->compute_norm_dist(D, D_norm);
+                long long t;
+#pragma omp parallel for
+                for (t = 0; t < (long long)N; t++)
+                {
+                    T d = distance_squared(pX + t*P, pC, P);
+                    if (i == 0 || d < D_min[t]) D_min[t] = d;
+                }
 
-                // compute accumulated distrance
-                cumsum_D_norm(0) = D_norm(0);
-                for (t = 1; t < N; t++)
+                double sum = 0;
+                for (t = 0; t < (long long)N; t++)
                 {
-                    cumsum_D_norm(t) = cumsum_D_norm(t - 1) + D_norm(t);
+                    sum += D_min[t];
+                    cumsum_D[t] = sum;
                 }
 
-                if (std::abs(cumsum_D_norm(N - 1)) < FLT_EPSILON)
+                if (sum < FLT_EPSILON)
                 {
-                    GERROR_STREAM("std::abs(cumsum_D_norm(N-1))<FLT_EPSILON ... ");
-                    // set centroid from i to K
+                    GERROR_STREAM("cumsum_D(N-1)<FLT_EPSILON ... ");
+                    // set centroid from i+1 to K
 
-                    for (s = i; s < K; s++)
+                    for (s = i + 1; s < K; s++)
                     {
                         size_t ind = (size_t)(dis(gen)*N);
                         if (ind >= N) ind = N - 1;
@@ -281,28 +323,12 @@ void kmeans<T>::get_initial_guess_kmeansplusplus(const ArrayType& X, size_t K, A
                     break;
                 }
 
-                // convert to probability
-                for (t = 0; t < N; t++)
-                {
-                    cumsum_D_norm(t) /= cumsum_D_norm(N - 1);
-                }
-
-                T v = dis(gen);
-                for (t = 0; t < N; t++)
-                {
-                    if (cumsum_D_norm(t)>=v) break;
-                }
-
-                memcpy(&C(0, i), &X(0, t), sizeof(T)*P);
-
-                aC.create(P, &C(0, i));
-                norm_C[i] = Gadgetron::dot(aC, aC,false);
-
-                // update the IDX
-                ArrayType curr_C;
-                curr_C.create(P, i+1, C.begin());
+                // pick the next centroid with probability proportional to D_min
+                double v = dis(gen) * sum;
+                size_t picked = std::lower_bound(cumsum_D.begin(), cumsum_D.end(), v) - cumsum_D.begin();
+                if (picked >= N) picked = N - 1;
 
-                this->update_IDX(X, curr_C, norm_C, IDX);
+                memcpy(&C(0, i + 1), &X(0, picked), sizeof(T)*P);
             }
 
             memcpy(&C_for_initial(0, 0, n), C.begin(), sizeof(T)*P*K);
@@ -398,6 +424,12 @@ void kmeans<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial
         GADGET_CHECK_THROW(C_for_initial.get_size(0) == P);
         GADGET_CHECK_THROW(C_for_initial.get_size(1) == K);
 
+        if (this->mini_batch_size_ > 0 && this->mini_batch_size_ < N)
+        {
+            this->run_mini_batch(X, K, C_for_initial, IDX, C, sumD);
+            return;
+        }
+
         this->replicates_ = C_for_initial.get_size(2);
 
         IDX.resize(N, 0);
@@ -421,8 +453,15 @@ void kmeans<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial
             norm_C[k] = v;
         }
 
+        // distance bounds of every point, for the triangle inequality
+        VectorType upper, lower;
+        ArrayType C_prev;
+
         // first round of clustering
-        this->update_IDX(X, C, norm_C, IDX);
+        if (this->use_triangle_inequality_)
+            this->update_IDX_with_bounds(X, C, C, IDX, upper, lower);
+        else
+            this->update_IDX(X, C, norm_C, IDX);
 
         ClusterType prev_IDX;
         ArrayType D, D_norm;
@@ -435,11 +474,15 @@ void kmeans<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial
         while (num_iter<=this->max_iter_ &&  this->is_clustering_changed(prev_IDX, IDX))
         {
             prev_IDX = IDX;
+            if (this->use_triangle_inequality_) C_prev = C;
 
             // update the centroid
             this->update_centroid(X, IDX, C, norm_C);
             // update clustering
-            this->update_IDX(X, C, norm_C, IDX);
+            if (this->use_triangle_inequality_)
+                this->update_IDX_with_bounds(X, C, C_prev, IDX, upper, lower);
+            else
+                this->update_IDX(X, C, norm_C, IDX);
 
             this->compute_dist(X, IDX, C, D);
             this->compute_norm_dist(D, D_norm);
@@ -473,6 +516,10 @@ void kmeans<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial
                     this->compute_dist(X, IDX, C, D);
                     this->compute_norm_dist(D, D_norm);
                 }
+
+                // the bounds do not hold for the moved points and centroids any more
+                upper.clear();
+                lower.clear();
             }
 
             sumD = 0;
@@ -520,6 +567,102 @@ void kmeans<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial
     }
 }
 
+template <typename T>
+void kmeans<T>::run_mini_batch(const ArrayType& X, size_t K, const ArrayType& C_for_initial, ClusterType& IDX, ArrayType& C, T& sumD)
+{
+    try
+    {
+        size_t P = X.get_size(0);
+        size_t N = X.get_size(1);
+        size_t B = this->mini_batch_size_;
+
+        GADGET_CHECK_THROW(N>K);
+        GADGET_CHECK_THROW(B>0);
+
+        C.create(P, K);
+        memcpy(C.begin(), C_for_initial.begin(), sizeof(T)*P*K);
+
+        const T* pX = X.begin();
+        T* pC = C.begin();
+
+        std::mt19937 gen = this->create_random_generator();
+        std::uniform_int_distribution<size_t> dis(0, N - 1);
+
+        // number of samples every centroid has seen, its learning rate is the inverse
+        std::vector<size_t> num_in_C(K, 0);
+
+        std::vector<size_t> batch(B), batch_IDX(B);
+        VectorType batch_D(B);
+        ArrayType C_prev;
+
+        size_t iter, b, p;
+        for (iter = 0; iter < this->max_iter_; iter++)
+        {
+            for (b = 0; b < B; b++) batch[b] = dis(gen);
+
+            long long bb;
+#pragma omp parallel for
+            for (bb = 0; bb < (long long)B; bb++)
+            {
+                T d_second;
+                batch_IDX[bb] = closest_centroid(pX + batch[bb] * P, pC, P, K, batch_D[bb], d_second);
+            }
+
+            C_prev = C;
+
+            T batch_sumD = 0;
+            for (b = 0; b < B; b++)
+            {
+                size_t k = batch_IDX[b];
+                num_in_C[k]++;
+
+                T eta = (T)1 / (T)num_in_C[k];
+                const T* x = pX + batch[b] * P;
+                for (p = 0; p < P; p++) pC[p + k*P] += eta*(x[p] - pC[p + k*P]);
+
+                batch_sumD += batch_D[b];
+            }
+
+            // stop once the centroids move much less than the typical point to centroid distance
+            T moved = 0;
+            for (size_t i = 0; i < P*K; i++) moved += (pC[i] - C_prev[i])*(pC[i] - C_prev[i]);
+
+            if (moved <= (T)(1e-6) * batch_sumD / B)
+            {
+                if (this->verbose_)
+                {
+                    GDEBUG_STREAM("Mini-batch kmeans converged : iter " << iter);
+                }
+                break;
+            }
+        }
+
+        VectorType norm_C(K, 0);
+        for (size_t k = 0; k < K; k++)
+        {
+            for (p = 0; p < P; p++) norm_C[k] += pC[p + k*P] * pC[p + k*P];
+        }
+
+        this->update_IDX(X, C, norm_C, IDX);
+
+        ArrayType D, D_norm;
+        this->compute_dist(X, IDX, C, D);
+        this->compute_norm_dist(D, D_norm);
+
+        sumD = 0;
+        for (size_t n = 0; n < N; n++) sumD += D_norm(n)*D_norm(n);
+
+        if (this->verbose_)
+        {
+            GDEBUG_STREAM("Mini-batch kmeans : " << sumD);
+        }
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Exceptions happened in kmeans<T>::run_mini_batch(...) ... ");
+    }
+}
+
 template <typename T>
 void kmeans<T>::compute_dist(const ArrayType& X, const ClusterType& IDX, const ArrayType& C, ArrayType& D)
 {
@@ -612,9 +755,11 @@ void kmeans<T>::update_IDX(const ArrayType& X, const ArrayType& C, const VectorT
         ArrayType CX;
         Gadgetron::gemm(CX, C, true, X, false);
 
-        size_t t, s;
+        long long t;
+        size_t s;
 
-        for (t = 0; t < N; t++)
+#pragma omp parallel for private(s)
+        for (t = 0; t < (long long)N; t++)
         {
             for (s = 0; s < K; s++)
             {
@@ -639,6 +784,93 @@ void kmeans<T>::update_IDX(const ArrayType& X, const ArrayType& C, const VectorT
     }
 }
 
+template <typename T>
+void kmeans<T>::update_IDX_with_bounds(const ArrayType& X, const ArrayType& C, const ArrayType& C_prev, ClusterType& IDX, VectorType& upper, VectorType& lower)
+{
+    try
+    {
+        size_t P = X.get_size(0);
+        size_t N = X.get_size(1);
+
+        size_t K = C.get_size(1);
+
+        const T* pX = X.begin();
+        const T* pC = C.begin();
+
+        bool initialize = (upper.size() != N || lower.size() != N || IDX.size() != N);
+        if (initialize)
+        {
+            IDX.resize(N);
+            upper.resize(N);
+            lower.resize(N);
+        }
+
+        // how far every centroid moved, the largest and second largest movement
+        VectorType delta(K, 0);
+        size_t k, j, max_k = 0;
+        T max_delta = 0, second_delta = 0;
+        if (!initialize)
+        {
+            for (k = 0; k < K; k++)
+            {
+                delta[k] = std::sqrt(distance_squared(pC + k*P, C_prev.begin() + k*P, P));
+                if (delta[k] > max_delta)
+                {
+                    second_delta = max_delta;
+                    max_delta = delta[k];
+                    max_k = k;
+                }
+                else if (delta[k] > second_delta)
+                {
+                    second_delta = delta[k];
+                }
+            }
+        }
+
+        // half the distance from every centroid to its closest other centroid
+        // a point closer than that to its own centroid cannot be closer to another one
+        VectorType half_dist(K, std::numeric_limits<T>::max());
+        for (k = 0; k < K; k++)
+        {
+            for (j = k + 1; j < K; j++)
+            {
+                T d = (T)0.5 * std::sqrt(distance_squared(pC + k*P, pC + j*P, P));
+                if (d < half_dist[k]) half_dist[k] = d;
+                if (d < half_dist[j]) half_dist[j] = d;
+            }
+        }
+
+        long long n;
+#pragma omp parallel for
+        for (n = 0; n < (long long)N; n++)
+        {
+            const T* x = pX + n*P;
+
+            if (!initialize)
+            {
+                size_t a = IDX[n];
+                upper[n] += delta[a];
+                lower[n] -= (a == max_k) ? second_delta : max_delta;
+
+                T bound = std::max(half_dist[a], lower[n]);
+                if (upper[n] <= bound) continue;
+
+                upper[n] = std::sqrt(distance_squared(x, pC + a*P, P));
+                if (upper[n] <= bound) continue;
+            }
+
+            T d_closest, d_second;
+            IDX[n] = closest_centroid(x, pC, P, K, d_closest, d_second);
+            upper[n] = std::sqrt(d_closest);
+            lower[n] = std::sqrt(d_second);
+        }
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Exceptions happened in kmeans<T>::update_IDX_with_bounds(...) ... ");
+    }
+}
+
 template <typename T>
 void kmeans<T>::update_centroid(const ArrayType& X, const ClusterType& IDX, ArrayType& C, VectorType& norm_C)
 {
@@ -841,6 +1073,32 @@ void kmeans<T>::perform_online_update(const ArrayType& X, ClusterType& IDX, Arra
             num_pt_clusters[IDX[n]]++;
         }
 
+        // compute change of delta sum cost if a point is assigned to cluster k
+        auto compute_del_cost = [&](size_t k)
+        {
+            long long n;
+#pragma omp parallel for
+            for (n = 0; n < (long long)N; n++)
+            {
+                T v;
+                if (IDX[n] == k)
+                {
+                    if (num_pt_clusters[k] > 1)
+                        v = (T)num_pt_clusters[k] / (T)(num_pt_clusters[k] - 1);
+                    else
+                        v = 1;
+                }
+                else
+                    v = (T)num_pt_clusters[k] / (T)(num_pt_clusters[k] + 1);
+
+                del_cost(n, k) = v * distance_squared(pX + n*P, &C(0, k), P);
+            }
+        };
+
+        // for every cluster K and every point N
+        // a move only changes the costs of its old and new cluster, which are updated after it
+        for (k = 0; k < K; k++) compute_del_cost(k);
+
         size_t iter(0);
 
         size_t lastmoved = 0;
@@ -849,47 +1107,21 @@ void kmeans<T>::perform_online_update(const ArrayType& X, ClusterType& IDX, Arra
 
         while (iter < this->max_iter_)
         {
-            // for every cluster K and every point N
-            // compute change of delta sum cost
-            for (k = 0; k < K; k++)
-            {
-                for (n = 0; n < N; n++)
-                {
-                    T v;
-                    if (IDX[n] == k)
-                    {
-                        if (num_pt_clusters[k] > 1)
-                            v = (T)num_pt_clusters[k] / (T)(num_pt_clusters[k] - 1);
-                        else
-                            v = 1;
-                    }
-                    else
-                        v = (T)num_pt_clusters[k] / (T)(num_pt_clusters[k] + 1);
-
-                    T t(0), d = 0;
-                    for (p = 0; p < P; p++)
-                    {
-                        t = X(p, n) - C(p, k);
-                        d += t*t;
-                    }
-
-                    del_cost(n, k) = v * d;
-                }
-            }
-
             prevIDX = IDX;
 
             // get the new IDX
-            for (n = 0; n < N; n++)
+            long long nn;
+#pragma omp parallel for private(k)
+            for (nn = 0; nn < (long long)N; nn++)
             {
-                newIDX[n] = 0;
-                T min_del_cost = del_cost(n, 0);
+                newIDX[nn] = 0;
+                T min_del_cost = del_cost(nn, 0);
                 for (k = 1; k < K; k++)
                 {
-                    if(del_cost(n, k) < min_del_cost)
+                    if(del_cost(nn, k) < min_del_cost)
                     {
-                        newIDX[n] = k;
-                        min_del_cost = del_cost(n, k);
+                        newIDX[nn] = k;
+                        min_del_cost = del_cost(nn, k);
                     }
                 }
             }
@@ -954,6 +1186,9 @@ void kmeans<T>::perform_online_update(const ArrayType& X, ClusterType& IDX, Arra
                 C(p, nidx) = C(p, nidx) + (X(p, moved_ind) - C(p, nidx)) / num_pt_clusters[nidx];
                 C(p, oidx) = C(p, oidx) - (X(p, moved_ind) - C(p, oidx)) / num_pt_clusters[oidx];
             }
+
+            compute_del_cost(oidx);
+            compute_del_cost(nidx);
         }
     }
     catch (...)
@@ -10,6 +10,8 @@
 #include "ImageIOAnalyze.h"
 #include "hoNDArray.h"
 
+#include <random>
+
 namespace Gadgetron { 
 
 // ======================================================================================
@@ -26,6 +28,15 @@ namespace Gadgetron {
 // then, the resulting centroids are used for whole data kmeans
 // 'kmeans++': perform the kmeans++ method, http://ilpubs.stanford.edu:8090/778/1/2006-13.pdf
 //
+// The kmeans iterations use the triangle inequality to skip most distance computations (Hamerly, SDM 2010): every point keeps an upper bound
+// of the distance to its own centroid and a lower bound of the distance to the second closest one. The clustering is the same as with full
+// distance computation.
+//
+// mini-batch mode: for very large N, every iteration only uses a random batch of samples to update the centroids (Sculley, WWW 2010),
+// followed by one assignment of all samples.
+//
+// With a fixed seed, the initialization and the mini-batch sampling are reproducible, independent of the number of threads.
+//
 // online update: the kmeans can optionally use the so-called "online" update. In this process, every data point is reallocated to all clusters and the
 // delta change of adding or removing this point is computed; those moves which will reduce the total sum cost will be performed.
 //
@@ -65,6 +76,15 @@ public:
     // whether to perform on-line update
     bool perform_online_update_;
 
+    // whether to use the triangle inequality to skip distance computations
+    bool use_triangle_inequality_;
+
+    // if > 0 and < N, perform mini-batch kmeans with batches of this number of samples
+    size_t mini_batch_size_;
+
+    // seed for the random initialization and mini-batch sampling; 0 means a random seed
+    unsigned int seed_;
+
     // ======================================================================================
     /// parameter for debugging
     // ======================================================================================
@@ -98,6 +118,9 @@ public:
     virtual void run_replicates(const ArrayType& X, size_t K, const ArrayType& C_for_initial, ClusterType& IDX, ArrayType& C, VectorType& sumD_rep, T& sumD);
     virtual void run(const ArrayType& X, size_t K, const ArrayType& C_for_initial, ClusterType& IDX, ArrayType& C, T& sumD);
 
+    /// mini-batch kmeans, called by run if mini_batch_size_ is set
+    virtual void run_mini_batch(const ArrayType& X, size_t K, const ArrayType& C_for_initial, ClusterType& IDX, ArrayType& C, T& sumD);
+
     /// compute distance vector
     /// D: [P N] distance from a point to its closest centroid
     void compute_dist(const ArrayType& X, const ClusterType& IDX, const ArrayType& C, ArrayType& D);
@@ -109,6 +132,10 @@ public:
     /// norm_C is the norm of centroid, dot(C,C,1)
     void update_IDX(const ArrayType& X, const ArrayType& C, const VectorType& norm_C, ClusterType& IDX);
 
+    /// given the current centroids, update the IDX using and updating the distance bounds of every point
+    /// C_prev are the centroids the bounds refer to; if upper and lower are empty, all distances are computed to initialize them
+    void update_IDX_with_bounds(const ArrayType& X, const ArrayType& C, const ArrayType& C_prev, ClusterType& IDX, VectorType& upper, VectorType& lower);
+
     /// update centroids, given the IDX
     void update_centroid(const ArrayType& X, const ClusterType& IDX, ArrayType& C, VectorType& norm_C);
 
@@ -127,6 +154,11 @@ public:
     /// On return, IDX and C may be updated
     /// max_iter_ is used for online update
     void perform_online_update(const ArrayType& X, ClusterType& IDX, ArrayType& C, T& sumD);
+
+protected:
+
+    /// random generator for initialization and mini-batch sampling, seeded with seed_
+    std::mt19937 create_random_generator() const;
 };
 
 }
@@ -6,11 +6,15 @@
 #if (NPY_API_VERSION <= 6) && !defined(NPY_ARRAY_IN_FARRAY)
   // work-around for NumPy 1.6 (or earlier?)
   #define NPY_ARRAY_IN_FARRAY NPY_IN_FARRAY
+  #define NPY_ARRAY_FARRAY NPY_FARRAY
 #endif
 
 #include "hoNDArray.h"
 #include "log.h"
 
+#include <memory>
+#include <type_traits>
+
 #include <boost/python.hpp>
 namespace bp = boost::python;
 
@@ -230,6 +234,140 @@ struct hoNDArray_from_numpy_array<ISMRMRD::ImageHeader>
     }
 };
 
+// ===========================================================================================================
+// Conversion of shared hoNDArrays
+//
+// From Python, an aligned, writeable, Fortran contiguous NumPy array of the matching dtype is adopted as it is: the
+// hoNDArray does not own the memory and the shared pointer holds a reference to the NumPy array instead. Arrays of
+// any other layout are copied once into Fortran order.
+// To Python, an hoNDArray adopted that way is handed back as the NumPy array it wraps, so a round trip through C++
+// copies nothing. Any other hoNDArray is handed over as a Fortran ordered NumPy view of its memory. The view holds a
+// copy of the shared pointer, so the array lives as long as the view does. The view is of the memory, not of the
+// array: while Python holds it, C++ must not create() or assign to the array, which frees that memory.
+
+template <typename T>
+struct is_numpy_view_type : std::integral_constant<bool, std::is_arithmetic<T>::value
+    || std::is_same<T, std::complex<float> >::value || std::is_same<T, std::complex<double> >::value> {};
+
+// -------------------------------------------------------------------------------
+/// Deleter of an hoNDArray borrowing the memory of a NumPy array
+struct numpy_array_release {
+    PyObject* obj;
+
+    template <typename T> void operator()(hoNDArray<T>* arr) const {
+        delete arr;
+        GILLock lg;
+        Py_DECREF(obj);
+    }
+};
+
+// -------------------------------------------------------------------------------
+/// Releases the shared hoNDArray held by a view when NumPy frees the view
+template <typename T>
+void release_hoNDArray_capsule(PyObject* capsule)
+{
+    delete static_cast<std::shared_ptr<hoNDArray<T> >*>(PyCapsule_GetPointer(capsule, "gadgetron.hoNDArray"));
+}
+
+// -------------------------------------------------------------------------------
+/// Used for making a NumPy array from a shared hoNDArray
+template <typename T>
+struct shared_hoNDArray_to_numpy_array {
+    static_assert(is_numpy_view_type<T>::value, "shared_hoNDArray_to_numpy_array: only numeric arrays can be shared with NumPy");
+
+    static PyObject* convert(const std::shared_ptr<hoNDArray<T> >& arr) {
+        if (!arr || arr->get_number_of_elements() == 0) {
+            return hoNDArray_to_numpy_array<T>::convert(arr ? *arr : hoNDArray<T>());
+        }
+
+        // still the memory and shape of the NumPy array it was made from
+        auto release = std::get_deleter<numpy_array_release>(arr);
+        if (release && arr->get_data_ptr() == NumPyArray_DATA(release->obj)
+                && static_cast<size_t>(NumPyArray_NDIM(release->obj)) == arr->get_number_of_dimensions()) {
+            bool same_shape = true;
+            for (size_t i = 0; i < arr->get_number_of_dimensions(); i++) {
+                same_shape = same_shape && static_cast<size_t>(NumPyArray_DIM(release->obj, i)) == arr->get_size(i);
+            }
+            if (same_shape) {
+                Py_INCREF(release->obj);
+                return release->obj;
+            }
+        }
+
+        size_t ndim = arr->get_number_of_dimensions();
+        std::vector<npy_intp> dims2(ndim), strides(ndim);
+        npy_intp stride = sizeof(T);
+        for (size_t i = 0; i < ndim; i++) {
+            dims2[i] = static_cast<npy_intp>(arr->get_size(i));
+            strides[i] = stride;
+            stride *= dims2[i];
+        }
+
+        PyObject* owner = PyCapsule_New(new std::shared_ptr<hoNDArray<T> >(arr), "gadgetron.hoNDArray", &release_hoNDArray_capsule<T>);
+        if (owner == NULL) {
+            bp::throw_error_already_set();
+        }
+
+        PyObject* obj = NumPyArray_NewFromData(dims2.size(), dims2.data(), get_numpy_type<T>(), strides.data(),
+                arr->get_data_ptr(), NPY_ARRAY_FARRAY, owner);
+        if (obj == NULL) {
+            bp::throw_error_already_set();
+        }
+
+        return obj;
+    }
+};
+
+// -------------------------------------------------------------------------------
+/// Used for making a shared hoNDArray from a NumPy array
+template <typename T>
+struct shared_hoNDArray_from_numpy_array {
+    shared_hoNDArray_from_numpy_array() {
+        // actually register this converter with Boost
+        bp::converter::registry::push_back(
+                &convertible,
+                &construct,
+                bp::type_id<std::shared_ptr<hoNDArray<T> > >());
+    }
+
+    /// Returns NULL if obj is not a NumPy array of the dtype of T, the memory is used as T without conversion
+    static void* convertible(PyObject* obj) {
+        if (!NumPyArray_IsType(obj, get_numpy_type<T>())) {
+            return NULL;
+        }
+        return hoNDArray_from_numpy_array<T>::convertible(obj);
+    }
+
+    /// Construct the shared hoNDArray in-place
+    static void construct(PyObject* obj_orig, bp::converter::rvalue_from_python_stage1_data* data) {
+        void* storage = ((bp::converter::rvalue_from_python_storage<std::shared_ptr<hoNDArray<T> > >*)data)->storage.bytes;
+
+        // no copy if obj_orig is already an aligned, writeable, Fortran contiguous array
+        PyObject* obj = NumPyArray_FromAny(obj_orig, nullptr, 1, 36, NPY_ARRAY_FARRAY, nullptr);
+        if (obj == NULL) {
+            bp::throw_error_already_set();
+        }
+
+        size_t ndim = NumPyArray_NDIM(obj);
+        std::vector<size_t> dims(ndim);
+        for (size_t i = 0; i < ndim; i++) {
+            dims[i] = NumPyArray_DIM(obj, i);
+        }
+
+        hoNDArray<T>* arr = nullptr;
+        try {
+            arr = new hoNDArray<T>(dims, static_cast<T*>(NumPyArray_DATA(obj)), false);
+        } catch (...) {
+            bp::decref(obj);
+            throw;
+        }
+
+        // Placement-new of the shared pointer in memory provided by Boost; it now owns the reference to obj
+        new (storage) std::shared_ptr<hoNDArray<T> >(arr, numpy_array_release{ obj });
+        data->convertible = storage;
+    }
+};
+
 // --------------------------------------------------------------------------------
 /// Create and register hoNDArray converter as necessary
 template <typename T> void create_hoNDArray_converter() {
@@ -254,6 +392,29 @@ struct python_converter<hoNDArray<T> > {
     }
 };
 
+/// Create and register shared hoNDArray converter as necessary
+template <typename T> void create_shared_hoNDArray_converter() {
+    bp::type_info info = bp::type_id<std::shared_ptr<hoNDArray<T> > >();
+    const bp::converter::registration* reg = bp::converter::registry::query(info);
+    // only register if not already registered!
+    if (nullptr == reg || nullptr == (*reg).m_to_python) {
+        bp::to_python_converter<std::shared_ptr<hoNDArray<T> >, shared_hoNDArray_to_numpy_array<T> >();
+        shared_hoNDArray_from_numpy_array<T>();
+    }
+}
+
+/// Partial specialization of `python_converter` for shared hoNDArray
+template <typename T>
+struct python_converter<std::shared_ptr<hoNDArray<T> > > {
+    static void create()
+    {
+        // ensure NumPy C-API is initialized
+        initialize_numpy();
+        // register shared hoNDArray converter
+        create_shared_hoNDArray_converter<T>();
+    }
+};
+
 }
 
 #endif // GADGETRON_PYTHON_HONDARRAY_CONVERTER_H
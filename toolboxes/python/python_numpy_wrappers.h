@@ -20,6 +20,10 @@ EXPORTPYTHON npy_intp NumPyArray_SIZE(PyObject* obj);
 EXPORTPYTHON PyObject *NumPyArray_SimpleNew(int nd, npy_intp* dims, int typenum);
 EXPORTPYTHON PyObject *NumPyArray_EMPTY(int nd, npy_intp* dims, int typenum, int fortran);
 EXPORTPYTHON PyObject* NumPyArray_FromAny(PyObject* op, PyArray_Descr* dtype, int min_depth, int max_depth, int requirements, PyObject* context);
+/// Create an array over existing memory; the array keeps base alive (the reference to base is stolen)
+EXPORTPYTHON PyObject *NumPyArray_NewFromData(int nd, npy_intp* dims, int typenum, npy_intp* strides, void* data, int flags, PyObject* base);
+/// true if obj is a NumPy array whose dtype is equivalent to typenum
+EXPORTPYTHON bool NumPyArray_IsType(PyObject* obj, int typenum);
 /// return the enumerated numpy type for a given C++ type
 template <typename T> int get_numpy_type() { return NPY_VOID; }
 template <> inline int get_numpy_type< bool >() { return NPY_BOOL; }
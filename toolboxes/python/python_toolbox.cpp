@@ -88,6 +88,8 @@ std::string pyerr_to_string(void)
     PyObject *exc, *val, *tb;
     bp::object formatted_list, formatted;
     PyErr_Fetch(&exc, &val, &tb);
+    // errors set from C++, e.g. by a failed conversion, hold a bare message that traceback cannot format
+    PyErr_NormalizeException(&exc, &val, &tb);
     // wrap exception, value, traceback with bp::handle for auto memory management
     bp::handle<> hexc(exc), hval(bp::allow_null(val)), htb(bp::allow_null(tb));
     // import "traceback" module
@@ -153,6 +155,30 @@ PyObject* NumPyArray_EMPTY(int nd, npy_intp* dims, int typenum, int fortran)
     return PyArray_EMPTY(nd, dims, typenum,fortran);
 }
 
+/// Wraps PyArray_New and PyArray_SetBaseObject
+PyObject* NumPyArray_NewFromData(int nd, npy_intp* dims, int typenum, npy_intp* strides, void* data, int flags, PyObject* base)
+{
+    PyObject* obj = PyArray_New(&PyArray_Type, nd, dims, typenum, strides, data, 0, flags, NULL);
+    if (obj == NULL) {
+        Py_XDECREF(base);
+        return NULL;
+    }
+
+    // steals the reference to base, also on failure
+    if (PyArray_SetBaseObject((PyArrayObject*)obj, base) < 0) {
+        Py_DECREF(obj);
+        return NULL;
+    }
+
+    return obj;
+}
+
+/// Wraps PyArray_Check and PyArray_EquivTypenums
+bool NumPyArray_IsType(PyObject* obj, int typenum)
+{
+    return PyArray_Check(obj) && PyArray_EquivTypenums(PyArray_TYPE((PyArrayObject*)obj), typenum);
+}
+
 }
 
 bool boost::python::hasattr(object o, const char* name) {
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <sstream>
+#include <memory>
 #include "hoNDArray.h"
 #include "hoNDImage.h"
 #include "hoMRImage.h"
@@ -18,6 +19,7 @@
 #include "hoNDArray_utils.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDImage_util.h"
+#include "OmpExceptions.h"
 
 // transformation
 #include "hoImageRegTransformation.h"
@@ -434,8 +436,24 @@ namespace Gadgetron {
 
     protected:
 
+        typedef hoImageRegDeformationFieldRegister<TargetType, CoordType> DeformationFieldRegisterType;
+        typedef hoImageRegDeformationFieldBidirectionalRegister<TargetType, CoordType> DeformationFieldBidirectionalRegisterType;
+
         bool initialize(const TargetContinerType& targetContainer, bool warped);
 
+        /// create a register with the container parameters
+        /// every thread of the container registration keeps one register and reuses it for all its frames,
+        /// so the image pyramids and solver buffers are allocated once per thread and not once per frame
+        DeformationFieldRegisterType* createDeformationFieldRegister();
+        DeformationFieldBidirectionalRegisterType* createDeformationFieldBidirectionalRegister();
+
+        /// register two images with a register created by the functions above
+        bool registerTwoImagesDeformationField(DeformationFieldRegisterType& reg, const TargetType& target, const SourceType& source, bool initial, TargetType* warped, DeformationFieldType** deform);
+        bool registerTwoImagesDeformationFieldBidirectional(DeformationFieldBidirectionalRegisterType& reg, const TargetType& target, const SourceType& source, bool initial, TargetType* warped, DeformationFieldType** deform, DeformationFieldType** deformInv);
+
+        /// number of threads to register numOfTasks independent images, bounded by the cores and omp_get_max_threads()
+        /// the parallel regions inside the solvers and warpers carry if(!omp_in_parallel()), so they run serially in every thread and do not oversubscribe the cores
+        int numOfContainerThreads(long long numOfTasks) const;
     };
 
     template<typename TargetType, typename SourceType, typename CoordType> 
@@ -551,36 +569,95 @@ namespace Gadgetron {
     }
 
     template<typename TargetType, typename SourceType, typename CoordType> 
-    bool hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
-    registerTwoImagesDeformationField(const TargetType& target, const SourceType& source, bool initial, TargetType* warped, DeformationFieldType** deform)
+    typename hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::DeformationFieldRegisterType* hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
+    createDeformationFieldRegister()
     {
-        try
+        DeformationFieldRegisterType* reg = new DeformationFieldRegisterType(resolution_pyramid_levels_, use_world_coordinates_, bg_value_);
+
+        if ( !debugFolder_.empty() )
         {
-            GADGET_CHECK_RETURN_FALSE(deform!=NULL);
+            reg->debugFolder_ = debugFolder_;
+        }
 
-            hoImageRegDeformationFieldRegister<TargetType, CoordType> reg(resolution_pyramid_levels_, use_world_coordinates_, bg_value_);
+        GADGET_CHECK_THROW(reg->setDefaultParameters(resolution_pyramid_levels_, use_world_coordinates_));
 
-            if ( !debugFolder_.empty() )
-            {
-                reg.debugFolder_ = debugFolder_;
-            }
+        reg->max_iter_num_pyramid_level_ = max_iter_num_pyramid_level_;
+        reg->div_num_pyramid_level_ = div_num_pyramid_level_;
+        reg->dissimilarity_MI_betaArg_ = dissimilarity_MI_betaArg_;
+        reg->regularization_hilbert_strength_world_coordinate_ = regularization_hilbert_strength_world_coordinate_;
+        reg->regularization_hilbert_strength_pyramid_level_ = regularization_hilbert_strength_pyramid_level_;
+        reg->dissimilarity_LocalCCR_sigmaArg_ = dissimilarity_LocalCCR_sigmaArg_;
+        reg->boundary_handler_type_warper_ = boundary_handler_type_warper_;
+        reg->interp_type_warper_ = interp_type_warper_;
+        reg->apply_in_FOV_constraint_ = apply_in_FOV_constraint_;
+        reg->apply_divergence_free_constraint_ = apply_divergence_free_constraint_;
+        reg->verbose_ = verbose_;
 
-            GADGET_CHECK_RETURN_FALSE(reg.setDefaultParameters(resolution_pyramid_levels_, use_world_coordinates_));
+        reg->dissimilarity_type_.clear();
+        reg->dissimilarity_type_.resize(resolution_pyramid_levels_, dissimilarity_type_);
 
-            reg.max_iter_num_pyramid_level_ = max_iter_num_pyramid_level_;
-            reg.div_num_pyramid_level_ = div_num_pyramid_level_;
-            reg.dissimilarity_MI_betaArg_ = dissimilarity_MI_betaArg_;
-            reg.regularization_hilbert_strength_world_coordinate_ = regularization_hilbert_strength_world_coordinate_;
-            reg.regularization_hilbert_strength_pyramid_level_ = regularization_hilbert_strength_pyramid_level_;
-            reg.dissimilarity_LocalCCR_sigmaArg_ = dissimilarity_LocalCCR_sigmaArg_;
-            reg.boundary_handler_type_warper_ = boundary_handler_type_warper_;
-            reg.interp_type_warper_ = interp_type_warper_;
-            reg.apply_in_FOV_constraint_ = apply_in_FOV_constraint_;
-            reg.apply_divergence_free_constraint_ = apply_divergence_free_constraint_;
-            reg.verbose_ = verbose_;
+        return reg;
+    }
 
-            reg.dissimilarity_type_.clear();
-            reg.dissimilarity_type_.resize(resolution_pyramid_levels_, dissimilarity_type_);
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    typename hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::DeformationFieldBidirectionalRegisterType* hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
+    createDeformationFieldBidirectionalRegister()
+    {
+        DeformationFieldBidirectionalRegisterType* reg = new DeformationFieldBidirectionalRegisterType(resolution_pyramid_levels_, use_world_coordinates_, bg_value_);
+
+        if ( !debugFolder_.empty() )
+        {
+            reg->debugFolder_ = debugFolder_;
+        }
+
+        GADGET_CHECK_THROW(reg->setDefaultParameters(resolution_pyramid_levels_, use_world_coordinates_));
+
+        reg->max_iter_num_pyramid_level_ = max_iter_num_pyramid_level_;
+        reg->div_num_pyramid_level_ = div_num_pyramid_level_;
+        reg->dissimilarity_MI_betaArg_ = dissimilarity_MI_betaArg_;
+        reg->regularization_hilbert_strength_world_coordinate_ = regularization_hilbert_strength_world_coordinate_;
+        reg->regularization_hilbert_strength_pyramid_level_ = regularization_hilbert_strength_pyramid_level_;
+        reg->dissimilarity_LocalCCR_sigmaArg_ = dissimilarity_LocalCCR_sigmaArg_;
+        reg->boundary_handler_type_warper_ = boundary_handler_type_warper_;
+        reg->interp_type_warper_ = interp_type_warper_;
+        reg->inverse_deform_enforce_iter_pyramid_level_ = inverse_deform_enforce_iter_pyramid_level_;
+        reg->inverse_deform_enforce_weight_pyramid_level_ = inverse_deform_enforce_weight_pyramid_level_;
+        reg->apply_in_FOV_constraint_ = apply_in_FOV_constraint_;
+        reg->apply_divergence_free_constraint_ = apply_divergence_free_constraint_;
+
+        reg->verbose_ = verbose_;
+
+        reg->dissimilarity_type_.clear();
+        reg->dissimilarity_type_.resize(resolution_pyramid_levels_, dissimilarity_type_);
+
+        return reg;
+    }
+
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    bool hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
+    registerTwoImagesDeformationField(const TargetType& target, const SourceType& source, bool initial, TargetType* warped, DeformationFieldType** deform)
+    {
+        try
+        {
+            std::unique_ptr<DeformationFieldRegisterType> reg(this->createDeformationFieldRegister());
+            GADGET_CHECK_RETURN_FALSE(this->registerTwoImagesDeformationField(*reg, target, source, initial, warped, deform));
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::registerTwoImagesDeformationField(...) ... ");
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    bool hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
+    registerTwoImagesDeformationField(DeformationFieldRegisterType& reg, const TargetType& target, const SourceType& source, bool initial, TargetType* warped, DeformationFieldType** deform)
+    {
+        try
+        {
+            GADGET_CHECK_RETURN_FALSE(deform!=NULL);
 
             reg.setTarget( const_cast<TargetType&>(target) );
             reg.setSource( const_cast<TargetType&>(source) );
@@ -596,6 +673,12 @@ namespace Gadgetron {
 
             unsigned int d;
 
+            // a reused register still holds the deformation of its previous frame
+            if ( reg.transform_->getDeformationField(0).dimensions_equal(target) )
+            {
+                GADGET_CHECK_RETURN_FALSE(reg.transform_->setIdentity());
+            }
+
             if ( target.dimensions_equal( *(deform[0]) ) )
             {
                 if ( initial )
@@ -642,7 +725,7 @@ namespace Gadgetron {
         }
         catch(...)
         {
-            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::registerTwoImagesDeformationField(...) ... ");
+            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::registerTwoImagesDeformationField(reg, ...) ... ");
             return false;
         }
 
@@ -655,35 +738,26 @@ namespace Gadgetron {
     {
         try
         {
-            GADGET_CHECK_RETURN_FALSE(deform!=NULL);
-            GADGET_CHECK_RETURN_FALSE(deformInv!=NULL);
-
-            hoImageRegDeformationFieldBidirectionalRegister<TargetType, CoordType> reg(resolution_pyramid_levels_, use_world_coordinates_, bg_value_);
-
-            if ( !debugFolder_.empty() )
-            {
-                reg.debugFolder_ = debugFolder_;
-            }
-
-            GADGET_CHECK_RETURN_FALSE(reg.setDefaultParameters(resolution_pyramid_levels_, use_world_coordinates_));
-
-            reg.max_iter_num_pyramid_level_ = max_iter_num_pyramid_level_;
-            reg.div_num_pyramid_level_ = div_num_pyramid_level_;
-            reg.dissimilarity_MI_betaArg_ = dissimilarity_MI_betaArg_;
-            reg.regularization_hilbert_strength_world_coordinate_ = regularization_hilbert_strength_world_coordinate_;
-            reg.regularization_hilbert_strength_pyramid_level_ = regularization_hilbert_strength_pyramid_level_;
-            reg.dissimilarity_LocalCCR_sigmaArg_ = dissimilarity_LocalCCR_sigmaArg_;
-            reg.boundary_handler_type_warper_ = boundary_handler_type_warper_;
-            reg.interp_type_warper_ = interp_type_warper_;
-            reg.inverse_deform_enforce_iter_pyramid_level_ = inverse_deform_enforce_iter_pyramid_level_;
-            reg.inverse_deform_enforce_weight_pyramid_level_ = inverse_deform_enforce_weight_pyramid_level_;
-            reg.apply_in_FOV_constraint_ = apply_in_FOV_constraint_;
-            reg.apply_divergence_free_constraint_ = apply_divergence_free_constraint_;
+            std::unique_ptr<DeformationFieldBidirectionalRegisterType> reg(this->createDeformationFieldBidirectionalRegister());
+            GADGET_CHECK_RETURN_FALSE(this->registerTwoImagesDeformationFieldBidirectional(*reg, target, source, initial, warped, deform, deformInv));
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::registerTwoImagesDeformationFieldBidirectional(...) ... ");
+            return false;
+        }
 
-            reg.verbose_ = verbose_;
+        return true;
+    }
 
-            reg.dissimilarity_type_.clear();
-            reg.dissimilarity_type_.resize(resolution_pyramid_levels_, dissimilarity_type_);
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    bool hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
+    registerTwoImagesDeformationFieldBidirectional(DeformationFieldBidirectionalRegisterType& reg, const TargetType& target, const SourceType& source, bool initial, TargetType* warped, DeformationFieldType** deform, DeformationFieldType** deformInv)
+    {
+        try
+        {
+            GADGET_CHECK_RETURN_FALSE(deform!=NULL);
+            GADGET_CHECK_RETURN_FALSE(deformInv!=NULL);
 
             reg.setTarget( const_cast<TargetType&>(target) );
             reg.setSource( const_cast<SourceType&>(source) );
@@ -697,6 +771,13 @@ namespace Gadgetron {
 
             unsigned int d;
 
+            // a reused register still holds the deformations of its previous frame
+            if ( reg.transform_->getDeformationField(0).dimensions_equal(target) )
+            {
+                GADGET_CHECK_RETURN_FALSE(reg.transform_->setIdentity());
+                GADGET_CHECK_RETURN_FALSE(reg.transform_inverse_->setIdentity());
+            }
+
             if ( target.dimensions_equal( *(deform[0]) ) )
             {
                 if ( initial )
@@ -748,13 +829,27 @@ namespace Gadgetron {
         }
         catch(...)
         {
-            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::registerTwoImagesDeformationFieldBidirectional(...) ... ");
+            GERROR_STREAM("Error happened in hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::registerTwoImagesDeformationFieldBidirectional(reg, ...) ... ");
             return false;
         }
 
         return true;
     }
 
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    int hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::numOfContainerThreads(long long numOfTasks) const
+    {
+        int numOfThreads = 1;
+
+#ifdef USE_OMP
+        int numOfProcs = std::min(omp_get_num_procs(), omp_get_max_threads());
+        numOfThreads = (numOfTasks>numOfProcs) ? numOfProcs : (int)numOfTasks;
+        if ( numOfThreads < 1 ) numOfThreads = 1;
+#endif // USE_OMP
+
+        return numOfThreads;
+    }
+
     template<typename TargetType, typename SourceType, typename CoordType> 
     bool hoImageRegContainer2DRegistration<TargetType, SourceType, CoordType>::
     initialize(const TargetContinerType& targetContainer, bool warped)
@@ -828,27 +923,8 @@ namespace Gadgetron {
                 warped_container_.get_all_images(warpedImages);
             }
 
-            GDEBUG_STREAM("registerOverContainer2DPairWise - threading ... ");
-
-            int numOfThreads = 1;
-
-#ifdef USE_OMP
-            int numOfProcs = omp_get_num_procs();
-            int nested = omp_get_nested();
-            GDEBUG_STREAM("registerOverContainer2DPairWise - nested openMP is " << nested);
-            /*if (numOfImages < numOfProcs - 1)
-            {
-                omp_set_nested(1);
-                GDEBUG_STREAM("registerOverContainer2DPairWise - nested openMP on ... ");
-            }
-            else
-            {
-                omp_set_nested(0);
-                GDEBUG_STREAM("registerOverContainer2DPairWise - nested openMP off ... ");
-            }*/
-
-            numOfThreads = (numOfImages>numOfProcs) ? numOfProcs : numOfImages;
-#endif // USE_OMP
+            int numOfThreads = this->numOfContainerThreads(numOfImages);
+            GDEBUG_STREAM("registerOverContainer2DPairWise - number of threads : " << numOfThreads);
 
             unsigned int ii;
             long long n;
@@ -862,35 +938,42 @@ namespace Gadgetron {
                     deformation_field_[ii].get_all_images(deform[ii]);
                 }
 
-                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, warpedImages) num_threads(numOfThreads)
+                OmpExceptions errors;
+                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, warpedImages, errors) num_threads(numOfThreads)
                 {
                     DeformationFieldType* deformCurr[DIn];
+                    std::unique_ptr<DeformationFieldRegisterType> reg;
+                    errors.run([&]() { reg.reset(this->createDeformationFieldRegister()); });
 
-                    #pragma omp for 
+                    #pragma omp for schedule(dynamic)
                     for ( n=0; n<numOfImages; n++ )
                     {
-                        TargetType& target = *(targetImages[n]);
-                        SourceType& source = *(sourceImages[n]);
-
-                        if ( &target == &source )
+                        errors.run([&]()
                         {
-                            for ( ii=0; ii<DIn; ii++ )
+                            TargetType& target = *(targetImages[n]);
+                            SourceType& source = *(sourceImages[n]);
+
+                            if ( &target == &source )
                             {
-                                deform[ii][n]->create(target.get_dimensions());
-                                Gadgetron::clear( *deform[ii][n] );
+                                for ( ii=0; ii<DIn; ii++ )
+                                {
+                                    deform[ii][n]->create(target.get_dimensions());
+                                    Gadgetron::clear( *deform[ii][n] );
+                                }
                             }
-                        }
-                        else
-                        {
-                            for ( ii=0; ii<DIn; ii++ )
+                            else
                             {
-                                deformCurr[ii] = deform[ii][n];
-                            }
+                                for ( ii=0; ii<DIn; ii++ )
+                                {
+                                    deformCurr[ii] = deform[ii][n];
+                                }
 
-                            registerTwoImagesDeformationField(target, source, initial, warpedImages[n], deformCurr);
-                        }
+                                registerTwoImagesDeformationField(*reg, target, source, initial, warpedImages[n], deformCurr);
+                            }
+                        });
                     }
                 }
+                errors.rethrow();
             }
             else if ( container_reg_transformation_ == GT_IMAGE_REG_TRANSFORMATION_DEFORMATION_FIELD_BIDIRECTIONAL )
             {
@@ -903,50 +986,53 @@ namespace Gadgetron {
                     deformation_field_inverse_[ii].get_all_images(deformInv[ii]);
                 }
 
-                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, deformInv, warpedImages) num_threads(numOfThreads)
+                OmpExceptions errors;
+                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, deformInv, warpedImages, errors) num_threads(numOfThreads)
                 {
                     DeformationFieldType* deformCurr[DIn];
                     DeformationFieldType* deformInvCurr[DIn];
+                    std::unique_ptr<DeformationFieldBidirectionalRegisterType> reg;
+                    errors.run([&]() { reg.reset(this->createDeformationFieldBidirectionalRegister()); });
 
-                    #pragma omp for 
+                    #pragma omp for schedule(dynamic)
                     for ( n=0; n<numOfImages; n++ )
                     {
-                        TargetType& target = *(targetImages[n]);
-                        SourceType& source = *(sourceImages[n]);
-
-                        if ( &target == &source )
+                        errors.run([&]()
                         {
-                            for ( ii=0; ii<DIn; ii++ )
+                            TargetType& target = *(targetImages[n]);
+                            SourceType& source = *(sourceImages[n]);
+
+                            if ( &target == &source )
                             {
-                                deform[ii][n]->create(target.get_dimensions());
-                                Gadgetron::clear( *deform[ii][n] );
+                                for ( ii=0; ii<DIn; ii++ )
+                                {
+                                    deform[ii][n]->create(target.get_dimensions());
+                                    Gadgetron::clear( *deform[ii][n] );
 
-                                deformInv[ii][n]->create(source.get_dimensions());
-                                Gadgetron::clear( *deformInv[ii][n] );
+                                    deformInv[ii][n]->create(source.get_dimensions());
+                                    Gadgetron::clear( *deformInv[ii][n] );
+                                }
                             }
-                        }
-                        else
-                        {
-                            for ( ii=0; ii<DIn; ii++ )
+                            else
                             {
-                                deformCurr[ii] = deform[ii][n];
-                                deformInvCurr[ii] = deformInv[ii][n];
-                            }
+                                for ( ii=0; ii<DIn; ii++ )
+                                {
+                                    deformCurr[ii] = deform[ii][n];
+                                    deformInvCurr[ii] = deformInv[ii][n];
+                                }
 
-                            registerTwoImagesDeformationFieldBidirectional(target, source, initial, warpedImages[n], deformCurr, deformInvCurr);
-                        }
+                                registerTwoImagesDeformationFieldBidirectional(*reg, target, source, initial, warpedImages[n], deformCurr, deformInvCurr);
+                            }
+                        });
                     }
                 }
+                errors.rethrow();
             }
             else if ( container_reg_transformation_==GT_IMAGE_REG_TRANSFORMATION_RIGID 
                         || container_reg_transformation_==GT_IMAGE_REG_TRANSFORMATION_AFFINE )
             {
                 GDEBUG_STREAM("To be implemented ...");
             }
-
-//#ifdef USE_OMP
-//            omp_set_nested(nested);
-//#endif // USE_OMP
         }
         catch(...)
         {
@@ -1003,25 +1089,8 @@ namespace Gadgetron {
 
             GADGET_CHECK_RETURN_FALSE(numOfImages==targetImages.size());
 
-            int numOfThreads = 1;
-
-#ifdef USE_OMP
-            int numOfProcs = omp_get_num_procs();
-            int nested = omp_get_nested();
-            GDEBUG_STREAM("registerOverContainer2DFixedReference - nested openMP is " << nested);
-            //if (numOfImages < numOfProcs - 1)
-            //{
-            //    omp_set_nested(1);
-            //    GDEBUG_STREAM("registerOverContainer2DFixedReference - nested openMP on ... ");
-            //}
-            //else
-            //{
-            //    omp_set_nested(0);
-            //    GDEBUG_STREAM("registerOverContainer2DFixedReference - nested openMP off ... ");
-            //}
-
-            numOfThreads = (numOfImages>numOfProcs) ? numOfProcs : numOfImages;
-#endif // USE_OMP
+            int numOfThreads = this->numOfContainerThreads(numOfImages);
+            GDEBUG_STREAM("registerOverContainer2DFixedReference - number of threads : " << numOfThreads);
 
             if ( container_reg_transformation_ == GT_IMAGE_REG_TRANSFORMATION_DEFORMATION_FIELD )
             {
@@ -1032,40 +1101,47 @@ namespace Gadgetron {
                     deformation_field_[ii].get_all_images(deform[ii]);
                 }
 
-                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, warpedImages) num_threads(numOfThreads)
+                OmpExceptions errors;
+                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, warpedImages, errors) num_threads(numOfThreads)
                 {
                     DeformationFieldType* deformCurr[DIn];
+                    std::unique_ptr<DeformationFieldRegisterType> reg;
+                    errors.run([&]() { reg.reset(this->createDeformationFieldRegister()); });
 
-                    #pragma omp for 
+                    #pragma omp for schedule(dynamic)
                     for ( n=0; n<numOfImages; n++ )
                     {
-                        if ( targetImages[n] == sourceImages[n] )
+                        errors.run([&]()
                         {
-                            if ( warpedImages[n] != NULL )
+                            if ( targetImages[n] == sourceImages[n] )
                             {
-                                *(warpedImages[n]) = *(targetImages[n]);
+                                if ( warpedImages[n] != NULL )
+                                {
+                                    *(warpedImages[n]) = *(targetImages[n]);
+                                }
+
+                                for ( ii=0; ii<DIn; ii++ )
+                                {
+                                    deform[ii][n]->create(targetImages[n]->get_dimensions());
+                                    Gadgetron::clear(*deform[ii][n]);
+                                }
+
+                                return;
                             }
 
+                            TargetType& target = *(targetImages[n]);
+                            SourceType& source = *(sourceImages[n]);
+
                             for ( ii=0; ii<DIn; ii++ )
                             {
-                                deform[ii][n]->create(targetImages[n]->get_dimensions());
-                                Gadgetron::clear(*deform[ii][n]);
+                                deformCurr[ii] = deform[ii][n];
                             }
 
-                            continue;
-                        }
-
-                        TargetType& target = *(targetImages[n]);
-                        SourceType& source = *(sourceImages[n]);
-
-                        for ( ii=0; ii<DIn; ii++ )
-                        {
-                            deformCurr[ii] = deform[ii][n];
-                        }
-
-                        registerTwoImagesDeformationField(target, source, initial, warpedImages[n], deformCurr);
+                            registerTwoImagesDeformationField(*reg, target, source, initial, warpedImages[n], deformCurr);
+                        });
                     }
                 }
+                errors.rethrow();
             }
             else if ( container_reg_transformation_ == GT_IMAGE_REG_TRANSFORMATION_DEFORMATION_FIELD_BIDIRECTIONAL )
             {
@@ -1078,55 +1154,58 @@ namespace Gadgetron {
                     deformation_field_inverse_[ii].get_all_images(deformInv[ii]);
                 }
 
-                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, deformInv, warpedImages) num_threads(numOfThreads)
+                OmpExceptions errors;
+                #pragma omp parallel default(none) private(n, ii) shared(numOfImages, initial, targetImages, sourceImages, deform, deformInv, warpedImages, errors) num_threads(numOfThreads)
                 {
                     DeformationFieldType* deformCurr[DIn];
                     DeformationFieldType* deformInvCurr[DIn];
+                    std::unique_ptr<DeformationFieldBidirectionalRegisterType> reg;
+                    errors.run([&]() { reg.reset(this->createDeformationFieldBidirectionalRegister()); });
 
-                    #pragma omp for 
+                    #pragma omp for schedule(dynamic)
                     for ( n=0; n<numOfImages; n++ )
                     {
-                        if ( targetImages[n] == sourceImages[n] )
+                        errors.run([&]()
                         {
-                            if ( warpedImages[n] != NULL )
+                            if ( targetImages[n] == sourceImages[n] )
                             {
-                                *(warpedImages[n]) = *(targetImages[n]);
-                            }
+                                if ( warpedImages[n] != NULL )
+                                {
+                                    *(warpedImages[n]) = *(targetImages[n]);
+                                }
 
-                            for ( ii=0; ii<DIn; ii++ )
-                            {
-                                deform[ii][n]->create(targetImages[n]->get_dimensions());
-                                Gadgetron::clear(*deform[ii][n]);
+                                for ( ii=0; ii<DIn; ii++ )
+                                {
+                                    deform[ii][n]->create(targetImages[n]->get_dimensions());
+                                    Gadgetron::clear(*deform[ii][n]);
 
-                                deformInv[ii][n]->create(targetImages[n]->get_dimensions());
-                                Gadgetron::clear(*deformInv[ii][n]);
-                            }
+                                    deformInv[ii][n]->create(targetImages[n]->get_dimensions());
+                                    Gadgetron::clear(*deformInv[ii][n]);
+                                }
 
-                            continue;
-                        }
+                                return;
+                            }
 
-                        TargetType& target = *(targetImages[n]);
-                        SourceType& source = *(sourceImages[n]);
+                            TargetType& target = *(targetImages[n]);
+                            SourceType& source = *(sourceImages[n]);
 
-                        for ( ii=0; ii<DIn; ii++ )
-                        {
-                            deformCurr[ii] = deform[ii][n];
-                            deformInvCurr[ii] = deformInv[ii][n];
-                        }
+                            for ( ii=0; ii<DIn; ii++ )
+                            {
+                                deformCurr[ii] = deform[ii][n];
+                                deformInvCurr[ii] = deformInv[ii][n];
+                            }
 
-                        registerTwoImagesDeformationFieldBidirectional(target, source, initial, warpedImages[n], deformCurr, deformInvCurr);
+                            registerTwoImagesDeformationFieldBidirectional(*reg, target, source, initial, warpedImages[n], deformCurr, deformInvCurr);
+                        });
                     }
                 }
+                errors.rethrow();
             }
             else if ( container_reg_transformation_==GT_IMAGE_REG_TRANSFORMATION_RIGID 
                         || container_reg_transformation_==GT_IMAGE_REG_TRANSFORMATION_AFFINE )
             {
                 GDEBUG_STREAM("To be implemented ...");
             }
-
-//#ifdef USE_OMP
-//            omp_set_nested(nested);
-//#endif // USE_OMP
         }
         catch(...)
         {
@@ -1160,6 +1239,8 @@ namespace Gadgetron {
             long long numOfTasks = (long long)(2*row);
             GDEBUG_STREAM("hoImageRegContainer2DRegistration<...>::registerOverContainer2DProgressive(...), numOfTasks : " << numOfTasks);
 
+            int numOfThreads = this->numOfContainerThreads(numOfTasks);
+
             std::vector< std::vector<TargetType*> > regImages(numOfTasks);
             std::vector< std::vector<TargetType*> > warpedImages(numOfTasks);
 
@@ -1269,63 +1350,77 @@ namespace Gadgetron {
             {
                 bool initial = false;
 
-                #pragma omp parallel default(none) private(n, ii) shared(numOfTasks, initial, regImages, warpedImages, deform)
+                OmpExceptions errors;
+                #pragma omp parallel default(none) private(n, ii) shared(numOfTasks, initial, regImages, warpedImages, deform, errors) num_threads(numOfThreads)
                 {
                     DeformationFieldType* deformCurr[DIn];
+                    std::unique_ptr<DeformationFieldRegisterType> reg;
+                    errors.run([&]() { reg.reset(this->createDeformationFieldRegister()); });
 
-                    #pragma omp for 
+                    #pragma omp for schedule(dynamic)
                     for ( n=0; n<numOfTasks; n++ )
                     {
-                        size_t numOfImages = regImages[n].size();
-
-                        // no need to copy the refrence frame to warped
-
-                        size_t k;
-                        for ( k=1; k<numOfImages; k++ )
+                        errors.run([&]()
                         {
-                            TargetType& target = *(warpedImages[n][k-1]);
-                            SourceType& source = *(regImages[n][k]);
+                            size_t numOfImages = regImages[n].size();
 
-                            for ( ii=0; ii<DIn; ii++ )
+                            // no need to copy the refrence frame to warped
+
+                            size_t k;
+                            for ( k=1; k<numOfImages; k++ )
                             {
-                                deformCurr[ii] = deform[ii][n][k];
-                            }
+                                TargetType& target = *(warpedImages[n][k-1]);
+                                SourceType& source = *(regImages[n][k]);
 
-                            registerTwoImagesDeformationField(target, source, initial, warpedImages[n][k], deformCurr);
-                        }
+                                for ( ii=0; ii<DIn; ii++ )
+                                {
+                                    deformCurr[ii] = deform[ii][n][k];
+                                }
+
+                                registerTwoImagesDeformationField(*reg, target, source, initial, warpedImages[n][k], deformCurr);
+                            }
+                        });
                     }
                 }
+                errors.rethrow();
             }
             else if ( container_reg_transformation_ == GT_IMAGE_REG_TRANSFORMATION_DEFORMATION_FIELD_BIDIRECTIONAL )
             {
                 bool initial = false;
 
-                #pragma omp parallel default(none) private(n, ii) shared(numOfTasks, initial, regImages, warpedImages, deform, deformInv)
+                OmpExceptions errors;
+                #pragma omp parallel default(none) private(n, ii) shared(numOfTasks, initial, regImages, warpedImages, deform, deformInv, errors) num_threads(numOfThreads)
                 {
                     DeformationFieldType* deformCurr[DIn];
                     DeformationFieldType* deformInvCurr[DIn];
+                    std::unique_ptr<DeformationFieldBidirectionalRegisterType> reg;
+                    errors.run([&]() { reg.reset(this->createDeformationFieldBidirectionalRegister()); });
 
-                    #pragma omp for 
+                    #pragma omp for schedule(dynamic)
                     for ( n=0; n<numOfTasks; n++ )
                     {
-                        size_t numOfImages = regImages[n].size();
-
-                        size_t k;
-                        for ( k=1; k<numOfImages; k++ )
+                        errors.run([&]()
                         {
-                            TargetType& target = *(warpedImages[n][k-1]);
-                            SourceType& source = *(regImages[n][k]);
+                            size_t numOfImages = regImages[n].size();
 
-                            for ( ii=0; ii<DIn; ii++ )
+                            size_t k;
+                            for ( k=1; k<numOfImages; k++ )
                             {
-                                deformCurr[ii] = deform[ii][n][k];
-                                deformInvCurr[ii] = deformInv[ii][n][k];
-                            }
+                                TargetType& target = *(warpedImages[n][k-1]);
+                                SourceType& source = *(regImages[n][k]);
 
-                            registerTwoImagesDeformationFieldBidirectional(target, source, initial, warpedImages[n][k], deformCurr, deformInvCurr);
-                        }
+                                for ( ii=0; ii<DIn; ii++ )
+                                {
+                                    deformCurr[ii] = deform[ii][n][k];
+                                    deformInvCurr[ii] = deformInv[ii][n][k];
+                                }
+
+                                registerTwoImagesDeformationFieldBidirectional(*reg, target, source, initial, warpedImages[n][k], deformCurr, deformInvCurr);
+                            }
+                        });
                     }
                 }
+                errors.rethrow();
             }
             else if ( container_reg_transformation_==GT_IMAGE_REG_TRANSFORMATION_RIGID 
                         || container_reg_transformation_==GT_IMAGE_REG_TRANSFORMATION_AFFINE )
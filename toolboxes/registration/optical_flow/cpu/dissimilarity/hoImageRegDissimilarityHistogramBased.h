@@ -136,7 +136,7 @@ namespace Gadgetron {
 
             if ( pv_interpolation_ )
             {
-                #pragma omp parallel for default(none) private(n) shared(N, range_t, range_w)
+                #pragma omp parallel for default(none) private(n) shared(N, range_t, range_w) if(!omp_in_parallel())
                 for ( n=0; n<(long long)N; n+=(long long)step_size_ignore_pixel_ )
                 {
                     ValueType vt = target(n);
@@ -177,7 +177,7 @@ namespace Gadgetron {
             }
             else
             {
-                #pragma omp parallel for default(none) private(n) shared(N, range_t, range_w)
+                #pragma omp parallel for default(none) private(n) shared(N, range_t, range_w) if(!omp_in_parallel())
                 for ( n=0; n<(long long)N; n+=(long long)step_size_ignore_pixel_ )
                 {
                     ValueType vt = target(n);
@@ -206,15 +206,24 @@ namespace Gadgetron {
         {
             GADGET_CHECK_RETURN_FALSE(NonParametricRegisterClass::initialize());
 
-            if ( transform_ == NULL )
+            std::vector<size_t> dim, dimInv;
+            target_->get_dimensions(dim);
+            source_->get_dimensions(dimInv);
+
+            // a register reused for images of another size needs transformations of the new sizes
+            if ( transform_ != NULL && !preset_transform_
+                && ( !transform_->getDeformationField(0).dimensions_equal(dim) || !transform_inverse_->getDeformationField(0).dimensions_equal(dimInv) ) )
             {
-                std::vector<size_t> dim;
+                delete transform_;
+                transform_ = NULL;
+                delete transform_inverse_;
+                transform_inverse_ = NULL;
+            }
 
-                target_->get_dimensions(dim);
+            if ( transform_ == NULL )
+            {
                 transform_ = new TransformationType(dim);
-
-                source_->get_dimensions(dim);
-                transform_inverse_ = new TransformationType(dim);
+                transform_inverse_ = new TransformationType(dimInv);
 
                 preset_transform_ = false;
             }
@@ -286,10 +286,18 @@ namespace Gadgetron {
         {
             GADGET_CHECK_RETURN_FALSE(BaseClass::initialize());
 
+            std::vector<size_t> dim;
+            target_->get_dimensions(dim);
+
+            // a register reused for a target of another size needs a transformation of the new size
+            if ( transform_ != NULL && !preset_transform_ && !transform_->getDeformationField(0).dimensions_equal(dim) )
+            {
+                delete transform_;
+                transform_ = NULL;
+            }
+
             if ( transform_ == NULL )
             {
-                std::vector<size_t> dim;
-                target_->get_dimensions(dim);
                 transform_ = new TransformationType(dim);
                 preset_transform_ = false;
             }
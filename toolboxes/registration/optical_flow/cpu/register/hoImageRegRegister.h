@@ -189,6 +189,9 @@ namespace Gadgetron {
 
     protected:
 
+        /// delete the boundary handlers, interpolators and dissimilarities allocated by initialize()
+        void clearPyramidObjects();
+
         TargetType* target_;
         SourceType* source_;
 
@@ -283,24 +286,40 @@ namespace Gadgetron {
     template<typename TargetType, typename SourceType, typename CoordType> 
     hoImageRegRegister<TargetType, SourceType, CoordType>::~hoImageRegRegister()
     {
-        unsigned int ii;
-        for ( ii=0; ii<resolution_pyramid_levels_; ii++ )
+        this->clearPyramidObjects();
+    }
+
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    void hoImageRegRegister<TargetType, SourceType, CoordType>::clearPyramidObjects()
+    {
+        size_t ii;
+        for ( ii=0; ii<dissimilarity_pyramid_.size(); ii++ )
         {
             delete target_bh_warper_[ii];
+            target_bh_warper_[ii] = NULL;
             delete target_interp_warper_[ii];
+            target_interp_warper_[ii] = NULL;
 
             delete source_bh_warper_[ii];
+            source_bh_warper_[ii] = NULL;
             delete source_interp_warper_[ii];
+            source_interp_warper_[ii] = NULL;
 
             delete dissimilarity_pyramid_[ii];
+            dissimilarity_pyramid_[ii] = NULL;
             delete dissimilarity_pyramid_inverse_[ii];
+            dissimilarity_pyramid_inverse_[ii] = NULL;
         }
 
         delete target_bh_pyramid_construction_;
+        target_bh_pyramid_construction_ = NULL;
         delete target_interp_pyramid_construction_;
+        target_interp_pyramid_construction_ = NULL;
 
         delete source_bh_pyramid_construction_;
+        source_bh_pyramid_construction_ = NULL;
         delete source_interp_pyramid_construction_;
+        source_interp_pyramid_construction_ = NULL;
     }
 
     template<typename TargetType, typename SourceType, typename CoordType> 
@@ -388,6 +407,9 @@ namespace Gadgetron {
             target_pyramid_[0] = *target_;
             source_pyramid_[0] = *source_;
 
+            // the register can be initialized again for a new pair of images, e.g. when it is reused over the frames of a container
+            this->clearPyramidObjects();
+
             target_bh_pyramid_construction_ = createBoundaryHandler<TargetType>(boundary_handler_type_pyramid_construction_);
             target_interp_pyramid_construction_ = createInterpolator<TargetType, DOut>(interp_type_pyramid_construction_);
             target_interp_pyramid_construction_->setBoundaryHandler(*target_bh_pyramid_construction_);
@@ -356,7 +356,7 @@ namespace Gadgetron {
                         long long sz = (long long)dim_inverse[2];
 
                         long long z;
-                        #pragma omp parallel default(none) private(z) shared(sx, sy, sz, transform, transform_inverse, deform_delta, deform, deform_inverse)
+                        #pragma omp parallel default(none) private(z) shared(sx, sy, sz, transform, transform_inverse, deform_delta, deform, deform_inverse) if(!omp_in_parallel())
                         {
                             CoordType ix, iy, iz, px, py, pz, px_inverse, py_inverse, pz_inverse, dx, dy, dz, dx_inverse, dy_inverse, dz_inverse;
 
@@ -393,7 +393,7 @@ namespace Gadgetron {
                         size_t N = deform_inverse.get_number_of_elements();
 
                         long long n;
-                        #pragma omp parallel default(none) private(n) shared(N, transform, transform_inverse, deform_delta, deform, deform_inverse)
+                        #pragma omp parallel default(none) private(n) shared(N, transform, transform_inverse, deform_delta, deform, deform_inverse) if(!omp_in_parallel())
                         {
                             size_t ind[D];
                             CoordType wind[D], wind_inverse[D], d_inverse[D], pt[D], d[D];
@@ -459,7 +459,7 @@ namespace Gadgetron {
                         long long sz = (long long)dim_inverse[2];
 
                         long long z;
-                        #pragma omp parallel default(none) private(z) shared(sx, sy, sz, transform, transform_inverse, deform_delta)
+                        #pragma omp parallel default(none) private(z) shared(sx, sy, sz, transform, transform_inverse, deform_delta) if(!omp_in_parallel())
                         {
                             CoordType px, py, pz, dx, dy, dz, dx_inverse, dy_inverse, dz_inverse;
                             size_t offset;
@@ -494,7 +494,7 @@ namespace Gadgetron {
                         size_t N = deform_inverse.get_number_of_elements();
 
                         long long n;
-                        #pragma omp parallel default(none) private(n) shared(N, transform, transform_inverse, deform_delta, deform_inverse)
+                        #pragma omp parallel default(none) private(n) shared(N, transform, transform_inverse, deform_delta, deform_inverse) if(!omp_in_parallel())
                         {
                             size_t ind[D];
                             CoordType d_inverse[D], pt[D], d[D];
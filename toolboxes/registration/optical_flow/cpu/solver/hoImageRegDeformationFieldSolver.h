@@ -433,7 +433,7 @@ namespace Gadgetron {
                     {
                         CoordType ix, iy, iz, wx, wy, wz, pX, pY, pZ, deltaWX, deltaWY, deltaWZ;
 
-                        #pragma omp parallel for default(none) private(y, x, z, ix, iy, iz, wx, wy, wz, pX, pY, pZ, deltaWX, deltaWY, deltaWZ) shared(sx, sy, sz, target, deform_delta, deform_updated, transform)
+                        #pragma omp parallel for default(none) private(y, x, z, ix, iy, iz, wx, wy, wz, pX, pY, pZ, deltaWX, deltaWY, deltaWZ) shared(sx, sy, sz, target, deform_delta, deform_updated, transform) if(!omp_in_parallel())
                         for ( z=0; z<sz; z++ )
                         {
                             for ( y=0; y<sy; y++ )
@@ -467,7 +467,7 @@ namespace Gadgetron {
 
                         long long n;
 
-                        #pragma omp parallel default(none) private(n, ii) shared(N, target, deform_delta, deform_updated, transform)
+                        #pragma omp parallel default(none) private(n, ii) shared(N, target, deform_delta, deform_updated, transform) if(!omp_in_parallel())
                         {
                             size_t ind[D];
                             CoordType pos[D];
@@ -533,7 +533,7 @@ namespace Gadgetron {
                     {
                         CoordType pX, pY, pZ;
 
-                        #pragma omp parallel for default(none) private(y, x, z, pX, pY, pZ) shared(sx, sy, sz, deform_delta, deform_updated, transform)
+                        #pragma omp parallel for default(none) private(y, x, z, pX, pY, pZ) shared(sx, sy, sz, deform_delta, deform_updated, transform) if(!omp_in_parallel())
                         for ( z=0; z<sz; z++ )
                         {
                             for ( y=0; y<sy; y++ )
@@ -561,7 +561,7 @@ namespace Gadgetron {
 
                         long long n;
 
-                        #pragma omp parallel default(none) private(n, ii) shared(N, deform_delta, deform_updated, transform)
+                        #pragma omp parallel default(none) private(n, ii) shared(N, deform_delta, deform_updated, transform) if(!omp_in_parallel())
                         {
                             size_t ind[D];
                             CoordType pDelta[D];
@@ -860,7 +860,7 @@ namespace Gadgetron {
                 CoordType dy = (CoordType)(2 * M_PI / sy);
                 CoordType dz = (CoordType)(2 * M_PI / sz);
 
-#pragma omp parallel for private(z, y, x) shared(sx, sy, sz)
+#pragma omp parallel for private(z, y, x) shared(sx, sy, sz) if(!omp_in_parallel())
                 for (z = 0; z < sz; z++)
                 {
                     CoordType kz = z;
@@ -920,7 +920,7 @@ namespace Gadgetron {
                     dd[ii] = (CoordType)(2 * M_PI / deform[0].get_size(ii));
                 }
 
-#pragma omp parallel default(none) private(n) shared(dd, N)
+#pragma omp parallel default(none) private(n) shared(dd, N) if(!omp_in_parallel())
                 {
                     size_t ind[D];
                     CoordType kk[D];
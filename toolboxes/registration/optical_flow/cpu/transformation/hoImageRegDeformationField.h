@@ -299,7 +299,7 @@ namespace Gadgetron {
                 pos[ii] = pt_in[ii];
             }
 
-            #pragma omp parallel for default(none) private(ii) shared(pos, pt_out)
+            #pragma omp parallel for default(none) private(ii) shared(pos, pt_out) if(!omp_in_parallel())
             for ( ii=0; ii<(int)D; ii++ )
             {
                 pt_out[ii] += this->interp_default_[ii]->operator()(pos);
@@ -375,7 +375,7 @@ namespace Gadgetron {
         try
         {
             long long n;
-            #pragma omp parallel for default(none) private(n) shared(N, pt_in, pt_out)
+            #pragma omp parallel for default(none) private(n) shared(N, pt_in, pt_out) if(!omp_in_parallel())
             for( n=0; n<(long long)N; n++ )
             {
                 this->transform(pt_in+n*D, pt_out+n*D);
@@ -413,7 +413,7 @@ namespace Gadgetron {
         try
         {
             long long n;
-            #pragma omp parallel for default(none) private(n) shared(N, xi, yi, xo, yo)
+            #pragma omp parallel for default(none) private(n) shared(N, xi, yi, xo, yo) if(!omp_in_parallel())
             for( n=0; n<(long long)N; n++ )
             {
                 this->transform(xi[n], yi[n], xo[n], yo[n]);
@@ -452,7 +452,7 @@ namespace Gadgetron {
         try
         {
             long long n;
-            #pragma omp parallel for default(none) private(n) shared(N, xi, yi, zi, xo, yo, zo)
+            #pragma omp parallel for default(none) private(n) shared(N, xi, yi, zi, xo, yo, zo) if(!omp_in_parallel())
             for( n=0; n<(long long)N; n++ )
             {
                 this->transform(xi[n], yi[n], zi[n], xo[n], yo[n], zo[n]);
@@ -564,7 +564,7 @@ namespace Gadgetron {
 
             long long n;
 
-            #pragma omp parallel private(n) shared(N, jac, dim, offset, pixelSize, borderWidth, deltaReciprocal, deform_field)
+            #pragma omp parallel private(n) shared(N, jac, dim, offset, pixelSize, borderWidth, deltaReciprocal, deform_field) if(!omp_in_parallel())
             {
 
                 std::vector<size_t> ind(D);
@@ -666,7 +666,7 @@ namespace Gadgetron {
             Gadgetron::clear(logJac);
 
             long long n;
-            #pragma omp parallel private(n) shared(N, borderWidth, jac, deformNorm, logJac, dim, pixelSize, deform_field)
+            #pragma omp parallel private(n) shared(N, borderWidth, jac, deformNorm, logJac, dim, pixelSize, deform_field) if(!omp_in_parallel())
             {
                 std::vector<size_t> ind(D);
                 hoMatrix<T> jacCurr(D, D);
@@ -225,7 +225,7 @@ namespace Gadgetron {
         {
             long long ii;
 
-            #pragma omp parallel for default(none) private(ii) shared(pt_in, pt_out, N)
+            #pragma omp parallel for default(none) private(ii) shared(pt_in, pt_out, N) if(!omp_in_parallel())
             for ( ii=0; ii<(long long)N; ii++ )
             {
                 this->transform(pt_in+ii*D, pt_out+ii*D);
@@ -264,7 +264,7 @@ namespace Gadgetron {
         {
             long long ii;
 
-            #pragma omp parallel for default(none) private(ii) shared(xi, yi, xo, yo, N)
+            #pragma omp parallel for default(none) private(ii) shared(xi, yi, xo, yo, N) if(!omp_in_parallel())
             for ( ii=0; ii<(long long)N; ii++ )
             {
                 this->transform(xi[ii], yi[ii], xo[ii], yo[ii]);
@@ -304,7 +304,7 @@ namespace Gadgetron {
         {
             long long ii;
 
-            #pragma omp parallel for default(none) private(ii) shared(xi, yi, zi, xo, yo, zo, N)
+            #pragma omp parallel for default(none) private(ii) shared(xi, yi, zi, xo, yo, zo, N) if(!omp_in_parallel())
             for ( ii=0; ii<(long long)N; ii++ )
             {
                 this->transform(xi[ii], yi[ii], zi[ii], xo[ii], yo[ii], zo[ii]);
@@ -228,7 +228,7 @@ namespace Gadgetron {
         {
             long long ii;
 
-            #pragma omp parallel for default(none) private(ii) shared(in, out, N)
+            #pragma omp parallel for default(none) private(ii) shared(in, out, N) if(!omp_in_parallel())
             for ( ii=0; ii<(long long)N; ii++ )
             {
                 this->transform(in[ii].begin(), out[ii].begin());
@@ -262,7 +262,7 @@ namespace Gadgetron {
         {
             long long ii;
 
-            #pragma omp parallel for default(none) private(ii) shared(pt_in, N, pt_out)
+            #pragma omp parallel for default(none) private(ii) shared(pt_in, N, pt_out) if(!omp_in_parallel())
             for ( ii=0; ii<(long long)N; ii++ )
             {
                 this->transform(pt_in+ii*DIn, pt_out+ii*DOut);
@@ -287,7 +287,7 @@ namespace Gadgetron {
 
             long long ii;
 
-            #pragma omp parallel default(none) private(ii) shared(pt_inout, N)
+            #pragma omp parallel default(none) private(ii) shared(pt_inout, N) if(!omp_in_parallel())
             {
                 T pt_out[DOut];
 
@@ -316,7 +316,7 @@ namespace Gadgetron {
         {
             long long ii;
 
-            #pragma omp parallel for default(none) private(ii) shared(xi, yi, xo, yo, N)
+            #pragma omp parallel for default(none) private(ii) shared(xi, yi, xo, yo, N) if(!omp_in_parallel())
             for ( ii=0; ii<(long long)N; ii++ )
             {
                 this->transform(xi[ii], yi[ii], xo[ii], yo[ii]);
@@ -341,7 +341,7 @@ namespace Gadgetron {
 
             T xo, yo;
 
-            #pragma omp parallel for default(none) private(ii, xo, yo) shared(x_inout, y_inout, N)
+            #pragma omp parallel for default(none) private(ii, xo, yo) shared(x_inout, y_inout, N) if(!omp_in_parallel())
             for ( ii=0; ii<(long long)N; ii++ )
             {
                 this->transform(x_inout[ii], y_inout[ii], xo, yo);
@@ -366,7 +366,7 @@ namespace Gadgetron {
         {
             long long ii;
 
-            #pragma omp parallel for default(none) private(ii) shared(xi, yi, zi, xo, yo, zo, N)
+            #pragma omp parallel for default(none) private(ii) shared(xi, yi, zi, xo, yo, zo, N) if(!omp_in_parallel())
             for ( ii=0; ii<(long long)N; ii++ )
             {
                 this->transform(xi[ii], yi[ii], zi[ii], xo[ii], yo[ii], zo[ii]);
@@ -391,7 +391,7 @@ namespace Gadgetron {
 
             T xo, yo, zo;
 
-            #pragma omp parallel for default(none) private(ii, xo, yo, zo) shared(x_inout, y_inout, z_inout, N)
+            #pragma omp parallel for default(none) private(ii, xo, yo, zo) shared(x_inout, y_inout, z_inout, N) if(!omp_in_parallel())
             for ( ii=0; ii<(long long)N; ii++ )
             {
                 this->transform(x_inout[ii], y_inout[ii], z_inout[ii], xo, yo, zo);
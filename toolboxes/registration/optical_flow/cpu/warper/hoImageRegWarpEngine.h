@@ -0,0 +1,349 @@
+/** \file   hoImageRegWarpEngine.h
+    \brief  Tiled, row parallel warping of 2D and 3D images, used by hoImageRegWarper
+
+            The interpolator and boundary handler are compile time parameters of the samplers, so the per pixel
+            interpolation is not a virtual call. A row of the target grid is processed in tiles; the source positions
+            of a tile are computed first, and a tile completely inside the source image is interpolated in one simd loop
+            (gather loads on AVX2/AVX-512 builds). Tiles touching the boundary fall back to the per pixel path.
+*/
+
+#ifndef hoImageRegWarpEngine_H_
+#define hoImageRegWarpEngine_H_
+
+#pragma once
+
+#include "hoNDImage.h"
+#include "hoNDInterpolator.h"
+#include "hoNDBoundaryHandler.h"
+
+#include <algorithm>
+
+#ifdef USE_OMP
+    #include <omp.h>
+#endif // USE_OMP
+
+namespace Gadgetron {
+
+    /// linear interpolation of a 2D or 3D image, identical to hoNDInterpolatorLinear
+    /// the boundary handler is only called for pixels whose neighbours are outside the image
+    template <typename ImageType, typename BoundHandlerType>
+    class hoImageRegWarpLinearSampler
+    {
+    public:
+
+        typedef typename ImageType::value_type T;
+        typedef typename ImageType::coord_type coord_type;
+
+        static const bool vectorized = true;
+
+        hoImageRegWarpLinearSampler(const ImageType& a, BoundHandlerType& bh) : data_(a.begin()), bh_(bh)
+        {
+            sx_ = a.get_size(0);
+            sy_ = a.get_size(1);
+            sz_ = (ImageType::NDIM > 2) ? a.get_size(2) : 1;
+        }
+
+        /// whether all N points have their interpolation neighbours inside the image
+        bool inside(size_t N, const coord_type* x, const coord_type* y) const
+        {
+            const coord_type ex = coord_type(sx_) - 1, ey = coord_type(sy_) - 1;
+
+            bool res = true;
+            #pragma omp simd reduction(&&:res)
+            for (size_t n = 0; n < N; n++)
+            {
+                res = res && (x[n] >= 0) && (x[n] < ex) && (y[n] >= 0) && (y[n] < ey);
+            }
+            return res;
+        }
+
+        bool inside(size_t N, const coord_type* x, const coord_type* y, const coord_type* z) const
+        {
+            const coord_type ez = coord_type(sz_) - 1;
+
+            bool res = this->inside(N, x, y);
+            #pragma omp simd reduction(&&:res)
+            for (size_t n = 0; n < N; n++)
+            {
+                res = res && (z[n] >= 0) && (z[n] < ez);
+            }
+            return res;
+        }
+
+        /// interpolate N points which are all inside
+        void interior(size_t N, const coord_type* x, const coord_type* y, T* r) const
+        {
+            const T* data = data_;
+            const size_t sx = sx_;
+
+            #pragma omp simd
+            for (size_t n = 0; n < N; n++)
+            {
+                size_t ix = static_cast<size_t>(x[n]);
+                coord_type dx = x[n] - ix;
+                coord_type dx_prime = coord_type(1.0) - dx;
+
+                size_t iy = static_cast<size_t>(y[n]);
+                coord_type dy = y[n] - iy;
+                coord_type dy_prime = coord_type(1.0) - dy;
+
+                size_t offset = ix + iy*sx;
+
+                r[n] = (    (data[offset]       *   dx_prime     *dy_prime
+                        +   data[offset+1]      *   dx           *dy_prime)
+                        +   (data[offset+sx]    *   dx_prime     *dy
+                        +   data[offset+sx+1]   *   dx           *dy) );
+            }
+        }
+
+        void interior(size_t N, const coord_type* x, const coord_type* y, const coord_type* z, T* r) const
+        {
+            const T* data = data_;
+            const size_t sx = sx_;
+            const size_t sxy = sx_*sy_;
+
+            #pragma omp simd
+            for (size_t n = 0; n < N; n++)
+            {
+                size_t ix = static_cast<size_t>(x[n]);
+                coord_type dx = x[n] - ix;
+                coord_type dx_prime = coord_type(1.0) - dx;
+
+                size_t iy = static_cast<size_t>(y[n]);
+                coord_type dy = y[n] - iy;
+                coord_type dy_prime = coord_type(1.0) - dy;
+
+                size_t iz = static_cast<size_t>(z[n]);
+                coord_type dz = z[n] - iz;
+                coord_type dz_prime = coord_type(1.0) - dz;
+
+                size_t offset = ix + iy*sx + iz*sxy;
+
+                r[n] = (    (data[offset]           *   dx_prime     *dy_prime   *dz_prime
+                        +   data[offset+1]          *   dx           *dy_prime   *dz_prime)
+                        +   (data[offset+sx]        *   dx_prime     *dy         *dz_prime
+                        +   data[offset+sx+1]       *   dx           *dy         *dz_prime)
+                        +   (data[offset+sxy]       *   dx_prime     *dy_prime   *dz
+                        +   data[offset+sxy+1]      *   dx           *dy_prime   *dz)
+                        +   (data[offset+sxy+sx]    *   dx_prime     *dy         *dz
+                        +   data[offset+sxy+sx+1]   *   dx           *dy         *dz) );
+            }
+        }
+
+        /// interpolate a single point anywhere
+        T operator()(coord_type x, coord_type y) const
+        {
+            if ( this->inside(1, &x, &y) )
+            {
+                T r;
+                this->interior(1, &x, &y, &r);
+                return r;
+            }
+
+            long long ix = static_cast<long long>(std::floor(x));
+            coord_type dx = x - ix;
+            coord_type dx_prime = coord_type(1.0)-dx;
+
+            long long iy = static_cast<long long>(std::floor(y));
+            coord_type dy = y - iy;
+            coord_type dy_prime = coord_type(1.0)-dy;
+
+            return (    (bh_.BoundHandlerType::operator()(ix, iy       )   *   dx_prime    *dy_prime
+                    +   bh_.BoundHandlerType::operator()(ix+1, iy      )   *   dx          *dy_prime)
+                    +   (bh_.BoundHandlerType::operator()(ix, iy+1     )   *   dx_prime    *dy
+                    +   bh_.BoundHandlerType::operator()(ix+1, iy+1    )   *   dx          *dy) );
+        }
+
+        T operator()(coord_type x, coord_type y, coord_type z) const
+        {
+            if ( this->inside(1, &x, &y, &z) )
+            {
+                T r;
+                this->interior(1, &x, &y, &z, &r);
+                return r;
+            }
+
+            long long ix = static_cast<long long>(std::floor(x));
+            coord_type dx = x - ix;
+            coord_type dx_prime = coord_type(1.0)-dx;
+
+            long long iy = static_cast<long long>(std::floor(y));
+            coord_type dy = y - iy;
+            coord_type dy_prime = coord_type(1.0)-dy;
+
+            long long iz = static_cast<long long>(std::floor(z));
+            coord_type dz = z - iz;
+            coord_type dz_prime = coord_type(1.0)-dz;
+
+            return (    (bh_.BoundHandlerType::operator()(ix,   iy,     iz   )   *   dx_prime     *dy_prime   *dz_prime
+                    +   bh_.BoundHandlerType::operator()(ix+1, iy,     iz    )   *   dx           *dy_prime   *dz_prime)
+                    +   (bh_.BoundHandlerType::operator()(ix,   iy+1,   iz   )   *   dx_prime     *dy         *dz_prime
+                    +   bh_.BoundHandlerType::operator()(ix+1, iy+1,   iz    )   *   dx           *dy         *dz_prime)
+                    +   (bh_.BoundHandlerType::operator()(ix,   iy,     iz+1 )   *   dx_prime     *dy_prime   *dz
+                    +   bh_.BoundHandlerType::operator()(ix+1, iy,     iz+1  )   *   dx           *dy_prime   *dz)
+                    +   (bh_.BoundHandlerType::operator()(ix,   iy+1,   iz+1 )   *   dx_prime     *dy         *dz
+                    +   bh_.BoundHandlerType::operator()(ix+1, iy+1,   iz+1  )   *   dx           *dy         *dz) );
+        }
+
+    protected:
+
+        const T* data_;
+        BoundHandlerType& bh_;
+
+        size_t sx_;
+        size_t sy_;
+        size_t sz_;
+    };
+
+    /// any interpolator, e.g. hoNDInterpolatorBSpline, called without virtual dispatch when InterpolatorType is the final type
+    template <typename InterpolatorType>
+    class hoImageRegWarpInterpolatorSampler
+    {
+    public:
+
+        typedef typename InterpolatorType::T T;
+        typedef typename InterpolatorType::coord_type coord_type;
+
+        static const bool vectorized = false;
+
+        hoImageRegWarpInterpolatorSampler(InterpolatorType& interp) : interp_(interp) {}
+
+        bool inside(size_t, const coord_type*, const coord_type*) const { return false; }
+        bool inside(size_t, const coord_type*, const coord_type*, const coord_type*) const { return false; }
+        void interior(size_t, const coord_type*, const coord_type*, T*) const {}
+        void interior(size_t, const coord_type*, const coord_type*, const coord_type*, T*) const {}
+
+        T operator()(coord_type x, coord_type y) const { return interp_.InterpolatorType::operator()(x, y); }
+        T operator()(coord_type x, coord_type y, coord_type z) const { return interp_.InterpolatorType::operator()(x, y, z); }
+
+    protected:
+
+        InterpolatorType& interp_;
+    };
+
+    namespace hoImageRegWarpEngine
+    {
+        /// number of pixels of a row processed together
+        static const size_t tile_size = 64;
+
+        /// images smaller than this are warped by one thread
+        static const size_t parallel_number_of_pixels = 128*128;
+
+        /// warp the pixels of the 2D or 3D target grid which are not equal to bg_value
+        /// mapper(x0, N, y, z, xs, ys, zs) fills the source image positions of the N pixels starting at (x0, y, z)
+        /// warped must already have the size of target
+        template <unsigned int D, typename ImageType, typename Sampler, typename Mapper>
+        void warpRows(const ImageType& target, typename ImageType::value_type bg_value, const Sampler& sampler, Mapper mapper, ImageType& warped)
+        {
+            static_assert(D==2 || D==3, "hoImageRegWarpEngine only supports 2D and 3D");
+
+            typedef typename ImageType::value_type T;
+            typedef typename Sampler::coord_type coord_type;
+
+            const size_t sx = target.get_size(0);
+            const size_t sy = target.get_size(1);
+            const size_t sz = (D==3) ? target.get_size(2) : 1;
+
+            const T* pTarget = target.begin();
+            T* pWarped = warped.begin();
+
+            long long numOfRows = (long long)(sy*sz);
+            long long r;
+
+            #pragma omp parallel for private(r) if(sx*sy*sz >= parallel_number_of_pixels && !omp_in_parallel())
+            for ( r=0; r<numOfRows; r++ )
+            {
+                size_t y = (size_t)r % sy;
+                size_t z = (size_t)r / sy;
+
+                coord_type xs[tile_size], ys[tile_size], zs[tile_size];
+                T res[tile_size];
+
+                for ( size_t x0=0; x0<sx; x0+=tile_size )
+                {
+                    size_t N = std::min(tile_size, sx-x0);
+
+                    const T* t = pTarget + x0 + r*sx;
+                    T* w = pWarped + x0 + r*sx;
+
+                    mapper(x0, N, y, z, xs, ys, zs);
+
+                    bool inside;
+                    if constexpr (D==2) inside = Sampler::vectorized && sampler.inside(N, xs, ys);
+                    else inside = Sampler::vectorized && sampler.inside(N, xs, ys, zs);
+
+                    if ( inside )
+                    {
+                        if constexpr (D==2) sampler.interior(N, xs, ys, res);
+                        else sampler.interior(N, xs, ys, zs, res);
+
+                        #pragma omp simd
+                        for ( size_t n=0; n<N; n++ )
+                        {
+                            w[n] = (t[n] != bg_value) ? res[n] : t[n];
+                        }
+                    }
+                    else
+                    {
+                        for ( size_t n=0; n<N; n++ )
+                        {
+                            if ( t[n] != bg_value )
+                            {
+                                if constexpr (D==2) w[n] = sampler(xs[n], ys[n]);
+                                else w[n] = sampler(xs[n], ys[n], zs[n]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        /// call f(sampler) with the sampler matching the run time type of interp
+        /// returns false if there is no specialised sampler for the interpolator or boundary handler, e.g. nearest neighbour
+        template <unsigned int D, typename ImageType, typename F>
+        bool dispatch(const ImageType& source, hoNDInterpolator<ImageType>& interp, F f)
+        {
+            typedef hoNDBoundaryHandler<ImageType> BoundHandlerType;
+
+            hoNDInterpolatorLinear<ImageType>* interpLinear = dynamic_cast< hoNDInterpolatorLinear<ImageType>* >(&interp);
+            if ( interpLinear != NULL )
+            {
+                BoundHandlerType* bh = interpLinear->getBoundaryHandler();
+                if ( bh == NULL ) return false;
+
+                if ( hoNDBoundaryHandlerFixedValue<ImageType>* h = dynamic_cast< hoNDBoundaryHandlerFixedValue<ImageType>* >(bh) )
+                {
+                    f(hoImageRegWarpLinearSampler<ImageType, hoNDBoundaryHandlerFixedValue<ImageType> >(source, *h));
+                }
+                else if ( hoNDBoundaryHandlerBorderValue<ImageType>* h = dynamic_cast< hoNDBoundaryHandlerBorderValue<ImageType>* >(bh) )
+                {
+                    f(hoImageRegWarpLinearSampler<ImageType, hoNDBoundaryHandlerBorderValue<ImageType> >(source, *h));
+                }
+                else if ( hoNDBoundaryHandlerPeriodic<ImageType>* h = dynamic_cast< hoNDBoundaryHandlerPeriodic<ImageType>* >(bh) )
+                {
+                    f(hoImageRegWarpLinearSampler<ImageType, hoNDBoundaryHandlerPeriodic<ImageType> >(source, *h));
+                }
+                else if ( hoNDBoundaryHandlerMirror<ImageType>* h = dynamic_cast< hoNDBoundaryHandlerMirror<ImageType>* >(bh) )
+                {
+                    f(hoImageRegWarpLinearSampler<ImageType, hoNDBoundaryHandlerMirror<ImageType> >(source, *h));
+                }
+                else
+                {
+                    return false;
+                }
+
+                return true;
+            }
+
+            hoNDInterpolatorBSpline<ImageType, D>* interpBSpline = dynamic_cast< hoNDInterpolatorBSpline<ImageType, D>* >(&interp);
+            if ( interpBSpline != NULL )
+            {
+                f(hoImageRegWarpInterpolatorSampler< hoNDInterpolatorBSpline<ImageType, D> >(*interpBSpline));
+                return true;
+            }
+
+            return false;
+        }
+    }
+}
+#endif // hoImageRegWarpEngine_H_
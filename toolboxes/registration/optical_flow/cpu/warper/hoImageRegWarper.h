@@ -19,6 +19,7 @@
 
 #include "hoImageRegTransformation.h"
 #include "hoImageRegDeformationField.h"
+#include "hoImageRegWarpEngine.h"
 
 #include "GadgetronTimer.h"
 #include "ImageIOAnalyze.h"
@@ -86,6 +87,9 @@ namespace Gadgetron {
 
         virtual void print(std::ostream& os) const;
 
+        /// if true, 2D and 3D warps with the linear or BSpline interpolator use hoImageRegWarpEngine
+        bool useWarpEngine_;
+
         // ----------------------------------
         // debug and timing
         // ----------------------------------
@@ -104,6 +108,9 @@ namespace Gadgetron {
 
     protected:
 
+        /// warp with hoImageRegWarpEngine; returns false if the engine does not support the setup, nothing is changed then
+        bool warpWithEngine(const TargetType& target, const SourceType& source, bool useWorldCoordinate, TargetType& warped);
+
         TransformationType* transform_;
         InterpolatorType* interp_;
 
@@ -112,7 +119,7 @@ namespace Gadgetron {
     };
 
     template<typename TargetType, typename SourceType, typename CoordType> 
-    hoImageRegWarper<TargetType, SourceType, CoordType>::hoImageRegWarper(ValueType bg_value) : transform_(NULL), interp_(NULL), performTiming_(false), bg_value_(bg_value)
+    hoImageRegWarper<TargetType, SourceType, CoordType>::hoImageRegWarper(ValueType bg_value) : useWarpEngine_(true), transform_(NULL), interp_(NULL), performTiming_(false), bg_value_(bg_value)
     {
         gt_timer1_.set_timing_in_destruction(false);
         gt_timer2_.set_timing_in_destruction(false);
@@ -165,6 +172,11 @@ namespace Gadgetron {
 
             warped = target;
 
+            if ( useWarpEngine_ && this->warpWithEngine(target, source, useWorldCoordinate, warped) )
+            {
+                return true;
+            }
+
             if ( DIn==2 && DOut==2 )
             {
                 size_t sx = target.get_size(0);
@@ -239,7 +251,7 @@ namespace Gadgetron {
 
                 if ( useWorldCoordinate )
                 {
-                    #pragma omp parallel private(z) shared(sx, sy, sz, target, source, warped)
+                    #pragma omp parallel private(z) shared(sx, sy, sz, target, source, warped) if(!omp_in_parallel())
                     {
                         typename TargetType::coord_type px, py, pz, px_source, py_source, pz_source, ix_source, iy_source, iz_source;
 
@@ -273,7 +285,7 @@ namespace Gadgetron {
                 }
                 else
                 {
-                    #pragma omp parallel private(z) shared(sx, sy, sz, target, source, warped)
+                    #pragma omp parallel private(z) shared(sx, sy, sz, target, source, warped) if(!omp_in_parallel())
                     {
                         typename TargetType::coord_type ix_source, iy_source, iz_source;
 
@@ -308,7 +320,7 @@ namespace Gadgetron {
 
                 if ( useWorldCoordinate )
                 {
-                    #pragma omp parallel private(n) shared(numOfPixels, target, source, warped)
+                    #pragma omp parallel private(n) shared(numOfPixels, target, source, warped) if(!omp_in_parallel())
                     {
                         size_t ind_target[DIn];
                         typename TargetType::coord_type pt_target[DIn];
@@ -339,7 +351,7 @@ namespace Gadgetron {
                 }
                 else
                 {
-                    #pragma omp parallel private(n) shared(numOfPixels, target, source, warped)
+                    #pragma omp parallel private(n) shared(numOfPixels, target, source, warped) if(!omp_in_parallel())
                     {
                         typename TargetType::coord_type pt_target[DIn];
                         typename TargetType::coord_type pt_source[DOut];
@@ -389,6 +401,11 @@ namespace Gadgetron {
 
             warped = target;
 
+            if ( useWarpEngine_ && this->warpWithEngine(target, source, true, warped) )
+            {
+                return true;
+            }
+
             if ( DIn==2 && DOut==2 )
             {
                 size_t sx = target.get_size(0);
@@ -433,7 +450,7 @@ namespace Gadgetron {
 
                 long long z;
 
-                #pragma omp parallel private(z) shared(sx, sy, sz, target, source, warped)
+                #pragma omp parallel private(z) shared(sx, sy, sz, target, source, warped) if(!omp_in_parallel())
                 {
                     coord_type px, py, pz, dx, dy, dz, ix_source, iy_source, iz_source;
 
@@ -471,7 +488,7 @@ namespace Gadgetron {
 
                 long long n;
 
-                #pragma omp parallel private(n) shared(numOfPixels, target, source, warped)
+                #pragma omp parallel private(n) shared(numOfPixels, target, source, warped) if(!omp_in_parallel())
                 {
                     size_t ind_target[DIn];
                     coord_type pt_target[DIn];
@@ -518,6 +535,121 @@ namespace Gadgetron {
         return true;
     }
 
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    bool hoImageRegWarper<TargetType, SourceType, CoordType>::
+    warpWithEngine(const TargetType& target, const SourceType& source, bool useWorldCoordinate, TargetType& warped)
+    {
+        if constexpr ( (DIn==2 || DIn==3) && DIn==DOut )
+        {
+            typedef typename TargetType::coord_type target_coord_type;
+
+            const size_t sx = target.get_size(0);
+            const size_t sy = target.get_size(1);
+
+            TransformationType* transform = transform_;
+
+            // the deformation field is read directly and must be on the target grid
+            DeformTransformationType* transformDeformField = dynamic_cast<DeformTransformationType*>(transform_);
+            const CoordType* deform[DIn];
+            if ( transformDeformField != NULL )
+            {
+                for ( unsigned int ii=0; ii<DIn; ii++ )
+                {
+                    const typename DeformTransformationType::DeformationFieldType& field = transformDeformField->getDeformationField(ii);
+                    for ( unsigned int jj=0; jj<DIn; jj++ )
+                    {
+                        if ( field.get_size(jj) != target.get_size(jj) ) return false;
+                    }
+                    deform[ii] = field.begin();
+                }
+            }
+
+            return hoImageRegWarpEngine::dispatch<DOut>(source, *interp_, [&](const auto& sampler)
+            {
+                if ( transformDeformField != NULL && !useWorldCoordinate )
+                {
+                    // source position = target pixel + deformation
+                    hoImageRegWarpEngine::warpRows<DIn>(target, bg_value_, sampler,
+                        [&](size_t x0, size_t N, size_t y, size_t z, target_coord_type* xs, target_coord_type* ys, target_coord_type* zs)
+                        {
+                            size_t offset = x0 + y*sx + z*sx*sy;
+
+                            #pragma omp simd
+                            for ( size_t n=0; n<N; n++ )
+                            {
+                                xs[n] = (x0+n) + deform[0][offset+n];
+                                ys[n] = y + deform[1][offset+n];
+                                if constexpr (DIn==3) zs[n] = z + deform[2][offset+n];
+                            }
+                        }, warped);
+                }
+                else if ( transformDeformField != NULL )
+                {
+                    // deformation is in the world coordinate
+                    hoImageRegWarpEngine::warpRows<DIn>(target, bg_value_, sampler,
+                        [&](size_t x0, size_t N, size_t y, size_t z, target_coord_type* xs, target_coord_type* ys, target_coord_type* zs)
+                        {
+                            size_t offset = x0 + y*sx + z*sx*sy;
+
+                            for ( size_t n=0; n<N; n++ )
+                            {
+                                if constexpr (DIn==2)
+                                {
+                                    coord_type px, py;
+                                    target.image_to_world(x0+n, y, px, py);
+                                    source.world_to_image(px+deform[0][offset+n], py+deform[1][offset+n], xs[n], ys[n]);
+                                }
+                                else
+                                {
+                                    coord_type px, py, pz;
+                                    target.image_to_world(x0+n, y, z, px, py, pz);
+                                    source.world_to_image(px+deform[0][offset+n], py+deform[1][offset+n], pz+deform[2][offset+n], xs[n], ys[n], zs[n]);
+                                }
+                            }
+                        }, warped);
+                }
+                else if ( useWorldCoordinate )
+                {
+                    hoImageRegWarpEngine::warpRows<DIn>(target, bg_value_, sampler,
+                        [&](size_t x0, size_t N, size_t y, size_t z, target_coord_type* xs, target_coord_type* ys, target_coord_type* zs)
+                        {
+                            for ( size_t n=0; n<N; n++ )
+                            {
+                                if constexpr (DIn==2)
+                                {
+                                    target_coord_type px, py, px_source, py_source;
+                                    target.image_to_world(x0+n, y, px, py);
+                                    transform->transform(px, py, px_source, py_source);
+                                    source.world_to_image(px_source, py_source, xs[n], ys[n]);
+                                }
+                                else
+                                {
+                                    target_coord_type px, py, pz, px_source, py_source, pz_source;
+                                    target.image_to_world(x0+n, y, z, px, py, pz);
+                                    transform->transform(px, py, pz, px_source, py_source, pz_source);
+                                    source.world_to_image(px_source, py_source, pz_source, xs[n], ys[n], zs[n]);
+                                }
+                            }
+                        }, warped);
+                }
+                else
+                {
+                    hoImageRegWarpEngine::warpRows<DIn>(target, bg_value_, sampler,
+                        [&](size_t x0, size_t N, size_t y, size_t z, target_coord_type* xs, target_coord_type* ys, target_coord_type* zs)
+                        {
+                            for ( size_t n=0; n<N; n++ )
+                            {
+                                if constexpr (DIn==2) transform->transform(x0+n, y, xs[n], ys[n]);
+                                else transform->transform(x0+n, y, z, xs[n], ys[n], zs[n]);
+                            }
+                        }, warped);
+                }
+            });
+        }
+
+        return false;
+    }
+
     template<typename TargetType, typename SourceType, typename CoordType> 
     void hoImageRegWarper<TargetType, SourceType, CoordType>::print(std::ostream& os) const
     {
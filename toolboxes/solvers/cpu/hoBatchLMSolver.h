@@ -0,0 +1,281 @@
+/** \file hoBatchLMSolver.h
+    \brief Levenberg-Marquardt solver fitting a small curve model to a batch of pixels in lockstep.
+
+    All pixels of a batch share the sample points x (e.g. the inversion or echo times) and are stored
+    lane-fastest (structure of arrays), so the model evaluation, the normal equations and the P x P
+    Cholesky solves run over the W lanes of a batch as one vectorisable loop.
+    Damping and step acceptance are kept per lane; converged or failed lanes are frozen by masking,
+    and the iteration stops once no lane is active.
+
+    The model is a functor providing the number of parameters and the value and gradient at one point:
+
+        static constexpr int num_params = P;
+        T operator()(T x, const T* p, T* grad) const;
+*/
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace Gadgetron {
+
+    enum class hoBatchLMStatus { SUCCESS, MAX_ITERATIONS_REACHED, LINEAR_SOLVER_FAILED };
+
+    template <typename T, typename Model, int W = 16> class hoBatchLMSolver
+    {
+    public:
+
+        static constexpr int P = Model::num_params;
+        static constexpr int batch_size = W;
+
+        hoBatchLMSolver() : max_iter_(1000), minimum_step_size_(T(1e-6)), minimum_gradient_(T(1e-8)) {}
+
+        explicit hoBatchLMSolver(const Model& model) : hoBatchLMSolver() { model_ = model; }
+
+        /// x: N sample points, shared by all lanes
+        /// y: [N W] measured values, lane fastest
+        /// params: [P W] initial guess on input and fitted parameters on output
+        /// status: [W] result of every lane
+        /// num_lanes: number of valid lanes; the remaining lanes of y and params are not read or written
+        void solve(const std::vector<T>& x, const T* y, T* params, hoBatchLMStatus* status, int num_lanes = W)
+        {
+            const size_t N = x.size();
+            if (num_lanes <= 0) return;
+            num_lanes = std::min(num_lanes, W);
+
+            // pad unused lanes with the first lane, so they carry benign numbers through the iterations
+            y_.resize(N * W);
+            for (size_t n = 0; n < N; n++)
+            {
+                for (int l = 0; l < W; l++)
+                    y_[n * W + l] = y[n * W + (l < num_lanes ? l : 0)];
+            }
+
+            for (int i = 0; i < P; i++)
+            {
+                for (int l = 0; l < W; l++)
+                    p_[i][l] = params[i * W + (l < num_lanes ? l : 0)];
+            }
+
+            for (int l = 0; l < W; l++)
+            {
+                active_[l] = (l < num_lanes);
+                status_[l] = hoBatchLMStatus::MAX_ITERATIONS_REACHED;
+                mu_[l] = T(1e-4);
+                nu_[l] = T(2);
+                for (int i = 0; i < P; i++) dtd_[i][l] = T(0);
+            }
+
+            this->evaluate(x, p_, cost_, g_, A_);
+
+            for (size_t k = 0; k < max_iter_; k++)
+            {
+                if (!this->any_active()) break;
+
+                // damped normal equations, (A + mu D) h = -g
+                #pragma omp simd
+                for (int l = 0; l < W; l++)
+                {
+                    for (int i = 0; i < P; i++)
+                        dtd_[i][l] = std::max(dtd_[i][l], A_[i * P + i][l]);
+
+                    T M[P * P], b[P], h[P];
+                    for (int i = 0; i < P; i++)
+                    {
+                        for (int j = 0; j < P; j++)
+                            M[i * P + j] = A_[i * P + j][l];
+                        M[i * P + i] += mu_[l] * dtd_[i][l];
+                        b[i] = -g_[i][l];
+                    }
+
+                    bool solved = cholesky_solve(M, b, h);
+
+                    T norm_h(0), norm_p(0);
+                    for (int i = 0; i < P; i++)
+                    {
+                        norm_h += h[i] * h[i];
+                        norm_p += p_[i][l] * p_[i][l];
+                        trial_[i][l] = p_[i][l] + h[i];
+                        h_[i][l] = h[i];
+                    }
+                    norm_h = std::sqrt(norm_h);
+                    norm_p = std::sqrt(norm_p);
+
+                    // a damped system which is not positive definite in finite precision is retried with more damping;
+                    // the lane fails only if the normal equations are no longer finite
+                    step_[l] = solved;
+                    if (active_[l] && !solved && !std::isfinite(norm_p + cost_[l]))
+                    {
+                        active_[l] = false;
+                        status_[l] = hoBatchLMStatus::LINEAR_SOLVER_FAILED;
+                    }
+                    else if (active_[l] && solved && norm_h < minimum_step_size_ * (norm_p + minimum_step_size_))
+                    {
+                        active_[l] = false;
+                        status_[l] = hoBatchLMStatus::SUCCESS;
+                    }
+                }
+
+                if (!this->any_active()) break;
+
+                this->evaluate(x, trial_, trial_cost_, trial_g_, trial_A_);
+
+                #pragma omp simd
+                for (int l = 0; l < W; l++)
+                {
+                    // gain ratio of the actual and the predicted reduction
+                    T predicted(0);
+                    for (int i = 0; i < P; i++)
+                        predicted += h_[i][l] * (mu_[l] * dtd_[i][l] * h_[i][l] - g_[i][l]);
+                    predicted /= 2;
+
+                    T rho = (cost_[l] - trial_cost_[l]) / predicted;
+                    bool better = active_[l] && step_[l] && (rho > 0) && std::isfinite(trial_cost_[l]);
+
+                    if (better)
+                    {
+                        T c = 2 * rho - 1;
+                        mu_[l] *= std::max(T(1) / 3, T(1) - c * c * c);
+                        nu_[l] = T(2);
+
+                        cost_[l] = trial_cost_[l];
+                        T norm_g(0);
+                        for (int i = 0; i < P; i++)
+                        {
+                            p_[i][l] = trial_[i][l];
+                            g_[i][l] = trial_g_[i][l];
+                            norm_g = std::max(norm_g, std::abs(g_[i][l]));
+                        }
+                        for (int i = 0; i < P * P; i++)
+                            A_[i][l] = trial_A_[i][l];
+
+                        if (norm_g <= minimum_gradient_)
+                        {
+                            active_[l] = false;
+                            status_[l] = hoBatchLMStatus::SUCCESS;
+                        }
+                    }
+                    else if (active_[l])
+                    {
+                        mu_[l] *= nu_[l];
+                        nu_[l] *= 2;
+                    }
+                }
+            }
+
+            for (int l = 0; l < num_lanes; l++)
+            {
+                for (int i = 0; i < P; i++)
+                    params[i * W + l] = p_[i][l];
+                if (status != NULL) status[l] = status_[l];
+            }
+        }
+
+        /// half of the sum of squared residuals of every lane at the end of the last solve
+        const T* cost() const { return cost_; }
+
+        Model model_;
+
+        /// maximal number of iterations
+        size_t max_iter_;
+        /// stop if the step is smaller than this, relative to the norm of the parameters
+        T minimum_step_size_;
+        /// stop if the largest gradient entry is smaller than this
+        T minimum_gradient_;
+
+    protected:
+
+        typedef T LaneVector[W];
+
+        bool any_active() const
+        {
+            bool res = false;
+            for (int l = 0; l < W; l++) res = res || active_[l];
+            return res;
+        }
+
+        /// cost, gradient J'r and normal matrix J'J at the parameters p of every lane
+        void evaluate(const std::vector<T>& x, const LaneVector* p, T* cost, LaneVector* g, LaneVector* A)
+        {
+            for (int l = 0; l < W; l++)
+            {
+                cost[l] = 0;
+                for (int i = 0; i < P; i++) g[i][l] = 0;
+                for (int i = 0; i < P * P; i++) A[i][l] = 0;
+            }
+
+            for (size_t n = 0; n < x.size(); n++)
+            {
+                const T xn = x[n];
+                const T* yn = &y_[n * W];
+
+                #pragma omp simd
+                for (int l = 0; l < W; l++)
+                {
+                    T pl[P], grad[P];
+                    for (int i = 0; i < P; i++) pl[i] = p[i][l];
+
+                    T r = model_(xn, pl, grad) - yn[l];
+
+                    cost[l] += r * r / 2;
+                    for (int i = 0; i < P; i++)
+                    {
+                        g[i][l] += grad[i] * r;
+                        for (int j = 0; j < P; j++)
+                            A[i * P + j][l] += grad[i] * grad[j];
+                    }
+                }
+            }
+        }
+
+        /// solve M h = b for a symmetric positive definite P x P matrix; M is overwritten
+        static inline bool cholesky_solve(T* M, const T* b, T* h)
+        {
+            bool ok = true;
+            for (int j = 0; j < P; j++)
+            {
+                T d = M[j * P + j];
+                for (int k = 0; k < j; k++) d -= M[j * P + k] * M[j * P + k];
+                ok = ok && (d > 0);
+                d = std::sqrt(d > 0 ? d : T(1));
+                M[j * P + j] = d;
+
+                for (int i = j + 1; i < P; i++)
+                {
+                    T v = M[i * P + j];
+                    for (int k = 0; k < j; k++) v -= M[i * P + k] * M[j * P + k];
+                    M[i * P + j] = v / d;
+                }
+            }
+
+            for (int i = 0; i < P; i++)
+            {
+                T v = b[i];
+                for (int k = 0; k < i; k++) v -= M[i * P + k] * h[k];
+                h[i] = v / M[i * P + i];
+            }
+
+            for (int i = P - 1; i >= 0; i--)
+            {
+                T v = h[i];
+                for (int k = i + 1; k < P; k++) v -= M[k * P + i] * h[k];
+                h[i] = v / M[i * P + i];
+            }
+
+            return ok;
+        }
+
+        std::vector<T> y_;
+
+        LaneVector p_[P], trial_[P], h_[P], dtd_[P];
+        LaneVector g_[P], trial_g_[P];
+        LaneVector A_[P * P], trial_A_[P * P];
+        T cost_[W], trial_cost_[W];
+        T mu_[W], nu_[W];
+        bool active_[W], step_[W];
+        hoBatchLMStatus status_[W];
+    };
+}
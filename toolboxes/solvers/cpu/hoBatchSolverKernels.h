@@ -0,0 +1,145 @@
+/** \file hoBatchSolverKernels.h
+    \brief Per-system vector kernels used by the batched cpu solvers.
+
+    A batch of B independent systems is stored as one hoNDArray whose last dimension is the batch.
+    Every kernel processes all systems marked as active in one OpenMP parallel loop over the batch;
+    within a system the loops are the single pass kernels of hoCgSolverKernels.h, or plain simd loops
+    over the interleaved real representation when all coefficients are real.
+    For a batch of one system the parallelism is left to the inner kernels.
+*/
+
+#pragma once
+
+#include "hoCgSolverKernels.h"
+
+#include <cmath>
+#include <vector>
+
+namespace Gadgetron{
+namespace hoBatchSolverKernels{
+
+    template <class T> using real_t = typename realType<T>::Type;
+
+    /**
+    * @brief Number of real values per element of type T
+    */
+    template <class T> constexpr size_t real_stride() { return is_complex_type_v<T> ? 2 : 1; }
+
+    /**
+    * @brief Calls f(b) for every active system b, in parallel over the batch
+    */
+    template <class F> void for_each_system(size_t B, const std::vector<unsigned char>& active, F f)
+    {
+        long long b;
+#pragma omp parallel for schedule(dynamic) if(B > 1)
+        for (b = 0; b < (long long)B; b++)
+        {
+            if (active[b]) f((size_t)b);
+        }
+    }
+
+    /**
+    * @brief r_b = sum(conj(x_b)*y_b) for all active systems
+    */
+    template <class T> void dotc(size_t B, size_t M, const std::vector<unsigned char>& active, const T* x, const T* y, std::vector<T>& r)
+    {
+        for_each_system(B, active, [&](size_t b) { r[b] = hoCgSolverKernels::dotc(M, x + b*M, y + b*M); });
+    }
+
+    /**
+    * @brief r_b = sum(|x_b|^2) for all active systems
+    */
+    template <class T> void nrm2sq(size_t B, size_t M, const std::vector<unsigned char>& active, const T* x, std::vector<real_t<T>>& r)
+    {
+        for_each_system(B, active, [&](size_t b) { r[b] = real(hoCgSolverKernels::dotc(M, x + b*M, x + b*M)); });
+    }
+
+    /**
+    * @brief x_b *= a_b for all active systems
+    */
+    template <class T> void scal(size_t B, size_t M, const std::vector<unsigned char>& active, const std::vector<real_t<T>>& a, T* x)
+    {
+        typedef real_t<T> REAL;
+        const size_t L = M*real_stride<T>();
+
+        for_each_system(B, active, [&](size_t b) {
+            REAL* px = reinterpret_cast<REAL*>(x + b*M);
+            const REAL ab = a[b];
+#pragma omp simd
+            for (size_t n = 0; n < L; n++) px[n] *= ab;
+        });
+    }
+
+    /**
+    * @brief x_b += a_b*y_b for all active systems
+    */
+    template <class T> void axpy(size_t B, size_t M, const std::vector<unsigned char>& active, const std::vector<real_t<T>>& a, const T* y, T* x)
+    {
+        typedef real_t<T> REAL;
+        const size_t L = M*real_stride<T>();
+
+        for_each_system(B, active, [&](size_t b) {
+            REAL* px = reinterpret_cast<REAL*>(x + b*M);
+            const REAL* py = reinterpret_cast<const REAL*>(y + b*M);
+            const REAL ab = a[b];
+#pragma omp simd
+            for (size_t n = 0; n < L; n++) px[n] += ab*py[n];
+        });
+    }
+
+    /**
+    * @brief y_b = x_b - a_b*y_b for all active systems; returns r_b = sum(|y_b|^2) of the result
+    */
+    template <class T> void xmay_nrm2sq(size_t B, size_t M, const std::vector<unsigned char>& active, const std::vector<real_t<T>>& a,
+        const T* x, T* y, std::vector<real_t<T>>& r)
+    {
+        typedef real_t<T> REAL;
+        const size_t L = M*real_stride<T>();
+
+        for_each_system(B, active, [&](size_t b) {
+            const REAL* px = reinterpret_cast<const REAL*>(x + b*M);
+            REAL* py = reinterpret_cast<REAL*>(y + b*M);
+            const REAL ab = a[b];
+            REAL nrm(0);
+#pragma omp simd reduction(+:nrm)
+            for (size_t n = 0; n < L; n++)
+            {
+                REAL v = px[n] - ab*py[n];
+                py[n] = v;
+                nrm += v*v;
+            }
+            r[b] = nrm;
+        });
+    }
+
+    /**
+    * @brief d_b = (z_b - t_b*d_b)*s_b for all active systems;
+    *        returns rd_b = sum(|d_b|^2) of the result and rx_b = sum(|x_b|^2) in the same pass
+    */
+    template <class T> void lsqr_direction(size_t B, size_t M, const std::vector<unsigned char>& active,
+        const std::vector<real_t<T>>& t, const std::vector<real_t<T>>& s, const T* z, T* d, const T* x,
+        std::vector<real_t<T>>& rd, std::vector<real_t<T>>& rx)
+    {
+        typedef real_t<T> REAL;
+        const size_t L = M*real_stride<T>();
+
+        for_each_system(B, active, [&](size_t b) {
+            const REAL* pz = reinterpret_cast<const REAL*>(z + b*M);
+            const REAL* px = reinterpret_cast<const REAL*>(x + b*M);
+            REAL* pd = reinterpret_cast<REAL*>(d + b*M);
+            const REAL tb = t[b], sb = s[b];
+            REAL nd(0), nx(0);
+#pragma omp simd reduction(+:nd,nx)
+            for (size_t n = 0; n < L; n++)
+            {
+                REAL v = (pz[n] - tb*pd[n])*sb;
+                pd[n] = v;
+                nd += v*v;
+                nx += px[n]*px[n];
+            }
+            rd[b] = nd;
+            rx[b] = nx;
+        });
+    }
+}
+}
@@ -0,0 +1,190 @@
+/** \file hoCgBatchSolver.h
+    \brief Conjugate gradient solver advancing a batch of independent systems in lockstep.
+
+    The domain of the encoding (and regularization) operators is [..., B], where the last dimension B
+    indexes independent systems (e.g. the N/S/SLC images of a recon buffer). The operators are applied to
+    the whole batch at once, so batched FFTs and kernel applications vectorise across systems,
+    while step lengths, inner products and the termination criterion are kept per system.
+    Converged systems are frozen and no longer updated; the iteration stops once all systems have converged.
+*/
+
+#pragma once
+
+#include "linearOperatorSolver.h"
+#include "cgPreconditioner.h"
+#include "hoNDArray_math.h"
+#include "hoBatchSolverKernels.h"
+
+#include <algorithm>
+
+namespace Gadgetron{
+
+  template <class T> class hoCgBatchSolver : public linearOperatorSolver< hoNDArray<T> >
+  {
+  public:
+
+    typedef linearOperatorSolver< hoNDArray<T> > BaseClass;
+    typedef typename realType<T>::Type REAL;
+
+    hoCgBatchSolver() : BaseClass() {
+      iterations_ = 10;
+      tc_tolerance_ = (REAL)1e-3;
+    }
+
+    virtual ~hoCgBatchSolver() {}
+
+    virtual void set_preconditioner( boost::shared_ptr< cgPreconditioner< hoNDArray<T> > > precond ) { precond_ = precond; }
+
+    virtual void set_max_iterations( unsigned int iterations ) { iterations_ = iterations; }
+    virtual unsigned int get_max_iterations() { return iterations_; }
+
+    // Relative residual rq/rq0 with respect to the initial residual, checked per system
+    virtual void set_tc_tolerance( REAL tolerance ) { tc_tolerance_ = tolerance; }
+    virtual REAL get_tc_tolerance() { return tc_tolerance_; }
+
+    // Number of iterations performed for every system of the last solve
+    const std::vector<unsigned int>& get_iterations() const { return iterations_done_; }
+
+    virtual boost::shared_ptr< hoNDArray<T> > solve( hoNDArray<T> *d )
+    {
+      if( !this->encoding_operator_ ){
+        throw std::runtime_error( "Error: hoCgBatchSolver::solve : no encoding operator is set" );
+      }
+
+      boost::shared_ptr< std::vector<size_t> > image_dims = this->encoding_operator_->get_domain_dimensions();
+      hoNDArray<T> rhs(*image_dims);
+      this->encoding_operator_->mult_MH( d, &rhs );
+      scal( this->encoding_operator_->get_weight(), rhs );
+
+      return solve_from_rhs( &rhs );
+    }
+
+    virtual boost::shared_ptr< hoNDArray<T> > solve_from_rhs( hoNDArray<T> *rhs )
+    {
+      if( !rhs || rhs->get_number_of_elements() == 0 ){
+        throw std::runtime_error( "Error: hoCgBatchSolver::solve_from_rhs : empty or NULL rhs provided" );
+      }
+
+      const std::vector<size_t>& dims = rhs->dimensions();
+      const size_t B = dims.back();
+      const size_t M = rhs->get_number_of_elements() / B;
+
+      boost::shared_ptr< hoNDArray<T> > x = boost::make_shared< hoNDArray<T> >(dims);
+
+      r_.create(dims);
+      p_.create(dims);
+      q_.create(dims);
+
+      if( this->get_x0() ){
+        if( !this->get_x0()->dimensions_equal( rhs ) ){
+          throw std::runtime_error( "Error: hoCgBatchSolver::solve_from_rhs : RHS and initial guess must have same dimensions" );
+        }
+        *x = *this->get_x0();
+        this->mult_MH_M( x.get(), &q_ );
+        hoCgSolverKernels::subtract( rhs->get_number_of_elements(), rhs->get_data_ptr(), q_.get_data_ptr(), r_.get_data_ptr() );
+      }
+      else{
+        clear(x.get());
+        r_ = *rhs;
+      }
+
+      p_ = r_;
+      if( precond_ ){
+        precond_->apply( &p_, &p_ );
+        precond_->apply( &p_, &p_ );
+      }
+
+      std::vector<unsigned char> active(B, 1);
+      std::vector<T> pq(B), rz(B);
+      std::vector<REAL> rq(B), rq0(B);
+      iterations_done_.assign(B, 0);
+
+      hoBatchSolverKernels::dotc( B, M, active, r_.get_data_ptr(), p_.get_data_ptr(), rz );
+      for( size_t b=0; b<B; b++ ){
+        rq[b] = real(rz[b]);
+        rq0[b] = rq[b];
+        if( !(rq0[b] > REAL(0)) ) active[b] = 0;
+      }
+
+      for( unsigned int it=0; it<iterations_; it++ ){
+
+        if( std::find( active.begin(), active.end(), 1 ) == active.end() ) break;
+
+        // q = MHM p, for the whole batch
+        this->mult_MH_M( &p_, &q_ );
+
+        hoBatchSolverKernels::dotc( B, M, active, p_.get_data_ptr(), q_.get_data_ptr(), pq );
+
+        T* px = x->get_data_ptr();
+        T* pr = r_.get_data_ptr();
+        T* pp = p_.get_data_ptr();
+        T* pQ = q_.get_data_ptr();
+
+        if( precond_ ){
+          hoBatchSolverKernels::for_each_system( B, active, [&](size_t b) {
+            hoCgSolverKernels::update_x_r( M, T(rq[b])/pq[b], pp + b*M, pQ + b*M, px + b*M, pr + b*M );
+          });
+
+          precond_->apply( &r_, &q_ );
+          precond_->apply( &q_, &q_ );
+
+          hoBatchSolverKernels::dotc( B, M, active, pr, pQ, rz );
+          hoBatchSolverKernels::for_each_system( B, active, [&](size_t b) {
+            REAL tmp_rq = real(rz[b]);
+            hoCgSolverKernels::xpby( M, pQ + b*M, tmp_rq/rq[b], pp + b*M );
+            rq[b] = tmp_rq;
+          });
+        }
+        else{
+          hoBatchSolverKernels::for_each_system( B, active, [&](size_t b) {
+            REAL tmp_rq = hoCgSolverKernels::update_x_r_nrm2sq( M, T(rq[b])/pq[b], pp + b*M, pQ + b*M, px + b*M, pr + b*M );
+            hoCgSolverKernels::xpby( M, pr + b*M, tmp_rq/rq[b], pp + b*M );
+            rq[b] = tmp_rq;
+          });
+        }
+
+        // Per system termination; frozen systems keep p = 0 so they no longer contribute to MHM p
+        for( size_t b=0; b<B; b++ ){
+          if( !active[b] ) continue;
+          iterations_done_[b] = it+1;
+          if( rq[b]/rq0[b] < tc_tolerance_ ){
+            active[b] = 0;
+            std::fill( pp + b*M, pp + (b+1)*M, T(0) );
+          }
+        }
+
+        if( this->output_mode_ >= solver< hoNDArray<T>, hoNDArray<T> >::OUTPUT_VERBOSE ){
+          GDEBUG_STREAM("Iteration " << it << ". active systems = " << std::count( active.begin(), active.end(), 1 ) << " / " << B << std::endl);
+        }
+      }
+
+      return x;
+    }
+
+  protected:
+
+    // MHM of the encoding and regularization operators, applied to the whole batch
+    void mult_MH_M( hoNDArray<T> *in, hoNDArray<T> *out )
+    {
+      if( !tmp_.dimensions_equal(in) ) tmp_.create(in->dimensions());
+
+      this->encoding_operator_->mult_MH_M( in, &tmp_, false );
+      hoCgSolverKernels::scale( in->get_number_of_elements(), T(this->encoding_operator_->get_weight()), tmp_.get_data_ptr(), out->get_data_ptr() );
+
+      for( unsigned int i=0; i<this->regularization_operators_.size(); i++ ){
+        this->regularization_operators_[i]->mult_MH_M( in, &tmp_, false );
+        axpy( T(this->regularization_operators_[i]->get_weight()), &tmp_, out );
+      }
+    }
+
+    boost::shared_ptr< cgPreconditioner< hoNDArray<T> > > precond_;
+
+    unsigned int iterations_;
+    REAL tc_tolerance_;
+
+    std::vector<unsigned int> iterations_done_;
+
+    // Workspace, kept between solves
+    hoNDArray<T> r_, p_, q_, tmp_;
+  };
+}
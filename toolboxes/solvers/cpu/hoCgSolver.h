@@ -4,25 +4,341 @@
     The file hoCgSolver.h is a convienience wrapper for the device independent cgSolver class.
     The class hoCgSolver instantiates the cgSolver for the hoNDArray
     and the header otherwise includes other neccessary header files.
+
+    Compared to the device independent implementation, the cpu solver keeps a persistent workspace
+    between iterations and solves, and performs the vector updates of each iteration in fused,
+    single pass kernels (see hoCgSolverKernels.h). Optionally, the pipelined conjugate gradient
+    variant of Ghysels and Vanroose can be used, which merges all inner products and vector updates
+    of an iteration into one sweep over memory.
+
+    Ref to:
+    P. Ghysels and W. Vanroose, Hiding global synchronization latency in the preconditioned Conjugate Gradient algorithm,
+    Parallel Computing 40(7), 224-238 (2014).
 */
 
 #pragma once
 
 #include "cgSolver.h"
 #include "hoNDArray_math.h"
+#include "hoCgSolverKernels.h"
+
+#include <chrono>
+#include <numeric>
 
 namespace Gadgetron{
 
   /** \class hoCgSolver
       \brief Instantiation of the conjugate gradient solver on the cpu.
-      
+
       The class hoCgSolver is a convienience wrapper for the device independent cgSolver class.
       hoCgSolver instantiates the cgSolver for type hoNDArray<T>.
   */
   template <class T> class hoCgSolver : public cgSolver< hoNDArray<T> >
   {
   public:
-    hoCgSolver() : cgSolver<hoNDArray<T> >() {}
+
+    typedef cgSolver< hoNDArray<T> > BaseClass;
+    typedef typename BaseClass::REAL REAL;
+
+    hoCgSolver() : BaseClass(), pipelined_(false), allocations_(0), allocations_last_solve_(0) {}
     virtual ~hoCgSolver() {}
+
+    // Enable/disable the pipelined cg variant.
+    // The pipelined variant performs one fused sweep over all vectors per iteration,
+    // at the price of three more workspace arrays and slightly different rounding.
+    // It is only used without preconditioner; otherwise the standard iteration is performed.
+    //
+
+    virtual void set_pipelined( bool pipelined ) { pipelined_ = pipelined; }
+    virtual bool get_pipelined() { return pipelined_; }
+
+    // Wall time in ms of every iteration of the last solve
+    //
+
+    const std::vector<double>& get_iteration_times() const { return iteration_times_; }
+
+    // Number of arrays allocated by the solver in the last solve, and since construction.
+    // After the first solve, only the returned solution is allocated for problems of unchanged size.
+    //
+
+    size_t get_allocations_last_solve() const { return allocations_last_solve_; }
+    size_t get_allocations() const { return allocations_; }
+
+    // Free the workspace kept between solves
+    //
+
+    virtual void release_workspace()
+    {
+      r_ws_.reset();
+      p_ws_.reset();
+      q_.clear();
+      tmp_.clear();
+      w_.clear();
+      z_.clear();
+      s_.clear();
+    }
+
+  protected:
+
+    using BaseClass::x_;
+    using BaseClass::p_;
+    using BaseClass::r_;
+    using BaseClass::rq_;
+    using BaseClass::rq0_;
+    using BaseClass::alpha_;
+    using BaseClass::precond_;
+    using BaseClass::cb_;
+
+    virtual void initialize( hoNDArray<T> *rhs )
+    {
+      if( !rhs || rhs->get_number_of_elements() == 0 ){
+        throw std::runtime_error( "Error: hoCgSolver::initialize : empty or NULL rhs provided" );
+      }
+
+      if( this->get_x0().get() && !this->get_x0()->dimensions_equal( rhs ) ){
+        throw std::runtime_error( "Error: hoCgSolver::initialize : RHS and initial guess must have same dimensions" );
+      }
+
+      allocations_last_solve_ = 0;
+      iteration_times_.clear();
+      iteration_times_.reserve(this->get_max_iterations());
+
+      const std::vector<size_t>& dims = rhs->dimensions();
+      const size_t N = rhs->get_number_of_elements();
+
+      // The solution is handed over to the caller, hence it cannot be part of the workspace
+      x_ = boost::make_shared< hoNDArray<T> >(dims);
+      count_allocation();
+
+      if( !r_ws_ ) r_ws_ = boost::make_shared< hoNDArray<T> >();
+      if( !p_ws_ ) p_ws_ = boost::make_shared< hoNDArray<T> >();
+
+      prepare_workspace(*r_ws_, dims);
+      prepare_workspace(*p_ws_, dims);
+      prepare_workspace(q_, dims);
+
+      r_ = r_ws_;
+      p_ = p_ws_;
+
+      // r = rhs - MHM x0
+      //
+
+      if( this->get_x0().get() ){
+
+        if( this->output_mode_ >= solver<hoNDArray<T>,hoNDArray<T> >::OUTPUT_VERBOSE ) {
+          GDEBUG_STREAM("Preparing guess..." << std::endl);
+        }
+
+        *x_ = *(this->get_x0());
+        this->mult_MH_M_ws( x_.get(), &q_ );
+        hoCgSolverKernels::subtract( N, rhs->get_data_ptr(), q_.get_data_ptr(), r_->get_data_ptr() );
+      }
+      else{
+        clear(x_.get());
+        std::copy( rhs->begin(), rhs->end(), r_->begin() );
+      }
+
+      if( use_pipelined() ){
+        prepare_workspace(w_, dims);
+        prepare_workspace(z_, dims);
+        prepare_workspace(s_, dims);
+
+        // The first iteration updates z, s and p with beta = 0, and 0*NaN from a reused or fresh workspace is NaN
+        clear(&z_);
+        clear(&s_);
+        clear(p_.get());
+
+        // w = MHM r
+        this->mult_MH_M_ws( r_.get(), &w_ );
+
+        T delta;
+        rq_ = hoCgSolverKernels::nrm2sq_dotc( N, r_->get_data_ptr(), w_.get_data_ptr(), delta );
+        delta_ = real(delta);
+        rq0_ = rq_;
+        rq_prev_ = rq_;
+        alpha_prev_ = REAL(1);
+      }
+      else{
+
+        // p = M r
+        //
+
+        std::copy( r_->begin(), r_->end(), p_->begin() );
+
+        if( precond_.get() ) {
+          precond_->apply( p_.get(), p_.get() );
+          precond_->apply( p_.get(), p_.get() );
+        }
+
+        rq_ = real( hoCgSolverKernels::dotc( N, r_->get_data_ptr(), p_->get_data_ptr() ) );
+
+        // Without initial guess, rq0 is computed with respect to the right hand side, as in cgSolver
+        if( this->get_x0().get() ){
+          hoNDArray<T> p0(dims);
+          count_allocation();
+          std::copy( rhs->begin(), rhs->end(), p0.begin() );
+          if( precond_.get() ) {
+            precond_->apply( &p0, &p0 );
+            precond_->apply( &p0, &p0 );
+          }
+          rq0_ = real( hoCgSolverKernels::dotc( N, rhs->get_data_ptr(), p0.get_data_ptr() ) );
+        }
+        else{
+          rq0_ = rq_;
+        }
+      }
+
+      cb_->initialize(this);
+    }
+
+    virtual void deinitialize()
+    {
+      // p and r are kept in the workspace for the next solve
+      p_.reset();
+      r_.reset();
+      x_.reset();
+
+      if( this->output_mode_ >= solver<hoNDArray<T>,hoNDArray<T> >::OUTPUT_VERBOSE && !iteration_times_.empty() ){
+        double total = std::accumulate( iteration_times_.begin(), iteration_times_.end(), 0.0 );
+        GDEBUG_STREAM("hoCgSolver : " << iteration_times_.size() << " iterations, "
+                      << total/iteration_times_.size() << " ms per iteration, "
+                      << allocations_last_solve_ << " array allocations" << std::endl);
+      }
+    }
+
+    virtual void iterate( unsigned int iteration, REAL *tc_metric, bool *tc_terminate )
+    {
+      auto start = std::chrono::high_resolution_clock::now();
+
+      if( use_pipelined() )
+        this->iterate_pipelined(iteration);
+      else
+        this->iterate_standard();
+
+      iteration_times_.push_back( std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now()-start).count() );
+
+      if( !cb_->iterate( iteration, tc_metric, tc_terminate ) ){
+        throw std::runtime_error( "Error: hoCgSolver::iterate : termination callback iteration failed" );
+      }
+    }
+
+    // Standard (preconditioned) cg iteration with fused vector updates
+    //
+
+    void iterate_standard()
+    {
+      const size_t N = x_->get_number_of_elements();
+
+      this->mult_MH_M_ws( p_.get(), &q_ );
+
+      alpha_ = T(rq_) / hoCgSolverKernels::dotc( N, p_->get_data_ptr(), q_.get_data_ptr() );
+
+      if( precond_.get() ){
+
+        hoCgSolverKernels::update_x_r( N, alpha_, p_->get_data_ptr(), q_.get_data_ptr(), x_->get_data_ptr(), r_->get_data_ptr() );
+
+        precond_->apply( r_.get(), &q_ );
+        precond_->apply( &q_, &q_ );
+
+        REAL tmp_rq = real( hoCgSolverKernels::dotc( N, r_->get_data_ptr(), q_.get_data_ptr() ) );
+        hoCgSolverKernels::xpby( N, q_.get_data_ptr(), tmp_rq/rq_, p_->get_data_ptr() );
+        rq_ = tmp_rq;
+      }
+      else{
+
+        REAL tmp_rq = hoCgSolverKernels::update_x_r_nrm2sq( N, alpha_, p_->get_data_ptr(), q_.get_data_ptr(), x_->get_data_ptr(), r_->get_data_ptr() );
+        hoCgSolverKernels::xpby( N, r_->get_data_ptr(), tmp_rq/rq_, p_->get_data_ptr() );
+        rq_ = tmp_rq;
+      }
+    }
+
+    // Pipelined cg iteration; rq_ and delta_ hold (r,r) and (r,MHM r) of the current residual
+    //
+
+    void iterate_pipelined( unsigned int iteration )
+    {
+      const size_t N = x_->get_number_of_elements();
+
+      // q = MHM w
+      this->mult_MH_M_ws( &w_, &q_ );
+
+      REAL beta, alpha;
+      if( iteration == 0 ){
+        beta = REAL(0);
+        alpha = rq_/delta_;
+      }
+      else{
+        beta = rq_/rq_prev_;
+        alpha = rq_/(delta_ - beta*rq_/alpha_prev_);
+      }
+
+      T delta;
+      REAL gamma = hoCgSolverKernels::update_pipelined( N, T(alpha), beta,
+        q_.get_data_ptr(), z_.get_data_ptr(), s_.get_data_ptr(), p_->get_data_ptr(),
+        x_->get_data_ptr(), r_->get_data_ptr(), w_.get_data_ptr(), delta );
+
+      alpha_ = T(alpha);
+      alpha_prev_ = alpha;
+      rq_prev_ = rq_;
+      rq_ = gamma;
+      delta_ = real(delta);
+    }
+
+    // mult_MH_M of the encoding and regularization matrices using the solver workspace
+    //
+
+    void mult_MH_M_ws( hoNDArray<T> *in, hoNDArray<T> *out )
+    {
+      if( !in || !out ){
+        throw std::runtime_error( "Error: hoCgSolver::mult_MH_M : invalid input pointer(s)" );
+      }
+
+      if( in->get_number_of_elements() != out->get_number_of_elements() ){
+        throw std::runtime_error( "Error: hoCgSolver::mult_MH_M : array dimensionality mismatch" );
+      }
+
+      prepare_workspace(tmp_, in->dimensions());
+
+      this->encoding_operator_->mult_MH_M( in, &tmp_, false );
+      hoCgSolverKernels::scale( in->get_number_of_elements(), T(this->encoding_operator_->get_weight()), tmp_.get_data_ptr(), out->get_data_ptr() );
+
+      for( unsigned int i=0; i<this->regularization_operators_.size(); i++ ){
+        this->regularization_operators_[i]->mult_MH_M( in, &tmp_, false );
+        axpy( T(this->regularization_operators_[i]->get_weight()), &tmp_, out );
+      }
+    }
+
+    bool use_pipelined() const { return pipelined_ && !precond_.get(); }
+
+    void prepare_workspace( hoNDArray<T>& a, const std::vector<size_t>& dims )
+    {
+      if( !a.dimensions_equal(&dims) ){
+        a.create(dims);
+        count_allocation();
+      }
+    }
+
+    void count_allocation()
+    {
+      allocations_++;
+      allocations_last_solve_++;
+    }
+
+  protected:
+
+    bool pipelined_;
+
+    // Workspace, kept between iterations and solves
+    boost::shared_ptr< hoNDArray<T> > r_ws_, p_ws_;
+    hoNDArray<T> q_, tmp_;
+
+    // Additional workspace of the pipelined variant
+    hoNDArray<T> w_, z_, s_;
+    REAL delta_, rq_prev_, alpha_prev_;
+
+    // Statistics
+    std::vector<double> iteration_times_;
+    size_t allocations_;
+    size_t allocations_last_solve_;
   };
 }
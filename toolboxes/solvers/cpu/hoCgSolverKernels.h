@@ -0,0 +1,290 @@
+/** \file hoCgSolverKernels.h
+    \brief Fused vector kernels used by the cpu conjugate gradient solver.
+
+    Every kernel makes a single pass over its operands and combines the vector updates of a cg iteration
+    with the inner products that depend on them. Complex arrays are processed as interleaved real arrays
+    so that the loops vectorise, and the loops are OpenMP parallel for arrays above NumElementsUseThreading.
+*/
+
+#pragma once
+
+#include "complext.h"
+#include "hoNDArray_math.h"
+
+#ifndef NumElementsUseThreading
+#define NumElementsUseThreading 64 * 1024
+#endif // NumElementsUseThreading
+
+namespace Gadgetron{
+namespace hoCgSolverKernels{
+
+    namespace detail{
+
+        template <class T> using real_t = typename realType<T>::Type;
+
+        template <class T> inline const real_t<T>* as_real(const T* x) { return reinterpret_cast<const real_t<T>*>(x); }
+        template <class T> inline real_t<T>* as_real(T* x) { return reinterpret_cast<real_t<T>*>(x); }
+
+        template <class T> inline T make_value(real_t<T> re, real_t<T> im)
+        {
+            if constexpr (is_complex_type_v<T>)
+                return T(re, im);
+            else
+                return re;
+        }
+    }
+
+    /**
+    * @brief r = a - b
+    */
+    template <class T> void subtract(size_t N, const T* a, const T* b, T* r)
+    {
+        long long n;
+#pragma omp parallel for simd if(N > NumElementsUseThreading)
+        for (n = 0; n < (long long)N; n++)
+            r[n] = a[n] - b[n];
+    }
+
+    /**
+    * @brief r = a*x
+    */
+    template <class T> void scale(size_t N, T a, const T* x, T* r)
+    {
+        long long n;
+#pragma omp parallel for simd if(N > NumElementsUseThreading)
+        for (n = 0; n < (long long)N; n++)
+            r[n] = a * x[n];
+    }
+
+    /**
+    * @brief Returns sum(conj(x)*y)
+    */
+    template <class T> T dotc(size_t N, const T* x, const T* y)
+    {
+        typedef detail::real_t<T> REAL;
+        const REAL* px = detail::as_real(x);
+        const REAL* py = detail::as_real(y);
+
+        REAL re(0), im(0);
+        long long n;
+
+        if constexpr (is_complex_type_v<T>)
+        {
+#pragma omp parallel for simd reduction(+:re,im) if(N > NumElementsUseThreading)
+            for (n = 0; n < (long long)N; n++)
+            {
+                REAL xr = px[2*n], xi = px[2*n+1];
+                REAL yr = py[2*n], yi = py[2*n+1];
+                re += xr*yr + xi*yi;
+                im += xr*yi - xi*yr;
+            }
+        }
+        else
+        {
+#pragma omp parallel for simd reduction(+:re) if(N > NumElementsUseThreading)
+            for (n = 0; n < (long long)N; n++)
+                re += px[n] * py[n];
+        }
+
+        return detail::make_value<T>(re, im);
+    }
+
+    /**
+    * @brief Returns sum(|x|^2) and computes delta = sum(conj(x)*y) in the same pass
+    */
+    template <class T> detail::real_t<T> nrm2sq_dotc(size_t N, const T* x, const T* y, T& delta)
+    {
+        typedef detail::real_t<T> REAL;
+        const REAL* px = detail::as_real(x);
+        const REAL* py = detail::as_real(y);
+
+        REAL nrm(0), re(0), im(0);
+        long long n;
+
+        if constexpr (is_complex_type_v<T>)
+        {
+#pragma omp parallel for simd reduction(+:nrm,re,im) if(N > NumElementsUseThreading)
+            for (n = 0; n < (long long)N; n++)
+            {
+                REAL xr = px[2*n], xi = px[2*n+1];
+                REAL yr = py[2*n], yi = py[2*n+1];
+                nrm += xr*xr + xi*xi;
+                re += xr*yr + xi*yi;
+                im += xr*yi - xi*yr;
+            }
+        }
+        else
+        {
+#pragma omp parallel for simd reduction(+:nrm,re) if(N > NumElementsUseThreading)
+            for (n = 0; n < (long long)N; n++)
+            {
+                nrm += px[n] * px[n];
+                re += px[n] * py[n];
+            }
+        }
+
+        delta = detail::make_value<T>(re, im);
+        return nrm;
+    }
+
+    /**
+    * @brief p = z + beta*p
+    */
+    template <class T> void xpby(size_t N, const T* z, detail::real_t<T> beta, T* p)
+    {
+        typedef detail::real_t<T> REAL;
+        const size_t M = is_complex_type_v<T> ? 2*N : N;
+        const REAL* pz = detail::as_real(z);
+        REAL* pp = detail::as_real(p);
+
+        long long n;
+#pragma omp parallel for simd if(N > NumElementsUseThreading)
+        for (n = 0; n < (long long)M; n++)
+            pp[n] = pz[n] + beta * pp[n];
+    }
+
+    /**
+    * @brief x += alpha*p, r -= alpha*q
+    */
+    template <class T> void update_x_r(size_t N, T alpha, const T* p, const T* q, T* x, T* r)
+    {
+        long long n;
+#pragma omp parallel for simd if(N > NumElementsUseThreading)
+        for (n = 0; n < (long long)N; n++)
+        {
+            x[n] += alpha * p[n];
+            r[n] -= alpha * q[n];
+        }
+    }
+
+    /**
+    * @brief x += alpha*p, r -= alpha*q; returns sum(|r|^2) of the updated residual
+    */
+    template <class T> detail::real_t<T> update_x_r_nrm2sq(size_t N, T alpha, const T* p, const T* q, T* x, T* r)
+    {
+        typedef detail::real_t<T> REAL;
+        const REAL* pp = detail::as_real(p);
+        const REAL* pq = detail::as_real(q);
+        REAL* px = detail::as_real(x);
+        REAL* pr = detail::as_real(r);
+
+        REAL nrm(0);
+        long long n;
+
+        if constexpr (is_complex_type_v<T>)
+        {
+            const REAL ar = real(alpha), ai = imag(alpha);
+#pragma omp parallel for simd reduction(+:nrm) if(N > NumElementsUseThreading)
+            for (n = 0; n < (long long)N; n++)
+            {
+                REAL p_r = pp[2*n], p_i = pp[2*n+1];
+                REAL q_r = pq[2*n], q_i = pq[2*n+1];
+
+                px[2*n]   += ar*p_r - ai*p_i;
+                px[2*n+1] += ar*p_i + ai*p_r;
+
+                REAL r_r = pr[2*n]   - (ar*q_r - ai*q_i);
+                REAL r_i = pr[2*n+1] - (ar*q_i + ai*q_r);
+                pr[2*n]   = r_r;
+                pr[2*n+1] = r_i;
+
+                nrm += r_r*r_r + r_i*r_i;
+            }
+        }
+        else
+        {
+#pragma omp parallel for simd reduction(+:nrm) if(N > NumElementsUseThreading)
+            for (n = 0; n < (long long)N; n++)
+            {
+                px[n] += alpha * pp[n];
+                REAL rv = pr[n] - alpha * pq[n];
+                pr[n] = rv;
+                nrm += rv * rv;
+            }
+        }
+
+        return nrm;
+    }
+
+    /**
+    * @brief Vector updates of one pipelined cg iteration:
+    *   z = q + beta*z, s = w + beta*s, p = r + beta*p,
+    *   x += alpha*p, r -= alpha*s, w -= alpha*z.
+    *   Returns sum(|r|^2) and computes delta = sum(conj(r)*w) of the updated vectors,
+    *   which are the inner products needed by the next iteration.
+    */
+    template <class T> detail::real_t<T> update_pipelined(size_t N, T alpha, detail::real_t<T> beta, const T* q,
+        T* z, T* s, T* p, T* x, T* r, T* w, T& delta)
+    {
+        typedef detail::real_t<T> REAL;
+        const REAL* pq = detail::as_real(q);
+        REAL* pz = detail::as_real(z);
+        REAL* ps = detail::as_real(s);
+        REAL* pp = detail::as_real(p);
+        REAL* px = detail::as_real(x);
+        REAL* pr = detail::as_real(r);
+        REAL* pw = detail::as_real(w);
+
+        REAL nrm(0), re(0), im(0);
+        long long n;
+
+        if constexpr (is_complex_type_v<T>)
+        {
+            const REAL ar = real(alpha), ai = imag(alpha);
+#pragma omp parallel for simd reduction(+:nrm,re,im) if(N > NumElementsUseThreading)
+            for (n = 0; n < (long long)N; n++)
+            {
+                const long long i = 2*n, j = 2*n + 1;
+
+                REAL z_r = pq[i] + beta*pz[i], z_i = pq[j] + beta*pz[j];
+                REAL s_r = pw[i] + beta*ps[i], s_i = pw[j] + beta*ps[j];
+                REAL p_r = pr[i] + beta*pp[i], p_i = pr[j] + beta*pp[j];
+
+                px[i] += ar*p_r - ai*p_i;
+                px[j] += ar*p_i + ai*p_r;
+
+                REAL r_r = pr[i] - (ar*s_r - ai*s_i);
+                REAL r_i = pr[j] - (ar*s_i + ai*s_r);
+                REAL w_r = pw[i] - (ar*z_r - ai*z_i);
+                REAL w_i = pw[j] - (ar*z_i + ai*z_r);
+
+                pz[i] = z_r; pz[j] = z_i;
+                ps[i] = s_r; ps[j] = s_i;
+                pp[i] = p_r; pp[j] = p_i;
+                pr[i] = r_r; pr[j] = r_i;
+                pw[i] = w_r; pw[j] = w_i;
+
+                nrm += r_r*r_r + r_i*r_i;
+                re += r_r*w_r + r_i*w_i;
+                im += r_r*w_i - r_i*w_r;
+            }
+        }
+        else
+        {
+#pragma omp parallel for simd reduction(+:nrm,re) if(N > NumElementsUseThreading)
+            for (n = 0; n < (long long)N; n++)
+            {
+                REAL zv = pq[n] + beta*pz[n];
+                REAL sv = pw[n] + beta*ps[n];
+                REAL pv = pr[n] + beta*pp[n];
+
+                px[n] += alpha*pv;
+                REAL rv = pr[n] - alpha*sv;
+                REAL wv = pw[n] - alpha*zv;
+
+                pz[n] = zv;
+                ps[n] = sv;
+                pp[n] = pv;
+                pr[n] = rv;
+                pw[n] = wv;
+
+                nrm += rv*rv;
+                re += rv*wv;
+            }
+        }
+
+        delta = detail::make_value<T>(re, im);
+        return nrm;
+    }
+}
+}
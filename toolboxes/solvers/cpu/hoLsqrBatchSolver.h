@@ -0,0 +1,219 @@
+/** \file   hoLsqrBatchSolver.h
+    \brief  LSQR solver advancing a batch of independent systems in lockstep
+
+    The domain and codomain of the encoding operator are [..., B], where the last dimension B indexes
+    independent systems, e.g. the N images of a 2D+T SPIRIT problem handled by hoSPIRIT2DTOperator.
+    mult_M and mult_MH are applied to the whole batch at once, while all scalars of the LSQR recursion
+    and the termination tests of lsqrSolver are kept per system. A converged system is frozen,
+    its solution is not updated further, and the iteration stops when all systems have converged.
+    For a single system the iterates are those of hoLsqrSolver.
+*/
+
+#pragma once
+
+#include "hoNDArray_math.h"
+#include "lsqrSolver.h"
+#include "hoBatchSolverKernels.h"
+
+#include <algorithm>
+
+namespace Gadgetron{
+
+    template <class T> class hoLsqrBatchSolver : public lsqrSolver< hoNDArray<T> >
+    {
+    public:
+
+        typedef lsqrSolver< hoNDArray<T> > BaseClass;
+        typedef typename realType<T>::Type REAL;
+
+        hoLsqrBatchSolver() : BaseClass() {}
+        virtual ~hoLsqrBatchSolver() {}
+
+        /// number of iterations performed for every system of the last solve
+        const std::vector<unsigned int>& get_iterations() const { return iterations_done_; }
+
+        virtual void solve(hoNDArray<T>* x, hoNDArray<T>* b)
+        {
+            GADGET_CHECK_THROW(x != NULL);
+            GADGET_CHECK_THROW(b != NULL);
+
+            boost::shared_ptr< std::vector<size_t> > image_dims = this->encoding_operator_->get_domain_dimensions();
+            GADGET_CHECK_THROW(b->dimensions_equal(image_dims.get()));
+
+            if (this->x0_ != NULL)
+            {
+                GADGET_CHECK_THROW(this->x0_->dimensions_equal(image_dims.get()));
+                *x = *(this->x0_);
+            }
+            else
+            {
+                x->create(*image_dims);
+                Gadgetron::clear(*x);
+            }
+
+            const size_t B = image_dims->back();
+            const size_t M = x->get_number_of_elements() / B;
+            const size_t Mb = b->get_number_of_elements() / B;
+
+            std::vector<unsigned char> active(B, 1);
+            std::vector<REAL> n2b(B), beta(B), alpha(B), normr(B), normar(B), norma(B, REAL(0));
+            std::vector<REAL> c(B, REAL(1)), s(B, REAL(0)), phibar(B), phi(B), rho(B), thet(B), rho_inv(B);
+            std::vector<REAL> tmp(B), tmp2(B), sumnormd2(B, REAL(0)), coef(B);
+            std::vector<size_t> stag(B, 0);
+            const size_t maxstagsteps = 3;
+
+            iterations_done_.assign(B, 0);
+
+            hoBatchSolverKernels::nrm2sq(B, Mb, active, b->get_data_ptr(), n2b);
+
+            // u = b - A*x
+            u_.create(b->dimensions());
+            this->encoding_operator_->mult_M(x, &u_);
+
+            std::vector<REAL> one(B, REAL(1));
+            hoBatchSolverKernels::xmay_nrm2sq(B, Mb, active, one, b->get_data_ptr(), u_.get_data_ptr(), beta);
+
+            for (size_t k = 0; k < B; k++)
+            {
+                n2b[k] = std::sqrt(n2b[k]);
+                beta[k] = std::sqrt(beta[k]);
+                normr[k] = beta[k];
+                phibar[k] = beta[k];
+                coef[k] = (std::abs(beta[k]) > 0) ? REAL(1.0) / beta[k] : REAL(1.0);
+            }
+            hoBatchSolverKernels::scal(B, Mb, active, coef, u_.get_data_ptr());
+
+            // v = A'*u
+            v_.create(x->dimensions());
+            this->encoding_operator_->mult_MH(&u_, &v_);
+            hoBatchSolverKernels::nrm2sq(B, M, active, v_.get_data_ptr(), alpha);
+
+            for (size_t k = 0; k < B; k++)
+            {
+                alpha[k] = std::sqrt(alpha[k]);
+                coef[k] = (std::abs(alpha[k]) > 0) ? REAL(1.0) / alpha[k] : REAL(1.0);
+                normar[k] = alpha[k] * beta[k];
+            }
+            hoBatchSolverKernels::scal(B, M, active, coef, v_.get_data_ptr());
+
+            // systems with an all zero solution
+            for (size_t k = 0; k < B; k++)
+            {
+                if (std::abs(normar[k]) < DBL_EPSILON)
+                {
+                    std::fill(x->begin() + k*M, x->begin() + (k + 1)*M, T(0));
+                    active[k] = 0;
+                }
+            }
+
+            d_.create(x->dimensions());
+            Gadgetron::clear(d_);
+            utmp_.create(b->dimensions());
+            vt_.create(x->dimensions());
+
+            size_t ii;
+            for (ii = 0; ii < this->iterations_; ii++)
+            {
+                if (std::find(active.begin(), active.end(), 1) == active.end()) break;
+
+                // u = A*v - alpha*u, beta = |u|, u /= beta
+                this->encoding_operator_->mult_M(&v_, &utmp_);
+                hoBatchSolverKernels::xmay_nrm2sq(B, Mb, active, alpha, utmp_.get_data_ptr(), u_.get_data_ptr(), beta);
+
+                for (size_t k = 0; k < B; k++)
+                {
+                    if (!active[k]) continue;
+
+                    beta[k] = std::sqrt(beta[k]);
+                    coef[k] = REAL(1.0) / beta[k];
+
+                    norma[k] = std::sqrt(norma[k] * norma[k] + alpha[k] * alpha[k] + beta[k] * beta[k]);
+
+                    thet[k] = -s[k] * alpha[k];
+                    REAL rhot = c[k] * alpha[k];
+                    rho[k] = (REAL)(std::sqrt((double)(rhot*rhot + beta[k] * beta[k])));
+                    c[k] = rhot / rho[k];
+                    s[k] = -beta[k] / rho[k];
+                    phi[k] = c[k] * phibar[k];
+                    if (std::abs(phi[k]) < DBL_EPSILON)
+                    {
+                        stag[k] = 1;
+                    }
+
+                    phibar[k] = s[k] * phibar[k];
+                    rho_inv[k] = REAL(1.0) / rho[k];
+                }
+                hoBatchSolverKernels::scal(B, Mb, active, coef, u_.get_data_ptr());
+
+                // d = (v - thet*d)/rho
+                hoBatchSolverKernels::lsqr_direction(B, M, active, thet, rho_inv, v_.get_data_ptr(), d_.get_data_ptr(), x->get_data_ptr(), tmp, tmp2);
+
+                for (size_t k = 0; k < B; k++)
+                {
+                    if (!active[k]) continue;
+
+                    iterations_done_[k] = (unsigned int)(ii + 1);
+
+                    tmp[k] = std::sqrt(tmp[k]);
+                    tmp2[k] = std::sqrt(tmp2[k]);
+                    sumnormd2[k] += (tmp[k] * tmp[k]);
+
+                    // Check for stagnation of the method
+                    if (std::abs(phi[k])*std::abs(tmp[k]) < DBL_EPSILON*std::abs(tmp2[k]))
+                    {
+                        stag[k]++;
+                    }
+                    else
+                    {
+                        stag[k] = 0;
+                    }
+
+                    // check for convergence in min{|b-A*x|}, in A*x=b and for stagnation
+                    if ( (std::abs(normar[k] / (norma[k] * normr[k])) <= this->tc_tolerance_)
+                        || (std::abs(normr[k]) <= std::abs(this->tc_tolerance_ * n2b[k]))
+                        || (stag[k] >= maxstagsteps) )
+                    {
+                        active[k] = 0;
+                    }
+                }
+
+                // x += phi*d
+                hoBatchSolverKernels::axpy(B, M, active, phi, d_.get_data_ptr(), x->get_data_ptr());
+
+                // v = A'*u - beta*v, alpha = |v|, v /= alpha
+                this->encoding_operator_->mult_MH(&u_, &vt_);
+                hoBatchSolverKernels::xmay_nrm2sq(B, M, active, beta, vt_.get_data_ptr(), v_.get_data_ptr(), alpha);
+
+                for (size_t k = 0; k < B; k++)
+                {
+                    if (!active[k]) continue;
+
+                    normr[k] = (REAL)(std::abs((double)s[k]) * normr[k]);
+                    alpha[k] = std::sqrt(alpha[k]);
+                    coef[k] = REAL(1.0) / alpha[k];
+                    normar[k] = alpha[k] * std::abs((REAL)s[k] * phi[k]);
+                }
+                hoBatchSolverKernels::scal(B, M, active, coef, v_.get_data_ptr());
+            }
+
+            if (this->output_mode_ >= solver<hoNDArray<T>, hoNDArray<T> >::OUTPUT_VERBOSE)
+            {
+                GDEBUG_STREAM("Total iteration number is  " << ii << " - " << std::count(active.begin(), active.end(), 1) << " of " << B << " systems not converged ... ");
+            }
+        }
+
+        virtual boost::shared_ptr< hoNDArray<T> > solve(hoNDArray<T> *b)
+        {
+            boost::shared_ptr< hoNDArray<T> > x = boost::make_shared< hoNDArray<T> >();
+            this->solve(x.get(), b);
+            return x;
+        }
+
+    protected:
+
+        std::vector<unsigned int> iterations_done_;
+
+        // Workspace, kept between solves
+        hoNDArray<T> u_, v_, d_, utmp_, vt_;
+    };
+}
@@ -2,11 +2,36 @@
 
 #include "hoCgSolver.h"
 #include "sbSolver.h"
+#include "hoNDArray_expressions.h"
 
 #include "complext.h"
 
 namespace Gadgetron{
 
+  // Single pass versions of the split Bregman vector kernels in sbSolver.h
+
+  template <class T> void sb_encoding_space(const hoNDArray<T>& d_k, const hoNDArray<T>& b_k, const hoNDArray<T>* p_M, hoNDArray<T>& r)
+  {
+    if (p_M)
+      assign(r, lazy(d_k) - lazy(b_k) + lazy(*p_M));
+    else
+      assign(r, lazy(d_k) - lazy(b_k));
+  }
+
+  template <class T> void sb_accumulate_abs_square(hoNDArray<T>& x, hoNDArray<typename realType<T>::Type>& s, bool first)
+  {
+    if (first)
+      assign(s, norm(lazy(x)));
+    else
+      assign(s, lazy(s) + norm(lazy(x)));
+  }
+
+  // y is not written, which the contract of sb_distance leaves open
+  template <class T> typename realType<T>::Type sb_distance(const hoNDArray<T>& x, hoNDArray<T>& y)
+  {
+    return nrm2(lazy(x) - lazy(y));
+  }
+
   template <class T> class hoSbCgSolver : public sbSolver< hoNDArray<typename realType<T>::Type >, hoNDArray<T>, hoCgSolver<T> >
   {
   public:    
@@ -17,6 +17,35 @@
 
 namespace Gadgetron{
 
+// Vector kernels of the split Bregman iterations, written with the array operators. Array types with fused
+// single pass kernels overload them (see hoSbCgSolver.h); they are called unqualified so the overloads are found.
+
+// r = d_k - b_k (+ p_M)
+template<class ARRAY_TYPE> void sb_encoding_space(const ARRAY_TYPE& d_k, const ARRAY_TYPE& b_k, const ARRAY_TYPE* p_M, ARRAY_TYPE& r)
+{
+	r = d_k;
+	r -= b_k;
+	if(p_M)
+		r += *p_M;
+}
+
+// s = |x|^2 for the first x, s += |x|^2 for the following ones
+template<class ARRAY_TYPE_REAL, class ARRAY_TYPE> void sb_accumulate_abs_square(ARRAY_TYPE& x, ARRAY_TYPE_REAL& s, bool first)
+{
+	if(first)
+		s = *abs_square(&x);
+	else
+		s += *abs_square(&x);
+}
+
+// Returns nrm2(x - y). y serves as scratch space and holds unspecified values afterwards; overloads may leave it
+// unchanged, so callers must not read it before assigning it again.
+template<class ARRAY_TYPE> typename realType<typename ARRAY_TYPE::element_type>::Type sb_distance(const ARRAY_TYPE& x, ARRAY_TYPE& y)
+{
+	y -= x;
+	return nrm2(&y);
+}
+
 template< class ARRAY_TYPE_REAL,
 class ARRAY_TYPE_ELEMENT,
 class INNER_SOLVER >
@@ -52,10 +81,7 @@ protected:
 
 		virtual void update_encoding_space(ARRAY_TYPE_ELEMENT* encoding_space)
 		{
-			*encoding_space = *d_k;
-			*encoding_space -= *b_k;
-			if(prior.get())
-				*encoding_space += *p_M;
+			sb_encoding_space(*d_k, *b_k, p_M.get(), *encoding_space);
 		}
 
 		virtual void deinitialize()
@@ -154,10 +180,7 @@ protected:
 		{
 			for (int i=0; i < reg_ops.size(); i++){
 				ARRAY_TYPE_ELEMENT tmp(*codom_dims,encoding_space->get_data_ptr()+op_cont->get_offset(i));
-				tmp = *d_ks[i];
-				tmp -= *b_ks[i];
-				if (this->prior.get())
-					tmp += *p_Ms[i];
+				sb_encoding_space(*d_ks[i], *b_ks[i], this->prior.get() ? p_Ms[i].get() : nullptr, tmp);
 			}
 		}
 
@@ -197,7 +220,7 @@ protected:
 				this->reg_ops[i]->mult_M(u_k,&tmp[i],true);
 				if (this->prior.get())
 					tmp[i] -= *p_Ms[i];
-				(i==0) ? s_k = *abs_square<ELEMENT_TYPE>(&tmp[i]) : s_k += *abs_square<ELEMENT_TYPE>(&tmp[i]);
+				sb_accumulate_abs_square(tmp[i], s_k, i==0);
 			}
 			sqrt_inplace(&s_k);
 			for (int i=0; i<reg_ops.size(); i++) {
@@ -213,7 +236,7 @@ protected:
 				this->reg_ops[i]->mult_M(u_k,b_ks[i].get(),true);
 				if (this->prior.get())
 					*b_ks[i] -= *p_Ms[i];
-				(i==0) ? s_k = *abs_square(b_ks[i].get()) : s_k += *abs_square(b_ks[i].get());
+				sb_accumulate_abs_square(*b_ks[i], s_k, i==0);
 			}
 			sqrt_inplace(&s_k);
 			for (int i=0; i<reg_ops.size(); i++) {
@@ -254,10 +277,7 @@ protected:
 		{
 			for (int i=0; i < reg_ops.size(); i++){
 				ARRAY_TYPE_ELEMENT tmp(*codom_dims,encoding_space->get_data_ptr()+op_cont->get_offset(i));
-				tmp = *d_ks[i];
-				tmp -= *b_ks[i];
-				if (this->prior.get())
-					tmp += *p_Ms[i];
+				sb_encoding_space(*d_ks[i], *b_ks[i], this->prior.get() ? p_Ms[i].get() : nullptr, tmp);
 			}
 		}
 
@@ -297,7 +317,7 @@ protected:
 				this->reg_ops[i]->mult_M(u_k,&tmp[i],true);
 				if (this->prior.get())
 					tmp[i] -= *p_Ms[i];
-				(i==0) ? s_k = *abs_square<ELEMENT_TYPE>(&tmp[i]) : s_k += *abs_square<ELEMENT_TYPE>(&tmp[i]);
+				sb_accumulate_abs_square(tmp[i], s_k, i==0);
 			}
 			sqrt_inplace(&s_k);
 			for (int i=0; i<reg_ops.size(); i++) {
@@ -313,7 +333,7 @@ protected:
 				this->reg_ops[i]->mult_M(u_k,b_ks[i].get(),true);
 				if (this->prior.get())
 					*b_ks[i] -= *p_Ms[i];
-				(i==0) ? s_k = *abs_square(b_ks[i].get()) : s_k += *abs_square(b_ks[i].get());
+				sb_accumulate_abs_square(*b_ks[i], s_k, i==0);
 			}
 			sqrt_inplace(&s_k);
 			for (int i=0; i<reg_ops.size(); i++) {
@@ -767,8 +787,7 @@ protected:
 
 						// Compute change in u_k
 						if( this->output_mode_ >= solver<ARRAY_TYPE_ELEMENT, ARRAY_TYPE_ELEMENT>::OUTPUT_VERBOSE ){
-							*u_k -= *tmp_u_k;
-							GDEBUG_STREAM("u_k delta l2-norm (inner loop): " << nrm2(u_k.get()) << std::endl);
+							GDEBUG_STREAM("u_k delta l2-norm (inner loop): " << sb_distance(*tmp_u_k, *u_k) << std::endl);
 						}
 
 						// Update u_k
@@ -790,9 +809,7 @@ protected:
 
 			// Output change in u_k
 			if( tolerance > REAL(0) || this->output_mode_ >= solver<ARRAY_TYPE_ELEMENT, ARRAY_TYPE_ELEMENT>::OUTPUT_VERBOSE ){
-				u_k_prev *= ELEMENT_TYPE(-1);
-				u_k_prev += *u_k;
-				REAL delta = nrm2(&u_k_prev);
+				REAL delta = sb_distance(*u_k, u_k_prev);
 
 				if( this->output_mode_ >= solver<ARRAY_TYPE_ELEMENT, ARRAY_TYPE_ELEMENT>::OUTPUT_VERBOSE )
 					GDEBUG_STREAM("u_k delta l2-norm (outer loop): " << delta << std::endl << std::endl);